@@ -0,0 +1,269 @@
+#! /usr/bin/env python2.7
+"""
+Builds the integrators with repeated, warmed-up trials and sweeps the number
+of threads / IVPs, collecting the benchmark records written by each run
+(see generic/benchmark.h) into a single JSON and CSV file.
+With --sweep, each integrator runs the whole sweep in a single process
+(see generic/parameter_sweep.h), and step sizes may be swept as well.
+With --profile, the hardware counter metrics (see generic/hw_counters.h) are
+added to the records, the GPU metrics by an additional Nsight Compute run.
+"""
+from __future__ import print_function
+import os
+import stat
+import json
+import csv
+import subprocess
+import multiprocessing
+from argparse import ArgumentParser
+
+#: the columns of the csv output
+fields = ['solver', 'platform', 'num_ivps', 'num_threads', 'block_size',
+          'num_steps', 'stepsize', 'warmup', 'trials', 'min', 'max', 'mean', 'variance',
+          'median', 'p10', 'p90']
+
+#: the hardware counter columns, added with --profile
+counter_fields = ['flops_per_ivp_step', 'bytes_per_ivp_step', 'arithmetic_intensity',
+                  'l1_hit_rate', 'l2_hit_rate', 'occupancy', 'registers', 'local_bytes']
+
+#: the Nsight Compute metrics of the GPU driver kernel
+ncu_metrics = ['dram__bytes.sum',
+               'sm__sass_thread_inst_executed_op_dadd_pred_on.sum',
+               'sm__sass_thread_inst_executed_op_dmul_pred_on.sum',
+               'sm__sass_thread_inst_executed_op_dfma_pred_on.sum',
+               'sm__warps_active.avg.pct_of_peak_sustained_active',
+               'l1tex__t_sector_hit_rate.pct',
+               'lts__t_sector_hit_rate.pct',
+               'launch__registers_per_thread']
+
+
+def get_executables(blacklist, gpu, suffix=''):
+    exes = []
+    executable = stat.S_IEXEC | stat.S_IXGRP | stat.S_IXOTH
+    for filename in sorted(os.listdir(os.getcwd())):
+        if not os.path.isfile(filename) or filename.endswith('.py'):
+            continue
+        if not os.stat(filename).st_mode & executable:
+            continue
+        if any(b in filename for b in blacklist):
+            continue
+        if gpu and filename.endswith('-int-gpu' + suffix):
+            exes.append(filename)
+        elif not gpu and filename.endswith('-int' + suffix):
+            exes.append(filename)
+    return exes
+
+
+def profile_gpu(command, records, launches):
+    """
+    Runs `command` under Nsight Compute for the first `launches` launches of
+    the driver kernel, and merges the per IVP-step metrics into the last record
+    of `records` (the record of the unprofiled run of the same command)
+    """
+    with open(records, 'r') as file:
+        lines = [line for line in file if line.strip()]
+    output = subprocess.check_output(
+        ['ncu', '--kernel-name', 'regex:intDriver', '--launch-count', str(launches),
+         '--csv', '--print-units', 'base', '--metrics', ','.join(ncu_metrics)] + command)
+    # the profiled run appends a record (with replay-inflated timings) of its own
+    with open(records, 'w') as file:
+        file.writelines(lines)
+
+    sums = dict((m, 0.) for m in ncu_metrics)
+    counts = dict((m, 0) for m in ncu_metrics)
+    rows = [l for l in output.splitlines() if l.startswith('"')]
+    for row in csv.DictReader(rows):
+        name = row.get('Metric Name')
+        if name in sums:
+            sums[name] += float(row['Metric Value'].replace(',', ''))
+            counts[name] += 1
+    num_launches = counts['dram__bytes.sum']
+    if not lines or not num_launches:
+        print('Warning: no intDriver launches profiled')
+        return
+
+    record = json.loads(lines[-1])
+    # each launch advances every IVP by one global step
+    ivp_steps = float(num_launches * record['num_ivps'])
+    flops = (sums['sm__sass_thread_inst_executed_op_dadd_pred_on.sum'] +
+             sums['sm__sass_thread_inst_executed_op_dmul_pred_on.sum'] +
+             2 * sums['sm__sass_thread_inst_executed_op_dfma_pred_on.sum'])
+
+    def mean(name):
+        return sums[name] / counts[name] if counts[name] else None
+    record['flops_per_ivp_step'] = flops / ivp_steps
+    record['bytes_per_ivp_step'] = sums['dram__bytes.sum'] / ivp_steps
+    record['arithmetic_intensity'] = flops / sums['dram__bytes.sum'] if sums['dram__bytes.sum'] else None
+    # achieved values replace the theoretical occupancy of the record
+    for key, name, scale in [('occupancy', 'sm__warps_active.avg.pct_of_peak_sustained_active', 0.01),
+                             ('l1_hit_rate', 'l1tex__t_sector_hit_rate.pct', 0.01),
+                             ('l2_hit_rate', 'lts__t_sector_hit_rate.pct', 0.01),
+                             ('registers', 'launch__registers_per_thread', 1)]:
+        if counts[name]:
+            record[key] = mean(name) * scale
+    lines[-1] = json.dumps(record) + '\n'
+    with open(records, 'w') as file:
+        file.writelines(lines)
+
+
+def run(records, num_threads, num_cond, langs, trials, warmup,
+        blacklist=[], scons_args=[], build=True, sweep=False, step_sizes=[],
+        profile=False, launches=10):
+    """
+    Runs the sweep, appending the benchmark records to `records`
+    (a JSON lines file)
+    """
+    if os.path.isfile(records):
+        os.remove(records)
+    home = os.getcwd()
+    if build:
+        scons = subprocess.check_output('which scons', shell=True).strip()
+        args = ['-j', str(multiprocessing.cpu_count()),
+                'BENCHMARK_TRIALS={}'.format(trials),
+                'BENCHMARK_WARMUP={}'.format(warmup),
+                'BENCHMARK_OUTPUT={}'.format(os.path.abspath(records))]
+        if sweep:
+            args.append('PARAMETER_SWEEP=True')
+        if profile:
+            args.append('HW_COUNTERS=True')
+        targets = [t for t, l in [('cpu', 'c'), ('gpu', 'cuda')] if l in langs]
+        subprocess.check_call([scons] + targets + args + scons_args)
+
+    if sweep:
+        # one process per integrator, the initial conditions are read once
+        conds = ','.join(str(x) for x in num_cond)
+        steps = [','.join(str(x) for x in step_sizes)] if step_sizes else []
+        if 'c' in langs:
+            for exe in get_executables(blacklist, False, '-sweep'):
+                print(exe)
+                subprocess.check_call([os.path.join(home, exe),
+                                       ','.join(str(x) for x in num_threads), conds] + steps)
+        if 'cuda' in langs:
+            for exe in get_executables(blacklist, True, '-sweep'):
+                print(exe)
+                subprocess.check_call([os.path.join(home, exe), conds] + steps)
+        return
+
+    if 'c' in langs:
+        for exe in get_executables(blacklist, False):
+            for thread in num_threads:
+                for cond in num_cond:
+                    print(exe, thread, cond)
+                    subprocess.check_call([os.path.join(home, exe), str(thread), str(cond)])
+    if 'cuda' in langs:
+        for exe in get_executables(blacklist, True):
+            for cond in num_cond:
+                print(exe, cond)
+                subprocess.check_call([os.path.join(home, exe), str(cond)])
+                if profile:
+                    profile_gpu([os.path.join(home, exe), str(cond)], records, launches)
+
+
+def collect(records, output, profile=False):
+    """
+    Converts the JSON lines `records` into `output`.json and `output`.csv
+    """
+    with open(records, 'r') as file:
+        data = [json.loads(line) for line in file if line.strip()]
+    with open(output + '.json', 'w') as file:
+        json.dump(data, file, indent=2)
+    with open(output + '.csv', 'w') as file:
+        writer = csv.DictWriter(file, fieldnames=fields + (counter_fields if profile else []),
+                                extrasaction='ignore')
+        writer.writeheader()
+        for record in data:
+            writer.writerow(record)
+    return data
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='Benchmarks the integrators over a sweep of '
+                                        'thread counts and problem sizes')
+    parser.add_argument('-nt', '--num_threads',
+                        type=str,
+                        required=False,
+                        default='1',
+                        help='Comma separated list of # of threads to test with for CPU integrators')
+    parser.add_argument('-nc', '--num_cond',
+                        type=str,
+                        required=True,
+                        help='Comma separated list of # of IVPs to test with')
+    parser.add_argument('-l', '--langs',
+                        type=str,
+                        required=False,
+                        default='c,cuda',
+                        help='Comma separated list of languages to test.')
+    parser.add_argument('-s', '--solver_blacklist',
+                        required=False,
+                        default='',
+                        help='The solvers to not run')
+    parser.add_argument('-r', '--trials',
+                        type=int,
+                        required=False,
+                        default=10,
+                        help='The number of timed trials per run')
+    parser.add_argument('-w', '--warmup',
+                        type=int,
+                        required=False,
+                        default=1,
+                        help='The number of untimed warm-up trials per run')
+    parser.add_argument('-o', '--output',
+                        required=False,
+                        default='benchmark',
+                        help='The base name of the JSON / CSV output files')
+    parser.add_argument('--sweep',
+                        required=False,
+                        default=False,
+                        action='store_true',
+                        help='Run the whole sweep in a single process per integrator, '
+                             'using the [solver]-sweep executables')
+    parser.add_argument('-ts', '--step_sizes',
+                        type=str,
+                        required=False,
+                        default='',
+                        help='Comma separated list of global step sizes to test with '
+                             '(requires --sweep, defaults to the t_step option)')
+    parser.add_argument('--no_build',
+                        required=False,
+                        default=False,
+                        action='store_true',
+                        help='Do not rebuild the executables, these must have been built '
+                             'with BENCHMARK_OUTPUT set to the records file')
+    parser.add_argument('--profile',
+                        required=False,
+                        default=False,
+                        action='store_true',
+                        help='Build with HW_COUNTERS, and add the hardware counter metrics to the '
+                             'records (the GPU metrics by an additional Nsight Compute run)')
+    parser.add_argument('--launches',
+                        type=int,
+                        required=False,
+                        default=10,
+                        help='The number of driver kernel launches profiled per GPU run (with --profile)')
+    parser.add_argument('scons_args',
+                        nargs='*',
+                        help='Additional options passed to scons, e.g. mechanism_dir=...')
+    args = parser.parse_args()
+    if args.step_sizes and not args.sweep:
+        parser.error('step sizes can only be swept with --sweep')
+    if args.profile and args.sweep:
+        parser.error('the hardware counters are not collected by the sweep executables')
+
+    records = args.output + '.records'
+    run(records,
+        num_threads=[int(x) for x in args.num_threads.split(',') if x.strip()],
+        num_cond=[int(x) for x in args.num_cond.split(',') if x.strip()],
+        langs=[x.strip() for x in args.langs.split(',') if x.strip()],
+        trials=args.trials,
+        warmup=args.warmup,
+        blacklist=[x.strip() for x in args.solver_blacklist.split(',') if x.strip()],
+        scons_args=args.scons_args,
+        build=not args.no_build,
+        sweep=args.sweep,
+        step_sizes=[float(x) for x in args.step_sizes.split(',') if x.strip()],
+        profile=args.profile,
+        launches=args.launches)
+    data = collect(records, args.output, args.profile)
+    for record in data:
+        print('{solver}-{platform}\t{num_ivps}\t{num_threads}\tmedian: {median:.6e} s\t'
+              'p10: {p10:.6e} s\tp90: {p90:.6e} s'.format(**record))
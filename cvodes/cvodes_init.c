@@ -9,6 +9,8 @@
 #include "header.h"
 #include "solver_options.h"
 #include "cvodes_dydt.h"
+#include "cvodes_memory.h"
+#include "tolerances.h"
 
 #ifndef FINITE_DIFFERENCE
  	#include "cvodes_jac.h"
@@ -26,152 +28,215 @@
 namespace cvode {
 #endif
 
-/** The state vectors used in CVODE operation */
-N_Vector *y_locals;
-/** The base state vectors used in N_Vector creation */
-double* y_local_vectors;
-/** The stored CVODE integrator objects */
-void** integrators;
-
-/*! \fn void initialize_solver(int num_threads)
-   \brief Initializes the solver
-   \param num_threads The number of OpenMP threads to use
+/*!
+   \brief Creates and initializes a CVODE integrator
+   \param y_local The state vector of the integrator
+   \param atol_local The absolute tolerance vector of the integrator, set to the default tolerances
+   \return The CVODE integrator
 
    Various definitions in the generated options, e.g. #FINITE_DIFFERENCE, #CV_MAX_ERRTEST_FAILS,
    etc. affect the options set for the CVODEs solver. @see solver_options.h
+*/
+ void* create_cvodes_integrator(N_Vector y_local, N_Vector atol_local) {
+ 	ivp_tolerances defaults;
+ 	initialize_tolerances(&defaults);
+ 	double* atol = NV_DATA_S(atol_local);
+ 	for (int j = 0; j < NSP; ++j)
+ 		atol[j] = defaults.atol[j];
+
+ 	void* integrator = CVodeCreate(CV_BDF, CV_NEWTON);
+ 	if (integrator == NULL)
+ 	{
+ 		printf("Error creating CVodes Integrator\n");
+ 		exit(-1);
+ 	}
+
+	//initialize
+	int flag = CVodeInit(integrator, dydt_cvodes, 0, y_local);
+	if (flag != CV_SUCCESS) {
+	    if (flag == CV_MEM_FAIL) {
+	        printf("Memory allocation failed.\n");
+	    } else if (flag == CV_ILL_INPUT) {
+	        printf("Illegal value for CVodeInit input argument.\n");
+        } else if (flag == CV_MEM_NULL) {
+        	printf("CVODEs Memory was not initialized with CVodeInit!\n");
+	    }
+	    exit(flag);
+	}
+
+	//set tolerances
+	flag = CVodeSVtolerances(integrator, defaults.rtol, atol_local);
+	if (flag != CV_SUCCESS) {
+	    if (flag == CV_NO_MALLOC) {
+	        printf("CVODE memory block not initialized by CVodeCreate.\n");
+	    } else if (flag == CV_ILL_INPUT) {
+	        printf("Illegal value for CVodeInit input argument.\n");
+        } else if (flag == CV_MEM_NULL) {
+        	printf("CVODEs Memory was not initialized with CVodeInit!\n");
+	    }
+	    exit(flag);
+	}
+
+	//setup the solver
+    flag = CVLapackDense(integrator, NSP);
+	if (flag != CVDLS_SUCCESS) {
+	    if (flag == CVDLS_MEM_FAIL) {
+	        printf("CVODE memory block not initialized by CVodeCreate.\n");
+	    } else if (flag == CVDLS_ILL_INPUT) {
+	        printf("Illegal value for CVodeInit input argument.\n");
+        } else if (flag == CVDLS_MEM_NULL) {
+        	printf("CVODEs Memory was not initialized with CVodeInit!\n");
+	    }
+	    exit(flag);
+	}
+
+    #ifndef FINITE_DIFFERENCE
+    	flag = CVDlsSetDenseJacFn(integrator, eval_jacob_cvodes);
+    	if (flag != CV_SUCCESS) {
+	    	printf("Error setting analytic jacobian\n");
+	    	exit(flag);
+    	}
+    #endif
+
+    #ifdef CV_MAX_ORD
+        flag = CVodeSetMaxOrd(integrator, CV_MAX_ORD);
+        if (flag != CV_SUCCESS) {
+	    	printf("Error setting max order\n");
+	    	exit(flag);
+    	}
+    #endif
+
+    #ifdef CV_MAX_STEPS
+        flag = CVodeSetMaxNumSteps(integrator, CV_MAX_STEPS);
+        if (flag != CV_SUCCESS) {
+	    	printf("Error setting max steps\n");
+	    	exit(flag);
+    	}
+    #endif
+
+    #ifdef CV_HMAX
+        flag = CVodeSetMaxStep(integrator, CV_HMAX);
+        if (flag != CV_SUCCESS) {
+	    	printf("Error setting max timestep\n");
+	    	exit(flag);
+    	}
+    #endif
+    #ifdef CV_HMIN
+        flag = CVodeSetMinStep(integrator, CV_HMIN);
+        if (flag != CV_SUCCESS) {
+	    	printf("Error setting min timestep\n");
+	    	exit(flag);
+    	}
+    #endif
+    #ifdef CV_MAX_ERRTEST_FAILS
+        flag = CVodeSetMaxErrTestFails(integrator, CV_MAX_ERRTEST_FAILS);
+        if (flag != CV_SUCCESS) {
+	    	printf("Error setting max error test fails\n");
+	    	exit(flag);
+    	}
+    #endif
+    #ifdef CV_MAX_HNIL
+        flag = CVodeSetMaxHnilWarns(integrator, CV_MAX_HNIL);
+        if (flag != CV_SUCCESS) {
+	    	printf("Error setting max hnil warnings\n");
+	    	exit(flag);
+    	}
+    #endif
+ 	return integrator;
+ }
+
+/*! \fn void* initialize_solver(int num_threads)
+   \brief Initializes the solver
+   \param num_threads The number of OpenMP threads to use
+   \return The (cvodes_memory) integrators of each thread
 
    The RHS function dydt_cvodes() will be used in the solver.
 
    If #FINITE_DIFFERENCE is not defined, the jacobian function in eval_jacob_cvodes
    will be used in the CVODE solver.  Else, the CVODE finite difference based on the
    RHS function will be used.
+
+   The tolerances set here are the defaults, the driver sets those of each IVP before integration. @see tolerances.h
+
+   If #NUMA_FIRST_TOUCH is defined, the integrator of each thread is created by that thread, such that
+   its memory is placed on the NUMA node of the thread. @see numa_placement.h
+
+   If #CV_CONTINUE is defined, each thread additionally gets a pool of #CV_POOL_SIZE (empty) entries,
+   whose integrators are created on first use. @see cvodes_pool
 */
- void initialize_solver(int num_threads) {
- 	y_locals = (N_Vector*)malloc(num_threads * sizeof(N_Vector));
- 	y_local_vectors = (double*)calloc(num_threads * NSP, sizeof(double));
- 	integrators = (void**)malloc(num_threads * sizeof(void*));
+ void* initialize_solver(int num_threads) {
+ 	cvodes_memory* memory = (cvodes_memory*)malloc(sizeof(cvodes_memory));
+ 	N_Vector* y_locals = memory->y_locals = (N_Vector*)malloc(num_threads * sizeof(N_Vector));
+ 	double* y_local_vectors = memory->y_local_vectors = (double*)calloc(num_threads * NSP, sizeof(double));
+ 	void** integrators = memory->integrators = (void**)malloc(num_threads * sizeof(void*));
+ 	N_Vector* atol_locals = memory->atol_locals = (N_Vector*)malloc(num_threads * sizeof(N_Vector));
+ 	double* atol_local_vectors = memory->atol_local_vectors = (double*)malloc(num_threads * NSP * sizeof(double));
 
+#ifdef NUMA_FIRST_TOUCH
+	// iteration i runs on thread i
+	#pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+#endif
  	for (int i = 0; i < num_threads; i++)
 	{
-		integrators[i] = CVodeCreate(CV_BDF, CV_NEWTON);
 		y_locals[i] = N_VMake_Serial(NSP, &y_local_vectors[i * NSP]);
-		if (integrators[i] == NULL)
-		{
-			printf("Error creating CVodes Integrator\n");
-			exit(-1);
-		}
-
-		//initialize
-		int flag = CVodeInit(integrators[i], dydt_cvodes, 0, y_locals[i]);
-		if (flag != CV_SUCCESS) {
-		    if (flag == CV_MEM_FAIL) {
-		        printf("Memory allocation failed.\n");
-		    } else if (flag == CV_ILL_INPUT) {
-		        printf("Illegal value for CVodeInit input argument.\n");
-	        } else if (flag == CV_MEM_NULL) {
-	        	printf("CVODEs Memory was not initialized with CVodeInit!\n");
-		    }
-		    exit(flag);
-		}
-
-		//set tolerances
-		flag = CVodeSStolerances(integrators[i], RTOL, ATOL);
-		if (flag != CV_SUCCESS) {
-		    if (flag == CV_NO_MALLOC) {
-		        printf("CVODE memory block not initialized by CVodeCreate.\n");
-		    } else if (flag == CV_ILL_INPUT) {
-		        printf("Illegal value for CVodeInit input argument.\n");
-	        } else if (flag == CV_MEM_NULL) {
-	        	printf("CVODEs Memory was not initialized with CVodeInit!\n");
-		    }
-		    exit(flag);
-		}
-
-    	//setup the solver
-	    flag = CVLapackDense(integrators[i], NSP);
-		if (flag != CVDLS_SUCCESS) {
-		    if (flag == CVDLS_MEM_FAIL) {
-		        printf("CVODE memory block not initialized by CVodeCreate.\n");
-		    } else if (flag == CVDLS_ILL_INPUT) {
-		        printf("Illegal value for CVodeInit input argument.\n");
-	        } else if (flag == CVDLS_MEM_NULL) {
-	        	printf("CVODEs Memory was not initialized with CVodeInit!\n");
-		    }
-		    exit(flag);
-		}
-
-	    #ifndef FINITE_DIFFERENCE
-	    	flag = CVDlsSetDenseJacFn(integrators[i], eval_jacob_cvodes);
-	    	if (flag != CV_SUCCESS) {
-		    	printf("Error setting analytic jacobian\n");
-		    	exit(flag);
-	    	}
-	    #endif
-
-	    #ifdef CV_MAX_ORD
-	        CVodeSetMaxOrd(integrators[i], CV_MAX_ORD);
-	        if (flag != CV_SUCCESS) {
-		    	printf("Error setting max order\n");
-		    	exit(flag);
-	    	}
-	    #endif
-
-	    #ifdef CV_MAX_STEPS
-	        CVodeSetMaxNumSteps(integrators[i], CV_MAX_STEPS);
-	        if (flag != CV_SUCCESS) {
-		    	printf("Error setting max steps\n");
-		    	exit(flag);
-	    	}
-	    #endif
-
-	    #ifdef CV_HMAX
-	        CVodeSetMaxStep(integrators[i], CV_HMAX);
-	        if (flag != CV_SUCCESS) {
-		    	printf("Error setting max timestep\n");
-		    	exit(flag);
-	    	}
-	    #endif
-	    #ifdef CV_HMIN
-	        CVodeSetMinStep(integrators[i], CV_HMIN);
-	        if (flag != CV_SUCCESS) {
-		    	printf("Error setting min timestep\n");
-		    	exit(flag);
-	    	}
-	    #endif
-	    #ifdef CV_MAX_ERRTEST_FAILS
-	        CVodeSetMaxErrTestFails(integrators[i], CV_MAX_ERRTEST_FAILS);
-	        if (flag != CV_SUCCESS) {
-		    	printf("Error setting max error test fails\n");
-		    	exit(flag);
-	    	}
-	    #endif
-	    #ifdef CV_MAX_HNIL
-	        CVodeSetMaxHnilWarns(integrators[i], CV_MAX_HNIL);
-	        if (flag != CV_SUCCESS) {
-		    	printf("Error setting max hnil warnings\n");
-		    	exit(flag);
-	    	}
-	    #endif
+		atol_locals[i] = N_VMake_Serial(NSP, &atol_local_vectors[i * NSP]);
+		integrators[i] = create_cvodes_integrator(y_locals[i], atol_locals[i]);
 	}
+#ifdef CV_CONTINUE
+	memory->pools = (cvodes_pool*)malloc(num_threads * sizeof(cvodes_pool));
+#ifdef NUMA_FIRST_TOUCH
+	#pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+#endif
+	for (int i = 0; i < num_threads; i++)
+	{
+		memory->pools[i].entries = (cvodes_entry*)calloc(CV_POOL_SIZE, sizeof(cvodes_entry));
+		memory->pools[i].clock = 0;
+		for (int j = 0; j < CV_POOL_SIZE; ++j)
+			memory->pools[i].entries[j].tid = -1;
+	}
+#endif
+ 	return memory;
  }
 
 /*!
-   \fn void cleanup_solver(int num_threads)
+   \fn void cleanup_solver(int num_threads, void* memory)
    \brief Cleans up the created solvers
    \param num_threads The number of OpenMP threads used
+   \param memory The integrators returned by initialize_solver
 
    Frees and cleans up allocated CVODE memory.
 */
- void cleanup_solver(int num_threads) {
+ void cleanup_solver(int num_threads, void* memory) {
+ 	cvodes_memory* cv_mem = (cvodes_memory*)memory;
  	//free the integrators and nvectors
 	for (int i = 0; i < num_threads; i++)
 	{
-		CVodeFree(&integrators[i]);
-		N_VDestroy(y_locals[i]);
+		CVodeFree(&cv_mem->integrators[i]);
+		N_VDestroy(cv_mem->y_locals[i]);
+		N_VDestroy(cv_mem->atol_locals[i]);
 	}
-	free(y_locals);
-	free(y_local_vectors);
-	free(integrators);
+#ifdef CV_CONTINUE
+	for (int i = 0; i < num_threads; i++)
+	{
+		for (int j = 0; j < CV_POOL_SIZE; ++j)
+		{
+			cvodes_entry* entry = &cv_mem->pools[i].entries[j];
+			if (entry->integrator == NULL)
+				continue;
+			CVodeFree(&entry->integrator);
+			N_VDestroy(entry->y);
+			N_VDestroy(entry->atol);
+		}
+		free(cv_mem->pools[i].entries);
+	}
+	free(cv_mem->pools);
+#endif
+	free(cv_mem->y_locals);
+	free(cv_mem->y_local_vectors);
+	free(cv_mem->atol_locals);
+	free(cv_mem->atol_local_vectors);
+	free(cv_mem->integrators);
+	free(cv_mem);
  }
 
 /*!
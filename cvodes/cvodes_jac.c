@@ -7,12 +7,20 @@
 
 /*!
 This function converts the N_Vectors `y` and `y_dot` to simple double pointers, the user data `f` to a double
-and outputs the Jacobian supplied by `eval_jacob` to the CVODE jacobian `jac`
+and outputs the Jacobian supplied by `eval_jacob` to the CVODE jacobian `jac`.
+If #SPARSE_JACOBIAN is defined, the compressed Jacobian is scattered into the (dense) CVODE jacobian.
 Currently, CV_SUCCESS is always returned.
 */
 int eval_jacob_cvodes(long int N, double t, N_Vector y, N_Vector ydot, DlsMat jac, void* f, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
 {
 	double* local_y = NV_DATA_S(y);
+#ifdef SPARSE_JACOBIAN
+	double values[JAC_SIZE];
+	eval_jacob((double)t, *(double*)f, local_y, values);
+	SetToZero(jac);
+	jacobian_scatter_add(values, 1.0, (double*)jac->data, (int)jac->ldim);
+#else
 	eval_jacob((double)t, *(double*)f, local_y, (double*)jac->data);
+#endif
 	return 0;
 }
\ No newline at end of file
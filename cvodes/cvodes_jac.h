@@ -12,6 +12,7 @@
 #include "sundials/sundials_direct.h"
 #include "nvector/nvector_serial.h"
 #include "jacob.h"
+#include "sparse_jacobian.h"
 
 /*!
    \brief The CVODEs Jacobian interface for a direct dense Jacobian
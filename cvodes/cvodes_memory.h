@@ -0,0 +1,88 @@
+/*! \file cvodes_memory.h
+    \brief Header file for the per-thread CVODE integrator memory of a solver instance
+
+    Returned by initialize_solver, and passed to intDriver via accelerInt_context::solver
+*/
+#ifndef CVODES_MEMORY_HEAD
+#define CVODES_MEMORY_HEAD
+
+#include "header.h"
+#include "solver_options.h"
+#include "sundials/sundials_nvector.h"
+#include "nvector/nvector_serial.h"
+
+//! The number of CVODE counters stored in the statistics, @see STATISTICS
+#define NUM_CV_COUNTERS (6)
+
+#ifdef CV_CONTINUE
+
+#ifndef CV_POOL_SIZE
+//! The number of continued CVODE integrators kept per thread
+#define CV_POOL_SIZE (64)
+#endif
+
+/*! \brief A CVODE integrator kept for the continued integration of one IVP
+
+    The integrator continues (without CVodeReInit) from its last output if the IVP is integrated
+    from the time, state and pressure of the last output, @see CV_CONTINUE
+*/
+typedef struct
+{
+	/** The IVP last integrated by this entry, -1 if none */
+	int tid;
+	/** The time the IVP was last integrated to */
+	double t;
+	/** The pressure of the IVP, the user data of the integrator */
+	double pr;
+	/** The time of the last use of this entry, in calls to the pool */
+	unsigned long used;
+	/** The CVODE counters after the last integration */
+	long int counters[NUM_CV_COUNTERS];
+	/** The state vector, holds the last output of the integrator */
+	N_Vector y;
+	/** The absolute tolerance vector */
+	N_Vector atol;
+	/** The CVODE integrator, NULL until first used */
+	void* integrator;
+} cvodes_entry;
+
+/*! \brief The least recently used pool of continued CVODE integrators of a thread
+*/
+typedef struct
+{
+	/** The (#CV_POOL_SIZE) entries */
+	cvodes_entry* entries;
+	/** The number of lookups in this pool */
+	unsigned long clock;
+} cvodes_pool;
+
+#endif
+
+/*! \brief The per-thread CVODE integrator memory of a solver instance
+*/
+typedef struct
+{
+	/** The state vectors used in CVODE operation */
+	N_Vector *y_locals;
+	/** The base state vectors used in N_Vector creation */
+	double* y_local_vectors;
+	/** The absolute tolerance vectors of the IVP currently integrated by each thread */
+	N_Vector *atol_locals;
+	/** The base absolute tolerance vectors used in N_Vector creation */
+	double* atol_local_vectors;
+	/** The stored CVODE integrator objects */
+	void** integrators;
+#ifdef CV_CONTINUE
+	/** The pools of continued integrators of each thread */
+	cvodes_pool* pools;
+#endif
+} cvodes_memory;
+
+/*! \brief Creates and initializes a CVODE integrator
+    \param y_local The state vector of the integrator
+    \param atol_local The absolute tolerance vector of the integrator, set to the default tolerances
+    \return The CVODE integrator
+*/
+void* create_cvodes_integrator(N_Vector y_local, N_Vector atol_local);
+
+#endif
@@ -7,8 +7,13 @@
  *
  */
 
+#include <stdbool.h>
+#include <string.h>
 #include "header.h"
 #include "solver.h"
+#include "solver_context.h"
+#include "state_layout.h"
+#include "cvodes_memory.h"
 
 /* CVODES INCLUDES */
 #include "sundials/sundials_types.h"
@@ -18,32 +23,333 @@
 #include "cvodes/cvodes.h"
 #include "cvodes/cvodes_lapack.h"
 
-extern N_Vector *y_locals;
-extern double* y_local_vectors;
-extern void** integrators;
-
 #ifdef GENERATE_DOCS
 namespace cvode {
 #endif
 
 /**
- * \brief Integration driver for the CPU integrators
+ * \brief Integrates the state `fill` of the current IVP from `t` to `t_end`, with the tolerances and user data already set
+ * \param[in]       integrator  the CVODE integrator of this thread
+ * \param[in]       tid         the IVP index
+ * \param[in]       t           the current IVP time
+ * \param[in]       t_end       the time to integrate the IVP to
+ * \param[in,out]   fill        the state vector of the IVP
+ * \return                      zero on success, otherwise the CVODE error flag
+ */
+static int cvodes_integrate (void* integrator, const int tid, const double t, const double t_end, N_Vector fill)
+{
+    //reinit this integrator for time t, w/ updated state
+    int flag = CVodeReInit(integrator, t, fill);
+    if (flag != CV_SUCCESS)
+    {
+        printf("Error reinitializing integrator for thread %d, code: %d\n", tid, flag);
+        exit(flag);
+    }
+
+    //set end time
+    flag = CVodeSetStopTime(integrator, t_end);
+    if (flag != CV_SUCCESS)
+    {
+        printf("Error setting end time for thread %d, code: %d\n", tid, flag);
+        exit(flag);
+    }
+
+    // call integrator for one time step
+    double t_next;
+    flag = CVode(integrator, t_end, fill, &t_next, CV_NORMAL);
+    if ((flag != CV_SUCCESS && flag != CV_TSTOP_RETURN) || t_next != t_end)
+    {
+        return flag < 0 ? flag : -1;
+    }
+    return 0;
+}
+
+#ifdef CV_CONTINUE
+/**
+ * \brief Returns the entry of the pool of this thread to integrate IVP `tid` with
+ * \param[in,out]   pool        the pool of continued integrators of this thread
+ * \param[in]       tid         the IVP index
+ * \return                      the entry that last integrated IVP `tid` if any, else the least recently used entry
+ *
+ * The integrator of an unused entry is created here.
+ */
+static cvodes_entry* get_cvodes_entry (cvodes_pool* pool, const int tid)
+{
+    cvodes_entry* entry = &pool->entries[0];
+    for (int j = 0; j < CV_POOL_SIZE; ++j)
+    {
+        if (pool->entries[j].tid == tid)
+        {
+            entry = &pool->entries[j];
+            break;
+        }
+        if (pool->entries[j].used < entry->used)
+            entry = &pool->entries[j];
+    }
+    entry->used = ++pool->clock;
+    if (entry->integrator == NULL)
+    {
+        entry->y = N_VNew_Serial(NSP);
+        entry->atol = N_VNew_Serial(NSP);
+        entry->integrator = create_cvodes_integrator(entry->y, entry->atol);
+    }
+    return entry;
+}
+
+/**
+ * \brief Integrates IVP `tid` from `t` to `t_end` with a continued integrator, with the tolerances and user data already set
+ * \param[in,out]   entry       the pool entry of the IVP, whose state vector holds the state at `t`
+ * \param[in]       tid         the IVP index
+ * \param[in]       t           the current IVP time
+ * \param[in]       t_end       the time to integrate the IVP to
+ * \param[in]       resume      true if the integrator continues from its last output, i.e. at `t` with this state
+ * \return                      zero on success, otherwise the CVODE error flag
+ *
+ * No stop time is set, such that CVODE steps past `t_end` as its error control allows, and
+ * returns the state at `t_end` interpolated from its history.  The next call continues from
+ * the internal state of CVODE (with its order, step size and Jacobian), rather than restarting
+ * at first order with a small step.
+ */
+static int cvodes_continue (cvodes_entry* entry, const int tid, const double t, const double t_end, const bool resume)
+{
+    if (!resume)
+    {
+        int flag = CVodeReInit(entry->integrator, t, entry->y);
+        if (flag != CV_SUCCESS)
+        {
+            printf("Error reinitializing integrator for thread %d, code: %d\n", tid, flag);
+            exit(flag);
+        }
+        memset(entry->counters, 0, NUM_CV_COUNTERS * sizeof(long int));
+    }
+
+    double t_next;
+    int flag = CVode(entry->integrator, t_end, entry->y, &t_next, CV_NORMAL);
+    if (flag != CV_SUCCESS || t_next != t_end)
+    {
+        // the integrator is restarted on the next call
+        entry->tid = -1;
+        return flag < 0 ? flag : -1;
+    }
+    entry->tid = tid;
+    entry->t = t_end;
+    return 0;
+}
+#endif
+
+#ifdef STATISTICS
+/**
+ * \brief Adds the CVODE counters of the last integration to the statistics of IVP `tid`
+ * \param[in]       integrator  the CVODE integrator
+ * \param[in,out]   context     the solver instance
+ * \param[in]       tid         the IVP index
+ * \param[in,out]   last        the counters after the previous integration of the integrator, updated here,
+ *                              or NULL if the counters were reset by CVodeReInit (i.e. are per call)
+ */
+static void store_cvodes_counters (void* integrator, accelerInt_context* context, const int tid, long int* last)
+{
+    long int counts[NUM_CV_COUNTERS] = {0};
+    CVodeGetNumSteps(integrator, &counts[0]);
+    CVodeGetNumErrTestFails(integrator, &counts[1]);
+    CVodeGetNumNonlinSolvConvFails(integrator, &counts[2]);
+    CVDlsGetNumJacEvals(integrator, &counts[3]);
+    CVodeGetNumLinSolvSetups(integrator, &counts[4]);
+    CVodeGetNumNonlinSolvIters(integrator, &counts[5]);
+    long int delta[NUM_CV_COUNTERS];
+    for (int i = 0; i < NUM_CV_COUNTERS; ++i)
+    {
+        delta[i] = counts[i] - (last != NULL ? last[i] : 0);
+        if (last != NULL)
+            last[i] = counts[i];
+    }
+    clear_counters();
+    STAT_ADD(STAT_STEPS, (int)delta[0]);
+    STAT_ADD(STAT_REJECTED, (int)(delta[1] + delta[2]));
+    STAT_ADD(STAT_JAC_EVALS, (int)delta[3]);
+    STAT_ADD(STAT_LU_DECOMPS, (int)delta[4]);
+    STAT_ADD(STAT_NEWTON_ITERS, (int)delta[5]);
+    store_counters(&context->stats, tid);
+}
+#endif
+
+/**
+ * \brief Sets the tolerances and user data of IVP `tid` on the integrator of this thread
+ * \param[in]       context     the solver instance
+ * \param[in]       integrator  the CVODE integrator of this thread
+ * \param[in,out]   atol_local  the absolute tolerance vector of this thread
+ * \param[in]       tid         the IVP index
+ * \param[in]       pr_local    the pressure of the IVP, must remain valid while integrating
+ */
+static void cvodes_setup (const accelerInt_context* context, void* integrator, N_Vector atol_local,
+                          const int tid, double* pr_local)
+{
+    //set the tolerances of this IVP
+    load_tolerances(&context->tol, context->tol_scale, tid, &current_tolerances);
+    double* atol = NV_DATA_S(atol_local);
+    for (int i = 0; i < NSP; i++)
+    {
+        atol[i] = current_tolerances.atol[i];
+    }
+    int flag = CVodeSVtolerances(integrator, current_tolerances.rtol, atol_local);
+    if (flag != CV_SUCCESS)
+    {
+        printf("Error setting tolerances for thread %d, code: %d\n", tid, flag);
+        exit(flag);
+    }
+
+    //set user data to Pr
+    flag = CVodeSetUserData(integrator, pr_local);
+    if (flag != CV_SUCCESS)
+    {
+        printf("Error setting user data for thread %d, code: %d\n", tid, flag);
+        exit(flag);
+    }
+}
+
+#ifdef FAILURE_RETRY
+/**
+ * \brief Re-integrates the IVPs queued by the current integration step, @see failure_retry.h
+ * \param[in,out]   context     the solver instance
  * \param[in]       NUM         the number of IVPs to solve
  * \param[in]       t           the current IVP time
  * \param[in]       t_end       the time to integrate the IVP to
+ * \param[in]       t_local     the per-IVP current times, or NULL if all IVPs are at `t`
+ * \param[in]       t_end_local the per-IVP end times, or NULL if all IVPs end at `t_end`
+ * \param[in]       pr_global   the pressure value for the IVPs
+ * \param[in, out]  y_global    the state vectors, the queued IVPs at time t
+ *
+ * Each queued IVP is restarted from its state at `t` over #FAILURE_RETRY_SPLITS equal sub-intervals,
+ * such that CVODE estimates the initial step size for, and limits the step count (#CV_MAX_STEPS) to,
+ * each sub-interval.  IVPs that fail again are left at time `t`.
+ */
+static void retry_failures (accelerInt_context* context, const int NUM, const double t, const double t_end,
+                            const double* t_local, const double* t_end_local,
+                            const double *pr_global, double *y_global)
+{
+    const cvodes_memory* memory = (const cvodes_memory*)context->solver;
+    failure_storage* failures = &context->failures;
+    const int num_queued = failures->num_queued;
+    int q;
+    #pragma omp parallel for shared(y_global, pr_global, failures) private(q) schedule(dynamic) num_threads(context->num_threads)
+    for (q = 0; q < num_queued; ++q) {
+        const int tid = failures->queue[q];
+        int index = omp_get_thread_num();
+        void* integrator = memory->integrators[index];
+        N_Vector fill = memory->y_locals[index];
+        double pr_local = pr_global[tid];
+        double* y_local = NV_DATA_S(fill);
+        for (int i = 0; i < NSP; i++)
+        {
+            y_local[i] = y_global[state_index(tid, i, NUM)];
+        }
+        cvodes_setup(context, integrator, memory->atol_locals[index], tid, &pr_local);
+
+        const double t_ivp = ivp_time(t_local, t, tid);
+        const double t_end_ivp = ivp_time(t_end_local, t_end, tid);
+        int code = 0;
+        for (int s = 0; s < FAILURE_RETRY_SPLITS && code == 0; ++s)
+        {
+            const double t_s = t_ivp + s * (t_end_ivp - t_ivp) / FAILURE_RETRY_SPLITS;
+            const double t_e = s + 1 == FAILURE_RETRY_SPLITS ? t_end_ivp :
+                               t_ivp + (s + 1) * (t_end_ivp - t_ivp) / FAILURE_RETRY_SPLITS;
+            code = cvodes_integrate(integrator, tid, t_s, t_e, fill);
+#ifdef STATISTICS
+            store_cvodes_counters(integrator, context, tid, NULL);
+#endif
+        }
+        record_retry(failures, tid, code);
+        if (code != 0)
+            continue;
+
+        for (int i = 0; i < NSP; i++)
+        {
+            y_global[state_index(tid, i, NUM)] = y_local[i];
+        }
+    }
+    failures->num_queued = 0;
+}
+#endif
+
+/**
+ * \brief Integration driver for the CPU integrators, @see intDriver and intDriverLocal
+ * \param[in,out]   context     the solver instance, whose accelerInt_context::solver holds the cvodes_memory
+ * \param[in]       NUM         the number of IVPs to solve
+ * \param[in]       t           the current IVP time
+ * \param[in]       t_end       the time to integrate the IVP to
+ * \param[in]       t_local     the per-IVP current times, or NULL if all IVPs are at `t`
+ * \param[in]       t_end_local the per-IVP end times, or NULL if all IVPs end at `t_end`
  * \param[in]       pr_global   the pressure value for the IVPs
  * \param[in, out]  y_global    the state vectors
  *
  * The integration driver for the CVODEs solver
+ *
+ * The OpenMP schedule is controlled by #SCHEDULE_CLAUSE.  If #COST_REORDER is defined
+ * the IVPs are issued in order of descending cost measured on the previous call.
+ * The tolerances of each IVP (see tolerances.h) are set on the integrator before each integration.
+ *
+ * If #FAILURE_RETRY is defined, the failed IVPs are queued and re-integrated once all other IVPs
+ * are done, rather than exiting the program, @see retry_failures
+ *
+ * If #CV_CONTINUE is defined, each IVP is integrated by an integrator of the pool of the thread
+ * (@see get_cvodes_entry), which continues from its last output if the IVP is at the time, state and
+ * pressure of that output, and is reinitialized otherwise (e.g. if the caller changed the state, or the
+ * IVP was last integrated by another thread or evicted).  With the static schedule, and at most
+ * #CV_POOL_SIZE IVPs per thread, every integration after the first continues.
  */
-void intDriver (const int NUM, const double t, const double t_end,
-                const double *pr_global, double *y_global)
+static void drive (accelerInt_context* context, const int NUM, const double t, const double t_end,
+                   const double* t_local, const double* t_end_local,
+                   const double *pr_global, double *y_global)
 {
-    int tid;
-    double t_next;
-    #pragma omp parallel for shared(y_global, pr_global, integrators, y_locals) private(tid, t_next)
-    for (tid = 0; tid < NUM; ++tid) {
+#ifdef COST_REORDER
+    const int* order = get_ivp_order(&context->order, NUM);
+#endif
+    const cvodes_memory* memory = (const cvodes_memory*)context->solver;
+#ifdef CV_CONTINUE
+    cvodes_pool* pools = memory->pools;
+#else
+    void** integrators = memory->integrators;
+    N_Vector* y_locals = memory->y_locals;
+    N_Vector* atol_locals = memory->atol_locals;
+#endif
+#ifdef FAILURE_RETRY
+    if (context->failures.num != NUM)
+        reset_failures(&context->failures, NUM);
+#endif
+    int k;
+#ifdef CV_CONTINUE
+    #pragma omp parallel for shared(y_global, pr_global, pools) private(k) SCHEDULE_CLAUSE num_threads(context->num_threads)
+#else
+    #pragma omp parallel for shared(y_global, pr_global, integrators, y_locals, atol_locals) private(k) SCHEDULE_CLAUSE num_threads(context->num_threads)
+#endif
+    for (k = 0; k < NUM; ++k) {
+#ifdef COST_REORDER
+        int tid = order[k];
+        double cost_start = COST_TIMER();
+#else
+        int tid = k;
+#endif
         int index = omp_get_thread_num();
+        const double t_ivp = ivp_time(t_local, t, tid);
+        const double t_end_ivp = ivp_time(t_end_local, t_end, tid);
+
+#ifdef CV_CONTINUE
+        cvodes_entry* entry = get_cvodes_entry(&pools[index], tid);
+        void* integrator = entry->integrator;
+        double* y_local = NV_DATA_S(entry->y);
+        // continue if the IVP is where the integrator left it
+        bool resume = entry->tid == tid && entry->t == t_ivp && entry->pr == pr_global[tid];
+        for (int i = 0; i < NSP; i++)
+        {
+            resume = resume && y_local[i] == y_global[state_index(tid, i, NUM)];
+            y_local[i] = y_global[state_index(tid, i, NUM)];
+        }
+        entry->pr = pr_global[tid];
+
+        cvodes_setup(context, integrator, entry->atol, tid, &entry->pr);
+
+        int code = cvodes_continue(entry, tid, t_ivp, t_end_ivp, resume);
+#else
+        void* integrator = integrators[index];
 
         // local array with initial values
         N_Vector fill = y_locals[index];
@@ -54,50 +360,87 @@ void intDriver (const int NUM, const double t, const double t_end,
 
         for (int i = 0; i < NSP; i++)
         {
-            y_local[i] = y_global[tid + i * NUM];
-        }
-
-        //reinit this integrator for time t, w/ updated state
-        int flag = CVodeReInit(integrators[index], t, fill);
-        if (flag != CV_SUCCESS)
-        {
-            printf("Error reinitializing integrator for thread %d, code: %d\n", tid, flag);
-            exit(flag);
+            y_local[i] = y_global[state_index(tid, i, NUM)];
         }
 
-        //set user data to Pr
-        flag = CVodeSetUserData(integrators[index], &pr_local);
-        if (flag != CV_SUCCESS)
-        {
-            printf("Error setting user data for thread %d, code: %d\n", tid, flag);
-            exit(flag);
-        }
+        cvodes_setup(context, integrator, atol_locals[index], tid, &pr_local);
 
-        //set end time
-        flag = CVodeSetStopTime(integrators[index], t_end);
-        if (flag != CV_SUCCESS)
+        int code = cvodes_integrate(integrator, tid, t_ivp, t_end_ivp, fill);
+#endif
+#ifndef FAILURE_RETRY
+        if (code != 0)
         {
-            printf("Error setting end time for thread %d, code: %d\n", tid, flag);
-            exit(flag);
+            printf("Error on integration step for thread %d, code %d\n", tid, code);
+            exit(code);
         }
+#endif
 
-        // call integrator for one time step
-        flag = CVode(integrators[index], t_end, fill, &t_next, CV_NORMAL);
-        if ((flag != CV_SUCCESS && flag != CV_TSTOP_RETURN) || t_next != t_end)
-        {
-            printf("Error on integration step for thread %d, code %d\n", tid, flag);
-            exit(flag);
-        }
+#ifdef STATISTICS
+    #ifdef CV_CONTINUE
+        store_cvodes_counters(integrator, context, tid, entry->counters);
+    #else
+        store_cvodes_counters(integrator, context, tid, NULL);
+    #endif
+#endif
 
+#ifdef FAILURE_RETRY
+        // a failed IVP is restarted from its initial state, which is still in y_global
+        if (code != 0)
+            queue_failure(&context->failures, tid);
+        else
+#endif
         // update global array with integrated values
         for (int i = 0; i < NSP; i++)
         {
-            y_global[tid + i * NUM] = y_local[i];
+            y_global[state_index(tid, i, NUM)] = y_local[i];
         }
+#ifdef COST_REORDER
+        record_ivp_cost(&context->order, tid, COST_TIMER() - cost_start);
+#endif
 
     } // end tid loop
+#ifdef FAILURE_RETRY
+    retry_failures(context, NUM, t, t_end, t_local, t_end_local, pr_global, y_global);
+#endif
+#ifdef COST_REORDER
+    update_ivp_order(&context->order, NUM);
+#endif
 
-} // end intDriver
+} // end drive
+
+/**
+ * \brief Integration driver for the CPU integrators
+ * \param[in,out]   context     the solver instance, whose accelerInt_context::solver holds the cvodes_memory
+ * \param[in]       NUM         the number of IVPs to solve
+ * \param[in]       t           the current IVP time
+ * \param[in]       t_end       the time to integrate the IVP to
+ * \param[in]       pr_global   the pressure value for the IVPs
+ * \param[in, out]  y_global    the state vectors
+ *
+ * @see drive
+ */
+void intDriver (accelerInt_context* context, const int NUM, const double t, const double t_end,
+                const double *pr_global, double *y_global)
+{
+    drive(context, NUM, t, t_end, NULL, NULL, pr_global, y_global);
+}
+
+/**
+ * \brief Integration driver for the CPU integrators, with per-IVP integration intervals
+ * \param[in,out]   context     the solver instance, whose accelerInt_context::solver holds the cvodes_memory
+ * \param[in]       NUM         the number of IVPs to solve
+ * \param[in]       t_local     the (NUM) current times of the IVPs
+ * \param[in]       t_end_local the (NUM) times to integrate the IVPs to
+ * \param[in]       pr_global   the pressure value for the IVPs
+ * \param[in, out]  y_global    the state vectors
+ *
+ * @see drive
+ */
+void intDriverLocal (accelerInt_context* context, const int NUM, const double* t_local, const double* t_end_local,
+                     const double *pr_global, double *y_global)
+{
+    drive(context, NUM, 0, 0, t_local, t_end_local, pr_global, y_global);
+}
 
 #ifdef GENERATE_DOCS
 }
@@ -34,6 +34,28 @@ void dydt (const double t, const double mu, const double * __restrict__ y, doubl
 
 } // end dydt
 
+/**
+ * \brief A batched implementation of the RHS of the van der Pol equation, used if #DYDT_BATCH is defined
+ * \param[in]        n         The number of states
+ * \param[in]        t         The system times of the states
+ * \param[in]        mu        The van der Pol parameters of the states
+ * \param[in]        y         The lane-wise state vectors, i.e. entry `i` of state `k` is `y[k + i * n]`
+ * \param[out]       dy        The lane-wise output RHS (dydt) vectors
+ *
+ * The states are independent, and stored such that the loop below vectorizes over them.
+ */
+void dydt_batch (const int n, const double * __restrict__ t, const double * __restrict__ mu,
+                 const double * __restrict__ y, double * __restrict__ dy) {
+
+  for (int k = 0; k < n; ++k) {
+    // y1' = y2
+    dy[k] = y[k + n];
+    // y2' = mu(1 - y1^2)y2 - y1
+    dy[k + n] = mu[k] * (1 - y[k] * y[k]) * y[k + n] - y[k];
+  }
+
+} // end dydt_batch
+
 
 #ifdef GENERATE_DOCS
 }
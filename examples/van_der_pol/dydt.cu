@@ -8,6 +8,7 @@
 
 #include "header.cuh"
 #include "gpu_macros.cuh"
+#include "warp_ivp.cuh"
 
 #ifdef GENERATE_DOCS
 //put this in the van der Pol namespace for documentation
@@ -38,6 +39,33 @@ void dydt (const double t, const double mu, const double * __restrict__ y, doubl
 
 } // end dydt
 
+#ifdef WARP_IVP
+/**
+ * \brief The RHS of the van der Pol equation, evaluated by the group of an IVP, @see warp_ivp.cuh
+ * \param[in]        t         The current system time
+ * \param[in]        mu        The van der Pol parameter
+ * \param[in]        y         The (contiguous) state vector of the IVP
+ * \param[out]       dy        The (contiguous) output RHS (dydt) vector of the IVP
+ * \param[in]        lane      The lane of the calling thread in the group
+ * \param[in]        d_mem     The mechanism_memory struct
+ *
+ * With only two species, the first lane evaluates the whole vector.
+ */
+ __device__
+void dydt_warp (const double t, const double mu, const double * __restrict__ y, double * __restrict__ dy,
+                const int lane, const mechanism_memory * __restrict__ d_mem) {
+
+  if (lane == 0)
+  {
+    // y1' = y2
+    dy[0] = y[1];
+    // y2' = mu(1 - y1^2)y2 - y1
+    dy[1] = mu * (1 - y[0] * y[0]) * y[1] - y[0];
+  }
+
+} // end dydt_warp
+#endif
+
 
 #ifdef GENERATE_DOCS
 }
@@ -23,6 +23,17 @@ namespace van_der_pol {
  */
 void dydt (const double t, const double mu, const double * __restrict__ y, double * __restrict__ dy);
 
+/**
+ * \brief A batched implementation of the RHS of the van der Pol equation, used if #DYDT_BATCH is defined
+ * \param[in]        n         The number of states
+ * \param[in]        t         The system times of the states
+ * \param[in]        mu        The van der Pol parameters of the states
+ * \param[in]        y         The lane-wise state vectors, i.e. entry `i` of state `k` is `y[k + i * n]`
+ * \param[out]       dy        The lane-wise output RHS (dydt) vectors
+ */
+void dydt_batch (const int n, const double * __restrict__ t, const double * __restrict__ mu,
+                 const double * __restrict__ y, double * __restrict__ dy);
+
 #ifdef GENERATE_DOCS
 }
 #endif
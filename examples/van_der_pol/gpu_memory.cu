@@ -4,6 +4,8 @@
  */
 
 #include "gpu_memory.cuh"
+#include "gpu_arena.cuh"
+#include "sparse_jacobian.cuh"
 
 #ifdef GENERATE_DOCS
 //put this in the van der Pol namespace for documentation
@@ -21,8 +23,8 @@ size_t required_mechanism_size() {
   mech_size += NSP;
   //dydt vector
   mech_size += NSP;
-  //Jacobian
-  mech_size += NSP * NSP;
+  //Jacobian, compressed if SPARSE_JACOBIAN
+  mech_size += JAC_SIZE;
   //and mu parameter
   mech_size += 1;
   return mech_size * sizeof(double);
@@ -37,15 +39,15 @@ size_t required_mechanism_size() {
 void initialize_gpu_memory(int padded, mechanism_memory** h_mem, mechanism_memory** d_mem)
 {
   // Allocate storage for the device struct
-  cudaErrorCheck( cudaMalloc(d_mem, sizeof(mechanism_memory)) );
+  cudaErrorCheck( arena_malloc(d_mem, sizeof(mechanism_memory)) );
   //allocate the device arrays on the host pointer
-  cudaErrorCheck( cudaMalloc(&((*h_mem)->y), NSP * padded * sizeof(double)) );
-  cudaErrorCheck( cudaMalloc(&((*h_mem)->dy), NSP * padded * sizeof(double)) );
-  cudaErrorCheck( cudaMalloc(&((*h_mem)->var), 1 * padded * sizeof(double)) );
-  cudaErrorCheck( cudaMalloc(&((*h_mem)->jac), NSP * NSP * padded * sizeof(double)) );
+  cudaErrorCheck( arena_malloc(&((*h_mem)->y), NSP * padded * sizeof(double)) );
+  cudaErrorCheck( arena_malloc(&((*h_mem)->dy), NSP * padded * sizeof(double)) );
+  cudaErrorCheck( arena_malloc(&((*h_mem)->var), 1 * padded * sizeof(double)) );
+  cudaErrorCheck( arena_malloc(&((*h_mem)->jac), JAC_SIZE * padded * sizeof(double)) );
   // set non-initialized values to zero
   cudaErrorCheck( cudaMemset((*h_mem)->dy, 0, NSP * padded * sizeof(double)) );
-  cudaErrorCheck( cudaMemset((*h_mem)->jac, 0, NSP * NSP * padded * sizeof(double)) );
+  cudaErrorCheck( cudaMemset((*h_mem)->jac, 0, JAC_SIZE * padded * sizeof(double)) );
   // and copy to device pointer
   cudaErrorCheck( cudaMemcpy(*d_mem, *h_mem, sizeof(mechanism_memory), cudaMemcpyHostToDevice) );
 }
@@ -56,11 +58,11 @@ void initialize_gpu_memory(int padded, mechanism_memory** h_mem, mechanism_memor
  */
 void free_gpu_memory(mechanism_memory** h_mem, mechanism_memory** d_mem)
 {
-  cudaErrorCheck(cudaFree((*h_mem)->y));
-  cudaErrorCheck(cudaFree((*h_mem)->dy));
-  cudaErrorCheck(cudaFree((*h_mem)->var));
-  cudaErrorCheck(cudaFree((*h_mem)->jac));
-  cudaErrorCheck(cudaFree(*d_mem));
+  cudaErrorCheck(arena_free((*h_mem)->y));
+  cudaErrorCheck(arena_free((*h_mem)->dy));
+  cudaErrorCheck(arena_free((*h_mem)->var));
+  cudaErrorCheck(arena_free((*h_mem)->jac));
+  cudaErrorCheck(arena_free(*d_mem));
 }
 
 #ifdef GENERATE_DOCS
@@ -21,7 +21,7 @@ namespace van_der_pol_cu {
  * \param           y               The global state vector arrays
  * \param           dy              The global dydt vector arrays
  * \param           var             The global param array [Used for \f$\mu\f$]
- * \param           jac             The global Jacobian arrays
+ * \param           jac             The global Jacobian arrays, of #JAC_SIZE entries per thread
  *
  * This is also heavily used when using with @pyJac to hold additional arrays
  * for evaluating chemical kinetic reactions.
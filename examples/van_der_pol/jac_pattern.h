@@ -0,0 +1,23 @@
+/**
+ * \file
+ * \brief The structural nonzero pattern of the van der Pol Jacobian
+ *
+ * Used if the \ref scons_opts "SCons option" #SPARSE_JACOBIAN is set, in which case eval_jacob() and
+ * sparse_multiplier() store only these entries, in compressed sparse column order.  @see sparse_jacobian.h
+ *
+ * \f[
+ *     J = \begin{bmatrix} 0 & 1 \\ -2 \mu y_1 y_2 - 1 & \mu (1 - y_1^2) \end{bmatrix}
+ * \f]
+ */
+
+#ifndef JAC_PATTERN_H
+#define JAC_PATTERN_H
+
+//! The number of structural nonzeros of the Jacobian
+#define JAC_NNZ (3)
+//! The start of each column (and the end of the last) in the compressed entries
+#define JAC_COL_START {0, 1, 3}
+//! The row of each compressed entry, ascending within each column
+#define JAC_ROW_INDEX {1, 0, 1}
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * \file
+ * \brief An implementation of the van der Pol Jacobian-vector product \f$\frac{\partial \dot{\vec{y}}}{\partial \vec{y}} \vec{v}\f$
+ *
+ * Used by the exponential integrators if the \ref scons_opts "SCons option" #JAC_VEC is 'analytic'
+ *
+ */
+
+#include "jac_vec_mult.h"
+
+#ifdef GENERATE_DOCS
+//put this in the van der Pol namespace for documentation
+namespace van_der_pol {
+#endif
+
+/**
+ * \brief An implementation of the van der Pol Jacobian-vector product
+ *
+ * \param[in]           t               The current system time
+ * \param[in]           mu              The van der Pol parameter
+ * \param[in]           y               The state vector at time t
+ * \param[in]           v               The (NSP x 1) vector to multiply by
+ * \param[out]          w               The (NSP x 1) vector to store the result in, \f$w := \frac{\partial \dot{\vec{y}}}{\partial \vec{y}} v\f$
+ *
+ *  As with eval_jacob(), this function operates on local copies of the global state vector, and the
+ *  Jacobian itself is never formed.  @see jacob.c
+ */
+void jac_vec_mult (const double t, const double mu, const double * __restrict__ y,
+                   const double * __restrict__ v, double * __restrict__ w)
+{
+    w[0] = v[1];
+    w[1] = (-2 * mu * y[0] * y[1] - 1) * v[0] + mu * (1 - y[0] * y[0]) * v[1];
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
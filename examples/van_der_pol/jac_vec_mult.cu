@@ -0,0 +1,41 @@
+/**
+ * \file
+ * \brief A CUDA implementation of the van der Pol Jacobian-vector product \f$\frac{\partial \dot{\vec{y}}}{\partial \vec{y}} \vec{v}\f$
+ *
+ * Used by the exponential integrators if the \ref scons_opts "SCons option" #JAC_VEC is 'analytic'
+ *
+ */
+
+#include "jac_vec_mult.cuh"
+#include "gpu_macros.cuh"
+
+#ifdef GENERATE_DOCS
+//put this in the van der Pol namespace for documentation
+namespace van_der_pol_cu {
+#endif
+
+/**
+ * \brief An implementation of the van der Pol Jacobian-vector product
+ *
+ * \param[in]           t               The current system time
+ * \param[in]           mu              The van der Pol parameter
+ * \param[in]           y               The state vector at time t
+ * \param[in]           v               The (NSP x 1) vector to multiply by
+ * \param[out]          w               The (NSP x 1) vector to store the result in, \f$w := \frac{\partial \dot{\vec{y}}}{\partial \vec{y}} v\f$
+ * \param[in]           d_mem           The mechanism_memory struct.  In future versions, this will be used to access the \f$\mu\f$ parameter to have a consistent interface.
+ *
+ *  As with eval_jacob(), this function operates directly on the global state vectors, hence we use
+ *  the #INDEX macro defined in gpu_macros.cuh here.  @see jacob.cu
+ */
+__device__
+void jac_vec_mult (const double t, const double mu, const double * __restrict__ y,
+                   const double * __restrict__ v, double * __restrict__ w,
+                   const mechanism_memory * __restrict__ d_mem)
+{
+    w[INDEX(0)] = v[INDEX(1)];
+    w[INDEX(1)] = (-2 * mu * y[INDEX(0)] * y[INDEX(1)] - 1) * v[INDEX(0)] + mu * (1 - y[INDEX(0)] * y[INDEX(0)]) * v[INDEX(1)];
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,37 @@
+/**
+ * \file
+ * \brief Header definition for the CUDA van der Pol Jacobian-vector product, used in the matrix-free exponential integrators
+ *
+ */
+
+#ifndef JAC_VEC_MULT_CUH
+#define JAC_VEC_MULT_CUH
+
+#include "header.cuh"
+
+#ifdef GENERATE_DOCS
+//put this in the van der Pol namespace for documentation
+namespace van_der_pol_cu {
+#endif
+
+/**
+ * \brief An implementation of the van der Pol Jacobian-vector product
+ *
+ * \param[in]           t               The current system time
+ * \param[in]           mu              The van der Pol parameter
+ * \param[in]           y               The state vector at time t
+ * \param[in]           v               The (NSP x 1) vector to multiply by
+ * \param[out]          w               The (NSP x 1) vector to store the result in, \f$w := \frac{\partial \dot{\vec{y}}}{\partial \vec{y}} v\f$
+ * \param[in]           d_mem           The mechanism_memory struct.  In future versions, this will be used to access the \f$\mu\f$ parameter to have a consistent interface.
+ *
+ */
+__device__
+void jac_vec_mult (const double t, const double mu, const double * __restrict__ y,
+                   const double * __restrict__ v, double * __restrict__ w,
+                   const mechanism_memory * __restrict__ d_mem);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * \file
+ * \brief Header definition for the van der Pol Jacobian-vector product, used in the matrix-free exponential integrators
+ *
+ */
+
+#ifndef JAC_VEC_MULT_H
+#define JAC_VEC_MULT_H
+
+#include "header.h"
+
+#ifdef GENERATE_DOCS
+//put this in the van der Pol namespace for documentation
+namespace van_der_pol {
+#endif
+
+/**
+ * \brief An implementation of the van der Pol Jacobian-vector product
+ *
+ * \param[in]           t               The current system time
+ * \param[in]           mu              The van der Pol parameter
+ * \param[in]           y               The state vector at time t
+ * \param[in]           v               The (NSP x 1) vector to multiply by
+ * \param[out]          w               The (NSP x 1) vector to store the result in, \f$w := \frac{\partial \dot{\vec{y}}}{\partial \vec{y}} v\f$
+ *
+ */
+void jac_vec_mult (const double t, const double mu, const double * __restrict__ y,
+                   const double * __restrict__ v, double * __restrict__ w);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
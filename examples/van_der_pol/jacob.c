@@ -7,6 +7,7 @@
  */
 
 #include "header.h"
+#include "solver_options.h"
 
 #ifdef GENERATE_DOCS
 //put this in the van der Pol namespace for documentation
@@ -23,11 +24,18 @@ namespace van_der_pol {
  *
  *  The Jacobian is in a local Column-major (Fortran) order.  As with dydt(), this function operates on local
  *  copies of the global state vector and jacobian.  Hence simple linear indexing can be used here.
+ *  If #SPARSE_JACOBIAN is defined, only the structural nonzeros of jac_pattern.h are stored (in the same order).
  *  @see solver_generic.c
  *
  */
 void eval_jacob (const double t, const double mu, const double * __restrict__ y, double * __restrict__ jac)
 {
+#ifdef SPARSE_JACOBIAN
+    //the compressed columns, jac[0, 0] is a structural zero
+    jac[0] = -2 * mu * y[0] * y[1] - 1;
+    jac[1] = 1;
+    jac[2] = mu * (1 - y[0] * y[0]);
+#else
     //Note, to reach index [i, j] of the Jacobian, we multiply `i` by NSP, the size of the first dimension of Jacobian and add j, i.e.:
     //jac[i, j] -> jac[i * NSP + j]
     //!jac[0, 0] = \f$\frac{\partial \dot{y_1}}{\partial y_1}\f$
@@ -38,6 +46,7 @@ void eval_jacob (const double t, const double mu, const double * __restrict__ y,
     jac[1 * NSP + 0] = 1;
     //!jac[1, 1] = \f$\frac{\partial \dot{y_2}}{\partial y_2}\f$
     jac[1 * NSP + 1] = mu * (1 - y[0] * y[0]);
+#endif
 }
 
 #ifdef GENERATE_DOCS
@@ -7,6 +7,7 @@
  */
 
 #include "header.cuh"
+#include "solver_options.cuh"
 
 #ifdef GENERATE_DOCS
 //put this in the van der Pol namespace for documentation
@@ -24,12 +25,19 @@ namespace van_der_pol_cu {
  *
  *  The Jacobian is in Column-major (Fortran) order.  As with dydt(), this function operates directly on
  *  global state vector and jacobian.  Hence we use the #INDEX macro defined in gpu_macros.cuh here.
+ *  If #SPARSE_JACOBIAN is defined, only the structural nonzeros of jac_pattern.h are stored (in the same order).
  *  @see dydt()
  *
  */
 __device__
 void eval_jacob (const double t, const double mu, const double * __restrict__ y, double * __restrict__ jac, const mechanism_memory * __restrict__ d_mem)
 {
+#ifdef SPARSE_JACOBIAN
+    //the compressed columns, jac[0, 0] is a structural zero
+    jac[INDEX(0)] = -2 * mu * y[INDEX(0)] * y[INDEX(1)] - 1;
+    jac[INDEX(1)] = 1;
+    jac[INDEX(2)] = mu * (1 - y[INDEX(0)] * y[INDEX(0)]);
+#else
     //Note, to reach index [i, j] of the Jacobian, we multiply `i` by NSP, the size of the first dimension of Jacobian and add j, i.e.:
     //jac[i, j] -> jac[i * NSP + j]
     //!jac[0, 0] = \f$\frac{\partial \dot{y_1}}{\partial y_1}\f$
@@ -40,6 +48,7 @@ void eval_jacob (const double t, const double mu, const double * __restrict__ y,
     jac[INDEX(1 * NSP + 0)] = 1;
     //!jac[1, 1] = \f$\frac{\partial \dot{y_2}}{\partial y_2}\f$
     jac[INDEX(1 * NSP + 1)] = mu * (1 - y[INDEX(0)] * y[INDEX(0)]);
+#endif
 }
 
 #ifdef GENERATE_DOCS
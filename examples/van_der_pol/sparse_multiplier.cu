@@ -5,6 +5,7 @@
  */
 
 #include "sparse_multiplier.cuh"
+#include "solver_options.cuh"
 
 #ifdef GENERATE_DOCS
 //put this in the van der Pol namespace for documentation
@@ -15,13 +16,19 @@ namespace van_der_pol_cu {
 /**
  * \brief Implements Jacobian \ vector multiplication in sparse (or unrolled) form
  * \param[in]           A           The (NSP x NSP) Jacobian matrix, see eval_jacob() for details on layout
+ *                                  (the compressed structural nonzeros if #SPARSE_JACOBIAN is defined)
  * \param[in]           Vm          The (NSP x 1) vector to multiply by
  * \param[out]          w           The (NSP x 1) vector to store the result in, \f$w := A * Vm\f$
  */
 __device__
 void sparse_multiplier(const double * A, const double * Vm, double* w) {
+#ifdef SPARSE_JACOBIAN
+  w[INDEX(0)] =  A[INDEX(1)] * Vm[INDEX(1)];
+  w[INDEX(1)] =  A[INDEX(0)] * Vm[INDEX(0)] +  A[INDEX(2)] * Vm[INDEX(1)];
+#else
   w[INDEX(0)] =  A[INDEX(0)] * Vm[INDEX(0)] +  A[INDEX(NSP)] * Vm[INDEX(1)];
   w[INDEX(1)] =  A[INDEX(1)] * Vm[INDEX(0)] +  A[INDEX(NSP + 1)] * Vm[INDEX(1)];
+#endif
 }
 
 
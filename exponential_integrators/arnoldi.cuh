@@ -6,6 +6,8 @@
  * \date 03/09/2015
  *
  * Note: turn on EXACT_KRYLOV krylov definition to use the use the "happy breakdown" criteria in determining end of krylov iteration
+ *
+ * The new basis vectors are orthogonalized by modified Gram-Schmidt, or by orthogonalize_cgs2 if #ARNOLDI_CGS2 is defined, @see krylov_shared.cuh
  */
 
 #ifndef ARNOLDI_CUH
@@ -16,53 +18,70 @@
 #include "header.cuh"
 #include "phiAHessenberg.cuh"
 #include "exponential_linear_algebra.cuh"
-#include "sparse_multiplier.cuh"
+#include "jac_operator.cuh"
 #include "solver_options.cuh"
 #include "solver_props.cuh"
 
 //#define EXACT_KRYLOV
 
+//! The number of entries in #index_list
+#define NUM_INDICIES (23)
 //! The list of indicies to check the Krylov projection error at
-__constant__ int index_list[23] = {1, 2, 3, 4, 5, 6, 7, 9, 11, 14, 17, 21, 27, 34, 42, 53, 67, 84, 106, 133, 167, 211, 265};
+__constant__ int index_list[NUM_INDICIES] = {1, 2, 3, 4, 5, 6, 7, 9, 11, 14, 17, 21, 27, 34, 42, 53, 67, 84, 106, 133, 167, 211, 265};
+
+#ifdef KRYLOV_SHARED
+//! The dynamic shared memory of the block, of which the first #SHARED_SIZE bytes belong to the mechanism
+extern __shared__ double krylov_shared[];
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 
 /*!
  * \fn int arnoldi(const double scale,
 			const int p, const double h,
-			const double* __restrict__ A,
+			const jac_operator* __restrict__ J,
 			const solver_memory* __restrict__ solver,
 			const double* __restrict__ v, double* __restrict__ beta,
+			double* __restrict__ Vm, double* __restrict__ Hm,
 			double * __restrict__ work,
-			cuDoubleComplex* __restrict__ work2)
+			cuDoubleComplex* __restrict__ work2,
+			const int m_start, const int m_basis)
  * \brief Runs the arnoldi iteration to calculate the Krylov projection
  * \returns				m - the ending size of the matrix
  * \param[in]			scale	the value to scale the timestep by
  * \param[in]			p		the order of the maximum phi function needed
  * \param[in]			h		the timestep
- * \param[in]			A 		the jacobian matrix
+ * \param[in]			J 		the jacobian operator
  * \param[in,out]		solver  the solver memory struct
  * \param[in]  			v 		the vector to use for the krylov subspace
- * \param[out] 			beta 	the norm of the v vector
+ * \param[in,out] 		beta 	the norm of the v vector (an input if `m_basis > 0`)
+ * \param[in,out]		Vm 		the arnoldi basis matrix (solver_memory::Vm, or solver_memory::Vm_fy)
+ * \param[in,out]		Hm 		the constructed Hessenberg matrix (solver_memory::Hm, or solver_memory::Hm_fy)
  * \param[in,out]		work    A work vector
  * \param[in,out]		work2   A complex work vector
+ * \param[in]			m_start	the size of a previous projection, the error is first checked at the largest size of #index_list below it (zero to check every size)
+ * \param[in]			m_basis	the size of a previous projection of `v` (with the same `J`) still held in `Vm`, `Hm` and `beta`, which is resumed rather than rebuilt (zero to start from scratch)
+ *
+ * The returned `Vm`, `Hm` and `beta` may be passed back with `m_basis = m`, as long as `v` and `J` are unchanged and
+ * the projection did not end in a happy breakdown (`Hm(m, m + 1)` below #ATOL), as `Vm(m)` is then never formed.
  */
 __device__
 int arnoldi(const double scale,
 			const int p, const double h,
-			const double* __restrict__ A,
+			const jac_operator* __restrict__ J,
 			const solver_memory* __restrict__ solver,
 			const double* __restrict__ v, double* __restrict__ beta,
+			double* __restrict__ Vm, double* __restrict__ Hm,
 			double * __restrict__ work,
-			cuDoubleComplex* __restrict__ work2)
+			cuDoubleComplex* __restrict__ work2,
+			const int m_start, const int m_basis)
 {
 	const double* __restrict__ sc = solver->sc;
-	double* __restrict__ Vm = solver->Vm;
-	double* __restrict__ Hm = solver->Hm;
 	double* __restrict__ phiHm = solver->phiHm;
-
-	//first place A*fy in the Vm matrix
-	*beta = normalize(v, Vm);
+#ifdef KRYLOV_SHARED
+	//the Gram-Schmidt coefficients of this thread, strided by the block size
+	double* __restrict__ coeffs = (double*)(((char*)krylov_shared) + KRYLOV_SHARED_OFFSET) + threadIdx.x;
+#endif
 
 	double store = 0;
 	int index = 0;
@@ -70,17 +89,47 @@ int arnoldi(const double scale,
 	double err = 2.0;
 	int info = 0;
 
+	if (m_basis > 0)
+	{
+		//resume the iteration from the previous projection
+		j = m_basis;
+		while (index + 1 < NUM_INDICIES && index_list[index] < j)
+			index++;
+	}
+	else
+	{
+		//first place A*fy in the Vm matrix
+		*beta = normalize(v, Vm);
+	}
+	//skip the checks at the sizes well below that of the previous projection
+	while (index + 1 < NUM_INDICIES && index_list[index + 1] < m_start)
+		index++;
+
 	while (err >= 1.0)
 	{
 		for (; j < index_list[index] && j + p < STRIDE; j++)
 		{
-			sparse_multiplier(A, &Vm[GRID_DIM * (j * NSP)], work);
+			jac_operator_multiply(J, &Vm[GRID_DIM * (j * NSP)], work);
+#if defined(KRYLOV_SHARED)
+			//orthogonalize with the coefficients in shared memory, and store them in Hm
+			Hm[INDEX(j * STRIDE + j + 1)] = orthogonalize_cgs2(j, Vm, work, coeffs,
+															   &coeffs[STRIDE * blockDim.x], blockDim.x);
+			for (int i = 0; i <= j; i++)
+			{
+				Hm[INDEX(j * STRIDE + i)] = coeffs[i * blockDim.x];
+			}
+#elif defined(ARNOLDI_CGS2)
+			//orthogonalize with the second pass coefficients in the next (unused) column of Hm
+			Hm[INDEX(j * STRIDE + j + 1)] = orthogonalize_cgs2(j, Vm, work, &Hm[INDEX(j * STRIDE)],
+															   &Hm[INDEX((j + 1) * STRIDE)], GRID_DIM);
+#else
 			for (int i = 0; i <= j; i++)
 			{
 				Hm[INDEX(j * STRIDE + i)] = dotproduct(work, &Vm[GRID_DIM * (i * NSP)]);
 				scale_subtract(Hm[INDEX(j * STRIDE + i)], &Vm[GRID_DIM * (i * NSP)], work);
 			}
 			Hm[INDEX(j * STRIDE + j + 1)] = two_norm(work);
+#endif
 			if (fabs(Hm[INDEX(j * STRIDE + j + 1)]) < ATOL)
 			{
 				//happy breakdown
@@ -120,10 +169,14 @@ int arnoldi(const double scale,
 
 #ifdef RB43
 		//2. Get phiHm
+		PHASE_BEGIN(solver, PHASE_PHI);
 		info = expAc_variable (j + p, Hm, h * scale, phiHm, solver, work2);
+		PHASE_END(solver, PHASE_PHI);
 #elif EXP4
 		//2. Get phiHm
+		PHASE_BEGIN(solver, PHASE_PHI);
 		info = phiAc_variable (j + p, Hm, h * scale, phiHm, solver, work2);
+		PHASE_END(solver, PHASE_PHI);
 #endif
 		if (info != 0)
 			return -info;
@@ -153,4 +206,210 @@ int arnoldi(const double scale,
 	return j;
 }
 
+#ifdef KRYLOV_BLOCK
+/*!
+ * \fn int arnoldi_block(const double scale,
+			const int p, const double h,
+			const jac_operator* __restrict__ J,
+			const solver_memory* __restrict__ solver,
+			const double* __restrict__ v, double* __restrict__ beta,
+			double* __restrict__ Vm, double* __restrict__ Hm,
+			double* __restrict__ work, double* __restrict__ work_pair,
+			cuDoubleComplex* __restrict__ work2,
+			const int m_shared, const int m_start)
+ * \brief Computes the Krylov projection of `v` by extending that of another vector (with the same `J`) by block Arnoldi steps
+ * \returns				m - the ending size of the matrix
+ * \param[in]			scale	the value to scale the timestep by
+ * \param[in]			p		the order of the maximum phi function needed
+ * \param[in]			h		the timestep
+ * \param[in]			J 		the jacobian operator
+ * \param[in,out]		solver  the solver memory struct
+ * \param[in]  			v 		the vector to project
+ * \param[out] 			beta 	the norm of the v vector
+ * \param[in,out]		Vm 		the arnoldi basis matrix, holding the basis of the previous projection on entry
+ * \param[in,out]		Hm 		the constructed (block) Hessenberg matrix, holding that of the previous projection on entry
+ * \param[in,out]		work    A work vector
+ * \param[in,out]		work_pair	A second work vector
+ * \param[in,out]		work2   A complex work vector
+ * \param[in]			m_shared	the size `m` of the previous projection, as returned by arnoldi
+ * \param[in]			m_start	the size of a previous projection of this kind, the error is first checked at the largest size of #index_list below it (zero to check every size)
+ *
+ * See the CPU arnoldi_block for the method.  The coefficients of `v` in the basis are kept in the last
+ * (never used) column of `Hm`, and those of the second Gram-Schmidt pass of a block step in the two
+ * (not yet used) columns after the block.
+ */
+__device__
+int arnoldi_block(const double scale,
+				  const int p, const double h,
+				  const jac_operator* __restrict__ J,
+				  const solver_memory* __restrict__ solver,
+				  const double* __restrict__ v, double* __restrict__ beta,
+				  double* __restrict__ Vm, double* __restrict__ Hm,
+				  double* __restrict__ work, double* __restrict__ work_pair,
+				  cuDoubleComplex* __restrict__ work2,
+				  const int m_shared, const int m_start)
+{
+	const double* __restrict__ sc = solver->sc;
+	double* __restrict__ phiHm = solver->phiHm;
+	//the coefficients of v in the basis
+	double* __restrict__ c = &Hm[INDEX((STRIDE - 1) * STRIDE)];
+
+	int index = 0;
+	int j = m_shared;
+	double err = 2.0;
+	int info = 0;
+	//the returned size, or the failure
+	int m = j;
+#ifdef CONST_TIME_STEP
+	bool full = false;
+#endif
+
+	//the previous projection ended in a happy breakdown, its last basis vector was never formed
+	if (fabs(Hm[INDEX((j - 1) * STRIDE + j)]) < ATOL)
+	{
+		#pragma unroll
+		for (int i = 0; i < NSP; ++i)
+			Vm[INDEX(j * NSP + i)] = 0.0;
+	}
+
+	//orthogonalize v against the previous basis
+	*beta = two_norm(v);
+	#pragma unroll
+	for (int i = 0; i < NSP; ++i)
+		work[INDEX(i)] = v[INDEX(i)];
+	c[GRID_DIM * (j + 1)] = orthogonalize_cgs2(j, Vm, work, c, &Hm[INDEX((j + 2) * STRIDE)], GRID_DIM);
+	if (c[GRID_DIM * (j + 1)] < ATOL)
+	{
+		#pragma unroll
+		for (int i = 0; i < NSP; ++i)
+			Vm[INDEX((j + 1) * NSP + i)] = 0.0;
+	}
+	else
+		scale_mult(1.0 / c[GRID_DIM * (j + 1)], work, &Vm[GRID_DIM * ((j + 1) * NSP)]);
+	if (*beta > 0)
+	{
+		for (int i = 0; i <= j + 1; i++)
+			c[GRID_DIM * i] /= *beta;
+	}
+	for (int i = j + 2; i < STRIDE; i++)
+		c[GRID_DIM * i] = 0.0;
+	//the previous subspace is invariant and contains v, i.e. the projection is exact
+	const bool exact = fabs(Hm[INDEX((j - 1) * STRIDE + j)]) < ATOL && c[GRID_DIM * (j + 1)] < ATOL;
+
+	//check first after at least one block step
+	while (index + 1 < NUM_INDICIES && index_list[index] <= j)
+		index++;
+	//skip the checks at the sizes well below that of the previous projection
+	while (index + 1 < NUM_INDICIES && index_list[index + 1] < m_start)
+		index++;
+
+	while (err > 1.0)
+	{
+		for (; !exact && j < index_list[index] && j + 2 + p < STRIDE; j += 2)
+		{
+			jac_operator_multiply2(J, &Vm[GRID_DIM * (j * NSP)], &Vm[GRID_DIM * ((j + 1) * NSP)], work, work_pair);
+			orthogonalize_pair(j + 2, Vm, work, work_pair, &Hm[INDEX(j * STRIDE)], &Hm[INDEX((j + 1) * STRIDE)],
+							   &Hm[INDEX((j + 2) * STRIDE)], &Hm[INDEX((j + 3) * STRIDE)], GRID_DIM);
+
+			//QR factorization of the remainder, the next block
+			Hm[INDEX(j * STRIDE + j + 2)] = two_norm(work);
+			Hm[INDEX(j * STRIDE + j + 3)] = 0.0;
+			if (Hm[INDEX(j * STRIDE + j + 2)] < ATOL)
+			{
+				//(partial) happy breakdown, no new direction
+				Hm[INDEX(j * STRIDE + j + 2)] = 0.0;
+				#pragma unroll
+				for (int i = 0; i < NSP; ++i)
+					Vm[INDEX((j + 2) * NSP + i)] = 0.0;
+			}
+			else
+				scale_mult(1.0 / Hm[INDEX(j * STRIDE + j + 2)], work, &Vm[GRID_DIM * ((j + 2) * NSP)]);
+			Hm[INDEX((j + 1) * STRIDE + j + 2)] = dotproduct(work_pair, &Vm[GRID_DIM * ((j + 2) * NSP)]);
+			scale_subtract(Hm[INDEX((j + 1) * STRIDE + j + 2)], &Vm[GRID_DIM * ((j + 2) * NSP)], work_pair);
+			Hm[INDEX((j + 1) * STRIDE + j + 3)] = two_norm(work_pair);
+			if (Hm[INDEX((j + 1) * STRIDE + j + 3)] < ATOL)
+			{
+				Hm[INDEX((j + 1) * STRIDE + j + 3)] = 0.0;
+				#pragma unroll
+				for (int i = 0; i < NSP; ++i)
+					Vm[INDEX((j + 3) * NSP + i)] = 0.0;
+			}
+			else
+				scale_mult(1.0 / Hm[INDEX((j + 1) * STRIDE + j + 3)], work_pair, &Vm[GRID_DIM * ((j + 3) * NSP)]);
+		}
+		if (!exact && j < index_list[index])
+		{
+			//out of space
+#ifdef CONST_TIME_STEP
+			full = true;
+			if (j == m_shared)
+#endif
+			{
+				m = j + 2;
+				break;
+			}
+		}
+		//the next size to check at
+		while (index + 1 < NUM_INDICIES && index_list[index] <= j)
+			index++;
+
+		//resize Hm to be mxm, and store the entries coupling it to the next block for later
+		const double store0 = j > 1 ? Hm[INDEX((j - 2) * STRIDE + j)] : 0.0;
+		const double store1 = Hm[INDEX((j - 1) * STRIDE + j)];
+		const double store2 = Hm[INDEX((j - 1) * STRIDE + j + 1)];
+		if (j > 1)
+			Hm[INDEX((j - 2) * STRIDE + j)] = 0.0;
+		Hm[INDEX((j - 1) * STRIDE + j)] = 0.0;
+		Hm[INDEX((j - 1) * STRIDE + j + 1)] = 0.0;
+
+		//1. Construct augmented Hm, with the coefficients of v in place of e1
+		for (int i = 0; i < (j + 2); ++i)
+			Hm[INDEX(j * STRIDE + i)] = i < j ? c[GRID_DIM * i] : 0.0;
+		#pragma unroll
+		for (int i = 1; i < p; i++)
+		{
+			//0. fill potentially non-empty memory first
+			for (int k = 0; k < (j + i + 2); ++k)
+				Hm[INDEX((j + i) * STRIDE + k)] = 0;
+			Hm[INDEX((j + i) * STRIDE + (j + i - 1))] = 1.0;
+		}
+
+		//2. Get phiHm
+		PHASE_BEGIN(solver, PHASE_PHI);
+		info = expAc_block (j + p, Hm, h * scale, phiHm, solver, work2);
+		PHASE_END(solver, PHASE_PHI);
+
+		//restore Hm
+		if (j > 1)
+			Hm[INDEX((j - 2) * STRIDE + j)] = store0;
+		Hm[INDEX((j - 1) * STRIDE + j)] = store1;
+		Hm[INDEX((j - 1) * STRIDE + j + 1)] = store2;
+		if (info != 0)
+		{
+			m = -info;
+			break;
+		}
+
+		//3. Get error, from the residual of the projection in the next block
+		const double r0 = (j > 1 ? store0 * phiHm[INDEX(j * STRIDE + j - 2)] : 0.0) + store1 * phiHm[INDEX(j * STRIDE + j - 1)];
+		const double r1 = store2 * phiHm[INDEX(j * STRIDE + j - 1)];
+		#pragma unroll
+		for (int i = 0; i < NSP; ++i)
+			work[INDEX(i)] = r0 * Vm[INDEX(j * NSP + i)] + r1 * Vm[INDEX((j + 1) * NSP + i)];
+		err = h * (*beta) * sc_norm(work, sc);
+		m = j;
+#ifdef CONST_TIME_STEP
+		if (full)
+			break;
+#endif
+	}
+
+	//clear the second subdiagonal
+	for (int i = m_shared; i < j; i++)
+		Hm[INDEX(i * STRIDE + i + 2)] = 0.0;
+
+	return m;
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -12,63 +12,99 @@
 #define ARNOLDI_H
 
 #include <string.h>
+#include <stdbool.h>
 
 #include "header.h"
 #include "phiAHessenberg.h"
 #include "exponential_linear_algebra.h"
-#include "sparse_multiplier.h"
+#include "jac_operator.h"
+#include "phase_profile.h"
+#include "tolerances.h"
 #include "solver_options.h"
 #include "solver_props.h"
 
 //#define EXACT_KRYLOV
 
+//! The number of entries in #index_list
+#define NUM_INDICIES (23)
 //! The list of indicies to check the Krylov projection error at
-static int index_list[23] = {1, 2, 3, 4, 5, 6, 7, 9, 11, 14, 17, 21, 27, 34, 42, 53, 67, 84, 106, 133, 167, 211, 265};
+static int index_list[NUM_INDICIES] = {1, 2, 3, 4, 5, 6, 7, 9, 11, 14, 17, 21, 27, 34, 42, 53, 67, 84, 106, 133, 167, 211, 265};
+
+/**
+ * \brief The norm below which a new basis vector is a (happy) breakdown, i.e. the smallest absolute tolerance of the current IVP
+ */
+static inline double breakdown_tolerance()
+{
+	double tol = current_tolerances.atol[0];
+	for (int i = 1; i < NSP; ++i)
+		tol = fmin(tol, current_tolerances.atol[i]);
+	return tol;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
- * \fn int arnoldi(const double scale, const int p, const double h, const double* A, const double* v, const double* sc, double* beta, double* Vm, double* Hm, double* phiHm)
+ * \fn int arnoldi(const double scale, const int p, const double h, const jac_operator* J, const double* v, const double* sc, double* beta, double* Vm, double* Hm, double* phiHm, const int m_start, const int m_basis)
  * \brief Runs the arnoldi iteration to calculate the Krylov projection
  * \returns				m - the ending size of the matrix
  * \param[in]			scale	the value to scale the timestep by
  * \param[in]			p		the order of the maximum phi function needed
  * \param[in]			h		the timestep
- * \param[in]			A 		the jacobian matrix
+ * \param[in]			J 		the jacobian operator
  * \param[in]  			v 		the vector to use for the krylov subspace
  * \param[in] 			sc 		the error scaling vector
- * \param[out] 			beta 	the norm of the v vector
- * \param[out]			Vm 		the arnoldi basis matrix
- * \param[out]			Hm 		the constructed Hessenberg matrix, used in actual exponentials
+ * \param[in,out] 		beta 	the norm of the v vector (an input if `m_basis > 0`)
+ * \param[in,out]		Vm 		the arnoldi basis matrix
+ * \param[in,out]		Hm 		the constructed Hessenberg matrix, used in actual exponentials
  * \param[out] 			phiHm   the exponential matrix computed from h * scale * Hm
+ * \param[in]			m_start	the size of a previous projection, the error is first checked at the largest size of #index_list below it (zero to check every size)
+ * \param[in]			m_basis	the size of a previous projection of `v` (with the same `J`) still held in `Vm`, `Hm` and `beta`, which is resumed rather than rebuilt (zero to start from scratch)
+ *
+ * The returned `Vm`, `Hm` and `beta` may be passed back with `m_basis = m`, as long as `v` and `J` are unchanged and
+ * the projection did not end in a happy breakdown (`Hm(m, m + 1)` below the breakdown tolerance), as `Vm(m)` is then never formed.
  */
 static inline
-int arnoldi(const double scale, const int p, const double h, const double* A, const double* v, const double* sc, double* beta, double* Vm, double* Hm, double* phiHm)
+int arnoldi(const double scale, const int p, const double h, const jac_operator* J, const double* v, const double* sc, double* beta, double* Vm, double* Hm, double* phiHm,
+			const int m_start, const int m_basis)
 {
 	//the temporary work array
 	double w[NSP];
 
-	//first place A*fy in the Vm matrix
-	*beta = normalize(v, Vm);
-
 	double store = 0;
 	int index = 0;
 	int j = 0;
 	double err = 2.0;
+	const double breakdown = breakdown_tolerance();
+
+	if (m_basis > 0)
+	{
+		//resume the iteration from the previous projection
+		j = m_basis;
+		while (index + 1 < NUM_INDICIES && index_list[index] < j)
+			index++;
+	}
+	else
+	{
+		//first place A*fy in the Vm matrix
+		*beta = normalize(v, Vm);
+	}
+	//skip the checks at the sizes well below that of the previous projection
+	while (index + 1 < NUM_INDICIES && index_list[index + 1] < m_start)
+		index++;
 
 	while(err > 1.0)
 	{
 
 		for (; j < index_list[index] && j + p < STRIDE; j++)
 		{
-			sparse_multiplier(A, &Vm[j * NSP], w);
+			jac_operator_multiply(J, &Vm[j * NSP], w);
 			for (int i = 0; i <= j; i++)
 			{
 				Hm[j * STRIDE + i] = dotproduct(w, &Vm[i * NSP]);
 				scale_subtract(Hm[j * STRIDE + i], &Vm[i * NSP], w);
 			}
 			Hm[j * STRIDE + j + 1] = two_norm(w);
-			if (fabs(Hm[j * STRIDE + j + 1]) < ATOL)
+			if (fabs(Hm[j * STRIDE + j + 1]) < breakdown)
 			{
 				//happy breakdown
 				j++;
@@ -104,10 +140,14 @@ int arnoldi(const double scale, const int p, const double h, const double* A, co
 
 #ifdef RB43
 		//2. Get phiHm
+		PHASE_BEGIN(PHASE_PHI);
 		int info = expAc_variable (j + p, Hm, h * scale, phiHm);
+		PHASE_END(PHASE_PHI);
 #elif EXP4
 		//2. Get phiHm
+		PHASE_BEGIN(PHASE_PHI);
 		int info = phiAc_variable (j + p, Hm, h * scale, phiHm);
+		PHASE_END(PHASE_PHI);
 #endif
 		if (info != 0)
 		{
@@ -125,7 +165,7 @@ int arnoldi(const double scale, const int p, const double h, const double* A, co
 #if defined(LOG_OUTPUT) && defined(EXACT_KRYLOV)
 		//kill the error such that we will continue
 		//and greatly reduce the subspace approximation error
-		if (index_list[index] + p < STRIDE  && fabs(Hm[(j - 1) * STRIDE + j]) >= ATOL)
+		if (index_list[index] + p < STRIDE  && fabs(Hm[(j - 1) * STRIDE + j]) >= breakdown)
 		{
 			err = 10;
 		}
@@ -140,4 +180,198 @@ int arnoldi(const double scale, const int p, const double h, const double* A, co
 	return j;
 }
 
+#ifdef KRYLOV_BLOCK
+/**
+ * \fn int arnoldi_block(const double scale, const int p, const double h, const jac_operator* J, const double* v, const double* sc, double* beta, double* Vm, double* Hm, double* phiHm, const int m_shared, const int m_start)
+ * \brief Computes the Krylov projection of `v` by extending that of another vector (with the same `J`) by block Arnoldi steps
+ * \returns				m - the ending size of the matrix, #STRIDE if `m_shared` leaves no room to extend (i.e. `v` must be projected alone)
+ * \param[in]			scale	the value to scale the timestep by
+ * \param[in]			p		the order of the maximum phi function needed
+ * \param[in]			h		the timestep
+ * \param[in]			J 		the jacobian operator
+ * \param[in]  			v 		the vector to project
+ * \param[in] 			sc 		the error scaling vector
+ * \param[out] 			beta 	the norm of the v vector
+ * \param[in,out]		Vm 		the arnoldi basis matrix, holding the basis of the previous projection on entry
+ * \param[in,out]		Hm 		the constructed (block) Hessenberg matrix, holding that of the previous projection on entry
+ * \param[out] 			phiHm   the exponential matrix computed from h * scale * Hm
+ * \param[in]			m_shared	the size `m` of the previous projection, as returned by arnoldi
+ * \param[in]			m_start	the size of a previous projection of this kind, the error is first checked at the largest size of #index_list below it (zero to check every size)
+ *
+ * The subspace of the previous projection is kept, and `v` is orthogonalized against it.  Its residual
+ * and the last (not yet multiplied) vector of the previous basis form the first block, which is then
+ * extended two vectors at a time: both are multiplied by the Jacobian in one pass (jac_operator_multiply2),
+ * and orthogonalized against the basis in one pass (orthogonalize_pair).  If `v` is close to the previous
+ * subspace, as the nonlinear remainders of consecutive stages are, far fewer new basis vectors are needed
+ * than by projecting `v` from scratch.
+ *
+ * As `v` is not the first basis vector, and the blocks add two basis vectors per step, `Hm` is upper
+ * Hessenberg only up to two subdiagonals and the first column of the augmented matrix is the coefficient
+ * vector of `v / beta`, such that the returned `phiHm` is used exactly as that of arnoldi.  The entries
+ * below the first subdiagonal are cleared before returning, so that `Hm` may be reused by arnoldi.
+ */
+static inline
+int arnoldi_block(const double scale, const int p, const double h, const jac_operator* J, const double* v, const double* sc, double* beta, double* Vm, double* Hm, double* phiHm,
+				  const int m_shared, const int m_start)
+{
+	//the pair of new vectors of a block step
+	double w0[NSP];
+	double w1[NSP];
+	//the coefficients of v in the basis
+	double c[STRIDE] = {0.0};
+
+	int index = 0;
+	int j = m_shared;
+	double err = 2.0;
+	int info = 0;
+	//the returned size, or the failure
+	int m = j;
+#ifdef CONST_TIME_STEP
+	bool full = false;
+#endif
+	const double breakdown = breakdown_tolerance();
+
+	//no previous projection to extend, or no room for its augmented matrix: the caller projects v alone
+	if (m_shared < 1 || m_shared + p >= STRIDE)
+		return STRIDE;
+
+	//the previous projection ended in a happy breakdown, its last basis vector was never formed
+	if (fabs(Hm[(j - 1) * STRIDE + j]) < breakdown)
+		memset(&Vm[j * NSP], 0, NSP * sizeof(double));
+
+	//orthogonalize v against the previous basis (twice, as it may lie close to it)
+	*beta = two_norm(v);
+	memcpy(w0, v, NSP * sizeof(double));
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (int i = 0; i <= j; i++)
+		{
+			double s = dotproduct(w0, &Vm[i * NSP]);
+			c[i] += s;
+			scale_subtract(s, &Vm[i * NSP], w0);
+		}
+	}
+	c[j + 1] = two_norm(w0);
+	if (c[j + 1] < breakdown)
+		memset(&Vm[(j + 1) * NSP], 0, NSP * sizeof(double));
+	else
+		scale_mult(1.0 / c[j + 1], w0, &Vm[(j + 1) * NSP]);
+	if (*beta > 0)
+	{
+		for (int i = 0; i <= j + 1; i++)
+			c[i] /= *beta;
+	}
+	//the previous subspace is invariant and contains v, i.e. the projection is exact
+	const bool exact = fabs(Hm[(j - 1) * STRIDE + j]) < breakdown && c[j + 1] < breakdown;
+
+	//check first after at least one block step
+	while (index + 1 < NUM_INDICIES && index_list[index] <= j)
+		index++;
+	//skip the checks at the sizes well below that of the previous projection
+	while (index + 1 < NUM_INDICIES && index_list[index + 1] < m_start)
+		index++;
+
+	while (err > 1.0)
+	{
+		for (; !exact && j < index_list[index] && j + 2 + p < STRIDE; j += 2)
+		{
+			jac_operator_multiply2(J, &Vm[j * NSP], &Vm[(j + 1) * NSP], w0, w1);
+			orthogonalize_pair(j + 2, Vm, w0, w1, &Hm[j * STRIDE], &Hm[(j + 1) * STRIDE]);
+
+			//QR factorization of the remainder, the next block
+			Hm[j * STRIDE + j + 2] = two_norm(w0);
+			Hm[j * STRIDE + j + 3] = 0.0;
+			if (Hm[j * STRIDE + j + 2] < breakdown)
+			{
+				//(partial) happy breakdown, no new direction
+				Hm[j * STRIDE + j + 2] = 0.0;
+				memset(&Vm[(j + 2) * NSP], 0, NSP * sizeof(double));
+			}
+			else
+				scale_mult(1.0 / Hm[j * STRIDE + j + 2], w0, &Vm[(j + 2) * NSP]);
+			Hm[(j + 1) * STRIDE + j + 2] = dotproduct(w1, &Vm[(j + 2) * NSP]);
+			scale_subtract(Hm[(j + 1) * STRIDE + j + 2], &Vm[(j + 2) * NSP], w1);
+			Hm[(j + 1) * STRIDE + j + 3] = two_norm(w1);
+			if (Hm[(j + 1) * STRIDE + j + 3] < breakdown)
+			{
+				Hm[(j + 1) * STRIDE + j + 3] = 0.0;
+				memset(&Vm[(j + 3) * NSP], 0, NSP * sizeof(double));
+			}
+			else
+				scale_mult(1.0 / Hm[(j + 1) * STRIDE + j + 3], w1, &Vm[(j + 3) * NSP]);
+		}
+		if (!exact && j < index_list[index])
+		{
+			//out of space
+#ifdef CONST_TIME_STEP
+			full = true;
+			if (j == m_shared)
+#endif
+			{
+				m = j + 2;
+				break;
+			}
+		}
+		//the next size to check at
+		while (index + 1 < NUM_INDICIES && index_list[index] <= j)
+			index++;
+
+		//resize Hm to be mxm, and store the entries coupling it to the next block for later
+		const double store0 = j > 1 ? Hm[(j - 2) * STRIDE + j] : 0.0;
+		const double store1 = Hm[(j - 1) * STRIDE + j];
+		const double store2 = Hm[(j - 1) * STRIDE + j + 1];
+		if (j > 1)
+			Hm[(j - 2) * STRIDE + j] = 0.0;
+		Hm[(j - 1) * STRIDE + j] = 0.0;
+		Hm[(j - 1) * STRIDE + j + 1] = 0.0;
+
+		//1. Construct augmented Hm, with the coefficients of v in place of e1
+		memset(&Hm[j * STRIDE], 0, (j + 2) * sizeof(double));
+		for (int i = 0; i < j; i++)
+			Hm[j * STRIDE + i] = c[i];
+		for (int i = 1; i < p; i++)
+		{
+			//0. fill potentially non-empty memory first
+			memset(&Hm[(j + i) * STRIDE], 0, (j + i + 2) * sizeof(double));
+			Hm[(j + i) * STRIDE + (j + i - 1)] = 1.0;
+		}
+
+		//2. Get phiHm
+		PHASE_BEGIN(PHASE_PHI);
+		info = expAc_block (j + p, Hm, h * scale, phiHm);
+		PHASE_END(PHASE_PHI);
+
+		//restore Hm
+		if (j > 1)
+			Hm[(j - 2) * STRIDE + j] = store0;
+		Hm[(j - 1) * STRIDE + j] = store1;
+		Hm[(j - 1) * STRIDE + j + 1] = store2;
+		if (info != 0)
+		{
+			m = -info;
+			break;
+		}
+
+		//3. Get error, from the residual of the projection in the next block
+		for (int i = 0; i < NSP; ++i)
+		{
+			w0[i] = ((j > 1 ? store0 * phiHm[j * STRIDE + j - 2] : 0.0) + store1 * phiHm[j * STRIDE + j - 1]) * Vm[j * NSP + i]
+					+ store2 * phiHm[j * STRIDE + j - 1] * Vm[(j + 1) * NSP + i];
+		}
+		err = h * (*beta) * sc_norm(w0, sc);
+		m = j;
+#ifdef CONST_TIME_STEP
+		if (full)
+			break;
+#endif
+	}
+
+	//clear the second subdiagonal
+	for (int i = m_shared; i < j; i++)
+		Hm[i * STRIDE + i + 2] = 0.0;
+
+	return m;
+}
+#endif
+
 #endif
\ No newline at end of file
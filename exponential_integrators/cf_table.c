@@ -0,0 +1,60 @@
+/**
+ * \file
+ * \brief Build-time generator of the rational approximant table
+ *
+ * If #RA_TABLE is defined, SCons compiles and runs this program (with the Carathéodory-Fejér
+ * code in cf.c) once per build, writing the poles and residues of the (#N_RA, #N_RA) rational
+ * approximant to rational_approximant_table.h.  The exponential integrators then read the table
+ * in find_poles_and_residuals(), rather than computing the approximant on every start.
+ *
+ * Usage: cf_table [output file]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "cf.h"
+#include "solver_options.h"
+
+/**
+ * \brief Writes the `n` entries of `v` as a C array initializer
+ */
+static void write_array(FILE* file, const char* name, const double* v, const int n)
+{
+    fprintf(file, "static const double %s[%d] = {", name, n);
+    for (int i = 0; i < n; ++i)
+        fprintf(file, "%s%.17e", i ? ", " : "", v[i]);
+    fprintf(file, "};\n");
+}
+
+int main(int argc, char* argv[])
+{
+    FILE* file = argc > 1 ? fopen(argv[1], "w") : stdout;
+    if (file == NULL)
+    {
+        printf("Error opening %s for writing.\n", argv[1]);
+        exit(-1);
+    }
+
+    double poles_r[N_RA];
+    double poles_i[N_RA];
+    double res_r[N_RA];
+    double res_i[N_RA];
+    cf (N_RA, poles_r, poles_i, res_r, res_i);
+
+    fprintf(file, "/*! \\file\n\n"
+                  "\\brief The poles and residues of the rational approximant to the matrix exponential\n\n"
+                  "Autogenerated at build time by cf_table.c, for N_RA = %d and ATOL = %.17e\n"
+                  "*/\n\n", N_RA, ATOL);
+    fprintf(file, "#ifndef RA_TABLE_H\n#define RA_TABLE_H\n\n");
+    fprintf(file, "/*! The order of the tabulated rational approximant */\n#define RA_TABLE_ORDER (%d)\n", N_RA);
+    write_array(file, "ra_poles_r", poles_r, N_RA);
+    write_array(file, "ra_poles_i", poles_i, N_RA);
+    write_array(file, "ra_res_r", res_r, N_RA);
+    write_array(file, "ra_res_i", res_i, N_RA);
+    fprintf(file, "\n#endif\n");
+
+    if (file != stdout)
+        fclose(file);
+    return 0;
+}
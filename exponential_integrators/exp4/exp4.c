@@ -21,12 +21,15 @@
 
 #include "header.h"
 #include "dydt.h"
-#include "jacob.h"
+#include "jac_operator.h"
+#include "lazy_jacobian.h"
 #include "arnoldi.h"
+#include "solver_stats.h"
+#include "phase_profile.h"
+#include "warm_start.h"
 #include "exp4_props.h"
 #include "exponential_linear_algebra.h"
 #include "solver_init.h"
-#include "sparse_multiplier.h"
 
 #ifdef GENERATE_DOCS
 namespace exp4 {
@@ -56,6 +59,16 @@ int integrate (const double t_start, const double t_end, const double pr, double
 	double err_old = 1.0;
 	double h_old = h;
 
+#ifdef SOLVER_WARM_START
+	warm_start_memory* ws = current_warm_start;
+	if (ws->valid) {
+		// continue from the step size and error history of the previous call
+		h = fmin(ws->h, t_end - t_start);
+		h_old = ws->h_old;
+		err_old = ws->err_old;
+	}
+#endif
+
 	bool reject = false;
 	int failures = 0;
 	int steps = 0;
@@ -87,8 +100,8 @@ int integrate (const double t_start, const double t_end, const double pr, double
 	double beta = 0;
 	// source vector
 	double fy[NSP];
-	// Jacobian matrix
-	double A[NSP * NSP] = {0.0};
+	// Jacobian operator
+	jac_operator A = {0};
 
 	// temporary arrays
 	double temp[NSP];
@@ -97,7 +110,28 @@ int integrate (const double t_start, const double t_end, const double pr, double
 	double Hm[STRIDE * STRIDE] = {0.0};
 	double Vm[NSP * STRIDE];
 	double phiHm[STRIDE * STRIDE];
+#ifdef KRYLOV_RECYCLE
+	//the projection of fy is kept apart from those of k4 and k7, to be resumed after a rejected step
+	double Hm_fy[STRIDE * STRIDE] = {0.0};
+	double Vm_fy[NSP * STRIDE];
+	//the number of Arnoldi vectors of the projection of fy that are valid for the current Jacobian
+	int m_basis = 0;
+	//the Krylov subspace sizes of the last step, the starting sizes of the next
+	int m_prev[3] = {0, 0, 0};
+#else
+	double* const Hm_fy = Hm;
+	double* const Vm_fy = Vm;
+	const int m_basis = 0;
+	const int m_prev[3] = {0, 0, 0};
+#endif
+	double beta_fy = 0;
 	double err = 0.0;
+#ifdef LAZY_JACOBIAN
+	//the number of accepted steps taken with the Jacobian, negative before its first evaluation
+	int jac_age = -1;
+	//the step size at the evaluation of the Jacobian
+	double h_jac = h;
+#endif
 
 	// i-vectors
 	double k1[NSP];
@@ -125,37 +159,74 @@ int integrate (const double t_start, const double t_end, const double pr, double
 		}
 
 		if (!reject) {
+			PHASE_BEGIN(PHASE_RHS);
 			dydt (t, pr, y, fy);
-			eval_jacob (t, pr, y, A);
+			PHASE_END(PHASE_RHS);
 		}
+#ifdef LAZY_JACOBIAN
+		bool update_jac = lazy_jacobian_stale(reject, jac_age, err, h / h_jac);
+#else
+		bool update_jac = !reject;
+#endif
+		if (update_jac) {
+			PHASE_BEGIN(PHASE_JACOBIAN);
+			jac_operator_update (&A, t, pr, y, fy);
+			PHASE_END(PHASE_JACOBIAN);
+			STAT_INC(STAT_JAC_EVALS);
+#ifdef LAZY_JACOBIAN
+			if (reject)
+				STAT_INC(STAT_JAC_STALE_REJECTS);
+			jac_age = 0;
+			h_jac = h;
+#endif
+		}
+#ifdef KRYLOV_RECYCLE
+		if (!reject || update_jac) {
+			m_basis = 0;
+		}
+#endif
 
 		//do arnoldi
-		int m = arnoldi(1.0 / 3.0, P, h, A, fy, sc, &beta, Vm, Hm, phiHm);
+		PHASE_BEGIN(PHASE_KRYLOV);
+		int m = arnoldi(1.0 / 3.0, P, h, &A, fy, sc, &beta_fy, Vm_fy, Hm_fy, phiHm, m_prev[0], m_basis);
+		PHASE_END(PHASE_KRYLOV);
+		STAT_INC(STAT_KRYLOV_CALLS);
+		STAT_ADD(STAT_KRYLOV_RECYCLED, m_basis);
 		if (m + P >= STRIDE || m < 0)
 		{
+#ifdef KRYLOV_RECYCLE
+			m_basis = 0;
+#endif
 			//need to reduce h and try again
 			h /= 5.0;
 			failures++;
+			STAT_INC(STAT_REJECTED);
 			reject = true;
 			continue;
 		}
+		STAT_ADD(STAT_KRYLOV_SIZE, m);
+#ifdef KRYLOV_RECYCLE
+		//a projection that ended in a happy breakdown never formed its last basis vector, and is not resumed
+		m_basis = fabs(Hm_fy[(m - 1) * STRIDE + m]) < breakdown_tolerance() ? 0 : m;
+		m_prev[0] = m;
+#endif
 
 		//k1 is partially in the first column of phiHm
 		//k1 = beta * Vm * phiHm(:, 1)
-		matvec_n_by_m_scale(m, beta, Vm, phiHm, k1);
+		matvec_n_by_m_scale(m, beta_fy, Vm_fy, phiHm, k1);
 
 		//k2
 		//computing phi(2h * A)
 		matvec_m_by_m (m, phiHm, phiHm, temp);
 		//note: f_temp will contain hm * phi * phi * e1 for later use
-		matvec_m_by_m (m, Hm, temp, f_temp);
-		matvec_n_by_m_scale_add(m, beta * (h / 6.0), Vm, f_temp, k2, k1);
+		matvec_m_by_m (m, Hm_fy, temp, f_temp);
+		matvec_n_by_m_scale_add(m, beta_fy * (h / 6.0), Vm_fy, f_temp, k2, k1);
 
 		//k3
 		//use the stored hm * phi * phi * e1 to get phi(3h * A)
 		matvec_m_by_m (m, phiHm, f_temp, temp);
-		matvec_m_by_m (m, Hm, temp, f_temp);
-		matvec_n_by_m_scale_add_subtract(m, beta * (h * h / 27.0), Vm, f_temp, k3, k2, k1);
+		matvec_m_by_m (m, Hm_fy, temp, f_temp);
+		matvec_n_by_m_scale_add_subtract(m, beta_fy * (h * h / 27.0), Vm_fy, f_temp, k3, k2, k1);
 
 		// d4
 
@@ -166,8 +237,10 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			k4[i] = y[i] + f_temp[i];
 		}
 
+		PHASE_BEGIN(PHASE_RHS);
 		dydt (t, pr, k4, temp);
-		sparse_multiplier (A, f_temp, k4);
+		PHASE_END(PHASE_RHS);
+		jac_operator_multiply (&A, f_temp, k4);
 
 
 		for (int i = 0; i < NSP; ++i) {
@@ -175,15 +248,23 @@ int integrate (const double t_start, const double t_end, const double pr, double
 		}
 
 		//do arnoldi
-		int m1 = arnoldi(1.0 / 3.0, P, h, A, k4, sc, &beta, Vm, Hm, phiHm);
+		PHASE_BEGIN(PHASE_KRYLOV);
+		int m1 = arnoldi(1.0 / 3.0, P, h, &A, k4, sc, &beta, Vm, Hm, phiHm, m_prev[1], 0);
+		PHASE_END(PHASE_KRYLOV);
+		STAT_INC(STAT_KRYLOV_CALLS);
 		if (m1 + P >= STRIDE || m1 < 0)
 		{
 			//need to reduce h and try again
 			h /= 5.0;
 			failures++;
+			STAT_INC(STAT_REJECTED);
 			reject = true;
 			continue;
 		}
+		STAT_ADD(STAT_KRYLOV_SIZE, m1);
+#ifdef KRYLOV_RECYCLE
+		m_prev[1] = m1;
+#endif
 		//k4 is partially in the m'th column of phiHm
 		matvec_n_by_m_scale(m1, beta, Vm, phiHm, k4);
 
@@ -209,23 +290,33 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			k7[i] = y[i] + f_temp[i];
 		}
 
+		PHASE_BEGIN(PHASE_RHS);
 		dydt (t, pr, k7, temp);
-		sparse_multiplier (A, f_temp, k7);
+		PHASE_END(PHASE_RHS);
+		jac_operator_multiply (&A, f_temp, k7);
 
 
 		for (int i = 0; i < NSP; ++i) {
 			k7[i] = temp[i] - fy[i] - k7[i];
 		}
 
-		int m2 = arnoldi(1.0 / 3.0, P, h, A, k7, sc, &beta, Vm, Hm, phiHm);
+		PHASE_BEGIN(PHASE_KRYLOV);
+		int m2 = arnoldi(1.0 / 3.0, P, h, &A, k7, sc, &beta, Vm, Hm, phiHm, m_prev[2], 0);
+		PHASE_END(PHASE_KRYLOV);
+		STAT_INC(STAT_KRYLOV_CALLS);
 		if (m2 + P >= STRIDE || m2 < 0)
 		{
 			//need to reduce h and try again
 			h /= 5.0;
 			failures++;
+			STAT_INC(STAT_REJECTED);
 			reject = true;
 			continue;
 		}
+		STAT_ADD(STAT_KRYLOV_SIZE, m2);
+#ifdef KRYLOV_RECYCLE
+		m_prev[2] = m2;
+#endif
 		//k7 is partially in the m'th column of phiHm
 		matvec_n_by_m_scale(m2, beta / (h / 3.0), Vm, &phiHm[m2 * STRIDE], k7);
 
@@ -255,6 +346,12 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			temp[i] = -k1[i] + 2.0 * k2[i] - k4[i] + k7[i] - (y1[i] - y[i]) / h;
 		}
 		//double err_W = h * sc_norm(temp, sc);
+#ifdef LAZY_JACOBIAN
+		// the embedded order 3 method assumes the exact Jacobian, hence a reused Jacobian must satisfy both estimates
+		if (jac_age > 0)
+			err = fmax(EPS, fmax(err, h * sc_norm(temp, f_temp)));
+		else
+#endif
 		err = fmax(EPS, fmin(err, h * sc_norm(temp, f_temp)));
 
 		// classical step size calculation
@@ -282,11 +379,19 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			err_old = fmax(1.0e-2, err);
 			h_old = h;
 
+			STAT_INC(STAT_STEPS);
+#ifdef LAZY_JACOBIAN
+			STAT_ADD(STAT_JAC_AGE, jac_age);
+			jac_age++;
+#endif
 			// check if last step rejected
 			if (reject) {
 				reject = false;
 				h_new = fmin(h, h_new);
 			}
+#ifdef SOLVER_WARM_START
+			ws->h = h_new;
+#endif
 			h = fmin(h_new, t_end - t);
 
 		} else {
@@ -300,12 +405,18 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			h_new = fmin(h_new, t_end - t);
 
 
+			STAT_INC(STAT_REJECTED);
 			reject = true;
 			h = fmin(h, h_new);
 		}
 #else
 		//constant time stepping
 		// update y and t
+		STAT_INC(STAT_STEPS);
+#ifdef LAZY_JACOBIAN
+		STAT_ADD(STAT_JAC_AGE, jac_age);
+		jac_age++;
+#endif
 		for (int i = 0; i < NSP; ++i) {
 			y[i] = y1[i];
 		}
@@ -320,6 +431,12 @@ int integrate (const double t_start, const double t_end, const double pr, double
 		fclose(rFile);
 	#endif
 
+#ifdef SOLVER_WARM_START
+	ws->h_old = h_old;
+	ws->err_old = err_old;
+	ws->valid = true;
+#endif
+
 	return EC_success;
 
 }
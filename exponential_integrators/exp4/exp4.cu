@@ -27,11 +27,8 @@
 #include "solver_props.cuh"
 
 #include "dydt.cuh"
-#ifndef FINITE_DIFFERENCE
-	#include "jacob.cuh"
-#else
-	#include "fd_jacob.cuh"
-#endif
+#include "jac_operator.cuh"
+#include "lazy_jacobian.cuh"
 #include "arnoldi.cuh"
 #include "exponential_linear_algebra.cuh"
 #include "solver_init.cuh"
@@ -82,8 +79,23 @@ void integrate (const double t_start, const double t_end, const double pr,
 
 	double err_old = 1.0;
 	double h_old = h;
+#ifdef SOLVER_WARM_START
+	double * const __restrict__ warm = solver->warm;
+	if (warm[INDEX(0)] > 0) {
+		// continue from the step size and error history of the previous kernel call
+		h = fmin(warm[INDEX(0)], t_end - t_start);
+		h_old = warm[INDEX(1)];
+		err_old = warm[INDEX(2)];
+	}
+#endif
 	double beta = 0;
 	double err = 0.0;
+#ifdef LAZY_JACOBIAN
+	//the number of accepted steps taken with the Jacobian (in mechanism_memory::jac), negative before its first evaluation
+	int jac_age = -1;
+	//the step size at the evaluation of the Jacobian
+	double h_jac = h;
+#endif
 
 	bool reject = false;
 	int failures = 0;
@@ -93,15 +105,32 @@ void integrate (const double t_start, const double t_end, const double pr,
 
 	//arrays
 	double * const __restrict__ sc = solver->sc;
+	double const * const __restrict__ tol = solver->tol;
 	double * const __restrict__ work1 = solver->work1;
 	double * const __restrict__ work2 = solver->work2;
 	double * const __restrict__ y1 = solver->work3;
 	cuDoubleComplex * const __restrict__ work4 = solver->work4;
 	double * const __restrict__ fy = mech->dy;
-	double * const __restrict__ A = mech->jac;
+	jac_operator A;
+	jac_operator_init(&A, mech, solver);
 	double * const __restrict__ Hm = solver->Hm;
 	double * const __restrict__ Vm = solver->Vm;
 	double * const __restrict__ phiHm = solver->phiHm;
+#ifdef KRYLOV_RECYCLE
+	//the projection of fy is kept apart from those of k4 and k7, to be resumed after a rejected step
+	double * const __restrict__ Hm_fy = solver->Hm_fy;
+	double * const __restrict__ Vm_fy = solver->Vm_fy;
+	//the number of Arnoldi vectors of the projection of fy that are valid for the current Jacobian
+	int m_basis = 0;
+	//the Krylov subspace sizes of the last step, the starting sizes of the next
+	int m_prev[3] = {0, 0, 0};
+#else
+	double * const __restrict__ Hm_fy = Hm;
+	double * const __restrict__ Vm_fy = Vm;
+	const int m_basis = 0;
+	const int m_prev[3] = {0, 0, 0};
+#endif
+	double beta_fy = 0;
 	double * const __restrict__ k1 = solver->k1;
 	double * const __restrict__ k2 = solver->k2;
 	double * const __restrict__ k3 = solver->k3;
@@ -112,7 +141,8 @@ void integrate (const double t_start, const double t_end, const double pr,
 	int * const __restrict__ result = solver->result;
 
 	// get scaling for weighted norm
-	scale_init(y, sc);
+	STAT_RESET(solver);
+	scale_init(y, sc, tol);
 
 	//initial krylov subspace sizes
 	while (t < t_end) {
@@ -135,44 +165,77 @@ void integrate (const double t_start, const double t_end, const double pr,
 		}
 
 		if (!reject) {
+			PHASE_BEGIN(solver, PHASE_RHS);
 			dydt (t, pr, y, fy, mech);
-		#ifdef FINITE_DIFFERENCE
-			eval_jacob (t, pr, y, A, mech, work1, work2);
-		#else
-			eval_jacob (t, pr, y, A, mech);
-		#endif
+			PHASE_END(solver, PHASE_RHS);
+		}
+#ifdef LAZY_JACOBIAN
+		bool update_jac = lazy_jacobian_stale(reject, jac_age, err, h / h_jac);
+#else
+		bool update_jac = !reject;
+#endif
+		if (update_jac) {
+			PHASE_BEGIN(solver, PHASE_JACOBIAN);
+			jac_operator_update (&A, t, pr, y, fy, work1, work2);
+			PHASE_END(solver, PHASE_JACOBIAN);
+			STAT_INC(solver, STAT_JAC_EVALS);
+#ifdef LAZY_JACOBIAN
+			if (reject)
+				STAT_INC(solver, STAT_JAC_STALE_REJECTS);
+			jac_age = 0;
+			h_jac = h;
+#endif
 		}
+#ifdef KRYLOV_RECYCLE
+		if (!reject || update_jac) {
+			m_basis = 0;
+		}
+#endif
 
 		#ifdef DIVERGENCE_TEST
 		integrator_steps[T_ID]++;
 		#endif
-		int m = arnoldi(1.0 / 3.0, P, h, A, solver, fy, &beta, work1, work4);
+		PHASE_BEGIN(solver, PHASE_KRYLOV);
+		int m = arnoldi(1.0 / 3.0, P, h, &A, solver, fy, &beta_fy, Vm_fy, Hm_fy, work1, work4, m_prev[0], m_basis);
+		PHASE_END(solver, PHASE_KRYLOV);
+		STAT_INC(solver, STAT_KRYLOV_CALLS);
+		STAT_ADD(solver, STAT_KRYLOV_RECYCLED, m_basis);
 		if (m + P >= STRIDE || m < 0)
 		{
+#ifdef KRYLOV_RECYCLE
+			m_basis = 0;
+#endif
 			//need to reduce h and try again
 			h /= 5.0;
 			failures++;
+			STAT_INC(solver, STAT_REJECTED);
 			reject = true;
 			continue;
 		}
+		STAT_ADD(solver, STAT_KRYLOV_SIZE, m);
+#ifdef KRYLOV_RECYCLE
+		//a projection that ended in a happy breakdown never formed its last basis vector, and is not resumed
+		m_basis = fabs(Hm_fy[INDEX((m - 1) * STRIDE + m)]) < ATOL ? 0 : m;
+		m_prev[0] = m;
+#endif
 
 		// k1
 		//k1 is partially in the first column of phiHm
 		//k1 = beta * Vm * phiHm(:, 1)
-		matvec_n_by_m_scale(m, beta, Vm, phiHm, k1);
+		matvec_n_by_m_scale(m, beta_fy, Vm_fy, phiHm, k1);
 
 		// k2
 		//computing phi(2h * A)
 		matvec_m_by_m (m, phiHm, phiHm, work1);
 		//note: work2 will contain hm * phi * phi * e1 for later use
-		matvec_m_by_m (m, Hm, work1, work2);
-		matvec_n_by_m_scale_add(m, beta * (h / 6.0), Vm, work2, k2, k1);
+		matvec_m_by_m (m, Hm_fy, work1, work2);
+		matvec_n_by_m_scale_add(m, beta_fy * (h / 6.0), Vm_fy, work2, k2, k1);
 
 		// k3
 		//use the stored hm * phi * phi * e1 to get phi(3h * A)
 		matvec_m_by_m (m, phiHm, work2, work1);
-		matvec_m_by_m (m, Hm, work1, work2);
-		matvec_n_by_m_scale_add_subtract(m, beta * (h * h / 27.0), Vm, work2, k3, k2, k1);
+		matvec_m_by_m (m, Hm_fy, work1, work2);
+		matvec_n_by_m_scale_add_subtract(m, beta_fy * (h * h / 27.0), Vm_fy, work2, k3, k2, k1);
 
 		// d4
 		#pragma unroll
@@ -183,8 +246,10 @@ void integrate (const double t_start, const double t_end, const double pr,
 			k4[INDEX(i)] = y[INDEX(i)] + work2[INDEX(i)];
 		}
 
+		PHASE_BEGIN(solver, PHASE_RHS);
 		dydt (t, pr, k4, work1, mech);
-		sparse_multiplier (A, work2, k4);
+		PHASE_END(solver, PHASE_RHS);
+		jac_operator_multiply (&A, work2, k4);
 
 		#pragma unroll
 		for (int i = 0; i < NSP; ++i) {
@@ -192,15 +257,23 @@ void integrate (const double t_start, const double t_end, const double pr,
 		}
 
 		//do arnoldi
-		int m1 = arnoldi(1.0 / 3.0, P, h, A, solver, k4, &beta, work1, work4);
+		PHASE_BEGIN(solver, PHASE_KRYLOV);
+		int m1 = arnoldi(1.0 / 3.0, P, h, &A, solver, k4, &beta, Vm, Hm, work1, work4, m_prev[1], 0);
+		PHASE_END(solver, PHASE_KRYLOV);
+		STAT_INC(solver, STAT_KRYLOV_CALLS);
 		if (m1 + P >= STRIDE || m1 < 0)
 		{
 			//need to reduce h and try again
 			h /= 5.0;
 			failures++;
+			STAT_INC(solver, STAT_REJECTED);
 			reject = true;
 			continue;
 		}
+		STAT_ADD(solver, STAT_KRYLOV_SIZE, m1);
+#ifdef KRYLOV_RECYCLE
+		m_prev[1] = m1;
+#endif
 		//k4 is partially in the m'th column of phiHm
 		matvec_n_by_m_scale(m1, beta, Vm, phiHm, k4);
 
@@ -226,23 +299,33 @@ void integrate (const double t_start, const double t_end, const double pr,
 			k7[INDEX(i)] = y[INDEX(i)] + work2[INDEX(i)];
 		}
 
+		PHASE_BEGIN(solver, PHASE_RHS);
 		dydt (t, pr, k7, work1, mech);
-		sparse_multiplier (A, work2, k7);
+		PHASE_END(solver, PHASE_RHS);
+		jac_operator_multiply (&A, work2, k7);
 
 		#pragma unroll
 		for (int i = 0; i < NSP; ++i) {
 			k7[INDEX(i)] = work1[INDEX(i)] - fy[INDEX(i)] - k7[INDEX(i)];
 		}
 
-		int m2 = arnoldi(1.0 / 3.0, P, h, A, solver, k7, &beta, work1, work4);
+		PHASE_BEGIN(solver, PHASE_KRYLOV);
+		int m2 = arnoldi(1.0 / 3.0, P, h, &A, solver, k7, &beta, Vm, Hm, work1, work4, m_prev[2], 0);
+		PHASE_END(solver, PHASE_KRYLOV);
+		STAT_INC(solver, STAT_KRYLOV_CALLS);
 		if (m2 + P >= STRIDE || m2 < 0)
 		{
 			//need to reduce h and try again
 			h /= 5.0;
 			failures++;
+			STAT_INC(solver, STAT_REJECTED);
 			reject = true;
 			continue;
 		}
+		STAT_ADD(solver, STAT_KRYLOV_SIZE, m2);
+#ifdef KRYLOV_RECYCLE
+		m_prev[2] = m2;
+#endif
 		//k7 is partially in the m'th column of phiHm
 		matvec_n_by_m_scale(m2, beta / (h / 3.0), Vm, &phiHm[GRID_DIM * m2 * STRIDE], k7);
 
@@ -252,7 +335,7 @@ void integrate (const double t_start, const double t_end, const double pr,
 			y1[INDEX(i)] = y[INDEX(i)] + h * (k3[INDEX(i)] + k4[INDEX(i)] - (4.0 / 3.0) * k5[INDEX(i)] + k6[INDEX(i)] + (1.0 / 6.0) * k7[INDEX(i)]);
 		}
 
-		scale (y, y1, work2);
+		scale (y, y1, work2, tol);
 
 		///////////////////
 		// calculate errors
@@ -271,6 +354,12 @@ void integrate (const double t_start, const double t_end, const double pr,
 			work1[INDEX(i)] = -k1[INDEX(i)] + 2.0 * k2[INDEX(i)] - k4[INDEX(i)] + k7[INDEX(i)] - (y1[INDEX(i)] - y[INDEX(i)]) / h;
 		}
 		//double err_W = h * sc_norm(temp, sc);
+#ifdef LAZY_JACOBIAN
+		// the embedded order 3 method assumes the exact Jacobian, hence a reused Jacobian must satisfy both estimates
+		if (jac_age > 0)
+			err = fmax(EPS, fmax(err, h * sc_norm(work1, work2)));
+		else
+#endif
 		err = fmax(EPS, fmin(err, h * sc_norm(work1, work2)));
 
 		// classical step size calculation
@@ -298,12 +387,20 @@ void integrate (const double t_start, const double t_end, const double pr,
 			// store time step and error
 			err_old = fmax(1.0e-2, err);
 			h_old = h;
+			STAT_INC(solver, STAT_STEPS);
+#ifdef LAZY_JACOBIAN
+			STAT_ADD(solver, STAT_JAC_AGE, jac_age);
+			jac_age++;
+#endif
 
 			// check if last step rejected
 			if (reject) {
 				reject = false;
 				h_new = fmin(h, h_new);
 			}
+#ifdef SOLVER_WARM_START
+			warm[INDEX(0)] = h_new;
+#endif
 			h = fmin(h_new, t_end - t);
 
 		} else {
@@ -312,12 +409,18 @@ void integrate (const double t_start, const double t_end, const double pr,
 			h_new = h * fmax(fmin(0.9 * h_new, 8.0), 0.2);
 			h_new = fmin(h_new, t_end - t);
 
+			STAT_INC(solver, STAT_REJECTED);
 			reject = true;
 			h = fmin(h, h_new);
 		}
 #else
 		//constant time stepping
 		//update y & t
+		STAT_INC(solver, STAT_STEPS);
+#ifdef LAZY_JACOBIAN
+		STAT_ADD(solver, STAT_JAC_AGE, jac_age);
+		jac_age++;
+#endif
 		#pragma unroll
 		for (int i = 0; i < NSP; ++i)
 		{
@@ -328,6 +431,10 @@ void integrate (const double t_start, const double t_end, const double pr,
 
 	} // end while
 
+#ifdef SOLVER_WARM_START
+	warm[INDEX(1)] = h_old;
+	warm[INDEX(2)] = err_old;
+#endif
 	result[T_ID] = EC_success;
 }
 
@@ -7,6 +7,7 @@
  *
  */
 
+#include <stddef.h>
 #include "rational_approximant.h"
 
 #ifdef GENERATE_DOCS
@@ -43,13 +44,15 @@ void init_solver_log() {
 void solver_log() {
 }
 
-/*! \fn void initialize_solver(int num_threads)
+/*! \fn void* initialize_solver(int num_threads)
    \brief Initializes the solver
    \param num_threads The number of OpenMP threads to use
 */
-void initialize_solver(int num_threads) {
+void* initialize_solver(int num_threads) {
     //Solves for the poles and residuals used for the Rational Approximants in the Krylov subspace methods
  	find_poles_and_residuals();
+ 	//no per-thread memory is kept
+ 	return NULL;
 }
 
 /*!
@@ -61,7 +64,7 @@ const char* solver_name() {
  	return name;
 }
 
-void cleanup_solver(int num_threads) {
+void cleanup_solver(int num_threads, void* memory) {
 }
 
 #ifdef GENERATE_DOCS
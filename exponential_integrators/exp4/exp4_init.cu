@@ -11,6 +11,11 @@
 #include "solver_options.cuh"
 #include "solver_props.cuh"
 #include "gpu_macros.cuh"
+#include "gpu_arena.cuh"
+#include "phiAHessenberg.cuh"
+#ifdef FINITE_DIFFERENCE
+#include "fd_jacob.cuh"
+#endif
 
 #ifdef GENERATE_DOCS
 namespace exp4cu {
@@ -24,7 +29,7 @@ namespace exp4cu {
  */
 void createAndZero(void** ptr, size_t size)
 {
-  cudaErrorCheck(cudaMalloc(ptr, size));
+  cudaErrorCheck(arena_malloc(ptr, size));
   cudaErrorCheck(cudaMemset(*ptr, 0, size));
 }
 
@@ -38,20 +43,48 @@ void createAndZero(void** ptr, size_t size)
 */
 void initialize_solver(int padded, solver_memory** h_mem, solver_memory** d_mem) {
     find_poles_and_residuals();
+#if defined(FINITE_DIFFERENCE) && defined(FD_COLORING) && !defined(MATRIX_FREE)
+    initialize_fd_coloring();
+#endif
     // Allocate storage for the device struct
-    cudaErrorCheck( cudaMalloc(d_mem, sizeof(solver_memory)) );
+    cudaErrorCheck( arena_malloc(d_mem, sizeof(solver_memory)) );
     //allocate the device arrays on the host pointer
     createAndZero((void**)&((*h_mem)->sc), NSP * padded * sizeof(double));
     createAndZero((void**)&((*h_mem)->work1), STRIDE * padded * sizeof(double));
     createAndZero((void**)&((*h_mem)->work2), STRIDE * padded * sizeof(double));
-    createAndZero((void**)&((*h_mem)->work3), STRIDE * padded * sizeof(double));
     createAndZero((void**)&((*h_mem)->work4), STRIDE * padded * sizeof(cuDoubleComplex));
     createAndZero((void**)&((*h_mem)->Hm), STRIDE * STRIDE * padded * sizeof(double));
     createAndZero((void**)&((*h_mem)->phiHm), STRIDE * STRIDE * padded * sizeof(double));
     createAndZero((void**)&((*h_mem)->Vm), NSP * STRIDE * padded * sizeof(double));
+#ifdef PHI_TAYLOR
+    createAndZero((void**)&((*h_mem)->phi_work), PHI_TAYLOR_WORK * STRIDE * STRIDE * padded * sizeof(double));
+#else
     createAndZero((void**)&((*h_mem)->ipiv), NSP * padded * sizeof(int));
     createAndZero((void**)&((*h_mem)->invA), STRIDE * STRIDE * padded * sizeof(cuDoubleComplex));
+#endif
+    // y_n+1 (work3) is only live after the last phi function evaluation of the step, hence shares its work storage
+#ifdef PHI_TAYLOR
+    (*h_mem)->work3 = (*h_mem)->phi_work;
+#else
+    (*h_mem)->work3 = (double*)(*h_mem)->invA;
+#endif
     createAndZero((void**)&((*h_mem)->result), padded * sizeof(int));
+#ifdef STATISTICS
+    createAndZero((void**)&((*h_mem)->stats), NUM_STATS * padded * sizeof(int));
+#endif
+#ifdef PROFILE_PHASES
+    createAndZero((void**)&((*h_mem)->phases), 2 * NUM_PHASES * padded * sizeof(long long));
+#endif
+#ifdef SOLVER_WARM_START
+    createAndZero((void**)&((*h_mem)->warm), WARM_SIZE * padded * sizeof(double));
+#endif
+#if defined(MATRIX_FREE) && defined(JAC_VEC_FINITE_DIFFERENCE)
+    createAndZero((void**)&((*h_mem)->y_pert), NSP * padded * sizeof(double));
+#endif
+#ifdef KRYLOV_RECYCLE
+    createAndZero((void**)&((*h_mem)->Hm_fy), STRIDE * STRIDE * padded * sizeof(double));
+    createAndZero((void**)&((*h_mem)->Vm_fy), NSP * STRIDE * padded * sizeof(double));
+#endif
     createAndZero((void**)&((*h_mem)->k1), NSP * padded * sizeof(double));
     createAndZero((void**)&((*h_mem)->k2), NSP * padded * sizeof(double));
     createAndZero((void**)&((*h_mem)->k3), NSP * padded * sizeof(double));
@@ -60,6 +93,7 @@ void initialize_solver(int padded, solver_memory** h_mem, solver_memory** d_mem)
     createAndZero((void**)&((*h_mem)->k6), NSP * padded * sizeof(double));
     createAndZero((void**)&((*h_mem)->k7), NSP * padded * sizeof(double));
 
+    initialize_tolerances(&(*h_mem)->tol);
     //copy host struct to device
     cudaErrorCheck( cudaMemcpy(*d_mem, *h_mem, sizeof(solver_memory), cudaMemcpyHostToDevice) );
  }
@@ -167,8 +201,10 @@ void initialize_solver(int padded, solver_memory** h_mem, solver_memory** d_mem)
   size_t required_solver_size() {
     //return the size (in bytes), needed per cuda thread
     size_t num_bytes = 0;
-    //three work arrays
-    num_bytes += 3 * STRIDE;
+    //scale array
+    num_bytes += NSP;
+    //two work arrays, the third shares the phi function work storage
+    num_bytes += 2 * STRIDE;
     //Hm, phiHm
     num_bytes += 2 * STRIDE * STRIDE;
     //Vm
@@ -177,14 +213,39 @@ void initialize_solver(int padded, solver_memory** h_mem, solver_memory** d_mem)
     num_bytes += 7 * NSP;
     //add all doubles
     num_bytes *= sizeof(double);
+#ifdef PHI_TAYLOR
+    //Taylor phi function work matricies
+    num_bytes += PHI_TAYLOR_WORK * STRIDE * STRIDE * sizeof(double);
+#else
     //one pivot array
     num_bytes += STRIDE * sizeof(int);
     //complex inverse
     num_bytes += STRIDE * STRIDE * sizeof(cuDoubleComplex);
+#endif
     //complex work array
     num_bytes += STRIDE * sizeof(cuDoubleComplex);
     //result flag
     num_bytes += 1 * sizeof(int);
+#ifdef STATISTICS
+    //statistics counters
+    num_bytes += NUM_STATS * sizeof(int);
+#endif
+#ifdef PROFILE_PHASES
+    //phase counters
+    num_bytes += 2 * NUM_PHASES * sizeof(long long);
+#endif
+#ifdef SOLVER_WARM_START
+    //warm start state
+    num_bytes += WARM_SIZE * sizeof(double);
+#endif
+#if defined(MATRIX_FREE) && defined(JAC_VEC_FINITE_DIFFERENCE)
+    //perturbed state vector
+    num_bytes += NSP * sizeof(double);
+#endif
+#ifdef KRYLOV_RECYCLE
+    //Hm_fy, Vm_fy
+    num_bytes += (STRIDE * STRIDE + NSP * STRIDE) * sizeof(double);
+#endif
 
     return num_bytes;
  }
@@ -203,25 +264,45 @@ void initialize_solver(int padded, solver_memory** h_mem, solver_memory** d_mem)
     fclose(rFile);
     fclose(logFile);
  #endif
-    cudaErrorCheck( cudaFree((*h_mem)->sc) );
-    cudaErrorCheck( cudaFree((*h_mem)->work1) );
-    cudaErrorCheck( cudaFree((*h_mem)->work2) );
-    cudaErrorCheck( cudaFree((*h_mem)->work3) );
-    cudaErrorCheck( cudaFree((*h_mem)->work4) );
-    cudaErrorCheck( cudaFree((*h_mem)->Hm) );
-    cudaErrorCheck( cudaFree((*h_mem)->phiHm) );
-    cudaErrorCheck( cudaFree((*h_mem)->Vm) );
-    cudaErrorCheck( cudaFree((*h_mem)->ipiv) );
-    cudaErrorCheck( cudaFree((*h_mem)->invA) );
-    cudaErrorCheck( cudaFree((*h_mem)->result) );
-    cudaErrorCheck( cudaFree((*h_mem)->k1) );
-    cudaErrorCheck( cudaFree((*h_mem)->k2) );
-    cudaErrorCheck( cudaFree((*h_mem)->k3) );
-    cudaErrorCheck( cudaFree((*h_mem)->k4) );
-    cudaErrorCheck( cudaFree((*h_mem)->k5) );
-    cudaErrorCheck( cudaFree((*h_mem)->k6) );
-    cudaErrorCheck( cudaFree((*h_mem)->k7) );
-    cudaErrorCheck( cudaFree(*d_mem) );
+    cudaErrorCheck( arena_free((*h_mem)->sc) );
+    cudaErrorCheck( arena_free((*h_mem)->work1) );
+    cudaErrorCheck( arena_free((*h_mem)->work2) );
+    cudaErrorCheck( arena_free((*h_mem)->work4) );
+    cudaErrorCheck( arena_free((*h_mem)->Hm) );
+    cudaErrorCheck( arena_free((*h_mem)->phiHm) );
+    cudaErrorCheck( arena_free((*h_mem)->Vm) );
+#ifdef PHI_TAYLOR
+    cudaErrorCheck( arena_free((*h_mem)->phi_work) );
+#else
+    cudaErrorCheck( arena_free((*h_mem)->ipiv) );
+    cudaErrorCheck( arena_free((*h_mem)->invA) );
+#endif
+    cudaErrorCheck( arena_free((*h_mem)->result) );
+#ifdef STATISTICS
+    cudaErrorCheck( arena_free((*h_mem)->stats) );
+#endif
+#ifdef PROFILE_PHASES
+    cudaErrorCheck( arena_free((*h_mem)->phases) );
+#endif
+#ifdef SOLVER_WARM_START
+    cudaErrorCheck( arena_free((*h_mem)->warm) );
+#endif
+#if defined(MATRIX_FREE) && defined(JAC_VEC_FINITE_DIFFERENCE)
+    cudaErrorCheck( arena_free((*h_mem)->y_pert) );
+#endif
+#ifdef KRYLOV_RECYCLE
+    cudaErrorCheck( arena_free((*h_mem)->Hm_fy) );
+    cudaErrorCheck( arena_free((*h_mem)->Vm_fy) );
+#endif
+    cudaErrorCheck( arena_free((*h_mem)->k1) );
+    cudaErrorCheck( arena_free((*h_mem)->k2) );
+    cudaErrorCheck( arena_free((*h_mem)->k3) );
+    cudaErrorCheck( arena_free((*h_mem)->k4) );
+    cudaErrorCheck( arena_free((*h_mem)->k5) );
+    cudaErrorCheck( arena_free((*h_mem)->k6) );
+    cudaErrorCheck( arena_free((*h_mem)->k7) );
+    cleanup_tolerances((*h_mem)->tol);
+    cudaErrorCheck( arena_free(*d_mem) );
  }
 
 #ifdef GENERATE_DOCS
@@ -14,7 +14,9 @@ namespace exp4 {
 
 
 #include "header.h"
+#include "solver_options.h"
 #include <stdio.h>
+#include <stdbool.h>
 
 //if defined, uses (I - h * Hm)^-1 to smooth the krylov error vector
 //#define USE_SMOOTHED_ERROR
@@ -33,6 +35,26 @@ namespace exp4 {
 //! Number of consecutive errors on internal integration steps allowed before exit
 #define MAX_CONSECUTIVE_ERRORS (5)
 
+#if defined(WARM_START) && !defined(CONST_TIME_STEP)
+//! The EXP4 solver continues from the step size and error history of the previous call, @see warm_start_memory
+#define SOLVER_WARM_START
+
+/**
+ * \brief The per-IVP state of the EXP4 solver kept between calls to integrate()
+ */
+typedef struct
+{
+    //! true if this struct holds the state at the end of a successful integrate() call
+    bool valid;
+    //! the (unclamped) step size proposed by the last accepted step
+    double h;
+    //! the last accepted step size, for the Gustafsson step size prediction
+    double h_old;
+    //! the (bounded) error estimate of the last accepted step
+    double err_old;
+} warm_start_memory;
+#endif
+
 /**
  * \addtogroup ErrorCodes Return codes of Integrators
  * @{
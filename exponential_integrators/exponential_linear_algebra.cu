@@ -153,20 +153,21 @@ void matvec_n_by_m_scale_add_subtract (const int m, const double scale,
 ///////////////////////////////////////////////////////////////////////////////
 
 __device__
-void scale (const double* __restrict__ y0, const double* __restrict__ y1, double* __restrict__ sc) {
+void scale (const double* __restrict__ y0, const double* __restrict__ y1, double* __restrict__ sc,
+			const double* __restrict__ tol) {
 	#pragma unroll
 	for (int i = 0; i < NSP; ++i) {
-		sc[INDEX(i)] = 1.0 / (ATOL + fmax(fabs(y0[INDEX(i)]), fabs(y1[INDEX(i)])) * RTOL);
+		sc[INDEX(i)] = 1.0 / (TOL_ATOL(tol, i) + fmax(fabs(y0[INDEX(i)]), fabs(y1[INDEX(i)])) * TOL_RTOL(tol));
 	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 __device__
-void scale_init (const double* __restrict__ y0, double* __restrict__ sc) {
+void scale_init (const double* __restrict__ y0, double* __restrict__ sc, const double* __restrict__ tol) {
 	#pragma unroll
 	for (int i = 0; i < NSP; ++i) {
-		sc[INDEX(i)] = 1.0 / (ATOL + fabs(y0[INDEX(i)]) * RTOL);
+		sc[INDEX(i)] = 1.0 / (TOL_ATOL(tol, i) + fabs(y0[INDEX(i)]) * TOL_RTOL(tol));
 	}
 }
 
@@ -241,4 +242,133 @@ __device__ void scale_mult(const double s, const double* __restrict__ w, double*
 	{
 		Vm[INDEX(i)] = w[INDEX(i)] * s;
 	}
-}
\ No newline at end of file
+}
+
+__device__
+double orthogonalize_cgs2(const int j, const double* __restrict__ Vm, double* __restrict__ w,
+						  double* __restrict__ h, double* __restrict__ c, const int stride)
+{
+	//h = Vm^T * w
+	for (int i = 0; i <= j; i++)
+	{
+		h[i * stride] = 0.0;
+		c[i * stride] = 0.0;
+	}
+	#pragma unroll
+	for (int k = 0; k < NSP; k++)
+	{
+		const double wk = w[INDEX(k)];
+		for (int i = 0; i <= j; i++)
+		{
+			h[i * stride] += Vm[INDEX(i * NSP + k)] * wk;
+		}
+	}
+
+	//w -= Vm * h, and c = Vm^T * w of the updated w in the same pass
+	#pragma unroll
+	for (int k = 0; k < NSP; k++)
+	{
+		double wk = w[INDEX(k)];
+		for (int i = 0; i <= j; i++)
+		{
+			wk -= h[i * stride] * Vm[INDEX(i * NSP + k)];
+		}
+		for (int i = 0; i <= j; i++)
+		{
+			c[i * stride] += Vm[INDEX(i * NSP + k)] * wk;
+		}
+		w[INDEX(k)] = wk;
+	}
+
+	//w -= Vm * c, and the norm of the result
+	double norm = 0.0;
+	#pragma unroll
+	for (int k = 0; k < NSP; k++)
+	{
+		double wk = w[INDEX(k)];
+		for (int i = 0; i <= j; i++)
+		{
+			wk -= c[i * stride] * Vm[INDEX(i * NSP + k)];
+		}
+		w[INDEX(k)] = wk;
+		norm += wk * wk;
+	}
+
+	for (int i = 0; i <= j; i++)
+	{
+		h[i * stride] += c[i * stride];
+	}
+	return sqrt(norm);
+}
+
+__device__
+void orthogonalize_pair(const int n, const double* __restrict__ Vm,
+						double* __restrict__ w0, double* __restrict__ w1,
+						double* __restrict__ h0, double* __restrict__ h1,
+						double* __restrict__ c0, double* __restrict__ c1, const int stride)
+{
+	//H = Vm^T * W
+	for (int i = 0; i < n; i++)
+	{
+		h0[i * stride] = 0.0;
+		h1[i * stride] = 0.0;
+		c0[i * stride] = 0.0;
+		c1[i * stride] = 0.0;
+	}
+	#pragma unroll
+	for (int k = 0; k < NSP; k++)
+	{
+		const double w0k = w0[INDEX(k)];
+		const double w1k = w1[INDEX(k)];
+		for (int i = 0; i < n; i++)
+		{
+			const double v = Vm[INDEX(i * NSP + k)];
+			h0[i * stride] += v * w0k;
+			h1[i * stride] += v * w1k;
+		}
+	}
+
+	//W -= Vm * H, and C = Vm^T * W of the updated W in the same pass
+	#pragma unroll
+	for (int k = 0; k < NSP; k++)
+	{
+		double w0k = w0[INDEX(k)];
+		double w1k = w1[INDEX(k)];
+		for (int i = 0; i < n; i++)
+		{
+			const double v = Vm[INDEX(i * NSP + k)];
+			w0k -= h0[i * stride] * v;
+			w1k -= h1[i * stride] * v;
+		}
+		for (int i = 0; i < n; i++)
+		{
+			const double v = Vm[INDEX(i * NSP + k)];
+			c0[i * stride] += v * w0k;
+			c1[i * stride] += v * w1k;
+		}
+		w0[INDEX(k)] = w0k;
+		w1[INDEX(k)] = w1k;
+	}
+
+	//W -= Vm * C
+	#pragma unroll
+	for (int k = 0; k < NSP; k++)
+	{
+		double w0k = w0[INDEX(k)];
+		double w1k = w1[INDEX(k)];
+		for (int i = 0; i < n; i++)
+		{
+			const double v = Vm[INDEX(i * NSP + k)];
+			w0k -= c0[i * stride] * v;
+			w1k -= c1[i * stride] * v;
+		}
+		w0[INDEX(k)] = w0k;
+		w1[INDEX(k)] = w1k;
+	}
+
+	for (int i = 0; i < n; i++)
+	{
+		h0[i * stride] += c0[i * stride];
+		h1[i * stride] += c1[i * stride];
+	}
+}
@@ -13,6 +13,7 @@
 #include "header.cuh"
 #include "solver_options.cuh"
 #include "solver_props.cuh"
+#include "tolerances.cuh"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -153,14 +154,16 @@ void matvec_n_by_m_scale_add_subtract (const int m,
  *  \brief Get scaling for weighted norm
  *
  *	Computes \f$\frac{1.0}{ATOL + \max\left(\left|y0\right|, \left|y1\right|) * RTOL\right)}\f$
+ *	with the tolerances `tol`
  *
  * \param[in]		y0		values at current timestep
  * \param[in]		y1		values at next timestep
  * \param[out]		sc	array of scaling values
+ * \param[in]		tol		the integration tolerances @see tolerances.cuh
  */
 __device__
 void scale (const double* __restrict__ y0,
-	const double* __restrict__ y1, double* __restrict__ sc);
+	const double* __restrict__ y1, double* __restrict__ sc, const double* __restrict__ tol);
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -169,9 +172,10 @@ void scale (const double* __restrict__ y0,
  *
  * \param[in]		y0		values at current timestep
  * \param[out]		sc	array of scaling values
+ * \param[in]		tol		the integration tolerances @see tolerances.cuh
  */
 __device__
-void scale_init (const double* __restrict__ y0, double* __restrict__ sc);
+void scale_init (const double* __restrict__ y0, double* __restrict__ sc, const double* __restrict__ tol);
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -244,4 +248,49 @@ void scale_subtract(const double s, const double* __restrict__ Vm, double* __res
 __device__
 void scale_mult(const double s, const double* __restrict__ w, double* __restrict__ Vm);
 
+/*!
+ * \brief Orthogonalizes w against the first `j + 1` Arnoldi basis vectors by twice iterated classical Gram-Schmidt
+ *
+ * \f$h = V^T w,\; w \mathrel{-}= V h,\; c = V^T w,\; w \mathrel{-}= V c,\; h \mathrel{+}= c\f$
+ *
+ * The basis is read in three passes (the second subtraction and projection share one), such that
+ * each entry of w is loaded once per pass.  The coefficients are strided by `stride`, e.g.
+ * `h = &Hm[INDEX(j * STRIDE)]` with `stride = GRID_DIM`, or a per-thread array in shared memory.
+ *
+ * \param[in]		j		the index of the last basis vector to orthogonalize against
+ * \param[in]		Vm		the Arnoldi basis matrix
+ * \param[in,out]	w		the vector to orthogonalize
+ * \param[out]		h		the `j + 1` projection coefficients, i.e. the Hessenberg column
+ * \param[out]		c		the `j + 1` coefficients of the second pass (scratch)
+ * \param[in]		stride	the distance between consecutive entries of h and c
+ * \returns 		norm - the 2-norm of the orthogonalized w
+ */
+__device__
+double orthogonalize_cgs2(const int j, const double* __restrict__ Vm, double* __restrict__ w,
+						  double* __restrict__ h, double* __restrict__ c, const int stride);
+
+/*!
+ * \brief Orthogonalizes the pair of vectors w0 and w1 against the first `n` Arnoldi basis vectors by twice iterated block classical Gram-Schmidt
+ *
+ * \f$H = V^T W,\; W \mathrel{-}= V H,\; C = V^T W,\; W \mathrel{-}= V C,\; H \mathrel{+}= C\f$ for \f$W = [w_0, w_1]\f$
+ *
+ * As orthogonalize_cgs2, but each of the three passes reads the basis once for both vectors.
+ * The pair itself is not orthogonalized.
+ *
+ * \param[in]		n		the number of basis vectors to orthogonalize against
+ * \param[in]		Vm		the Arnoldi basis matrix
+ * \param[in,out]	w0		the first vector to orthogonalize
+ * \param[in,out]	w1		the second vector to orthogonalize
+ * \param[out]		h0		the `n` projection coefficients of w0
+ * \param[out]		h1		the `n` projection coefficients of w1
+ * \param[out]		c0		the `n` coefficients of the second pass of w0 (scratch)
+ * \param[out]		c1		the `n` coefficients of the second pass of w1 (scratch)
+ * \param[in]		stride	the distance between consecutive entries of the coefficients
+ */
+__device__
+void orthogonalize_pair(const int n, const double* __restrict__ Vm,
+						double* __restrict__ w0, double* __restrict__ w1,
+						double* __restrict__ h0, double* __restrict__ h1,
+						double* __restrict__ c0, double* __restrict__ c1, const int stride);
+
 #endif
\ No newline at end of file
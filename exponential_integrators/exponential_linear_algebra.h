@@ -13,6 +13,7 @@
 #include "header.h"
 #include "solver_options.h"
 #include "solver_props.h"
+#include "tolerances.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -249,6 +250,7 @@ void matvec_n_by_m_scale_add_subtract (const int m, const double scale,
  *  \brief Get scaling for weighted norm
  *
  *	Computes \f$\frac{1.0}{ATOL + \max\left(\left|y0\right|, \left|y1\right|) * RTOL\right)}\f$
+ *	with the tolerances of the current IVP, @see current_tolerances
  *
  * \param[in]		y0		values at current timestep
  * \param[in]		y1		values at next timestep
@@ -258,7 +260,7 @@ static inline
 void scale (const double* __restrict__ y0, const double* __restrict__ y1, double* __restrict__ sc) {
 
 	for (int i = 0; i < NSP; ++i) {
-		sc[i] = 1.0 / (ATOL + fmax(fabs(y0[i]), fabs(y1[i])) * RTOL);
+		sc[i] = 1.0 / (current_tolerances.atol[i] + fmax(fabs(y0[i]), fabs(y1[i])) * current_tolerances.rtol);
 	}
 }
 
@@ -274,7 +276,7 @@ static inline
 void scale_init (const double* __restrict__ y0, double* __restrict__ sc) {
 
 	for (int i = 0; i < NSP; ++i) {
-		sc[i] = 1.0 / (ATOL + fabs(y0[i]) * RTOL);
+		sc[i] = 1.0 / (current_tolerances.atol[i] + fabs(y0[i]) * current_tolerances.rtol);
 	}
 }
 
@@ -400,4 +402,56 @@ static inline void scale_mult(const double s, const double* __restrict__ w, doub
 		Vm[i] = w[i] * s;
 	}
 }
+
+/*!
+ * \brief Orthogonalizes the pair of vectors w0 and w1 against the first `n` Arnoldi basis vectors by twice iterated block classical Gram-Schmidt
+ *
+ * \f$H = V^T W,\; W \mathrel{-}= V H,\; C = V^T W,\; W \mathrel{-}= V C,\; H \mathrel{+}= C\f$ for \f$W = [w_0, w_1]\f$
+ *
+ * Each pass reads the basis once for both vectors, rather than once per vector and basis vector as
+ * modified Gram-Schmidt does.  The pair itself is not orthogonalized.
+ *
+ * \param[in]		n		the number of basis vectors to orthogonalize against
+ * \param[in]		Vm		the Arnoldi basis matrix
+ * \param[in,out]	w0		the first vector to orthogonalize
+ * \param[in,out]	w1		the second vector to orthogonalize
+ * \param[out]		h0		the `n` projection coefficients of w0
+ * \param[out]		h1		the `n` projection coefficients of w1
+ */
+static inline void orthogonalize_pair(const int n, const double* __restrict__ Vm,
+									  double* __restrict__ w0, double* __restrict__ w1,
+									  double* __restrict__ h0, double* __restrict__ h1)
+{
+	double c0[STRIDE];
+	double c1[STRIDE];
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		double* __restrict__ a0 = pass ? c0 : h0;
+		double* __restrict__ a1 = pass ? c1 : h1;
+		for (int i = 0; i < n; i++)
+		{
+			a0[i] = 0.0;
+			a1[i] = 0.0;
+			for (int k = 0; k < NSP; k++)
+			{
+				a0[i] += Vm[i * NSP + k] * w0[k];
+				a1[i] += Vm[i * NSP + k] * w1[k];
+			}
+		}
+		for (int i = 0; i < n; i++)
+		{
+			for (int k = 0; k < NSP; k++)
+			{
+				w0[k] -= a0[i] * Vm[i * NSP + k];
+				w1[k] -= a1[i] * Vm[i * NSP + k];
+			}
+		}
+	}
+	for (int i = 0; i < n; i++)
+	{
+		h0[i] += c0[i];
+		h1[i] += c1[i];
+	}
+}
+
 #endif
\ No newline at end of file
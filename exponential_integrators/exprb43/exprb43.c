@@ -23,9 +23,13 @@
 
 #include "header.h"
 #include "dydt.h"
-#include "jacob.h"
+#include "jac_operator.h"
+#include "lazy_jacobian.h"
 #include "exprb43_props.h"
 #include "arnoldi.h"
+#include "solver_stats.h"
+#include "phase_profile.h"
+#include "warm_start.h"
 #include "exponential_linear_algebra.h"
 #include "solver_init.h"
 
@@ -57,6 +61,16 @@ int integrate (const double t_start, const double t_end, const double pr, double
 	double err_old = 1.0;
 	double h_old = h;
 
+#ifdef SOLVER_WARM_START
+	warm_start_memory* ws = current_warm_start;
+	if (ws->valid) {
+		// continue from the step size and error history of the previous call
+		h = fmin(ws->h, t_end - t_start);
+		h_old = ws->h_old;
+		err_old = ws->err_old;
+	}
+#endif
+
 	bool reject = false;
 	int failures = 0;
 	int steps = 0;
@@ -95,14 +109,35 @@ int integrate (const double t_start, const double t_end, const double pr, double
 	// source vector
 	double fy[NSP];
 
-	// Jacobian matrix
-	double A[NSP * NSP] = {0.0};
+	// Jacobian operator
+	jac_operator A = {0};
 	double gy[NSP];
 
 	double Hm[STRIDE * STRIDE] = {0.0};
 	double Vm[NSP * STRIDE];
 	double phiHm[STRIDE * STRIDE];
+#ifdef KRYLOV_RECYCLE
+	//the projection of fy is kept apart from those of Dn2 and Dn3, to be resumed after a rejected step
+	double Hm_fy[STRIDE * STRIDE] = {0.0};
+	double Vm_fy[NSP * STRIDE];
+	//the number of Arnoldi vectors of the projection of fy that are valid for the current Jacobian
+	int m_basis = 0;
+	//the Krylov subspace sizes of the last step, the starting sizes of the next
+	int m_prev[3] = {0, 0, 0};
+#else
+	double* const Hm_fy = Hm;
+	double* const Vm_fy = Vm;
+	const int m_basis = 0;
+	const int m_prev[3] = {0, 0, 0};
+#endif
+	double beta_fy = 0;
 	double err = 0.0;
+#ifdef LAZY_JACOBIAN
+	//the number of accepted steps taken with the Jacobian, negative before its first evaluation
+	int jac_age = -1;
+	//the step size at the evaluation of the Jacobian
+	double h_jac = h;
+#endif
 	double savedActions[NSP * 5];
 	int numSteps = 0;
 	while ((t < t_end) && (t + h > t)) {
@@ -122,26 +157,63 @@ int integrate (const double t_start, const double t_end, const double pr, double
 		}
 
 		if (!reject) {
+			PHASE_BEGIN(PHASE_RHS);
 			dydt (t, pr, y, fy);
-			eval_jacob (t, pr, y, A);
+			PHASE_END(PHASE_RHS);
+		}
+#ifdef LAZY_JACOBIAN
+		bool update_jac = lazy_jacobian_stale(reject, jac_age, err, h / h_jac);
+#else
+		bool update_jac = !reject;
+#endif
+		if (update_jac) {
+			PHASE_BEGIN(PHASE_JACOBIAN);
+			jac_operator_update (&A, t, pr, y, fy);
+			PHASE_END(PHASE_JACOBIAN);
+			STAT_INC(STAT_JAC_EVALS);
+#ifdef LAZY_JACOBIAN
+			if (reject)
+				STAT_INC(STAT_JAC_STALE_REJECTS);
+			jac_age = 0;
+			h_jac = h;
+#endif
+		}
+		if (!reject || update_jac) {
 			//gy = fy - A * y
-			sparse_multiplier(A, y, gy);
+			jac_operator_multiply(&A, y, gy);
 
 			for (int i = 0; i < NSP; ++i) {
 				gy[i] = fy[i] - gy[i];
 			}
+#ifdef KRYLOV_RECYCLE
+			m_basis = 0;
+#endif
 		}
 
 		//do arnoldi
-		int m = arnoldi(0.5, 1, h, A, fy, sc, &beta, Vm, Hm, phiHm);
+		PHASE_BEGIN(PHASE_KRYLOV);
+		int m = arnoldi(0.5, 1, h, &A, fy, sc, &beta_fy, Vm_fy, Hm_fy, phiHm, m_prev[0], m_basis);
+		PHASE_END(PHASE_KRYLOV);
+		STAT_INC(STAT_KRYLOV_CALLS);
+		STAT_ADD(STAT_KRYLOV_RECYCLED, m_basis);
 		if (m + 1 >= STRIDE || m < 0)
 		{
+#ifdef KRYLOV_RECYCLE
+			m_basis = 0;
+#endif
 			//need to reduce h and try again
 			h /= 5.0;
 			failures++;
+			STAT_INC(STAT_REJECTED);
 			reject = true;
 			continue;
 		}
+		STAT_ADD(STAT_KRYLOV_SIZE, m);
+#ifdef KRYLOV_RECYCLE
+		//a projection that ended in a happy breakdown never formed its last basis vector, and is not resumed
+		m_basis = fabs(Hm_fy[(m - 1) * STRIDE + m]) < breakdown_tolerance() ? 0 : m;
+		m_prev[0] = m;
+#endif
 
 		// Un2 to be stored in temp
 		//Un2 is partially in the mth column of phiHm
@@ -150,17 +222,19 @@ int integrate (const double t_start, const double t_end, const double pr, double
 
 		//store h * beta * Vm * phi_1(h * Hm) * e1 in savedActions
 		matvec_m_by_m_plusequal(m, phiHm, &phiHm[m * STRIDE], temp);
-		matvec_n_by_m_scale(m, beta, Vm, temp, savedActions);
+		matvec_n_by_m_scale(m, beta_fy, Vm_fy, temp, savedActions);
 
 		//store 0.5 * h *  beta * Vm * phi_1(0.5 * h * Hm) * fy + y in temp
-		matvec_n_by_m_scale_add(m, beta, Vm, &phiHm[m * STRIDE], temp, y);
+		matvec_n_by_m_scale_add(m, beta_fy, Vm_fy, &phiHm[m * STRIDE], temp, y);
 		//temp is now equal to Un2
 
 		//next compute Dn2
 		//Dn2 = (F(Un2) - Jn * Un2) - gy
 
+		PHASE_BEGIN(PHASE_RHS);
 		dydt(t, pr, temp, &savedActions[NSP]);
-		sparse_multiplier(A, temp, f_temp);
+		PHASE_END(PHASE_RHS);
+		jac_operator_multiply(&A, temp, f_temp);
 
 
 		for (int i = 0; i < NSP; ++i) {
@@ -173,15 +247,23 @@ int integrate (const double t_start, const double t_end, const double pr, double
 		//Un3 = y + ** h * beta * Vm * phiHm(:, m) **
 
 		//now we need the action of the exponential on Dn2
-		int m1 = arnoldi(1.0, 4, h, A, temp, sc, &beta, Vm, Hm, phiHm);
+		PHASE_BEGIN(PHASE_KRYLOV);
+		int m1 = arnoldi(1.0, 4, h, &A, temp, sc, &beta, Vm, Hm, phiHm, m_prev[1], 0);
+		PHASE_END(PHASE_KRYLOV);
+		STAT_INC(STAT_KRYLOV_CALLS);
 		if (m1 + 4 >= STRIDE || m1 < 0)
 		{
 			//need to reduce h and try again
 			h /= 5.0;
 			failures++;
+			STAT_INC(STAT_REJECTED);
 			reject = true;
 			continue;
 		}
+		STAT_ADD(STAT_KRYLOV_SIZE, m1);
+#ifdef KRYLOV_RECYCLE
+		m_prev[1] = m1;
+#endif
 
 		//save Phi3(h * A) * Dn2 to savedActions[0]
 		//save Phi4(h * A) * Dn2 to savedActions[NSP]
@@ -194,8 +276,10 @@ int integrate (const double t_start, const double t_end, const double pr, double
 
 		//next compute Dn3
 		//Dn3 = F(Un3) - A * Un3 - gy
+		PHASE_BEGIN(PHASE_RHS);
 		dydt(t, pr, temp, &savedActions[3 * NSP]);
-		sparse_multiplier(A, temp, f_temp);
+		PHASE_END(PHASE_RHS);
+		jac_operator_multiply(&A, temp, f_temp);
 
 
 		for (int i = 0; i < NSP; ++i) {
@@ -204,15 +288,33 @@ int integrate (const double t_start, const double t_end, const double pr, double
 		//temp is now equal to Dn3
 
 		//finally we need the action of the exponential on Dn3
-		int m2 = arnoldi(1.0, 4, h, A, temp, sc, &beta, Vm, Hm, phiHm);
+		PHASE_BEGIN(PHASE_KRYLOV);
+#ifdef KRYLOV_BLOCK
+		//extend the subspace of Dn2, still in Vm and Hm
+		int m2 = arnoldi_block(1.0, 4, h, &A, temp, sc, &beta, Vm, Hm, phiHm, m1, m_prev[2]);
+		if (m2 + 4 >= STRIDE)
+			//the extended subspace does not fit, project Dn3 alone
+			m2 = arnoldi(1.0, 4, h, &A, temp, sc, &beta, Vm, Hm, phiHm, m_prev[2], 0);
+		else if (m2 >= 0)
+			STAT_ADD(STAT_KRYLOV_RECYCLED, m1);
+#else
+		int m2 = arnoldi(1.0, 4, h, &A, temp, sc, &beta, Vm, Hm, phiHm, m_prev[2], 0);
+#endif
+		PHASE_END(PHASE_KRYLOV);
+		STAT_INC(STAT_KRYLOV_CALLS);
 		if (m2 + 4 >= STRIDE || m2 < 0)
 		{
 			//need to reduce h and try again
 			h /= 5.0;
 			failures++;
+			STAT_INC(STAT_REJECTED);
 			reject = true;
 			continue;
 		}
+		STAT_ADD(STAT_KRYLOV_SIZE, m2);
+#ifdef KRYLOV_RECYCLE
+		m_prev[2] = m2;
+#endif
 
 		out[0] = &savedActions[3 * NSP];
 		out[1] = &savedActions[4 * NSP];
@@ -267,11 +369,19 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			err_old = fmax(1.0e-2, err);
 			h_old = h;
 
+			STAT_INC(STAT_STEPS);
+#ifdef LAZY_JACOBIAN
+			STAT_ADD(STAT_JAC_AGE, jac_age);
+			jac_age++;
+#endif
 			// check if last step rejected
 			if (reject) {
 				reject = false;
 				h_new = fmin(h, h_new);
 			}
+#ifdef SOLVER_WARM_START
+			ws->h = h_new;
+#endif
 			h = fmin(h_new, t_end - t);
 			numSteps++;
 
@@ -285,12 +395,18 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			h_new = h * fmax(fmin(0.9 * h_new, 8.0), 0.2);
 			h_new = fmin(h_new, t_end - t);
 
+			STAT_INC(STAT_REJECTED);
 			reject = true;
 			h = fmin(h, h_new);
 		}
 #else
 		//constant time stepping
 		// update y and t
+		STAT_INC(STAT_STEPS);
+#ifdef LAZY_JACOBIAN
+		STAT_ADD(STAT_JAC_AGE, jac_age);
+		jac_age++;
+#endif
 		for (int i = 0; i < NSP; ++i) {
 			y[i] = y1[i];
 		}
@@ -305,6 +421,12 @@ int integrate (const double t_start, const double t_end, const double pr, double
 		fclose(rFile);
 	#endif
 
+#ifdef SOLVER_WARM_START
+	ws->h_old = h_old;
+	ws->err_old = err_old;
+	ws->valid = true;
+#endif
+
 	return EC_success;
 }
 
@@ -28,12 +28,9 @@
 #include "solver_props.cuh"
 
 #include "dydt.cuh"
-#ifndef FINITE_DIFFERENCE
-#include "jacob.cuh"
-#else
-#include "fd_jacob.cuh"
-#endif
 #include "exprb43_props.cuh"
+#include "jac_operator.cuh"
+#include "lazy_jacobian.cuh"
 #include "arnoldi.cuh"
 #include "exponential_linear_algebra.cuh"
 #include "solver_init.cuh"
@@ -84,6 +81,15 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 
 	double err_old = 1.0;
 	double h_old = h;
+#ifdef SOLVER_WARM_START
+	double * const __restrict__ warm = solver->warm;
+	if (warm[INDEX(0)] > 0) {
+		// continue from the step size and error history of the previous kernel call
+		h = fmin(warm[INDEX(0)], t_end - t_start);
+		h_old = warm[INDEX(1)];
+		err_old = warm[INDEX(2)];
+	}
+#endif
 
 	bool reject = false;
 
@@ -91,7 +97,9 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 
 	// get scaling for weighted norm
 	double * const __restrict__ sc = solver->sc;
-	scale_init(y, sc);
+	double const * const __restrict__ tol = solver->tol;
+	STAT_RESET(solver);
+	scale_init(y, sc, tol);
 
 #ifdef LOG_KRYLOV_AND_STEPSIZES
 	if (T_ID == 0)
@@ -108,9 +116,26 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 	double * const __restrict__ y1 = solver->work3;
 	cuDoubleComplex * const __restrict__ work4 = solver->work4;
 	double * const __restrict__ fy = mech->dy;
-	double * const __restrict__ A = mech->jac;
+	jac_operator A;
+	jac_operator_init(&A, mech, solver);
+	double * const __restrict__ Hm = solver->Hm;
 	double * const __restrict__ Vm = solver->Vm;
 	double * const __restrict__ phiHm = solver->phiHm;
+#ifdef KRYLOV_RECYCLE
+	//the projection of fy is kept apart from those of Dn2 and Dn3, to be resumed after a rejected step
+	double * const __restrict__ Hm_fy = solver->Hm_fy;
+	double * const __restrict__ Vm_fy = solver->Vm_fy;
+	//the number of Arnoldi vectors of the projection of fy that are valid for the current Jacobian
+	int m_basis = 0;
+	//the Krylov subspace sizes of the last step, the starting sizes of the next
+	int m_prev[3] = {0, 0, 0};
+#else
+	double * const __restrict__ Hm_fy = Hm;
+	double * const __restrict__ Vm_fy = Vm;
+	const int m_basis = 0;
+	const int m_prev[3] = {0, 0, 0};
+#endif
+	double beta_fy = 0;
 	double * const __restrict__ savedActions = solver->savedActions;
 	double * const __restrict__ gy = solver->gy;
 	int * const __restrict__ result = solver->result;
@@ -121,6 +146,12 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 	double scale_vec[3] = {0, 0, 0};
 
 	double err = 0.0;
+#ifdef LAZY_JACOBIAN
+	//the number of accepted steps taken with the Jacobian (in mechanism_memory::jac), negative before its first evaluation
+	int jac_age = -1;
+	//the step size at the evaluation of the Jacobian
+	double h_jac = h;
+#endif
 	int failures = 0;
 	int steps = 0;
 	while (t < t_end) {
@@ -143,33 +174,66 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 		}
 
 		if (!reject) {
+			PHASE_BEGIN(solver, PHASE_RHS);
 			dydt (t, pr, y, fy, mech);
-		#ifdef FINITE_DIFFERENCE
-			eval_jacob (t, pr, y, A, mech, work1, work2);
-		#else
-			eval_jacob (t, pr, y, A, mech);
-		#endif
+			PHASE_END(solver, PHASE_RHS);
+		}
+#ifdef LAZY_JACOBIAN
+		bool update_jac = lazy_jacobian_stale(reject, jac_age, err, h / h_jac);
+#else
+		bool update_jac = !reject;
+#endif
+		if (update_jac) {
+			PHASE_BEGIN(solver, PHASE_JACOBIAN);
+			jac_operator_update (&A, t, pr, y, fy, work1, work2);
+			PHASE_END(solver, PHASE_JACOBIAN);
+			STAT_INC(solver, STAT_JAC_EVALS);
+#ifdef LAZY_JACOBIAN
+			if (reject)
+				STAT_INC(solver, STAT_JAC_STALE_REJECTS);
+			jac_age = 0;
+			h_jac = h;
+#endif
+		}
+		if (!reject || update_jac) {
 			//gy = fy - A * y
-			sparse_multiplier(A, y, gy);
+			jac_operator_multiply(&A, y, gy);
 			#pragma unroll
 			for (int i = 0; i < NSP; ++i) {
 				gy[INDEX(i)] = fy[INDEX(i)] - gy[INDEX(i)];
 			}
+#ifdef KRYLOV_RECYCLE
+			m_basis = 0;
+#endif
 		}
 
 		#ifdef DIVERGENCE_TEST
 		integrator_steps[T_ID]++;
 		#endif
-		int m = arnoldi(0.5, 1, h, A, solver, fy, &beta, work2, work4);
+		PHASE_BEGIN(solver, PHASE_KRYLOV);
+		int m = arnoldi(0.5, 1, h, &A, solver, fy, &beta_fy, Vm_fy, Hm_fy, work2, work4, m_prev[0], m_basis);
+		PHASE_END(solver, PHASE_KRYLOV);
+		STAT_INC(solver, STAT_KRYLOV_CALLS);
+		STAT_ADD(solver, STAT_KRYLOV_RECYCLED, m_basis);
 		if (m + 1 >= STRIDE || m < 0)
 		{
+#ifdef KRYLOV_RECYCLE
+			m_basis = 0;
+#endif
 			//failure: too many krylov vectors required or singular matrix encountered
 			//need to reduce h and try again
 			h /= 5.0;
 			reject = true;
 			failures++;
+			STAT_INC(solver, STAT_REJECTED);
 			continue;
 		}
+		STAT_ADD(solver, STAT_KRYLOV_SIZE, m);
+#ifdef KRYLOV_RECYCLE
+		//a projection that ended in a happy breakdown never formed its last basis vector, and is not resumed
+		m_basis = fabs(Hm_fy[INDEX((m - 1) * STRIDE + m)]) < ATOL ? 0 : m;
+		m_prev[0] = m;
+#endif
 
 		// Un2 to be stored in work1
 		//Un2 is partially in the mth column of phiHm
@@ -178,17 +242,19 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 
 		//store h * beta * Vm * phi_1(h * Hm) * e1 in savedActions
 		matvec_m_by_m_plusequal(m, phiHm, &phiHm[GRID_DIM * (m * STRIDE)], work1);
-		matvec_n_by_m_scale(m, beta, Vm, work1, savedActions);
+		matvec_n_by_m_scale(m, beta_fy, Vm_fy, work1, savedActions);
 
 		//store 0.5 * h *  beta * Vm * phi_1(0.5 * h * Hm) * fy + y in work1
-		matvec_n_by_m_scale_add(m, beta, Vm, &phiHm[GRID_DIM * (m * STRIDE)], work1, y);
+		matvec_n_by_m_scale_add(m, beta_fy, Vm_fy, &phiHm[GRID_DIM * (m * STRIDE)], work1, y);
 		//work1 is now equal to Un2
 
 		//next compute Dn2
 		//Dn2 = (F(Un2) - Jn * Un2) - gy
 
+		PHASE_BEGIN(solver, PHASE_RHS);
 		dydt(t, pr, work1, &savedActions[GRID_DIM * NSP], mech);
-		sparse_multiplier(A, work1, work2);
+		PHASE_END(solver, PHASE_RHS);
+		jac_operator_multiply(&A, work1, work2);
 
 		#pragma unroll
 		for (int i = 0; i < NSP; ++i) {
@@ -201,15 +267,23 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 		//Un3 = y + ** h * beta * Vm * phiHm(:, m) **
 
 		//now we need the action of the exponential on Dn2
-		int m1 = arnoldi(1.0, 4, h, A, solver, work1, &beta, work2, work4);
+		PHASE_BEGIN(solver, PHASE_KRYLOV);
+		int m1 = arnoldi(1.0, 4, h, &A, solver, work1, &beta, Vm, Hm, work2, work4, m_prev[1], 0);
+		PHASE_END(solver, PHASE_KRYLOV);
+		STAT_INC(solver, STAT_KRYLOV_CALLS);
 		if (m1 + 4 >= STRIDE || m1 < 0)
 		{
 			//need to reduce h and try again
 			h /= 5.0;
 			reject = true;
 			failures++;
+			STAT_INC(solver, STAT_REJECTED);
 			continue;
 		}
+		STAT_ADD(solver, STAT_KRYLOV_SIZE, m1);
+#ifdef KRYLOV_RECYCLE
+		m_prev[1] = m1;
+#endif
 
 		//save Phi3(h * A) * Dn2 to savedActions[0]
 		//save Phi4(h * A) * Dn2 to savedActions[NSP]
@@ -227,8 +301,10 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 
 		//next compute Dn3
 		//Dn3 = F(Un3) - A * Un3 - gy
+		PHASE_BEGIN(solver, PHASE_RHS);
 		dydt(t, pr, work1, &savedActions[GRID_DIM * 3 * NSP], mech);
-		sparse_multiplier(A, work1, work2);
+		PHASE_END(solver, PHASE_RHS);
+		jac_operator_multiply(&A, work1, work2);
 
 		#pragma unroll
 		for (int i = 0; i < NSP; ++i) {
@@ -237,15 +313,33 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 		//work1 is now equal to Dn3
 
 		//finally we need the action of the exponential on Dn3
-		int m2 = arnoldi(1.0, 4, h, A, solver, work1, &beta, work2, work4);
+		PHASE_BEGIN(solver, PHASE_KRYLOV);
+#ifdef KRYLOV_BLOCK
+		//extend the subspace of Dn2, still in Vm and Hm (y1 is free until the end of the step)
+		int m2 = arnoldi_block(1.0, 4, h, &A, solver, work1, &beta, Vm, Hm, work2, y1, work4, m1, m_prev[2]);
+		if (m2 + 4 >= STRIDE)
+			//the extended subspace does not fit, project Dn3 alone
+			m2 = arnoldi(1.0, 4, h, &A, solver, work1, &beta, Vm, Hm, work2, work4, m_prev[2], 0);
+		else if (m2 >= 0)
+			STAT_ADD(solver, STAT_KRYLOV_RECYCLED, m1);
+#else
+		int m2 = arnoldi(1.0, 4, h, &A, solver, work1, &beta, Vm, Hm, work2, work4, m_prev[2], 0);
+#endif
+		PHASE_END(solver, PHASE_KRYLOV);
+		STAT_INC(solver, STAT_KRYLOV_CALLS);
 		if (m2 + 4 >= STRIDE || m2 < 0)
 		{
 			//need to reduce h and try again
 			h /= 5.0;
 			reject = true;
 			failures++;
+			STAT_INC(solver, STAT_REJECTED);
 			continue;
 		}
+		STAT_ADD(solver, STAT_KRYLOV_SIZE, m2);
+#ifdef KRYLOV_RECYCLE
+		m_prev[2] = m2;
+#endif
 		out[0] = &savedActions[GRID_DIM * 3 * NSP];
 		out[1] = &savedActions[GRID_DIM * 4 * NSP];
 		in[0] = &phiHm[GRID_DIM * (m2 + 2) * STRIDE];
@@ -265,7 +359,7 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 
 
 		//scale and find err
-		scale (y, y1, work2);
+		scale (y, y1, work2, tol);
 		err = fmax(EPS, sc_norm(work1, work2));
 
 		// classical step size calculation
@@ -310,12 +404,20 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 			// store time step and error
 			err_old = fmax(1.0e-2, err);
 			h_old = h;
+			STAT_INC(solver, STAT_STEPS);
+#ifdef LAZY_JACOBIAN
+			STAT_ADD(solver, STAT_JAC_AGE, jac_age);
+			jac_age++;
+#endif
 
 			// check if last step rejected
 			if (reject) {
 				h_new = fmin(h, h_new);
 				reject = false;
 			}
+#ifdef SOLVER_WARM_START
+			warm[INDEX(0)] = h_new;
+#endif
 			h = fmin(h_new, t_end - t);
 
 		} else {
@@ -323,12 +425,18 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 			h_new = h * fmax(fmin(0.9 * h_new, 8.0), 0.2);
 			h_new = fmin(h_new, t_end - t);
 
+			STAT_INC(solver, STAT_REJECTED);
 			reject = true;
 			h = fmin(h, h_new);
 		}
 #else
 		//constant time stepping
 		//update y & t
+		STAT_INC(solver, STAT_STEPS);
+#ifdef LAZY_JACOBIAN
+		STAT_ADD(solver, STAT_JAC_AGE, jac_age);
+		jac_age++;
+#endif
 		#pragma unroll
 		for (int i = 0; i < NSP; ++i)
 		{
@@ -339,6 +447,10 @@ __device__ void integrate (const double t_start, const double t_end, const doubl
 
 	} // end while
 
+#ifdef SOLVER_WARM_START
+	warm[INDEX(1)] = h_old;
+	warm[INDEX(2)] = err_old;
+#endif
 	result[T_ID] = EC_success;
 
 }
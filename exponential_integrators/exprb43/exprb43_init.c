@@ -7,6 +7,7 @@
  *
  */
 
+#include <stddef.h>
 #include "rational_approximant.h"
 
 #ifdef GENERATE_DOCS
@@ -41,13 +42,15 @@ namespace exprb43 {
  }
  void solver_log() {}
 
- /*! \fn void initialize_solver(int num_threads)
+ /*! \fn void* initialize_solver(int num_threads)
    \brief 
    \param num_threads Unused
 */
- void initialize_solver(int num_threads) {
+ void* initialize_solver(int num_threads) {
     //Solves for the poles and residuals used for the Rational Approximants in the Krylov subspace methods
  	find_poles_and_residuals();
+ 	//no per-thread memory is kept
+ 	return NULL;
  }
 
 /*!
@@ -59,7 +62,7 @@ namespace exprb43 {
  	return name;
  }
 
- void cleanup_solver(int num_threads) {
+ void cleanup_solver(int num_threads, void* memory) {
  }
 
 #ifdef GENERATE_DOCS
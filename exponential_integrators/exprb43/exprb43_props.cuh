@@ -9,6 +9,9 @@
 #define RB43_PROPS_CUH
 
 #include "header.cuh"
+#include "solver_stats.cuh"
+#include "phase_profile.cuh"
+#include "tolerances.cuh"
 #include <cuComplex.h>
 #include <stdio.h>
 
@@ -27,20 +30,32 @@ namespace exprb43cu {
 #define M_MAX NSP
 //! Krylov matrix stride
 #define STRIDE (M_MAX + P)
+
+//the Gram-Schmidt selection depends on STRIDE
+#include "krylov_shared.cuh"
 //! Maximum allowed internal timesteps per integration step
 #define MAX_STEPS (100000)
 //! Number of consecutive errors on internal integration steps allowed before exit
 #define MAX_CONSECUTIVE_ERRORS (5)
 
+#if defined(WARM_START) && !defined(CONST_TIME_STEP)
+//! The EXPRB43 solver continues from the step size and error history of the previous kernel call
+#define SOLVER_WARM_START
+//! The number of warm start entries per IVP: the proposed step size, the last accepted step size and its error estimate
+#define WARM_SIZE (3)
+#endif
+
 struct solver_memory
 {
 	//! the scaled error coefficients
 	double* sc;
+	//! The (#TOL_SIZE) integration tolerances, shared by all threads @see tolerances.cuh
+	double* tol;
 	//! a work array
 	double* work1;
 	//! a work array
 	double* work2;
-	//! a work array
+	//! a work array (y_n+1), aliases the storage of the phi function evaluation (invA / phi_work)
 	double* work3;
 	//! The difference between RHS function and the Jacobian state vector product
 	double* gy;
@@ -52,14 +67,41 @@ struct solver_memory
 	double* Vm;
 	//! Saved stage results
 	double* savedActions;
+#ifdef PHI_TAYLOR
+	//! the #PHI_TAYLOR_WORK work matricies of the Taylor phi functions
+	double* phi_work;
+#else
 	//! the pivot indicies
 	int* ipiv;
 	//! the inverse of the Hessenberg Krylov subspace
 	cuDoubleComplex* invA;
+#endif
 	//! a (complex) work array
 	cuDoubleComplex* work4;
 	//! an array of integration results for the various threads @see exprb43cu_ErrCodes
 	int* result;
+#ifdef STATISTICS
+	//! per-IVP integrator statistics, stored as `stats[INDEX(stat)]` @see StatisticIndex
+	int* stats;
+#endif
+#ifdef PROFILE_PHASES
+	//! per-thread phase counters, stored as `phases[INDEX(phase)]` (cycles) and `phases[INDEX(NUM_PHASES + phase)]` (calls) @see PhaseIndex
+	long long* phases;
+#endif
+#ifdef SOLVER_WARM_START
+	//! per-IVP warm start state kept between kernel calls, stored as `warm[INDEX(k)]` @see warm_start.cuh
+	double* warm;
+#endif
+#if defined(MATRIX_FREE) && defined(JAC_VEC_FINITE_DIFFERENCE)
+	//! the perturbed state vector of the finite difference Jacobian-vector product @see jac_operator.cuh
+	double* y_pert;
+#endif
+#ifdef KRYLOV_RECYCLE
+	//! The Hessenberg Krylov subspace array of the projection of the RHS, kept for reuse after a rejected step
+	double* Hm_fy;
+	//! the Arnoldi basis array of the projection of the RHS, kept for reuse after a rejected step
+	double* Vm_fy;
+#endif
 };
 
 /**
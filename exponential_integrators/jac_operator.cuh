@@ -0,0 +1,182 @@
+/*!
+ * \file jac_operator.cuh
+ * \brief The Jacobian operator used by the GPU Krylov subspace methods of the exponential integrators
+ *
+ * The exponential integrators only use the Jacobian through Jacobian-vector products.  By default
+ * the Jacobian is formed by eval_jacob in mechanism_memory::jac and multiplied by sparse_multiplier.
+ * If #MATRIX_FREE is defined, mechanism_memory::jac is never accessed, and the action of the Jacobian
+ * is computed either by the analytic `jac_vec_mult` of the mechanism (#JAC_VEC_ANALYTIC), or by a
+ * directional finite difference of dydt (#JAC_VEC_FINITE_DIFFERENCE):
+ * \f[
+ *     J v \approx \frac{f(y + \sigma v) - f(y)}{\sigma}, \quad \sigma = \frac{\sqrt{\epsilon (1 + \|y\|)}}{\|v\|}
+ * \f]
+ */
+
+#ifndef JAC_OPERATOR_CUH
+#define JAC_OPERATOR_CUH
+
+#include <math.h>
+#include <float.h>
+
+#include "header.cuh"
+#include "solver_options.cuh"
+#include "solver_props.cuh"
+#include "gpu_macros.cuh"
+#include "exponential_linear_algebra.cuh"
+#ifndef MATRIX_FREE
+#ifndef FINITE_DIFFERENCE
+#include "jacob.cuh"
+#else
+#include "fd_jacob.cuh"
+#endif
+#include "sparse_multiplier.cuh"
+#include "sparse_jacobian.cuh"
+#else
+#include "dydt.cuh"
+#ifdef JAC_VEC_ANALYTIC
+#include "jac_vec_mult.cuh"
+#endif
+#endif
+
+/**
+ * \brief The Jacobian of the RHS at the current state of an exponential integrator (for a single thread)
+ */
+struct jac_operator
+{
+	//! The mechanism memory used in evaluating dydt and the Jacobian
+	const mechanism_memory* mech;
+#ifndef MATRIX_FREE
+	//! The (NSP x NSP) Jacobian matrix, mechanism_memory::jac
+	double* A;
+#else
+	//! The system time of the linearization
+	double t;
+	//! The system constant variable (pressure/density) of the linearization
+	double pr;
+	//! The state vector of the linearization
+	const double* y;
+	//! The RHS at #y
+	const double* fy;
+#ifdef JAC_VEC_FINITE_DIFFERENCE
+	//! The perturbed state vector, solver_memory::y_pert
+	double* y_pert;
+	//! The norm of #y
+	double y_norm;
+#endif
+#endif
+};
+
+/**
+ * \brief Initializes the Jacobian operator with the (global) memory of this thread
+ * \param[out]		J		the Jacobian operator
+ * \param[in]		mech	the mechanism memory struct
+ * \param[in]		solver	the solver memory struct
+ */
+__device__
+void jac_operator_init(jac_operator* __restrict__ J, const mechanism_memory* __restrict__ mech,
+					   const solver_memory* __restrict__ solver)
+{
+	J->mech = mech;
+#ifndef MATRIX_FREE
+	J->A = mech->jac;
+#elif defined(JAC_VEC_FINITE_DIFFERENCE)
+	J->y_pert = solver->y_pert;
+#endif
+}
+
+/**
+ * \brief Updates the Jacobian operator to the linearization at time `t` and state `y`
+ * \param[in,out]	J		the Jacobian operator
+ * \param[in]		t		the current system time
+ * \param[in]		pr		the system constant variable (pressure/density)
+ * \param[in]		y		the state vector, which must stay unchanged while the operator is in use
+ * \param[in]		fy		the RHS at `y`, which must stay unchanged while the operator is in use
+ * \param[in]		work1	a work array (only used by the finite difference Jacobian)
+ * \param[in]		work2	a work array (only used by the finite difference Jacobian)
+ */
+__device__
+void jac_operator_update(jac_operator* __restrict__ J, const double t, const double pr,
+						 const double* __restrict__ y, const double* __restrict__ fy,
+						 double* __restrict__ work1, double* __restrict__ work2)
+{
+#ifndef MATRIX_FREE
+	#ifdef FINITE_DIFFERENCE
+		eval_jacob (t, pr, y, J->A, J->mech, work1, work2);
+	#else
+		eval_jacob (t, pr, y, J->A, J->mech);
+	#endif
+#else
+	J->t = t;
+	J->pr = pr;
+	J->y = y;
+	J->fy = fy;
+#ifdef JAC_VEC_FINITE_DIFFERENCE
+	J->y_norm = two_norm(y);
+#endif
+#endif
+}
+
+/**
+ * \brief Computes the Jacobian-vector product \f$w := J v\f$
+ * \param[in]		J		the Jacobian operator
+ * \param[in]		v		the (NSP x 1) vector to multiply
+ * \param[out]		w		the (NSP x 1) result, which may not alias `v`
+ */
+__device__
+void jac_operator_multiply(const jac_operator* __restrict__ J, const double* __restrict__ v, double* __restrict__ w)
+{
+#ifndef MATRIX_FREE
+	sparse_multiplier (J->A, v, w);
+#elif defined(JAC_VEC_ANALYTIC)
+	jac_vec_mult (J->t, J->pr, J->y, v, w, J->mech);
+#else
+	double v_norm = two_norm(v);
+	if (v_norm == 0)
+	{
+		#pragma unroll
+		for (int i = 0; i < NSP; ++i)
+			w[INDEX(i)] = 0;
+		return;
+	}
+	double sigma = sqrt(DBL_EPSILON * (1.0 + J->y_norm)) / v_norm;
+	double* __restrict__ y_pert = J->y_pert;
+	#pragma unroll
+	for (int i = 0; i < NSP; ++i)
+		y_pert[INDEX(i)] = J->y[INDEX(i)] + sigma * v[INDEX(i)];
+	dydt (J->t, J->pr, y_pert, w, J->mech);
+	#pragma unroll
+	for (int i = 0; i < NSP; ++i)
+		w[INDEX(i)] = (w[INDEX(i)] - J->fy[INDEX(i)]) / sigma;
+#endif
+}
+
+/**
+ * \brief Computes the Jacobian-vector products \f$w_0 := J v_0\f$ and \f$w_1 := J v_1\f$
+ * \param[in]		J		the Jacobian operator
+ * \param[in]		v0		the first (NSP x 1) vector to multiply
+ * \param[in]		v1		the second (NSP x 1) vector to multiply
+ * \param[out]		w0		the (NSP x 1) result of `v0`, which may not alias `v0` or `v1`
+ * \param[out]		w1		the (NSP x 1) result of `v1`, which may not alias `v0` or `v1`
+ *
+ * If the Jacobian is stored compressed (#SPARSE_JACOBIAN), both products are formed in a single pass over
+ * its entries, @see jac_operator.h
+ */
+__device__
+void jac_operator_multiply2(const jac_operator* __restrict__ J, const double* __restrict__ v0,
+							const double* __restrict__ v1, double* __restrict__ w0, double* __restrict__ w1)
+{
+#if !defined(MATRIX_FREE) && defined(SPARSE_JACOBIAN)
+	#pragma unroll
+	for (int i = 0; i < NSP; ++i)
+	{
+		w0[INDEX(i)] = 0;
+		w1[INDEX(i)] = 0;
+	}
+	jacobian_multiply_add2(J->A, v0, v1, w0, w1);
+#else
+	jac_operator_multiply(J, v0, w0);
+	jac_operator_multiply(J, v1, w1);
+#endif
+}
+
+#endif
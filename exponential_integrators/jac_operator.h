@@ -0,0 +1,142 @@
+/*!
+ * \file jac_operator.h
+ * \brief The Jacobian operator used by the Krylov subspace methods of the exponential integrators
+ *
+ * The exponential integrators only use the Jacobian through Jacobian-vector products.  By default
+ * the Jacobian is formed by eval_jacob and multiplied by sparse_multiplier.  If #MATRIX_FREE is
+ * defined, the Jacobian is never stored, and its action is computed either by the analytic
+ * `jac_vec_mult` of the mechanism (#JAC_VEC_ANALYTIC), or by a directional finite difference of
+ * dydt (#JAC_VEC_FINITE_DIFFERENCE):
+ * \f[
+ *     J v \approx \frac{f(y + \sigma v) - f(y)}{\sigma}, \quad \sigma = \frac{\sqrt{\epsilon (1 + \|y\|)}}{\|v\|}
+ * \f]
+ */
+
+#ifndef JAC_OPERATOR_H
+#define JAC_OPERATOR_H
+
+#include <math.h>
+#include <float.h>
+
+#include "header.h"
+#include "solver_options.h"
+#include "exponential_linear_algebra.h"
+#ifndef MATRIX_FREE
+#include "jacob.h"
+#include "sparse_multiplier.h"
+#include "sparse_jacobian.h"
+#else
+#include "dydt.h"
+#ifdef JAC_VEC_ANALYTIC
+#include "jac_vec_mult.h"
+#endif
+#endif
+
+/**
+ * \brief The Jacobian of the RHS at the current state of an exponential integrator
+ */
+typedef struct
+{
+#ifndef MATRIX_FREE
+	//! The (NSP x NSP) Jacobian matrix, compressed if #SPARSE_JACOBIAN is defined
+	double A[JAC_SIZE];
+#else
+	//! The system time of the linearization
+	double t;
+	//! The system constant variable (pressure/density) of the linearization
+	double pr;
+	//! The state vector of the linearization
+	const double* y;
+	//! The RHS at #y
+	const double* fy;
+#ifdef JAC_VEC_FINITE_DIFFERENCE
+	//! The norm of #y
+	double y_norm;
+#endif
+#endif
+} jac_operator;
+
+/**
+ * \brief Updates the Jacobian operator to the linearization at time `t` and state `y`
+ * \param[out]		J		the Jacobian operator
+ * \param[in]		t		the current system time
+ * \param[in]		pr		the system constant variable (pressure/density)
+ * \param[in]		y		the state vector, which must stay unchanged while the operator is in use
+ * \param[in]		fy		the RHS at `y`, which must stay unchanged while the operator is in use
+ */
+static inline
+void jac_operator_update(jac_operator* J, const double t, const double pr, const double* y, const double* fy)
+{
+#ifndef MATRIX_FREE
+	eval_jacob (t, pr, y, J->A);
+#else
+	J->t = t;
+	J->pr = pr;
+	J->y = y;
+	J->fy = fy;
+#ifdef JAC_VEC_FINITE_DIFFERENCE
+	J->y_norm = two_norm(y);
+#endif
+#endif
+}
+
+/**
+ * \brief Computes the Jacobian-vector product \f$w := J v\f$
+ * \param[in]		J		the Jacobian operator
+ * \param[in]		v		the (NSP x 1) vector to multiply
+ * \param[out]		w		the (NSP x 1) result, which may not alias `v`
+ */
+static inline
+void jac_operator_multiply(const jac_operator* J, const double* v, double* w)
+{
+#ifndef MATRIX_FREE
+	sparse_multiplier (J->A, v, w);
+#elif defined(JAC_VEC_ANALYTIC)
+	jac_vec_mult (J->t, J->pr, J->y, v, w);
+#else
+	double v_norm = two_norm(v);
+	if (v_norm == 0)
+	{
+		for (int i = 0; i < NSP; ++i)
+			w[i] = 0;
+		return;
+	}
+	double sigma = sqrt(DBL_EPSILON * (1.0 + J->y_norm)) / v_norm;
+	double y_pert[NSP];
+	for (int i = 0; i < NSP; ++i)
+		y_pert[i] = J->y[i] + sigma * v[i];
+	dydt (J->t, J->pr, y_pert, w);
+	for (int i = 0; i < NSP; ++i)
+		w[i] = (w[i] - J->fy[i]) / sigma;
+#endif
+}
+
+/**
+ * \brief Computes the Jacobian-vector products \f$w_0 := J v_0\f$ and \f$w_1 := J v_1\f$
+ * \param[in]		J		the Jacobian operator
+ * \param[in]		v0		the first (NSP x 1) vector to multiply
+ * \param[in]		v1		the second (NSP x 1) vector to multiply
+ * \param[out]		w0		the (NSP x 1) result of `v0`, which may not alias `v0` or `v1`
+ * \param[out]		w1		the (NSP x 1) result of `v1`, which may not alias `v0` or `v1`
+ *
+ * If the Jacobian is stored compressed (#SPARSE_JACOBIAN), both products are formed in a single pass over
+ * its entries.  Otherwise the unrolled sparse_multiplier of the mechanism (or the matrix-free product)
+ * is applied to each vector.
+ */
+static inline
+void jac_operator_multiply2(const jac_operator* J, const double* v0, const double* v1, double* w0, double* w1)
+{
+#if !defined(MATRIX_FREE) && defined(SPARSE_JACOBIAN)
+	for (int i = 0; i < NSP; ++i)
+	{
+		w0[i] = 0;
+		w1[i] = 0;
+	}
+	jacobian_multiply_add2(J->A, v0, v1, w0, w1);
+#else
+	jac_operator_multiply(J, v0, w0);
+	jac_operator_multiply(J, v1, w1);
+#endif
+}
+
+#endif
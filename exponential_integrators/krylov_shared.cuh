@@ -0,0 +1,45 @@
+/**
+ * \file
+ * \brief Selection of the Gram-Schmidt variant and coefficient storage of the GPU Arnoldi iteration
+ *
+ * If #ARNOLDI_CGS2 is defined, the GPU Arnoldi iterations orthogonalize each new vector by twice
+ * iterated classical Gram-Schmidt (orthogonalize_cgs2), which streams the Arnoldi basis from global
+ * memory in three fused passes, rather than twice per basis vector as modified Gram-Schmidt does.
+ * The two (STRIDE x 1) coefficient vectors of each thread are accessed once per basis entry, and
+ * are kept in shared memory (#KRYLOV_SHARED) if those of a block fit; intDriver is then launched
+ * with #SOLVER_SHARED_SIZE additional bytes of dynamic shared memory.  Otherwise the coefficients
+ * are kept in the current and the (not yet used) next column of solver_memory::Hm.
+ *
+ * Must be included after the definition of STRIDE.
+ */
+
+#ifndef KRYLOV_SHARED_CUH
+#define KRYLOV_SHARED_CUH
+
+#include "header.cuh"
+#include "solver_options.cuh"
+#include "launch_bounds.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The maximum dynamic shared memory per block (in bytes) that may be launched without opting in
+#define KRYLOV_MAX_SHARED (49152)
+//! The offset (in bytes) of the coefficients in the dynamic shared memory, i.e. #SHARED_SIZE aligned to a double
+#define KRYLOV_SHARED_OFFSET (((SHARED_SIZE + 7) / 8) * 8)
+//! The shared memory (in bytes) of the two (STRIDE x 1) coefficient vectors of each thread of a block
+#define KRYLOV_SHARED_SIZE (2 * STRIDE * TARGET_BLOCK_SIZE * 8)
+
+#if defined(ARNOLDI_CGS2) && (KRYLOV_SHARED_OFFSET + KRYLOV_SHARED_SIZE <= KRYLOV_MAX_SHARED)
+    //! The Gram-Schmidt coefficients of the Arnoldi iteration are kept in shared memory
+    #define KRYLOV_SHARED
+    //! The dynamic shared memory (in bytes) per block required by the solver, in addition to #SHARED_SIZE
+    #define SOLVER_SHARED_SIZE (KRYLOV_SHARED_OFFSET - SHARED_SIZE + KRYLOV_SHARED_SIZE)
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
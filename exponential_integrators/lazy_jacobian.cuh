@@ -0,0 +1,41 @@
+/*!
+ * \file lazy_jacobian.cuh
+ * \brief The Jacobian reuse policy of the GPU exponential integrators (#LAZY_JACOBIAN)
+ *
+ * The GPU counterpart of lazy_jacobian.h, the Jacobian is kept in mechanism_memory::jac between steps.
+ */
+
+#ifndef LAZY_JACOBIAN_CUH
+#define LAZY_JACOBIAN_CUH
+
+#include "solver_options.cuh"
+
+#ifdef LAZY_JACOBIAN
+
+#ifndef JAC_MAX_AGE
+//! The maximum number of accepted steps a Jacobian is used for
+#define JAC_MAX_AGE (5)
+#endif
+//! The maximum error estimate of the last accepted step for which the Jacobian is kept
+#define JAC_REUSE_ERR (0.5)
+//! The maximum ratio of the step size to that of the Jacobian evaluation for which the Jacobian is kept
+#define JAC_REUSE_QMAX (2.0)
+
+/**
+ * \brief Returns true if the Jacobian must be (re-)evaluated before the next step
+ * \param[in]		reject		true if the last step was rejected
+ * \param[in]		age			the number of accepted steps taken with the Jacobian, negative if none was evaluated
+ * \param[in]		err			the error estimate of the last accepted step
+ * \param[in]		h_ratio		the ratio of the next step size to the step size of the Jacobian evaluation
+ */
+__device__ __forceinline__
+bool lazy_jacobian_stale(const bool reject, const int age, const double err, const double h_ratio)
+{
+	if (reject)
+		return age > 0;
+	return age < 0 || age >= JAC_MAX_AGE || err > JAC_REUSE_ERR || h_ratio > JAC_REUSE_QMAX;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+/*!
+ * \file lazy_jacobian.h
+ * \brief The Jacobian reuse policy of the exponential integrators (#LAZY_JACOBIAN)
+ *
+ * EXP4 and EXPRB43 evaluate the nonlinear remainder \f$g(u) = f(u) - A u\f$ of their stages with the
+ * Jacobian operator \f$A\f$ in use, hence remain consistent (as exponential W-methods) if \f$A\f$ is only an
+ * approximation of the current Jacobian.  If #LAZY_JACOBIAN is defined, the Jacobian of a previous step is
+ * kept while it is younger than #JAC_MAX_AGE accepted steps, the last error estimate is below #JAC_REUSE_ERR,
+ * and the step size has grown by no more than #JAC_REUSE_QMAX since the evaluation.  A step rejected with
+ * a reused Jacobian is retried with a fresh one.
+ */
+
+#ifndef LAZY_JACOBIAN_H
+#define LAZY_JACOBIAN_H
+
+#include <stdbool.h>
+
+#include "solver_options.h"
+
+#ifdef LAZY_JACOBIAN
+
+#ifndef JAC_MAX_AGE
+//! The maximum number of accepted steps a Jacobian is used for
+#define JAC_MAX_AGE (5)
+#endif
+//! The maximum error estimate of the last accepted step for which the Jacobian is kept
+#define JAC_REUSE_ERR (0.5)
+//! The maximum ratio of the step size to that of the Jacobian evaluation for which the Jacobian is kept
+#define JAC_REUSE_QMAX (2.0)
+
+/**
+ * \brief Returns true if the Jacobian must be (re-)evaluated before the next step
+ * \param[in]		reject		true if the last step was rejected
+ * \param[in]		age			the number of accepted steps taken with the Jacobian, negative if none was evaluated
+ * \param[in]		err			the error estimate of the last accepted step
+ * \param[in]		h_ratio		the ratio of the next step size to the step size of the Jacobian evaluation
+ */
+static inline
+bool lazy_jacobian_stale(const bool reject, const int age, const double err, const double h_ratio)
+{
+	if (reject)
+		return age > 0;
+	return age < 0 || age >= JAC_MAX_AGE || err > JAC_REUSE_ERR || h_ratio > JAC_REUSE_QMAX;
+}
+
+#endif
+
+#endif
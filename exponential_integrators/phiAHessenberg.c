@@ -4,6 +4,8 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <complex.h>
 
 #include "header.h"
@@ -11,6 +13,9 @@
 #include "complexInverse.h"
 #include "solver_options.h"
 #include "solver_props.h"
+#include "phiAHessenberg.h"
+
+#ifndef PHI_TAYLOR
 
 extern double complex poles[N_RA];
 extern double complex res[N_RA];
@@ -182,4 +187,271 @@ int expAc_variable(const int m, const double* A, const double c, double* phiA) {
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
+
+/** \brief Compute the zeroth order Phi (exponential) matrix function of a general (e.g. block Hessenberg) matrix
+ *
+ *  Computes \f$\phi_0(c*A)\f$ as expAc_variable, but inverts the shifted matricies by a (LAPACK) LU factorization
+ *  with full partial pivoting, such that `A` need not be upper Hessenberg, @see arnoldi_block
+ *
+ *  \param[in]		m		The matrix size (mxm)
+ *  \param[in]		A		The input matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ */
+int expAc_block(const int m, const double* A, const double c, double* phiA) {
+
+	//allocate arrays
+	int ipiv[STRIDE] = {0};
+	double complex invA[STRIDE * STRIDE];
+	double complex work[STRIDE];
+	const int lda = STRIDE;
+	const int lwork = STRIDE;
+	int info = 0;
+
+	for (int i = 0; i < m; ++i) {
+
+		for (int j = 0; j < m; ++j) {
+			phiA[i + j*STRIDE] = 0.0;
+		}
+	}
+
+
+	for (int q = 0; q < N_RA; q += 2) {
+
+		for (int i = 0; i < m; ++i) {
+			for (int j = 0; j < m; ++j) {
+				// A - theta * I
+				if (i == j) {
+					invA[i + j*STRIDE] = c * A[i + j*STRIDE] - poles[q];
+				} else {
+					invA[i + j*STRIDE] = c * A[i + j*STRIDE];
+				}
+			}
+		}
+
+		// takes care of (A * c - poles(q) * I)^-1
+		zgetrf_ (&m, &m, invA, &lda, ipiv, &info);
+		if (info != 0)
+			return info;
+		zgetri_ (&m, invA, &lda, ipiv, work, &lwork, &info);
+		if (info != 0)
+			return info;
+
+
+		for (int i = 0; i < m; ++i) {
+
+			for (int j = 0; j < m; ++j) {
+				phiA[i + j*STRIDE] += 2.0 * creal(res[q] * invA[i + j*STRIDE]);
+			}
+		}
+	}
+
+	return 0;
+}
+
+#else
+
+/** \brief Computes the (mxm) matrix product \f$C = A B\f$ of matricies with leading dimension #STRIDE
+ */
+static inline void phi_multiply(const int m, const double* __restrict__ A, const double* __restrict__ B,
+								double* __restrict__ C) {
+	for (int j = 0; j < m; ++j) {
+		for (int i = 0; i < m; ++i) {
+			C[i + j*STRIDE] = 0.0;
+		}
+		for (int k = 0; k < m; ++k) {
+			const double b = B[k + j*STRIDE];
+			for (int i = 0; i < m; ++i) {
+				C[i + j*STRIDE] += A[i + k*STRIDE] * b;
+			}
+		}
+	}
+}
+
+/** \brief Evaluates the truncated Taylor series \f$\sum_{k=0}^{K} X^k / (k + p)!\f$ of \f$\phi_p(X)\f$
+ *
+ *  The series of degree #PHI_TAYLOR_DEGREE is evaluated by the Paterson-Stockmeyer scheme, i.e. by Horner's
+ *  rule in \f$X^q\f$ (with \f$q\f$ = #PHI_TAYLOR_BLOCK) over blocks formed from the shared powers
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		p		The order of the phi function
+ *  \param[in]		powers	The powers \f$X, X^2 \ldots X^q\f$
+ *  \param[out]		F		The resulting phi function
+ *  \param[out]		work	A work matrix
+ */
+static void phi_taylor_series(const int m, const int p, double* const powers[PHI_TAYLOR_BLOCK],
+							  double* __restrict__ F, double* __restrict__ work) {
+	double coeffs[PHI_TAYLOR_DEGREE + 1];
+	coeffs[0] = 1.0;
+	for (int k = 2; k <= p; ++k)
+		coeffs[0] /= k;
+	for (int k = 1; k <= PHI_TAYLOR_DEGREE; ++k)
+		coeffs[k] = coeffs[k - 1] / (k + p);
+
+	for (int b = PHI_TAYLOR_DEGREE / PHI_TAYLOR_BLOCK; b >= 0; --b) {
+		if (b < PHI_TAYLOR_DEGREE / PHI_TAYLOR_BLOCK) {
+			phi_multiply(m, powers[PHI_TAYLOR_BLOCK - 1], F, work);
+			memcpy(F, work, m * STRIDE * sizeof(double));
+		} else {
+			memset(F, 0, m * STRIDE * sizeof(double));
+		}
+		// add the block sum_i coeffs[b * q + i] X^i
+		for (int i = 0; i < PHI_TAYLOR_BLOCK && b * PHI_TAYLOR_BLOCK + i <= PHI_TAYLOR_DEGREE; ++i) {
+			const double a = coeffs[b * PHI_TAYLOR_BLOCK + i];
+			if (i == 0) {
+				for (int j = 0; j < m; ++j)
+					F[j + j*STRIDE] += a;
+				continue;
+			}
+			for (int j = 0; j < m; ++j) {
+				for (int k = 0; k < m; ++k) {
+					F[k + j*STRIDE] += a * powers[i - 1][k + j*STRIDE];
+				}
+			}
+		}
+	}
+}
+
+/** \brief Computes \f$\phi_0(c*A) \ldots \phi_p(c*A)\f$ by scaling and squaring from a single set of matrix powers
+ *
+ *  \f$c*A\f$ is scaled by \f$2^{-s}\f$ such that its 1-norm is at most #PHI_TAYLOR_THETA, the powers of the scaled
+ *  matrix are formed once and shared by the truncated Taylor series of each phi function, and the results are
+ *  squared back with \f$e^{2X} = (e^X)^2\f$, \f$\phi_1(2X) = \frac{1}{2}(e^X + I)\phi_1(X)\f$ and
+ *  \f$\phi_2(2X) = \frac{1}{4}(\phi_1(X)^2 + 2\phi_2(X))\f$
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		A		The input Hessenberg matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[in]		p		The order of the requested phi function (at most 2)
+ *  \param[out]		phiA	The resulting phi matrix function
+ *  \return			Non-zero if the scaled matrix is not finite
+ */
+static int phi_taylor(const int m, const double* A, const double c, const int p, double* phiA) {
+	double work[PHI_TAYLOR_WORK][STRIDE * STRIDE];
+	double* powers[PHI_TAYLOR_BLOCK];
+	for (int k = 0; k < PHI_TAYLOR_BLOCK; ++k)
+		powers[k] = work[k];
+	double* temp = work[PHI_TAYLOR_BLOCK];
+	double* F[3] = {work[PHI_TAYLOR_BLOCK + 1], work[PHI_TAYLOR_BLOCK + 2], work[PHI_TAYLOR_BLOCK + 3]};
+
+	// the 1-norm of c * A
+	double norm = 0;
+	for (int j = 0; j < m; ++j) {
+		double col = 0;
+		for (int i = 0; i < m; ++i) {
+			col += fabs(A[i + j*STRIDE]);
+		}
+		norm = fmax(norm, col);
+	}
+	norm *= fabs(c);
+	if (!isfinite(norm))
+		return 1;
+
+	int s = 0;
+	double scale = c;
+	while (norm > PHI_TAYLOR_THETA) {
+		norm *= 0.5;
+		scale *= 0.5;
+		s++;
+	}
+
+	for (int j = 0; j < m; ++j) {
+		for (int i = 0; i < m; ++i) {
+			powers[0][i + j*STRIDE] = scale * A[i + j*STRIDE];
+		}
+	}
+	for (int k = 1; k < PHI_TAYLOR_BLOCK; ++k)
+		phi_multiply(m, powers[k - 1], powers[0], powers[k]);
+
+	for (int k = 0; k <= p; ++k)
+		phi_taylor_series(m, k, powers, F[k], temp);
+
+	for (; s > 0; --s) {
+		double* swap;
+		// update in decreasing order, as each phi function is squared based on the lower orders
+		if (p >= 2) {
+			phi_multiply(m, F[1], F[1], temp);
+			for (int j = 0; j < m; ++j) {
+				for (int i = 0; i < m; ++i) {
+					F[2][i + j*STRIDE] = 0.25 * (temp[i + j*STRIDE] + 2.0 * F[2][i + j*STRIDE]);
+				}
+			}
+		}
+		if (p >= 1) {
+			phi_multiply(m, F[0], F[1], temp);
+			for (int j = 0; j < m; ++j) {
+				for (int i = 0; i < m; ++i) {
+					F[1][i + j*STRIDE] = 0.5 * (temp[i + j*STRIDE] + F[1][i + j*STRIDE]);
+				}
+			}
+		}
+		phi_multiply(m, F[0], F[0], temp);
+		swap = F[0];
+		F[0] = temp;
+		temp = swap;
+	}
+
+	for (int j = 0; j < m; ++j) {
+		for (int i = 0; i < m; ++i) {
+			phiA[i + j*STRIDE] = F[p][i + j*STRIDE];
+		}
+	}
+
+	return 0;
+}
+
+/** \brief Compute the 2nd order Phi (exponential) matrix function
+ *
+ *  Computes \f$\phi_2(c*A)\f$, @see phi_taylor
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		A		The input Hessenberg matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ */
+int phi2Ac_variable(const int m, const double* A, const double c, double* phiA) {
+	return phi_taylor(m, A, c, 2, phiA);
+}
+
+/** \brief Compute the first order Phi (exponential) matrix function
+ *
+ *  Computes \f$\phi_1(c*A)\f$, @see phi_taylor
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		A		The input Hessenberg matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ */
+int phiAc_variable(const int m, const double* A, const double c, double* phiA) {
+	return phi_taylor(m, A, c, 1, phiA);
+}
+
+/** \brief Compute the zeroth order Phi (exponential) matrix function.
+ *		   This is the regular matrix exponential
+ *
+ *  Computes \f$\phi_0(c*A)\f$, @see phi_taylor
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		A		The input Hessenberg matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ */
+int expAc_variable(const int m, const double* A, const double c, double* phiA) {
+	return phi_taylor(m, A, c, 0, phiA);
+}
+
+/** \brief Compute the zeroth order Phi (exponential) matrix function of a general (e.g. block Hessenberg) matrix
+ *
+ *  Computes \f$\phi_0(c*A)\f$, @see phi_taylor, which does not depend on the structure of `A`
+ *
+ *  \param[in]		m		The matrix size (mxm)
+ *  \param[in]		A		The input matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ */
+int expAc_block(const int m, const double* A, const double c, double* phiA) {
+	return phi_taylor(m, A, c, 0, phiA);
+}
+
+#endif
@@ -8,6 +8,9 @@
 #include "solver_options.cuh"
 #include "solver_props.cuh"
 #include "complexInverse.cuh"
+#include "phiAHessenberg.cuh"
+
+#ifndef PHI_TAYLOR
 
 extern __device__ __constant__ cuDoubleComplex poles[N_RA];
 extern __device__ __constant__ cuDoubleComplex res[N_RA];
@@ -192,4 +195,308 @@ int expAc_variable(const int m, const double* __restrict__ A, const double c,
 		}
 	}
 	return 0;
-}
\ No newline at end of file
+}
+
+/** \brief Compute the zeroth order Phi (exponential) matrix function of a general (e.g. block Hessenberg) matrix
+ *
+ *  Computes \f$\phi_0(c*A)\f$ as expAc_variable, but inverts the shifted matricies by getComplexInverse (with
+ *  full partial pivoting), such that `A` need not be upper Hessenberg, @see arnoldi_block
+ *
+ *  \param[in]		m		The matrix size (mxm)
+ *  \param[in]		A		The input matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ *  \param[in]		solver  The solver_memory object
+ *  \param[in]		work	A complex work array
+ */
+__device__
+int expAc_block(const int m, const double* __restrict__ A, const double c,
+					double* __restrict__ phiA, const solver_memory* __restrict__ solver,
+					cuDoubleComplex* __restrict__ work) {
+
+	cuDoubleComplex * const __restrict__ invA = solver->invA;
+	int * const __restrict__ ipiv = solver->ipiv;
+	int info = 0;
+
+	#pragma unroll
+	for (int i = 0; i < m; ++i) {
+		#pragma unroll
+		for (int j = 0; j < m; ++j) {
+			phiA[INDEX(i + j*STRIDE)] = 0.0;
+		}
+	}
+
+	#pragma unroll
+	for (int q = 0; q < N_RA; q += 2) {
+
+		for (int i = 0; i < m; ++i) {
+			for (int j = 0; j < m; ++j) {
+				// A - theta * I
+				if (i == j) {
+					invA[INDEX(i + j*STRIDE)] = cuCsub(make_cuDoubleComplex(c * A[INDEX(i + j*STRIDE)], 0.0), poles[q]);
+				} else {
+					invA[INDEX(i + j*STRIDE)] = make_cuDoubleComplex(c * A[INDEX(i + j*STRIDE)], 0.0);
+				}
+			}
+		}
+
+		// takes care of (A * c - poles(q) * I)^-1
+		getComplexInverse (m, invA, ipiv, &info, work);
+
+		if (info != 0)
+			return info;
+
+
+		#pragma unroll
+		for (int i = 0; i < m; ++i) {
+			#pragma unroll
+			for (int j = 0; j < m; ++j) {
+				phiA[INDEX(i + j*STRIDE)] += 2.0 * cuCreal( cuCmul( res[q], invA[INDEX(i + j*STRIDE)]) );
+			}
+		}
+	}
+	return 0;
+}
+
+#else
+
+/** \brief Computes the (mxm) matrix product \f$C = A B\f$ of matricies with leading dimension #STRIDE
+ */
+__device__
+void phi_multiply(const int m, const double* __restrict__ A, const double* __restrict__ B,
+					double* __restrict__ C) {
+	for (int j = 0; j < m; ++j) {
+		for (int i = 0; i < m; ++i) {
+			C[INDEX(i + j*STRIDE)] = 0.0;
+		}
+		for (int k = 0; k < m; ++k) {
+			const double b = B[INDEX(k + j*STRIDE)];
+			for (int i = 0; i < m; ++i) {
+				C[INDEX(i + j*STRIDE)] += A[INDEX(i + k*STRIDE)] * b;
+			}
+		}
+	}
+}
+
+/** \brief Evaluates the truncated Taylor series \f$\sum_{k=0}^{K} X^k / (k + p)!\f$ of \f$\phi_p(X)\f$
+ *
+ *  The series of degree #PHI_TAYLOR_DEGREE is evaluated by the Paterson-Stockmeyer scheme, i.e. by Horner's
+ *  rule in \f$X^q\f$ (with \f$q\f$ = #PHI_TAYLOR_BLOCK) over blocks formed from the shared powers
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		p		The order of the phi function
+ *  \param[in]		powers	The powers \f$X, X^2 \ldots X^q\f$
+ *  \param[out]		F		The resulting phi function
+ *  \param[out]		work	A work matrix
+ */
+__device__
+void phi_taylor_series(const int m, const int p, double* const powers[PHI_TAYLOR_BLOCK],
+						double* __restrict__ F, double* __restrict__ work) {
+	double coeffs[PHI_TAYLOR_DEGREE + 1];
+	coeffs[0] = 1.0;
+	for (int k = 2; k <= p; ++k)
+		coeffs[0] /= k;
+	#pragma unroll
+	for (int k = 1; k <= PHI_TAYLOR_DEGREE; ++k)
+		coeffs[k] = coeffs[k - 1] / (k + p);
+
+	for (int b = PHI_TAYLOR_DEGREE / PHI_TAYLOR_BLOCK; b >= 0; --b) {
+		if (b < PHI_TAYLOR_DEGREE / PHI_TAYLOR_BLOCK) {
+			phi_multiply(m, powers[PHI_TAYLOR_BLOCK - 1], F, work);
+			for (int j = 0; j < m; ++j) {
+				for (int i = 0; i < m; ++i) {
+					F[INDEX(i + j*STRIDE)] = work[INDEX(i + j*STRIDE)];
+				}
+			}
+		} else {
+			for (int j = 0; j < m; ++j) {
+				for (int i = 0; i < m; ++i) {
+					F[INDEX(i + j*STRIDE)] = 0.0;
+				}
+			}
+		}
+		// add the block sum_i coeffs[b * q + i] X^i
+		for (int i = 0; i < PHI_TAYLOR_BLOCK && b * PHI_TAYLOR_BLOCK + i <= PHI_TAYLOR_DEGREE; ++i) {
+			const double a = coeffs[b * PHI_TAYLOR_BLOCK + i];
+			if (i == 0) {
+				for (int j = 0; j < m; ++j)
+					F[INDEX(j + j*STRIDE)] += a;
+				continue;
+			}
+			for (int j = 0; j < m; ++j) {
+				for (int k = 0; k < m; ++k) {
+					F[INDEX(k + j*STRIDE)] += a * powers[i - 1][INDEX(k + j*STRIDE)];
+				}
+			}
+		}
+	}
+}
+
+/** \brief Computes \f$\phi_0(c*A) \ldots \phi_p(c*A)\f$ by scaling and squaring from a single set of matrix powers
+ *
+ *  \f$c*A\f$ is scaled by \f$2^{-s}\f$ such that its 1-norm is at most #PHI_TAYLOR_THETA, the powers of the scaled
+ *  matrix are formed once and shared by the truncated Taylor series of each phi function, and the results are
+ *  squared back with \f$e^{2X} = (e^X)^2\f$, \f$\phi_1(2X) = \frac{1}{2}(e^X + I)\phi_1(X)\f$ and
+ *  \f$\phi_2(2X) = \frac{1}{4}(\phi_1(X)^2 + 2\phi_2(X))\f$
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		A		The input Hessenberg matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[in]		p		The order of the requested phi function (at most 2)
+ *  \param[out]		phiA	The resulting phi matrix function
+ *  \param[in]		solver  The solver_memory object, with the #PHI_TAYLOR_WORK work matricies
+ *  \return			Non-zero if the scaled matrix is not finite
+ */
+__device__
+int phi_taylor(const int m, const double* __restrict__ A, const double c, const int p,
+				double* __restrict__ phiA, const solver_memory* __restrict__ solver) {
+	double* powers[PHI_TAYLOR_BLOCK];
+	#pragma unroll
+	for (int k = 0; k < PHI_TAYLOR_BLOCK; ++k)
+		powers[k] = &solver->phi_work[GRID_DIM * (k * STRIDE * STRIDE)];
+	double* temp = &solver->phi_work[GRID_DIM * (PHI_TAYLOR_BLOCK * STRIDE * STRIDE)];
+	double* F[3];
+	#pragma unroll
+	for (int k = 0; k < 3; ++k)
+		F[k] = &solver->phi_work[GRID_DIM * ((PHI_TAYLOR_BLOCK + 1 + k) * STRIDE * STRIDE)];
+
+	// the 1-norm of c * A
+	double norm = 0;
+	for (int j = 0; j < m; ++j) {
+		double col = 0;
+		for (int i = 0; i < m; ++i) {
+			col += fabs(A[INDEX(i + j*STRIDE)]);
+		}
+		norm = fmax(norm, col);
+	}
+	norm *= fabs(c);
+	if (!isfinite(norm))
+		return 1;
+
+	int s = 0;
+	double scale = c;
+	while (norm > PHI_TAYLOR_THETA) {
+		norm *= 0.5;
+		scale *= 0.5;
+		s++;
+	}
+
+	for (int j = 0; j < m; ++j) {
+		for (int i = 0; i < m; ++i) {
+			powers[0][INDEX(i + j*STRIDE)] = scale * A[INDEX(i + j*STRIDE)];
+		}
+	}
+	for (int k = 1; k < PHI_TAYLOR_BLOCK; ++k)
+		phi_multiply(m, powers[k - 1], powers[0], powers[k]);
+
+	for (int k = 0; k <= p; ++k)
+		phi_taylor_series(m, k, powers, F[k], temp);
+
+	for (; s > 0; --s) {
+		double* swap;
+		// update in decreasing order, as each phi function is squared based on the lower orders
+		if (p >= 2) {
+			phi_multiply(m, F[1], F[1], temp);
+			for (int j = 0; j < m; ++j) {
+				for (int i = 0; i < m; ++i) {
+					F[2][INDEX(i + j*STRIDE)] = 0.25 * (temp[INDEX(i + j*STRIDE)] + 2.0 * F[2][INDEX(i + j*STRIDE)]);
+				}
+			}
+		}
+		if (p >= 1) {
+			phi_multiply(m, F[0], F[1], temp);
+			for (int j = 0; j < m; ++j) {
+				for (int i = 0; i < m; ++i) {
+					F[1][INDEX(i + j*STRIDE)] = 0.5 * (temp[INDEX(i + j*STRIDE)] + F[1][INDEX(i + j*STRIDE)]);
+				}
+			}
+		}
+		phi_multiply(m, F[0], F[0], temp);
+		swap = F[0];
+		F[0] = temp;
+		temp = swap;
+	}
+
+	for (int j = 0; j < m; ++j) {
+		for (int i = 0; i < m; ++i) {
+			phiA[INDEX(i + j*STRIDE)] = F[p][INDEX(i + j*STRIDE)];
+		}
+	}
+
+	return 0;
+}
+
+/** \brief Compute the 2nd order Phi (exponential) matrix function
+ *
+ *  Computes \f$\phi_2(c*A)\f$, @see phi_taylor
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		A		The input Hessenberg matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ *  \param[in]		solver  The solver_memory object
+ *  \param[in]		work	A complex work array (unused)
+ */
+__device__
+int phi2Ac_variable(const int m, const double* __restrict__ A, const double c,
+						double* __restrict__ phiA, const solver_memory* __restrict__ solver,
+						cuDoubleComplex* __restrict__ work) {
+	return phi_taylor(m, A, c, 2, phiA, solver);
+}
+
+/** \brief Compute the first order Phi (exponential) matrix function
+ *
+ *  Computes \f$\phi_1(c*A)\f$, @see phi_taylor
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		A		The input Hessenberg matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ *  \param[in]		solver  The solver_memory object
+ *  \param[in]		work	A complex work array (unused)
+ */
+__device__
+int phiAc_variable(const int m, const double* __restrict__ A, const double c,
+						double* __restrict__ phiA, const solver_memory* __restrict__ solver,
+						cuDoubleComplex* __restrict__ work) {
+	return phi_taylor(m, A, c, 1, phiA, solver);
+}
+
+/** \brief Compute the zeroth order Phi (exponential) matrix function.
+ *		   This is the regular matrix exponential
+ *
+ *  Computes \f$\phi_0(c*A)\f$, @see phi_taylor
+ *
+ *  \param[in]		m		The Hessenberg matrix size (mxm)
+ *  \param[in]		A		The input Hessenberg matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ *  \param[in]		solver  The solver_memory object
+ *  \param[in]		work	A complex work array (unused)
+ */
+__device__
+int expAc_variable(const int m, const double* __restrict__ A, const double c,
+						double* __restrict__ phiA, const solver_memory* __restrict__ solver,
+						cuDoubleComplex* __restrict__ work) {
+	return phi_taylor(m, A, c, 0, phiA, solver);
+}
+
+/** \brief Compute the zeroth order Phi (exponential) matrix function of a general (e.g. block Hessenberg) matrix
+ *
+ *  Computes \f$\phi_0(c*A)\f$, @see phi_taylor, which does not depend on the structure of `A`
+ *
+ *  \param[in]		m		The matrix size (mxm)
+ *  \param[in]		A		The input matrix
+ *  \param[in]		c		The scaling factor
+ *  \param[out]		phiA	The resulting exponential matrix
+ *  \param[in]		solver  The solver_memory object
+ *  \param[in]		work	A complex work array (unused)
+ */
+__device__
+int expAc_block(const int m, const double* __restrict__ A, const double c,
+					double* __restrict__ phiA, const solver_memory* __restrict__ solver,
+					cuDoubleComplex* __restrict__ work) {
+	return phi_taylor(m, A, c, 0, phiA, solver);
+}
+
+#endif
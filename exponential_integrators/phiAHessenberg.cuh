@@ -7,6 +7,18 @@
 #define PHIA_HEAD_HESSENBERG_CU
 
 #include "header.cuh"
+#include "solver_options.cuh"
+
+#ifdef PHI_TAYLOR
+//! The degree of the truncated Taylor series of the phi functions
+#define PHI_TAYLOR_DEGREE (14)
+//! The number of shared matrix powers of the Paterson-Stockmeyer evaluation of the series
+#define PHI_TAYLOR_BLOCK (3)
+//! The 1-norm the matrix is scaled to before the series are evaluated
+#define PHI_TAYLOR_THETA (0.5)
+//! The number of (#STRIDE x #STRIDE) work matricies per IVP: the shared powers, a temporary and phi_0 .. phi_2
+#define PHI_TAYLOR_WORK (PHI_TAYLOR_BLOCK + 4)
+#endif
 
 //void phiAv (const double*, const double, const double*, double*);
 __device__ int phi2Ac_variable(const int, const double* __restrict__, const double, double* __restrict__,
@@ -15,5 +27,7 @@ __device__ int phiAc_variable(const int, const double* __restrict__, const doubl
 								const solver_memory* __restrict__, cuDoubleComplex* __restrict__);
 __device__ int expAc_variable(const int, const double* __restrict__, const double, double* __restrict__,
 								const solver_memory* __restrict__, cuDoubleComplex* __restrict__);
+__device__ int expAc_block(const int, const double* __restrict__, const double, double* __restrict__,
+								const solver_memory* __restrict__, cuDoubleComplex* __restrict__);
 
 #endif
\ No newline at end of file
@@ -7,10 +7,23 @@
 #define PHIA_HEAD_HESSENBERG
 
 #include "header.h"
+#include "solver_options.h"
+
+#ifdef PHI_TAYLOR
+//! The degree of the truncated Taylor series of the phi functions
+#define PHI_TAYLOR_DEGREE (14)
+//! The number of shared matrix powers of the Paterson-Stockmeyer evaluation of the series
+#define PHI_TAYLOR_BLOCK (3)
+//! The 1-norm the matrix is scaled to before the series are evaluated
+#define PHI_TAYLOR_THETA (0.5)
+//! The number of (#STRIDE x #STRIDE) work matricies: the shared powers, a temporary and phi_0 .. phi_2
+#define PHI_TAYLOR_WORK (PHI_TAYLOR_BLOCK + 4)
+#endif
 
 //void phiAv (const double*, const double, const double*, double*);
 int phi2Ac_variable(const int, const double*, const double, double*);
 int phiAc_variable(const int, const double*, const double, double*);
 int expAc_variable(const int, const double*, const double, double*);
+int expAc_block(const int, const double*, const double, double*);
 
 #endif
\ No newline at end of file
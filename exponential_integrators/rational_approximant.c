@@ -10,18 +10,34 @@
 
 //cf
 #include "header.h"
-#include "cf.h"
 #include "solver_options.h"
 #include <complex.h>
+#ifdef RA_TABLE
+#include "rational_approximant_table.h"
+#if RA_TABLE_ORDER != N_RA
+#error "The rational approximant table does not match N_RA, rebuild to regenerate it."
+#endif
+#else
+#include <stdlib.h>
+#include "cf.h"
+#endif
 
 double complex poles[N_RA];
 double complex res[N_RA];
 
 /**
-* \brief get poles and residues for rational approximant to matrix exponential
+* \brief compute the poles and residues for rational approximant to matrix exponential
 */
-void find_poles_and_residuals()
+static void compute_poles_and_residuals()
 {
+#ifdef RA_TABLE
+    // tabulated at build time, @see cf_table.c
+    for (int i = 0; i < N_RA; ++i)
+    {
+        poles[i] = ra_poles_r[i] + ra_poles_i[i] * _Complex_I;
+        res[i] = ra_res_r[i] + ra_res_i[i] * _Complex_I;
+    }
+#else
 	// get poles and residues for rational approximant to matrix exponential
     double *poles_r = (double *) calloc (N_RA, sizeof(double));
     double *poles_i = (double *) calloc (N_RA, sizeof(double));
@@ -41,4 +57,24 @@ void find_poles_and_residuals()
     free (poles_i);
     free (res_r);
     free (res_i);
+#endif
+}
+
+/**
+* \brief get poles and residues for rational approximant to matrix exponential
+*
+* The poles and residues are shared by all solver instances, hence are only computed by the first call.
+*/
+void find_poles_and_residuals()
+{
+    //set once the poles and residues are computed
+    static int computed = 0;
+    #pragma omp critical(find_poles_and_residuals)
+    {
+        if (!computed)
+        {
+            compute_poles_and_residuals();
+            computed = 1;
+        }
+    }
 }
\ No newline at end of file
@@ -11,20 +11,42 @@
 //cf
 #include <cuComplex.h>
 #include "header.cuh"
+#include "solver_options.cuh"
+#include "gpu_macros.cuh"
+// the host code is not compiled by NVRTC (@see nvrtc_kernels.cuh), which only needs the poles and residues
+#ifndef __CUDACC_RTC__
+#ifdef RA_TABLE
+#include "rational_approximant_table.h"
+#if RA_TABLE_ORDER != N_RA
+#error "The rational approximant table does not match N_RA, rebuild to regenerate it."
+#endif
+#else
 extern "C" {
 #include "cf.h"
 }
-#include "solver_options.cuh"
-#include "gpu_macros.cuh"
+#endif
+#endif
 
 __device__ __constant__ cuDoubleComplex poles[N_RA];
 __device__ __constant__ cuDoubleComplex res[N_RA];
 
+#ifndef __CUDACC_RTC__
 /**
 * \brief get poles and residues for rational approximant to matrix exponential
 */
 void find_poles_and_residuals()
 {
+    cuDoubleComplex polesHost[N_RA];
+    cuDoubleComplex resHost[N_RA];
+
+#ifdef RA_TABLE
+    // tabulated at build time, @see cf_table.c
+    for (int i = 0; i < N_RA; ++i)
+    {
+        polesHost[i] = make_cuDoubleComplex(ra_poles_r[i], ra_poles_i[i]);
+        resHost[i] = make_cuDoubleComplex(ra_res_r[i], ra_res_i[i]);
+    }
+#else
 	// get poles and residues for rational approximant to matrix exponential
     double *poles_r = (double *) calloc (N_RA, sizeof(double));
     double *poles_i = (double *) calloc (N_RA, sizeof(double));
@@ -33,9 +55,6 @@ void find_poles_and_residuals()
 
     cf (N_RA, poles_r, poles_i, res_r, res_i);
 
-    cuDoubleComplex polesHost[N_RA];
-    cuDoubleComplex resHost[N_RA];
-
     for (int i = 0; i < N_RA; ++i)
     {
         polesHost[i] = make_cuDoubleComplex(poles_r[i], poles_i[i]);
@@ -47,8 +66,10 @@ void find_poles_and_residuals()
     free (poles_i);
     free (res_r);
     free (res_i);
+#endif
 
     //copy to GPU memory
     cudaErrorCheck( cudaMemcpyToSymbol (poles, polesHost, N_RA * sizeof(cuDoubleComplex), 0, cudaMemcpyHostToDevice) );
     cudaErrorCheck( cudaMemcpyToSymbol (res, resHost, N_RA * sizeof(cuDoubleComplex), 0, cudaMemcpyHostToDevice) );
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,128 @@
+/**
+ * \file
+ * \brief Implementation of the batched (cuBLAS) LU factorization of the GPU Radau-IIa system matrices
+ *
+ * \see batched_lu.cuh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cublas_v2.h>
+#include "batched_lu.cuh"
+#include "gpu_arena.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef BATCHED_LU
+
+#define cublasErrorCheck(ans) { cublasAssert((ans), __FILE__, __LINE__); }
+inline void cublasAssert(cublasStatus_t code, const char *file, int line)
+{
+    if (code != CUBLAS_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "CUBLASassert: status %d %s %d\n", (int)code, file, line);
+        exit(code);
+    }
+}
+
+bool batched_lu_selected()
+{
+    int min_nsp = BATCHED_LU_MIN_NSP;
+    const char* env = getenv("ACCELERINT_BATCHED_LU_MIN_NSP");
+    if (env != NULL && env[0] != '\0')
+        min_nsp = atoi(env);
+    return NSP >= min_nsp;
+}
+
+size_t batched_lu_size()
+{
+    if (!batched_lu_selected())
+        return 0;
+    //the real and complex matrices
+    size_t num_bytes = NSP * NSP * (sizeof(double) + sizeof(cuDoubleComplex));
+    //their pointers and pivot indicies
+    num_bytes += sizeof(double*) + sizeof(cuDoubleComplex*) + 2 * NSP * sizeof(int);
+    //the slot and the results
+    num_bytes += 3 * sizeof(int);
+    return num_bytes;
+}
+
+void initialize_batched_lu(const int padded, batched_lu* lu)
+{
+    memset(lu, 0, sizeof(batched_lu));
+    lu->enabled = batched_lu_selected();
+    if (!lu->enabled)
+        return;
+    cudaErrorCheck( arena_malloc((void**)&lu->resume, sizeof(int)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->count, sizeof(int)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->slot, padded * sizeof(int)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->E1, (size_t)NSP * NSP * padded * sizeof(double)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->E2, (size_t)NSP * NSP * padded * sizeof(cuDoubleComplex)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->E1_batch, padded * sizeof(double*)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->E2_batch, padded * sizeof(cuDoubleComplex*)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->ipiv1, NSP * padded * sizeof(int)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->ipiv2, NSP * padded * sizeof(int)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->info1, padded * sizeof(int)) );
+    cudaErrorCheck( arena_malloc((void**)&lu->info2, padded * sizeof(int)) );
+    cudaErrorCheck( cudaMemset(lu->resume, 0, sizeof(int)) );
+    cudaErrorCheck( cudaMemset(lu->count, 0, sizeof(int)) );
+    cudaErrorCheck( cudaMallocHost((void**)&lu->count_host, sizeof(int)) );
+    cublasHandle_t handle;
+    cublasErrorCheck( cublasCreate(&handle) );
+    lu->handle = (void*)handle;
+}
+
+void cleanup_batched_lu(batched_lu* lu)
+{
+    if (!lu->enabled)
+        return;
+    cublasErrorCheck( cublasDestroy((cublasHandle_t)lu->handle) );
+    cudaErrorCheck( cudaFreeHost(lu->count_host) );
+    cudaErrorCheck( arena_free(lu->resume) );
+    cudaErrorCheck( arena_free(lu->count) );
+    cudaErrorCheck( arena_free(lu->slot) );
+    cudaErrorCheck( arena_free(lu->E1) );
+    cudaErrorCheck( arena_free(lu->E2) );
+    cudaErrorCheck( arena_free(lu->E1_batch) );
+    cudaErrorCheck( arena_free(lu->E2_batch) );
+    cudaErrorCheck( arena_free(lu->ipiv1) );
+    cudaErrorCheck( arena_free(lu->ipiv2) );
+    cudaErrorCheck( arena_free(lu->info1) );
+    cudaErrorCheck( arena_free(lu->info2) );
+    lu->enabled = false;
+}
+
+void batched_lu_begin(const batched_lu* lu, cudaStream_t stream)
+{
+    if (!lu->enabled)
+        return;
+    cudaErrorCheck( cudaMemsetAsync(lu->resume, 0, sizeof(int), stream) );
+}
+
+bool batched_lu_factor(const batched_lu* lu, cudaStream_t stream)
+{
+    if (!lu->enabled)
+        return false;
+    cudaErrorCheck( cudaMemcpyAsync(lu->count_host, lu->count, sizeof(int), cudaMemcpyDeviceToHost, stream) );
+    cudaErrorCheck( cudaStreamSynchronize(stream) );
+    const int count = *lu->count_host;
+    if (count == 0)
+        return false;
+    cublasHandle_t handle = (cublasHandle_t)lu->handle;
+    cublasErrorCheck( cublasSetStream(handle, stream) );
+    cublasErrorCheck( cublasDgetrfBatched(handle, NSP, lu->E1_batch, NSP, lu->ipiv1, lu->info1, count) );
+    cublasErrorCheck( cublasZgetrfBatched(handle, NSP, lu->E2_batch, NSP, lu->ipiv2, lu->info2, count) );
+    // empty the batch for the relaunch
+    cudaErrorCheck( cudaMemsetAsync(lu->count, 0, sizeof(int), stream) );
+    cudaErrorCheck( cudaMemsetAsync(lu->resume, 1, sizeof(int), stream) );
+    return true;
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,183 @@
+/**
+ * \file
+ * \brief Header definitions for the batched (cuBLAS) LU factorization of the GPU Radau-IIa system matrices
+ *
+ * The dense factorizations getLU / getComplexLU (and warp_getLU) are performed within the integration
+ * kernel, each thread factoring the matrices of its IVP.  For larger mechanisms, the factorizations are
+ * instead left to the batched routines of cuBLAS (`cublasDgetrfBatched` / `cublasZgetrfBatched`), which
+ * factor the matrices of many IVPs at once with tuned kernels.  As these are launched from the host, the
+ * integration kernel is split at each factorization:
+ *  -# a thread that must factor its system matrices copies them to the batch (in contiguous, column-major
+ *     storage), registers them in the next slot of the batch, saves its step state and returns with the
+ *     #EC_lu_pending marker
+ *  -# the host factors the registered matrices with the batched routines, @see batched_lu_factor
+ *  -# the kernel is relaunched: the suspended threads copy their factors back to their (#INDEX strided)
+ *     matrices and continue the step, while all other threads return immediately
+ *
+ * until no thread is suspended.  The linear solves of the Newton iterations remain in the kernel.
+ *
+ * If the BATCHED_LU option is enabled (#BATCHED_LU_AUTO), the batched factorization is selected at
+ * initialization if NSP is at least #BATCHED_LU_MIN_NSP, or the value of the `ACCELERINT_BATCHED_LU_MIN_NSP`
+ * environment variable if set, @see batched_lu_selected.  Each round of a chunk synchronizes its stream,
+ * hence the option is incompatible with the persistent, managed memory and CUDA graph drivers.
+ */
+
+#ifndef BATCHED_LU_CUH
+#define BATCHED_LU_CUH
+
+#include "header.cuh"
+#include "solver_options.cuh"
+#include "gpu_macros.cuh"
+#include <cuComplex.h>
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#if defined(RADAU2A) && defined(BATCHED_LU_AUTO) && !defined(MIXED_PRECISION) && !defined(HESSENBERG_RADAU) \
+    && !defined(SPARSE_LU)
+    //! The Radau-IIa solver may factor its matrices with the batched library routines, @see batched_lu_selected
+    #define BATCHED_LU
+#endif
+
+#ifdef BATCHED_LU
+
+#ifndef BATCHED_LU_MIN_NSP
+    //! The default minimum number of species for which the batched factorization is selected
+    #define BATCHED_LU_MIN_NSP (64)
+#endif
+
+/**
+ * \brief The batch of system matrices of a solver memory set
+ *
+ * The device arrays are indexed by thread (`E1[T_ID * NSP * NSP + i + j * NSP]`, `slot[T_ID]`), or by the
+ * slot the thread registered its matrices in (`ipiv1[slot * NSP + i]`, `info1[slot]`).
+ */
+struct batched_lu
+{
+    //! True if the batched factorization is used, otherwise all other members are NULL
+    bool enabled;
+    //! Nonzero in the relaunches of a chunk, @see batched_lu_begin
+    int* resume;
+    //! The number of matrices registered in the batch
+    int* count;
+    //! The slot of the registered matrices of each thread
+    int* slot;
+    //! The real system matrices
+    double* E1;
+    //! The complex system matrices
+    cuDoubleComplex* E2;
+    //! The real system matrices of the registered slots
+    double** E1_batch;
+    //! The complex system matrices of the registered slots
+    cuDoubleComplex** E2_batch;
+    //! The (1-based) pivot indicies of the real system matrices
+    int* ipiv1;
+    //! The (1-based) pivot indicies of the complex system matrices
+    int* ipiv2;
+    //! The factorization result of the real system matrices, `j + 1` if the `j`th pivot is zero
+    int* info1;
+    //! The factorization result of the complex system matrices
+    int* info2;
+    //! The (host) cuBLAS handle of the batch
+    void* handle;
+    //! The (pinned host) number of matrices registered in the batch
+    int* count_host;
+};
+
+/**
+ * \brief Returns true if the batched factorization is selected for this mechanism size
+ */
+bool batched_lu_selected();
+
+/**
+ * \brief Returns the device memory (in bytes) the batch requires per thread, zero if not selected
+ */
+size_t batched_lu_size();
+
+/**
+ * \brief Allocates the batch of `padded` threads (if selected) on the current device
+ */
+void initialize_batched_lu(const int padded, batched_lu* lu);
+
+/**
+ * \brief Frees the batch
+ */
+void cleanup_batched_lu(batched_lu* lu);
+
+/**
+ * \brief Marks the next launch on `stream` as the first of a chunk, call before the integration kernel
+ */
+void batched_lu_begin(const batched_lu* lu, cudaStream_t stream);
+
+/**
+ * \brief Factors the matrices registered by the kernel just issued on `stream`, and marks the next launch as a relaunch
+ * \returns True if any matrix was factored (hence the kernel must be relaunched), false if the chunk is finished
+ *
+ * Synchronizes `stream`.  Always false if the batch is not used.
+ */
+bool batched_lu_factor(const batched_lu* lu, cudaStream_t stream);
+
+/**
+ * \brief Returns true if this launch continues the threads suspended at a factorization
+ */
+__device__ __forceinline__
+bool batched_lu_resuming(const batched_lu* __restrict__ lu)
+{
+    return lu->enabled && *lu->resume != 0;
+}
+
+/**
+ * \brief Copies the system matrices `E1` and `E2` of this thread to the batch, and registers them for factorization
+ */
+__device__ __forceinline__
+void batched_lu_suspend(const batched_lu* __restrict__ lu, const double* __restrict__ E1,
+                        const cuDoubleComplex* __restrict__ E2)
+{
+    double* __restrict__ A1 = &lu->E1[(size_t)T_ID * NSP * NSP];
+    cuDoubleComplex* __restrict__ A2 = &lu->E2[(size_t)T_ID * NSP * NSP];
+    #pragma unroll 8
+    for (int i = 0; i < NSP * NSP; ++i)
+    {
+        A1[i] = E1[INDEX(i)];
+        A2[i] = E2[INDEX(i)];
+    }
+    const int k = atomicAdd(lu->count, 1);
+    lu->slot[T_ID] = k;
+    lu->E1_batch[k] = A1;
+    lu->E2_batch[k] = A2;
+}
+
+/**
+ * \brief Copies the factors (and 0-based pivots) of the system matrices of this thread back from the batch
+ * \returns 0 on success, or the (non-zero) info of the first failed factorization, @see getLU
+ */
+__device__ __forceinline__
+int batched_lu_resume(const batched_lu* __restrict__ lu, double* __restrict__ E1, int* __restrict__ ipiv1,
+                      cuDoubleComplex* __restrict__ E2, int* __restrict__ ipiv2)
+{
+    const int k = lu->slot[T_ID];
+    const double* __restrict__ A1 = &lu->E1[(size_t)T_ID * NSP * NSP];
+    const cuDoubleComplex* __restrict__ A2 = &lu->E2[(size_t)T_ID * NSP * NSP];
+    #pragma unroll 8
+    for (int i = 0; i < NSP * NSP; ++i)
+    {
+        E1[INDEX(i)] = A1[i];
+        E2[INDEX(i)] = A2[i];
+    }
+    #pragma unroll 8
+    for (int i = 0; i < NSP; ++i)
+    {
+        ipiv1[INDEX(i)] = lu->ipiv1[k * NSP + i] - 1;
+        ipiv2[INDEX(i)] = lu->ipiv2[k * NSP + i] - 1;
+    }
+    return lu->info1[k] != 0 ? lu->info1[k] : lu->info2[k];
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ * \file
+ * \brief Monotonic timing, trial statistics and machine-readable output for the benchmark runs
+ *
+ * Used by the CPU and GPU main files: each run performs #BENCHMARK_WARMUP untimed warm-up trials,
+ * followed by #BENCHMARK_TRIALS timed trials from the same initial conditions.  If #BENCHMARK_OUTPUT
+ * is defined, a summary record of the trials is appended to the named file, as CSV if the file name
+ * ends with `.csv` and as [JSON lines](http://jsonlines.org/) (one object per run) otherwise.
+ * The solver options must be included before this file.
+ * @see benchmark.py
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifndef BENCHMARK_TRIALS
+    //! The number of timed trials per run
+    #define BENCHMARK_TRIALS (1)
+#endif
+#ifndef BENCHMARK_WARMUP
+    //! The number of untimed warm-up trials per run
+    #define BENCHMARK_WARMUP (0)
+#endif
+
+/**
+ * \brief The hardware metrics of a benchmark run, accumulated over its timed trials (#HW_COUNTERS)
+ *
+ * Negative values are unavailable.  @see hw_counters.h
+ */
+typedef struct
+{
+    //! the floating point operations
+    double flops;
+    //! the DRAM traffic (bytes)
+    double dram_bytes;
+    //! the L1 data cache hit rate
+    double l1_hit_rate;
+    //! the L2 (GPU) or last level (CPU) cache hit rate
+    double l2_hit_rate;
+    //! the theoretical occupancy of intDriver (GPU)
+    double occupancy;
+    //! the registers per thread of intDriver (GPU)
+    int registers;
+    //! the local memory (bytes) per thread of intDriver (GPU), i.e. its register spills and local arrays
+    int local_bytes;
+} benchmark_counters;
+
+/**
+ * \brief The configuration of a benchmark run
+ */
+typedef struct
+{
+    //! the solver name
+    const char* solver;
+    //! the platform, i.e. "cpu" or "gpu"
+    const char* platform;
+    //! the number of IVPs
+    int num_ivps;
+    //! the number of OpenMP threads (CPU) or devices (GPU)
+    int num_threads;
+    //! the GPU block size, zero for the CPU solvers
+    int block_size;
+    //! the number of global integration steps per trial
+    int num_steps;
+    //! the global integration step size
+    double stepsize;
+    //! the hardware metrics of the run, or NULL if not measured (only written if #HW_COUNTERS is defined)
+    const benchmark_counters* counters;
+} benchmark_info;
+
+/**
+ * \brief Summary statistics of the trial wall times (in seconds)
+ */
+typedef struct
+{
+    double min;
+    double max;
+    double mean;
+    //! the (unbiased) sample variance
+    double variance;
+    double median;
+    //! the 10th percentile
+    double p10;
+    //! the 90th percentile
+    double p90;
+} benchmark_summary;
+
+/**
+ * \brief Returns the time (in seconds) of a monotonic, high-resolution clock
+ */
+static inline double benchmark_time()
+{
+#ifdef WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#endif
+}
+
+//! qsort comparison of doubles
+static inline int benchmark_compare(const void* a, const void* b)
+{
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+/**
+ * \brief Returns the `p`-th percentile of the `n` sorted samples, linearly interpolated between the closest ranks
+ */
+static inline double benchmark_percentile(const int n, const double* sorted, const double p)
+{
+    double pos = p / 100.0 * (n - 1);
+    int lo = (int)floor(pos);
+    int hi = lo + 1 < n ? lo + 1 : n - 1;
+    return sorted[lo] + (pos - lo) * (sorted[hi] - sorted[lo]);
+}
+
+/**
+ * \brief Computes the summary statistics of the trial times
+ * \param[in]       n           The number of trials
+ * \param[in]       samples     The trial times
+ * \param[out]      summary     The summary statistics
+ */
+static inline void benchmark_summarize(const int n, const double* samples, benchmark_summary* summary)
+{
+    double* sorted = (double*)malloc(n * sizeof(double));
+    memcpy(sorted, samples, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), benchmark_compare);
+
+    double mean = 0;
+    for (int i = 0; i < n; ++i)
+        mean += sorted[i];
+    mean /= n;
+    double variance = 0;
+    for (int i = 0; i < n; ++i)
+        variance += (sorted[i] - mean) * (sorted[i] - mean);
+    variance = n > 1 ? variance / (n - 1) : 0;
+
+    summary->min = sorted[0];
+    summary->max = sorted[n - 1];
+    summary->mean = mean;
+    summary->variance = variance;
+    summary->median = benchmark_percentile(n, sorted, 50);
+    summary->p10 = benchmark_percentile(n, sorted, 10);
+    summary->p90 = benchmark_percentile(n, sorted, 90);
+    free(sorted);
+}
+
+#ifdef HW_COUNTERS
+/**
+ * \brief Writes a hardware metric of a record, empty (CSV) or null (JSON) if negative, i.e. unavailable
+ */
+static inline void benchmark_write_metric(FILE* file, const int csv, const char* name, const double value)
+{
+    if (csv && value < 0)
+        fprintf(file, ",");
+    else if (csv)
+        fprintf(file, ",%.9e", value);
+    else if (value < 0)
+        fprintf(file, ", \"%s\": null", name);
+    else
+        fprintf(file, ", \"%s\": %.9e", name, value);
+}
+
+/**
+ * \brief Writes the hardware metrics of a record, normalized per IVP-step, i.e. per IVP and global step of a trial
+ */
+static inline void benchmark_write_counters(FILE* file, const int csv, const benchmark_info* info, const int n)
+{
+    benchmark_counters none = {-1, -1, -1, -1, -1, -1, -1};
+    const benchmark_counters* c = info->counters != NULL ? info->counters : &none;
+    double ivp_steps = (double)info->num_ivps * info->num_steps * n;
+    benchmark_write_metric(file, csv, "flops_per_ivp_step", c->flops < 0 ? -1 : c->flops / ivp_steps);
+    benchmark_write_metric(file, csv, "bytes_per_ivp_step", c->dram_bytes < 0 ? -1 : c->dram_bytes / ivp_steps);
+    benchmark_write_metric(file, csv, "arithmetic_intensity",
+                           c->flops < 0 || c->dram_bytes <= 0 ? -1 : c->flops / c->dram_bytes);
+    benchmark_write_metric(file, csv, "l1_hit_rate", c->l1_hit_rate);
+    benchmark_write_metric(file, csv, "l2_hit_rate", c->l2_hit_rate);
+    benchmark_write_metric(file, csv, "occupancy", c->occupancy);
+    benchmark_write_metric(file, csv, "registers", c->registers);
+    benchmark_write_metric(file, csv, "local_bytes", c->local_bytes);
+}
+#endif
+
+/**
+ * \brief Appends the record of a benchmark run to `filename`
+ * \param[in]       filename    The output file, CSV if the name ends with `.csv`, JSON lines otherwise
+ * \param[in]       info        The configuration of the run
+ * \param[in]       n           The number of trials
+ * \param[in]       samples     The trial times (only written to JSON)
+ * \param[in]       summary     The summary statistics of the trials
+ *
+ * A header line is written to (new or empty) CSV files.  If #HW_COUNTERS is defined, the record includes
+ * the hardware metrics of `info`, @see benchmark_write_counters
+ */
+static inline void benchmark_write(const char* filename, const benchmark_info* info, const int n,
+                                   const double* samples, const benchmark_summary* summary)
+{
+    size_t len = strlen(filename);
+    int csv = len >= 4 && strcmp(&filename[len - 4], ".csv") == 0;
+    FILE* file = fopen(filename, "a");
+    if (file == NULL)
+    {
+        printf("Error: could not open benchmark output file %s\n", filename);
+        exit(-1);
+    }
+    if (csv)
+    {
+        fseek(file, 0, SEEK_END);
+        if (ftell(file) == 0)
+        {
+            fprintf(file, "solver,platform,num_ivps,num_threads,block_size,num_steps,stepsize,warmup,trials,"
+                          "min,max,mean,variance,median,p10,p90");
+#ifdef HW_COUNTERS
+            fprintf(file, ",flops_per_ivp_step,bytes_per_ivp_step,arithmetic_intensity,l1_hit_rate,l2_hit_rate,"
+                          "occupancy,registers,local_bytes");
+#endif
+            fprintf(file, "\n");
+        }
+        fprintf(file, "%s,%s,%d,%d,%d,%d,%.9e,%d,%d,%.9e,%.9e,%.9e,%.9e,%.9e,%.9e,%.9e",
+                info->solver, info->platform, info->num_ivps, info->num_threads, info->block_size,
+                info->num_steps, info->stepsize, BENCHMARK_WARMUP, n, summary->min, summary->max, summary->mean,
+                summary->variance, summary->median, summary->p10, summary->p90);
+#ifdef HW_COUNTERS
+        benchmark_write_counters(file, csv, info, n);
+#endif
+        fprintf(file, "\n");
+    }
+    else
+    {
+        fprintf(file, "{\"solver\": \"%s\", \"platform\": \"%s\", \"num_ivps\": %d, \"num_threads\": %d, "
+                      "\"block_size\": %d, \"num_steps\": %d, \"stepsize\": %.9e, \"warmup\": %d, \"trials\": %d, "
+                      "\"min\": %.9e, \"max\": %.9e, \"mean\": %.9e, \"variance\": %.9e, "
+                      "\"median\": %.9e, \"p10\": %.9e, \"p90\": %.9e, \"samples\": [",
+                info->solver, info->platform, info->num_ivps, info->num_threads, info->block_size,
+                info->num_steps, info->stepsize, BENCHMARK_WARMUP, n, summary->min, summary->max, summary->mean,
+                summary->variance, summary->median, summary->p10, summary->p90);
+        for (int i = 0; i < n; ++i)
+            fprintf(file, "%s%.9e", i ? ", " : "", samples[i]);
+        fprintf(file, "]");
+#ifdef HW_COUNTERS
+        benchmark_write_counters(file, csv, info, n);
+#endif
+        fprintf(file, "}\n");
+    }
+    fclose(file);
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,300 @@
+/**
+ * \file
+ * \brief Asynchronous checkpoint files of the integration state, and the restart from them
+ *
+ * Used by the CPU and GPU main files.  A checkpoint holds everything needed to resume the global
+ * time loop: a checkpoint_header (with the system time and the number of completed global steps),
+ * followed by the state vectors and parameters in the column-major layout of `y_host` / `var_host`
+ * (i.e. `y[tid + i * NUM]`, also if the drivers use the blocked layout of #STATE_BLOCK), and the per-IVP
+ * controller state of the solver, i.e. the warm start memory (step sizes, error history, Jacobians and
+ * their factorizations, or the RKC spectral radius, @see warm_start.h and warm_start.cuh) as stored on
+ * the host.  Each array is written with a single `fwrite`.
+ *
+ * As for the log (@see log_writer.h), write_checkpoint copies the state into a snapshot and returns,
+ * and a background thread writes the snapshot.  The snapshot is written to a temporary file that
+ * replaces the checkpoint once complete, such that a process killed while writing leaves the
+ * previous checkpoint intact.
+ *
+ * The mechanism header (header.h / header.cuh) must be included before this file.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef STATE_BLOCK
+#include "state_layout.h"
+#endif
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+//! The magic bytes identifying a checkpoint file
+#define CHECKPOINT_MAGIC "ACCINTCP"
+
+/**
+ * \brief The header of a checkpoint file
+ */
+typedef struct
+{
+    //! #CHECKPOINT_MAGIC (without the terminating null)
+    char magic[8];
+    //! the number of IVPs
+    int64_t num;
+    //! the number of state vector entries per IVP, i.e. NSP
+    int64_t nsp;
+    //! the number of completed global integration steps
+    int64_t step;
+    //! the system time
+    double t;
+    //! the size (in bytes) of the per-IVP controller state following the parameters, zero if none
+    int64_t warm_bytes;
+    //! the name of the solver that wrote the checkpoint (the controller state is specific to it)
+    char solver[32];
+} checkpoint_header;
+
+/**
+ * \brief The state of an open checkpoint writer
+ */
+typedef struct
+{
+    //! the checkpoint file name
+    char* filename;
+    //! the temporary file the checkpoint is written to
+    char* tmp_name;
+    //! the snapshot header
+    checkpoint_header header;
+    //! the snapshot of the state vectors
+    double* y;
+    //! the snapshot of the parameters
+    double* var;
+    //! the snapshot of the controller state
+    void* warm;
+    //! true if the snapshot is waiting to be written
+    bool pending;
+    //! set to stop the writer thread, once the pending snapshot is written
+    bool done;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} checkpoint_writer;
+
+/**
+ * \brief Writes the snapshot to the temporary file, and replaces the checkpoint with it
+ */
+static void checkpoint_write_snapshot(checkpoint_writer* writer)
+{
+    const size_t num = (size_t)writer->header.num;
+    const size_t warm_bytes = (size_t)writer->header.warm_bytes;
+    FILE* file = fopen(writer->tmp_name, "wb");
+    if (file == NULL ||
+        fwrite(&writer->header, sizeof(checkpoint_header), 1, file) != 1 ||
+        fwrite(writer->y, sizeof(double), num * NSP, file) != num * NSP ||
+        fwrite(writer->var, sizeof(double), num, file) != num ||
+        (warm_bytes && fwrite(writer->warm, 1, warm_bytes, file) != warm_bytes) ||
+        fflush(file) != 0 || fsync(fileno(file)) != 0)
+    {
+        printf("Error: could not write the checkpoint file %s\n", writer->tmp_name);
+        exit(-1);
+    }
+    fclose(file);
+    if (rename(writer->tmp_name, writer->filename) != 0)
+    {
+        printf("Error: could not replace the checkpoint file %s\n", writer->filename);
+        exit(-1);
+    }
+}
+
+/**
+ * \brief The writer thread, writes each pending snapshot until the writer is closed
+ */
+static void* checkpoint_writer_thread(void* arg)
+{
+    checkpoint_writer* writer = (checkpoint_writer*)arg;
+    pthread_mutex_lock(&writer->lock);
+    while (true)
+    {
+        while (!writer->pending && !writer->done)
+            pthread_cond_wait(&writer->cond, &writer->lock);
+        if (!writer->pending)
+            break;
+        pthread_mutex_unlock(&writer->lock);
+        checkpoint_write_snapshot(writer);
+        pthread_mutex_lock(&writer->lock);
+        writer->pending = false;
+        pthread_cond_broadcast(&writer->cond);
+    }
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+/**
+ * \brief Allocates the snapshot and starts the writer thread
+ * \param[out]      writer      The checkpoint writer to open
+ * \param[in]       filename    The checkpoint file name
+ * \param[in]       NUM         The number of IVPs
+ * \param[in]       warm_bytes  The size (in bytes) of the per-IVP controller state of all IVPs, zero if none
+ */
+static inline void open_checkpoint(checkpoint_writer* writer, const char* filename, const int NUM,
+                                   const size_t warm_bytes)
+{
+    memset(writer, 0, sizeof(checkpoint_writer));
+    writer->filename = (char*)malloc(strlen(filename) + 1);
+    strcpy(writer->filename, filename);
+    writer->tmp_name = (char*)malloc(strlen(filename) + 5);
+    sprintf(writer->tmp_name, "%s.tmp", filename);
+    memcpy(writer->header.magic, CHECKPOINT_MAGIC, sizeof(writer->header.magic));
+    writer->header.num = NUM;
+    writer->header.nsp = NSP;
+    writer->header.warm_bytes = (int64_t)warm_bytes;
+    strncpy(writer->header.solver, solver_name(), sizeof(writer->header.solver) - 1);
+    writer->y = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    writer->var = (double*)malloc((size_t)NUM * sizeof(double));
+    writer->warm = warm_bytes ? malloc(warm_bytes) : NULL;
+    if (writer->y == NULL || writer->var == NULL || (warm_bytes && writer->warm == NULL))
+    {
+        printf("Error: could not allocate the checkpoint snapshot for %d IVPs.\n", NUM);
+        exit(-1);
+    }
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+    if (pthread_create(&writer->thread, NULL, checkpoint_writer_thread, writer) != 0)
+    {
+        printf("Error: could not start the checkpoint writer thread.\n");
+        exit(-1);
+    }
+}
+
+/**
+ * \brief Queues a checkpoint of the integration state
+ * \param[in]       writer      The open checkpoint writer
+ * \param[in]       t           The current system time
+ * \param[in]       step        The number of completed global integration steps
+ * \param[in]       y_host      The current state vectors
+ * \param[in]       var_host    The parameters
+ * \param[in]       warm        The per-IVP controller state (of the size given to open_checkpoint), or NULL if none
+ *
+ * Returns once the state has been copied, blocking only if the previous checkpoint is still being written
+ */
+static inline void write_checkpoint(checkpoint_writer* writer, const double t, const int step,
+                                    const double* y_host, const double* var_host, const void* warm)
+{
+    pthread_mutex_lock(&writer->lock);
+    while (writer->pending)
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    pthread_mutex_unlock(&writer->lock);
+
+    const size_t num = (size_t)writer->header.num;
+    const size_t warm_bytes = (size_t)writer->header.warm_bytes;
+#ifdef STATE_BLOCK
+    // the checkpoint keeps the column-major layout, @see state_layout.h
+    unblock_states((int)num, y_host, writer->y, 1);
+#else
+    memcpy(writer->y, y_host, num * NSP * sizeof(double));
+#endif
+    memcpy(writer->var, var_host, num * sizeof(double));
+    if (warm_bytes)
+    {
+        if (warm != NULL)
+            memcpy(writer->warm, warm, warm_bytes);
+        else
+            memset(writer->warm, 0, warm_bytes);
+    }
+    writer->header.t = t;
+    writer->header.step = step;
+
+    pthread_mutex_lock(&writer->lock);
+    writer->pending = true;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+/**
+ * \brief Writes the pending checkpoint, stops the writer thread and frees the snapshot
+ */
+static inline void close_checkpoint(checkpoint_writer* writer)
+{
+    pthread_mutex_lock(&writer->lock);
+    writer->done = true;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread, NULL);
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->cond);
+    free(writer->filename);
+    free(writer->tmp_name);
+    free(writer->y);
+    free(writer->var);
+    free(writer->warm);
+}
+
+/**
+ * \brief Reads a checkpoint written by write_checkpoint
+ * \param[in]       filename    The checkpoint file name
+ * \param[in]       NUM         The number of IVPs, must match the checkpoint
+ * \param[in]       warm_bytes  The size (in bytes) of the per-IVP controller state of all IVPs of this build, zero if none
+ * \param[out]      t           The system time of the checkpoint
+ * \param[out]      step        The number of completed global integration steps
+ * \param[out]      y_host      The (NUM * NSP) state vectors
+ * \param[out]      var_host    The (NUM) parameters
+ * \param[out]      warm        The per-IVP controller state, or NULL if none
+ * \return                      True if the controller state was read, false if the checkpoint holds none
+ *                              (or that of a different build), in which case the solver starts cold
+ *
+ * The program exits if the checkpoint does not match NUM or the mechanism.
+ */
+static inline bool read_checkpoint(const char* filename, const int NUM, const size_t warm_bytes, double* t,
+                                   int* step, double* y_host, double* var_host, void* warm)
+{
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        printf("Error: could not open the checkpoint file %s\n", filename);
+        exit(-1);
+    }
+    checkpoint_header header;
+    if (fread(&header, sizeof(checkpoint_header), 1, file) != 1 ||
+        memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0)
+    {
+        printf("Error: %s is not a checkpoint file.\n", filename);
+        exit(-1);
+    }
+    if (header.num != NUM || header.nsp != NSP)
+    {
+        printf("Error: the checkpoint %s holds %lld IVPs of %lld entries, expected %d IVPs of %d entries.\n",
+               filename, (long long)header.num, (long long)header.nsp, NUM, NSP);
+        exit(-1);
+    }
+    if (fread(y_host, sizeof(double), (size_t)NUM * NSP, file) != (size_t)NUM * NSP ||
+        fread(var_host, sizeof(double), NUM, file) != (size_t)NUM)
+    {
+        printf("Error: the checkpoint file %s is truncated.\n", filename);
+        exit(-1);
+    }
+    bool has_warm = warm_bytes && header.warm_bytes == (int64_t)warm_bytes &&
+                    strncmp(header.solver, solver_name(), sizeof(header.solver)) == 0;
+    if (has_warm && fread(warm, 1, warm_bytes, file) != warm_bytes)
+    {
+        printf("Error: the checkpoint file %s is truncated.\n", filename);
+        exit(-1);
+    }
+    if (warm_bytes && !has_warm)
+        printf("Warning: the checkpoint %s holds no controller state of this solver, restarting cold.\n", filename);
+    fclose(file);
+    *t = header.t;
+    *step = (int)header.step;
+    return has_warm;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -246,4 +246,18 @@ void getComplexInverseHessenberg (const int n, double complex* __restrict__ A,
 
 	// now get inverse
 	*info = getComplexInverseHessenbergLU(n, A, ipiv);
-}
\ No newline at end of file
+}
+
+/** \brief getComplexLUHessenberg computes the LU factorization of an upper Hessenberg matrix A, without the inversion
+ *
+ *  Exposes getHessenbergLU to the microbenchmarks, the solvers use getComplexInverseHessenberg
+ *
+ *  \param[in]          n           The order of the matrix A.  n >= 0.
+ *  \param[in,out]      A           The array, dimension (STRIDE, n) @see STRIDE
+ *  \param[out]         ipiv        The pivot indices, @see getHessenbergLU
+ *  \return             If not zero, an error occured during factorization
+ */
+int getComplexLUHessenberg (const int n, double complex* __restrict__ A, int* __restrict__ ipiv)
+{
+	return getHessenbergLU (n, A, ipiv);
+}
@@ -11,6 +11,7 @@
 __device__ void getComplexLU (const int, cuDoubleComplex* __restrict__, int* __restrict__, int* __restrict__);
 __device__ void getComplexInverse (const int, cuDoubleComplex* __restrict__, const int* __restrict__,
 										int* __restrict__, cuDoubleComplex* __restrict__);
+__device__ void getHessenbergLU (const int, cuDoubleComplex*, int* __restrict__, int* __restrict__);
 __device__ void getComplexInverseHessenberg (const int, cuDoubleComplex* __restrict__, int* __restrict__,
 												int* __restrict__, cuDoubleComplex* __restrict__);
 
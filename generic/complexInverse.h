@@ -8,5 +8,6 @@
 
 void getComplexInverseHessenberg (const int, double complex* __restrict__, int * __restrict__,
 									int * __restrict__);
+int getComplexLUHessenberg (const int, double complex* __restrict__, int * __restrict__);
 
 #endif
\ No newline at end of file
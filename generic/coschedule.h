@@ -0,0 +1,55 @@
+/**
+ * \file
+ * \brief The CPU half of the co-scheduled (CPU + GPU) drivers
+ *
+ * If #COSCHEDULE is defined, the [solver]-cosched executables link the OpenMP CPU integrator and the GPU
+ * integrator of the same method.  The two are compiled separately (as C, and CUDA C++), hence the CPU
+ * integrator is exposed to the GPU driver (@see coschedule_main.cu) through the C functions declared here,
+ * which do not depend on any of the CPU solver headers.
+ */
+
+#ifndef COSCHEDULE_H
+#define COSCHEDULE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief Creates the CPU solver instance of the co-scheduled driver
+ * \param[in]       num_threads     The number of OpenMP threads to use
+ * \return                          The (opaque) instance, free with coschedule_cpu_destroy
+ */
+void* coschedule_cpu_create(const int num_threads);
+
+/**
+ * \brief Integrates NUM IVPs from `t` to `t_end` on the CPU
+ * \param[in,out]   cpu             The instance returned by coschedule_cpu_create
+ * \param[in]       NUM             The number of IVPs, the leading dimension of `y` and `var`
+ * \param[in]       t               The starting time
+ * \param[in]       t_end           The end time
+ * \param[in]       var             The (NUM) pressures/densities
+ * \param[in,out]   y               The (NUM * NSP) state vectors, stored as `y[i + j * NUM]`
+ */
+void coschedule_cpu_integrate(void* cpu, const int NUM, const double t, const double t_end,
+                              const double* var, double* y);
+
+/**
+ * \brief Frees the CPU solver instance of the co-scheduled driver
+ * \param[in,out]   cpu             The instance returned by coschedule_cpu_create
+ */
+void coschedule_cpu_destroy(void* cpu);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * \file
+ * \brief The CPU half of the co-scheduled (CPU + GPU) drivers, @see coschedule.h
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "header.h"
+#include "solver_context.h"
+#include "coschedule.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef COSCHEDULE
+
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+    #error "The co-scheduled drivers reassign the IVPs every step, and are incompatible with the WARM_START option"
+#endif
+
+void* coschedule_cpu_create(const int num_threads)
+{
+    accelerInt_context* context = (accelerInt_context*)malloc(sizeof(accelerInt_context));
+    if (context == NULL)
+    {
+        printf("Error: could not allocate the CPU solver instance.\n");
+        exit(-1);
+    }
+    initialize_context(context, num_threads);
+    return context;
+}
+
+void coschedule_cpu_integrate(void* cpu, const int NUM, const double t, const double t_end,
+                              const double* var, double* y)
+{
+    intDriver((accelerInt_context*)cpu, NUM, t, t_end, var, y);
+}
+
+void coschedule_cpu_destroy(void* cpu)
+{
+    cleanup_context((accelerInt_context*)cpu);
+    free(cpu);
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,423 @@
+/**
+ * \file
+ * \brief the main file of the co-scheduled (CPU + GPU) solvers
+ *
+ * Contains main function, setup, timing and the co-scheduling of the [solver]-cosched executables
+ * (built with the COSCHEDULE option), which integrate each outer step of one batch of IVPs with
+ * both the GPU integrator and the OpenMP CPU integrator of the same method.
+ *
+ * A feeder thread claims chunks of IVPs from the head of the batch for the GPU, while the CPU
+ * pulls blocks of #COSCHEDULE_BLOCK IVPs per OpenMP thread from the tail, until the two meet.
+ * Each GPU chunk is the share of the (still unclaimed) IVPs predicted by the GPU and CPU throughputs
+ * measured on the previous step, such that both are expected to finish at the same time, and
+ * a misprediction is absorbed by the smaller chunks that follow.
+ * @see coschedule.h
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* Include CUDA libraries. */
+#include <cuda_runtime.h>
+
+//our code
+#include "header.cuh"
+#include "benchmark.h"
+#include "log_writer.h"
+#include "solver_interface.cuh"
+#include "read_initial_conditions.cuh"
+#include "coschedule.h"
+
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef SOLVER_WARM_START
+    #error "The co-scheduled drivers reassign the IVPs every step, and are incompatible with the WARM_START option"
+#endif
+
+#ifndef COSCHEDULE_BLOCK
+//! The number of IVPs per OpenMP thread pulled from the tail of the batch by the CPU at once
+#define COSCHEDULE_BLOCK (2)
+#endif
+
+#ifndef COSCHEDULE_MIN_CHUNK
+//! The smallest chunk of IVPs claimed by the GPU (unless fewer remain)
+#define COSCHEDULE_MIN_CHUNK (TARGET_BLOCK_SIZE)
+#endif
+
+#ifndef COSCHEDULE_GPU_FRACTION
+//! The share of the IVPs claimed by the GPU on the first step, before any throughput is measured
+#define COSCHEDULE_GPU_FRACTION (0.5)
+#endif
+
+/**
+ * \brief One outer step of the batch, shared by the GPU feeder thread and the CPU
+ *
+ * The IVPs `[head, tail)` are unclaimed, the GPU claims from the head and the CPU from the tail.
+ * As the claimed ranges never overlap, both write their results directly into `y`.
+ */
+struct coschedule_step
+{
+    //! Guards #head and #tail
+    pthread_mutex_t lock;
+    //! The first unclaimed IVP
+    int head;
+    //! One past the last unclaimed IVP
+    int tail;
+    //! The number of IVPs, the leading dimension of #y and #var
+    int NUM;
+    //! The starting time
+    double t;
+    //! The end time
+    double t_end;
+    //! The state vectors of the batch
+    double* y;
+    //! The pressures/densities of the batch
+    const double* var;
+    //! The predicted share of the unclaimed IVPs the GPU integrates in the time the CPU integrates the rest
+    double gpu_fraction;
+    //! The GPU solver instance
+    accelerInt_context* gpu;
+    //! The (NUM * NN) and (NUM) staging arrays of the GPU chunks
+    double* y_gpu, *var_gpu;
+    //! The number of IVPs integrated on the GPU
+    int gpu_ivps;
+    //! The time the GPU feeder was busy
+    double gpu_time;
+};
+
+/**
+ * \brief Claims up to `n` IVPs from the head (GPU) or tail (CPU) of the unclaimed IVPs
+ * \param[in,out]   step        The outer step
+ * \param[in]       n           The number of IVPs to claim.  If < 0, the GPU share (coschedule_step::gpu_fraction)
+ *                              of the unclaimed IVPs is claimed from the head.
+ * \param[out]      offset      The first claimed IVP
+ * \return                      The number of claimed IVPs, zero once all are claimed
+ */
+static int claim_ivps(coschedule_step* step, const int n, int* offset)
+{
+    pthread_mutex_lock(&step->lock);
+    int remaining = step->tail - step->head;
+    int count = n;
+    if (n < 0)
+    {
+        count = (int)ceil(step->gpu_fraction * remaining);
+        count = count < COSCHEDULE_MIN_CHUNK ? COSCHEDULE_MIN_CHUNK : count;
+    }
+    count = count > remaining ? remaining : count;
+    if (n < 0)
+    {
+        *offset = step->head;
+        step->head += count;
+    }
+    else
+    {
+        step->tail -= count;
+        *offset = step->tail;
+    }
+    pthread_mutex_unlock(&step->lock);
+    return count;
+}
+
+/**
+ * \brief Copies the IVPs `[offset, offset + n)` of the batch into the packed (leading dimension `n`) staging arrays
+ */
+static void gather_ivps(const coschedule_step* step, const int offset, const int n, double* y_chunk, double* var_chunk)
+{
+    for (int j = 0; j < NN; ++j)
+        memcpy(&y_chunk[j * n], &step->y[offset + j * step->NUM], n * sizeof(double));
+    memcpy(var_chunk, &step->var[offset], n * sizeof(double));
+}
+
+/**
+ * \brief Copies the packed staging array of the IVPs `[offset, offset + n)` back into the batch
+ */
+static void scatter_ivps(coschedule_step* step, const int offset, const int n, const double* y_chunk)
+{
+    for (int j = 0; j < NN; ++j)
+        memcpy(&step->y[offset + j * step->NUM], &y_chunk[j * n], n * sizeof(double));
+}
+
+/**
+ * \brief The GPU feeder thread, integrates chunks claimed from the head of the batch until none remain
+ * \param[in,out]   arg         The coschedule_step
+ */
+static void* gpu_feeder(void* arg)
+{
+    coschedule_step* step = (coschedule_step*)arg;
+    double start = benchmark_time();
+    int offset = 0;
+    int n = 0;
+    while ((n = claim_ivps(step, -1, &offset)) > 0)
+    {
+        gather_ivps(step, offset, n, step->y_gpu, step->var_gpu);
+        accelerInt_context_integrate(step->gpu, n, step->t, step->t_end, -1, step->y_gpu, step->var_gpu);
+        scatter_ivps(step, offset, n, step->y_gpu);
+        step->gpu_ivps += n;
+    }
+    step->gpu_time = benchmark_time() - start;
+    return NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+/** Main function
+ *
+ * \param[in]       argc    command line argument count
+ * \param[in]       argv    command line argument vector
+ *
+ * This allows running the co-scheduled integrators from the command line.  The syntax is as follows:\n
+ * `./solver-name-cosched [num_threads] [num_IVPs] [device]`\n
+ * *  num_threads  [Optional, Default: one less than `omp_get_max_threads()`]
+ *      *  The number OpenMP threads of the CPU integrator, in addition to the GPU feeder thread
+ * *  num_IVPs     [Optional, Default:1]
+ *      *  The number of initial value problems to solve.
+ *      *  This must be less than the number of conditions in the data file if #SAME_IC is not defined.
+ *      *  If #SAME_IC is defined, then the initial conditions in the mechanism files will be used.
+ * *  device       [Optional, Default:0]
+ *      *  The CUDA device number to use
+ *
+ * The integration is repeated for #BENCHMARK_WARMUP untimed and #BENCHMARK_TRIALS timed trials
+ * from the same initial conditions, the reported time is the median of the timed trials.
+ * The measured throughputs carry over between the trials.  Logging (if enabled) is performed
+ * for the last trial only.  @see benchmark.h
+ */
+int main (int argc, char *argv[])
+{
+    int NUM = 1;
+#ifdef _OPENMP
+    int max_threads = omp_get_max_threads();
+#else
+    int max_threads = 1;
+#endif
+    int num_threads = max_threads > 1 ? max_threads - 1 : 1;
+    if (argc > 1)
+    {
+        if (sscanf(argv[1], "%i", &num_threads) != 1 || (num_threads <= 0) || (num_threads > max_threads))
+        {
+            printf("Error: Number of threads not in correct range\n");
+            printf("Provide number between 1 and %i\n", max_threads);
+            exit(1);
+        }
+    }
+    if (argc > 2)
+    {
+        if (sscanf(argv[2], "%i", &NUM) != 1 || (NUM <= 0))
+        {
+            printf("Error: Problem size not in correct range\n");
+            printf("Provide number greater than 0\n");
+            exit(1);
+        }
+    }
+    int device = 0;
+    if (argc > 3)
+    {
+        int visible_devices;
+        cudaGetDeviceCount(&visible_devices);
+        if (sscanf(argv[3], "%i", &device) != 1 || (device < 0) || (device >= visible_devices))
+        {
+            printf("Error: GPU device number not in correct range\n");
+            printf("Provide number between 0 and %i\n", visible_devices - 1);
+            exit(1);
+        }
+    }
+
+    printf ("# ODEs: %d\n", NUM);
+    printf ("# threads: %d (CPU) \t block size: %d (GPU)\n", num_threads, TARGET_BLOCK_SIZE);
+
+    accelerInt_context* gpu = accelerInt_create(NUM, device);
+    void* cpu = coschedule_cpu_create(num_threads);
+
+#ifdef SHUFFLE
+    const char* filename = "shuffled_data.bin";
+#elif !defined(SAME_IC)
+    const char* filename = "ign_data.bin";
+#endif
+
+    double* y_host;
+    double* var_host;
+#ifdef SAME_IC
+    set_same_initial_conditions(NUM, &y_host, &var_host);
+#else
+    read_initial_conditions(filename, NUM, &y_host, &var_host);
+#endif
+
+    // the initial conditions of each trial
+    double* y_init = (double*)malloc(NUM * NN * sizeof(double));
+    memcpy(y_init, y_host, NUM * NN * sizeof(double));
+
+    // the staging arrays of the GPU chunks and CPU blocks
+    const int block = COSCHEDULE_BLOCK * num_threads;
+    double* y_gpu = (double*)malloc(NUM * NN * sizeof(double));
+    double* var_gpu = (double*)malloc(NUM * sizeof(double));
+    double* y_cpu = (double*)malloc(block * NN * sizeof(double));
+    double* var_cpu = (double*)malloc(block * sizeof(double));
+
+#ifdef LOG_OUTPUT
+    // file for data
+    log_writer state_log;
+    const char* f_name = solver_name();
+    int len = strlen(f_name);
+    char out_name[len + 21];
+    struct stat info;
+    if (stat("./log/", &info) != 0)
+    {
+        printf("Expecting 'log' subdirectory in current working directory. Please run"
+               " mkdir log (or the equivalent) and run again.\n");
+        exit(-1);
+    }
+    sprintf(out_name, "log/%s-cosched-log.bin", f_name);
+    open_log(&state_log, out_name, NUM);
+
+    write_log(&state_log, 0, y_host);
+#endif
+
+    // the IVPs per second measured on the last step (zero until measured)
+    double gpu_rate = 0;
+    double cpu_rate = 0;
+    double gpu_share = 0;
+    coschedule_step step;
+    pthread_mutex_init(&step.lock, NULL);
+    step.NUM = NUM;
+    step.y = y_host;
+    step.var = var_host;
+    step.gpu = gpu;
+    step.y_gpu = y_gpu;
+    step.var_gpu = var_gpu;
+
+    double samples[BENCHMARK_TRIALS];
+    int numSteps = 0;
+    for (int trial = -BENCHMARK_WARMUP; trial < BENCHMARK_TRIALS; ++trial)
+    {
+#ifdef LOG_OUTPUT
+        // only the last trial is logged
+        bool last_trial = trial == BENCHMARK_TRIALS - 1;
+#endif
+        memcpy(y_host, y_init, NUM * NN * sizeof(double));
+
+        //////////////////////////////
+        // start timer
+        double trial_start = benchmark_time();
+        //////////////////////////////
+
+        // set initial time
+        double t = 0;
+        double t_next = fmin(end_time, t_step);
+        numSteps = 0;
+
+        // time integration loop
+        while (t + EPS < end_time)
+        {
+            numSteps++;
+
+            step.head = 0;
+            step.tail = NUM;
+            step.t = t;
+            step.t_end = t_next;
+            step.gpu_fraction = gpu_rate > 0 && cpu_rate > 0 ? gpu_rate / (gpu_rate + cpu_rate) :
+                                                               COSCHEDULE_GPU_FRACTION;
+            step.gpu_ivps = 0;
+            step.gpu_time = 0;
+            pthread_t feeder;
+            if (pthread_create(&feeder, NULL, gpu_feeder, &step) != 0)
+            {
+                printf("Error: could not create the GPU feeder thread\n");
+                exit(-1);
+            }
+
+            // the CPU pulls from the tail
+            double cpu_start = benchmark_time();
+            int cpu_ivps = 0;
+            int offset = 0;
+            int n = 0;
+            while ((n = claim_ivps(&step, block, &offset)) > 0)
+            {
+                gather_ivps(&step, offset, n, y_cpu, var_cpu);
+                coschedule_cpu_integrate(cpu, n, t, t_next, var_cpu, y_cpu);
+                scatter_ivps(&step, offset, n, y_cpu);
+                cpu_ivps += n;
+            }
+            double cpu_time = benchmark_time() - cpu_start;
+            pthread_join(feeder, NULL);
+
+            // the throughputs of this step predict the split of the next
+            if (step.gpu_ivps > 0 && step.gpu_time > 0)
+                gpu_rate = step.gpu_ivps / step.gpu_time;
+            if (cpu_ivps > 0 && cpu_time > 0)
+                cpu_rate = cpu_ivps / cpu_time;
+            gpu_share = (double)step.gpu_ivps / (double)NUM;
+
+            t = t_next;
+            t_next = fmin(end_time, (numSteps + 1) * t_step);
+
+        #if defined(PRINT)
+                printf("%.15le\t%.15le\n", t, y_host[0]);
+        #endif
+        #ifdef LOG_OUTPUT
+                #if !defined(LOG_END_ONLY)
+                if (last_trial && (numSteps % LOG_STEP_STRIDE == 0 || !(t + EPS < end_time)))
+                    write_log(&state_log, t, y_host);
+                #endif
+        #endif
+        }
+
+#ifdef LOG_END_ONLY
+        if (last_trial)
+            write_log(&state_log, t, y_host);
+#endif
+
+        /////////////////////////////////
+        // end timer
+        if (trial >= 0)
+            samples[trial] = benchmark_time() - trial_start;
+        /////////////////////////////////
+    } // end trials
+
+    benchmark_summary summary;
+    benchmark_summarize(BENCHMARK_TRIALS, samples, &summary);
+    double runtime = summary.median;
+    printf ("Time: %.15e sec\n", runtime);
+#if BENCHMARK_TRIALS > 1
+    printf ("Trials: %d\tmin: %.6e\tp10: %.6e\tp90: %.6e\tmax: %.6e\tstd. dev.: %.6e (s)\n",
+            BENCHMARK_TRIALS, summary.min, summary.p10, summary.p90, summary.max, sqrt(summary.variance));
+#endif
+#ifdef BENCHMARK_OUTPUT
+    benchmark_info bench = {solver_name(), "cosched", NUM, num_threads, TARGET_BLOCK_SIZE, numSteps, t_step};
+    benchmark_write(BENCHMARK_OUTPUT, &bench, BENCHMARK_TRIALS, samples, &summary);
+#endif
+    runtime = runtime / ((double)(numSteps));
+    printf ("Time per step: %e (s)\t%.15e (s/thread)\n", runtime, runtime / NUM);
+    printf ("GPU share (last step): %.4f\tthroughput: %e (GPU)\t%e (CPU) (IVPs/s)\n", gpu_share, gpu_rate, cpu_rate);
+    printf("TFinal: %e\n", y_host[0]);
+
+#ifdef LOG_OUTPUT
+    close_log(&state_log);
+#endif
+
+    pthread_mutex_destroy(&step.lock);
+    coschedule_cpu_destroy(cpu);
+    accelerInt_destroy(gpu);
+    free_initial_conditions(y_host, var_host);
+    free(y_init);
+    free(y_gpu);
+    free(var_gpu);
+    free(y_cpu);
+    free(var_cpu);
+
+    return 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
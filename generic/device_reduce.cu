@@ -0,0 +1,151 @@
+/**
+ * \file
+ * \brief Device-side reduction of the result codes and the ignition detection of the GPU drivers,
+ *        @see device_reduce.cuh
+ */
+
+#include <math.h>
+#include <string.h>
+#include "device_reduce.cuh"
+#include "solver.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The threads per block of reduce_chunk
+#define REDUCE_THREADS (256)
+
+__global__
+void reduce_chunk(const int num, const int* __restrict__ result, const double* __restrict__ y,
+                  const double t, const double* __restrict__ T0, double* __restrict__ time,
+                  chunk_summary* __restrict__ summary)
+{
+    const int tid = blockIdx.x * blockDim.x + threadIdx.x;
+    int ignited = 0;
+    // temperatures are positive, hence are ordered as their bits
+    unsigned long long T_bits = 0;
+    if (tid < num)
+    {
+        if (result[tid] != 0)
+            atomicMax(&summary->failure, num - tid);
+        const double T = y[tid];
+        T_bits = __double_as_longlong(fmax(T, 0.0));
+        if (T0 != NULL)
+        {
+            if (isnan(time[tid]) && T >= T0[tid] + IGN_RISE)
+                time[tid] = t;
+            ignited = !isnan(time[tid]);
+        }
+    }
+    // a warp reduction, then a single atomic per warp
+    for (int offset = warpSize / 2; offset > 0; offset /= 2)
+    {
+        ignited += __shfl_down_sync(0xffffffff, ignited, offset);
+        unsigned long long other = __shfl_down_sync(0xffffffff, T_bits, offset);
+        T_bits = other > T_bits ? other : T_bits;
+    }
+    if ((threadIdx.x & (warpSize - 1)) == 0)
+    {
+        if (ignited > 0)
+            atomicAdd(&summary->num_ignited, ignited);
+        atomicMax(&summary->max_T, T_bits);
+    }
+}
+
+void create_chunk_reduction(chunk_reduction* reduction)
+{
+    cudaErrorCheck( cudaMalloc((void**)&reduction->device, sizeof(chunk_summary)) );
+    cudaErrorCheck( cudaMallocHost((void**)&reduction->host, sizeof(chunk_summary)) );
+    memset(reduction->host, 0, sizeof(chunk_summary));
+}
+
+void free_chunk_reduction(chunk_reduction* reduction)
+{
+    if (reduction->device != NULL)
+        cudaErrorCheck( cudaFree(reduction->device) );
+    if (reduction->host != NULL)
+        cudaErrorCheck( cudaFreeHost(reduction->host) );
+    reduction->device = NULL;
+    reduction->host = NULL;
+}
+
+void enqueue_chunk_reduction(const chunk_reduction* reduction, const int num, const int* result, const double* y,
+                             const int offset, const double t, const ignition_state* ignition,
+                             cudaStream_t stream)
+{
+    const bool detect = ignition != NULL && ignition->num > 0;
+    cudaErrorCheck( cudaMemsetAsync(reduction->device, 0, sizeof(chunk_summary), stream) );
+    reduce_chunk <<< (num + REDUCE_THREADS - 1) / REDUCE_THREADS, REDUCE_THREADS, 0, stream >>> (
+        num, result, y, t, detect ? &ignition->T0[offset] : NULL,
+        detect ? &ignition->time[offset] : NULL, reduction->device);
+    cudaErrorCheck( cudaMemcpyAsync(reduction->host, reduction->device, sizeof(chunk_summary),
+                                    cudaMemcpyDeviceToHost, stream) );
+}
+
+void finish_chunk_reduction(const chunk_reduction* reduction, const int num, const int* result, int* result_flag,
+                            ignition_state* ignition)
+{
+    const chunk_summary* summary = reduction->host;
+    if (summary->failure > 0)
+    {
+        // the failing chunk is reported in full
+        cudaErrorCheck( cudaMemcpy(result_flag, result, num * sizeof(int), cudaMemcpyDeviceToHost) );
+        check_error(num, result_flag);
+    }
+    if (ignition == NULL)
+        return;
+    unsigned long long T_bits = summary->max_T;
+    double max_T;
+    memcpy(&max_T, &T_bits, sizeof(double));
+    // the devices of multiple shards are driven from separate host threads
+    #pragma omp critical(device_reduce)
+    {
+        ignition->num_ignited += summary->num_ignited;
+        ignition->max_T = fmax(ignition->max_T, max_T);
+    }
+}
+
+void reset_ignition(ignition_state* ignition, const int num, const double* T_host, cudaStream_t stream)
+{
+    if (ignition->num != num)
+    {
+        free_ignition(ignition);
+        cudaErrorCheck( cudaMalloc((void**)&ignition->T0, num * sizeof(double)) );
+        cudaErrorCheck( cudaMalloc((void**)&ignition->time, num * sizeof(double)) );
+        ignition->num = num;
+    }
+    cudaErrorCheck( cudaMemcpyAsync(ignition->T0, T_host, num * sizeof(double), cudaMemcpyHostToDevice, stream) );
+    // all bits set is a NaN, i.e. not yet ignited
+    cudaErrorCheck( cudaMemsetAsync(ignition->time, 0xFF, num * sizeof(double), stream) );
+    cudaErrorCheck( cudaStreamSynchronize(stream) );
+    ignition->num_ignited = 0;
+    ignition->max_T = 0;
+}
+
+void get_ignition_times(const ignition_state* ignition, double* times)
+{
+    if (ignition->num == 0)
+        return;
+    cudaErrorCheck( cudaMemcpy(times, ignition->time, ignition->num * sizeof(double), cudaMemcpyDeviceToHost) );
+    for (int i = 0; i < ignition->num; ++i)
+    {
+        if (isnan(times[i]))
+            times[i] = -1;
+    }
+}
+
+void free_ignition(ignition_state* ignition)
+{
+    if (ignition->T0 != NULL)
+        cudaErrorCheck( cudaFree(ignition->T0) );
+    if (ignition->time != NULL)
+        cudaErrorCheck( cudaFree(ignition->time) );
+    ignition->T0 = NULL;
+    ignition->time = NULL;
+    ignition->num = 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,157 @@
+/**
+ * \file
+ * \brief Device-side reduction of the result codes and the ignition detection of the GPU drivers
+ *
+ * If #DEVICE_REDUCE is defined, the drivers do not copy the (per-IVP) result codes of each chunk back to
+ * the host.  Instead, a reduction kernel behind each chunk condenses them (and the temperatures of the
+ * chunk) into a chunk_summary of a few words, which is copied back in place of the result codes.
+ * The full result codes are only copied (and reported by check_error) if an IVP of the chunk failed.
+ *
+ * If #IGN is also defined, the reduction records the per-IVP ignition times on the device: an IVP has
+ * ignited once its temperature (the first state vector entry) rose by #IGN_RISE over its initial
+ * temperature, and its ignition time is the end time of the first such step.  Only the number of ignited
+ * IVPs and the maximum temperature are returned per chunk, the ignition times are downloaded on request.
+ */
+
+#ifndef DEVICE_REDUCE_CUH
+#define DEVICE_REDUCE_CUH
+
+#include <cuda_runtime.h>
+#include "solver_options.cuh"
+#include "gpu_macros.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The temperature rise (over the initial temperature) that marks ignition, as for the host detection
+#define IGN_RISE (400.0)
+
+/**
+ * \brief The reduced results of a chunk of IVPs
+ *
+ * Zeroed before each reduction, such that all fields are reduced with atomic maxima / sums.
+ */
+struct chunk_summary {
+    //! the chunk size minus the index of the first failing IVP of the chunk, zero if none failed
+    int failure;
+    //! the number of ignited IVPs of the chunk
+    int num_ignited;
+    //! the maximum temperature of the chunk, as its bits (non-negative doubles are ordered as their bits)
+    unsigned long long max_T;
+};
+
+/**
+ * \brief The device summary and its pinned host copy, one per stream (or shard)
+ */
+struct chunk_reduction {
+    chunk_summary* device;
+    chunk_summary* host;
+};
+
+/**
+ * \brief The per-IVP ignition state on the device, and its host totals
+ * \param           num             The number of IVPs covered, zero until reset_ignition is called
+ * \param           T0              The (device) initial temperatures
+ * \param           time            The (device) ignition times, NaN until ignited
+ * \param           num_ignited     The number of ignited IVPs after the last step
+ * \param           max_T           The maximum temperature since the last reset_ignition
+ *
+ * Zero-initialize before first use.
+ */
+struct ignition_state {
+    int num;
+    double* T0;
+    double* time;
+    int num_ignited;
+    double max_T;
+};
+
+/**
+ * \brief Reduces the result codes and temperatures of a chunk into `summary`, and updates the ignition times
+ * \param[in]       num             The number of IVPs in the chunk
+ * \param[in]       result          The result codes of the chunk, solver_memory::result
+ * \param[in]       y               The state vectors of the chunk, of which the first row (the temperatures) is read
+ * \param[in]       t               The end time of the step
+ * \param[in]       T0              The initial temperatures of the chunk (offset to its first IVP), or NULL
+ * \param[in,out]   time            The ignition times of the chunk (offset to its first IVP), or NULL
+ * \param[out]      summary         The (zeroed) summary
+ */
+__global__
+void reduce_chunk(const int num, const int* __restrict__ result, const double* __restrict__ y,
+                  const double t, const double* __restrict__ T0, double* __restrict__ time,
+                  chunk_summary* __restrict__ summary);
+
+/**
+ * \brief Allocates the device summary and its pinned host copy on the current device
+ */
+void create_chunk_reduction(chunk_reduction* reduction);
+
+/**
+ * \brief Frees the summaries of create_chunk_reduction
+ */
+void free_chunk_reduction(chunk_reduction* reduction);
+
+/**
+ * \brief Issues the reduction of a chunk behind its integration on `stream`, and the download of the summary
+ * \param[in]       reduction       The summaries of the stream
+ * \param[in]       num             The number of IVPs in the chunk
+ * \param[in]       result          The (device) result codes of the chunk
+ * \param[in]       y               The (device) state vectors of the chunk
+ * \param[in]       offset          The index of the first IVP of the chunk in `ignition`
+ * \param[in]       t               The end time of the step
+ * \param[in]       ignition        The ignition state, or NULL.  The ignition times are not updated unless
+ *                                  reset_ignition was called
+ * \param[in]       stream          The stream of the chunk
+ */
+void enqueue_chunk_reduction(const chunk_reduction* reduction, const int num, const int* result, const double* y,
+                             const int offset, const double t, const ignition_state* ignition,
+                             cudaStream_t stream);
+
+/**
+ * \brief Checks the summary of a completed chunk, and adds it to the ignition totals
+ * \param[in]       reduction       The summaries of the stream, whose chunk is complete
+ * \param[in]       num             The number of IVPs in the chunk
+ * \param[in]       result          The (device) result codes of the chunk
+ * \param[out]      result_flag     Host storage for the result codes of the chunk
+ * \param[in,out]   ignition        The ignition totals
+ *
+ * If an IVP of the chunk failed, the result codes are downloaded and passed to check_error.
+ */
+void finish_chunk_reduction(const chunk_reduction* reduction, const int num, const int* result, int* result_flag,
+                            ignition_state* ignition);
+
+/**
+ * \brief Starts the ignition detection of `num` IVPs on the current device, at their current temperatures
+ * \param[in,out]   ignition        The ignition state, (re-)allocated if `num` changed
+ * \param[in]       num             The number of IVPs
+ * \param[in]       T_host          The (num) initial temperatures, i.e. the first row of the host state vectors
+ * \param[in]       stream          The stream the initialization is issued on
+ */
+void reset_ignition(ignition_state* ignition, const int num, const double* T_host, cudaStream_t stream);
+
+/**
+ * \brief Zeros the ignited IVP count of `ignition`, called before each integration step
+ */
+inline void begin_ignition_step(ignition_state* ignition)
+{
+    ignition->num_ignited = 0;
+}
+
+/**
+ * \brief Downloads the ignition times of the IVPs of `ignition`
+ * \param[in]       ignition        The ignition state
+ * \param[out]      times           The (ignition_state::num) ignition times, negative if not ignited
+ */
+void get_ignition_times(const ignition_state* ignition, double* times);
+
+/**
+ * \brief Frees the device storage of `ignition`
+ */
+void free_ignition(ignition_state* ignition);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,21 @@
+/**
+ * \file
+ * \brief The per-IVP event requests of the CPU solvers, @see events.h
+ */
+
+#include <stdlib.h>
+#include "events.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef EVENT_DRIVER
+
+event_request* current_event = 0;
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
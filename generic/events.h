@@ -0,0 +1,61 @@
+/**
+ * \file
+ * \brief Header definitions for the event detection and dense output of the CPU solvers
+ *
+ * If #IGN_EVENT is defined, solvers that define SOLVER_EVENTS locate the ignition event of
+ * each IVP on their internal steps, from the continuous extension of each accepted step, and
+ * evaluate the state at requested output times.  A single call to intDriver from the initial
+ * to the end time then replaces the outer integration steps otherwise needed to resolve the
+ * ignition delay.  The event requests are set per solver instance (accelerInt_context::events),
+ * and the driver sets the (OpenMP thread-private) #current_event before each call to integrate().
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "solver_options.h"
+#include "solver_props.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#if defined(IGN_EVENT) && defined(SOLVER_EVENTS)
+//! Integrate in a single call, with the ignition event and dense output located by the solver
+#define EVENT_DRIVER
+
+#ifndef EVENT_INDEX
+//! The state vector entry of the event function, i.e. the temperature
+#define EVENT_INDEX (0)
+#endif
+
+/**
+ * \brief The event and dense output request of an IVP
+ *
+ * The event is the first upward crossing of `y[EVENT_INDEX]` through #threshold.
+ */
+typedef struct
+{
+    //! The event threshold
+    double threshold;
+    //! The event time, set by the solver if the event was found (should be initialized negative)
+    double t_event;
+    //! The number of dense output times
+    int num_out;
+    //! The dense output times, in ascending order
+    const double* t_out;
+    //! The dense output states, stored as `y_out[i + NSP * k]` for output time `k`
+    double* y_out;
+} event_request;
+
+//! The event request of the IVP currently integrated by this thread, or NULL if none
+extern event_request* current_event;
+#pragma omp threadprivate(current_event)
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
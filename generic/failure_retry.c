@@ -0,0 +1,115 @@
+/**
+ * \file
+ * \brief Per-IVP failure bookkeeping of the CPU integration drivers, @see failure_retry.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "header.h"
+#include "failure_retry.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef FAILURE_RETRY
+
+/**
+ * \brief Zeros the failure codes and counts for NUM IVPs, (re)allocating the storage if NUM differs from the previous call
+ * \param[in,out]   storage     The failure bookkeeping
+ * \param[in]       NUM         The number of IVPs
+ */
+void reset_failures(failure_storage* storage, const int NUM)
+{
+    if (NUM != storage->num)
+    {
+        free(storage->code);
+        free(storage->queue);
+        storage->code = (int*)malloc(NUM * sizeof(int));
+        storage->queue = (int*)malloc(NUM * sizeof(int));
+        if (storage->code == NULL || storage->queue == NULL)
+        {
+            printf("Error: could not allocate the failure storage for %d IVPs.\n", NUM);
+            exit(-1);
+        }
+        storage->num = NUM;
+    }
+    memset(storage->code, 0, NUM * sizeof(int));
+    memset(storage->counts, 0, NUM_FAILURE_COUNTS * sizeof(int));
+    storage->num_queued = 0;
+}
+
+/**
+ * \brief Appends IVP `tid` to the retry queue, may be called concurrently by the OpenMP threads
+ * \param[in,out]   storage     The failure bookkeeping
+ * \param[in]       tid         The IVP index
+ *
+ * Each IVP fails at most once per integration step, hence the queue never holds more than #failure_storage::num IVPs.
+ */
+void queue_failure(failure_storage* storage, const int tid)
+{
+    int slot;
+    #pragma omp atomic capture
+    slot = storage->num_queued++;
+    storage->queue[slot] = tid;
+    #pragma omp atomic
+    storage->counts[FAILURE_RETRIED]++;
+}
+
+/**
+ * \brief Records the result of the re-integration of IVP `tid`, may be called concurrently by the OpenMP threads
+ * \param[in,out]   storage     The failure bookkeeping
+ * \param[in]       tid         The IVP index
+ * \param[in]       code        The return code of the re-integration, zero on success
+ */
+void record_retry(failure_storage* storage, const int tid, const int code)
+{
+    if (code == 0)
+        return;
+    printf("During the re-integration of ODE# %d, an error occured (code %d), "
+           "its state is left at the start of the integration step\n", tid, code);
+    storage->code[tid] = code;
+    #pragma omp atomic
+    storage->counts[FAILURE_UNRECOVERED]++;
+}
+
+/**
+ * \brief Returns the failure codes and counts since the last call to reset_failures
+ * \param[in]       storage     The failure bookkeeping
+ * \param[in]       NUM         The number of IVPs, must match the last call to reset_failures
+ * \param[out]      codes       The (NUM) error code of the last unrecovered failure of each IVP (zero if none), or NULL
+ * \param[out]      counts      The (#NUM_FAILURE_COUNTS) failure counts, or NULL
+ */
+void get_failures(const failure_storage* storage, const int NUM, int* codes, int* counts)
+{
+    if (codes != NULL)
+    {
+        if (NUM == storage->num)
+            memcpy(codes, storage->code, NUM * sizeof(int));
+        else
+            memset(codes, 0, NUM * sizeof(int));
+    }
+    if (counts != NULL)
+        memcpy(counts, storage->counts, NUM_FAILURE_COUNTS * sizeof(int));
+}
+
+/**
+ * \brief Frees the failure bookkeeping
+ * \param[in,out]   storage     The failure bookkeeping
+ */
+void cleanup_failures(failure_storage* storage)
+{
+    free(storage->code);
+    free(storage->queue);
+    storage->code = NULL;
+    storage->queue = NULL;
+    storage->num = 0;
+    storage->num_queued = 0;
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,103 @@
+/**
+ * \file
+ * \brief Header definitions for the per-IVP failure isolation of the CPU integration drivers
+ *
+ * If #FAILURE_RETRY is defined, an IVP whose integration fails (e.g. #EC_max_steps_exceeded) no longer
+ * exits the program.  Instead, the driver leaves the state of the IVP at the start of the integration
+ * step, and appends the IVP to a retry queue.  Once the remaining IVPs of the step are integrated, the
+ * queued IVPs are re-integrated with a fallback setting (see the drivers), and IVPs that fail again are
+ * reported, rather than integrated further in this step.  The failures are gathered per solver instance
+ * (accelerInt_context::failures), and may be queried with accelerInt_get_failures.
+ */
+
+#ifndef FAILURE_RETRY_H
+#define FAILURE_RETRY_H
+
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef FAILURE_RETRY
+
+#ifndef FAILURE_RETRY_SPLITS
+//! The number of equal sub-intervals a failed IVP is re-integrated over
+#define FAILURE_RETRY_SPLITS (16)
+#endif
+
+/**
+ * \brief Indices of the failure counts returned by get_failures
+ */
+enum FailureCountIndex
+{
+    //! The number of failed integrations that were queued for re-integration
+    FAILURE_RETRIED = 0,
+    //! The number of re-integrations that failed
+    FAILURE_UNRECOVERED = 1,
+    NUM_FAILURE_COUNTS = 2
+};
+
+/**
+ * \brief The failure bookkeeping of a solver instance
+ * \param           num             The number of IVPs in #code and #queue
+ * \param           code            The error code of the last unrecovered failure of each IVP, zero if none
+ * \param           queue           The IVPs that failed in the current integration step
+ * \param           num_queued      The number of IVPs in #queue
+ * \param           counts          The failure counts, @see FailureCountIndex
+ *
+ * Zero-initialize before the first call to reset_failures.
+ */
+typedef struct
+{
+    int num;
+    int* code;
+    int* queue;
+    int num_queued;
+    int counts[NUM_FAILURE_COUNTS];
+} failure_storage;
+
+/**
+ * \brief Zeros the failure codes and counts for NUM IVPs, (re)allocating the storage if NUM differs from the previous call
+ * \param[in,out]   storage     The failure bookkeeping
+ * \param[in]       NUM         The number of IVPs
+ */
+void reset_failures(failure_storage* storage, const int NUM);
+
+/**
+ * \brief Appends IVP `tid` to the retry queue, may be called concurrently by the OpenMP threads
+ * \param[in,out]   storage     The failure bookkeeping
+ * \param[in]       tid         The IVP index
+ */
+void queue_failure(failure_storage* storage, const int tid);
+
+/**
+ * \brief Records the result of the re-integration of IVP `tid`, may be called concurrently by the OpenMP threads
+ * \param[in,out]   storage     The failure bookkeeping
+ * \param[in]       tid         The IVP index
+ * \param[in]       code        The return code of the re-integration, zero on success
+ */
+void record_retry(failure_storage* storage, const int tid, const int code);
+
+/**
+ * \brief Returns the failure codes and counts since the last call to reset_failures
+ * \param[in]       storage     The failure bookkeeping
+ * \param[in]       NUM         The number of IVPs, must match the last call to reset_failures
+ * \param[out]      codes       The (NUM) error code of the last unrecovered failure of each IVP (zero if none), or NULL
+ * \param[out]      counts      The (#NUM_FAILURE_COUNTS) failure counts, or NULL
+ */
+void get_failures(const failure_storage* storage, const int NUM, int* codes, int* counts);
+
+/**
+ * \brief Frees the failure bookkeeping
+ * \param[in,out]   storage     The failure bookkeeping
+ */
+void cleanup_failures(failure_storage* storage);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
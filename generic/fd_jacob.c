@@ -1,76 +1,74 @@
 /**
  * \file
  * \brief Finite Difference Jacobian implementation based on CVODEs
+ *
+ * If #FD_COLORING is defined, the nonzero pattern of the Jacobian is detected once (from
+ * dense finite difference Jacobians at the first state and two perturbed states), and the
+ * columns are greedily colored such that no two columns of a color share a nonzero row.
+ * All columns of a color are then perturbed together, such that each Jacobian requires
+ * one RHS evaluation per color (times FD_ORD) rather than per column.
+ *
+ * If #DYDT_BATCH is defined, the perturbed states (of all columns or colors, and finite difference
+ * points) are independent, and are evaluated #FD_BATCH at a time with the dydt_batch of the mechanism.
+ *
+ * If #SPARSE_JACOBIAN is defined (which implies #FD_COLORING), the columns are colored by the structural
+ * pattern of the mechanism instead, and only its entries are stored, @see sparse_jacobian.h
  */
 
 #include "header.h"
 #include "dydt.h"
 #include <math.h>
 #include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
 #include "solver_options.h"
+#include "sparse_jacobian.h"
+#include "tolerances.h"
 
 //! The finite difference order [Default: 1]
 #define FD_ORD 1
 
+// Finite difference coefficients
+#if FD_ORD == 2
+  // 2nd order central difference
+  static const double x_coeffs[FD_ORD] = {-1.0, 1.0};
+  static const double y_coeffs[FD_ORD] = {-0.5, 0.5};
+#elif FD_ORD == 4
+  // 4th order central difference
+  static const double x_coeffs[FD_ORD] = {-2.0, -1.0, 1.0, 2.0};
+  static const double y_coeffs[FD_ORD] = {1.0 / 12.0, -2.0 / 3.0, 2.0 / 3.0, -1.0 / 12.0};
+#elif FD_ORD == 6
+  // 6th order central difference
+  static const double x_coeffs[FD_ORD] = {-3.0, -2.0, -1.0, 1.0, 2.0, 3.0};
+  static const double y_coeffs[FD_ORD] = {-1.0 / 60.0, 3.0 / 20.0, -3.0 / 4.0, 3.0 / 4.0, -3.0 / 20.0, 1.0 / 60.0};
+#endif
+
+#ifdef SPARSE_JACOBIAN
+  //! The storage of the entry (i, j) of the Jacobian, the `n`-th entry of the pattern
+  #define FD_ENTRY(n, i, j) (n)
+#else
+  //! The storage of the entry (i, j) of the Jacobian, the `n`-th entry of the pattern
+  #define FD_ENTRY(n, i, j) ((i) + NSP*(j))
+#endif
+
 /**
- * \brief Computes a finite difference Jacobian of order FD_ORD of the RHS function dydt at the given pressure and state
+ * \brief Evaluates the RHS and the perturbation of each state vector entry
  *
  * \param[in]         t           the current system time
  * \param[in]         pres        the current system pressure
- * \param[in]         cy          the system state vector
- * \param[out]        jac         the resulting Jacobian
+ * \param[in]         y           the system state vector
+ * \param[out]        dy          the RHS at `y`
+ * \param[out]        r           the perturbation of each entry of `y`
  */
-void eval_jacob (const double t, const double pres, const double * cy, double * jac) {
-
-  double y[NSP];
-  memcpy(y, cy, NSP * sizeof(double));
-  double dy[NSP];
+static void fd_perturbations (const double t, const double pres, const double * y, double * dy, double * r) {
   dydt (t, pres, y, dy);
 
-  // Finite difference coefficients
-  #if FD_ORD != 1
-  double x_coeffs[FD_ORD];
-  double y_coeffs[FD_ORD];
-
-  if (FD_ORD == 2) {
-    // 2nd order central difference
-    x_coeffs[0] = -1.0;
-    x_coeffs[1] = 1.0;
-    y_coeffs[0] = -0.5;
-    y_coeffs[1] = 0.5;
-  } else if (FD_ORD == 4) {
-    // 4th order central difference
-    x_coeffs[0] = -2.0;
-    x_coeffs[1] = -1.0;
-    x_coeffs[2] = 1.0;
-    x_coeffs[3] = 2.0;
-    y_coeffs[0] = 1.0 / 12.0;
-    y_coeffs[1] = -2.0 / 3.0;
-    y_coeffs[2] = 2.0 / 3.0;
-    y_coeffs[3] = -1.0 / 12.0;
-  } else if (FD_ORD == 6) {
-    // 6th order central difference
-    x_coeffs[0] = -3.0;
-    x_coeffs[1] = -2.0;
-    x_coeffs[2] = -1.0;
-    x_coeffs[3] = 1.0;
-    x_coeffs[4] = 2.0;
-    x_coeffs[5] = 3.0;
-
-    y_coeffs[0] = -1.0 / 60.0;
-    y_coeffs[1] = 3.0 / 20.0;
-    y_coeffs[2] = -3.0 / 4.0;
-    y_coeffs[3] = 3.0 / 4.0;
-    y_coeffs[4] = -3.0 / 20.0;
-    y_coeffs[5] = 1.0 / 60.0;
-  }
-  #endif
-
   double ewt[NSP];
 
   for (int i = 0; i < NSP; ++i) {
-    ewt[i] = ATOL + (RTOL * fabs(y[i]));
+    ewt[i] = current_tolerances.atol[i] + (current_tolerances.rtol * fabs(y[i]));
   }
 
   // unit roundoff of machine
@@ -82,22 +80,137 @@ void eval_jacob (const double t, const double pres, const double * cy, double *
     sum += (ewt[i] * dy[i]) * (ewt[i] * dy[i]);
   }
   double fac = sqrt(sum / ((double)(NSP)));
-  double r0 = 1000.0 * RTOL * DBL_EPSILON * ((double)(NSP)) * fac;
+  double r0 = 1000.0 * current_tolerances.rtol * DBL_EPSILON * ((double)(NSP)) * fac;
+
+  for (int j = 0; j < NSP; ++j) {
+    r[j] = fmax(srur * fabs(y[j]), r0 / ewt[j]);
+  }
+}
+
+#ifdef DYDT_BATCH
+
+//! The number of perturbed states per dydt_batch call
+#define FD_BATCH (8)
+
+/**
+ * \brief Computes a finite difference Jacobian of order FD_ORD, evaluating the perturbed states with dydt_batch
+ *
+ * \param[in]         t           the current system time
+ * \param[in]         pres        the current system pressure
+ * \param[in]         cy          the system state vector
+ * \param[in]         num_groups  the number of column groups, the columns of a group are perturbed together
+ * \param[in]         group_ptr   the columns of group `g` are `group_cols[group_ptr[g]]`...`group_cols[group_ptr[g + 1] - 1]`
+ * \param[in]         group_cols  the columns, sorted by group
+ * \param[in]         row_ptr     if not NULL, the rows of column `j` are `row_index[row_ptr[j]]`...`row_index[row_ptr[j + 1] - 1]`,
+ *                                otherwise all rows are computed
+ * \param[in]         row_index   the row indicies, @see row_ptr
+ * \param[out]        jac         the resulting Jacobian, only the computed rows of each column are written
+ *                                (compressed by their position in `row_index` if #SPARSE_JACOBIAN is defined)
+ */
+static void fd_jacob_batch (const double t, const double pres, const double * cy, const int num_groups,
+                            const int * group_ptr, const int * group_cols, const int * row_ptr,
+                            const int * row_index, double * jac) {
+
+  double dy[NSP];
+  double r[NSP];
+  fd_perturbations (t, pres, cy, dy, r);
+
+  double tb[FD_BATCH];
+  double pb[FD_BATCH];
+  for (int b = 0; b < FD_BATCH; ++b) {
+    tb[b] = t;
+    pb[b] = pres;
+  }
+  // the lane-wise perturbed states and their RHS
+  double yb[NSP * FD_BATCH];
+  double fb[NSP * FD_BATCH];
+
+  // the perturbed states, ordered by group and then by finite difference point
+  const int num_evals = num_groups * FD_ORD;
+  for (int e0 = 0; e0 < num_evals; e0 += FD_BATCH) {
+    const int nb = num_evals - e0 < FD_BATCH ? num_evals - e0 : FD_BATCH;
+
+    for (int b = 0; b < nb; ++b) {
+      const int g = (e0 + b) / FD_ORD;
+      for (int i = 0; i < NSP; ++i) {
+        yb[b + i * nb] = cy[i];
+      }
+      for (int l = group_ptr[g]; l < group_ptr[g + 1]; ++l) {
+        const int j = group_cols[l];
+        #if FD_ORD==1
+          yb[b + j * nb] = cy[j] + r[j];
+        #else
+          yb[b + j * nb] = cy[j] + x_coeffs[(e0 + b) % FD_ORD] * r[j];
+        #endif
+      }
+    }
+
+    dydt_batch (nb, tb, pb, yb, fb);
+
+    for (int b = 0; b < nb; ++b) {
+      const int g = (e0 + b) / FD_ORD;
+      for (int l = group_ptr[g]; l < group_ptr[g + 1]; ++l) {
+        const int j = group_cols[l];
+        const int num_rows = row_ptr ? row_ptr[j + 1] - row_ptr[j] : NSP;
+        for (int n = 0; n < num_rows; ++n) {
+          const int i = row_ptr ? row_index[row_ptr[j] + n] : n;
+          const int e = row_ptr ? FD_ENTRY(row_ptr[j] + n, i, j) : i + NSP*j;
+          #if FD_ORD==1
+            jac[e] = (fb[b + i * nb] - dy[i]) / r[j];
+          #else
+            // the first point of a group starts the sum
+            const int k = (e0 + b) % FD_ORD;
+            double prev = k == 0 ? 0.0 : jac[e];
+            jac[e] = prev + y_coeffs[k] * fb[b + i * nb] / r[j];
+          #endif
+        }
+      }
+    }
+  }
+
+}
+
+#endif
+
+#ifndef SPARSE_JACOBIAN
+
+/**
+ * \brief Computes a dense finite difference Jacobian of order FD_ORD, perturbing one column at a time
+ *
+ * \param[in]         t           the current system time
+ * \param[in]         pres        the current system pressure
+ * \param[in]         cy          the system state vector
+ * \param[out]        jac         the resulting Jacobian
+ */
+static void fd_jacob_dense (const double t, const double pres, const double * cy, double * jac) {
+
+#ifdef DYDT_BATCH
+  // each column is a group of its own, i.e. both the group pointer and the columns are the identity
+  int cols[NSP + 1];
+  for (int j = 0; j <= NSP; ++j) {
+    cols[j] = j;
+  }
+  fd_jacob_batch (t, pres, cy, NSP, cols, cols, NULL, NULL, jac);
+#else
+  double y[NSP];
+  memcpy(y, cy, NSP * sizeof(double));
+  double dy[NSP];
+  double r[NSP];
+  fd_perturbations (t, pres, y, dy, r);
 
   double ftemp[NSP];
 
 
   for (int j = 0; j < NSP; ++j) {
     double yj_orig = y[j];
-    double r = fmax(srur * fabs(yj_orig), r0 / ewt[j]);
 
     #if FD_ORD==1
-      y[j] = yj_orig + r;
+      y[j] = yj_orig + r[j];
       dydt (t, pres, y, ftemp);
 
 
       for (int i = 0; i < NSP; ++i) {
-        jac[i + NSP*j] = (ftemp[i] - dy[i]) / r;
+        jac[i + NSP*j] = (ftemp[i] - dy[i]) / r[j];
       }
     #else
 
@@ -106,7 +219,7 @@ void eval_jacob (const double t, const double pres, const double * cy, double *
       }
 
       for (int k = 0; k < FD_ORD; ++k) {
-        y[j] = yj_orig + x_coeffs[k] * r;
+        y[j] = yj_orig + x_coeffs[k] * r[j];
         dydt (t, pres, y, ftemp);
 
 
@@ -116,12 +229,206 @@ void eval_jacob (const double t, const double pres, const double * cy, double *
       }
 
       for (int i = 0; i < NSP; ++i) {
-        jac[i + NSP*j] /= r;
+        jac[i + NSP*j] /= r[j];
       }
 
     #endif
 
     y[j] = yj_orig;
   }
+#endif
 
 }
+
+#endif
+
+#ifdef FD_COLORING
+
+//! The columns of color `c` are `color_cols[color_ptr[c]]`...`color_cols[color_ptr[c + 1] - 1]`
+static int color_ptr[NSP + 1];
+//! The columns, sorted by color, @see color_ptr
+static int color_cols[NSP];
+//! The number of colors
+static int num_colors = 0;
+//! The nonzero rows of column `j` are `row_index[row_ptr[j]]`...`row_index[row_ptr[j + 1] - 1]`
+static int row_ptr[NSP + 1];
+//! The row indicies of the nonzero pattern, @see row_ptr
+static int row_index[NSP * NSP];
+//! Nonzero once the coloring is computed
+static int colored = 0;
+
+/**
+ * \brief Detects the nonzero pattern of the Jacobian and colors its columns, if not already done
+ *
+ * \param[in]         t           the current system time
+ * \param[in]         pres        the current system pressure
+ * \param[in]         cy          a state vector to evaluate the Jacobian at
+ *
+ * Thread-safe, only the first call computes the coloring.
+ */
+static void fd_coloring_init (const double t, const double pres, const double * cy) {
+  int done;
+  #pragma omp atomic read
+  done = colored;
+  if (done)
+    return;
+
+  #pragma omp critical(fd_coloring_init)
+  {
+    if (!colored) {
+      bool* pattern = (bool*)calloc(NSP * NSP, sizeof(bool));
+#ifdef SPARSE_JACOBIAN
+      // the structural pattern of the mechanism, i.e. the nonzero rows are the compressed entries
+      jacobian_pattern (pattern);
+#else
+      double* jac = (double*)malloc(NSP * NSP * sizeof(double));
+      double y[NSP];
+      // the union of the patterns at cy and two perturbed states (in which all entries are nonzero)
+      for (int k = 0; k < 3; ++k) {
+        for (int i = 0; i < NSP; ++i) {
+          y[i] = cy[i] + 0.1 * k * (fabs(cy[i]) + 1e-3);
+        }
+        fd_jacob_dense (t, pres, y, jac);
+        for (int i = 0; i < NSP * NSP; ++i) {
+          pattern[i] = pattern[i] || jac[i] != 0;
+        }
+      }
+      free(jac);
+#endif
+
+      int nnz = 0;
+      for (int j = 0; j < NSP; ++j) {
+        row_ptr[j] = nnz;
+        for (int i = 0; i < NSP; ++i) {
+          if (pattern[i + NSP * j])
+            row_index[nnz++] = i;
+        }
+      }
+      row_ptr[NSP] = nnz;
+
+      // greedy coloring, the first color not used by a column sharing a nonzero row
+      int color[NSP];
+      bool used[NSP];
+      num_colors = 0;
+      for (int j = 0; j < NSP; ++j) {
+        memset(used, 0, NSP * sizeof(bool));
+        for (int k = 0; k < j; ++k) {
+          for (int l = row_ptr[j]; l < row_ptr[j + 1]; ++l) {
+            if (pattern[row_index[l] + NSP * k]) {
+              used[color[k]] = true;
+              break;
+            }
+          }
+        }
+        int c = 0;
+        while (used[c])
+          c++;
+        color[j] = c;
+        num_colors = c + 1 > num_colors ? c + 1 : num_colors;
+      }
+      int count = 0;
+      for (int c = 0; c < num_colors; ++c) {
+        color_ptr[c] = count;
+        for (int j = 0; j < NSP; ++j) {
+          if (color[j] == c)
+            color_cols[count++] = j;
+        }
+      }
+      color_ptr[num_colors] = count;
+
+      free(pattern);
+      #pragma omp flush
+      #pragma omp atomic write
+      colored = 1;
+    }
+  }
+}
+
+/**
+ * \brief Computes a finite difference Jacobian of order FD_ORD, perturbing all columns of a color together
+ *
+ * \param[in]         t           the current system time
+ * \param[in]         pres        the current system pressure
+ * \param[in]         cy          the system state vector
+ * \param[out]        jac         the resulting Jacobian, entries outside the detected pattern are zero
+ *                                (only the entries of the pattern are stored if #SPARSE_JACOBIAN is defined)
+ */
+static void fd_jacob_colored (const double t, const double pres, const double * cy, double * jac) {
+
+#ifdef DYDT_BATCH
+  memset(jac, 0, JAC_SIZE * sizeof(double));
+  fd_jacob_batch (t, pres, cy, num_colors, color_ptr, color_cols, row_ptr, row_index, jac);
+#else
+  double y[NSP];
+  memcpy(y, cy, NSP * sizeof(double));
+  double dy[NSP];
+  double r[NSP];
+  fd_perturbations (t, pres, y, dy, r);
+
+  double ftemp[NSP];
+
+  memset(jac, 0, JAC_SIZE * sizeof(double));
+
+  for (int c = 0; c < num_colors; ++c) {
+    #if FD_ORD==1
+      for (int l = color_ptr[c]; l < color_ptr[c + 1]; ++l) {
+        y[color_cols[l]] += r[color_cols[l]];
+      }
+      dydt (t, pres, y, ftemp);
+
+      for (int l = color_ptr[c]; l < color_ptr[c + 1]; ++l) {
+        int j = color_cols[l];
+        y[j] = cy[j];
+        for (int n = row_ptr[j]; n < row_ptr[j + 1]; ++n) {
+          int i = row_index[n];
+          jac[FD_ENTRY(n, i, j)] = (ftemp[i] - dy[i]) / r[j];
+        }
+      }
+    #else
+      for (int k = 0; k < FD_ORD; ++k) {
+        for (int l = color_ptr[c]; l < color_ptr[c + 1]; ++l) {
+          int j = color_cols[l];
+          y[j] = cy[j] + x_coeffs[k] * r[j];
+        }
+        dydt (t, pres, y, ftemp);
+
+        for (int l = color_ptr[c]; l < color_ptr[c + 1]; ++l) {
+          int j = color_cols[l];
+          for (int n = row_ptr[j]; n < row_ptr[j + 1]; ++n) {
+            int i = row_index[n];
+            jac[FD_ENTRY(n, i, j)] += y_coeffs[k] * ftemp[i];
+          }
+        }
+      }
+
+      for (int l = color_ptr[c]; l < color_ptr[c + 1]; ++l) {
+        int j = color_cols[l];
+        y[j] = cy[j];
+        for (int n = row_ptr[j]; n < row_ptr[j + 1]; ++n) {
+          jac[FD_ENTRY(n, row_index[n], j)] /= r[j];
+        }
+      }
+    #endif
+  }
+#endif
+
+}
+
+#endif
+
+/**
+ * \brief Computes a finite difference Jacobian of order FD_ORD of the RHS function dydt at the given pressure and state
+ *
+ * \param[in]         t           the current system time
+ * \param[in]         pres        the current system pressure
+ * \param[in]         cy          the system state vector
+ * \param[out]        jac         the resulting Jacobian
+ */
+void eval_jacob (const double t, const double pres, const double * cy, double * jac) {
+#ifdef FD_COLORING
+  fd_coloring_init (t, pres, cy);
+  fd_jacob_colored (t, pres, cy, jac);
+#else
+  fd_jacob_dense (t, pres, cy, jac);
+#endif
+}
@@ -1,9 +1,18 @@
 /**
  * \file
  * \brief Finite Difference Jacobian implementation based on CVODEs
+ *
+ * If #FD_COLORING is defined, initialize_fd_coloring detects the nonzero pattern of the Jacobian
+ * and colors its columns, such that all columns of a color are perturbed together.
+ * If #SPARSE_JACOBIAN is defined (which implies #FD_COLORING), the columns are colored by the structural
+ * pattern of the mechanism instead, and only its entries are stored, @see sparse_jacobian.cuh
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "fd_jacob.cuh"
+#include "gpu_memory.cuh"
+#include "sparse_jacobian.cuh"
 
 //! The finite difference order [Default: 1]
 #define FD_ORD 1
@@ -20,8 +29,17 @@
   __constant__ double y_coeffs[FD_ORD] = {-1.0 / 60.0, 3.0 / 20.0, -3.0 / 4.0, 3.0 / 4.0, -3.0 / 20.0, 1.0 / 60.0};
 #endif
 
+#ifdef SPARSE_JACOBIAN
+  //! The storage of the entry (i, j) of the Jacobian, the `n`-th entry of the pattern
+  #define FD_ENTRY(n, i, j) (n)
+#else
+  //! The storage of the entry (i, j) of the Jacobian, the `n`-th entry of the pattern
+  #define FD_ENTRY(n, i, j) ((i) + NSP*(j))
+#endif
+
+#ifndef SPARSE_JACOBIAN
 /**
- * \brief Computes a finite difference Jacobian of order FD_ORD of the RHS function dydt at the given pressure and state
+ * \brief Computes a dense finite difference Jacobian of order FD_ORD, perturbing one column at a time
  *
  * \param[in]         t           the current system time
  * \param[in]         pres        the current system pressure
@@ -32,7 +50,7 @@
  * \param[in]         ewt         a storage for the error weights in computing the Jacobian perturbation factor
  */
 __device__
-void eval_jacob (const double t, const double pres, const double * __restrict__ cy,
+static void fd_jacob_dense (const double t, const double pres, const double * __restrict__ cy,
                     double * __restrict__ jac, const mechanism_memory* __restrict__ d_mem,
                     double* __restrict__ y_temp, double* __restrict__ ewt) {
   double* dy = d_mem->dy;
@@ -103,4 +121,256 @@ void eval_jacob (const double t, const double pres, const double * __restrict__
     y_temp[INDEX(j)] = yj_orig;
   }
 
-}
\ No newline at end of file
+}
+#endif
+
+#ifdef FD_COLORING
+
+//! The columns of color `c` are `fd_color_cols[fd_color_ptr[c]]`...`fd_color_cols[fd_color_ptr[c + 1] - 1]`
+__device__ int fd_color_ptr[NSP + 1];
+//! The columns, sorted by color, @see fd_color_ptr
+__device__ int fd_color_cols[NSP];
+//! The number of colors
+__device__ int fd_num_colors;
+//! The nonzero rows of column `j` are `fd_row_index[fd_row_ptr[j]]`...`fd_row_index[fd_row_ptr[j + 1] - 1]`
+__device__ int fd_row_ptr[NSP + 1];
+//! The row indicies of the nonzero pattern, @see fd_row_ptr
+__device__ int fd_row_index[NSP * NSP];
+
+#ifndef SPARSE_JACOBIAN
+/**
+ * \brief Accumulates the nonzero pattern of the dense finite difference Jacobian at three synthetic states
+ * \param[in]       d_mem       The mechanism memory (allocated for a single thread)
+ * \param[in]       y_temp      A (NSP x 1) work array
+ * \param[in]       ewt         A (NSP x 1) work array
+ * \param[in,out]   mask        The (zeroed) nonzero pattern, stored as `mask[i + j * NSP]`
+ *
+ * Launched with a single thread, such that `INDEX(i) == i`
+ */
+__global__
+void fd_coloring_detect(const mechanism_memory* __restrict__ d_mem, double* __restrict__ y_temp,
+                        double* __restrict__ ewt, bool* __restrict__ mask)
+{
+    double* const __restrict__ y = d_mem->y;
+    double* const __restrict__ jac = d_mem->jac;
+    for (int k = 0; k < 3; ++k)
+    {
+        y[INDEX(0)] = 1000.0 + 250.0 * k;
+        for (int i = 1; i < NSP; ++i)
+            y[INDEX(i)] = (1.0 + 0.5 * k + 0.01 * i) / NSP;
+        fd_jacob_dense(0, 101325.0 * (1 + k), y, jac, d_mem, y_temp, ewt);
+        for (int i = 0; i < NSP * NSP; ++i)
+            mask[i] = mask[i] || jac[INDEX(i)] != 0;
+    }
+}
+#endif
+
+// host code, not compiled by NVRTC (@see nvrtc_kernels.cuh)
+#ifndef __CUDACC_RTC__
+void initialize_fd_coloring()
+{
+    bool* pattern = (bool*)malloc(NSP * NSP * sizeof(bool));
+#ifdef SPARSE_JACOBIAN
+    // the structural pattern of the mechanism, i.e. the nonzero rows are the compressed entries
+    jacobian_pattern(pattern);
+#else
+    // evaluate the dense Jacobian on the device
+    mechanism_memory* h_mech = (mechanism_memory*)malloc(sizeof(mechanism_memory));
+    mechanism_memory* d_mech = 0;
+    initialize_gpu_memory(1, &h_mech, &d_mech);
+    double* d_work = 0;
+    cudaErrorCheck( cudaMalloc((void**)&d_work, 2 * NSP * sizeof(double)) );
+    bool* d_mask = 0;
+    cudaErrorCheck( cudaMalloc((void**)&d_mask, NSP * NSP * sizeof(bool)) );
+    cudaErrorCheck( cudaMemset(d_mask, 0, NSP * NSP * sizeof(bool)) );
+    fd_coloring_detect <<< 1, 1 >>> (d_mech, d_work, &d_work[NSP], d_mask);
+    cudaErrorCheck( cudaPeekAtLastError() );
+    cudaErrorCheck( cudaMemcpy(pattern, d_mask, NSP * NSP * sizeof(bool), cudaMemcpyDeviceToHost) );
+    cudaErrorCheck( cudaFree(d_mask) );
+    cudaErrorCheck( cudaFree(d_work) );
+    free_gpu_memory(&h_mech, &d_mech);
+    free(h_mech);
+#endif
+
+    int row_ptr[NSP + 1];
+    int* row_index = (int*)malloc(NSP * NSP * sizeof(int));
+    int nnz = 0;
+    for (int j = 0; j < NSP; ++j)
+    {
+        row_ptr[j] = nnz;
+        for (int i = 0; i < NSP; ++i)
+        {
+            if (pattern[i + NSP * j])
+                row_index[nnz++] = i;
+        }
+    }
+    row_ptr[NSP] = nnz;
+
+    // greedy coloring, the first color not used by a column sharing a nonzero row
+    int color[NSP];
+    bool used[NSP];
+    int num_colors = 0;
+    for (int j = 0; j < NSP; ++j)
+    {
+        memset(used, 0, NSP * sizeof(bool));
+        for (int k = 0; k < j; ++k)
+        {
+            for (int l = row_ptr[j]; l < row_ptr[j + 1]; ++l)
+            {
+                if (pattern[row_index[l] + NSP * k])
+                {
+                    used[color[k]] = true;
+                    break;
+                }
+            }
+        }
+        int c = 0;
+        while (used[c])
+            c++;
+        color[j] = c;
+        num_colors = c + 1 > num_colors ? c + 1 : num_colors;
+    }
+    int color_ptr[NSP + 1];
+    int color_cols[NSP];
+    int count = 0;
+    for (int c = 0; c < num_colors; ++c)
+    {
+        color_ptr[c] = count;
+        for (int j = 0; j < NSP; ++j)
+        {
+            if (color[j] == c)
+                color_cols[count++] = j;
+        }
+    }
+    color_ptr[num_colors] = count;
+
+    cudaErrorCheck( cudaMemcpyToSymbol(fd_color_ptr, color_ptr, (num_colors + 1) * sizeof(int)) );
+    cudaErrorCheck( cudaMemcpyToSymbol(fd_color_cols, color_cols, NSP * sizeof(int)) );
+    cudaErrorCheck( cudaMemcpyToSymbol(fd_num_colors, &num_colors, sizeof(int)) );
+    cudaErrorCheck( cudaMemcpyToSymbol(fd_row_ptr, row_ptr, (NSP + 1) * sizeof(int)) );
+    if (nnz > 0)
+        cudaErrorCheck( cudaMemcpyToSymbol(fd_row_index, row_index, nnz * sizeof(int)) );
+    free(pattern);
+    free(row_index);
+}
+#endif
+
+/**
+ * \brief Computes a finite difference Jacobian of order FD_ORD, perturbing all columns of a color together
+ *
+ * \param[in]         t           the current system time
+ * \param[in]         pres        the current system pressure
+ * \param[in]         cy          the system state vector
+ * \param[out]        jac         the resulting Jacobian, entries outside the detected pattern are zero
+ *                                (only the entries of the pattern are stored if #SPARSE_JACOBIAN is defined)
+ * \param[in]         d_mem       the mechanism_memory object used in computing dydt
+ * \param[in]         y_temp      a work array for the state vector
+ * \param[in]         ewt         a storage for the error weights in computing the Jacobian perturbation factor
+ */
+__device__
+static void fd_jacob_colored (const double t, const double pres, const double * __restrict__ cy,
+                    double * __restrict__ jac, const mechanism_memory* __restrict__ d_mem,
+                    double* __restrict__ y_temp, double* __restrict__ ewt) {
+  double* dy = d_mem->dy;
+
+  #pragma unroll
+  for (int i = 0; i < NSP; ++i) {
+    y_temp[INDEX(i)] = cy[INDEX(i)];
+    ewt[INDEX(i)] = ATOL + (RTOL * fabs(cy[INDEX(i)]));
+  }
+  for (int i = 0; i < JAC_SIZE; ++i) {
+    jac[INDEX(i)] = 0.0;
+  }
+
+  dydt (t, pres, cy, dy, d_mem);
+  #if FD_ORD == 1
+  // each entry of the pattern stores the unperturbed RHS until its column is evaluated
+  for (int j = 0; j < NSP; ++j) {
+      for (int n = fd_row_ptr[j]; n < fd_row_ptr[j + 1]; ++n) {
+        int i = fd_row_index[n];
+        jac[INDEX(FD_ENTRY(n, i, j))] = dy[INDEX(i)];
+      }
+  }
+  #endif
+
+  // unit roundoff of machine
+  double srur = sqrt(DBL_EPSILON);
+
+  double sum = 0.0;
+  #pragma unroll
+  for (int i = 0; i < NSP; ++i) {
+    sum += (ewt[INDEX(i)] * dy[INDEX(i)]) * (ewt[INDEX(i)] * dy[INDEX(i)]);
+  }
+  double fac = sqrt(sum / ((double)(NSP)));
+  double r0 = 1000.0 * RTOL * DBL_EPSILON * ((double)(NSP)) * fac;
+
+  for (int c = 0; c < fd_num_colors; ++c) {
+    #if FD_ORD == 1
+      for (int l = fd_color_ptr[c]; l < fd_color_ptr[c + 1]; ++l) {
+        int j = fd_color_cols[l];
+        y_temp[INDEX(j)] = cy[INDEX(j)] + fmax(srur * fabs(cy[INDEX(j)]), r0 / ewt[INDEX(j)]);
+      }
+      dydt (t, pres, y_temp, dy, d_mem);
+
+      for (int l = fd_color_ptr[c]; l < fd_color_ptr[c + 1]; ++l) {
+        int j = fd_color_cols[l];
+        double r = fmax(srur * fabs(cy[INDEX(j)]), r0 / ewt[INDEX(j)]);
+        for (int n = fd_row_ptr[j]; n < fd_row_ptr[j + 1]; ++n) {
+          int i = fd_row_index[n];
+          jac[INDEX(FD_ENTRY(n, i, j))] = (dy[INDEX(i)] - jac[INDEX(FD_ENTRY(n, i, j))]) / r;
+        }
+        y_temp[INDEX(j)] = cy[INDEX(j)];
+      }
+    #else
+      for (int k = 0; k < FD_ORD; ++k) {
+        for (int l = fd_color_ptr[c]; l < fd_color_ptr[c + 1]; ++l) {
+          int j = fd_color_cols[l];
+          double r = fmax(srur * fabs(cy[INDEX(j)]), r0 / ewt[INDEX(j)]);
+          y_temp[INDEX(j)] = cy[INDEX(j)] + x_coeffs[k] * r;
+        }
+        dydt (t, pres, y_temp, dy, d_mem);
+
+        for (int l = fd_color_ptr[c]; l < fd_color_ptr[c + 1]; ++l) {
+          int j = fd_color_cols[l];
+          for (int n = fd_row_ptr[j]; n < fd_row_ptr[j + 1]; ++n) {
+            int i = fd_row_index[n];
+            jac[INDEX(FD_ENTRY(n, i, j))] += y_coeffs[k] * dy[INDEX(i)];
+          }
+        }
+      }
+      for (int l = fd_color_ptr[c]; l < fd_color_ptr[c + 1]; ++l) {
+        int j = fd_color_cols[l];
+        double r = fmax(srur * fabs(cy[INDEX(j)]), r0 / ewt[INDEX(j)]);
+        for (int n = fd_row_ptr[j]; n < fd_row_ptr[j + 1]; ++n) {
+          jac[INDEX(FD_ENTRY(n, fd_row_index[n], j))] /= r;
+        }
+        y_temp[INDEX(j)] = cy[INDEX(j)];
+      }
+    #endif
+  }
+
+}
+
+#endif
+
+/**
+ * \brief Computes a finite difference Jacobian of order FD_ORD of the RHS function dydt at the given pressure and state
+ *
+ * \param[in]         t           the current system time
+ * \param[in]         pres        the current system pressure
+ * \param[in]         cy          the system state vector
+ * \param[out]        jac         the resulting Jacobian
+ * \param[in]         d_mem       the mechanism_memory object used in computing dydt
+ * \param[in]         y_temp      a work array for the state vector
+ * \param[in]         ewt         a storage for the error weights in computing the Jacobian perturbation factor
+ */
+__device__
+void eval_jacob (const double t, const double pres, const double * __restrict__ cy,
+                    double * __restrict__ jac, const mechanism_memory* __restrict__ d_mem,
+                    double* __restrict__ y_temp, double* __restrict__ ewt) {
+#ifdef FD_COLORING
+  fd_jacob_colored (t, pres, cy, jac, d_mem, y_temp, ewt);
+#else
+  fd_jacob_dense (t, pres, cy, jac, d_mem, y_temp, ewt);
+#endif
+}
@@ -18,4 +18,16 @@ void eval_jacob (const double, const double, const double * __restrict__,
                     double * __restrict__, const mechanism_memory* __restrict__,
                     double* __restrict__, double* __restrict__);
 
+#ifdef FD_COLORING
+/**
+ * \brief Detects the nonzero pattern of the finite difference Jacobian on the current device and colors its columns
+ *
+ * The pattern is the union of the nonzero entries of the (dense) finite difference Jacobian at three
+ * synthetic states (in which all entries are nonzero), evaluated by a single device thread.
+ * Columns that share no nonzero row receive the same color, and are perturbed together by eval_jacob.
+ * Must be called before the first call to eval_jacob.
+ */
+void initialize_fd_coloring();
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,172 @@
+/**
+ * \file
+ * \brief Implementation of the pooled device memory arena, @see gpu_arena.cuh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "gpu_arena.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The arena currently carved out of by arena_malloc on this thread, or NULL
+static gpu_arena* current_arena = NULL;
+#pragma omp threadprivate(current_arena)
+//! The reserved arenas (of all threads), whose arrays are not freed by arena_free
+static gpu_arena* arenas[MAX_ARENAS];
+//! The number of reserved arenas
+static int num_arenas = 0;
+
+/**
+ * \brief Allocates `size` bytes on the current device, or (if #MANAGED_MEMORY is defined) managed memory
+ *        that is preferably located on the current device
+ */
+static cudaError_t device_alloc(void** ptr, size_t size)
+{
+#ifdef MANAGED_MEMORY
+    cudaError_t code = cudaMallocManaged(ptr, size, cudaMemAttachGlobal);
+    if (code != cudaSuccess)
+        return code;
+    int device = 0;
+    cudaGetDevice(&device);
+    return cudaMemAdvise(*ptr, size, cudaMemAdviseSetPreferredLocation, device);
+#else
+    return cudaMalloc(ptr, size);
+#endif
+}
+
+/**
+ * \brief Returns true if `ptr` was carved out of a reserved arena
+ */
+static bool in_arena(const void* ptr)
+{
+    const char* p = (const char*)ptr;
+    bool found = false;
+    #pragma omp critical(gpu_arena)
+    for (int i = 0; i < num_arenas && !found; ++i)
+    {
+        found = p >= arenas[i]->base && p < arenas[i]->base + arenas[i]->capacity;
+    }
+    return found;
+}
+
+/**
+ * \brief Adds `arena` to the reserved arenas
+ */
+static void register_arena(gpu_arena* arena)
+{
+    bool full = false;
+    #pragma omp critical(gpu_arena)
+    {
+        full = num_arenas >= MAX_ARENAS;
+        if (!full)
+            arenas[num_arenas++] = arena;
+    }
+    if (full)
+    {
+        printf("Error: at most %d device memory arenas may be reserved at once.\n", MAX_ARENAS);
+        exit(-1);
+    }
+}
+
+/**
+ * \brief Removes `arena` from the reserved arenas
+ */
+static void unregister_arena(const gpu_arena* arena)
+{
+    #pragma omp critical(gpu_arena)
+    for (int i = 0; i < num_arenas; ++i)
+    {
+        if (arenas[i] == arena)
+        {
+            arenas[i] = arenas[--num_arenas];
+            break;
+        }
+    }
+}
+
+void arena_reserve(gpu_arena* arena, size_t size)
+{
+    int device = 0;
+    cudaGetDevice(&device);
+    size += arena->spilled;
+    size = ((size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT) * ARENA_ALIGNMENT;
+    arena->used = 0;
+    arena->spilled = 0;
+    if (arena->base != NULL && arena->device == device && size <= arena->capacity && 2 * size >= arena->capacity)
+        return;
+    arena_release(arena);
+    cudaError_t code = device_alloc((void**)&arena->base, size);
+    if (code != cudaSuccess)
+    {
+        printf("Error: could not reserve a device memory arena of %zu bytes: %s\n", size, cudaGetErrorString(code));
+        exit(-1);
+    }
+    arena->capacity = size;
+    arena->device = device;
+    register_arena(arena);
+}
+
+void arena_begin(gpu_arena* arena)
+{
+    arena->used = 0;
+    arena->spilled = 0;
+    current_arena = arena;
+}
+
+void arena_end()
+{
+    current_arena = NULL;
+}
+
+void arena_release(gpu_arena* arena)
+{
+    if (current_arena == arena)
+        current_arena = NULL;
+    unregister_arena(arena);
+    if (arena->base != NULL)
+    {
+        cudaError_t code = cudaFree(arena->base);
+        if (code != cudaSuccess)
+        {
+            printf("Error: could not free a device memory arena: %s\n", cudaGetErrorString(code));
+            exit(-1);
+        }
+    }
+    arena->base = NULL;
+    arena->capacity = 0;
+    arena->used = 0;
+}
+
+size_t arena_footprint(const gpu_arena* arena)
+{
+    return arena->capacity + arena->spilled;
+}
+
+cudaError_t arena_malloc(void** ptr, size_t size)
+{
+    gpu_arena* arena = current_arena;
+    size_t aligned = ((size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT) * ARENA_ALIGNMENT;
+    if (arena == NULL || arena->base == NULL || arena->used + aligned > arena->capacity)
+    {
+        if (arena != NULL)
+            arena->spilled += aligned;
+        return device_alloc(ptr, size);
+    }
+    *ptr = (void*)(arena->base + arena->used);
+    arena->used += aligned;
+    return cudaSuccess;
+}
+
+cudaError_t arena_free(void* ptr)
+{
+    if (ptr == NULL || in_arena(ptr))
+        return cudaSuccess;
+    return cudaFree(ptr);
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,133 @@
+/**
+ * \file
+ * \brief Definitions for the pooled device memory arena of the solver_memory and mechanism_memory arrays
+ *
+ * If #GPU_ARENA is defined, the GPU drivers reserve a single (aligned) device allocation per device,
+ * and the per-thread arrays of initialize_solver and initialize_gpu_memory are carved out of it by
+ * arena_malloc, while arena_free of a carved array is a no-op.  Re-initializing for a different
+ * number of IVPs then only re-carves the arena (which is reallocated only if it must grow,
+ * or may shrink by more than half), and the device is never reset, such that the library may share
+ * the device (and CUDA context) with other code.
+ *
+ * Requests that do not fit in the arena (or that are made outside of arena_begin / arena_end)
+ * fall back to cudaMalloc, and are freed by cudaFree, hence the arena is never required for correctness.
+ * The number of spilled bytes is reported by arena_footprint, and the next arena_reserve grows
+ * to cover them.
+ *
+ * The arena carved out of is selected per host thread by arena_begin, hence independent
+ * solver instances may be initialized concurrently from separate threads.
+ *
+ * If #MANAGED_MEMORY is defined, the arena and the cudaMalloc fallback are managed allocations
+ * (preferably located on the device), such that the device memory may be oversubscribed.
+ */
+
+#ifndef GPU_ARENA_CUH
+#define GPU_ARENA_CUH
+
+#include <stddef.h>
+#include <cuda_runtime.h>
+#include "solver_options.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The alignment (in bytes) of each array carved out of the arena
+#define ARENA_ALIGNMENT (256)
+//! The maximum number of simultaneously reserved arenas (e.g. one per device and solver instance)
+#define MAX_ARENAS (64)
+
+/**
+ * \brief A device memory arena
+ *
+ * \param           base            The device allocation
+ * \param           capacity        The size of #base (in bytes)
+ * \param           used            The number of bytes carved out of #base since the last arena_begin
+ * \param           spilled         The number of bytes that did not fit, and were allocated by cudaMalloc instead
+ * \param           device          The CUDA device of #base
+ */
+struct gpu_arena {
+    char* base;
+    size_t capacity;
+    size_t used;
+    size_t spilled;
+    int device;
+};
+
+/**
+ * \brief Ensures the arena can hold at least `size` bytes (plus the previous spill) on the current device
+ * \param[in,out]       arena       The arena, zero-initialize before the first call
+ * \param[in]           size        The required size (in bytes)
+ *
+ * The arena is reallocated only if it is too small, more than twice the required size, or on another device.
+ * All previously carved arrays are invalidated.
+ */
+void arena_reserve(gpu_arena* arena, size_t size);
+
+/**
+ * \brief Returns the arena size required by a mechanism_memory and solver_memory set of `padded` threads
+ * \param[in]           padded              The padded number of threads
+ * \param[in]           size_per_thread     The sum of required_mechanism_size() and required_solver_size()
+ *
+ * In addition to the per-thread arrays, room is left for the alignment of (up to 64) arrays, the device
+ * copies of the structs and the single-thread mechanism_memory used in setting up the solver
+ * (e.g. by the sparse LU factorization).
+ */
+inline size_t arena_required_size(const int padded, const size_t size_per_thread)
+{
+    return (padded + 1) * size_per_thread + 64 * ARENA_ALIGNMENT;
+}
+
+/**
+ * \brief Carves subsequent calls to arena_malloc (on this host thread) out of `arena`, starting from its beginning
+ * \param[in,out]       arena       The arena
+ */
+void arena_begin(gpu_arena* arena);
+
+/**
+ * \brief Stops carving out of the current arena of this host thread, subsequent calls to arena_malloc use cudaMalloc
+ */
+void arena_end();
+
+/**
+ * \brief Frees the device allocation of the arena
+ * \param[in,out]       arena       The arena
+ */
+void arena_release(gpu_arena* arena);
+
+/**
+ * \brief Returns the device memory footprint (in bytes) of the arena, i.e. its capacity
+ *        and the bytes spilled to cudaMalloc
+ * \param[in]           arena       The arena
+ */
+size_t arena_footprint(const gpu_arena* arena);
+
+/**
+ * \brief Allocates `size` bytes from the current arena (if any, and if they fit), or by cudaMalloc
+ * \param[out]          ptr         The address of the pointer to allocate
+ * \param[in]           size        The size (in bytes) of the allocation
+ * \return                          The CUDA error code of the allocation
+ */
+cudaError_t arena_malloc(void** ptr, size_t size);
+
+/**
+ * \brief Frees an allocation of arena_malloc, this is a no-op for arrays carved out of any (reserved) arena
+ * \param[in]           ptr         The pointer to free
+ * \return                          The CUDA error code of the deallocation
+ */
+cudaError_t arena_free(void* ptr);
+
+/**
+ * \brief Typed overload of arena_malloc(void**, size_t), analogous to cudaMalloc
+ */
+template <typename T>
+inline cudaError_t arena_malloc(T** ptr, size_t size)
+{
+    return arena_malloc((void**)ptr, size);
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * \file
+ * \brief Implementation of the Hessenberg reduced (compact) linear solves of the GPU Radau-IIa solver
+ *
+ * The shifted Hessenberg systems \f$(\sigma I - H) x = b\f$ are eliminated from the last column to the
+ * first: each step eliminates the subdiagonal entry of row `k` by a column operation between columns
+ * `k - 1` and `k` (interchanging them if the subdiagonal entry is larger, i.e. partial pivoting of
+ * \f$(\sigma I - H)^T\f$), after which column `k` is a final column of the upper triangular factor and
+ * is immediately back substituted.  Hence only the column being eliminated is stored, and the columns
+ * to the left are read from the (unshifted) Hessenberg matrix.  The solution is recovered from the
+ * multipliers and interchanges of the column operations.
+ *
+ * \see hessenberg.cuh
+ */
+
+#include "hessenberg.cuh"
+#include "gpu_macros.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef HESSENBERG_RADAU
+
+__device__
+void hessenberg_reduce(double* __restrict__ A, double* __restrict__ tau) {
+    for (int k = 0; k < NSP - 2; ++k) {
+        // the Householder reflection (I - tau v v^T) that zeros column k below the subdiagonal
+        double alpha = A[INDEX(k + 1 + k * NSP)];
+        double xnorm = 0;
+        for (int i = k + 2; i < NSP; ++i)
+            xnorm += A[INDEX(i + k * NSP)] * A[INDEX(i + k * NSP)];
+        if (xnorm == 0) {
+            tau[INDEX(k)] = 0;
+            continue;
+        }
+        double beta = -copysign(sqrt(alpha * alpha + xnorm), alpha);
+        double t = (beta - alpha) / beta;
+        double scal = 1.0 / (alpha - beta);
+        // store v (with implicit v[k + 1] = 1) below the subdiagonal
+        for (int i = k + 2; i < NSP; ++i)
+            A[INDEX(i + k * NSP)] *= scal;
+        A[INDEX(k + 1 + k * NSP)] = beta;
+        tau[INDEX(k)] = t;
+
+        // A := (I - t v v^T) A, on the trailing columns
+        for (int j = k + 1; j < NSP; ++j) {
+            double s = A[INDEX(k + 1 + j * NSP)];
+            for (int i = k + 2; i < NSP; ++i)
+                s += A[INDEX(i + k * NSP)] * A[INDEX(i + j * NSP)];
+            s *= t;
+            A[INDEX(k + 1 + j * NSP)] -= s;
+            for (int i = k + 2; i < NSP; ++i)
+                A[INDEX(i + j * NSP)] -= s * A[INDEX(i + k * NSP)];
+        }
+        // A := A (I - t v v^T)
+        for (int i = 0; i < NSP; ++i) {
+            double s = A[INDEX(i + (k + 1) * NSP)];
+            for (int j = k + 2; j < NSP; ++j)
+                s += A[INDEX(i + j * NSP)] * A[INDEX(j + k * NSP)];
+            s *= t;
+            A[INDEX(i + (k + 1) * NSP)] -= s;
+            for (int j = k + 2; j < NSP; ++j)
+                A[INDEX(i + j * NSP)] -= s * A[INDEX(j + k * NSP)];
+        }
+    }
+}
+
+__device__
+void hessenberg_apply_Q(const double* __restrict__ A, const double* __restrict__ tau,
+                        const bool transpose, double* __restrict__ b) {
+    // Q = P_0 P_1 ... P_{NSP - 3}, with symmetric reflections P_k
+    for (int step = 0; step < NSP - 2; ++step) {
+        const int k = transpose ? step : NSP - 3 - step;
+        double s = b[INDEX(k + 1)];
+        for (int i = k + 2; i < NSP; ++i)
+            s += A[INDEX(i + k * NSP)] * b[INDEX(i)];
+        s *= tau[INDEX(k)];
+        b[INDEX(k + 1)] -= s;
+        for (int i = k + 2; i < NSP; ++i)
+            b[INDEX(i)] -= s * A[INDEX(i + k * NSP)];
+    }
+}
+
+__device__
+void hessenberg_apply_Q3(const double* __restrict__ A, const double* __restrict__ tau, const bool transpose,
+                         double* __restrict__ b1, double* __restrict__ b2, double* __restrict__ b3) {
+    for (int step = 0; step < NSP - 2; ++step) {
+        const int k = transpose ? step : NSP - 3 - step;
+        double s1 = b1[INDEX(k + 1)];
+        double s2 = b2[INDEX(k + 1)];
+        double s3 = b3[INDEX(k + 1)];
+        for (int i = k + 2; i < NSP; ++i) {
+            double v = A[INDEX(i + k * NSP)];
+            s1 += v * b1[INDEX(i)];
+            s2 += v * b2[INDEX(i)];
+            s3 += v * b3[INDEX(i)];
+        }
+        double t = tau[INDEX(k)];
+        s1 *= t;
+        s2 *= t;
+        s3 *= t;
+        b1[INDEX(k + 1)] -= s1;
+        b2[INDEX(k + 1)] -= s2;
+        b3[INDEX(k + 1)] -= s3;
+        for (int i = k + 2; i < NSP; ++i) {
+            double v = A[INDEX(i + k * NSP)];
+            b1[INDEX(i)] -= s1 * v;
+            b2[INDEX(i)] -= s2 * v;
+            b3[INDEX(i)] -= s3 * v;
+        }
+    }
+}
+
+__device__
+int hessenberg_solve(const double* __restrict__ A, const double sigma, double* __restrict__ b,
+                     double* __restrict__ work, double* __restrict__ mult, int* __restrict__ ipiv) {
+    // the column being eliminated, initially the last column of the shifted matrix
+    double* const __restrict__ v = work;
+    for (int i = 0; i < NSP; ++i)
+        v[INDEX(i)] = -A[INDEX(i + (NSP - 1) * NSP)];
+    v[INDEX(NSP - 1)] += sigma;
+
+    for (int k = NSP - 1; k > 0; --k) {
+        double uk = -A[INDEX(k + (k - 1) * NSP)];
+        double vk = v[INDEX(k)];
+        double x;
+        if (fabs(uk) > fabs(vk)) {
+            // interchange, such that column k - 1 of the shifted matrix is final
+            double m = vk / uk;
+            x = b[INDEX(k)] / uk;
+            for (int i = 0; i < k; ++i) {
+                double a = -A[INDEX(i + (k - 1) * NSP)];
+                if (i == k - 1)
+                    a += sigma;
+                b[INDEX(i)] -= a * x;
+                v[INDEX(i)] -= m * a;
+            }
+            mult[INDEX(k)] = m;
+            ipiv[INDEX(k)] = 1;
+        } else {
+            if (vk == 0)
+                return k + 1;
+            double m = uk / vk;
+            x = b[INDEX(k)] / vk;
+            for (int i = 0; i < k; ++i) {
+                double a = -A[INDEX(i + (k - 1) * NSP)];
+                if (i == k - 1)
+                    a += sigma;
+                b[INDEX(i)] -= v[INDEX(i)] * x;
+                v[INDEX(i)] = a - m * v[INDEX(i)];
+            }
+            mult[INDEX(k)] = m;
+            ipiv[INDEX(k)] = 0;
+        }
+        b[INDEX(k)] = x;
+    }
+    if (v[INDEX(0)] == 0)
+        return 1;
+    b[INDEX(0)] /= v[INDEX(0)];
+
+    // undo the column operations, in the order they were applied to the matrix
+    for (int k = 1; k < NSP; ++k) {
+        b[INDEX(k)] -= mult[INDEX(k)] * b[INDEX(k - 1)];
+        if (ipiv[INDEX(k)]) {
+            double temp = b[INDEX(k)];
+            b[INDEX(k)] = b[INDEX(k - 1)];
+            b[INDEX(k - 1)] = temp;
+        }
+    }
+    return 0;
+}
+
+__device__
+int hessenberg_solve_complex(const double* __restrict__ A, const cuDoubleComplex sigma,
+                             cuDoubleComplex* __restrict__ b, cuDoubleComplex* __restrict__ work,
+                             cuDoubleComplex* __restrict__ mult, int* __restrict__ ipiv) {
+    cuDoubleComplex* const __restrict__ v = work;
+    for (int i = 0; i < NSP; ++i)
+        v[INDEX(i)] = make_cuDoubleComplex(-A[INDEX(i + (NSP - 1) * NSP)], 0);
+    v[INDEX(NSP - 1)] = cuCadd(v[INDEX(NSP - 1)], sigma);
+
+    for (int k = NSP - 1; k > 0; --k) {
+        // the subdiagonal entries of the shifted matrix are real
+        double uk = -A[INDEX(k + (k - 1) * NSP)];
+        cuDoubleComplex vk = v[INDEX(k)];
+        cuDoubleComplex x;
+        if (fabs(uk) > cuCabs(vk)) {
+            cuDoubleComplex m = make_cuDoubleComplex(cuCreal(vk) / uk, cuCimag(vk) / uk);
+            x = make_cuDoubleComplex(cuCreal(b[INDEX(k)]) / uk, cuCimag(b[INDEX(k)]) / uk);
+            for (int i = 0; i < k; ++i) {
+                cuDoubleComplex a = make_cuDoubleComplex(-A[INDEX(i + (k - 1) * NSP)], 0);
+                if (i == k - 1)
+                    a = cuCadd(a, sigma);
+                b[INDEX(i)] = cuCsub(b[INDEX(i)], cuCmul(a, x));
+                v[INDEX(i)] = cuCsub(v[INDEX(i)], cuCmul(m, a));
+            }
+            mult[INDEX(k)] = m;
+            ipiv[INDEX(k)] = 1;
+        } else {
+            if (cuCreal(vk) == 0 && cuCimag(vk) == 0)
+                return k + 1;
+            cuDoubleComplex m = cuCdiv(make_cuDoubleComplex(uk, 0), vk);
+            x = cuCdiv(b[INDEX(k)], vk);
+            for (int i = 0; i < k; ++i) {
+                cuDoubleComplex a = make_cuDoubleComplex(-A[INDEX(i + (k - 1) * NSP)], 0);
+                if (i == k - 1)
+                    a = cuCadd(a, sigma);
+                b[INDEX(i)] = cuCsub(b[INDEX(i)], cuCmul(v[INDEX(i)], x));
+                v[INDEX(i)] = cuCsub(a, cuCmul(m, v[INDEX(i)]));
+            }
+            mult[INDEX(k)] = m;
+            ipiv[INDEX(k)] = 0;
+        }
+        b[INDEX(k)] = x;
+    }
+    if (cuCreal(v[INDEX(0)]) == 0 && cuCimag(v[INDEX(0)]) == 0)
+        return 1;
+    b[INDEX(0)] = cuCdiv(b[INDEX(0)], v[INDEX(0)]);
+
+    for (int k = 1; k < NSP; ++k) {
+        b[INDEX(k)] = cuCsub(b[INDEX(k)], cuCmul(mult[INDEX(k)], b[INDEX(k - 1)]));
+        if (ipiv[INDEX(k)]) {
+            cuDoubleComplex temp = b[INDEX(k)];
+            b[INDEX(k)] = b[INDEX(k - 1)];
+            b[INDEX(k - 1)] = temp;
+        }
+    }
+    return 0;
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
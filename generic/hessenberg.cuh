@@ -0,0 +1,81 @@
+/**
+ * \file
+ * \brief Header definitions for the Hessenberg reduced (compact) linear solves of the GPU Radau-IIa solver
+ *
+ * If #HESSENBERG_RADAU is defined, the Radau-IIa solver never forms (or stores) its real and complex
+ * system matrices \f$\frac{\gamma}{h} I - J\f$ and \f$\frac{\alpha + i \beta}{h} I - J\f$.  Instead, each
+ * Jacobian is reduced once, in place, to the upper Hessenberg form \f$J = Q H Q^T\f$ by Householder
+ * reflections (stored below the subdiagonal, as in LAPACK's dgehrd), such that
+ * \f$\sigma I - J = Q (\sigma I - H) Q^T\f$ for any shift \f$\sigma\f$.  The shifted Hessenberg systems
+ * are eliminated (with column pivoting) within each solve, in \f$O(NSP^2)\f$ operations and
+ * \f$O(NSP)\f$ storage, hence a change of the step size requires no refactorization, and the only
+ * (NSP x NSP) array per thread is the Jacobian itself.
+ *
+ * All arrays keep the column-major, #INDEX strided storage of the solver, `A[INDEX(i + j * NSP)]`.
+ */
+
+#ifndef HESSENBERG_CUH
+#define HESSENBERG_CUH
+
+#include "header.cuh"
+#include "solver_options.cuh"
+#include <cuComplex.h>
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef HESSENBERG_RADAU
+
+/**
+ * \brief Reduces the (NSP x NSP) matrix `A` in place to upper Hessenberg form \f$H = Q^T A Q\f$
+ * \param[in,out]   A           On entry the matrix, on exit \f$H\f$ on and above the subdiagonal,
+ *                              and the Householder vectors of \f$Q\f$ below it
+ * \param[out]      tau         The (NSP) scalar factors of the Householder reflections
+ */
+__device__
+void hessenberg_reduce(double* __restrict__ A, double* __restrict__ tau);
+
+/**
+ * \brief Computes \f$Q^T b\f$ (if `transpose`) or \f$Q b\f$ in place, for the reduction of hessenberg_reduce
+ */
+__device__
+void hessenberg_apply_Q(const double* __restrict__ A, const double* __restrict__ tau,
+                        const bool transpose, double* __restrict__ b);
+
+/**
+ * \brief Computes \f$Q^T b_i\f$ (if `transpose`) or \f$Q b_i\f$ in place for three vectors at once, @see hessenberg_apply_Q
+ */
+__device__
+void hessenberg_apply_Q3(const double* __restrict__ A, const double* __restrict__ tau, const bool transpose,
+                         double* __restrict__ b1, double* __restrict__ b2, double* __restrict__ b3);
+
+/**
+ * \brief Solves \f$(\sigma I - H) x = b\f$ for the Hessenberg matrix of hessenberg_reduce, overwriting `b` with the solution
+ * \param[in]       A           The reduced matrix
+ * \param[in]       sigma       The shift
+ * \param[in,out]   b           The right hand side, and on exit the solution
+ * \param[out]      work        An (NSP) work array
+ * \param[out]      mult        An (NSP) work array, for the multipliers of the elimination
+ * \param[out]      ipiv        An (NSP) work array, for the column interchanges of the elimination
+ * \returns 0 on success, or `k + 1` if the k-th pivot is zero (i.e. the shifted matrix is singular)
+ */
+__device__
+int hessenberg_solve(const double* __restrict__ A, const double sigma, double* __restrict__ b,
+                     double* __restrict__ work, double* __restrict__ mult, int* __restrict__ ipiv);
+
+/**
+ * \brief Solves \f$(\sigma I - H) x = b\f$ for a complex shift and right hand side, @see hessenberg_solve
+ */
+__device__
+int hessenberg_solve_complex(const double* __restrict__ A, const cuDoubleComplex sigma,
+                             cuDoubleComplex* __restrict__ b, cuDoubleComplex* __restrict__ work,
+                             cuDoubleComplex* __restrict__ mult, int* __restrict__ ipiv);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * \file
+ * \brief The host state of a GPU solver instance
+ *
+ * Bundles the per-IVP host storage that is kept between the kernel calls (and integration calls)
+ * of a solver instance: the accumulated statistics, the warm start state, the reordering buffers
+ * and the phase totals.  Each instance (i.e. each accelerInt_context, or the driver of solver_main.cu)
+ * owns its host_state, such that independent instances never share host memory.
+ */
+
+#ifndef HOST_STATE_CUH
+#define HOST_STATE_CUH
+
+#include "solver_options.cuh"
+#include "solver_stats.cuh"
+#include "warm_start.cuh"
+#include "warp_reorder.cuh"
+#include "phase_profile.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+/**
+ * \brief The host state of a GPU solver instance
+ * \param           stats           The accumulated per-IVP statistics
+ * \param           warm            The per-IVP warm start state (if the solver defines SOLVER_WARM_START)
+ * \param           reorder         The reordering buffers, @see warp_reorder_gather
+ * \param           profile         The phase totals, @see accumulate_phase_profile
+ *
+ * Zero-initialize before first use.
+ */
+struct host_state {
+    ivp_statistics stats;
+#ifdef SOLVER_WARM_START
+    warm_start_storage warm;
+#endif
+    warp_reorder_state reorder;
+    phase_totals profile;
+};
+
+/**
+ * \brief Frees the host storage of `state`, which may be reused afterwards
+ * \param[in,out]   state       The host state
+ */
+inline void cleanup_host_state(host_state* state)
+{
+    cleanup_statistics(&state->stats);
+#ifdef SOLVER_WARM_START
+    cleanup_warm_start(&state->warm);
+#endif
+    cleanup_warp_reorder(&state->reorder);
+    reset_phase_profile(&state->profile);
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
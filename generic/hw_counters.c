@@ -0,0 +1,218 @@
+/**
+ * \file
+ * \brief The Linux perf_event_open counters of the CPU benchmark runs, @see hw_counters.h
+ */
+
+//! for syscall()
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hw_counters.h"
+
+#ifdef HW_COUNTERS
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <omp.h>
+#endif
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef HW_COUNTERS
+
+#ifndef HW_FLOP_EVENTS
+    //! The raw floating point events (`config:weight`, comma separated), none by default
+    #define HW_FLOP_EVENTS ""
+#endif
+
+//! The names of the events, in the order of HardwareEvent
+static const char* hw_event_names[HW_FLOP_EVENT] = {"cycles", "instructions", "L1D accesses", "L1D misses",
+                                                    "LLC accesses", "LLC misses"};
+
+//! Returns the generic perf_event_attr type and config of `event`
+static void hw_event_config(const int event, __u32* type, __u64* config)
+{
+    const __u64 cache_access = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16);
+    const __u64 cache_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    *type = PERF_TYPE_HARDWARE;
+    switch (event)
+    {
+        case HW_CYCLES:
+            *config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case HW_INSTRUCTIONS:
+            *config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case HW_L1D_ACCESSES:
+            *type = PERF_TYPE_HW_CACHE;
+            *config = PERF_COUNT_HW_CACHE_L1D | cache_access;
+            break;
+        case HW_L1D_MISSES:
+            *type = PERF_TYPE_HW_CACHE;
+            *config = PERF_COUNT_HW_CACHE_L1D | cache_miss;
+            break;
+        case HW_LLC_ACCESSES:
+            *config = PERF_COUNT_HW_CACHE_REFERENCES;
+            break;
+        case HW_LLC_MISSES:
+            *config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+    }
+}
+
+//! Opens a disabled counter of the calling thread, returns its file descriptor or -1
+static int hw_event_open(const __u32 type, const __u64 config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // the counters may be multiplexed, hence are scaled by their enabled / running times
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+void hw_counters_open(hw_counters* counters, const int num_threads)
+{
+    counters->num_threads = num_threads;
+    counters->num_flop_events = 0;
+    __u64 flop_configs[HW_MAX_FLOP_EVENTS];
+    const char* spec = HW_FLOP_EVENTS;
+    while (*spec != '\0' && counters->num_flop_events < HW_MAX_FLOP_EVENTS)
+    {
+        char* end;
+        flop_configs[counters->num_flop_events] = strtoull(spec, &end, 0);
+        if (end == spec || *end != ':')
+        {
+            printf("Error: HW_FLOP_EVENTS must be a comma separated list of config:weight pairs.\n");
+            exit(-1);
+        }
+        spec = end + 1;
+        counters->flop_weights[counters->num_flop_events++] = strtod(spec, &end);
+        spec = *end == ',' ? end + 1 : end;
+    }
+
+    counters->fds = (int*)malloc(num_threads * HW_MAX_EVENTS * sizeof(int));
+    for (int i = 0; i < num_threads * HW_MAX_EVENTS; ++i)
+        counters->fds[i] = -1;
+    // each thread counts itself, the OpenMP team of the integration is kept alive between parallel regions
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int* fds = &counters->fds[omp_get_thread_num() * HW_MAX_EVENTS];
+        for (int event = 0; event < HW_FLOP_EVENT; ++event)
+        {
+            __u32 type;
+            __u64 config;
+            hw_event_config(event, &type, &config);
+            fds[event] = hw_event_open(type, config);
+        }
+        for (int k = 0; k < counters->num_flop_events; ++k)
+            fds[HW_FLOP_EVENT + k] = hw_event_open(PERF_TYPE_RAW, flop_configs[k]);
+    }
+    for (int event = 0; event < HW_MAX_EVENTS; ++event)
+        counters->counts[event] = event < HW_FLOP_EVENT + counters->num_flop_events ? 0 : -1;
+    for (int i = 0; i < num_threads * HW_MAX_EVENTS; ++i)
+    {
+        int event = i % HW_MAX_EVENTS;
+        if (counters->fds[i] < 0 && counters->counts[event] >= 0)
+        {
+            if (event < HW_FLOP_EVENT)
+                printf("Warning: the %s counter could not be opened, see perf_event_paranoid.\n",
+                       hw_event_names[event]);
+            else
+                printf("Warning: the floating point event %d could not be opened.\n", event - HW_FLOP_EVENT);
+            counters->counts[event] = -1;
+        }
+    }
+}
+
+void hw_counters_start(hw_counters* counters)
+{
+    for (int i = 0; i < counters->num_threads * HW_MAX_EVENTS; ++i)
+    {
+        if (counters->fds[i] < 0)
+            continue;
+        ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void hw_counters_stop(hw_counters* counters)
+{
+    for (int i = 0; i < counters->num_threads * HW_MAX_EVENTS; ++i)
+    {
+        if (counters->fds[i] < 0)
+            continue;
+        ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        // the value, and the times enabled and running
+        __u64 values[3];
+        int event = i % HW_MAX_EVENTS;
+        if (read(counters->fds[i], values, sizeof(values)) != sizeof(values) || counters->counts[event] < 0)
+            continue;
+        if (values[2] > 0)
+            counters->counts[event] += (double)values[0] * (double)values[1] / (double)values[2];
+    }
+}
+
+void hw_counters_summarize(const hw_counters* counters, benchmark_counters* metrics)
+{
+    const double* counts = counters->counts;
+    metrics->flops = counters->num_flop_events > 0 ? 0 : -1;
+    for (int k = 0; k < counters->num_flop_events; ++k)
+    {
+        if (counts[HW_FLOP_EVENT + k] < 0)
+        {
+            metrics->flops = -1;
+            break;
+        }
+        metrics->flops += counters->flop_weights[k] * counts[HW_FLOP_EVENT + k];
+    }
+    metrics->dram_bytes = counts[HW_LLC_MISSES] < 0 ? -1 : counts[HW_LLC_MISSES] * HW_CACHE_LINE;
+    metrics->l1_hit_rate = counts[HW_L1D_ACCESSES] <= 0 || counts[HW_L1D_MISSES] < 0 ? -1 :
+                           1.0 - counts[HW_L1D_MISSES] / counts[HW_L1D_ACCESSES];
+    metrics->l2_hit_rate = counts[HW_LLC_ACCESSES] <= 0 || counts[HW_LLC_MISSES] < 0 ? -1 :
+                           1.0 - counts[HW_LLC_MISSES] / counts[HW_LLC_ACCESSES];
+    metrics->occupancy = -1;
+    metrics->registers = -1;
+    metrics->local_bytes = -1;
+}
+
+void hw_counters_print(const hw_counters* counters, const double ivp_steps)
+{
+    for (int event = 0; event < HW_FLOP_EVENT; ++event)
+    {
+        if (counters->counts[event] >= 0)
+            printf("%s: %.6e (per IVP-step)\n", hw_event_names[event], counters->counts[event] / ivp_steps);
+    }
+    benchmark_counters metrics;
+    hw_counters_summarize(counters, &metrics);
+    if (metrics.flops >= 0 && metrics.dram_bytes > 0)
+        printf("FLOPs: %.6e\tDRAM bytes: %.6e (per IVP-step)\tarithmetic intensity: %.6e (FLOP / byte)\n",
+               metrics.flops / ivp_steps, metrics.dram_bytes / ivp_steps, metrics.flops / metrics.dram_bytes);
+}
+
+void hw_counters_close(hw_counters* counters)
+{
+    for (int i = 0; i < counters->num_threads * HW_MAX_EVENTS; ++i)
+    {
+        if (counters->fds[i] >= 0)
+            close(counters->fds[i]);
+    }
+    free(counters->fds);
+    counters->fds = NULL;
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,104 @@
+/**
+ * \file
+ * \brief Hardware performance counters of the CPU benchmark runs, for the roofline placement of the integrators
+ *
+ * If #HW_COUNTERS is defined, the CPU executables count the cycles, instructions, and L1 data / last level
+ * cache accesses and misses of each OpenMP thread over the timed trials, with the Linux perf_event_open interface.
+ * The floating point operations are the weighted sum of the (model specific) raw events of #HW_FLOP_EVENTS,
+ * a comma separated list of `config:weight` pairs, e.g. for double precision on Intel Skylake
+ * `"0x5301c7:1,0x5304c7:4,0x5310c7:2,0x5340c7:8"` (scalar, 256 bit, 128 bit and 512 bit packed).
+ * The DRAM traffic is estimated as the last level cache misses times the cache line size.
+ * Counters that cannot be opened (e.g. for a restrictive `/proc/sys/kernel/perf_event_paranoid`) are reported
+ * as unavailable.  @see benchmark.h
+ */
+
+#ifndef HW_COUNTERS_H
+#define HW_COUNTERS_H
+
+#include "solver_options.h"
+#include "benchmark.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef HW_COUNTERS
+
+//! The bytes transferred from DRAM per last level cache miss
+#define HW_CACHE_LINE (64)
+//! The maximum number of raw floating point events
+#define HW_MAX_FLOP_EVENTS (8)
+
+/**
+ * \brief The counted events
+ */
+enum HardwareEvent
+{
+    HW_CYCLES = 0,
+    HW_INSTRUCTIONS = 1,
+    HW_L1D_ACCESSES = 2,
+    HW_L1D_MISSES = 3,
+    HW_LLC_ACCESSES = 4,
+    HW_LLC_MISSES = 5,
+    //! the first of the raw floating point events of #HW_FLOP_EVENTS
+    HW_FLOP_EVENT = 6
+};
+
+//! The maximum number of counted events
+#define HW_MAX_EVENTS (HW_FLOP_EVENT + HW_MAX_FLOP_EVENTS)
+
+/**
+ * \brief The counters of a team of OpenMP threads
+ */
+typedef struct
+{
+    int num_threads;
+    //! the number of raw floating point events
+    int num_flop_events;
+    //! the weights of the raw floating point events
+    double flop_weights[HW_MAX_FLOP_EVENTS];
+    //! the counter file descriptors, stored as `fds[thread * HW_MAX_EVENTS + event]`, negative if not opened
+    int* fds;
+    //! the (multiplexing corrected) counts accumulated over the trials, negative if not opened
+    double counts[HW_MAX_EVENTS];
+} hw_counters;
+
+/**
+ * \brief Opens the (disabled) counters on each thread of the OpenMP team of `num_threads` threads
+ */
+void hw_counters_open(hw_counters* counters, const int num_threads);
+
+/**
+ * \brief Resets and enables the counters, called before each timed trial
+ */
+void hw_counters_start(hw_counters* counters);
+
+/**
+ * \brief Disables the counters, and accumulates their counts, called after each timed trial
+ */
+void hw_counters_stop(hw_counters* counters);
+
+/**
+ * \brief Converts the accumulated counts to the benchmark record metrics
+ */
+void hw_counters_summarize(const hw_counters* counters, benchmark_counters* metrics);
+
+/**
+ * \brief Prints the accumulated counts, and the arithmetic intensity
+ * \param[in]       counters    The counters
+ * \param[in]       ivp_steps   The number of IVP-steps of the counted trials, i.e. IVPs * global steps * trials
+ */
+void hw_counters_print(const hw_counters* counters, const double ivp_steps);
+
+/**
+ * \brief Closes the counters
+ */
+void hw_counters_close(hw_counters* counters);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
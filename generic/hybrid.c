@@ -0,0 +1,131 @@
+/**
+ * \file
+ * \brief Classification of the IVPs for the hybrid dispatch of the CPU integration drivers
+ *
+ * Most IVPs of a reacting flow are only mildly stiff, and are integrated more cheaply by the
+ * explicit, stabilized RKC integrator than by the implicit / exponential integrators, which
+ * form and factor (or exponentiate) the Jacobian.  The stiffness of each IVP is measured by the
+ * nonlinear power method of RKC at the start of each global integration step.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+#include "header.h"
+#include "dydt.h"
+#include "hybrid.h"
+#include "state_layout.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef HYBRID_DISPATCH
+
+/**
+ * \brief Returns true if the IVP should be integrated by the stiff integrator
+ * \param[in]       t           The current system time
+ * \param[in]       t_end       The IVP integration end time
+ * \param[in]       pr          The IVP constant variable (presssure/density)
+ * \param[in]       y           The IVP state vector at time t
+ */
+static bool is_stiff(const double t, const double t_end, const double pr, const double* y)
+{
+    double dy[NSP];
+    rkc_real y_r[NSP];
+    rkc_real F[NSP];
+    rkc_real v[NSP];
+    rkc_real Fv[NSP];
+    dydt (t, pr, y, dy);
+    for (int i = 0; i < NSP; ++i)
+    {
+        y_r[i] = (rkc_real)y[i];
+        F[i] = (rkc_real)dy[i];
+    }
+    // the RHS is the initial eigenvector estimate, as in RKC
+    memcpy(v, F, NSP * sizeof(rkc_real));
+    const double h = fabs(t_end - t);
+    return h * rkc_spec_rad (t, pr, (rkc_real)h, y_r, F, v, Fv) > HYBRID_THRESHOLD;
+}
+
+/**
+ * \brief Partitions the IVPs into the stiff and the non-stiff batch
+ * \param[in,out]   storage     The partition arrays
+ * \param[in]       num_threads The number of OpenMP threads used to classify the IVPs
+ * \param[in]       NUM         The number of IVPs
+ * \param[in]       t           The current system time
+ * \param[in]       t_end       The IVP integration end time
+ * \param[in]       t_local     The per-IVP current times, or NULL if all IVPs are at `t`
+ * \param[in]       t_end_local The per-IVP end times, or NULL if all IVPs end at `t_end`
+ * \param[in]       pr_global   The system constant variable (pressures / densities)
+ * \param[in]       y_global    The system state vectors at time t
+ * \param[in]       order       The order in which the IVPs would otherwise be issued, or NULL for the identity
+ * \param[out]      num_stiff   The number of stiff IVPs
+ * \return                      The IVPs of `order`, stiff IVPs first, each batch in the order of `order`
+ */
+const int* hybrid_partition(hybrid_storage* storage, const int num_threads,
+                            const int NUM, const double t, const double t_end,
+                            const double* t_local, const double* t_end_local,
+                            const double* pr_global, const double* y_global,
+                            const int* order, int* num_stiff)
+{
+    if (NUM != storage->size)
+    {
+        cleanup_hybrid(storage);
+        storage->partition = (int*)malloc(NUM * sizeof(int));
+        storage->stiff = (char*)malloc(NUM * sizeof(char));
+        storage->size = NUM;
+    }
+    int* partition = storage->partition;
+    char* stiff = storage->stiff;
+
+    int k;
+    #pragma omp parallel for private(k) num_threads(num_threads)
+    for (k = 0; k < NUM; ++k)
+    {
+        double y_local[NSP];
+        for (int i = 0; i < NSP; ++i)
+        {
+            y_local[i] = y_global[state_index(k, i, NUM)];
+        }
+        stiff[k] = is_stiff(t_local == NULL ? t : t_local[k], t_end_local == NULL ? t_end : t_end_local[k],
+                            pr_global[k], y_local);
+    }
+
+    // stable partition, such that each batch retains the (e.g. cost) ordering
+    int count = 0;
+    for (k = 0; k < NUM; ++k)
+    {
+        int tid = order == NULL ? k : order[k];
+        if (stiff[tid])
+            partition[count++] = tid;
+    }
+    *num_stiff = count;
+    for (k = 0; k < NUM; ++k)
+    {
+        int tid = order == NULL ? k : order[k];
+        if (!stiff[tid])
+            partition[count++] = tid;
+    }
+    return partition;
+}
+
+/**
+ * \brief Frees the partition arrays
+ * \param[in,out]   storage     The partition arrays
+ */
+void cleanup_hybrid(hybrid_storage* storage)
+{
+    free(storage->partition);
+    free(storage->stiff);
+    storage->partition = 0;
+    storage->stiff = 0;
+    storage->size = 0;
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
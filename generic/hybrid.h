@@ -0,0 +1,103 @@
+/**
+ * \file
+ * \brief Header definitions for the hybrid dispatch of the CPU integration drivers
+ *
+ * If #HYBRID is defined, the stiff integrators (Radau-IIa, EXP4 and EXPRB43) are linked with
+ * the RKC integrator.  Before each global integration step, each IVP is classified by the product
+ * of its spectral radius estimate (@see rkc_spec_rad) and the step size: IVPs above #HYBRID_THRESHOLD
+ * are integrated by the stiff integrator, and the others by RKC.
+ */
+
+#ifndef HYBRID_H
+#define HYBRID_H
+
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#if defined(HYBRID) && (defined(RADAU2A) || defined(RB43) || defined(EXP4))
+//! Dispatch the non-stiff IVPs of this (stiff) integrator to RKC
+#define HYBRID_DISPATCH
+#endif
+
+#ifdef HYBRID_DISPATCH
+
+#ifndef HYBRID_THRESHOLD
+//! IVPs with a spectral radius times step size above this are integrated by the stiff integrator
+#define HYBRID_THRESHOLD (1000.0)
+#endif
+
+/**
+ * \brief The RKC integrate method, see rkc.c (renamed in the hybrid build)
+ * \param[in]          t_start             the starting IVP integration time
+ * \param[in]          t_end               the IVP integration endtime
+ * \param[in]          pr                  the IVP constant variable (presssure/density)
+ * \param[in,out]      y                   The IVP state vector at time t_start.
+                                           At end of this function call, the system state at time t_end is stored here
+ */
+int rkc_integrate(const double t_start, const double t_end, const double pr, double* y);
+
+#ifdef RKC_SINGLE
+//! The precision of the RKC state vectors, @see RKC_SINGLE
+typedef float rkc_real;
+#else
+//! The precision of the RKC state vectors
+typedef double rkc_real;
+#endif
+
+/**
+ * \brief The RKC spectral radius estimate, see rkc.c
+ */
+rkc_real rkc_spec_rad (const double, const double, const rkc_real, const rkc_real*, const rkc_real*, rkc_real*, rkc_real*);
+
+/**
+ * \brief The partition arrays of a solver instance
+ * \param           size        The number of IVPs in #partition / #stiff
+ * \param           partition   The partitioned IVP order
+ * \param           stiff       Nonzero for the stiff IVPs
+ *
+ * Zero-initialize before the first call to hybrid_partition.
+ */
+typedef struct
+{
+    int size;
+    int* partition;
+    char* stiff;
+} hybrid_storage;
+
+/**
+ * \brief Partitions the IVPs into the stiff and the non-stiff batch
+ * \param[in,out]   storage     The partition arrays
+ * \param[in]       num_threads The number of OpenMP threads used to classify the IVPs
+ * \param[in]       NUM         The number of IVPs
+ * \param[in]       t           The current system time
+ * \param[in]       t_end       The IVP integration end time
+ * \param[in]       t_local     The per-IVP current times, or NULL if all IVPs are at `t`
+ * \param[in]       t_end_local The per-IVP end times, or NULL if all IVPs end at `t_end`
+ * \param[in]       pr_global   The system constant variable (pressures / densities)
+ * \param[in]       y_global    The system state vectors at time t
+ * \param[in]       order       The order in which the IVPs would otherwise be issued, or NULL for the identity
+ * \param[out]      num_stiff   The number of stiff IVPs
+ * \return                      The IVPs of `order`, stiff IVPs first, each batch in the order of `order`
+ */
+const int* hybrid_partition(hybrid_storage* storage, const int num_threads,
+                            const int NUM, const double t, const double t_end,
+                            const double* t_local, const double* t_end_local,
+                            const double* pr_global, const double* y_global,
+                            const int* order, int* num_stiff);
+
+/**
+ * \brief Frees the partition arrays
+ * \param[in,out]   storage     The partition arrays
+ */
+void cleanup_hybrid(hybrid_storage* storage);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * \file
+ * \brief Runtime dispatch of the CPU integrators between ISA-specific builds, @see isa_dispatch.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "isa_dispatch.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+//! The names of the ISA levels, as accepted by the `ACCELERINT_ISA` environment variable
+static const char* isa_names[] = {"baseline", "avx2", "avx512"};
+
+//! The selected ISA level
+static isa_level selected_isa = ISA_LEVEL_BASELINE;
+
+//! Guards the (process-wide) selection
+static pthread_once_t isa_once = PTHREAD_ONCE_INIT;
+
+#ifdef ISA_DISPATCHED
+
+#ifdef ISA_AVX2
+int integrate_isa_avx2(const double t_start, const double t_end, const double pr, double* y);
+#if defined(SIMD_LANES) && defined(LANE_INTEGRATOR)
+void integrate_lanes_isa_avx2(const double t_start, const double t_end, const int num_lanes, const double* pr,
+                              double* y, int* result);
+#endif
+#endif
+#ifdef ISA_AVX512
+int integrate_isa_avx512(const double t_start, const double t_end, const double pr, double* y);
+#if defined(SIMD_LANES) && defined(LANE_INTEGRATOR)
+void integrate_lanes_isa_avx512(const double t_start, const double t_end, const int num_lanes, const double* pr,
+                                double* y, int* result);
+#endif
+#endif
+
+int (*isa_integrate)(const double t_start, const double t_end, const double pr, double* y) = integrate;
+#if defined(SIMD_LANES) && defined(LANE_INTEGRATOR)
+void (*isa_integrate_lanes)(const double t_start, const double t_end, const int num_lanes, const double* pr,
+                            double* y, int* result) = integrate_lanes;
+#endif
+
+/**
+ * \brief Returns true if the CPU supports the ISA level `level`
+ */
+static int cpu_supports(const isa_level level)
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+    __builtin_cpu_init();
+    const int avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+                     __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2");
+    switch (level)
+    {
+        case ISA_LEVEL_AVX2:
+            return avx2;
+        case ISA_LEVEL_AVX512:
+            return avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd") &&
+                   __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") &&
+                   __builtin_cpu_supports("avx512vl");
+        default:
+            return 1;
+    }
+#else
+    return level == ISA_LEVEL_BASELINE;
+#endif
+}
+
+#endif
+
+/**
+ * \brief Selects the ISA level and sets the dispatched methods, @see select_isa
+ */
+static void select_isa_once(void)
+{
+#ifdef ISA_DISPATCHED
+    // the cap of the environment, if any
+    isa_level cap = ISA_LEVEL_AVX512;
+    const char* env = getenv("ACCELERINT_ISA");
+    if (env != NULL && env[0] != '\0')
+    {
+        int found = 0;
+        for (int level = ISA_LEVEL_BASELINE; level <= ISA_LEVEL_AVX512; ++level)
+        {
+            if (strcmp(env, isa_names[level]) == 0)
+            {
+                cap = (isa_level)level;
+                found = 1;
+            }
+        }
+        if (!found)
+            printf("Warning: unknown ACCELERINT_ISA %s, ignored.\n", env);
+    }
+#ifdef ISA_AVX512
+    if (selected_isa == ISA_LEVEL_BASELINE && cap >= ISA_LEVEL_AVX512 && cpu_supports(ISA_LEVEL_AVX512))
+    {
+        selected_isa = ISA_LEVEL_AVX512;
+        isa_integrate = integrate_isa_avx512;
+#if defined(SIMD_LANES) && defined(LANE_INTEGRATOR)
+        isa_integrate_lanes = integrate_lanes_isa_avx512;
+#endif
+    }
+#endif
+#ifdef ISA_AVX2
+    if (selected_isa == ISA_LEVEL_BASELINE && cap >= ISA_LEVEL_AVX2 && cpu_supports(ISA_LEVEL_AVX2))
+    {
+        selected_isa = ISA_LEVEL_AVX2;
+        isa_integrate = integrate_isa_avx2;
+#if defined(SIMD_LANES) && defined(LANE_INTEGRATOR)
+        isa_integrate_lanes = integrate_lanes_isa_avx2;
+#endif
+    }
+#endif
+#endif
+}
+
+/**
+ * \brief Selects (once per process) the highest built ISA level supported by the CPU, and returns it
+ *
+ * Called by initialize_context, i.e. before the first integration of any solver instance.
+ */
+isa_level select_isa(void)
+{
+    pthread_once(&isa_once, select_isa_once);
+    return selected_isa;
+}
+
+/**
+ * \brief Returns the name of the selected ISA level
+ */
+const char* isa_name(void)
+{
+    return isa_names[select_isa()];
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
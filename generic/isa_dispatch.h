@@ -0,0 +1,68 @@
+/**
+ * \file
+ * \brief Header definitions for the runtime dispatch of the CPU integrators between ISA-specific builds
+ *
+ * If #ISA_DISPATCH is defined, the build compiles the hot translation units of the Radau-IIa, EXP4, EXPRB43
+ * and RKC integrators (the integrator, its linear algebra and the mechanism `dydt` / `eval_jacob` objects) once
+ * more for each of the ISA levels of the `ISA_LEVELS` build option, in addition to the baseline build.  The
+ * global functions of each copy are suffixed by its level (e.g. `integrate_isa_avx2`), and its global variables
+ * are bound to those of the baseline build, @see SConstruct.
+ *
+ * select_isa picks the highest level the CPU supports when a solver instance is initialized (i.e. by
+ * accelerInt_initialize, accelerInt_create or the main files), and intDriver calls the integrator of that level
+ * through #isa_integrate.  The `ACCELERINT_ISA` environment variable (`baseline`, `avx2` or `avx512`) caps the
+ * selected level.  The RKC integrator of the #HYBRID dispatch is not dispatched.
+ */
+
+#ifndef ISA_DISPATCH_H
+#define ISA_DISPATCH_H
+
+#include "solver.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#if defined(ISA_DISPATCH) && (defined(RADAU2A) || defined(EXP4) || defined(RB43) || defined(RKC))
+    //! The integrator of this build has ISA-specific builds
+    #define ISA_DISPATCHED
+#endif
+
+/**
+ * \brief The ISA levels of the dispatched integrators
+ */
+typedef enum
+{
+    //! the baseline build
+    ISA_LEVEL_BASELINE = 0,
+    //! AVX2 / FMA (x86-64-v3, Haswell and later)
+    ISA_LEVEL_AVX2 = 1,
+    //! AVX-512 F / CD / BW / DQ / VL (x86-64-v4, Skylake-SP and later)
+    ISA_LEVEL_AVX512 = 2
+} isa_level;
+
+#ifdef ISA_DISPATCHED
+//! The integrate method of the selected ISA level, @see select_isa
+extern int (*isa_integrate)(const double t_start, const double t_end, const double pr, double* y);
+#if defined(SIMD_LANES) && defined(LANE_INTEGRATOR)
+//! The integrate_lanes method of the selected ISA level, @see select_isa
+extern void (*isa_integrate_lanes)(const double t_start, const double t_end, const int num_lanes, const double* pr,
+                                   double* y, int* result);
+#endif
+#endif
+
+/**
+ * \brief Selects (once per process) the highest built ISA level supported by the CPU, and returns it
+ */
+isa_level select_isa(void);
+
+/**
+ * \brief Returns the name of the selected ISA level
+ */
+const char* isa_name(void);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,759 @@
+/**
+ * \file
+ * \brief In-situ adaptive tabulation (ISAT) of the CPU library interface, @see isat.h
+ */
+
+//! for the POSIX read-write lock
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <pthread.h>
+#include "header.h"
+#include "dydt.h"
+#include "jacob.h"
+#include "sparse_jacobian.h"
+#include "isat.h"
+#include "state_layout.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef ISAT
+
+/**
+ * \brief The table, @see isat.h
+ *
+ * A child of a node is a node if non-negative, otherwise the entry `-child - 1`.
+ */
+struct isat_table
+{
+    //! the number of solver instances sharing the table
+    int references;
+    //! the maximum number of entries
+    int capacity;
+    //! the number of entries
+    int num_entries;
+    //! the query point of each entry (#ISAT_DIM per entry)
+    double* phi;
+    //! the result of each entry (NSP per entry)
+    double* r;
+    //! the mapping gradient of each entry (NSP x #ISAT_DIM per entry, column-major)
+    double* A;
+    //! the EOA of each entry (#ISAT_DIM x #ISAT_DIM per entry, column-major)
+    double* M;
+    //! the node each entry is a child of, -1 for the root
+    int* entry_parent;
+    //! true if the entry is in use
+    int* in_use;
+    //! true if the entry was retrieved since the last sweep of the clock hand
+    int* referenced;
+    //! incremented as an entry is evicted, such that stale references of a batch are detected
+    int* stamp;
+    //! the unused entries
+    int* free_entries;
+    int num_free_entries;
+    //! the cutting plane normal of each node (#ISAT_DIM per node)
+    double* v;
+    //! the cutting plane offset of each node
+    double* a;
+    //! the children of each node, the right child holds the query points with `v.phi > a`
+    int* left;
+    int* right;
+    //! the parent of each node, -1 for the root
+    int* node_parent;
+    //! the unused nodes
+    int* free_nodes;
+    int num_free_nodes;
+    //! the root (a node or an entry), if #num_entries is non-zero
+    int root;
+    //! the clock hand of the eviction
+    int hand;
+    //! the cumulative statistics, @see IsatStatisticIndex
+    long stats[NUM_ISAT_STATS];
+    //! guards the table, queries hold the read lock and updates the write lock
+    pthread_rwlock_t lock;
+};
+
+//! The child encoding of entry `e`
+#define ISAT_LEAF(e) (-(e) - 1)
+
+//! The action of a miss in isat_update
+enum { ISAT_NONE = 0, ISAT_GROW = 1, ISAT_ADD = 2 };
+
+/**
+ * \brief Allocates `count` entries of `size` bytes, or exits
+ */
+static void* isat_alloc(const size_t count, const size_t size)
+{
+    void* ptr = malloc(count * size);
+    if (ptr == NULL)
+    {
+        printf("Error: could not allocate the ISAT table.\n");
+        exit(-1);
+    }
+    return ptr;
+}
+
+/**
+ * \brief Creates an empty table of (at most) #ISAT_MEMORY MB
+ */
+isat_table* create_isat(void)
+{
+    isat_table* table = (isat_table*)isat_alloc(1, sizeof(isat_table));
+    memset(table, 0, sizeof(isat_table));
+    // an entry and a node per leaf
+    const size_t entry_bytes = (ISAT_DIM + NSP + (size_t)NSP * ISAT_DIM + (size_t)ISAT_DIM * ISAT_DIM) * sizeof(double)
+                               + 5 * sizeof(int) + (ISAT_DIM + 1) * sizeof(double) + 4 * sizeof(int);
+    const size_t capacity = ((size_t)ISAT_MEMORY << 20) / entry_bytes;
+    table->capacity = capacity < 1 ? 1 : (capacity > (1 << 30) ? (1 << 30) : (int)capacity);
+    const size_t cap = table->capacity;
+    table->phi = (double*)isat_alloc(cap * ISAT_DIM, sizeof(double));
+    table->r = (double*)isat_alloc(cap * NSP, sizeof(double));
+    table->A = (double*)isat_alloc(cap * NSP * ISAT_DIM, sizeof(double));
+    table->M = (double*)isat_alloc(cap * ISAT_DIM * ISAT_DIM, sizeof(double));
+    table->entry_parent = (int*)isat_alloc(cap, sizeof(int));
+    table->in_use = (int*)isat_alloc(cap, sizeof(int));
+    table->referenced = (int*)isat_alloc(cap, sizeof(int));
+    table->stamp = (int*)isat_alloc(cap, sizeof(int));
+    table->free_entries = (int*)isat_alloc(cap, sizeof(int));
+    table->v = (double*)isat_alloc(cap * ISAT_DIM, sizeof(double));
+    table->a = (double*)isat_alloc(cap, sizeof(double));
+    table->left = (int*)isat_alloc(cap, sizeof(int));
+    table->right = (int*)isat_alloc(cap, sizeof(int));
+    table->node_parent = (int*)isat_alloc(cap, sizeof(int));
+    table->free_nodes = (int*)isat_alloc(cap, sizeof(int));
+    memset(table->in_use, 0, cap * sizeof(int));
+    memset(table->referenced, 0, cap * sizeof(int));
+    memset(table->stamp, 0, cap * sizeof(int));
+    // pop the lowest indices first
+    for (int i = 0; i < table->capacity; ++i)
+    {
+        table->free_entries[i] = table->capacity - 1 - i;
+        table->free_nodes[i] = table->capacity - 1 - i;
+    }
+    table->num_free_entries = table->capacity;
+    table->num_free_nodes = table->capacity;
+    table->references = 1;
+    pthread_rwlock_init(&table->lock, NULL);
+    return table;
+}
+
+/**
+ * \brief Adds a reference to `table`, and returns it
+ */
+isat_table* share_isat(isat_table* table)
+{
+    pthread_rwlock_wrlock(&table->lock);
+    table->references++;
+    pthread_rwlock_unlock(&table->lock);
+    return table;
+}
+
+/**
+ * \brief Removes a reference to `table`, and frees it once unreferenced
+ */
+void release_isat(isat_table* table)
+{
+    if (table == NULL)
+        return;
+    pthread_rwlock_wrlock(&table->lock);
+    const int references = --table->references;
+    pthread_rwlock_unlock(&table->lock);
+    if (references > 0)
+        return;
+    pthread_rwlock_destroy(&table->lock);
+    free(table->phi);
+    free(table->r);
+    free(table->A);
+    free(table->M);
+    free(table->entry_parent);
+    free(table->in_use);
+    free(table->referenced);
+    free(table->stamp);
+    free(table->free_entries);
+    free(table->v);
+    free(table->a);
+    free(table->left);
+    free(table->right);
+    free(table->node_parent);
+    free(table->free_nodes);
+    free(table);
+}
+
+/**
+ * \brief Returns the entry whose leaf the query point `phi` falls in, the table must not be empty
+ */
+static int isat_find_leaf(const isat_table* table, const double* phi)
+{
+    int child = table->root;
+    while (child >= 0)
+    {
+        const double* v = &table->v[(size_t)child * ISAT_DIM];
+        double dot = 0;
+        for (int j = 0; j < ISAT_DIM; ++j)
+            dot += v[j] * phi[j];
+        child = dot > table->a[child] ? table->right[child] : table->left[child];
+    }
+    return -child - 1;
+}
+
+/**
+ * \brief Returns \f$\delta^T M \delta\f$ of entry `e`, with \f$\delta = \phi - \phi_0\f$ stored in `delta`
+ */
+static double isat_distance(const isat_table* table, const int e, const double* phi, double* delta)
+{
+    const double* phi0 = &table->phi[(size_t)e * ISAT_DIM];
+    const double* M = &table->M[(size_t)e * ISAT_DIM * ISAT_DIM];
+    for (int j = 0; j < ISAT_DIM; ++j)
+        delta[j] = phi[j] - phi0[j];
+    double dist = 0;
+    for (int j = 0; j < ISAT_DIM; ++j)
+    {
+        double Md = 0;
+        for (int k = 0; k < ISAT_DIM; ++k)
+            Md += M[j + (size_t)k * ISAT_DIM] * delta[k];
+        dist += delta[j] * Md;
+    }
+    return dist;
+}
+
+/**
+ * \brief Stores the linear approximation \f$R(\phi_0) + A \delta\f$ of entry `e` in `y`
+ */
+static void isat_retrieve(const isat_table* table, const int e, const double* delta, double* y)
+{
+    const double* r = &table->r[(size_t)e * NSP];
+    const double* A = &table->A[(size_t)e * NSP * ISAT_DIM];
+    for (int i = 0; i < NSP; ++i)
+        y[i] = r[i];
+    for (int j = 0; j < ISAT_DIM; ++j)
+    {
+        for (int i = 0; i < NSP; ++i)
+            y[i] += A[i + (size_t)j * NSP] * delta[j];
+    }
+}
+
+/**
+ * \brief (Re)allocates the workspace for NUM IVPs
+ */
+static void resize_isat_batch(isat_batch* batch, const int NUM)
+{
+    if (NUM <= batch->size)
+        return;
+    cleanup_isat_batch(batch);
+    batch->leaf = (int*)isat_alloc(NUM, sizeof(int));
+    batch->stamp = (int*)isat_alloc(NUM, sizeof(int));
+    batch->miss = (int*)isat_alloc(NUM, sizeof(int));
+    batch->y = (double*)isat_alloc(state_size(NUM), sizeof(double));
+    batch->y0 = (double*)isat_alloc(state_size(NUM), sizeof(double));
+    batch->var = (double*)isat_alloc(NUM, sizeof(double));
+    batch->size = NUM;
+}
+
+/**
+ * \brief Frees the workspace of a solver instance
+ */
+void cleanup_isat_batch(isat_batch* batch)
+{
+    free(batch->leaf);
+    free(batch->stamp);
+    free(batch->miss);
+    free(batch->y);
+    free(batch->y0);
+    free(batch->var);
+    memset(batch, 0, sizeof(isat_batch));
+}
+
+/**
+ * \brief Retrieves the IVPs inside the EOA of an entry, and compacts the others into the workspace
+ * \param[in,out]   table           The table
+ * \param[in,out]   batch           The workspace of the solver instance
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       dt              The step size, i.e. `t_end - t_start`
+ * \param[in,out]   y_host          The state vectors at the start of the step, the retrieved IVPs are set to the end of the step
+ * \param[in]       var_host        The parameters
+ * \param[in]       num_threads     The number of OpenMP threads
+ * \return                          The number of misses, integrated in place in `batch->y` with the parameters `batch->var`
+ */
+int isat_query(isat_table* table, isat_batch* batch, const int NUM, const double dt, double* y_host,
+               const double* var_host, const int num_threads)
+{
+    resize_isat_batch(batch, NUM);
+    long retrieved = 0;
+    pthread_rwlock_rdlock(&table->lock);
+    if (table->num_entries > 0)
+    {
+        int tid;
+        #pragma omp parallel for private(tid) reduction(+:retrieved) num_threads(num_threads)
+        for (tid = 0; tid < NUM; ++tid)
+        {
+            double phi[ISAT_DIM];
+            double delta[ISAT_DIM];
+            for (int i = 0; i < NSP; ++i)
+                phi[i] = y_host[state_index(tid, i, NUM)];
+            phi[NSP] = var_host[tid];
+            phi[NSP + 1] = dt;
+            const int e = isat_find_leaf(table, phi);
+            if (isat_distance(table, e, phi, delta) <= 1.0)
+            {
+                double y[NSP];
+                isat_retrieve(table, e, delta, y);
+                for (int i = 0; i < NSP; ++i)
+                    y_host[state_index(tid, i, NUM)] = y[i];
+                #pragma omp atomic write
+                table->referenced[e] = 1;
+                batch->leaf[tid] = -2;
+                retrieved++;
+            }
+            else
+            {
+                batch->leaf[tid] = e;
+                batch->stamp[tid] = table->stamp[e];
+            }
+        }
+    }
+    else
+    {
+        for (int tid = 0; tid < NUM; ++tid)
+            batch->leaf[tid] = -1;
+    }
+    // concurrent queries hold the read lock
+    #pragma omp atomic
+    table->stats[ISAT_QUERIES] += NUM;
+    #pragma omp atomic
+    table->stats[ISAT_RETRIEVES] += retrieved;
+    pthread_rwlock_unlock(&table->lock);
+
+    // compact the misses
+    int num_miss = 0;
+    for (int tid = 0; tid < NUM; ++tid)
+    {
+        if (batch->leaf[tid] != -2)
+            batch->miss[num_miss++] = tid;
+    }
+    batch->num_miss = num_miss;
+    int m;
+    #pragma omp parallel for private(m) num_threads(num_threads)
+    for (m = 0; m < num_miss; ++m)
+    {
+        const int tid = batch->miss[m];
+        for (int i = 0; i < NSP; ++i)
+        {
+            batch->y[state_index(m, i, num_miss)] = y_host[state_index(tid, i, NUM)];
+            batch->y0[state_index(m, i, num_miss)] = y_host[state_index(tid, i, NUM)];
+        }
+        batch->var[m] = var_host[tid];
+    }
+    return num_miss;
+}
+
+/**
+ * \brief Returns the maximum error of the linear approximation of entry `e` at `phi`, relative to the tolerances
+ */
+static double isat_error(const isat_table* table, const int e, const double* phi, const double* y)
+{
+    double delta[ISAT_DIM];
+    double approx[NSP];
+    isat_distance(table, e, phi, delta);
+    isat_retrieve(table, e, delta, approx);
+    double err = 0;
+    for (int i = 0; i < NSP; ++i)
+        err = fmax(err, fabs(approx[i] - y[i]) / (ISAT_ATOL + ISAT_RTOL * fabs(y[i])));
+    return err;
+}
+
+/**
+ * \brief Grows the EOA of entry `e` to the smallest ellipsoid (of the rank-one updates) that also holds `phi`
+ *
+ * \f$M' = M - \frac{s - 1}{s^2} (M \delta)(M \delta)^T\f$, with \f$s = \delta^T M \delta > 1\f$, such that
+ * \f$\delta^T M' \delta = 1\f$, and the EOA is unchanged in the directions M-orthogonal to \f$\delta\f$.
+ */
+static void isat_grow(isat_table* table, const int e, const double* phi)
+{
+    double delta[ISAT_DIM];
+    double Md[ISAT_DIM];
+    const double s = isat_distance(table, e, phi, delta);
+    if (s <= 1.0)
+        return;
+    double* M = &table->M[(size_t)e * ISAT_DIM * ISAT_DIM];
+    for (int j = 0; j < ISAT_DIM; ++j)
+    {
+        Md[j] = 0;
+        for (int k = 0; k < ISAT_DIM; ++k)
+            Md[j] += M[j + (size_t)k * ISAT_DIM] * delta[k];
+    }
+    const double c = (s - 1.0) / (s * s);
+    for (int k = 0; k < ISAT_DIM; ++k)
+    {
+        for (int j = 0; j < ISAT_DIM; ++j)
+            M[j + (size_t)k * ISAT_DIM] -= c * Md[j] * Md[k];
+    }
+}
+
+/**
+ * \brief Sets the parent of the child `child` (a node or an entry)
+ */
+static void isat_set_parent(isat_table* table, const int child, const int parent)
+{
+    if (child >= 0)
+        table->node_parent[child] = parent;
+    else
+        table->entry_parent[-child - 1] = parent;
+}
+
+/**
+ * \brief Replaces the child `old_child` of node `parent` (or the root if -1) by `new_child`
+ */
+static void isat_replace_child(isat_table* table, const int parent, const int old_child, const int new_child)
+{
+    if (parent < 0)
+        table->root = new_child;
+    else if (table->left[parent] == old_child)
+        table->left[parent] = new_child;
+    else
+        table->right[parent] = new_child;
+    isat_set_parent(table, new_child, parent);
+}
+
+/**
+ * \brief Removes entry `e` from the tree and frees it
+ */
+static void isat_evict(isat_table* table, const int e)
+{
+    const int parent = table->entry_parent[e];
+    if (parent >= 0)
+    {
+        // the sibling takes the place of the parent
+        const int sibling = table->left[parent] == ISAT_LEAF(e) ? table->right[parent] : table->left[parent];
+        isat_replace_child(table, table->node_parent[parent], parent, sibling);
+        table->free_nodes[table->num_free_nodes++] = parent;
+    }
+    table->in_use[e] = 0;
+    table->stamp[e]++;
+    table->free_entries[table->num_free_entries++] = e;
+    table->num_entries--;
+    table->stats[ISAT_EVICTIONS]++;
+}
+
+/**
+ * \brief Returns an unused entry, evicting the first entry the clock hand finds unreferenced if the table is full
+ *
+ * The entry is in use once inserted, such that the entries allocated by the same update are not evicted.
+ */
+static int isat_allocate_entry(isat_table* table)
+{
+    if (table->num_free_entries == 0)
+    {
+        while (!table->in_use[table->hand] || table->referenced[table->hand])
+        {
+            table->referenced[table->hand] = 0;
+            table->hand = (table->hand + 1) % table->capacity;
+        }
+        isat_evict(table, table->hand);
+        table->hand = (table->hand + 1) % table->capacity;
+    }
+    return table->free_entries[--table->num_free_entries];
+}
+
+/**
+ * \brief Inserts the (computed) entry `e` into the tree
+ *
+ * The leaf of the closest entry is split by the plane bisecting the query points in the EOA metric of that entry.
+ */
+static void isat_insert(isat_table* table, const int e)
+{
+    const double* phi = &table->phi[(size_t)e * ISAT_DIM];
+    if (table->num_entries == 0)
+    {
+        table->root = ISAT_LEAF(e);
+        table->entry_parent[e] = -1;
+    }
+    else
+    {
+        const int sibling = isat_find_leaf(table, phi);
+        const double* phi0 = &table->phi[(size_t)sibling * ISAT_DIM];
+        const double* M = &table->M[(size_t)sibling * ISAT_DIM * ISAT_DIM];
+        const int node = table->free_nodes[--table->num_free_nodes];
+        double* v = &table->v[(size_t)node * ISAT_DIM];
+        double a = 0;
+        for (int j = 0; j < ISAT_DIM; ++j)
+        {
+            v[j] = 0;
+            for (int k = 0; k < ISAT_DIM; ++k)
+                v[j] += M[j + (size_t)k * ISAT_DIM] * (phi[k] - phi0[k]);
+            a += v[j] * 0.5 * (phi[j] + phi0[j]);
+        }
+        table->a[node] = a;
+        isat_replace_child(table, table->entry_parent[sibling], ISAT_LEAF(sibling), node);
+        table->left[node] = ISAT_LEAF(sibling);
+        table->right[node] = ISAT_LEAF(e);
+        table->entry_parent[sibling] = node;
+        table->entry_parent[e] = node;
+    }
+    table->in_use[e] = 1;
+    table->referenced[e] = 0;
+    table->num_entries++;
+    table->stats[ISAT_ADDS]++;
+}
+
+/**
+ * \brief Stores \f$C = A B\f$ of the (n x n, column-major) matrices
+ */
+static void isat_matmul(const int n, const double* A, const double* B, double* C)
+{
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n; ++i)
+            C[i + j * n] = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            const double b = B[k + j * n];
+            for (int i = 0; i < n; ++i)
+                C[i + j * n] += A[i + k * n] * b;
+        }
+    }
+}
+
+/**
+ * \brief Stores the exponential of the (n x n, column-major) matrix `B` in `E`, by Taylor scaling and squaring
+ * \param[in]       n               The size of the matrices
+ * \param[in,out]   B               The matrix, scaled in place
+ * \param[out]      E               The exponential
+ * \param[in]       work            Two n x n work arrays
+ */
+static void isat_expm(const int n, double* B, double* E, double* work)
+{
+    double norm = 0;
+    for (int j = 0; j < n; ++j)
+    {
+        double sum = 0;
+        for (int i = 0; i < n; ++i)
+            sum += fabs(B[i + j * n]);
+        norm = fmax(norm, sum);
+    }
+    int squarings = 0;
+    while (norm > 0.5)
+    {
+        norm *= 0.5;
+        squarings++;
+    }
+    const double scale = ldexp(1.0, -squarings);
+    for (int i = 0; i < n * n; ++i)
+        B[i] *= scale;
+
+    double* term = work;
+    double* next = &work[n * n];
+    for (int i = 0; i < n * n; ++i)
+        E[i] = term[i] = 0;
+    for (int i = 0; i < n; ++i)
+        E[i + i * n] = term[i + i * n] = 1;
+    // ||B|| <= 1/2, hence 18 terms reach the double precision round-off
+    for (int k = 1; k <= 18; ++k)
+    {
+        isat_matmul(n, term, B, next);
+        double term_norm = 0;
+        for (int i = 0; i < n * n; ++i)
+        {
+            term[i] = next[i] / k;
+            E[i] += term[i];
+            term_norm = fmax(term_norm, fabs(term[i]));
+        }
+        if (term_norm < DBL_EPSILON)
+            break;
+    }
+    for (int s = 0; s < squarings; ++s)
+    {
+        isat_matmul(n, E, E, next);
+        memcpy(E, next, (size_t)n * n * sizeof(double));
+    }
+}
+
+/**
+ * \brief Computes the result, mapping gradient and initial EOA of entry `e` at the query point `phi` with result `y`
+ */
+static void isat_compute_entry(isat_table* table, const int e, const double* phi, const double* y)
+{
+    const int n = NSP + 1;
+    const double pr = phi[NSP];
+    const double dt = phi[NSP + 1];
+    double* aug = (double*)isat_alloc((size_t)4 * n * n + (size_t)JAC_SIZE, sizeof(double));
+    double* E = &aug[(size_t)n * n];
+    double* work = &aug[(size_t)2 * n * n];
+    double* jac = &aug[(size_t)4 * n * n];
+    double f[NSP], f_pr[NSP];
+    memset(aug, 0, (size_t)n * n * sizeof(double));
+
+    // the augmented Jacobian [J, df/dpr; 0, 0] * dt, averaged over the start and end of the step
+    const double dpr = sqrt(DBL_EPSILON) * fmax(fabs(pr), 1.0);
+    for (int s = 0; s < 2; ++s)
+    {
+        const double* ys = s == 0 ? phi : y;
+        eval_jacob(0, pr, ys, jac);
+        dydt(0, pr, ys, f);
+        dydt(0, pr + dpr, ys, f_pr);
+        jacobian_scatter_add(jac, 0.5 * dt, aug, n);
+        for (int i = 0; i < NSP; ++i)
+            aug[i + NSP * n] += 0.5 * dt * (f_pr[i] - f[i]) / dpr;
+    }
+    isat_expm(n, aug, E, work);
+
+    double* A = &table->A[(size_t)e * NSP * ISAT_DIM];
+    for (int j = 0; j <= NSP; ++j)
+    {
+        for (int i = 0; i < NSP; ++i)
+            A[i + (size_t)j * NSP] = E[i + j * n];
+    }
+    // dR/d(dt) = f(R)
+    dydt(0, pr, y, f);
+    for (int i = 0; i < NSP; ++i)
+        A[i + (size_t)(NSP + 1) * NSP] = f[i];
+    memcpy(&table->phi[(size_t)e * ISAT_DIM], phi, ISAT_DIM * sizeof(double));
+    memcpy(&table->r[(size_t)e * NSP], y, NSP * sizeof(double));
+
+    // M = (W A)^T (W A) + D, i.e. the linear change is within the tolerances
+    double* M = &table->M[(size_t)e * ISAT_DIM * ISAT_DIM];
+    double w[NSP];
+    for (int i = 0; i < NSP; ++i)
+        w[i] = 1.0 / (ISAT_ATOL + ISAT_RTOL * fabs(y[i]));
+    for (int k = 0; k < ISAT_DIM; ++k)
+    {
+        for (int j = 0; j <= k; ++j)
+        {
+            double sum = 0;
+            for (int i = 0; i < NSP; ++i)
+                sum += w[i] * w[i] * A[i + (size_t)j * NSP] * A[i + (size_t)k * NSP];
+            M[j + (size_t)k * ISAT_DIM] = sum;
+            M[k + (size_t)j * ISAT_DIM] = sum;
+        }
+    }
+    // bound the EOA to a relative neighbourhood of the query point
+    for (int j = 0; j < ISAT_DIM; ++j)
+    {
+        double radius = ISAT_MAX_RADIUS * fabs(phi[j]);
+        if (j < NSP)
+            radius += ISAT_MAX_RADIUS * ISAT_ATOL / ISAT_RTOL;
+        else if (radius == 0)
+            radius = ISAT_MAX_RADIUS;
+        M[j + (size_t)j * ISAT_DIM] += 1.0 / (radius * radius);
+    }
+    free(aug);
+}
+
+/**
+ * \brief Copies the integrated misses to the state vectors, and grows or adds the table entries
+ * \param[in,out]   table           The table
+ * \param[in]       batch           The workspace of the solver instance, with the integrated misses
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       dt              The step size, i.e. `t_end - t_start`
+ * \param[in,out]   y_host          The state vectors, the misses are set to the end of the step
+ * \param[in]       codes           The (num_miss) error codes of the misses (which are not tabulated if non-zero), or NULL
+ * \param[in]       num_threads     The number of OpenMP threads
+ */
+void isat_update(isat_table* table, const isat_batch* batch, const int NUM, const double dt, double* y_host,
+                 const int* codes, const int num_threads)
+{
+    const int num_miss = batch->num_miss;
+    if (num_miss == 0)
+        return;
+    int* action = (int*)isat_alloc(num_miss, sizeof(int));
+    int* slot = (int*)isat_alloc(num_miss, sizeof(int));
+    pthread_rwlock_wrlock(&table->lock);
+
+    // copy the results, and test the linear approximation of the closest entry
+    int m;
+    #pragma omp parallel for private(m) num_threads(num_threads)
+    for (m = 0; m < num_miss; ++m)
+    {
+        const int tid = batch->miss[m];
+        double phi[ISAT_DIM];
+        double y[NSP];
+        for (int i = 0; i < NSP; ++i)
+        {
+            phi[i] = batch->y0[state_index(m, i, num_miss)];
+            y[i] = batch->y[state_index(m, i, num_miss)];
+            y_host[state_index(tid, i, NUM)] = y[i];
+        }
+        phi[NSP] = batch->var[m];
+        phi[NSP + 1] = dt;
+        const int e = batch->leaf[tid];
+        if (codes != NULL && codes[m] != 0)
+            action[m] = ISAT_NONE;
+        else if (e >= 0 && table->in_use[e] && table->stamp[e] == batch->stamp[tid] &&
+                 isat_error(table, e, phi, y) <= 1.0)
+            action[m] = ISAT_GROW;
+        else
+            action[m] = ISAT_ADD;
+    }
+
+    // grow, and allocate the added entries (at most the capacity)
+    int num_adds = 0;
+    for (m = 0; m < num_miss; ++m)
+    {
+        if (action[m] == ISAT_GROW)
+        {
+            double phi[ISAT_DIM];
+            for (int i = 0; i < NSP; ++i)
+                phi[i] = batch->y0[state_index(m, i, num_miss)];
+            phi[NSP] = batch->var[m];
+            phi[NSP + 1] = dt;
+            isat_grow(table, batch->leaf[batch->miss[m]], phi);
+            table->stats[ISAT_GROWS]++;
+        }
+        else if (action[m] == ISAT_ADD && num_adds < table->capacity)
+        {
+            slot[num_adds++] = m;
+        }
+    }
+    int* entry = (int*)isat_alloc(num_adds > 0 ? num_adds : 1, sizeof(int));
+    for (int k = 0; k < num_adds; ++k)
+        entry[k] = isat_allocate_entry(table);
+
+    // compute the added entries, and insert them
+    int k;
+    #pragma omp parallel for private(k) schedule(dynamic) num_threads(num_threads)
+    for (k = 0; k < num_adds; ++k)
+    {
+        const int mk = slot[k];
+        double phi[ISAT_DIM];
+        double y[NSP];
+        for (int i = 0; i < NSP; ++i)
+        {
+            phi[i] = batch->y0[state_index(mk, i, num_miss)];
+            y[i] = batch->y[state_index(mk, i, num_miss)];
+        }
+        phi[NSP] = batch->var[mk];
+        phi[NSP + 1] = dt;
+        isat_compute_entry(table, entry[k], phi, y);
+    }
+    for (k = 0; k < num_adds; ++k)
+        isat_insert(table, entry[k]);
+
+    pthread_rwlock_unlock(&table->lock);
+    free(entry);
+    free(action);
+    free(slot);
+}
+
+/**
+ * \brief Returns the cumulative statistics of `table`
+ * \param[in]       table           The table
+ * \param[out]      stats           The (#NUM_ISAT_STATS) statistics, @see IsatStatisticIndex
+ */
+void get_isat_statistics(isat_table* table, long* stats)
+{
+    pthread_rwlock_rdlock(&table->lock);
+    memcpy(stats, table->stats, NUM_ISAT_STATS * sizeof(long));
+    stats[ISAT_ENTRIES] = table->num_entries;
+    pthread_rwlock_unlock(&table->lock);
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,177 @@
+/**
+ * \file
+ * \brief Header definitions for the in-situ adaptive tabulation (ISAT) of the CPU library interface
+ *
+ * If #ISAT is defined, accelerInt_context_integrate first retrieves each IVP from a table of previously
+ * integrated steps, and integrates only the IVPs that are not retrieved (the misses) with intDriver.
+ *
+ * An entry of the table is keyed on the query point \f$\phi_0 = (y_0, pr, \Delta t)\f$, and holds the result
+ * \f$R(\phi_0)\f$ (the state vector at the end of the step), the mapping gradient \f$A = \partial R / \partial \phi\f$
+ * and an ellipsoid of accuracy (EOA) \f$\{\phi : (\phi - \phi_0)^T M (\phi - \phi_0) \le 1\}\f$.  A query point
+ * inside the EOA of an entry is retrieved by the linear approximation \f$R(\phi_0) + A (\phi - \phi_0)\f$.
+ *
+ * The mapping gradient is built from the Jacobian of the mechanism: the state and parameter columns are the
+ * exponential of the (augmented) Jacobian `eval_jacob` and the finite difference parameter derivative of `dydt`,
+ * averaged over the start and end of the step, and the step size column is \f$f(R(\phi_0))\f$.  The initial EOA
+ * is the region where the linear change is within the tolerances #ISAT_ATOL and #ISAT_RTOL (bounded by
+ * #ISAT_MAX_RADIUS).  After the misses are integrated, the EOA of the entry the query was closest to is grown
+ * to include the query point if the linear approximation is within the tolerances, otherwise a new entry is
+ * added (Pope, Combust. Theory Modelling 1, 1997).
+ *
+ * The entries are the leaves of a binary tree of cutting planes.  Its capacity is bounded by #ISAT_MEMORY, and
+ * once full the entries that were not retrieved since the last sweep of a clock hand are evicted.  The table
+ * may be shared by solver instances (accelerInt_context_share_isat), and is guarded by a read-write lock,
+ * such that instances integrating concurrently query it in parallel.
+ *
+ * With #ISAT, the statistics and failures of accelerInt_context_integrate refer to the (compacted) misses.
+ * As the position of an IVP among the misses changes between calls, the per-IVP state of the drivers is not
+ * kept, hence #ISAT is incompatible with #WARM_START and #COST_REORDER (and the per-IVP tolerance scales
+ * bypass the table).
+ */
+
+#ifndef ISAT_H
+#define ISAT_H
+
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief Indices of the (cumulative) table statistics returned by get_isat_statistics
+ */
+enum IsatStatisticIndex
+{
+    //! The number of queries
+    ISAT_QUERIES = 0,
+    //! The number of queries retrieved from the table
+    ISAT_RETRIEVES = 1,
+    //! The number of EOA growths
+    ISAT_GROWS = 2,
+    //! The number of added entries
+    ISAT_ADDS = 3,
+    //! The number of evicted entries
+    ISAT_EVICTIONS = 4,
+    //! The current number of entries
+    ISAT_ENTRIES = 5,
+    NUM_ISAT_STATS = 6
+};
+
+#ifdef ISAT
+
+#if defined(WARM_START) || defined(COST_REORDER)
+    #error "ISAT integrates the compacted misses, and is incompatible with the WARM_START and COST_REORDER options"
+#endif
+
+#ifndef ISAT_ATOL
+    //! The absolute tolerance of the retrieved state vectors
+    #define ISAT_ATOL (1e-8)
+#endif
+#ifndef ISAT_RTOL
+    //! The relative tolerance of the retrieved state vectors
+    #define ISAT_RTOL (1e-4)
+#endif
+#ifndef ISAT_MEMORY
+    //! The maximum size of the table, in MB
+    #define ISAT_MEMORY (256)
+#endif
+#ifndef ISAT_MAX_RADIUS
+    //! The maximum relative extent of the initial EOA in each coordinate
+    #define ISAT_MAX_RADIUS (0.1)
+#endif
+
+//! The dimension of the query points (the state vector, the parameter and the step size)
+#define ISAT_DIM (NSP + 2)
+
+/**
+ * \brief The table, @see isat.h
+ *
+ * Opaque, such that the read-write lock (and the POSIX feature macros it requires) stays private to isat.c.
+ */
+typedef struct isat_table isat_table;
+
+/**
+ * \brief The per-call workspace of a solver instance
+ * \param           size            The number of IVPs the arrays are allocated for
+ * \param           num_miss        The number of misses of the last query
+ * \param           leaf            The closest entry of each IVP, -1 if none, or -2 if retrieved
+ * \param           stamp           The stamp of the closest entry of each IVP at the time of the query
+ * \param           miss            The IVP index of each miss
+ * \param           y               The compacted state vectors of the misses, stored as `y[state_index(m, i, num_miss)]`
+ * \param           y0              The state vectors of the misses at the start of the step, in the layout of #y
+ * \param           var             The compacted parameters of the misses
+ */
+typedef struct
+{
+    int size;
+    int num_miss;
+    int* leaf;
+    int* stamp;
+    int* miss;
+    double* y;
+    double* y0;
+    double* var;
+} isat_batch;
+
+/**
+ * \brief Creates an empty table of (at most) #ISAT_MEMORY MB
+ */
+isat_table* create_isat(void);
+
+/**
+ * \brief Adds a reference to `table`, and returns it
+ */
+isat_table* share_isat(isat_table* table);
+
+/**
+ * \brief Removes a reference to `table`, and frees it once unreferenced
+ */
+void release_isat(isat_table* table);
+
+/**
+ * \brief Retrieves the IVPs inside the EOA of an entry, and compacts the others into the workspace
+ * \param[in,out]   table           The table
+ * \param[in,out]   batch           The workspace of the solver instance
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       dt              The step size, i.e. `t_end - t_start`
+ * \param[in,out]   y_host          The state vectors at the start of the step, the retrieved IVPs are set to the end of the step
+ * \param[in]       var_host        The parameters
+ * \param[in]       num_threads     The number of OpenMP threads
+ * \return                          The number of misses, integrated in place in `batch->y` with the parameters `batch->var`
+ */
+int isat_query(isat_table* table, isat_batch* batch, const int NUM, const double dt, double* y_host,
+               const double* var_host, const int num_threads);
+
+/**
+ * \brief Copies the integrated misses to the state vectors, and grows or adds the table entries
+ * \param[in,out]   table           The table
+ * \param[in]       batch           The workspace of the solver instance, with the integrated misses
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       dt              The step size, i.e. `t_end - t_start`
+ * \param[in,out]   y_host          The state vectors, the misses are set to the end of the step
+ * \param[in]       codes           The (num_miss) error codes of the misses (which are not tabulated if non-zero), or NULL
+ * \param[in]       num_threads     The number of OpenMP threads
+ */
+void isat_update(isat_table* table, const isat_batch* batch, const int NUM, const double dt, double* y_host,
+                 const int* codes, const int num_threads);
+
+/**
+ * \brief Returns the cumulative statistics of `table`
+ * \param[in]       table           The table
+ * \param[out]      stats           The (#NUM_ISAT_STATS) statistics, @see IsatStatisticIndex
+ */
+void get_isat_statistics(isat_table* table, long* stats);
+
+/**
+ * \brief Frees the workspace of a solver instance
+ */
+void cleanup_isat_batch(isat_batch* batch);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * \file
+ * \brief The bounded pipeline of IVP chunks of the GPU library interface, @see ivp_stream.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "header.cuh"
+#include "ivp_stream.h"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The states of a chunk buffer
+typedef enum
+{
+    //! waiting for the producer
+    SLOT_FREE = 0,
+    //! filled by the producer, waiting for the integration
+    SLOT_FILLED = 1,
+    //! integrated, waiting for the consumer
+    SLOT_INTEGRATED = 2
+} ivp_stream_slot_state;
+
+/**
+ * \brief A chunk buffer of the pipeline
+ */
+typedef struct
+{
+    double* y;
+    double* var;
+    //! the number of IVPs, zero marks the end of the stream
+    int num;
+    //! the index of the first IVP in the stream
+    long offset;
+    ivp_stream_slot_state state;
+} ivp_stream_slot;
+
+/**
+ * \brief The state of a running pipeline
+ */
+typedef struct
+{
+    int chunk_size;
+    accelerInt_producer producer;
+    accelerInt_consumer consumer;
+    void* user;
+    ivp_stream_slot slots[IVP_STREAM_DEPTH];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} ivp_stream;
+
+/**
+ * \brief Waits (holding the lock) until the slot `seq` of the ring reaches `state`, and returns it
+ */
+static ivp_stream_slot* ivp_stream_wait(ivp_stream* stream, const long seq, const ivp_stream_slot_state state)
+{
+    ivp_stream_slot* slot = &stream->slots[seq % IVP_STREAM_DEPTH];
+    while (slot->state != state)
+        pthread_cond_wait(&stream->cond, &stream->lock);
+    return slot;
+}
+
+/**
+ * \brief Marks `slot` as `state` (holding the lock), and wakes the other stages
+ */
+static void ivp_stream_advance(ivp_stream* stream, ivp_stream_slot* slot, const ivp_stream_slot_state state)
+{
+    slot->state = state;
+    pthread_cond_broadcast(&stream->cond);
+}
+
+/**
+ * \brief The reader thread, fills the free slots in order until the producer is exhausted
+ *
+ * A partial chunk is compacted to a leading dimension of its size.
+ */
+static void* ivp_stream_reader(void* arg)
+{
+    ivp_stream* stream = (ivp_stream*)arg;
+    const int chunk_size = stream->chunk_size;
+    long offset = 0;
+    for (long seq = 0; ; ++seq)
+    {
+        pthread_mutex_lock(&stream->lock);
+        ivp_stream_slot* slot = ivp_stream_wait(stream, seq, SLOT_FREE);
+        pthread_mutex_unlock(&stream->lock);
+
+        int num = stream->producer(stream->user, chunk_size, slot->y, slot->var);
+        if (num < 0 || num > chunk_size)
+        {
+            printf("Error: the stream producer returned %d IVPs for a chunk of size %d.\n", num, chunk_size);
+            exit(-1);
+        }
+        // the rows move towards the start of the buffer, hence in increasing order
+        for (int i = 1; i < NSP && num < chunk_size; ++i)
+            memmove(&slot->y[i * num], &slot->y[i * chunk_size], num * sizeof(double));
+
+        pthread_mutex_lock(&stream->lock);
+        slot->num = num;
+        slot->offset = offset;
+        ivp_stream_advance(stream, slot, SLOT_FILLED);
+        pthread_mutex_unlock(&stream->lock);
+        offset += num;
+        if (num == 0)
+            return NULL;
+    }
+}
+
+/**
+ * \brief The writer thread, passes the integrated slots in order to the consumer until the end of the stream
+ */
+static void* ivp_stream_writer(void* arg)
+{
+    ivp_stream* stream = (ivp_stream*)arg;
+    for (long seq = 0; ; ++seq)
+    {
+        pthread_mutex_lock(&stream->lock);
+        ivp_stream_slot* slot = ivp_stream_wait(stream, seq, SLOT_INTEGRATED);
+        pthread_mutex_unlock(&stream->lock);
+        if (slot->num == 0)
+            return NULL;
+
+        stream->consumer(stream->user, slot->offset, slot->num, slot->y, slot->var);
+
+        pthread_mutex_lock(&stream->lock);
+        ivp_stream_advance(stream, slot, SLOT_FREE);
+        pthread_mutex_unlock(&stream->lock);
+    }
+}
+
+/**
+ * \brief Integrates the stream of `producer` chunk by chunk on the calling thread, @see ivp_stream.h
+ */
+long run_ivp_stream(const int chunk_size, accelerInt_producer producer, accelerInt_consumer consumer,
+                    void* user, ivp_stream_integrator integrate, void* solver)
+{
+    if (chunk_size <= 0 || producer == NULL || consumer == NULL)
+    {
+        printf("Error: the stream requires a positive chunk size, a producer and a consumer.\n");
+        exit(-1);
+    }
+    ivp_stream stream;
+    stream.chunk_size = chunk_size;
+    stream.producer = producer;
+    stream.consumer = consumer;
+    stream.user = user;
+    for (int k = 0; k < IVP_STREAM_DEPTH; ++k)
+    {
+        stream.slots[k].y = (double*)malloc((size_t)chunk_size * NSP * sizeof(double));
+        stream.slots[k].var = (double*)malloc((size_t)chunk_size * sizeof(double));
+        if (stream.slots[k].y == NULL || stream.slots[k].var == NULL)
+        {
+            printf("Error: could not allocate the stream buffers for chunks of %d IVPs.\n", chunk_size);
+            exit(-1);
+        }
+        stream.slots[k].num = 0;
+        stream.slots[k].offset = 0;
+        stream.slots[k].state = SLOT_FREE;
+    }
+    pthread_mutex_init(&stream.lock, NULL);
+    pthread_cond_init(&stream.cond, NULL);
+    pthread_t reader, writer;
+    if (pthread_create(&reader, NULL, ivp_stream_reader, &stream) != 0 ||
+        pthread_create(&writer, NULL, ivp_stream_writer, &stream) != 0)
+    {
+        printf("Error: could not start the stream threads.\n");
+        exit(-1);
+    }
+
+    long total = 0;
+    for (long seq = 0; ; ++seq)
+    {
+        pthread_mutex_lock(&stream.lock);
+        ivp_stream_slot* slot = ivp_stream_wait(&stream, seq, SLOT_FILLED);
+        pthread_mutex_unlock(&stream.lock);
+
+        // the slot may be refilled once advanced, hence its size is read before
+        const int num = slot->num;
+        if (num > 0)
+            integrate(solver, num, slot->y, slot->var);
+        total += num;
+
+        // the end of the stream is passed on to the writer
+        pthread_mutex_lock(&stream.lock);
+        ivp_stream_advance(&stream, slot, SLOT_INTEGRATED);
+        pthread_mutex_unlock(&stream.lock);
+        if (num == 0)
+            break;
+    }
+
+    pthread_join(reader, NULL);
+    pthread_join(writer, NULL);
+    pthread_mutex_destroy(&stream.lock);
+    pthread_cond_destroy(&stream.cond);
+    for (int k = 0; k < IVP_STREAM_DEPTH; ++k)
+    {
+        free(stream.slots[k].y);
+        free(stream.slots[k].var);
+    }
+    return total;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,73 @@
+/**
+ * \file
+ * \brief A bounded pipeline of IVP chunks, for the streaming integration of unbounded batches
+ *
+ * Used by the CPU and GPU library interfaces (accelerInt_integrate_stream).  The caller supplies a producer,
+ * which fills a chunk of (at most) `chunk_size` IVPs, and a consumer, which receives each integrated chunk.
+ * A reader thread calls the producer and a writer thread calls the consumer, while the calling thread
+ * integrates, such that reading, integration and writing of consecutive chunks overlap.  The chunks cycle
+ * through a ring of #IVP_STREAM_DEPTH buffers, hence the memory used is bounded by
+ * #IVP_STREAM_DEPTH * `chunk_size` * (NSP + 1) doubles, independent of the number of IVPs.
+ *
+ * The producer and consumer are each called from a single thread, in chunk order, but concurrently with
+ * each other (and with the integration).
+ *
+ * Implemented in ivp_stream.c (CPU) and ivp_stream.cu (GPU).
+ */
+
+#ifndef IVP_STREAM_H
+#define IVP_STREAM_H
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifndef IVP_STREAM_DEPTH
+    //! The number of chunk buffers, i.e. one each being read, integrated and written
+    #define IVP_STREAM_DEPTH (3)
+#endif
+
+/**
+ * \brief Fills the next chunk of the stream
+ * \param[in]       user        The user pointer passed to accelerInt_integrate_stream
+ * \param[in]       max_num     The maximum number of IVPs in the chunk, i.e. the chunk size
+ * \param[out]      y           The state vectors of the chunk, stored as `y[tid + i * max_num]`
+ * \param[out]      var         The parameters of the chunk
+ * \return                      The number of IVPs filled, zero once the stream is exhausted
+ */
+typedef int (*accelerInt_producer)(void* user, const int max_num, double* y, double* var);
+
+/**
+ * \brief Receives an integrated chunk of the stream
+ * \param[in]       user        The user pointer passed to accelerInt_integrate_stream
+ * \param[in]       offset      The index of the first IVP of the chunk in the stream
+ * \param[in]       num         The number of IVPs in the chunk
+ * \param[in]       y           The integrated state vectors of the chunk, stored as `y[tid + i * num]`
+ * \param[in]       var         The parameters of the chunk
+ */
+typedef void (*accelerInt_consumer)(void* user, const long offset, const int num, const double* y,
+                                    const double* var);
+
+/**
+ * \brief Integrates a chunk of `num` IVPs in place (`y[tid + i * num]`)
+ */
+typedef void (*ivp_stream_integrator)(void* solver, const int num, double* y, const double* var);
+
+/**
+ * \brief Integrates the stream of `producer` chunk by chunk on the calling thread
+ * \param[in]       chunk_size  The (maximum) number of IVPs per chunk
+ * \param[in]       producer    Fills the next chunk
+ * \param[in]       consumer    Receives each integrated chunk
+ * \param[in]       user        Passed to `producer` and `consumer`
+ * \param[in]       integrate   Integrates a chunk in place
+ * \param[in]       solver      Passed to `integrate`
+ * \return                      The number of IVPs integrated
+ */
+long run_ivp_stream(const int chunk_size, accelerInt_producer producer, accelerInt_consumer consumer,
+                    void* user, ivp_stream_integrator integrate, void* solver);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
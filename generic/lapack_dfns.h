@@ -14,5 +14,9 @@ extern void zgetrf_ (const int* m, const int* n, double complex* A, const int* l
 extern void dgetrs_ (const char* trans, const int* n, const int* nrhs, double* A, const int* LDA, int* ipiv, double* B, const int* LDB, int* info);
 extern void zgetrs_ (const char* trans, const int* n, const int* nrhs, double complex* A, const int* LDA, int* ipiv, double complex* B, const int* LDB, int* info);
 extern void zgetri_ (const int* n, double complex* A, const int* LDA, int* ipiv, double complex* work, const int* LDB, int* info);
+extern void sgetrf_ (const int* m, const int* n, float* A, const int* lda, int* ipiv, int* info);
+extern void cgetrf_ (const int* m, const int* n, float complex* A, const int* lda, int* ipiv, int* info);
+extern void sgetrs_ (const char* trans, const int* n, const int* nrhs, float* A, const int* LDA, int* ipiv, float* B, const int* LDB, int* info);
+extern void cgetrs_ (const char* trans, const int* n, const int* nrhs, float complex* A, const int* LDA, int* ipiv, float complex* B, const int* LDB, int* info);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+/**
+ * \file
+ * \brief The launch configuration of the GPU integration drivers
+ *
+ * The block size (#TARGET_BLOCK_SIZE) is defined by the launch_bounds.cuh of the mechanism, unless
+ * overridden by the BLOCK_SIZE SCons option.  The cache configuration and the occupancy target of
+ * the drivers are set by the CACHE_CONFIG and LAUNCH_MIN_BLOCKS SCons options.  All three may be
+ * selected per device by launch_tuner.py, see the LAUNCH_TUNING SCons option.
+ */
+
+#ifndef LAUNCH_CONFIG_CUH
+#define LAUNCH_CONFIG_CUH
+
+#include "solver_options.cuh"
+#include "launch_bounds.cuh"
+
+#ifndef CACHE_CONFIG
+//! The preferred cache configuration of the integration kernels
+#define CACHE_CONFIG cudaFuncCachePreferL1
+#endif
+
+#ifdef LAUNCH_MIN_BLOCKS
+//! Limits the register use of the drivers, such that #LAUNCH_MIN_BLOCKS blocks may be resident per multiprocessor
+#define DRIVER_LAUNCH_BOUNDS __launch_bounds__(TARGET_BLOCK_SIZE, LAUNCH_MIN_BLOCKS)
+#else
+#define DRIVER_LAUNCH_BOUNDS
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * \file
+ * \brief Per-IVP cost bookkeeping used to reorder IVPs in the CPU integration drivers
+ *
+ * Combined with a dynamic or guided OpenMP schedule, issuing the most expensive IVPs first
+ * (as measured on the previous global integration step) avoids having a few stiff IVPs
+ * near ignition still running while the other threads are idle.
+ */
+
+#include <stdlib.h>
+#include "header.h"
+#include "load_balance.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief Returns the order in which the IVPs should be integrated
+ * \param[in,out]   ordering    The cost bookkeeping
+ * \param[in]       NUM         The number of IVPs
+ *
+ * The order is reset to the identity whenever NUM changes.
+ */
+const int* get_ivp_order(ivp_ordering* ordering, const int NUM)
+{
+    if (NUM != ordering->size)
+    {
+        cleanup_ivp_order(ordering);
+        ordering->order = (int*)malloc(NUM * sizeof(int));
+        ordering->cost = (double*)calloc(NUM, sizeof(double));
+        ordering->keys = (ivp_cost_key*)malloc(NUM * sizeof(ivp_cost_key));
+        for (int i = 0; i < NUM; ++i)
+            ordering->order[i] = i;
+        ordering->size = NUM;
+    }
+    return ordering->order;
+}
+
+/**
+ * \brief Stores the measured integration cost of an IVP
+ * \param[in,out]   ordering    The cost bookkeeping
+ * \param[in]       tid         The IVP index
+ * \param[in]       cost        The measured cost (wall time) of the IVP
+ */
+void record_ivp_cost(ivp_ordering* ordering, const int tid, const double cost)
+{
+    ordering->cost[tid] = cost;
+}
+
+/**
+ * \brief Comparison function for qsort, ordering IVP indicies by descending cost
+ */
+static int compare_cost(const void* a, const void* b)
+{
+    const ivp_cost_key* ka = (const ivp_cost_key*)a;
+    const ivp_cost_key* kb = (const ivp_cost_key*)b;
+    if (ka->cost > kb->cost)
+        return -1;
+    if (ka->cost < kb->cost)
+        return 1;
+    //keep the original ordering for equal cost, to retain memory locality
+    return ka->index - kb->index;
+}
+
+/**
+ * \brief Sorts the IVP order by descending cost measured during the last global integration step
+ * \param[in,out]   ordering    The cost bookkeeping
+ * \param[in]       NUM         The number of IVPs
+ *
+ * The costs are sorted along with the indices, such that independent instances may sort concurrently.
+ */
+void update_ivp_order(ivp_ordering* ordering, const int NUM)
+{
+    get_ivp_order(ordering, NUM);
+    for (int i = 0; i < NUM; ++i)
+    {
+        ordering->keys[i].index = ordering->order[i];
+        ordering->keys[i].cost = ordering->cost[ordering->order[i]];
+    }
+    qsort(ordering->keys, NUM, sizeof(ivp_cost_key), compare_cost);
+    for (int i = 0; i < NUM; ++i)
+        ordering->order[i] = ordering->keys[i].index;
+}
+
+/**
+ * \brief Frees the cost and order arrays
+ * \param[in,out]   ordering    The cost bookkeeping
+ */
+void cleanup_ivp_order(ivp_ordering* ordering)
+{
+    free(ordering->order);
+    free(ordering->cost);
+    free(ordering->keys);
+    ordering->order = 0;
+    ordering->cost = 0;
+    ordering->keys = 0;
+    ordering->size = 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,90 @@
+/**
+ * \file
+ * \brief Header definitions for the load balancing of the CPU integration drivers
+ *
+ * Contains the OpenMP schedule clause used by the drivers, and the per-IVP cost
+ * bookkeeping used to reorder the IVPs between global integration steps (#COST_REORDER)
+ */
+
+#ifndef LOAD_BALANCE_H
+#define LOAD_BALANCE_H
+
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifndef SCHEDULE_CLAUSE
+//! The OpenMP schedule clause of the integration drivers, see the SCHEDULE SCons option
+#define SCHEDULE_CLAUSE
+#endif
+
+#ifdef _OPENMP
+ //! Wall clock used to measure the per-IVP integration cost
+ #define COST_TIMER() omp_get_wtime()
+#else
+ #define COST_TIMER() (0.0)
+#endif
+
+/**
+ * \brief An IVP index and its measured cost, the sort key of update_ivp_order
+ */
+typedef struct
+{
+    double cost;
+    int index;
+} ivp_cost_key;
+
+/**
+ * \brief The per-IVP cost bookkeeping of a solver instance
+ * \param           size        The number of IVPs in #order / #cost
+ * \param           order       The order in which the IVPs are issued to the OpenMP threads
+ * \param           cost        The cost of each IVP measured on the last global integration step
+ * \param           keys        The sort buffer of update_ivp_order
+ *
+ * Zero-initialize before the first call to get_ivp_order.
+ */
+typedef struct
+{
+    int size;
+    int* order;
+    double* cost;
+    ivp_cost_key* keys;
+} ivp_ordering;
+
+/**
+ * \brief Returns the order in which the IVPs should be integrated
+ * \param[in,out]   ordering    The cost bookkeeping
+ * \param[in]       NUM         The number of IVPs
+ *
+ * The order is reset to the identity whenever NUM changes.
+ */
+const int* get_ivp_order(ivp_ordering* ordering, const int NUM);
+
+/**
+ * \brief Stores the measured integration cost of an IVP
+ * \param[in,out]   ordering    The cost bookkeeping
+ * \param[in]       tid         The IVP index
+ * \param[in]       cost        The measured cost (wall time) of the IVP
+ */
+void record_ivp_cost(ivp_ordering* ordering, const int tid, const double cost);
+
+/**
+ * \brief Sorts the IVP order by descending cost measured during the last global integration step
+ * \param[in,out]   ordering    The cost bookkeeping
+ * \param[in]       NUM         The number of IVPs
+ */
+void update_ivp_order(ivp_ordering* ordering, const int NUM);
+
+/**
+ * \brief Frees the cost and order arrays
+ * \param[in,out]   ordering    The cost bookkeeping
+ */
+void cleanup_ivp_order(ivp_ordering* ordering);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,517 @@
+/**
+ * \file
+ * \brief Asynchronous, double-buffered binary logging of the state vectors
+ *
+ * Used by the CPU and GPU main files if #LOG_OUTPUT is defined.  write_log copies (every
+ * #LOG_IVP_STRIDE-th IVP of) the state vectors into one of two snapshot buffers and returns;
+ * a background thread converts the snapshot to the on-disk layout and writes it to file
+ * with a single `fwrite`.  The time loop only blocks if both snapshots are still pending.
+ *
+ * The default layout is that of the original logger (read by logger.py):\n
+ * system time\n
+ * temperature, mass fractions (State #1)\n
+ * temperature, mass fractions (State #2)...
+ *
+ * If #LOG_COLUMN_MAJOR is defined the file instead starts with a log_header, and each
+ * snapshot is stored as:\n
+ * system time\n
+ * temperature (State #1, State #2, ...)\n
+ * mass fraction #1 (State #1, State #2, ...)...
+ *
+ * such that the file may be memory mapped as a `(num_steps, 1 + NN * num)` array, @see log_reader.py
+ *
+ * If #LOG_COMPRESSED is defined the file instead starts with a log_compressed_header, and each snapshot is
+ * split into chunks of #LOG_CHUNK_IVPS IVPs, stored in the column-major layout above (temperature and mass
+ * fractions of the IVPs of the chunk).  The bytes of each chunk are shuffled (the first byte of each entry,
+ * then the second...) and compressed with zlib; if #LOG_LOSSY_BITS is greater than zero the mantissae of
+ * the mass fractions are first rounded to that many bits, i.e. to a relative error of at most
+ * `2^-(LOG_LOSSY_BITS + 1)`.  A snapshot is stored as:\n
+ * system time\n
+ * the compressed size of each chunk (int64)\n
+ * the compressed chunks
+ *
+ * and the file ends with a log_index_entry per snapshot, such that a reader may seek to the snapshots of a
+ * time range, and to the chunks of an IVP range, without decompressing the others.  The chunks of a
+ * snapshot are compressed by #LOG_WRITER_THREADS threads.
+ *
+ * The mechanism header (header.h / header.cuh) and the solver options must be included before this file.
+ */
+
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#ifdef STATE_BLOCK
+#include "state_layout.h"
+#endif
+#ifdef LOG_COMPRESSED
+#include <zlib.h>
+#endif
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifndef LOG_IVP_STRIDE
+    //! Only every LOG_IVP_STRIDE-th IVP is logged
+    #define LOG_IVP_STRIDE (1)
+#endif
+#ifndef LOG_STEP_STRIDE
+    //! Only every LOG_STEP_STRIDE-th global integration step (and the last) is logged
+    #define LOG_STEP_STRIDE (1)
+#endif
+
+//! The magic bytes identifying the column-major log format
+#define LOG_MAGIC "ACCINTLG"
+
+/**
+ * \brief The header of the column-major log format
+ */
+typedef struct
+{
+    //! #LOG_MAGIC (without the terminating null)
+    char magic[8];
+    //! the number of logged IVPs
+    int64_t num;
+    //! the number of logged entries per IVP, i.e. NN
+    int64_t nvar;
+    //! the number of logged snapshots (updated as the log is closed)
+    int64_t num_steps;
+    //! the stride of the logged IVPs
+    int64_t ivp_stride;
+    //! the stride of the logged global integration steps
+    int64_t step_stride;
+} log_header;
+
+#ifdef LOG_COMPRESSED
+#ifndef LOG_CHUNK_IVPS
+    //! The number of IVPs per compressed chunk
+    #define LOG_CHUNK_IVPS (1024)
+#endif
+#ifndef LOG_LOSSY_BITS
+    //! If greater than zero, the mantissa bits the logged mass fractions are rounded to
+    #define LOG_LOSSY_BITS (0)
+#endif
+#ifndef LOG_WRITER_THREADS
+    //! The number of threads compressing the chunks of a snapshot
+    #define LOG_WRITER_THREADS (2)
+#endif
+
+//! The magic bytes identifying the compressed log format
+#define LOG_COMPRESSED_MAGIC "ACCINTLZ"
+
+/**
+ * \brief The header of the compressed log format
+ */
+typedef struct
+{
+    //! #LOG_COMPRESSED_MAGIC (without the terminating null)
+    char magic[8];
+    //! the number of logged IVPs
+    int64_t num;
+    //! the number of logged entries per IVP, i.e. NN
+    int64_t nvar;
+    //! the number of logged snapshots (updated as the log is closed)
+    int64_t num_steps;
+    //! the stride of the logged IVPs
+    int64_t ivp_stride;
+    //! the stride of the logged global integration steps
+    int64_t step_stride;
+    //! the number of IVPs per chunk
+    int64_t chunk_ivps;
+    //! the mantissa bits of the mass fractions, zero if lossless
+    int64_t lossy_bits;
+    //! the file offset of the index (updated as the log is closed, zero if the log was not closed)
+    int64_t index_offset;
+} log_compressed_header;
+
+/**
+ * \brief An entry of the snapshot index of the compressed log format
+ */
+typedef struct
+{
+    //! the system time of the snapshot
+    double t;
+    //! the file offset of the snapshot
+    int64_t offset;
+} log_index_entry;
+#endif
+
+/**
+ * \brief The state of an open log
+ */
+typedef struct
+{
+    //! the log file
+    FILE* file;
+    //! the total number of IVPs
+    int NUM;
+    //! the number of logged IVPs
+    int num;
+    //! the snapshots of the logged state vectors, stored as `snapshot[s][tid + i * num]`
+    double* snapshot[2];
+    //! the system time of the snapshots
+    double time[2];
+    //! true if the snapshot is waiting to be written
+    bool pending[2];
+    //! the snapshot the next call to write_log copies to
+    int next;
+    //! set to stop the writer thread, once all pending snapshots are written
+    bool done;
+    //! the number of written snapshots
+    int64_t num_steps;
+    //! the on-disk layout of a snapshot (owned by the writer thread)
+    double* block;
+#ifdef LOG_COMPRESSED
+    //! the number of chunks per snapshot
+    int num_chunks;
+    //! the maximum compressed size of a chunk
+    size_t chunk_bound;
+    //! the shuffled bytes of each chunk, `LOG_CHUNK_IVPS * NN * sizeof(double)` bytes per chunk
+    unsigned char* shuffled;
+    //! the compressed chunks, #chunk_bound bytes per chunk
+    unsigned char* compressed;
+    //! the compressed size of each chunk
+    int64_t* sizes;
+    //! the snapshot index
+    log_index_entry* index;
+    //! the number of allocated index entries
+    int64_t index_capacity;
+#endif
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} log_writer;
+
+#ifdef LOG_COMPRESSED
+/**
+ * \brief Shuffles and compresses the chunks `first`, `first + LOG_WRITER_THREADS`, ... of the current block
+ */
+static void log_compress_chunks(log_writer* writer, const int first)
+{
+    const int num = writer->num;
+    const double* block = writer->block;
+    for (int c = first; c < writer->num_chunks; c += LOG_WRITER_THREADS)
+    {
+        const int start = c * LOG_CHUNK_IVPS;
+        const int count = (num - start < LOG_CHUNK_IVPS) ? num - start : LOG_CHUNK_IVPS;
+        const size_t n = (size_t)count * NN;
+        unsigned char* shuffled = &writer->shuffled[(size_t)c * LOG_CHUNK_IVPS * NN * sizeof(double)];
+        for (int i = 0; i < NN; ++i)
+        {
+            for (int j = 0; j < count; ++j)
+            {
+                uint64_t bits;
+                memcpy(&bits, &block[1 + (size_t)num * i + start + j], sizeof(double));
+#if LOG_LOSSY_BITS > 0 && LOG_LOSSY_BITS < 52
+                // round the mantissa of the (finite) mass fractions to nearest
+                const uint64_t drop = ((uint64_t)1 << (52 - LOG_LOSSY_BITS)) - 1;
+                if (i > 0 && ((bits >> 52) & 0x7ff) != 0x7ff)
+                    bits = (bits + (drop >> 1) + 1) & ~drop;
+#endif
+                // byte k of each entry is stored contiguously (little-endian)
+                const size_t idx = (size_t)i * count + j;
+                for (int k = 0; k < (int)sizeof(double); ++k)
+                    shuffled[k * n + idx] = (unsigned char)(bits >> (8 * k));
+            }
+        }
+        uLongf size = (uLongf)writer->chunk_bound;
+        if (compress2(&writer->compressed[(size_t)c * writer->chunk_bound], &size, shuffled,
+                      (uLong)(n * sizeof(double)), Z_BEST_SPEED) != Z_OK)
+        {
+            printf("Error: could not compress the log.\n");
+            exit(-1);
+        }
+        writer->sizes[c] = (int64_t)size;
+    }
+}
+
+/**
+ * \brief The arguments of a log_compress_thread
+ */
+typedef struct
+{
+    log_writer* writer;
+    int first;
+} log_compress_task;
+
+/**
+ * \brief A helper thread of the writer, compresses every #LOG_WRITER_THREADS-th chunk
+ */
+static void* log_compress_thread(void* arg)
+{
+    log_compress_task* task = (log_compress_task*)arg;
+    log_compress_chunks(task->writer, task->first);
+    return NULL;
+}
+
+/**
+ * \brief Compresses the current block, and writes it to file and to the snapshot index
+ */
+static void log_write_compressed(log_writer* writer)
+{
+    // compress the chunks, on the writer and LOG_WRITER_THREADS - 1 helper threads
+    pthread_t helpers[LOG_WRITER_THREADS];
+    log_compress_task tasks[LOG_WRITER_THREADS];
+    int num_helpers = 0;
+    for (int k = 1; k < LOG_WRITER_THREADS && k < writer->num_chunks; ++k)
+    {
+        tasks[num_helpers].writer = writer;
+        tasks[num_helpers].first = k;
+        if (pthread_create(&helpers[num_helpers], NULL, log_compress_thread, &tasks[num_helpers]) == 0)
+            num_helpers++;
+        else
+            log_compress_chunks(writer, k);
+    }
+    log_compress_chunks(writer, 0);
+    for (int k = 0; k < num_helpers; ++k)
+        pthread_join(helpers[k], NULL);
+
+    if (writer->num_steps == writer->index_capacity)
+    {
+        writer->index_capacity = writer->index_capacity ? 2 * writer->index_capacity : 64;
+        writer->index = (log_index_entry*)realloc(writer->index, writer->index_capacity * sizeof(log_index_entry));
+        if (writer->index == NULL)
+        {
+            printf("Error: could not allocate the log index.\n");
+            exit(-1);
+        }
+    }
+    writer->index[writer->num_steps].t = writer->block[0];
+    writer->index[writer->num_steps].offset = (int64_t)ftello(writer->file);
+    const size_t num_chunks = (size_t)writer->num_chunks;
+    bool ok = fwrite(writer->block, sizeof(double), 1, writer->file) == 1 &&
+              fwrite(writer->sizes, sizeof(int64_t), num_chunks, writer->file) == num_chunks;
+    for (size_t c = 0; c < num_chunks && ok; ++c)
+        ok = fwrite(&writer->compressed[c * writer->chunk_bound], 1, (size_t)writer->sizes[c], writer->file) ==
+             (size_t)writer->sizes[c];
+    if (!ok)
+    {
+        printf("Error: could not write to the log file.\n");
+        exit(-1);
+    }
+}
+#endif
+
+/**
+ * \brief Converts the snapshot `s` to the on-disk layout and writes it to file
+ */
+static void log_write_snapshot(log_writer* writer, const int s)
+{
+    const int num = writer->num;
+    const double* snap = writer->snapshot[s];
+    double* block = writer->block;
+    block[0] = writer->time[s];
+    for (int j = 0; j < num; j++)
+    {
+        double buffer[NN];
+        double Y_N = 1.0;
+        buffer[0] = snap[j];
+        for (int i = 1; i < NSP; ++i)
+        {
+            buffer[i] = snap[num * i + j];
+            Y_N -= buffer[i];
+        }
+        #if NN == NSP + 1 //pyjac
+        buffer[NSP] = Y_N;
+        #endif
+        apply_reverse_mask(&buffer[1]);
+#if defined(LOG_COLUMN_MAJOR) || defined(LOG_COMPRESSED)
+        for (int i = 0; i < NN; ++i)
+            block[1 + num * i + j] = buffer[i];
+#else
+        memcpy(&block[1 + NN * j], buffer, NN * sizeof(double));
+#endif
+    }
+#ifdef LOG_COMPRESSED
+    log_write_compressed(writer);
+#else
+    size_t count = 1 + (size_t)num * NN;
+    if (fwrite(block, sizeof(double), count, writer->file) != count)
+    {
+        printf("Error: could not write to the log file.\n");
+        exit(-1);
+    }
+#endif
+    writer->num_steps++;
+}
+
+/**
+ * \brief The writer thread, writes the pending snapshots in order until the log is closed
+ */
+static void* log_writer_thread(void* arg)
+{
+    log_writer* writer = (log_writer*)arg;
+    int s = 0;
+    pthread_mutex_lock(&writer->lock);
+    while (true)
+    {
+        while (!writer->pending[s] && !writer->done)
+            pthread_cond_wait(&writer->cond, &writer->lock);
+        if (!writer->pending[s])
+            break;
+        pthread_mutex_unlock(&writer->lock);
+        log_write_snapshot(writer, s);
+        pthread_mutex_lock(&writer->lock);
+        writer->pending[s] = false;
+        pthread_cond_broadcast(&writer->cond);
+        s = 1 - s;
+    }
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+/**
+ * \brief Opens the log file and starts the writer thread
+ * \param[out]      writer      The log to open
+ * \param[in]       filename    The log file name
+ * \param[in]       NUM         The number of IVPs
+ */
+static inline void open_log(log_writer* writer, const char* filename, const int NUM)
+{
+    memset(writer, 0, sizeof(log_writer));
+    writer->file = fopen(filename, "wb");
+    if (writer->file == NULL)
+    {
+        printf("Error: could not open log file %s\n", filename);
+        exit(-1);
+    }
+    writer->NUM = NUM;
+    writer->num = (NUM + LOG_IVP_STRIDE - 1) / LOG_IVP_STRIDE;
+    for (int s = 0; s < 2; ++s)
+        writer->snapshot[s] = (double*)malloc((size_t)writer->num * NSP * sizeof(double));
+    writer->block = (double*)malloc((1 + (size_t)writer->num * NN) * sizeof(double));
+#if defined(LOG_COMPRESSED)
+    writer->num_chunks = (writer->num + LOG_CHUNK_IVPS - 1) / LOG_CHUNK_IVPS;
+    writer->chunk_bound = (size_t)compressBound((uLong)(LOG_CHUNK_IVPS * NN * sizeof(double)));
+    writer->shuffled = (unsigned char*)malloc((size_t)writer->num_chunks * LOG_CHUNK_IVPS * NN * sizeof(double));
+    writer->compressed = (unsigned char*)malloc((size_t)writer->num_chunks * writer->chunk_bound);
+    writer->sizes = (int64_t*)malloc((size_t)writer->num_chunks * sizeof(int64_t));
+    if (writer->shuffled == NULL || writer->compressed == NULL || writer->sizes == NULL)
+    {
+        printf("Error: could not allocate the log compression buffers.\n");
+        exit(-1);
+    }
+    log_compressed_header header;
+    memset(&header, 0, sizeof(log_compressed_header));
+    memcpy(header.magic, LOG_COMPRESSED_MAGIC, sizeof(header.magic));
+    header.num = writer->num;
+    header.nvar = NN;
+    header.ivp_stride = LOG_IVP_STRIDE;
+    header.step_stride = LOG_STEP_STRIDE;
+    header.chunk_ivps = LOG_CHUNK_IVPS;
+    header.lossy_bits = LOG_LOSSY_BITS;
+    fwrite(&header, sizeof(log_compressed_header), 1, writer->file);
+#elif defined(LOG_COLUMN_MAJOR)
+    log_header header;
+    memcpy(header.magic, LOG_MAGIC, sizeof(header.magic));
+    header.num = writer->num;
+    header.nvar = NN;
+    header.num_steps = 0;
+    header.ivp_stride = LOG_IVP_STRIDE;
+    header.step_stride = LOG_STEP_STRIDE;
+    fwrite(&header, sizeof(log_header), 1, writer->file);
+#endif
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+    if (pthread_create(&writer->thread, NULL, log_writer_thread, writer) != 0)
+    {
+        printf("Error: could not start the log writer thread.\n");
+        exit(-1);
+    }
+}
+
+/**
+ * \brief Queues the state vectors to be written to the log
+ * \param[in]       writer      The open log
+ * \param[in]       t           The current system time
+ * \param[in]       y_host      The current state vectors
+ *
+ * Returns once `y_host` has been copied, blocking only if both snapshots are pending
+ */
+static inline void write_log(log_writer* writer, const double t, const double* y_host)
+{
+    const int s = writer->next;
+    pthread_mutex_lock(&writer->lock);
+    while (writer->pending[s])
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    pthread_mutex_unlock(&writer->lock);
+
+    const int NUM = writer->NUM;
+    const int num = writer->num;
+    double* snap = writer->snapshot[s];
+    for (int i = 0; i < NSP; ++i)
+    {
+#ifdef STATE_BLOCK
+        // the log keeps the column-major layout, @see state_layout.h
+        for (int j = 0; j < num; ++j)
+            snap[num * i + j] = y_host[state_index(j * LOG_IVP_STRIDE, i, NUM)];
+#elif LOG_IVP_STRIDE == 1
+        memcpy(&snap[num * i], &y_host[NUM * i], num * sizeof(double));
+#else
+        for (int j = 0; j < num; ++j)
+            snap[num * i + j] = y_host[NUM * i + j * LOG_IVP_STRIDE];
+#endif
+    }
+    writer->time[s] = t;
+
+    pthread_mutex_lock(&writer->lock);
+    writer->pending[s] = true;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+    writer->next = 1 - s;
+}
+
+/**
+ * \brief Writes the pending snapshots, stops the writer thread and closes the log file
+ */
+static inline void close_log(log_writer* writer)
+{
+    pthread_mutex_lock(&writer->lock);
+    writer->done = true;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread, NULL);
+#if defined(LOG_COMPRESSED)
+    // append the index, and record its offset and the number of snapshots
+    int64_t index_offset = (int64_t)ftello(writer->file);
+    if (fwrite(writer->index, sizeof(log_index_entry), (size_t)writer->num_steps, writer->file) !=
+        (size_t)writer->num_steps)
+    {
+        printf("Error: could not write the log index.\n");
+        exit(-1);
+    }
+    fseek(writer->file, offsetof(log_compressed_header, num_steps), SEEK_SET);
+    fwrite(&writer->num_steps, sizeof(int64_t), 1, writer->file);
+    fseek(writer->file, offsetof(log_compressed_header, index_offset), SEEK_SET);
+    fwrite(&index_offset, sizeof(int64_t), 1, writer->file);
+#elif defined(LOG_COLUMN_MAJOR)
+    // record the number of snapshots
+    fseek(writer->file, offsetof(log_header, num_steps), SEEK_SET);
+    fwrite(&writer->num_steps, sizeof(int64_t), 1, writer->file);
+#endif
+    fclose(writer->file);
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->cond);
+    for (int s = 0; s < 2; ++s)
+        free(writer->snapshot[s]);
+    free(writer->block);
+#ifdef LOG_COMPRESSED
+    free(writer->shuffled);
+    free(writer->compressed);
+    free(writer->sizes);
+    free(writer->index);
+#endif
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,302 @@
+/**
+ * \file
+ * \brief Implementation of the MPI distributed driver of the CPU solvers, @see mpi_driver.h
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "header.h"
+#include "mpi_driver.h"
+#include "read_initial_conditions.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef MPI_DRIVER
+
+//! The number of state vector entries per IVP
+#define MPI_WIDTH (NSP)
+
+/**
+ * \brief Aborts all ranks if an MPI-IO call on `filename` failed (files default to MPI_ERRORS_RETURN)
+ */
+static void check_io(const int err, const char* filename, const char* action)
+{
+    if (err != MPI_SUCCESS)
+    {
+        char message[MPI_MAX_ERROR_STRING];
+        int len = 0;
+        MPI_Error_string(err, message, &len);
+        fprintf(stderr, "Could not %s file: %s (%s)\n", action, filename, message);
+        MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+}
+
+/**
+ * \brief (Re)allocates the local arrays of `batch` for at least `num` IVPs
+ */
+static void reserve_batch(mpi_batch* batch, const int num)
+{
+    if (num <= batch->capacity && batch->y != NULL)
+        return;
+    free(batch->y);
+    free(batch->var);
+    free(batch->cost);
+    batch->capacity = num;
+    // at least one entry, such that malloc never returns (a valid) NULL
+    batch->y = (double*)malloc(((size_t)num * MPI_WIDTH + 1) * sizeof(double));
+    batch->var = (double*)malloc(((size_t)num + 1) * sizeof(double));
+    batch->cost = (double*)calloc((size_t)num + 1, sizeof(double));
+    if (batch->y == NULL || batch->var == NULL || batch->cost == NULL)
+    {
+        fprintf(stderr, "Error: could not allocate the local state of %d IVPs on rank %d.\n", num, batch->rank);
+        MPI_Abort(batch->comm, -1);
+    }
+}
+
+void mpi_batch_create(mpi_batch* batch, MPI_Comm comm, const int NUM, const int num_threads)
+{
+    memset(batch, 0, sizeof(mpi_batch));
+    batch->comm = comm;
+    MPI_Comm_rank(comm, &batch->rank);
+    MPI_Comm_size(comm, &batch->size);
+    batch->NUM = NUM;
+    batch->offset = (int)(((long long)NUM * batch->rank) / batch->size);
+    batch->num = (int)(((long long)NUM * (batch->rank + 1)) / batch->size) - batch->offset;
+    reserve_batch(batch, batch->num);
+    batch->context = accelerInt_create(num_threads);
+}
+
+/**
+ * \brief Reads the share of this rank from a pre-transposed initial condition file, @see write_initial_conditions
+ */
+static void read_soa_share(mpi_batch* batch, MPI_File fh, const char* filename, const soa_ic_header* header)
+{
+    if (header->width != MPI_WIDTH || header->num < batch->NUM)
+    {
+        if (batch->rank == 0)
+            fprintf(stderr, "File (%s) is incorrectly formatted, %d IVPs of width %d were expected but the file contains "
+                            "%d IVPs of width %d.\n", filename, batch->NUM, MPI_WIDTH, (int)header->num, (int)header->width);
+        MPI_Abort(batch->comm, -1);
+    }
+    const MPI_Offset var_start = (MPI_Offset)sizeof(soa_ic_header);
+    const MPI_Offset y_start = var_start + (MPI_Offset)header->num * sizeof(double);
+    check_io(MPI_File_read_at_all(fh, var_start + (MPI_Offset)batch->offset * sizeof(double), batch->var,
+                                  batch->num, MPI_DOUBLE, MPI_STATUS_IGNORE), filename, "read");
+    // the local share of every column of the file, in a single collective read
+    MPI_Datatype columns;
+    MPI_Type_vector(MPI_WIDTH, batch->num, (int)header->num, MPI_DOUBLE, &columns);
+    MPI_Type_commit(&columns);
+    check_io(MPI_File_set_view(fh, y_start + (MPI_Offset)batch->offset * sizeof(double), MPI_DOUBLE, columns,
+                               "native", MPI_INFO_NULL), filename, "read");
+    check_io(MPI_File_read_all(fh, batch->y, batch->num * MPI_WIDTH, MPI_DOUBLE, MPI_STATUS_IGNORE), filename, "read");
+    MPI_Type_free(&columns);
+}
+
+void mpi_batch_read(mpi_batch* batch, const char* filename)
+{
+    MPI_File fh;
+    check_io(MPI_File_open(batch->comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh), filename, "open");
+    MPI_Offset size = 0;
+    check_io(MPI_File_get_size(fh, &size), filename, "read");
+
+    soa_ic_header header;
+    memset(&header, 0, sizeof(soa_ic_header));
+    if (size >= (MPI_Offset)sizeof(soa_ic_header))
+        check_io(MPI_File_read_at_all(fh, 0, &header, sizeof(soa_ic_header), MPI_BYTE, MPI_STATUS_IGNORE),
+                 filename, "read");
+    if (memcmp(header.magic, SOA_IC_MAGIC, sizeof(header.magic)) == 0)
+    {
+        read_soa_share(batch, fh, filename, &header);
+        MPI_File_close(&fh);
+        return;
+    }
+
+    // raw rows of time, Temperature, Pressure and mass fractions
+    if (size < (MPI_Offset)batch->NUM * (NN + 2) * sizeof(double))
+    {
+        if (batch->rank == 0)
+            fprintf(stderr, "File (%s) is incorrectly formatted, %d doubles were expected but only %d were read.\n",
+                    filename, batch->NUM * (NN + 2), (int)(size / sizeof(double)));
+        MPI_Abort(batch->comm, -1);
+    }
+    MPI_Datatype row;
+    MPI_Type_contiguous(NN + 2, MPI_DOUBLE, &row);
+    MPI_Type_commit(&row);
+    double* rows = (double*)malloc(((size_t)batch->num * (NN + 2) + 1) * sizeof(double));
+    check_io(MPI_File_read_at_all(fh, (MPI_Offset)batch->offset * (NN + 2) * sizeof(double), rows,
+                                  batch->num, row, MPI_STATUS_IGNORE), filename, "read");
+    MPI_Type_free(&row);
+    MPI_File_close(&fh);
+    convert_initial_conditions(rows, batch->num, batch->y, batch->var);
+    free(rows);
+}
+
+void accelerInt_mpi_integrate(mpi_batch* batch, const double t_start, const double t_end)
+{
+    if (batch->num == 0)
+        return;
+    double start = MPI_Wtime();
+    accelerInt_context_integrate(batch->context, batch->num, t_start, t_end, -1, batch->y, batch->var);
+    double elapsed = MPI_Wtime() - start;
+#ifdef COST_REORDER
+    if (batch->context->order.size == batch->num)
+    {
+        memcpy(batch->cost, batch->context->order.cost, batch->num * sizeof(double));
+        return;
+    }
+#endif
+    for (int i = 0; i < batch->num; ++i)
+        batch->cost[i] = elapsed / batch->num;
+}
+
+int mpi_batch_rebalance(mpi_batch* batch)
+{
+    double local = 0;
+    for (int i = 0; i < batch->num; ++i)
+        local += batch->cost[i];
+    double total = 0, max = 0;
+    MPI_Allreduce(&local, &total, 1, MPI_DOUBLE, MPI_SUM, batch->comm);
+    MPI_Allreduce(&local, &max, 1, MPI_DOUBLE, MPI_MAX, batch->comm);
+    if (!(total > 0) || max * batch->size <= MPI_REBALANCE_TOL * total)
+        return 0;
+
+    // the cost of the IVPs on the lower ranks
+    double prefix = 0;
+    MPI_Exscan(&local, &prefix, 1, MPI_DOUBLE, MPI_SUM, batch->comm);
+    if (batch->rank == 0)
+        prefix = 0;
+
+    const int size = batch->size;
+    int* counts = (int*)calloc(4 * size, sizeof(int));
+    int* send_counts = counts;
+    int* send_displs = &counts[size];
+    int* recv_counts = &counts[2 * size];
+    int* recv_displs = &counts[3 * size];
+    const double share = total / size;
+    for (int i = 0; i < batch->num; ++i)
+    {
+        int dest = (int)((prefix + 0.5 * batch->cost[i]) / share);
+        dest = dest < 0 ? 0 : (dest >= size ? size - 1 : dest);
+        send_counts[dest] += 1;
+        prefix += batch->cost[i];
+    }
+    MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, batch->comm);
+    int num = 0;
+    for (int r = 0; r < size; ++r)
+    {
+        send_displs[r] = r == 0 ? 0 : send_displs[r - 1] + send_counts[r - 1];
+        recv_displs[r] = num;
+        num += recv_counts[r];
+    }
+    const int moved = (batch->num - send_counts[batch->rank]) + (num - recv_counts[batch->rank]);
+
+    // exchange the IVPs as (parameter, state vector) records, which arrive in global order
+    const int width = MPI_WIDTH + 1;
+    MPI_Datatype record;
+    MPI_Type_contiguous(width, MPI_DOUBLE, &record);
+    MPI_Type_commit(&record);
+    double* send = (double*)malloc(((size_t)batch->num * width + 1) * sizeof(double));
+    double* recv = (double*)malloc(((size_t)num * width + 1) * sizeof(double));
+    for (int i = 0; i < batch->num; ++i)
+    {
+        send[i * width] = batch->var[i];
+        for (int j = 0; j < MPI_WIDTH; ++j)
+            send[i * width + j + 1] = batch->y[i + j * batch->num];
+    }
+    MPI_Alltoallv(send, send_counts, send_displs, record, recv, recv_counts, recv_displs, record, batch->comm);
+    MPI_Type_free(&record);
+    free(send);
+    free(counts);
+
+    reserve_batch(batch, num);
+    for (int i = 0; i < num; ++i)
+    {
+        batch->var[i] = recv[i * width];
+        for (int j = 0; j < MPI_WIDTH; ++j)
+            batch->y[i + j * num] = recv[i * width + j + 1];
+        batch->cost[i] = 0;
+    }
+    free(recv);
+    batch->num = num;
+    batch->offset = 0;
+    MPI_Exscan(&num, &batch->offset, 1, MPI_INT, MPI_SUM, batch->comm);
+    if (batch->rank == 0)
+        batch->offset = 0;
+
+    if (moved > 0)
+    {
+        // the per-IVP solver state is indexed by the local position
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+        cleanup_warm_start(&batch->context->warm);
+#endif
+        cleanup_ivp_order(&batch->context->order);
+    }
+    return moved;
+}
+
+void mpi_batch_gather(const mpi_batch* batch, const int root, double* y_global)
+{
+    int* counts = NULL;
+    int* displs = NULL;
+    if (batch->rank == root)
+    {
+        counts = (int*)malloc(batch->size * sizeof(int));
+        displs = (int*)malloc(batch->size * sizeof(int));
+    }
+    MPI_Gather(&batch->num, 1, MPI_INT, counts, 1, MPI_INT, root, batch->comm);
+    MPI_Gather(&batch->offset, 1, MPI_INT, displs, 1, MPI_INT, root, batch->comm);
+    for (int j = 0; j < MPI_WIDTH; ++j)
+        MPI_Gatherv(&batch->y[j * batch->num], batch->num, MPI_DOUBLE,
+                    batch->rank == root ? &y_global[j * batch->NUM] : NULL, counts, displs, MPI_DOUBLE,
+                    root, batch->comm);
+    free(counts);
+    free(displs);
+}
+
+void mpi_batch_write(const mpi_batch* batch, const char* filename)
+{
+    MPI_File fh;
+    check_io(MPI_File_open(batch->comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh),
+             filename, "open");
+    check_io(MPI_File_set_size(fh, 0), filename, "write");
+    if (batch->rank == 0)
+    {
+        soa_ic_header header;
+        memcpy(header.magic, SOA_IC_MAGIC, sizeof(header.magic));
+        header.num = batch->NUM;
+        header.width = MPI_WIDTH;
+        check_io(MPI_File_write_at(fh, 0, &header, sizeof(soa_ic_header), MPI_BYTE, MPI_STATUS_IGNORE),
+                 filename, "write");
+    }
+    const MPI_Offset var_start = (MPI_Offset)sizeof(soa_ic_header);
+    const MPI_Offset y_start = var_start + (MPI_Offset)batch->NUM * sizeof(double);
+    check_io(MPI_File_write_at_all(fh, var_start + (MPI_Offset)batch->offset * sizeof(double), batch->var,
+                                   batch->num, MPI_DOUBLE, MPI_STATUS_IGNORE), filename, "write");
+    MPI_Datatype columns;
+    MPI_Type_vector(MPI_WIDTH, batch->num, batch->NUM, MPI_DOUBLE, &columns);
+    MPI_Type_commit(&columns);
+    check_io(MPI_File_set_view(fh, y_start + (MPI_Offset)batch->offset * sizeof(double), MPI_DOUBLE, columns,
+                               "native", MPI_INFO_NULL), filename, "write");
+    check_io(MPI_File_write_all(fh, batch->y, batch->num * MPI_WIDTH, MPI_DOUBLE, MPI_STATUS_IGNORE),
+             filename, "write");
+    MPI_Type_free(&columns);
+    MPI_File_close(&fh);
+}
+
+void mpi_batch_destroy(mpi_batch* batch)
+{
+    accelerInt_destroy(batch->context);
+    free(batch->y);
+    free(batch->var);
+    free(batch->cost);
+    memset(batch, 0, sizeof(mpi_batch));
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
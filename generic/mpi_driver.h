@@ -0,0 +1,136 @@
+/**
+ * \file
+ * \brief Header definitions for the MPI distributed driver of the CPU solvers
+ *
+ * If #MPI_DRIVER is defined, a batch of IVPs may be distributed over the ranks of an MPI communicator.
+ * Each rank holds a contiguous (in the order of the initial condition file) range of the IVPs, which
+ * it integrates through its own solver instance (@see accelerInt_create).  The initial conditions are
+ * read, and the results written, with collective MPI-IO, such that no rank ever holds the full batch.
+ * Between the outer integration steps the ranges are shifted such that the measured integration cost
+ * is split evenly over the ranks (@see mpi_batch_rebalance).  The IVPs keep their global order, hence
+ * the written files are independent of the number of ranks (as are the results, unless #WARM_START is used).
+ */
+
+#ifndef MPI_DRIVER_H
+#define MPI_DRIVER_H
+
+#include "solver_options.h"
+
+#ifdef MPI_DRIVER
+
+#include <mpi.h>
+#include "solver_interface.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifndef MPI_REBALANCE_TOL
+//! The ranges are rebalanced if the cost of the slowest rank exceeds the mean cost by more than this factor
+#define MPI_REBALANCE_TOL (1.1)
+#endif
+
+/**
+ * \brief The share of a distributed IVP batch held by one rank, @see mpi_batch_create
+ */
+typedef struct
+{
+    //! The communicator the batch is distributed over
+    MPI_Comm comm;
+    //! The rank of this process in #comm
+    int rank;
+    //! The number of ranks in #comm
+    int size;
+    //! The total number of IVPs
+    int NUM;
+    //! The number of IVPs held by this rank
+    int num;
+    //! The global index of the first IVP held by this rank
+    int offset;
+    //! The allocated number of IVPs of #y and #var
+    int capacity;
+    //! The (#num * NSP) local state vectors, stored as `y[i + j * num]`
+    double* y;
+    //! The (#num) local pressures/densities
+    double* var;
+    //! The (#num) integration cost of each local IVP, measured on the last call to accelerInt_mpi_integrate
+    double* cost;
+    //! The solver instance of this rank
+    accelerInt_context* context;
+} mpi_batch;
+
+/**
+ * \brief Creates the (unfilled) share of a batch of `NUM` IVPs distributed over `comm`
+ * \param[out]      batch           The batch share of this rank
+ * \param[in]       comm            The communicator, all ranks must call this collectively
+ * \param[in]       NUM             The total number of IVPs
+ * \param[in]       num_threads     The number of OpenMP threads of the solver instance of this rank
+ *
+ * Each rank is assigned an even, contiguous share of the IVPs, to be filled by mpi_batch_read
+ * (or by the caller, via mpi_batch::offset / mpi_batch::num).
+ */
+void mpi_batch_create(mpi_batch* batch, MPI_Comm comm, const int NUM, const int num_threads);
+
+/**
+ * \brief Collectively reads the share of this rank from an initial condition file
+ * \param[in,out]   batch           The batch share of this rank
+ * \param[in]       filename        The file to read, in either format of read_initial_conditions
+ */
+void mpi_batch_read(mpi_batch* batch, const char* filename);
+
+/**
+ * \brief Integrates all local IVPs of the batch from `t_start` to `t_end`
+ * \param[in,out]   batch           The batch share of this rank
+ * \param[in]       t_start         The starting time
+ * \param[in]       t_end           The end time
+ *
+ * The integration cost of each IVP is measured for the next mpi_batch_rebalance: the wall time
+ * of each IVP if #COST_REORDER is defined, else the wall time of the rank split evenly over its IVPs.
+ */
+void accelerInt_mpi_integrate(mpi_batch* batch, const double t_start, const double t_end);
+
+/**
+ * \brief Collectively shifts the IVP ranges of the ranks to even out the measured integration cost
+ * \param[in,out]   batch           The batch share of this rank
+ * \return                          The number of IVPs this rank sent to, or received from, other ranks
+ *
+ * Nothing is moved unless the cost of the slowest rank exceeds the mean by more than #MPI_REBALANCE_TOL.
+ * Otherwise, each IVP is assigned to the rank whose (equal) share of the total cost contains the midpoint
+ * of the IVP's cost in the global prefix sum of the costs, and the states are exchanged in a single
+ * MPI_Alltoallv.  As the IVPs keep their global order, this only moves IVPs at the range boundaries.
+ * The per-IVP solver state of the ranks whose IVPs moved (e.g. the warm start memory) is reset.
+ */
+int mpi_batch_rebalance(mpi_batch* batch);
+
+/**
+ * \brief Gathers the state vectors (in global order) on a single rank
+ * \param[in]       batch           The batch share of this rank
+ * \param[in]       root            The rank to gather on
+ * \param[out]      y_global        On `root`, the (NUM * NSP) state vectors, stored as `y_global[i + j * NUM]`.
+ *                                  Ignored on the other ranks.
+ */
+void mpi_batch_gather(const mpi_batch* batch, const int root, double* y_global);
+
+/**
+ * \brief Collectively writes the batch in the pre-transposed initial condition format
+ * \param[in]       batch           The batch share of this rank
+ * \param[in]       filename        The file to write, @see write_initial_conditions
+ *
+ * The file is independent of the number of ranks, and may be read again by mpi_batch_read
+ * or read_initial_conditions (e.g. to restart the integration).
+ */
+void mpi_batch_write(const mpi_batch* batch, const char* filename);
+
+/**
+ * \brief Frees the batch share and the solver instance of this rank
+ * \param[in,out]   batch           The batch share of this rank
+ */
+void mpi_batch_destroy(mpi_batch* batch);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
+
+#endif
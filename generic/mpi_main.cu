@@ -0,0 +1,167 @@
+/**
+ * \file
+ * \brief the MPI distributed main file for all GPU solvers
+ *
+ * Contains the main function of the MPI executables (built with the MPI_DRIVER option), @see mpi_driver.cuh
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* Include CUDA libraries. */
+#include <cuda_runtime.h>
+
+//our code
+#include "header.cuh"
+#include "mpi_driver.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+/** Main function
+ *
+ * \param[in]       argc    command line argument count
+ * \param[in]       argv    command line argument vector
+ *
+ * This allows running the integrators over MPI ranks from the command line.  The syntax is as follows:\n
+ * `mpirun -np [num_ranks] ./solver-name-gpu-mpi [num_IVPs] [device]`\n
+ * *  num_IVPs     [Optional, Default:1]
+ *      *  The total number of initial value problems to solve, split over the ranks.
+ *      *  This must be less than the number of conditions in the data file if #SAME_IC is not defined.
+ *      *  If #SAME_IC is defined, then the initial conditions in the mechanism files will be used.
+ * *  device       [Optional, Default:-1]
+ *      *  The CUDA device number used by all ranks, or -1 to assign the devices of each node round-robin
+ *
+ * Each rank reads its share of the data file, and the ranks are rebalanced after every step of #t_step.
+ * If #LOG_OUTPUT is defined, the final states are written (in the pre-transposed initial condition format)
+ * to `log/[solver-name]-mpi.bin`.
+ */
+int main (int argc, char *argv[])
+{
+    MPI_Init(&argc, &argv);
+    int rank = 0;
+    int num_ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+    int NUM = 1;
+    if (argc > 1)
+    {
+        if (sscanf(argv[1], "%i", &NUM) != 1 || (NUM <= 0))
+        {
+            if (rank == 0)
+            {
+                printf("Error: Problem size not in correct range\n");
+                printf("Provide number greater than 0\n");
+            }
+            MPI_Finalize();
+            exit(1);
+        }
+    }
+    int device = -1;
+    if (argc > 2)
+    {
+        int visible_devices;
+        cudaGetDeviceCount(&visible_devices);
+        if (sscanf(argv[2], "%i", &device) != 1 || (device < -1) || (device >= visible_devices))
+        {
+            if (rank == 0)
+            {
+                printf("Error: GPU device number not in correct range\n");
+                printf("Provide number between 0 and %i, or -1 to assign the devices round-robin\n", visible_devices - 1);
+            }
+            MPI_Finalize();
+            exit(1);
+        }
+    }
+
+    if (rank == 0)
+    {
+        printf ("# ODEs: %d\n", NUM);
+        printf ("# ranks: %d\n", num_ranks);
+    }
+
+    mpi_batch batch;
+    mpi_batch_create(&batch, MPI_COMM_WORLD, NUM, device);
+
+#ifdef SAME_IC
+    double* y_same;
+    double* var_same;
+    set_same_initial_conditions(batch.num, &y_same, &var_same);
+    memcpy(batch.y, y_same, batch.num * NN * sizeof(double));
+    memcpy(batch.var, var_same, batch.num * sizeof(double));
+    free(y_same);
+    free(var_same);
+#elif defined(SHUFFLE)
+    mpi_batch_read(&batch, "shuffled_data.bin");
+#else
+    mpi_batch_read(&batch, "ign_data.bin");
+#endif
+
+#ifdef LOG_OUTPUT
+    const char* f_name = solver_name();
+    char out_name[strlen(f_name) + 17];
+    struct stat info;
+    if (rank == 0 && stat("./log/", &info) != 0)
+    {
+        printf("Expecting 'log' subdirectory in current working directory. Please run"
+               " mkdir log (or the equivalent) and run again.\n");
+        MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+    sprintf(out_name, "log/%s-mpi.bin", f_name);
+#endif
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+
+    double t = 0;
+    double t_next = fmin(end_time, t_step);
+    int numSteps = 0;
+    long int moved = 0;
+    while (t + EPS < end_time)
+    {
+        numSteps++;
+        accelerInt_mpi_integrate(&batch, t, t_next);
+        t = t_next;
+        t_next = fmin(end_time, (numSteps + 1) * t_step);
+        if (t + EPS < end_time)
+            moved += mpi_batch_rebalance(&batch);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double runtime = MPI_Wtime() - start;
+
+#ifdef LOG_OUTPUT
+    mpi_batch_write(&batch, out_name);
+#endif
+
+    // the final temperature of the first IVP, from whichever rank holds it
+    double T_local = batch.offset == 0 && batch.num > 0 ? batch.y[0] : -DBL_MAX;
+    double T_final = 0;
+    MPI_Reduce(&T_local, &T_final, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    long int moved_total = 0;
+    MPI_Reduce(&moved, &moved_total, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0)
+    {
+        printf ("Time: %.15e sec\n", runtime);
+        runtime = runtime / ((double)(numSteps));
+        printf ("Time per step: %e (s)\t%.15e (s/thread)\n", runtime, runtime / NUM);
+        // each migrated IVP is counted by its sending and receiving rank
+        printf ("IVPs migrated: %ld\n", moved_total / 2);
+        printf ("TFinal: %e\n", T_final);
+    }
+
+    mpi_batch_destroy(&batch);
+    MPI_Finalize();
+    return 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
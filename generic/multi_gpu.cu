@@ -0,0 +1,591 @@
+/**
+ * \file
+ * \brief Sharding of IVP batches over multiple GPUs
+ *
+ * The IVPs are split into contiguous shards (optionally weighted by device speed),
+ * each of which is driven by a separate host thread on its own device.
+ */
+
+#include <string.h>
+#include "multi_gpu.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+/**
+ * \brief Splits NUM IVPs over the given devices and initializes the memory on each device
+ *
+ * \param[in]       NUM             The number of ODEs to integrate
+ * \param[in]       num_devices     The number of devices to use, if <= 0 all visible devices are used
+ * \param[in]       devices         The CUDA device numbers, if NULL devices 0 to `num_devices - 1` are used
+ * \param[in]       weights         The relative weights of the devices, if NULL the IVPs are split evenly
+ * \param[out]      shards          The shards to initialize, must have room for #MAX_DEVICES entries
+ * \param[in]       reset_devices   If true (and #GPU_ARENA is not defined) the devices are reset first.  This must be
+ *                                  false if other solver instances (or other code) may be using the devices.
+ * \return                          The number of shards initialized
+ *
+ * Each device receives `NUM * weights[i] / sum(weights)` IVPs (the last device receives the remainder),
+ * and the padded number of IVPs per kernel call is computed per device from its free memory.
+ * Devices that receive no IVPs are not initialized.
+ *
+ * If #PERSISTENT_KERNEL is defined, the state of all IVPs of the shard is kept on the device in the
+ * shard's ivp_queue, and the padded number of IVPs is further limited to the number of threads
+ * that may be resident on the device at once.
+ *
+ * If #GPU_ARENA is defined, the devices are not reset, and the memory of each shard is carved out of
+ * the shard's gpu_arena.  The shards must then be zero-initialized before the first call, and an arena
+ * kept by release_shards is reused by the next call on the same device.
+ *
+ * If #MANAGED_MEMORY is defined, the memory of each shard is managed (@see gpu_arena.cuh) and may
+ * oversubscribe the device, hence the padded number of IVPs covers the whole shard regardless of
+ * the free memory.  The devices must support concurrent managed access.
+ */
+int initialize_shards(const int NUM, int num_devices, const int* devices, const double* weights,
+                      device_shard* shards, const bool reset_devices)
+{
+    int visible_devices = 0;
+    cudaErrorCheck( cudaGetDeviceCount(&visible_devices) );
+    if (num_devices <= 0)
+        num_devices = visible_devices;
+    num_devices = min(num_devices, MAX_DEVICES);
+
+    double weight_sum = 0;
+    for (int i = 0; i < num_devices; ++i)
+    {
+        int id = devices == NULL ? i : devices[i];
+        if (id < 0 || id >= visible_devices)
+        {
+            printf("Error: GPU device number not in correct range\n");
+            printf("Provide number between 0 and %i\n", visible_devices - 1);
+            exit(1);
+        }
+        double w = weights == NULL ? 1.0 : weights[i];
+        if (w < 0)
+        {
+            printf("Error: negative weight specified for GPU device %d\n", id);
+            exit(1);
+        }
+        weight_sum += w;
+    }
+    if (weight_sum <= 0)
+    {
+        printf("Error: the sum of the GPU device weights must be positive\n");
+        exit(1);
+    }
+
+    size_t size_per_thread = required_mechanism_size() + required_solver_size();
+    int num_shards = 0;
+    int offset = 0;
+    for (int i = 0; i < num_devices; ++i)
+    {
+        double w = weights == NULL ? 1.0 : weights[i];
+        int num = i == num_devices - 1 ? NUM - offset : int(floor(NUM * w / weight_sum));
+        num = min(num, NUM - offset);
+        if (num <= 0)
+            continue;
+
+        device_shard* shard = &shards[num_shards++];
+        shard->device = devices == NULL ? i : devices[i];
+        shard->offset = offset;
+        shard->num = num;
+        offset += num;
+
+        cudaErrorCheck( cudaSetDevice (shard->device) );
+#ifndef GPU_ARENA
+        if (reset_devices)
+            cudaErrorCheck( cudaDeviceReset() );
+#endif
+        cudaErrorCheck( cudaPeekAtLastError() );
+        cudaErrorCheck( cudaDeviceSynchronize() );
+        //bump up shared mem bank size
+        cudaErrorCheck(cudaDeviceSetSharedMemConfig(cudaSharedMemBankSizeEightByte));
+        //and the L1 / shared memory split, see launch_config.cuh
+        cudaErrorCheck(cudaDeviceSetCacheConfig(CACHE_CONFIG));
+
+#ifdef PERSISTENT_KERNEL
+        // the work queue holds all IVPs of the shard, and must be allocated before the free memory is queried
+        ivp_queue* queue = &shard->queue;
+        queue->num = num;
+        cudaErrorCheck( cudaMalloc(&queue->next, sizeof(int)) );
+        cudaErrorCheck( cudaMalloc(&queue->var, num * sizeof(double)) );
+        cudaErrorCheck( cudaMalloc(&queue->y, NSP * num * sizeof(double)) );
+        cudaErrorCheck( cudaMalloc(&queue->result, num * sizeof(int)) );
+#ifdef STATISTICS
+        cudaErrorCheck( cudaMalloc(&queue->stats, NUM_STATS * num * sizeof(int)) );
+#endif
+#ifdef SOLVER_WARM_START
+        cudaErrorCheck( cudaMalloc(&queue->warm, WARM_SIZE * num * sizeof(double)) );
+#endif
+#endif
+
+        size_t free_mem = 0;
+        size_t total_mem = 0;
+        cudaErrorCheck( cudaMemGetInfo (&free_mem, &total_mem) );
+#ifdef GPU_ARENA
+        // the arena of a previous initialization on this device is reused (or reallocated)
+        if (shard->arena.base != NULL && shard->arena.device == shard->device)
+            free_mem += shard->arena.capacity;
+#endif
+
+#ifdef MANAGED_MEMORY
+        // the pages of the solver memory migrate on demand, and the whole shard is solved in one launch
+        int concurrent_managed = 0;
+        cudaErrorCheck( cudaDeviceGetAttribute(&concurrent_managed, cudaDevAttrConcurrentManagedAccess, shard->device) );
+        if (!concurrent_managed)
+        {
+            printf("Error: GPU device %d does not support concurrent managed memory access.\n", shard->device);
+            exit(-1);
+        }
+        int padded = num;
+#else
+        //conservatively estimate the maximum allowable threads
+        int max_threads = int(floor(0.8 * ((double)free_mem) / ((double)size_per_thread)));
+        int padded = min(num, max_threads);
+#endif
+#ifdef PERSISTENT_KERNEL
+        // launching more threads than can be resident only recreates the tail
+        int blocks_per_sm = 0;
+        int num_sm = 0;
+        cudaErrorCheck( cudaOccupancyMaxActiveBlocksPerMultiprocessor(&blocks_per_sm, intDriverPersistent,
+                                                                      TARGET_BLOCK_SIZE, SHARED_SIZE + SOLVER_SHARED_SIZE) );
+        cudaErrorCheck( cudaDeviceGetAttribute(&num_sm, cudaDevAttrMultiProcessorCount, shard->device) );
+        padded = min(padded, max(blocks_per_sm, 1) * num_sm * TARGET_BLOCK_SIZE);
+#endif
+        //padded is next factor of block size up
+        padded = int(ceil(padded / float(TARGET_BLOCK_SIZE)) * TARGET_BLOCK_SIZE);
+        if (padded == 0)
+        {
+            printf("Mechanism is too large to fit into global CUDA memory of device %d... exiting.", shard->device);
+            exit(-1);
+        }
+        shard->padded = padded;
+        shard->dimGrid = dim3(padded * DRIVER_THREADS_PER_IVP / TARGET_BLOCK_SIZE, 1);
+
+        shard->host_solver = (solver_memory*)malloc(sizeof(solver_memory));
+        shard->host_mech = (mechanism_memory*)malloc(sizeof(mechanism_memory));
+#ifdef GPU_ARENA
+        arena_reserve(&shard->arena, arena_required_size(padded, size_per_thread));
+        arena_begin(&shard->arena);
+#endif
+        initialize_gpu_memory(padded, &shard->host_mech, &shard->device_mech);
+        initialize_solver(padded, &shard->host_solver, &shard->device_solver);
+#ifdef GPU_ARENA
+        arena_end();
+#endif
+#ifdef PERSISTENT_KERNEL
+        // the host storage covers the whole queue
+        int staged = num;
+#else
+        int staged = padded;
+#endif
+        shard->result_flag = (int*)malloc(staged * sizeof(int));
+#ifdef STATISTICS
+        shard->stats_temp = (int*)malloc(NUM_STATS * staged * sizeof(int));
+#endif
+#ifdef SOLVER_WARM_START
+        shard->warm_temp = (double*)malloc(WARM_SIZE * staged * sizeof(double));
+#endif
+        cudaErrorCheck( cudaStreamCreate(&shard->stream) );
+#ifdef DEVICE_REDUCE
+        create_chunk_reduction(&shard->reduction);
+        memset(&shard->ignition, 0, sizeof(ignition_state));
+#endif
+    }
+    return num_shards;
+}
+
+#ifdef MANAGED_MEMORY
+/**
+ * \brief Returns true if `ptr` is a managed allocation
+ */
+static bool is_managed(const void* ptr)
+{
+    cudaPointerAttributes attributes;
+    if (cudaPointerGetAttributes(&attributes, ptr) != cudaSuccess)
+    {
+        // unregistered host memory, clear the error
+        cudaGetLastError();
+        return false;
+    }
+    return attributes.type == cudaMemoryTypeManaged;
+}
+
+/**
+ * \brief Integrates the IVPs of a shard in place in the (managed) `y_host`, in a single launch
+ *
+ * \param[in,out]       state           The host state of the solver instance
+ * \param[in]           shard           The shard
+ * \param[in]           NUM             The leading dimension of `y_host` and `var_host`
+ * \param[in]           t               The current system time
+ * \param[in]           t_next          The end time of this step
+ * \param[in,out]       y_host          The (managed) state vectors to integrate
+ * \param[in]           var_host        The (managed) parameters to use in dydt() and eval_jacob()
+ *
+ * The rows of the shard in `y_host` and `var_host` are prefetched to the device ahead of the
+ * launch of intDriverManaged, and the state vectors, result codes, statistics and warm start state
+ * are prefetched back to the host behind it on the same stream.  The result codes, statistics and
+ * warm start state are then read from (written to) the managed solver memory directly.
+ */
+static void integrate_managed(host_state* state, device_shard* shard, const int NUM,
+                              const double t, const double t_next,
+                              double * __restrict__ y_host, const double * __restrict__ var_host)
+{
+    dim3 dimBlock(TARGET_BLOCK_SIZE, 1);
+    const int offset = shard->offset;
+    const int num = shard->num;
+    const int padded = shard->padded;
+    solver_memory* host_solver = shard->host_solver;
+
+    RANGE_PUSH("prefetch");
+    for (int i = 0; i < NSP; ++i)
+        cudaErrorCheck( cudaMemPrefetchAsync(&y_host[offset + i * NUM], num * sizeof(double),
+                                             shard->device, shard->stream) );
+    cudaErrorCheck( cudaMemPrefetchAsync(&var_host[offset], num * sizeof(double), shard->device, shard->stream) );
+#ifdef SOLVER_WARM_START
+    load_warm_start(&state->warm, offset, num, padded, host_solver->warm);
+    cudaErrorCheck( cudaMemPrefetchAsync(host_solver->warm, WARM_SIZE * padded * sizeof(double),
+                                         shard->device, shard->stream) );
+#endif
+    RANGE_POP();
+    RANGE_PUSH("integrate");
+    intDriverManaged <<< shard->dimGrid, dimBlock, SHARED_SIZE + SOLVER_SHARED_SIZE, shard->stream >>> (num, NUM, t, t_next,
+                                                                       &var_host[offset], &y_host[offset],
+                                                                       shard->device_mech, shard->device_solver);
+#ifdef DEBUG
+    cudaErrorCheck( cudaPeekAtLastError() );
+    cudaErrorCheck( cudaStreamSynchronize(shard->stream) );
+#endif
+    for (int i = 0; i < NSP; ++i)
+        cudaErrorCheck( cudaMemPrefetchAsync(&y_host[offset + i * NUM], num * sizeof(double),
+                                             cudaCpuDeviceId, shard->stream) );
+    cudaErrorCheck( cudaMemPrefetchAsync(host_solver->result, num * sizeof(int), cudaCpuDeviceId, shard->stream) );
+#ifdef STATISTICS
+    cudaErrorCheck( cudaMemPrefetchAsync(host_solver->stats, NUM_STATS * padded * sizeof(int),
+                                         cudaCpuDeviceId, shard->stream) );
+#endif
+#ifdef SOLVER_WARM_START
+    cudaErrorCheck( cudaMemPrefetchAsync(host_solver->warm, WARM_SIZE * padded * sizeof(double),
+                                         cudaCpuDeviceId, shard->stream) );
+#endif
+    cudaErrorCheck( cudaStreamSynchronize(shard->stream) );
+    RANGE_POP();
+    check_error(num, host_solver->result);
+#ifdef STATISTICS
+    accumulate_statistics(&state->stats, offset, num, padded, host_solver->stats);
+#endif
+#ifdef SOLVER_WARM_START
+    store_warm_start(&state->warm, offset, num, padded, host_solver->warm);
+#endif
+}
+#endif
+
+/**
+ * \brief integrate all shards from time `t` to time `t_next`, driving each device from its own host thread
+ *
+ * \param[in,out]       state           The host state (statistics, warm start state, phase totals) of the solver instance
+ * \param[in]           num_shards      The number of shards
+ * \param[in]           shards          The shards initialized by initialize_shards
+ * \param[in]           NUM             The number of ODEs to integrate (leading dimension of `y_host` and `var_host`)
+ * \param[in]           t               The current system time
+ * \param[in]           t_next          The end time of this step
+ * \param[in,out]       y_host          The state vectors to integrate
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * The state vectors of each chunk are transferred directly from / to their (strided) location
+ * in `y_host`, hence the shards never touch the same host memory.  All work of a shard is issued
+ * on its own stream, such that shards of independent solver instances on the same device may overlap.
+ * If the solver defines SOLVER_WARM_START, the warm start state of each chunk is loaded before
+ * and stored after each kernel call, @see warm_start.cuh
+ *
+ * If #PERSISTENT_KERNEL is defined, all IVPs of the shard are instead transferred to the shard's
+ * ivp_queue, and solved by a single launch of intDriverPersistent, @see intDriverPersistent
+ *
+ * If #MANAGED_MEMORY is defined and `y_host` and `var_host` are managed allocations, each shard is
+ * integrated in place without staging copies, @see integrate_managed.  Otherwise the (single) chunk
+ * of each shard is copied as above.
+ *
+ * If #DEVICE_REDUCE is defined, the result codes of each chunk are reduced on the device instead of
+ * being copied back, and the ignition times are updated if reset_shard_ignition was called,
+ * @see device_reduce.cuh
+ *
+ * If #PROFILE_PHASES is defined, the phase counters of each shard are reduced on its device
+ * after the step, @see accumulate_phase_profile
+ */
+void integrate_shards(host_state* state, const int num_shards, device_shard* shards, const int NUM,
+                      const double t, const double t_next,
+                      double * __restrict__ y_host, const double * __restrict__ var_host)
+{
+    dim3 dimBlock(TARGET_BLOCK_SIZE, 1);
+#ifdef SOLVER_WARM_START
+    resize_warm_start(&state->warm, NUM);
+#endif
+    #pragma omp parallel for num_threads(num_shards)
+    for (int d = 0; d < num_shards; ++d)
+    {
+        device_shard* shard = &shards[d];
+        cudaErrorCheck( cudaSetDevice(shard->device) );
+#ifdef DEVICE_REDUCE
+        begin_ignition_step(&shard->ignition);
+#endif
+#ifdef PERSISTENT_KERNEL
+        const ivp_queue* queue = &shard->queue;
+        const int num = shard->num;
+        cudaErrorCheck( cudaMemcpyAsync (queue->var, &var_host[shard->offset],
+                                         num * sizeof(double), cudaMemcpyHostToDevice, shard->stream) );
+        cudaErrorCheck( cudaMemcpy2DAsync (queue->y, num * sizeof(double),
+                                           &y_host[shard->offset], NUM * sizeof(double),
+                                           num * sizeof(double), NSP,
+                                           cudaMemcpyHostToDevice, shard->stream) );
+#ifdef SOLVER_WARM_START
+        load_warm_start(&state->warm, shard->offset, num, num, shard->warm_temp);
+        cudaErrorCheck( cudaMemcpyAsync (queue->warm, shard->warm_temp, WARM_SIZE * num * sizeof(double),
+                                         cudaMemcpyHostToDevice, shard->stream) );
+#endif
+        cudaErrorCheck( cudaMemsetAsync (queue->next, 0, sizeof(int), shard->stream) );
+        RANGE_PUSH("integrate");
+        intDriverPersistent <<< shard->dimGrid, dimBlock, SHARED_SIZE + SOLVER_SHARED_SIZE, shard->stream >>> (t, t_next, *queue,
+                                                                            shard->device_mech, shard->device_solver);
+    #ifdef DEBUG
+        cudaErrorCheck( cudaPeekAtLastError() );
+        cudaErrorCheck( cudaStreamSynchronize(shard->stream) );
+    #endif
+        // copy the result flags back
+        cudaErrorCheck( cudaMemcpyAsync(shard->result_flag, queue->result, num * sizeof(int),
+                                        cudaMemcpyDeviceToHost, shard->stream) );
+        cudaErrorCheck( cudaStreamSynchronize(shard->stream) );
+        RANGE_POP();
+        check_error(num, shard->result_flag);
+        // transfer memory back to CPU
+        cudaErrorCheck( cudaMemcpy2DAsync (&y_host[shard->offset], NUM * sizeof(double),
+                                           queue->y, num * sizeof(double),
+                                           num * sizeof(double), NSP,
+                                           cudaMemcpyDeviceToHost, shard->stream) );
+#ifdef STATISTICS
+        cudaErrorCheck( cudaMemcpyAsync (shard->stats_temp, queue->stats, NUM_STATS * num * sizeof(int),
+                                         cudaMemcpyDeviceToHost, shard->stream) );
+#endif
+#ifdef SOLVER_WARM_START
+        cudaErrorCheck( cudaMemcpyAsync (shard->warm_temp, queue->warm, WARM_SIZE * num * sizeof(double),
+                                         cudaMemcpyDeviceToHost, shard->stream) );
+#endif
+        cudaErrorCheck( cudaStreamSynchronize(shard->stream) );
+#ifdef STATISTICS
+        accumulate_statistics(&state->stats, shard->offset, num, num, shard->stats_temp);
+#endif
+#ifdef SOLVER_WARM_START
+        store_warm_start(&state->warm, shard->offset, num, num, shard->warm_temp);
+#endif
+#else
+#ifdef MANAGED_MEMORY
+        if (is_managed(y_host) && is_managed(var_host))
+            integrate_managed(state, shard, NUM, t, t_next, y_host, var_host);
+        else
+#endif
+        for (int num_solved = 0; num_solved < shard->num;)
+        {
+            int offset = shard->offset + num_solved;
+            int num_cond = min(shard->num - num_solved, shard->padded);
+
+            RANGE_PUSH("upload");
+            cudaErrorCheck( cudaMemcpyAsync (shard->host_mech->var, &var_host[offset],
+                                             num_cond * sizeof(double), cudaMemcpyHostToDevice, shard->stream) );
+            cudaErrorCheck( cudaMemcpy2DAsync (shard->host_mech->y, shard->padded * sizeof(double),
+                                               &y_host[offset], NUM * sizeof(double),
+                                               num_cond * sizeof(double), NSP,
+                                               cudaMemcpyHostToDevice, shard->stream) );
+#ifdef SOLVER_WARM_START
+            load_warm_start(&state->warm, offset, num_cond, shard->padded, shard->warm_temp);
+            cudaErrorCheck( cudaMemcpy2DAsync (shard->host_solver->warm, shard->padded * sizeof(double),
+                                               shard->warm_temp, shard->padded * sizeof(double),
+                                               num_cond * sizeof(double), WARM_SIZE,
+                                               cudaMemcpyHostToDevice, shard->stream) );
+#endif
+            RANGE_POP();
+            RANGE_PUSH("integrate");
+#ifdef BATCHED_LU
+            // relaunched until no IVP is suspended at a (batched) factorization, @see batched_lu.cuh
+            batched_lu_begin(&shard->host_solver->batched, shard->stream);
+            do {
+#endif
+            intDriver <<< shard->dimGrid, dimBlock, SHARED_SIZE + SOLVER_SHARED_SIZE, shard->stream >>> (num_cond, t, t_next,
+                                                                      shard->host_mech->var,
+                                                                      shard->host_mech->y, shard->device_mech,
+                                                                      shard->device_solver);
+#ifdef BATCHED_LU
+            } while (batched_lu_factor(&shard->host_solver->batched, shard->stream));
+#endif
+    #ifdef DEBUG
+            cudaErrorCheck( cudaPeekAtLastError() );
+            cudaErrorCheck( cudaStreamSynchronize(shard->stream) );
+    #endif
+#ifdef DEVICE_REDUCE
+            // only the summary of the chunk is copied back
+            enqueue_chunk_reduction(&shard->reduction, num_cond, shard->host_solver->result, shard->host_mech->y,
+                                    offset - shard->offset, t_next, &shard->ignition, shard->stream);
+            cudaErrorCheck( cudaStreamSynchronize(shard->stream) );
+            RANGE_POP();
+            finish_chunk_reduction(&shard->reduction, num_cond, shard->host_solver->result, shard->result_flag,
+                                   &shard->ignition);
+#else
+            // copy the result flag back
+            cudaErrorCheck( cudaMemcpyAsync(shard->result_flag, shard->host_solver->result, num_cond * sizeof(int),
+                                            cudaMemcpyDeviceToHost, shard->stream) );
+            cudaErrorCheck( cudaStreamSynchronize(shard->stream) );
+            RANGE_POP();
+            check_error(num_cond, shard->result_flag);
+#endif
+            RANGE_PUSH("download");
+            // transfer memory back to CPU
+            cudaErrorCheck( cudaMemcpy2DAsync (&y_host[offset], NUM * sizeof(double),
+                                               shard->host_mech->y, shard->padded * sizeof(double),
+                                               num_cond * sizeof(double), NSP,
+                                               cudaMemcpyDeviceToHost, shard->stream) );
+#ifdef STATISTICS
+            // and the statistics of this chunk
+            cudaErrorCheck( cudaMemcpy2DAsync (shard->stats_temp, shard->padded * sizeof(int),
+                                               shard->host_solver->stats, shard->padded * sizeof(int),
+                                               num_cond * sizeof(int), NUM_STATS,
+                                               cudaMemcpyDeviceToHost, shard->stream) );
+#endif
+#ifdef SOLVER_WARM_START
+            // and the warm start state
+            cudaErrorCheck( cudaMemcpy2DAsync (shard->warm_temp, shard->padded * sizeof(double),
+                                               shard->host_solver->warm, shard->padded * sizeof(double),
+                                               num_cond * sizeof(double), WARM_SIZE,
+                                               cudaMemcpyDeviceToHost, shard->stream) );
+#endif
+            cudaErrorCheck( cudaStreamSynchronize(shard->stream) );
+#ifdef STATISTICS
+            accumulate_statistics(&state->stats, offset, num_cond, shard->padded, shard->stats_temp);
+#endif
+#ifdef SOLVER_WARM_START
+            store_warm_start(&state->warm, offset, num_cond, shard->padded, shard->warm_temp);
+#endif
+            RANGE_POP();
+            num_solved += num_cond;
+        }
+#endif
+#ifdef PROFILE_PHASES
+        accumulate_phase_profile(&state->profile, shard->host_solver->phases, shard->padded, shard->stream);
+#endif
+    }
+}
+
+#ifdef DEVICE_REDUCE
+/**
+ * \brief Starts the device-side ignition detection of all shards, at the current temperatures of `y_host`
+ *
+ * \param[in]           num_shards      The number of shards
+ * \param[in,out]       shards          The shards initialized by initialize_shards
+ * \param[in]           y_host          The state vectors, whose first row (of NUM entries) are the temperatures
+ *
+ * Each shard covers the ignition of its own IVPs, indexed from its offset.
+ */
+void reset_shard_ignition(const int num_shards, device_shard* shards, const double* y_host)
+{
+    for (int d = 0; d < num_shards; ++d)
+    {
+        device_shard* shard = &shards[d];
+        cudaErrorCheck( cudaSetDevice(shard->device) );
+        reset_ignition(&shard->ignition, shard->num, &y_host[shard->offset], shard->stream);
+    }
+}
+
+/**
+ * \brief Returns the ignition totals of the last step of all shards, and (optionally) the ignition times
+ *
+ * \param[in]           num_shards      The number of shards
+ * \param[in]           shards          The shards initialized by initialize_shards
+ * \param[out]          num_ignited     The number of ignited IVPs
+ * \param[out]          max_T           The maximum temperature since reset_shard_ignition
+ * \param[out]          times           The (NUM) ignition times, negative if not ignited, or NULL
+ */
+void get_shard_ignition(const int num_shards, const device_shard* shards, int* num_ignited, double* max_T,
+                        double* times)
+{
+    *num_ignited = 0;
+    *max_T = 0;
+    for (int d = 0; d < num_shards; ++d)
+    {
+        const device_shard* shard = &shards[d];
+        *num_ignited += shard->ignition.num_ignited;
+        *max_T = fmax(*max_T, shard->ignition.max_T);
+        if (times != NULL)
+        {
+            cudaErrorCheck( cudaSetDevice(shard->device) );
+            get_ignition_times(&shard->ignition, &times[shard->offset]);
+        }
+    }
+}
+#endif
+
+/**
+ * \brief Frees the memory of all shards, but keeps the device arenas (if #GPU_ARENA is defined)
+ *        for re-initialization by initialize_shards
+ *
+ * \param[in]           num_shards      The number of shards
+ * \param[in,out]       shards          The shards initialized by initialize_shards
+ */
+void release_shards(const int num_shards, device_shard* shards)
+{
+    for (int d = 0; d < num_shards; ++d)
+    {
+        device_shard* shard = &shards[d];
+        cudaErrorCheck( cudaSetDevice(shard->device) );
+        free_gpu_memory(&shard->host_mech, &shard->device_mech);
+        cleanup_solver(&shard->host_solver, &shard->device_solver);
+        cudaErrorCheck( cudaStreamDestroy(shard->stream) );
+        free(shard->host_mech);
+        free(shard->host_solver);
+        free(shard->result_flag);
+#ifdef DEVICE_REDUCE
+        free_chunk_reduction(&shard->reduction);
+        free_ignition(&shard->ignition);
+#endif
+#ifdef STATISTICS
+        free(shard->stats_temp);
+#endif
+#ifdef SOLVER_WARM_START
+        free(shard->warm_temp);
+#endif
+#ifdef PERSISTENT_KERNEL
+        cudaErrorCheck( cudaFree(shard->queue.next) );
+        cudaErrorCheck( cudaFree(shard->queue.var) );
+        cudaErrorCheck( cudaFree(shard->queue.y) );
+        cudaErrorCheck( cudaFree(shard->queue.result) );
+#ifdef STATISTICS
+        cudaErrorCheck( cudaFree(shard->queue.stats) );
+#endif
+#ifdef SOLVER_WARM_START
+        cudaErrorCheck( cudaFree(shard->queue.warm) );
+#endif
+#endif
+    }
+}
+
+/**
+ * \brief Frees the memory of all shards and resets the devices
+ *
+ * \param[in]           num_shards      The number of shards
+ * \param[in,out]       shards          The shards initialized by initialize_shards
+ *
+ * If #GPU_ARENA is defined, the device arenas are freed instead of resetting the devices.
+ */
+void cleanup_shards(const int num_shards, device_shard* shards)
+{
+    release_shards(num_shards, shards);
+    for (int d = 0; d < num_shards; ++d)
+    {
+        cudaErrorCheck( cudaSetDevice(shards[d].device) );
+#ifdef GPU_ARENA
+        arena_release(&shards[d].arena);
+#else
+        cudaErrorCheck( cudaDeviceReset() );
+#endif
+    }
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,159 @@
+/**
+ * \file
+ * \brief Header definitions for sharding IVP batches over multiple GPUs
+ *
+ * Contains the per-device shard struct and the initialization, integration and cleanup
+ * routines used by both solver_main.cu and solver_interface.cu
+ */
+
+#ifndef MULTI_GPU_CUH
+#define MULTI_GPU_CUH
+
+#include "solver.cuh"
+#include "solver_init.cuh"
+#include "launch_bounds.cuh"
+#include "gpu_macros.cuh"
+#include "gpu_memory.cuh"
+#include "header.cuh"
+#include "solver_props.cuh"
+#include "host_state.cuh"
+#include "gpu_arena.cuh"
+#include "device_reduce.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The maximum number of devices that IVPs may be sharded over
+#define MAX_DEVICES (16)
+
+#if defined(MANAGED_MEMORY) && defined(PERSISTENT_KERNEL)
+#error "MANAGED_MEMORY and PERSISTENT_KERNEL are mutually exclusive"
+#endif
+
+/**
+ * \brief The per-device state for a shard of the IVP batch
+ *
+ * \param           device          The CUDA device number
+ * \param           offset          The index of the first IVP in this shard
+ * \param           num             The number of IVPs in this shard
+ * \param           padded          The padded number of IVPs solved per kernel call on this device
+ * \param           host_solver     The host version of the solver_memory struct
+ * \param           device_solver   The device version of the solver_memory struct
+ * \param           host_mech       The host version of the mechanism_memory struct
+ * \param           device_mech     The device version of the mechanism_memory struct
+ * \param           dimGrid         The grid size on this device
+ * \param           stream          The stream all work of this shard is issued on
+ * \param           result_flag     Host storage for the result codes
+ * \param           stats_temp      Host storage for the per-IVP statistics (if #STATISTICS is defined)
+ * \param           warm_temp       Host storage for the per-IVP warm start state (if the solver defines SOLVER_WARM_START)
+ * \param           queue           The device work queue covering all IVPs of this shard (if #PERSISTENT_KERNEL is defined)
+ * \param           arena           The device memory arena of the mechanism_memory and solver_memory (if #GPU_ARENA is defined)
+ * \param           reduction       The summary of the last chunk (if #DEVICE_REDUCE is defined)
+ * \param           ignition        The ignition state of the IVPs of this shard (if #DEVICE_REDUCE and #IGN are defined)
+ */
+struct device_shard {
+    int device;
+    int offset;
+    int num;
+    int padded;
+    solver_memory* host_solver, *device_solver;
+    mechanism_memory* host_mech, *device_mech;
+    dim3 dimGrid;
+    cudaStream_t stream;
+    int* result_flag;
+#ifdef STATISTICS
+    int* stats_temp;
+#endif
+#ifdef SOLVER_WARM_START
+    double* warm_temp;
+#endif
+#ifdef PERSISTENT_KERNEL
+    ivp_queue queue;
+#endif
+#ifdef GPU_ARENA
+    gpu_arena arena;
+#endif
+#ifdef DEVICE_REDUCE
+    chunk_reduction reduction;
+    ignition_state ignition;
+#endif
+};
+
+/**
+ * \brief Splits NUM IVPs over the given devices and initializes the memory on each device
+ *
+ * \param[in]       NUM             The number of ODEs to integrate
+ * \param[in]       num_devices     The number of devices to use, if <= 0 all visible devices are used
+ * \param[in]       devices         The CUDA device numbers, if NULL devices 0 to `num_devices - 1` are used
+ * \param[in]       weights         The relative weights of the devices, if NULL the IVPs are split evenly
+ * \param[out]      shards          The shards to initialize, must have room for #MAX_DEVICES entries
+ * \param[in]       reset_devices   If true (and #GPU_ARENA is not defined) the devices are reset first
+ * \return                          The number of shards initialized
+ */
+int initialize_shards(const int NUM, int num_devices, const int* devices, const double* weights,
+                      device_shard* shards, const bool reset_devices);
+
+/**
+ * \brief integrate all shards from time `t` to time `t_next`, driving each device from its own host thread
+ *
+ * \param[in,out]       state           The host state (statistics, warm start state, phase totals) of the solver instance
+ * \param[in]           num_shards      The number of shards
+ * \param[in]           shards          The shards initialized by initialize_shards
+ * \param[in]           NUM             The number of ODEs to integrate (leading dimension of `y_host` and `var_host`)
+ * \param[in]           t               The current system time
+ * \param[in]           t_next          The end time of this step
+ * \param[in,out]       y_host          The state vectors to integrate
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ */
+void integrate_shards(host_state* state, const int num_shards, device_shard* shards, const int NUM,
+                      const double t, const double t_next,
+                      double * __restrict__ y_host, const double * __restrict__ var_host);
+
+#ifdef DEVICE_REDUCE
+/**
+ * \brief Starts the device-side ignition detection of all shards, at the current temperatures of `y_host`
+ *
+ * \param[in]           num_shards      The number of shards
+ * \param[in,out]       shards          The shards initialized by initialize_shards
+ * \param[in]           y_host          The state vectors, whose first row (of NUM entries) are the temperatures
+ */
+void reset_shard_ignition(const int num_shards, device_shard* shards, const double* y_host);
+
+/**
+ * \brief Returns the ignition totals of the last step of all shards, and (optionally) the ignition times
+ *
+ * \param[in]           num_shards      The number of shards
+ * \param[in]           shards          The shards initialized by initialize_shards
+ * \param[out]          num_ignited     The number of ignited IVPs
+ * \param[out]          max_T           The maximum temperature since reset_shard_ignition
+ * \param[out]          times           The (NUM) ignition times, negative if not ignited, or NULL
+ */
+void get_shard_ignition(const int num_shards, const device_shard* shards, int* num_ignited, double* max_T,
+                        double* times);
+#endif
+
+/**
+ * \brief Frees the memory of all shards, but keeps the device arenas (if #GPU_ARENA is defined)
+ *        for re-initialization by initialize_shards
+ *
+ * \param[in]           num_shards      The number of shards
+ * \param[in,out]       shards          The shards initialized by initialize_shards
+ */
+void release_shards(const int num_shards, device_shard* shards);
+
+/**
+ * \brief Frees the memory of all shards and resets the devices
+ *
+ * \param[in]           num_shards      The number of shards
+ * \param[in,out]       shards          The shards initialized by initialize_shards
+ *
+ * If #GPU_ARENA is defined, the device arenas are freed instead of resetting the devices.
+ */
+void cleanup_shards(const int num_shards, device_shard* shards);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * \file
+ * \brief NUMA-aware placement of the CPU driver memory, and the OpenMP thread pinning, @see numa_placement.h
+ */
+
+//! for sched_setaffinity and the CPU_* macros
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include "numa_placement.h"
+#include "load_balance.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief Allocates a per-IVP array of `rows` rows of NUM entries, stored as `array[tid + i * NUM]`
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       rows            The number of entries per IVP
+ * \param[in]       num_threads     The number of OpenMP threads of the driver
+ * \return                          The (zeroed) array, to be released with free
+ *
+ * If #NUMA_FIRST_TOUCH is defined, the entries of IVP `tid` are zeroed by the thread the (static)
+ * schedule of the drivers assigns `tid` to, otherwise the array is zeroed by the calling thread.
+ */
+double* allocate_ivp_array(const int NUM, const int rows, const int num_threads)
+{
+    double* array = (double*)malloc((size_t)NUM * rows * sizeof(double));
+    if (array == NULL)
+    {
+        printf("Error: could not allocate %d rows for %d IVPs.\n", rows, NUM);
+        exit(-1);
+    }
+#ifdef NUMA_FIRST_TOUCH
+    // the same loop (and schedule) as the drivers
+    int tid;
+    #pragma omp parallel for private(tid) SCHEDULE_CLAUSE num_threads(num_threads)
+    for (tid = 0; tid < NUM; ++tid)
+    {
+        for (int i = 0; i < rows; ++i)
+            array[tid + (size_t)i * NUM] = 0;
+    }
+#else
+    memset(array, 0, (size_t)NUM * rows * sizeof(double));
+#endif
+    return array;
+}
+
+/**
+ * \brief Pins the OpenMP threads of a team of `num_threads` threads to single CPUs
+ * \param[in]       num_threads     The number of OpenMP threads of the driver
+ * \param[in]       cpus            The CPU of each thread (thread `k` is pinned to `cpus[k % num_cpus]`),
+ *                                  or NULL to pin thread `k` to the `k`-th CPU the process may run on
+ * \param[in]       num_cpus        The number of entries in `cpus`
+ * \return                          Zero on success, otherwise the number of threads that could not be pinned
+ */
+int pin_threads(const int num_threads, const int* cpus, const int num_cpus)
+{
+#ifdef __linux__
+    // the CPUs the process may run on
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0)
+        return num_threads;
+    const int num_allowed = CPU_COUNT(&allowed);
+    if (cpus != NULL && num_cpus <= 0)
+        return num_threads;
+
+    int failed = 0;
+    #pragma omp parallel num_threads(num_threads) reduction(+:failed)
+    {
+#ifdef _OPENMP
+        const int k = omp_get_thread_num();
+#else
+        const int k = 0;
+#endif
+        int cpu = -1;
+        if (cpus != NULL)
+            cpu = cpus[k % num_cpus];
+        else
+        {
+            // the (k mod num_allowed)-th allowed CPU
+            for (int c = 0, n = 0; c < CPU_SETSIZE && cpu < 0; ++c)
+            {
+                if (CPU_ISSET(c, &allowed) && n++ == k % num_allowed)
+                    cpu = c;
+            }
+        }
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &mask);
+        if (cpu < 0 || cpu >= CPU_SETSIZE || sched_setaffinity(0, sizeof(cpu_set_t), &mask) != 0)
+        {
+            printf("Warning: could not pin OpenMP thread %d to CPU %d.\n", k, cpu);
+            failed += 1;
+        }
+    }
+    return failed;
+#else
+    printf("Warning: thread pinning is not supported on this platform.\n");
+    return num_threads;
+#endif
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
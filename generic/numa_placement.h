@@ -0,0 +1,55 @@
+/**
+ * \file
+ * \brief Header definitions for the NUMA-aware placement of the CPU driver memory, and the OpenMP thread pinning
+ *
+ * Linux places each page on the NUMA node of the thread that first writes to it.  If #NUMA_FIRST_TOUCH is
+ * defined, the per-IVP host arrays (e.g. `y_host` and `var_host` of read_initial_conditions) are therefore
+ * first written by the OpenMP threads that integrate the IVPs, i.e. with the (static) schedule of the drivers,
+ * and the per-thread integrator memory of initialize_solver is created by the thread using it.  The placement
+ * follows the threads only if they do not migrate between nodes, @see pin_threads
+ *
+ * With the dynamic or guided SCHEDULE, or #COST_REORDER, the IVPs of a thread change between calls, and the
+ * first touch only spreads the pages evenly over the nodes.
+ */
+
+#ifndef NUMA_PLACEMENT_H
+#define NUMA_PLACEMENT_H
+
+#include <stddef.h>
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief Allocates a per-IVP array of `rows` rows of NUM entries, stored as `array[tid + i * NUM]`
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       rows            The number of entries per IVP
+ * \param[in]       num_threads     The number of OpenMP threads of the driver
+ * \return                          The (zeroed) array, to be released with free
+ *
+ * If #NUMA_FIRST_TOUCH is defined, the entries of IVP `tid` are zeroed by the thread the (static)
+ * schedule of the drivers assigns `tid` to, otherwise the array is zeroed by the calling thread.
+ */
+double* allocate_ivp_array(const int NUM, const int rows, const int num_threads);
+
+/**
+ * \brief Pins the OpenMP threads of a team of `num_threads` threads to single CPUs
+ * \param[in]       num_threads     The number of OpenMP threads of the driver
+ * \param[in]       cpus            The CPU of each thread (thread `k` is pinned to `cpus[k % num_cpus]`),
+ *                                  or NULL to pin thread `k` to the `k`-th CPU the process may run on
+ * \param[in]       num_cpus        The number of entries in `cpus`
+ * \return                          Zero on success, otherwise the number of threads that could not be pinned
+ *
+ * The OpenMP runtime reuses the threads of a team of the same size for later parallel regions of the
+ * calling thread, hence this is called once, before the first integration.  On platforms without thread
+ * affinity, no thread is pinned.
+ */
+int pin_threads(const int num_threads, const int* cpus, const int num_cpus);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
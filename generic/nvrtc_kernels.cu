@@ -0,0 +1,430 @@
+/**
+ * \file
+ * \brief Runtime (NVRTC) compilation of the integration kernels of the GPU library interface, @see nvrtc_kernels.cuh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cuComplex.h>
+#include <nvrtc.h>
+#include "nvrtc_kernels.cuh"
+#include "nvrtc_sources.cuh"
+#include "solver_options.cuh"
+#include "gpu_macros.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef NVRTC
+
+#define nvrtcErrorCheck(ans) { nvrtcAssert((ans), __FILE__, __LINE__); }
+inline void nvrtcAssert(nvrtcResult code, const char *file, int line)
+{
+    if (code != NVRTC_SUCCESS)
+    {
+        fprintf(stderr, "NVRTCassert: %s %s %d\n", nvrtcGetErrorString(code), file, line);
+        exit(code);
+    }
+}
+
+#define cuErrorCheck(ans) { cuAssert((ans), __FILE__, __LINE__); }
+inline void cuAssert(CUresult code, const char *file, int line)
+{
+    if (code != CUDA_SUCCESS)
+    {
+        const char* message = NULL;
+        cuGetErrorString(code, &message);
+        fprintf(stderr, "CUassert: %s %s %d\n", message != NULL ? message : "unknown error", file, line);
+        exit(code);
+    }
+}
+
+/**
+ * The system headers included by the device sources, which NVRTC does not provide.  Only the declarations
+ * used by (the never compiled) host functions of the headers, and the float.h limits, are stubbed.
+ */
+static const char* const stub_names[] = {
+    "stdio.h", "stdlib.h", "string.h", "math.h", "float.h", "stdbool.h", "stddef.h", "stdint.h",
+    "cuda.h", "cuda_runtime.h", "helper_cuda.h", "omp.h"
+};
+static const char* const stub_headers[] = {
+    "#pragma once\ntypedef struct FILE FILE;\nextern FILE* stderr;\nint fprintf(FILE*, const char*, ...);\n",
+    "#pragma once\nextern \"C\" void exit(int);\n",
+    "",
+    "",
+    "#pragma once\n#define DBL_EPSILON 2.2204460492503131e-16\n#define DBL_MAX 1.7976931348623158e+308\n"
+    "#define DBL_MIN 2.2250738585072014e-308\n#define FLT_EPSILON 1.192092896e-07F\n"
+    "#define FLT_MAX 3.402823466e+38F\n#define FLT_MIN 1.175494351e-38F\n",
+    "",
+    "",
+    "#pragma once\ntypedef signed char int8_t;\ntypedef unsigned char uint8_t;\ntypedef int int32_t;\n"
+    "typedef unsigned int uint32_t;\ntypedef long long int64_t;\ntypedef unsigned long long uint64_t;\n",
+    "",
+    "#pragma once\ntypedef int cudaError_t;\n#define cudaSuccess 0\nconst char* cudaGetErrorString(cudaError_t);\n"
+    "typedef struct CUstream_st* cudaStream_t;\n",
+    "",
+    ""
+};
+#define NUM_STUB_HEADERS (sizeof(stub_names) / sizeof(stub_names[0]))
+
+//! The device sources of the integrator and mechanism
+static const char* const jit_sources[] = NVRTC_SOURCES;
+//! The include directories of jit_sources, whose headers are hashed
+static const char* const jit_include_paths[] = NVRTC_INCLUDE_PATHS;
+//! The remaining NVRTC options (defines, floating point and register flags)
+static const char* const jit_options[] = NVRTC_OPTIONS;
+
+#define NUM_JIT_SOURCES (sizeof(jit_sources) / sizeof(jit_sources[0]))
+#define NUM_JIT_INCLUDE_PATHS (sizeof(jit_include_paths) / sizeof(jit_include_paths[0]))
+#define NUM_JIT_OPTIONS (sizeof(jit_options) / sizeof(jit_options[0]))
+
+/*
+ * The device globals set up by the host (by initialize_solver), which are copied into the module
+ */
+#ifdef FD_COLORING
+extern __device__ int fd_color_ptr[NSP + 1];
+extern __device__ int fd_color_cols[NSP];
+extern __device__ int fd_num_colors;
+extern __device__ int fd_row_ptr[NSP + 1];
+extern __device__ int fd_row_index[NSP * NSP];
+#endif
+#if defined(EXP4) || defined(RB43)
+extern __device__ __constant__ cuDoubleComplex poles[N_RA];
+extern __device__ __constant__ cuDoubleComplex res[N_RA];
+#endif
+
+/**
+ * \brief Reads the file `path` into a (NUL-terminated) buffer, or returns NULL if it cannot be read
+ */
+static char* read_file(const char* path, size_t* size)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = (char*)malloc(length + 1);
+    if (length < 0 || fread(data, 1, length, file) != (size_t)length)
+    {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+    data[length] = '\0';
+    fclose(file);
+    *size = length;
+    return data;
+}
+
+/**
+ * \brief Adds `size` bytes of `data` to the (FNV-1a) hash `h`
+ */
+static uint64_t hash_bytes(uint64_t h, const void* data, const size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+//! The FNV-1a offset basis
+#define HASH_SEED (14695981039346656037ULL)
+
+/**
+ * \brief Adds the name and contents of the headers and sources in `dir` to the hash `h`, independent of their order
+ */
+static uint64_t hash_directory(uint64_t h, const char* dir)
+{
+    DIR* handle = opendir(dir);
+    if (handle == NULL)
+        return h;
+    uint64_t sum = 0;
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL)
+    {
+        const char* ext = strrchr(entry->d_name, '.');
+        if (ext == NULL || (strcmp(ext, ".h") && strcmp(ext, ".cuh") && strcmp(ext, ".cu")))
+            continue;
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        size_t size = 0;
+        char* data = read_file(path, &size);
+        if (data == NULL)
+            continue;
+        uint64_t file_hash = hash_bytes(HASH_SEED, entry->d_name, strlen(entry->d_name));
+        sum += hash_bytes(file_hash, data, size);
+        free(data);
+    }
+    closedir(handle);
+    return hash_bytes(h, &sum, sizeof(sum));
+}
+
+/**
+ * \brief Writes the translation unit compiled by NVRTC: the tolerances, followed by the device sources
+ */
+static char* jit_unit_source(const jit_kernels* jit)
+{
+    size_t capacity = 4096 + NSP * 32;
+    for (size_t i = 0; i < NUM_JIT_SOURCES; ++i)
+        capacity += strlen(jit_sources[i]) + 16;
+    char* unit = (char*)malloc(capacity);
+    size_t n = 0;
+    n += snprintf(&unit[n], capacity - n, "#define JIT_TOLERANCES\n#define JIT_RTOL (%.17g)\n", TOL_RTOL(jit->tol));
+    bool uniform = true;
+    for (int i = 1; i < NSP; ++i)
+        uniform = uniform && jit->tol[i] == jit->tol[0];
+    if (uniform)
+        n += snprintf(&unit[n], capacity - n, "#define JIT_ATOL(i) (%.17g)\n", jit->tol[0]);
+    else
+    {
+        n += snprintf(&unit[n], capacity - n, "static __constant__ double jit_atol[%d] = {", NSP);
+        for (int i = 0; i < NSP; ++i)
+            n += snprintf(&unit[n], capacity - n, "%s%.17g", i ? ", " : "", jit->tol[i]);
+        n += snprintf(&unit[n], capacity - n, "};\n#define JIT_ATOL(i) (jit_atol[i])\n");
+    }
+    for (size_t i = 0; i < NUM_JIT_SOURCES; ++i)
+        n += snprintf(&unit[n], capacity - n, "#include \"%s\"\n", jit_sources[i]);
+    return unit;
+}
+
+/**
+ * \brief Returns the path of the cached cubin of `hash` for the architecture `arch` in `path`, and creates the cache directory
+ */
+static void cache_path(char* path, const size_t size, const uint64_t hash, const char* arch)
+{
+    const char* dir = getenv("ACCELERINT_JIT_CACHE");
+    if (dir == NULL || dir[0] == '\0')
+        dir = NVRTC_CACHE_DIR;
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+        printf("Warning: could not create the NVRTC cache directory %s.\n", dir);
+    snprintf(path, size, "%s/%016llx-%s.cubin", dir, (unsigned long long)hash, arch);
+}
+
+/**
+ * \brief Compiles the unit `unit` for `arch` with NVRTC
+ * \param[in]       unit            The source of the translation unit
+ * \param[in]       arch            The (real) architecture, e.g. `sm_70`
+ * \param[out]      size            The size of the returned cache entry
+ * \return                          The cache entry: the lowered names of intDriver and intDriverLocal, each followed
+ *                                  by a newline, and the cubin
+ */
+static char* compile_unit(const char* unit, const char* arch, size_t* size)
+{
+    nvrtcProgram program;
+    nvrtcErrorCheck( nvrtcCreateProgram(&program, unit, "accelerInt_jit.cu", NUM_STUB_HEADERS,
+                                        stub_headers, stub_names) );
+    nvrtcErrorCheck( nvrtcAddNameExpression(program, "intDriver") );
+    nvrtcErrorCheck( nvrtcAddNameExpression(program, "intDriverLocal") );
+
+    const char* options[NUM_JIT_INCLUDE_PATHS + NUM_JIT_OPTIONS + 1];
+    char arch_option[64];
+    snprintf(arch_option, sizeof(arch_option), "--gpu-architecture=%s", arch);
+    char include_options[NUM_JIT_INCLUDE_PATHS][4096];
+    int num_options = 0;
+    options[num_options++] = arch_option;
+    for (size_t i = 0; i < NUM_JIT_INCLUDE_PATHS; ++i)
+    {
+        snprintf(include_options[i], sizeof(include_options[i]), "-I%s", jit_include_paths[i]);
+        options[num_options++] = include_options[i];
+    }
+    for (size_t i = 0; i < NUM_JIT_OPTIONS; ++i)
+        options[num_options++] = jit_options[i];
+
+    nvrtcResult result = nvrtcCompileProgram(program, num_options, options);
+    if (result != NVRTC_SUCCESS)
+    {
+        size_t log_size = 0;
+        nvrtcGetProgramLogSize(program, &log_size);
+        char* log = (char*)malloc(log_size + 1);
+        nvrtcGetProgramLog(program, log);
+        log[log_size] = '\0';
+        printf("Error: the NVRTC compilation of the integration kernels failed:\n%s\n", log);
+        free(log);
+        exit(-1);
+    }
+
+    const char* driver_name = NULL;
+    const char* local_name = NULL;
+    nvrtcErrorCheck( nvrtcGetLoweredName(program, "intDriver", &driver_name) );
+    nvrtcErrorCheck( nvrtcGetLoweredName(program, "intDriverLocal", &local_name) );
+    size_t cubin_size = 0;
+    nvrtcErrorCheck( nvrtcGetCUBINSize(program, &cubin_size) );
+    const size_t header_size = strlen(driver_name) + strlen(local_name) + 2;
+    char* entry = (char*)malloc(header_size + cubin_size);
+    snprintf(entry, header_size + 1, "%s\n%s\n", driver_name, local_name);
+    nvrtcErrorCheck( nvrtcGetCUBIN(program, &entry[header_size]) );
+    nvrtcErrorCheck( nvrtcDestroyProgram(&program) );
+    *size = header_size + cubin_size;
+    return entry;
+}
+
+/**
+ * \brief Writes the cache entry `entry` to `path`, under a temporary name first such that concurrent
+ *        initializations never read a partial entry
+ */
+static void write_cache_entry(const char* path, const char* entry, const size_t size)
+{
+    // unique per call, as the instances of one process (e.g. on separate threads) may compile the same entry
+    char temp[4096 + 32];
+    snprintf(temp, sizeof(temp), "%s.XXXXXX", path);
+    const int fd = mkstemp(temp);
+    if (fd >= 0)
+        fchmod(fd, 0644);
+    FILE* file = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (fd >= 0 && file == NULL)
+        close(fd);
+    bool written = file != NULL && fwrite(entry, 1, size, file) == size;
+    if (file != NULL)
+        written = fclose(file) == 0 && written;
+    if (!written || rename(temp, path) != 0)
+    {
+        if (fd >= 0)
+            remove(temp);
+        printf("Warning: could not write the NVRTC cache entry %s.\n", path);
+    }
+}
+
+/**
+ * \brief Copies the device global `name` of the linked kernels (at `symbol`) into `module`, if the module has it
+ */
+static void copy_jit_global(CUmodule module, const char* name, const void* symbol)
+{
+    CUdeviceptr dst;
+    size_t bytes = 0;
+    if (cuModuleGetGlobal(&dst, &bytes, module, name) != CUDA_SUCCESS)
+        return;
+    void* src = NULL;
+    cudaErrorCheck( cudaGetSymbolAddress(&src, symbol) );
+    cuErrorCheck( cuMemcpyDtoD(dst, (CUdeviceptr)src, bytes) );
+}
+
+void set_jit_tolerances(jit_kernels* jit, const double atol, const double rtol, const double* atol_vector)
+{
+    fill_tolerances(jit->tol, atol, rtol, atol_vector);
+}
+
+void load_jit_kernels(jit_kernels* jit)
+{
+    release_jit_kernels(jit);
+    // ensure the primary context of the device is current for the driver API
+    cudaErrorCheck( cudaFree(0) );
+    int device = 0;
+    int major = 0;
+    int minor = 0;
+    cudaErrorCheck( cudaGetDevice(&device) );
+    cudaErrorCheck( cudaDeviceGetAttribute(&major, cudaDevAttrComputeCapabilityMajor, device) );
+    cudaErrorCheck( cudaDeviceGetAttribute(&minor, cudaDevAttrComputeCapabilityMinor, device) );
+    char arch[16];
+    snprintf(arch, sizeof(arch), "sm_%d%d", major, minor);
+
+    // the key of the cached cubin: the unit (i.e. the tolerances), sources, headers, options and NVRTC version
+    char* unit = jit_unit_source(jit);
+    uint64_t hash = hash_bytes(HASH_SEED, unit, strlen(unit));
+    for (size_t i = 0; i < NUM_JIT_SOURCES; ++i)
+    {
+        size_t size = 0;
+        char* data = read_file(jit_sources[i], &size);
+        if (data == NULL)
+        {
+            printf("Error: could not read the NVRTC source %s.\n", jit_sources[i]);
+            exit(-1);
+        }
+        hash = hash_bytes(hash, data, size);
+        free(data);
+    }
+    for (size_t i = 0; i < NUM_JIT_INCLUDE_PATHS; ++i)
+        hash = hash_directory(hash, jit_include_paths[i]);
+    for (size_t i = 0; i < NUM_JIT_OPTIONS; ++i)
+        hash = hash_bytes(hash, jit_options[i], strlen(jit_options[i]));
+    int version[2];
+    nvrtcErrorCheck( nvrtcVersion(&version[0], &version[1]) );
+    hash = hash_bytes(hash, version, sizeof(version));
+
+    char path[4096];
+    cache_path(path, sizeof(path), hash, arch);
+    size_t size = 0;
+    char* entry = read_file(path, &size);
+    if (entry == NULL)
+    {
+        entry = compile_unit(unit, arch, &size);
+        write_cache_entry(path, entry, size);
+    }
+    free(unit);
+
+    // the lowered kernel names, followed by the cubin
+    const char* local_start = (const char*)memchr(entry, '\n', size);
+    const char* cubin = local_start != NULL ? (const char*)memchr(local_start + 1, '\n', size - (local_start + 1 - entry)) : NULL;
+    if (cubin == NULL)
+    {
+        printf("Error: the NVRTC cache entry %s is corrupt, remove it and run again.\n", path);
+        exit(-1);
+    }
+    char driver_name[1024];
+    char local_name[1024];
+    snprintf(driver_name, sizeof(driver_name), "%.*s", (int)(local_start - entry), entry);
+    snprintf(local_name, sizeof(local_name), "%.*s", (int)(cubin - local_start - 1), local_start + 1);
+    // moved to the (aligned) start of the buffer
+    cubin++;
+    memmove(entry, cubin, size - (cubin - entry));
+    cuErrorCheck( cuModuleLoadData(&jit->module, entry) );
+    cuErrorCheck( cuModuleGetFunction(&jit->driver, jit->module, driver_name) );
+    cuErrorCheck( cuModuleGetFunction(&jit->driver_local, jit->module, local_name) );
+    free(entry);
+
+#ifdef FD_COLORING
+    copy_jit_global(jit->module, "fd_color_ptr", fd_color_ptr);
+    copy_jit_global(jit->module, "fd_color_cols", fd_color_cols);
+    copy_jit_global(jit->module, "fd_num_colors", &fd_num_colors);
+    copy_jit_global(jit->module, "fd_row_ptr", fd_row_ptr);
+    copy_jit_global(jit->module, "fd_row_index", fd_row_index);
+#endif
+#if defined(EXP4) || defined(RB43)
+    copy_jit_global(jit->module, "poles", poles);
+    copy_jit_global(jit->module, "res", res);
+#endif
+}
+
+void release_jit_kernels(jit_kernels* jit)
+{
+    if (jit->module != NULL)
+        cuErrorCheck( cuModuleUnload(jit->module) );
+    jit->module = NULL;
+    jit->driver = NULL;
+    jit->driver_local = NULL;
+}
+
+void launch_jit_driver(const jit_kernels* jit, const dim3 grid, const dim3 block, const size_t shared,
+                       cudaStream_t stream, int num, double t, double t_end, const double* var, double* y,
+                       const mechanism_memory* d_mem, const solver_memory* s_mem)
+{
+    void* args[] = {&num, &t, &t_end, &var, &y, &d_mem, &s_mem};
+    cuErrorCheck( cuLaunchKernel(jit->driver, grid.x, grid.y, grid.z, block.x, block.y, block.z,
+                                 (unsigned int)shared, (CUstream)stream, args, NULL) );
+}
+
+void launch_jit_driver_local(const jit_kernels* jit, const dim3 grid, const dim3 block, const size_t shared,
+                             cudaStream_t stream, int num, const double* t_local, const double* t_end_local,
+                             const double* var, double* y, const mechanism_memory* d_mem,
+                             const solver_memory* s_mem)
+{
+    void* args[] = {&num, &t_local, &t_end_local, &var, &y, &d_mem, &s_mem};
+    cuErrorCheck( cuLaunchKernel(jit->driver_local, grid.x, grid.y, grid.z, block.x, block.y, block.z,
+                                 (unsigned int)shared, (CUstream)stream, args, NULL) );
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
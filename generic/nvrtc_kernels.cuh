@@ -0,0 +1,93 @@
+/**
+ * \file
+ * \brief Runtime (NVRTC) compilation of the integration kernels of the GPU library interface
+ *
+ * If #NVRTC is defined, the single-device library interface does not launch the intDriver / intDriverLocal
+ * kernels linked into the library.  Instead, the device sources of the integrator and mechanism
+ * (listed by SCons in the `nvrtc_sources.cuh` of the integrator) are compiled with NVRTC when the
+ * instance is initialized, for the architecture of its device, and with the integration tolerances as
+ * compile-time constants (@see TOL_ATOL).  Changing the tolerances recompiles the kernels.
+ *
+ * The cubins are cached on disk, named by a hash of the sources, headers, compile options and
+ * tolerances and by the device architecture, such that only the first initialization of a
+ * configuration pays for the compilation.  The cache directory is #NVRTC_CACHE_DIR, unless overridden
+ * by the `ACCELERINT_JIT_CACHE` environment variable.  Since the sources are read at initialization,
+ * edits to the mechanism (or solver) sources that keep NSP take effect without rebuilding the library.
+ *
+ * The multi-device shards (and hence PERSISTENT_KERNEL and MANAGED_MEMORY) launch the linked kernels.
+ */
+
+#ifndef NVRTC_KERNELS_CUH
+#define NVRTC_KERNELS_CUH
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include "header.cuh"
+#include "solver_props.cuh"
+#include "gpu_memory.cuh"
+#include "tolerances.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+/**
+ * \brief The runtime compiled kernels of a solver instance
+ * \param           module          The loaded module, NULL until load_jit_kernels is called
+ * \param           driver          The intDriver kernel of #module
+ * \param           driver_local    The intDriverLocal kernel of #module
+ * \param           tol             The tolerances the kernels are compiled for, stored as the `tol` array of tolerances.cuh
+ *
+ * Zero-initialize before first use.
+ */
+struct jit_kernels {
+    CUmodule module;
+    CUfunction driver;
+    CUfunction driver_local;
+    double tol[TOL_SIZE];
+};
+
+/**
+ * \brief Sets the tolerances the kernels of `jit` are compiled for by the next load_jit_kernels
+ * \param[in,out]   jit             The kernels
+ * \param[in]       atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]       rtol            The relative tolerance
+ * \param[in]       atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ */
+void set_jit_tolerances(jit_kernels* jit, const double atol, const double rtol, const double* atol_vector);
+
+/**
+ * \brief Compiles (or loads from the cache) the kernels of `jit` for the current device, replacing any loaded module
+ * \param[in,out]   jit             The kernels
+ *
+ * Call after initialize_solver, as the device globals it sets up (e.g. the finite difference coloring or the
+ * rational approximant poles) are copied into the module.  The program exits if the compilation fails,
+ * after printing the NVRTC log.
+ */
+void load_jit_kernels(jit_kernels* jit);
+
+/**
+ * \brief Unloads the module of `jit` (if any), call on its device before the device is reset
+ */
+void release_jit_kernels(jit_kernels* jit);
+
+/**
+ * \brief Launches the runtime compiled intDriver, @see intDriver for the kernel arguments
+ */
+void launch_jit_driver(const jit_kernels* jit, const dim3 grid, const dim3 block, const size_t shared,
+                       cudaStream_t stream, int num, double t, double t_end, const double* var, double* y,
+                       const mechanism_memory* d_mem, const solver_memory* s_mem);
+
+/**
+ * \brief Launches the runtime compiled intDriverLocal, @see intDriverLocal for the kernel arguments
+ */
+void launch_jit_driver_local(const jit_kernels* jit, const dim3 grid, const dim3 block, const size_t shared,
+                             cudaStream_t stream, int num, const double* t_local, const double* t_end_local,
+                             const double* var, double* y, const mechanism_memory* d_mem,
+                             const solver_memory* s_mem);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * \file
+ * \brief Implementation of the in-process parameter sweeps of the CPU solvers, @see parameter_sweep.h
+ */
+
+//! for clock_gettime(), @see benchmark.h
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "header.h"
+#include "parameter_sweep.h"
+#include "read_initial_conditions.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef PARAMETER_SWEEP
+
+void parameter_sweep_create(parameter_sweep* sweep, const char* filename, const int NUM)
+{
+    memset(sweep, 0, sizeof(parameter_sweep));
+    sweep->NUM = NUM;
+    if (filename == NULL)
+        set_same_initial_conditions(NUM, &sweep->y_init, &sweep->var_init);
+    else
+        read_initial_conditions(filename, NUM, &sweep->y_init, &sweep->var_init);
+    sweep->y = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    sweep->var = (double*)malloc((size_t)NUM * sizeof(double));
+    if (sweep->y == NULL || sweep->var == NULL)
+    {
+        printf("Error: could not allocate the sweep state of %d IVPs.\n", NUM);
+        exit(-1);
+    }
+}
+
+/**
+ * \brief Returns the cached solver instance of `num_threads` threads, creating it if required
+ */
+static accelerInt_context* get_context(parameter_sweep* sweep, const int num_threads)
+{
+    for (int i = 0; i < sweep->num_contexts; ++i)
+    {
+        if (sweep->contexts[i]->num_threads == num_threads)
+            return sweep->contexts[i];
+    }
+    sweep->contexts = (accelerInt_context**)realloc(sweep->contexts,
+                                                    (sweep->num_contexts + 1) * sizeof(accelerInt_context*));
+    sweep->contexts[sweep->num_contexts] = accelerInt_create(num_threads);
+    return sweep->contexts[sweep->num_contexts++];
+}
+
+/**
+ * \brief Returns the number of global steps taken by accelerInt_context_integrate from zero to `t_end`
+ */
+static int count_steps(const double t_end, const double stepsize)
+{
+    int numSteps = 0;
+    double t = 0;
+    while (t + EPS < t_end)
+    {
+        numSteps++;
+        t = fmin(t_end, numSteps * stepsize);
+    }
+    return numSteps;
+}
+
+int parameter_sweep_run(parameter_sweep* sweep, const sweep_point* point, double* samples,
+                        benchmark_summary* summary)
+{
+    const int NUM = point->NUM;
+    if (NUM <= 0 || NUM > sweep->NUM)
+    {
+        printf("Error: %d IVPs requested, but %d were loaded.\n", NUM, sweep->NUM);
+        exit(-1);
+    }
+    if (point->trials <= 0 || !(point->stepsize > 0))
+    {
+        printf("Error: invalid sweep configuration, at least one trial and a positive step size are required.\n");
+        exit(-1);
+    }
+    accelerInt_context* context = get_context(sweep, point->num_threads);
+
+    // the leading IVPs, repacked to the leading dimension of this configuration
+    memcpy(sweep->var, sweep->var_init, NUM * sizeof(double));
+    for (int trial = -point->warmup; trial < point->trials; ++trial)
+    {
+        for (int j = 0; j < NSP; ++j)
+            memcpy(&sweep->y[j * NUM], &sweep->y_init[j * sweep->NUM], NUM * sizeof(double));
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+        // each trial starts cold
+        cleanup_warm_start(&context->warm);
+#endif
+        double trial_start = benchmark_time();
+        accelerInt_context_integrate(context, NUM, 0, point->t_end, point->stepsize, sweep->y, sweep->var);
+        if (trial >= 0)
+            samples[trial] = benchmark_time() - trial_start;
+    }
+    benchmark_summarize(point->trials, samples, summary);
+    return count_steps(point->t_end, point->stepsize);
+}
+
+void parameter_sweep_destroy(parameter_sweep* sweep)
+{
+    for (int i = 0; i < sweep->num_contexts; ++i)
+        accelerInt_destroy(sweep->contexts[i]);
+    free(sweep->contexts);
+    free_initial_conditions(sweep->y_init, sweep->var_init);
+    free(sweep->y);
+    free(sweep->var);
+    memset(sweep, 0, sizeof(parameter_sweep));
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
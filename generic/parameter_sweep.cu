@@ -0,0 +1,121 @@
+/**
+ * \file
+ * \brief Implementation of the in-process parameter sweeps of the GPU solvers, @see parameter_sweep.cuh
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <cuda_runtime.h>
+#include "header.cuh"
+#include "parameter_sweep.cuh"
+#include "read_initial_conditions.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef PARAMETER_SWEEP
+
+void parameter_sweep_create(parameter_sweep* sweep, const char* filename, const int NUM, const int device)
+{
+    memset(sweep, 0, sizeof(parameter_sweep));
+    sweep->NUM = NUM;
+    sweep->device = device;
+    if (filename == NULL)
+        set_same_initial_conditions(NUM, &sweep->y_init, &sweep->var_init);
+    else
+        read_initial_conditions(filename, NUM, &sweep->y_init, &sweep->var_init);
+    sweep->y = (double*)malloc((size_t)NUM * NN * sizeof(double));
+    sweep->var = (double*)malloc((size_t)NUM * sizeof(double));
+    if (sweep->y == NULL || sweep->var == NULL)
+    {
+        printf("Error: could not allocate the sweep state of %d IVPs.\n", NUM);
+        exit(-1);
+    }
+}
+
+/**
+ * \brief Returns a solver instance for `NUM` IVPs, reusing that of the last configuration if possible
+ */
+static accelerInt_context* get_context(parameter_sweep* sweep, const int NUM, const bool fresh)
+{
+    if (sweep->context != NULL && (fresh || sweep->context_NUM != NUM))
+    {
+        accelerInt_destroy(sweep->context);
+        sweep->context = NULL;
+    }
+    if (sweep->context == NULL)
+    {
+        sweep->context = accelerInt_create(NUM, sweep->device);
+        sweep->context_NUM = NUM;
+    }
+    return sweep->context;
+}
+
+/**
+ * \brief Returns the number of global steps taken by accelerInt_context_integrate from zero to `t_end`
+ */
+static int count_steps(const double t_end, const double stepsize)
+{
+    int numSteps = 0;
+    double t = 0;
+    while (t + EPS < t_end)
+    {
+        numSteps++;
+        t = fmin(t_end, numSteps * stepsize);
+    }
+    return numSteps;
+}
+
+int parameter_sweep_run(parameter_sweep* sweep, const sweep_point* point, double* samples,
+                        benchmark_summary* summary)
+{
+    const int NUM = point->NUM;
+    if (NUM <= 0 || NUM > sweep->NUM)
+    {
+        printf("Error: %d IVPs requested, but %d were loaded.\n", NUM, sweep->NUM);
+        exit(-1);
+    }
+    if (point->trials <= 0 || !(point->stepsize > 0))
+    {
+        printf("Error: invalid sweep configuration, at least one trial and a positive step size are required.\n");
+        exit(-1);
+    }
+
+    // the leading IVPs, repacked to the leading dimension of this configuration
+    memcpy(sweep->var, sweep->var_init, NUM * sizeof(double));
+    for (int trial = -point->warmup; trial < point->trials; ++trial)
+    {
+        for (int j = 0; j < NN; ++j)
+            memcpy(&sweep->y[j * NUM], &sweep->y_init[j * sweep->NUM], NUM * sizeof(double));
+#ifdef SOLVER_WARM_START
+        // each trial starts cold
+        accelerInt_context* context = get_context(sweep, NUM, true);
+#else
+        accelerInt_context* context = get_context(sweep, NUM, false);
+#endif
+        double trial_start = benchmark_time();
+        accelerInt_context_integrate(context, NUM, 0, point->t_end, point->stepsize, sweep->y, sweep->var);
+        if (trial >= 0)
+            samples[trial] = benchmark_time() - trial_start;
+    }
+    benchmark_summarize(point->trials, samples, summary);
+    return count_steps(point->t_end, point->stepsize);
+}
+
+void parameter_sweep_destroy(parameter_sweep* sweep)
+{
+    accelerInt_destroy(sweep->context);
+    free_initial_conditions(sweep->y_init, sweep->var_init);
+    free(sweep->y);
+    free(sweep->var);
+    memset(sweep, 0, sizeof(parameter_sweep));
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,103 @@
+/**
+ * \file
+ * \brief Header definitions for the in-process parameter sweeps of the CPU solvers
+ *
+ * If #PARAMETER_SWEEP is defined, a single process may time the integrator over many configurations
+ * (number of IVPs, number of OpenMP threads and global step size) without being rebuilt or relaunched.
+ * The initial conditions are read once, for the largest number of IVPs, and each configuration integrates
+ * the leading IVPs of the file.  A solver instance (@see accelerInt_create) is kept per thread count, such
+ * that the integrator memory (and e.g. the rational approximant of the exponential solvers) is initialized
+ * once per thread count rather than once per configuration.  @see sweep_main.c
+ */
+
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include "solver_options.h"
+
+#ifdef PARAMETER_SWEEP
+
+#include "solver_interface.h"
+#include "benchmark.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief One configuration of a parameter sweep, @see parameter_sweep_run
+ */
+typedef struct
+{
+    //! The number of IVPs, at most parameter_sweep::NUM
+    int NUM;
+    //! The number of OpenMP threads
+    int num_threads;
+    //! The global integration step size
+    double stepsize;
+    //! The end time of each trial (from a starting time of zero)
+    double t_end;
+    //! The number of untimed warm-up trials
+    int warmup;
+    //! The number of timed trials
+    int trials;
+} sweep_point;
+
+/**
+ * \brief The loaded initial conditions and the cached solver instances of a parameter sweep
+ */
+typedef struct
+{
+    //! The number of loaded IVPs
+    int NUM;
+    //! The (#NUM * NSP) loaded state vectors, stored as `y_init[i + j * NUM]`
+    double* y_init;
+    //! The (#NUM) loaded pressures/densities
+    double* var_init;
+    //! The state vectors integrated by parameter_sweep_run, with the leading dimension of the configuration
+    double* y;
+    //! The pressures/densities of the configuration
+    double* var;
+    //! The number of cached solver instances
+    int num_contexts;
+    //! The solver instances, one per thread count
+    accelerInt_context** contexts;
+} parameter_sweep;
+
+/**
+ * \brief Reads the initial conditions of a parameter sweep
+ * \param[out]      sweep           The sweep to initialize
+ * \param[in]       filename        The initial condition file (in either format of read_initial_conditions),
+ *                                  or NULL to use the initial conditions of the mechanism (as for #SAME_IC)
+ * \param[in]       NUM             The number of IVPs to read, the largest of the configurations
+ */
+void parameter_sweep_create(parameter_sweep* sweep, const char* filename, const int NUM);
+
+/**
+ * \brief Times the integrator on one configuration
+ * \param[in,out]   sweep           The sweep
+ * \param[in]       point           The configuration
+ * \param[out]      samples         The (`point->trials`) wall times of the timed trials
+ * \param[out]      summary         The summary statistics of the timed trials
+ * \return                          The number of global integration steps per trial
+ *
+ * Each trial integrates the first `point->NUM` loaded IVPs from their initial conditions, from zero to
+ * `point->t_end`, on the (cached) solver instance of `point->num_threads` threads.  The final states of the
+ * last trial are left in parameter_sweep::y.
+ */
+int parameter_sweep_run(parameter_sweep* sweep, const sweep_point* point, double* samples,
+                        benchmark_summary* summary);
+
+/**
+ * \brief Frees the initial conditions and all solver instances of the sweep
+ * \param[in,out]   sweep           The sweep
+ */
+void parameter_sweep_destroy(parameter_sweep* sweep);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * \file
+ * \brief Storage for the per-phase profiling of the CPU solvers, @see phase_profile.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "header.h"
+#include "phase_profile.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+//! The phase names, in the order of PhaseIndex
+static const char* phase_names[NUM_PHASES] = {"RHS", "Jacobian", "LU", "Newton", "Krylov", "phi"};
+
+const char* phase_name(const int phase)
+{
+    return phase_names[phase];
+}
+
+#ifdef PROFILE_PHASES
+
+long long phase_cycles[NUM_PHASES] = {0};
+long long phase_calls[NUM_PHASES] = {0};
+#ifdef PROFILE_RANGES
+__itt_domain* phase_domain = NULL;
+__itt_string_handle* phase_handles[NUM_PHASES] = {NULL};
+#endif
+
+void reset_phase_profile(const int num_threads)
+{
+#ifdef PROFILE_RANGES
+    #pragma omp critical(phase_domain)
+    if (phase_domain == NULL)
+    {
+        phase_domain = __itt_domain_create("accelerInt");
+        for (int i = 0; i < NUM_PHASES; ++i)
+            phase_handles[i] = __itt_string_handle_create(phase_names[i]);
+    }
+#endif
+    #pragma omp parallel num_threads(num_threads)
+    {
+        memset(phase_cycles, 0, NUM_PHASES * sizeof(long long));
+        memset(phase_calls, 0, NUM_PHASES * sizeof(long long));
+    }
+}
+
+void get_phase_profile(const int num_threads, long long* cycles, long long* calls)
+{
+    memset(cycles, 0, NUM_PHASES * sizeof(long long));
+    memset(calls, 0, NUM_PHASES * sizeof(long long));
+    // the counters are thread-private, hence are merged by the same team that integrated
+    #pragma omp parallel num_threads(num_threads)
+    {
+        #pragma omp critical(phase_profile)
+        for (int i = 0; i < NUM_PHASES; ++i)
+        {
+            cycles[i] += phase_cycles[i];
+            calls[i] += phase_calls[i];
+        }
+    }
+}
+
+#else
+
+void reset_phase_profile(const int num_threads)
+{
+}
+
+void get_phase_profile(const int num_threads, long long* cycles, long long* calls)
+{
+    memset(cycles, 0, NUM_PHASES * sizeof(long long));
+    memset(calls, 0, NUM_PHASES * sizeof(long long));
+}
+
+#endif
+
+void print_phase_profile(const int num_threads, FILE* file)
+{
+    long long cycles[NUM_PHASES];
+    long long calls[NUM_PHASES];
+    get_phase_profile(num_threads, cycles, calls);
+    for (int i = 0; i < NUM_PHASES; ++i)
+    {
+        if (calls[i] == 0)
+            continue;
+        fprintf(file, "Phase %-8s\tcalls: %lld\tcycles: %.6e\tcycles / call: %.6e\n", phase_names[i], calls[i],
+                (double)cycles[i], (double)cycles[i] / (double)calls[i]);
+    }
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,93 @@
+/**
+ * \file
+ * \brief Reduction and host storage of the per-phase profiling of the GPU solvers, @see phase_profile.cuh
+ */
+
+#include <string.h>
+#include "phase_profile.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The phase names, in the order of PhaseIndex
+static const char* phase_names[NUM_PHASES] = {"RHS", "Jacobian", "LU", "Newton", "Krylov", "phi"};
+
+const char* phase_name(const int phase)
+{
+    return phase_names[phase];
+}
+
+void reset_phase_profile(phase_totals* totals)
+{
+    memset(totals, 0, sizeof(phase_totals));
+}
+
+/**
+ * \brief Sums each row of the (2 * #NUM_PHASES x padded) counters into `totals`, and zeros the counters
+ *
+ * One block per row, whose threads stride over the columns and are reduced in shared memory.
+ */
+__global__
+void reduce_phases(long long* __restrict__ phases, const int padded, long long* __restrict__ totals)
+{
+    __shared__ long long partial[256];
+    long long* row = &phases[blockIdx.x * padded];
+    long long sum = 0;
+    for (int i = threadIdx.x; i < padded; i += blockDim.x)
+    {
+        sum += row[i];
+        row[i] = 0;
+    }
+    partial[threadIdx.x] = sum;
+    __syncthreads();
+    for (int stride = blockDim.x / 2; stride > 0; stride /= 2)
+    {
+        if (threadIdx.x < stride)
+            partial[threadIdx.x] += partial[threadIdx.x + stride];
+        __syncthreads();
+    }
+    if (threadIdx.x == 0)
+        totals[blockIdx.x] = partial[0];
+}
+
+void accumulate_phase_profile(phase_totals* totals, long long* phases, const int padded, cudaStream_t stream)
+{
+#ifdef PROFILE_PHASES
+    long long* d_sums = 0;
+    long long sums[2 * NUM_PHASES];
+    cudaErrorCheck( cudaMalloc((void**)&d_sums, 2 * NUM_PHASES * sizeof(long long)) );
+    reduce_phases <<< 2 * NUM_PHASES, 256, 0, stream >>> (phases, padded, d_sums);
+    cudaErrorCheck( cudaMemcpyAsync(sums, d_sums, 2 * NUM_PHASES * sizeof(long long), cudaMemcpyDeviceToHost, stream) );
+    cudaErrorCheck( cudaStreamSynchronize(stream) );
+    cudaErrorCheck( cudaFree(d_sums) );
+    // the devices of multiple shards are driven from separate host threads
+    #pragma omp critical(phase_profile)
+    for (int i = 0; i < NUM_PHASES; ++i)
+    {
+        totals->cycles[i] += sums[i];
+        totals->calls[i] += sums[NUM_PHASES + i];
+    }
+#endif
+}
+
+void get_phase_profile(const phase_totals* totals, long long* cycles, long long* calls)
+{
+    memcpy(cycles, totals->cycles, NUM_PHASES * sizeof(long long));
+    memcpy(calls, totals->calls, NUM_PHASES * sizeof(long long));
+}
+
+void print_phase_profile(const phase_totals* totals, FILE* file)
+{
+    for (int i = 0; i < NUM_PHASES; ++i)
+    {
+        if (totals->calls[i] == 0)
+            continue;
+        fprintf(file, "Phase %-8s\tcalls: %lld\tcycles: %.6e\tcycles / call: %.6e\n", phase_names[i], totals->calls[i],
+                (double)totals->cycles[i], (double)totals->cycles[i] / (double)totals->calls[i]);
+    }
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
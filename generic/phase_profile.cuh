@@ -0,0 +1,131 @@
+/**
+ * \file
+ * \brief Definitions for the per-phase profiling of the GPU solvers
+ *
+ * If #PROFILE_PHASES is defined, each solver_memory struct contains a `phases` array of
+ * (2 * #NUM_PHASES * padded) counters, stored as `phases[INDEX(phase)]` (the elapsed clock64() cycles)
+ * and `phases[INDEX(NUM_PHASES + phase)]` (the number of calls).  The integrators bracket their
+ * hot paths with PHASE_BEGIN / PHASE_END, which subtract and add back the cycle counter of the thread.
+ * After each integration step the drivers reduce the counters over all threads on the device,
+ * and add the result to the host totals, @see accumulate_phase_profile.  The phases are inclusive,
+ * e.g. the Newton phase contains the RHS evaluations of the Newton iterations.
+ *
+ * If #PROFILE_RANGES is also defined, the host drivers emit NVTX ranges around the transfers
+ * and kernel calls of each chunk of IVPs, such that they show up on the Nsight timeline.
+ */
+
+#ifndef PHASE_PROFILE_CUH
+#define PHASE_PROFILE_CUH
+
+#include <stdio.h>
+#include <cuda_runtime.h>
+#include "solver_options.cuh"
+#include "gpu_macros.cuh"
+#ifdef PROFILE_RANGES
+#include <nvToolsExt.h>
+#endif
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+/**
+ * \brief The profiled solver phases
+ */
+enum PhaseIndex
+{
+    //! RHS (dydt) evaluations
+    PHASE_RHS = 0,
+    //! Jacobian evaluations (or Jacobian operator updates)
+    PHASE_JACOBIAN = 1,
+    //! LU factorizations of the iteration matrix
+    PHASE_LU = 2,
+    //! Newton iterations (including their RHS evaluations and back-substitutions)
+    PHASE_NEWTON = 3,
+    //! Arnoldi iterations (including the evaluation of the phi-functions)
+    PHASE_KRYLOV = 4,
+    //! Matrix exponential / phi-function evaluations of the Hessenberg matrix
+    PHASE_PHI = 5
+};
+
+//! The number of profiled phases
+#define NUM_PHASES (6)
+
+#ifdef PROFILE_PHASES
+    //! Start timing the given phase on this thread
+    #define PHASE_BEGIN(solver, phase) ((solver)->phases[INDEX(phase)] -= clock64())
+    //! Stop timing the given phase on this thread, must follow the matching PHASE_BEGIN
+    #define PHASE_END(solver, phase) ((solver)->phases[INDEX(phase)] += clock64(), \
+                                      (solver)->phases[INDEX(NUM_PHASES + (phase))] += 1)
+#else
+    #define PHASE_BEGIN(solver, phase)
+    #define PHASE_END(solver, phase)
+#endif
+
+#ifdef PROFILE_RANGES
+    //! Open a named NVTX range on the host timeline
+    #define RANGE_PUSH(name) nvtxRangePushA(name)
+    //! Close the innermost NVTX range
+    #define RANGE_POP() nvtxRangePop()
+#else
+    #define RANGE_PUSH(name)
+    #define RANGE_POP()
+#endif
+
+/**
+ * \brief Returns the name of `phase`
+ * \param[in]       phase       The phase, @see PhaseIndex
+ */
+const char* phase_name(const int phase);
+
+/**
+ * \brief The host phase totals of a solver instance
+ * \param           cycles      The total cycles per phase
+ * \param           calls       The total calls per phase
+ */
+struct phase_totals {
+    long long cycles[NUM_PHASES];
+    long long calls[NUM_PHASES];
+};
+
+/**
+ * \brief Zeros the host phase totals
+ * \param[out]      totals      The host phase totals
+ */
+void reset_phase_profile(phase_totals* totals);
+
+/**
+ * \brief Reduces the phase counters of a solver_memory set over all threads on the current device,
+ *        adds them to the host totals and zeros them
+ * \param[in,out]   totals      The host phase totals
+ * \param[in,out]   phases      The device counters, solver_memory::phases
+ * \param[in]       padded      The padded number of threads of the solver_memory set
+ * \param[in]       stream      The stream of the solver_memory set
+ *
+ * Blocks until the integration of the set is complete.  Does nothing if #PROFILE_PHASES is not defined.
+ */
+void accumulate_phase_profile(phase_totals* totals, long long* phases, const int padded,
+                              cudaStream_t stream = 0);
+
+/**
+ * \brief Copies the host phase totals
+ * \param[in]       totals      The host phase totals
+ * \param[out]      cycles      The (#NUM_PHASES) total cycles per phase
+ * \param[out]      calls       The (#NUM_PHASES) total calls per phase
+ *
+ * All entries are zero if #PROFILE_PHASES is not defined.
+ */
+void get_phase_profile(const phase_totals* totals, long long* cycles, long long* calls);
+
+/**
+ * \brief Prints the host phase totals
+ * \param[in]       totals      The host phase totals
+ * \param[in]       file        The output stream
+ */
+void print_phase_profile(const phase_totals* totals, FILE* file);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
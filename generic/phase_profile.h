@@ -0,0 +1,149 @@
+/**
+ * \file
+ * \brief Definitions for the per-phase profiling of the CPU solvers
+ *
+ * If #PROFILE_PHASES is defined, the integrators bracket their hot paths (the RHS and Jacobian
+ * evaluations, the LU factorizations, the Newton iterations, the Arnoldi iterations and the
+ * evaluation of the matrix exponential / phi-functions) with PHASE_BEGIN / PHASE_END, which
+ * accumulate the elapsed cycles and the number of calls in (OpenMP thread-private) counters.
+ * The counters are merged over the threads of a team by get_phase_profile, hence concurrent
+ * solver instances must use separate teams (e.g. be driven from separate host threads).  The phases are inclusive,
+ * e.g. the Newton phase contains the RHS evaluations of the Newton iterations.
+ *
+ * If #PROFILE_RANGES is also defined, each phase is emitted as an ITT task, such that the
+ * phases show up on the VTune timeline of each thread.
+ */
+
+#ifndef PHASE_PROFILE_H
+#define PHASE_PROFILE_H
+
+#include <stdio.h>
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief The profiled solver phases
+ */
+enum PhaseIndex
+{
+    //! RHS (dydt) evaluations
+    PHASE_RHS = 0,
+    //! Jacobian evaluations (or Jacobian operator updates)
+    PHASE_JACOBIAN = 1,
+    //! LU factorizations of the iteration matrix
+    PHASE_LU = 2,
+    //! Newton iterations (including their RHS evaluations and back-substitutions)
+    PHASE_NEWTON = 3,
+    //! Arnoldi iterations (including the evaluation of the phi-functions)
+    PHASE_KRYLOV = 4,
+    //! Matrix exponential / phi-function evaluations of the Hessenberg matrix
+    PHASE_PHI = 5
+};
+
+//! The number of profiled phases
+#define NUM_PHASES (6)
+
+/**
+ * \brief Returns the name of `phase`
+ * \param[in]       phase       The phase, @see PhaseIndex
+ */
+const char* phase_name(const int phase);
+
+#ifdef PROFILE_PHASES
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#ifdef PROFILE_RANGES
+#include <ittnotify.h>
+//! The ITT domain of the solver phases
+extern __itt_domain* phase_domain;
+//! The ITT names of the solver phases
+extern __itt_string_handle* phase_handles[NUM_PHASES];
+#endif
+
+//! The cycles spent in each phase by this thread
+extern long long phase_cycles[NUM_PHASES];
+//! The number of calls of each phase by this thread
+extern long long phase_calls[NUM_PHASES];
+#pragma omp threadprivate(phase_cycles, phase_calls)
+
+/**
+ * \brief Returns the current cycle (time stamp) counter, or the time in ns if it is unavailable
+ */
+static inline long long phase_clock()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (long long)__rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+/**
+ * \brief Starts `phase` on this thread, the start time is subtracted and added back by phase_end
+ */
+static inline void phase_begin(const int phase)
+{
+#ifdef PROFILE_RANGES
+    __itt_task_begin(phase_domain, __itt_null, __itt_null, phase_handles[phase]);
+#endif
+    phase_cycles[phase] -= phase_clock();
+}
+
+/**
+ * \brief Ends `phase` on this thread
+ */
+static inline void phase_end(const int phase)
+{
+    phase_cycles[phase] += phase_clock();
+    phase_calls[phase] += 1;
+#ifdef PROFILE_RANGES
+    __itt_task_end(phase_domain);
+#endif
+}
+
+    //! Start timing the given phase on this thread
+    #define PHASE_BEGIN(phase) phase_begin(phase)
+    //! Stop timing the given phase on this thread, must follow the matching PHASE_BEGIN
+    #define PHASE_END(phase) phase_end(phase)
+#else
+    #define PHASE_BEGIN(phase)
+    #define PHASE_END(phase)
+#endif
+
+/**
+ * \brief Zeros the phase counters of all threads of the team
+ * \param[in]       num_threads The number of OpenMP threads of the team that integrates
+ */
+void reset_phase_profile(const int num_threads);
+
+/**
+ * \brief Merges the phase counters of all threads of the team
+ * \param[in]       num_threads The number of OpenMP threads of the team that integrated
+ * \param[out]      cycles      The (#NUM_PHASES) total cycles per phase
+ * \param[out]      calls       The (#NUM_PHASES) total calls per phase
+ *
+ * All entries are zero if #PROFILE_PHASES is not defined.
+ */
+void get_phase_profile(const int num_threads, long long* cycles, long long* calls);
+
+/**
+ * \brief Prints the merged phase counters of all threads of the team
+ * \param[in]       num_threads The number of OpenMP threads of the team that integrated
+ * \param[in]       file        The output stream
+ */
+void print_phase_profile(const int num_threads, FILE* file);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -7,58 +7,155 @@
  *
  */
 
+//! for the POSIX memory mapping functions
+#define _POSIX_C_SOURCE 200112L
+
 #include "header.h"
+#include "read_initial_conditions.h"
+#include "numa_placement.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <sys/time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//! The number of state vector entries per IVP in y_host
+#define IC_WIDTH (NSP)
+
+#ifdef NUMA_FIRST_TOUCH
+ #ifdef _OPENMP
+  //! The number of threads the per-IVP arrays are first touched by (as set by the executables)
+  #define IC_THREADS (omp_get_max_threads())
+ #else
+  #define IC_THREADS (1)
+ #endif
+#endif
+
+//! The memory mapped file backing y_host / variable_host (if used in place), @see free_initial_conditions
+static void* ic_mapping = NULL;
+//! The size of ic_mapping
+static size_t ic_mapping_size = 0;
 
 /**
- * \brief Reads initial conditions for IVPs from binary file
+ * \brief Maps `filename` into memory
+ * \param[in]       filename        the file to map
+ * \param[in]       writable        if true, the (private, copy-on-write) mapping may be written to
+ * \param[out]      size            the size of the file in bytes
+ */
+static void* map_file(const char* filename, const bool writable, size_t* size)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Could not open file: %s\n", filename);
+        exit(-1);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        fprintf(stderr, "Could not determine the size of file: %s\n", filename);
+        exit(-1);
+    }
+    *size = (size_t)info.st_size;
+    void* data = mmap(NULL, *size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "Could not map file: %s\n", filename);
+        exit(-1);
+    }
+    posix_madvise(data, *size, POSIX_MADV_SEQUENTIAL);
+    return data;
+}
+
+/**
+ * \brief Reads a pre-transposed initial condition file, @see write_initial_conditions
  *
- * \param[in]           filename            the file to read from
- * \param[in]           NUM                 the number of IVP initial conditions to read
- * \param[in,out]       y_host              Address of the host state vector pointer.
-                                            This is initialized and populated by this method
- * \param[in, out]      variable_host       Address of the host pressure/density pointer.
-                                            This is initialized and populated by this method
+ * If the file contains exactly NUM IVPs, `y_host` and `variable_host` point directly into
+ * the (copy-on-write) mapped file.  Otherwise the first NUM IVPs are copied.
  *
- * Note: the data file is expected to be in the following format:\n
-        time, Temperature, Pressure, mass fractions         (State #1) \n
-        time, Temperature, Pressure, mass fractions         (State #2) ...
+ * If #NUMA_FIRST_TOUCH is defined, the IVPs are always copied, into arrays first touched by
+ * the threads of the drivers, @see allocate_ivp_array
  */
- void read_initial_conditions(const char* filename, int NUM, double** y_host, double** variable_host) {
-    (*y_host) = (double*)malloc(NUM * NSP * sizeof(double));
-    (*variable_host) = (double*)malloc(NUM * sizeof(double));
-    FILE *fp = fopen (filename, "rb");
-    if (fp == NULL)
+static void read_soa_initial_conditions(const char* filename, const int NUM, double** y_host, double** variable_host)
+{
+    size_t size = 0;
+    char* data = (char*)map_file(filename, true, &size);
+    const soa_ic_header* header = (const soa_ic_header*)data;
+    if (header->width != IC_WIDTH || header->num < NUM ||
+        size < sizeof(soa_ic_header) + (size_t)header->num * (IC_WIDTH + 1) * sizeof(double))
     {
-        fprintf(stderr, "Could not open file: %s\n", filename);
+        fprintf(stderr, "File (%s) is incorrectly formatted, %d IVPs of width %d were expected but the file contains "
+                        "%d IVPs of width %d.\n", filename, NUM, IC_WIDTH, (int)header->num, (int)header->width);
         exit(-1);
     }
-    double buffer[NN + 2];
+    const int num = (int)header->num;
+    double* var_file = (double*)(data + sizeof(soa_ic_header));
+    double* y_file = var_file + num;
+#ifndef NUMA_FIRST_TOUCH
+    if (num == NUM)
+    {
+        // use in place
+        *variable_host = var_file;
+        *y_host = y_file;
+        ic_mapping = data;
+        ic_mapping_size = size;
+        return;
+    }
+    (*y_host) = (double*)malloc(NUM * IC_WIDTH * sizeof(double));
+    (*variable_host) = (double*)malloc(NUM * sizeof(double));
+#else
+    (*y_host) = allocate_ivp_array(NUM, IC_WIDTH, IC_THREADS);
+    (*variable_host) = allocate_ivp_array(NUM, 1, IC_THREADS);
+#endif
+    memcpy(*variable_host, var_file, NUM * sizeof(double));
+    #pragma omp parallel for
+    for (int j = 0; j < IC_WIDTH; ++j)
+        memcpy(&(*y_host)[j * NUM], &y_file[j * num], NUM * sizeof(double));
+    munmap(data, size);
+}
+
+/**
+ * \brief Masks, transposes and (for #CONV) converts rows of the raw initial condition format
+ *
+ * \param[in]           data                NUM rows of (NN + 2) doubles: time, Temperature, Pressure, mass fractions
+ * \param[in]           NUM                 the number of rows
+ * \param[out]          y_host              the (NUM * IC_WIDTH) state vectors, stored as `y_host[i + j * NUM]`
+ * \param[out]          variable_host       the (NUM) pressures/densities
+ *
+ * @see read_initial_conditions
+ */
+void convert_initial_conditions(const double* data, int NUM, double* y_host, double* variable_host)
+{
+    double* y = y_host;
 
     // load temperature and mass fractions for all threads (cells)
+    #pragma omp parallel for
     for (int i = 0; i < NUM; ++i)
     {
-        // read line from data file
-        int count = fread(buffer, sizeof(double), NN + 2, fp);
-        if (count != (NN + 2))
-        {
-            fprintf(stderr, "File (%s) is incorrectly formatted, %d doubles were expected but only %d were read.\n", filename, NN + 1, count);
-            exit(-1);
-        }
+        // copy the row from the mapped data file
+        double buffer[NN + 2];
+        memcpy(buffer, &data[i * (NN + 2)], (NN + 2) * sizeof(double));
         //apply mask if necessary
         apply_mask(&buffer[3]);
         //put into y_host
-        (*y_host)[i] = buffer[1];
+        y[i] = buffer[1];
 #ifdef CONP
-        (*variable_host)[i] = buffer[2];
+        variable_host[i] = buffer[2];
 #elif CONV
         double pres = buffer[2];
 #endif
         for (int j = 0; j < NSP - 1; j++)
-            (*y_host)[i + (j + 1) * NUM] = buffer[j + 3];
+            y[i + (j + 1) * NUM] = buffer[j + 3];
 
         // if constant volume, calculate density
 #ifdef CONV
@@ -67,12 +164,114 @@
 
         for (int j = 0; j < NSP - 1; ++j)
         {
-            Yi[j] = (*y_host)[i + (j + 1) * NUM];
+            Yi[j] = y[i + (j + 1) * NUM];
         }
 
         mass2mole (Yi, Xi);
-        (*variable_host)[i] = getDensity ((*y_host)[i], pres, Xi);
+        variable_host[i] = getDensity (y[i], pres, Xi);
+#endif
+    }
+}
+
+/**
+ * \brief Reads initial conditions for IVPs from binary file
+ *
+ * \param[in]           filename            the file to read from
+ * \param[in]           NUM                 the number of IVP initial conditions to read
+ * \param[in,out]       y_host              Address of the host state vector pointer.
+                                            This is initialized and populated by this method
+ * \param[in, out]      variable_host       Address of the host pressure/density pointer.
+                                            This is initialized and populated by this method
+ *
+ * Note: the data file is expected to be in the following format:\n
+        time, Temperature, Pressure, mass fractions         (State #1) \n
+        time, Temperature, Pressure, mass fractions         (State #2) ...
+ *
+ * The file is memory mapped, and the rows are masked, transposed and (for #CONV) converted
+ * to densities in parallel.  Alternatively, the file may be in the pre-transposed format written
+ * by write_initial_conditions, which is used in place if it contains exactly NUM IVPs.
+ * The arrays must be released with free_initial_conditions.
+ *
+ * If #NUMA_FIRST_TOUCH is defined, the arrays are first touched by the threads of the drivers,
+ * @see allocate_ivp_array
+ */
+ void read_initial_conditions(const char* filename, int NUM, double** y_host, double** variable_host) {
+    size_t size = 0;
+    const double* data = (const double*)map_file(filename, false, &size);
+    if (size >= sizeof(soa_ic_header) && memcmp(data, SOA_IC_MAGIC, sizeof(((soa_ic_header*)0)->magic)) == 0)
+    {
+        munmap((void*)data, size);
+        read_soa_initial_conditions(filename, NUM, y_host, variable_host);
+        return;
+    }
+    if (size < (size_t)NUM * (NN + 2) * sizeof(double))
+    {
+        fprintf(stderr, "File (%s) is incorrectly formatted, %d doubles were expected but only %d were read.\n",
+                filename, NUM * (NN + 2), (int)(size / sizeof(double)));
+        exit(-1);
+    }
+
+#ifdef NUMA_FIRST_TOUCH
+    (*y_host) = allocate_ivp_array(NUM, NSP, IC_THREADS);
+    (*variable_host) = allocate_ivp_array(NUM, 1, IC_THREADS);
+#else
+    (*y_host) = (double*)malloc(NUM * NSP * sizeof(double));
+    (*variable_host) = (double*)malloc(NUM * sizeof(double));
 #endif
+
+    convert_initial_conditions(data, NUM, *y_host, *variable_host);
+    munmap((void*)data, size);
+}
+
+/**
+ * \brief Writes initial conditions in the pre-transposed (and masked) format
+ *
+ * \param[in]           filename            the file to write to
+ * \param[in]           NUM                 the number of IVPs
+ * \param[in]           y_host              the state vectors, as populated by read_initial_conditions
+ * \param[in]           variable_host       the pressures/densities, as populated by read_initial_conditions
+ *
+ * The file consists of a soa_ic_header, followed by `variable_host` and `y_host` as stored in memory,
+ * such that read_initial_conditions can use it in place.
+ */
+void write_initial_conditions(const char* filename, int NUM, const double* y_host, const double* variable_host)
+{
+    FILE *fp = fopen (filename, "wb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Could not open file: %s\n", filename);
+        exit(-1);
+    }
+    soa_ic_header header;
+    memcpy(header.magic, SOA_IC_MAGIC, sizeof(header.magic));
+    header.num = NUM;
+    header.width = IC_WIDTH;
+    if (fwrite(&header, sizeof(soa_ic_header), 1, fp) != 1 ||
+        fwrite(variable_host, sizeof(double), NUM, fp) != (size_t)NUM ||
+        fwrite(y_host, sizeof(double), (size_t)NUM * IC_WIDTH, fp) != (size_t)NUM * IC_WIDTH)
+    {
+        fprintf(stderr, "Could not write file: %s\n", filename);
+        exit(-1);
     }
     fclose (fp);
-}
\ No newline at end of file
+}
+
+/**
+ * \brief Releases the initial conditions returned by read_initial_conditions
+ *
+ * \param[in]           y_host              the host state vector pointer
+ * \param[in]           variable_host       the host pressure/density pointer
+ */
+void free_initial_conditions(double* y_host, double* variable_host)
+{
+    if (ic_mapping != NULL && (char*)y_host > (char*)ic_mapping &&
+        (char*)y_host < (char*)ic_mapping + ic_mapping_size)
+    {
+        munmap(ic_mapping, ic_mapping_size);
+        ic_mapping = NULL;
+        ic_mapping_size = 0;
+        return;
+    }
+    free(y_host);
+    free(variable_host);
+}
@@ -9,5 +9,27 @@
 
 #ifndef READ_INITIAL_CONDITIONS_H
 #define READ_INITIAL_CONDITIONS_H
+
+#include <stdint.h>
+
+//! The magic bytes identifying the pre-transposed initial condition format
+#define SOA_IC_MAGIC "ACCINTSA"
+
+/**
+ * \brief The header of the pre-transposed initial condition format, @see write_initial_conditions
+ */
+typedef struct
+{
+    //! #SOA_IC_MAGIC (without the terminating null)
+    char magic[8];
+    //! the number of IVPs in the file
+    int64_t num;
+    //! the number of state vector entries per IVP
+    int64_t width;
+} soa_ic_header;
+
 void read_initial_conditions(const char* filename, int NUM, double** y_host, double** variable_host);
-#endif
\ No newline at end of file
+void convert_initial_conditions(const double* data, int NUM, double* y_host, double* variable_host);
+void write_initial_conditions(const char* filename, int NUM, const double* y_host, const double* variable_host);
+void free_initial_conditions(double* y_host, double* variable_host);
+#endif
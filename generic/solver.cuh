@@ -14,13 +14,14 @@
  #include "solver_options.cuh"
  #include "solver_init.cuh"
  #include "solver_props.cuh"
+ #include "launch_config.cuh"
 
 #ifdef GENERATE_DOCS
  namespace genericcu {
 #endif
 
  __global__
-void intDriver (const int NUM,
+void DRIVER_LAUNCH_BOUNDS intDriver (const int NUM,
                 const double t,
                 const double t_end,
                 const double * __restrict__ pr_global,
@@ -28,6 +29,63 @@ void intDriver (const int NUM,
                 const mechanism_memory * __restrict__ d_mem,
                 const solver_memory * __restrict__ s_mem);
 
+ __global__
+void DRIVER_LAUNCH_BOUNDS intDriverLocal (const int NUM,
+                const double * __restrict__ t_local,
+                const double * __restrict__ t_end_local,
+                const double * __restrict__ pr_global,
+                double * __restrict__ y_global,
+                const mechanism_memory * __restrict__ d_mem,
+                const solver_memory * __restrict__ s_mem);
+
+#ifdef MANAGED_MEMORY
+ __global__
+void DRIVER_LAUNCH_BOUNDS intDriverManaged (const int NUM,
+                const int ld,
+                const double t,
+                const double t_end,
+                const double * __restrict__ pr_global,
+                double * __restrict__ y_global,
+                const mechanism_memory * __restrict__ d_mem,
+                const solver_memory * __restrict__ s_mem);
+#endif
+
+#ifdef PERSISTENT_KERNEL
+/**
+ * \brief The device-side work queue of the persistent integration kernel, covering all IVPs of a launch
+ *
+ * All arrays are stored with a leading dimension of #num, e.g. `y[ivp + i * num]`
+ */
+struct ivp_queue
+{
+    //! The number of IVPs in the queue
+    int num;
+    //! The index of the next unsolved IVP, zeroed before each launch
+    int* next;
+    //! The system constant variables (pressures / densities)
+    double* var;
+    //! The state vectors
+    double* y;
+    //! The result codes
+    int* result;
+#ifdef STATISTICS
+    //! The per-IVP statistics @see StatisticIndex
+    int* stats;
+#endif
+#ifdef SOLVER_WARM_START
+    //! The per-IVP warm start state
+    double* warm;
+#endif
+};
+
+ __global__
+void DRIVER_LAUNCH_BOUNDS intDriverPersistent (const double t,
+                          const double t_end,
+                          const ivp_queue queue,
+                          const mechanism_memory * __restrict__ d_mem,
+                          const solver_memory * __restrict__ s_mem);
+#endif
+
 __device__ void integrate (const double,
 						   const double,
 						   const double,
@@ -11,6 +11,7 @@
  #ifndef SOLVER_H
  #define SOLVER_H
 
+ #include <stddef.h>
  #include "solver_options.h"
  #include "solver_init.h"
  #include "solver_props.h"
@@ -19,8 +20,12 @@
  namespace generic {
 #endif
 
+ //! The state of a solver instance, @see solver_context.h
+ typedef struct accelerInt_context accelerInt_context;
+
 /**
  * \brief Integration driver for the CPU integrators
+ * \param[in,out]   context         The solver instance, @see solver_context.h
  * \param[in]       NUM             The (non-padded) number of IVPs to integrate
  * \param[in]       t               The current system time
  * \param[in]       t_end           The IVP integration end time
@@ -29,9 +34,32 @@
                                     Returns system state vectors at time t_end
  *
  */
- void intDriver (const int NUM, const double t, const double t_end,
+ void intDriver (accelerInt_context* context, const int NUM, const double t, const double t_end,
                 const double* pr_global, double* y_global);
 
+/**
+ * \brief Integration driver for the CPU integrators, with per-IVP integration intervals (local time stepping)
+ * \param[in,out]   context         The solver instance, @see solver_context.h
+ * \param[in]       NUM             The (non-padded) number of IVPs to integrate
+ * \param[in]       t_local         The (NUM) current times of the IVPs
+ * \param[in]       t_end_local     The (NUM) integration end times of the IVPs, `t_end_local[tid] >= t_local[tid]`
+ * \param[in]       pr_global       The system constant variable (pressures / densities)
+ * \param[in,out]   y_global        The system state vectors at their times `t_local`.
+                                    Returns system state vectors at their times `t_end_local`
+ *
+ */
+ void intDriverLocal (accelerInt_context* context, const int NUM, const double* t_local, const double* t_end_local,
+                      const double* pr_global, double* y_global);
+
+/**
+ * \brief The start (or end) time of IVP `tid`, i.e. the per-IVP `times[tid]` of intDriverLocal,
+ *        or the common time `t` of intDriver if `times` is NULL
+ */
+ static inline double ivp_time(const double* times, const double t, const int tid)
+ {
+    return times == NULL ? t : times[tid];
+ }
+
  /**
   * \brief A header definition of the integrate method, that must be implemented by various solvers
   * \param[in]          t_start             the starting IVP integration time
@@ -42,6 +70,21 @@
   */
  int integrate(const double t_start, const double t_end, const double pr, double* y);
 
+#if defined(SIMD_LANES) && defined(LANE_INTEGRATOR)
+ /**
+  * \brief A header definition of the lockstep integrate method, implemented by the solvers that define LANE_INTEGRATOR
+  * \param[in]          t_start             the starting IVP integration time
+  * \param[in]          t_end               the IVP integration endtime
+  * \param[in]          num_lanes           the number of IVPs in the group (at most #SIMD_LANES)
+  * \param[in]          pr                  the IVP constant variables (presssures/densities) of the group
+  * \param[in,out]      y                   The lane-wise state vectors (`y[lane + i * SIMD_LANES]`) at time t_start.
+                                            At end of this function call, the system states at time t_end are stored here
+  * \param[out]         result              The return codes of the IVPs in the group
+  */
+ void integrate_lanes(const double t_start, const double t_end, const int num_lanes, const double* pr,
+                      double* y, int* result);
+#endif
+
 #ifdef GENERATE_DOCS
 }
 #endif
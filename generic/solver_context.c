@@ -0,0 +1,60 @@
+/**
+ * \file
+ * \brief Initialization and cleanup of the state of a CPU solver instance, @see solver_context.h
+ */
+
+#include <string.h>
+#include "header.h"
+#include "solver_context.h"
+#include "isa_dispatch.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief Initializes `context` and the integrator memory for `num_threads` OpenMP threads
+ * \param[out]      context         The context to initialize
+ * \param[in]       num_threads     The number of OpenMP threads to use
+ */
+void initialize_context(accelerInt_context* context, const int num_threads)
+{
+    memset(context, 0, sizeof(accelerInt_context));
+    context->num_threads = num_threads;
+    select_isa();
+    initialize_tolerances(&context->tol);
+    context->solver = initialize_solver(num_threads);
+#ifdef ISAT
+    context->isat = create_isat();
+#endif
+}
+
+/**
+ * \brief Frees the integrator memory and host storage of `context`
+ * \param[in,out]   context         The context initialized by initialize_context
+ */
+void cleanup_context(accelerInt_context* context)
+{
+    cleanup_solver(context->num_threads, context->solver);
+    context->solver = NULL;
+    cleanup_ivp_order(&context->order);
+#ifdef HYBRID_DISPATCH
+    cleanup_hybrid(&context->hybrid);
+#endif
+    cleanup_statistics(&context->stats);
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+    cleanup_warm_start(&context->warm);
+#endif
+#ifdef FAILURE_RETRY
+    cleanup_failures(&context->failures);
+#endif
+#ifdef ISAT
+    release_isat(context->isat);
+    context->isat = NULL;
+    cleanup_isat_batch(&context->isat_work);
+#endif
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,87 @@
+/**
+ * \file
+ * \brief The state of a CPU solver instance
+ *
+ * Bundles the per-thread integrator memory and the per-IVP host storage that is kept between
+ * calls to intDriver: the tolerances, the accumulated statistics, the cost ordering, the warm start memory,
+ * the hybrid partition, the event requests, the failure bookkeeping and the ISAT table.  Each instance (i.e. each accelerInt_context,
+ * or the driver of solver_main.c) owns its context, such that independent instances never
+ * share mutable memory, and may integrate concurrently from different host threads.
+ */
+
+#ifndef SOLVER_CONTEXT_H
+#define SOLVER_CONTEXT_H
+
+#include "solver.h"
+#include "solver_stats.h"
+#include "load_balance.h"
+#include "warm_start.h"
+#include "hybrid.h"
+#include "events.h"
+#include "tolerances.h"
+#include "failure_retry.h"
+#include "isat.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief The state of a CPU solver instance, @see initialize_context
+ */
+struct accelerInt_context
+{
+    //! The number of OpenMP threads used by intDriver
+    int num_threads;
+    //! The per-thread integrator memory returned by initialize_solver (NULL for the stateless solvers)
+    void* solver;
+    //! The integration tolerances, @see tolerances.h
+    ivp_tolerances tol;
+    //! The (NUM) tolerance scaling factors used by intDriver, indexed by IVP, or NULL to use #tol for all IVPs
+    const double* tol_scale;
+    //! The accumulated per-IVP statistics
+    ivp_statistics stats;
+    //! The per-IVP cost bookkeeping (#COST_REORDER)
+    ivp_ordering order;
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+    //! The per-IVP warm start memory
+    warm_start_storage warm;
+#endif
+#ifdef HYBRID_DISPATCH
+    //! The partition arrays of the hybrid dispatch
+    hybrid_storage hybrid;
+#endif
+#ifdef EVENT_DRIVER
+    //! The (NUM) event requests used by intDriver, indexed by IVP, or NULL to disable event detection
+    event_request* events;
+#endif
+#ifdef FAILURE_RETRY
+    //! The per-IVP failure codes and the retry queue
+    failure_storage failures;
+#endif
+#ifdef ISAT
+    //! The ISAT table, which may be shared with other instances, @see accelerInt_context_share_isat
+    isat_table* isat;
+    //! The workspace of the ISAT queries
+    isat_batch isat_work;
+#endif
+};
+
+/**
+ * \brief Initializes `context` and the integrator memory for `num_threads` OpenMP threads
+ * \param[out]      context         The context to initialize
+ * \param[in]       num_threads     The number of OpenMP threads to use
+ */
+void initialize_context(accelerInt_context* context, const int num_threads);
+
+/**
+ * \brief Frees the integrator memory and host storage of `context`
+ * \param[in,out]   context         The context initialized by initialize_context
+ */
+void cleanup_context(accelerInt_context* context);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
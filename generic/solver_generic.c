@@ -9,53 +9,474 @@
 
 #include "header.h"
 #include "solver.h"
+#include "solver_context.h"
+#include "state_layout.h"
+#include "isa_dispatch.h"
+
+#ifdef ISA_DISPATCHED
+    // call the integrators of the ISA level chosen by select_isa
+    #define integrate (*isa_integrate)
+    #define integrate_lanes (*isa_integrate_lanes)
+#endif
 
 #ifdef GENERATE_DOCS
  namespace generic {
 #endif
 
+#if defined(SIMD_LANES) && defined(STATE_BLOCK) && STATE_BLOCK == SIMD_LANES && !defined(COST_REORDER) \
+    && !defined(FAILURE_RETRY)
+//! The lane groups of the lockstep driver are the blocks of the state vectors, which are integrated in place
+#define LANES_IN_PLACE
+#endif
+
+#ifdef FAILURE_RETRY
+
 /**
- * \brief Integration driver for the CPU integrators
+ * \brief Re-integrates the IVPs queued by the current integration step, @see failure_retry.h
+ * \param[in,out]   context         The solver instance
+ * \param[in]       NUM             The (non-padded) number of IVPs to integrate
+ * \param[in]       t               The current system time
+ * \param[in]       t_end           The IVP integration end time
+ * \param[in]       t_local         The per-IVP current times, or NULL if all IVPs are at `t`
+ * \param[in]       t_end_local     The per-IVP end times, or NULL if all IVPs end at `t_end`
+ * \param[in]       pr_global       The system constant variable (pressures / densities)
+ * \param[in,out]   y_global        The system state vectors, the queued IVPs at time t.
+                                    Returns the re-integrated state vectors at time t_end
+ *
+ * Each queued IVP is restarted from its state at `t` by integrate() (i.e. by the stiff integrator,
+ * also for IVPs dispatched to RKC by #HYBRID, or the scalar integrator for #SIMD_LANES), cold and over
+ * #FAILURE_RETRY_SPLITS equal sub-intervals, such that the initial step size is estimated for, and the
+ * step count limited to, each sub-interval.  IVPs that fail again are left at time `t`.
+ */
+static void retry_failures (accelerInt_context* context, const int NUM, const double t, const double t_end,
+                            const double* t_local, const double* t_end_local,
+                            const double *pr_global, double *y_global)
+{
+    failure_storage* failures = &context->failures;
+    const int num_queued = failures->num_queued;
+#ifdef SOLVER_WARM_START
+    resize_warm_start(&context->warm, NUM);
+#endif
+    int q;
+    #pragma omp parallel for shared(y_global, pr_global, failures) private(q) schedule(dynamic) num_threads(context->num_threads)
+    for (q = 0; q < num_queued; ++q) {
+        const int tid = failures->queue[q];
+
+        double y_local[NSP];
+        double pr_local = pr_global[tid];
+        for (int i = 0; i < NSP; i++)
+        {
+            y_local[i] = y_global[state_index(tid, i, NUM)];
+        }
+
+#ifdef STATISTICS
+        clear_counters();
+#endif
+        load_tolerances(&context->tol, context->tol_scale, tid, &current_tolerances);
+#ifdef SOLVER_WARM_START
+        current_warm_start = get_warm_start(&context->warm, tid);
+        current_warm_start->valid = false;
+#endif
+#ifdef EVENT_DRIVER
+        current_event = context->events == NULL ? NULL : &context->events[tid];
+#endif
+        const double t_ivp = ivp_time(t_local, t, tid);
+        const double t_end_ivp = ivp_time(t_end_local, t_end, tid);
+        int code = EC_success;
+        for (int s = 0; s < FAILURE_RETRY_SPLITS && code == EC_success; ++s)
+        {
+            const double t_s = t_ivp + s * (t_end_ivp - t_ivp) / FAILURE_RETRY_SPLITS;
+            const double t_e = s + 1 == FAILURE_RETRY_SPLITS ? t_end_ivp :
+                               t_ivp + (s + 1) * (t_end_ivp - t_ivp) / FAILURE_RETRY_SPLITS;
+            code = integrate (t_s, t_e, pr_local, y_local);
+        }
+#ifdef STATISTICS
+        store_counters(&context->stats, tid);
+#endif
+        record_retry(failures, tid, code);
+        if (code != EC_success)
+        {
+#ifdef SOLVER_WARM_START
+            current_warm_start->valid = false;
+#endif
+            continue;
+        }
+
+        for (int i = 0; i < NSP; i++)
+        {
+            y_global[state_index(tid, i, NUM)] = y_local[i];
+        }
+    }
+    failures->num_queued = 0;
+}
+
+#endif
+
+#if defined(SIMD_LANES) && defined(LANE_INTEGRATOR)
+
+/**
+ * \brief Lockstep integration driver for the CPU integrators, @see intDriver and intDriverLocal
+ * \param[in,out]   context         The solver instance
  * \param[in]       NUM             The (non-padded) number of IVPs to integrate
  * \param[in]       t               The current system time
  * \param[in]       t_end           The IVP integration end time
+ * \param[in]       t_local         The per-IVP current times, or NULL if all IVPs are at `t`
+ * \param[in]       t_end_local     The per-IVP end times, or NULL if all IVPs end at `t_end`
+ * \param[in]       pr_global       The system constant variable (pressures / densities)
+ * \param[in,out]   y_global        The system state vectors at time t.
+                                    Returns system state vectors at time t_end
+ *
+ * Each OpenMP thread integrates groups of #SIMD_LANES IVPs in lockstep via integrate_lanes,
+ * using the same lane-wise layout as `y_global` (the column-major layout of a group of IVPs).  If the
+ * groups are the blocks of `y_global` (#STATE_BLOCK, @see state_layout.h), each full group is integrated
+ * in place, without gathering its state vectors.  The tolerances of each lane are passed to the
+ * solver via #current_lane_tolerances, and the warm start memory of each lane (if the solver keeps any)
+ * via #current_lane_warm_start.  With per-IVP times, a group whose lanes do not share
+ * their integration interval is integrated one lane at a time by integrate().
+ *
+ * The OpenMP schedule is controlled by #SCHEDULE_CLAUSE.  If #COST_REORDER is defined
+ * the IVPs are grouped in order of descending cost measured on the previous call,
+ * such that IVPs with similar cost share a group.
+ *
+ * If #FAILURE_RETRY is defined, the failed lanes are re-integrated one at a time once all groups are done, @see retry_failures
+ */
+static void drive (accelerInt_context* context, const int NUM, const double t, const double t_end,
+                   const double* t_local, const double* t_end_local,
+                   const double *pr_global, double *y_global)
+{
+#ifdef COST_REORDER
+    const int* order = get_ivp_order(&context->order, NUM);
+#endif
+#ifdef SOLVER_WARM_START
+    resize_warm_start(&context->warm, NUM);
+#endif
+#ifdef FAILURE_RETRY
+    if (context->failures.num != NUM)
+        reset_failures(&context->failures, NUM);
+#endif
+    const int num_groups = (NUM + SIMD_LANES - 1) / SIMD_LANES;
+    int g;
+    #pragma omp parallel for shared(y_global, pr_global) private(g) SCHEDULE_CLAUSE num_threads(context->num_threads)
+    for (g = 0; g < num_groups; ++g) {
+        const int num_lanes = NUM - g * SIMD_LANES < SIMD_LANES ? NUM - g * SIMD_LANES : SIMD_LANES;
+        int tid[SIMD_LANES];
+        for (int l = 0; l < num_lanes; ++l)
+        {
+#ifdef COST_REORDER
+            tid[l] = order[g * SIMD_LANES + l];
+#else
+            tid[l] = g * SIMD_LANES + l;
+#endif
+        }
+#ifdef COST_REORDER
+        double cost_start = COST_TIMER();
+#endif
+
+        // local lane-wise arrays with initial values
+        double y_group[NSP * SIMD_LANES];
+        double pr_local[SIMD_LANES];
+        int result[SIMD_LANES];
+#ifdef LANES_IN_PLACE
+        // a full group is the g-th block of the global array
+        const bool in_place = num_lanes == SIMD_LANES;
+        double* y_local = in_place ? &y_global[(size_t)g * SIMD_LANES * NSP] : y_group;
+#else
+        const bool in_place = false;
+        double* y_local = y_group;
+#endif
+
+        // load local array with initial values from global array
+        for (int l = 0; l < num_lanes; ++l)
+        {
+            pr_local[l] = pr_global[tid[l]];
+            for (int i = 0; i < NSP && !in_place; i++)
+            {
+                y_local[l + i * SIMD_LANES] = y_global[state_index(tid[l], i, NUM)];
+            }
+        }
+        // unused lanes of the last group
+        for (int l = num_lanes; l < SIMD_LANES; ++l)
+        {
+            pr_local[l] = pr_local[0];
+        }
+        for (int l = 0; l < SIMD_LANES; ++l)
+        {
+            load_tolerances(&context->tol, context->tol_scale, tid[l < num_lanes ? l : 0],
+                            &current_lane_tolerances[l]);
+#ifdef SOLVER_WARM_START
+            current_lane_warm_start[l] = l < num_lanes ? get_warm_start(&context->warm, tid[l]) : NULL;
+#endif
+        }
+
+        // the lanes are integrated in lockstep if they share their integration interval
+        const double t_group = ivp_time(t_local, t, tid[0]);
+        const double t_end_group = ivp_time(t_end_local, t_end, tid[0]);
+        bool lockstep = true;
+        for (int l = 1; l < num_lanes; ++l)
+        {
+            lockstep = lockstep && ivp_time(t_local, t, tid[l]) == t_group &&
+                       ivp_time(t_end_local, t_end, tid[l]) == t_end_group;
+        }
+
+        // call integrator for one time step
+        if (lockstep)
+        {
+#ifdef STATISTICS
+            clear_lane_counters();
+#endif
+            integrate_lanes (t_group, t_end_group, num_lanes, pr_local, y_local, result);
+        }
+        else
+        {
+            for (int l = 0; l < num_lanes; ++l)
+            {
+                double y_lane[NSP];
+                for (int i = 0; i < NSP; i++)
+                {
+                    y_lane[i] = y_local[l + i * SIMD_LANES];
+                }
+#ifdef STATISTICS
+                clear_counters();
+#endif
+                load_tolerances(&context->tol, context->tol_scale, tid[l], &current_tolerances);
+#ifdef SOLVER_WARM_START
+                current_warm_start = current_lane_warm_start[l];
+#endif
+#ifdef EVENT_DRIVER
+                current_event = context->events == NULL ? NULL : &context->events[tid[l]];
+#endif
+                result[l] = integrate (ivp_time(t_local, t, tid[l]), ivp_time(t_end_local, t_end, tid[l]),
+                                       pr_local[l], y_lane);
+#ifdef STATISTICS
+                store_counters(&context->stats, tid[l]);
+#endif
+                for (int i = 0; i < NSP; i++)
+                {
+                    y_local[l + i * SIMD_LANES] = y_lane[i];
+                }
+            }
+        }
+        for (int l = 0; l < num_lanes; ++l)
+        {
+#ifdef FAILURE_RETRY
+            if (result[l] != EC_success)
+                queue_failure(&context->failures, tid[l]);
+#else
+            check_error(tid[l], result[l]);
+#endif
+#ifdef STATISTICS
+            if (lockstep)
+                store_lane_counters(&context->stats, l, tid[l]);
+#endif
+        }
+
+        // update global array with integrated values
+        for (int l = 0; l < num_lanes && !in_place; ++l)
+        {
+#ifdef FAILURE_RETRY
+            // failed lanes are restarted from their initial state
+            if (result[l] != EC_success)
+                continue;
+#endif
+            for (int i = 0; i < NSP; i++)
+            {
+                y_global[state_index(tid[l], i, NUM)] = y_local[l + i * SIMD_LANES];
+            }
+        }
+#ifdef COST_REORDER
+        double cost = COST_TIMER() - cost_start;
+        for (int l = 0; l < num_lanes; ++l)
+        {
+            record_ivp_cost(&context->order, tid[l], cost);
+        }
+#endif
+
+    } //end group loop
+#ifdef FAILURE_RETRY
+    retry_failures(context, NUM, t, t_end, t_local, t_end_local, pr_global, y_global);
+#endif
+#ifdef COST_REORDER
+    update_ivp_order(&context->order, NUM);
+#endif
+
+} // end drive
+
+#else
+
+/**
+ * \brief Integration driver for the CPU integrators, @see intDriver and intDriverLocal
+ * \param[in,out]   context         The solver instance
+ * \param[in]       NUM             The (non-padded) number of IVPs to integrate
+ * \param[in]       t               The current system time
+ * \param[in]       t_end           The IVP integration end time
+ * \param[in]       t_local         The per-IVP current times, or NULL if all IVPs are at `t`
+ * \param[in]       t_end_local     The per-IVP end times, or NULL if all IVPs end at `t_end`
  * \param[in]       pr_global       The system constant variable (pressures / densities)
  * \param[in,out]   y_global        The system state vectors at time t.
                                     Returns system state vectors at time t_end
  *
  * This is generic driver for CPU integrators
+ *
+ * The OpenMP schedule is controlled by #SCHEDULE_CLAUSE.  If #COST_REORDER is defined
+ * the IVPs are issued in order of descending cost measured on the previous call.
+ * The tolerances of the current IVP (see tolerances.h) are passed to the solver via #current_tolerances.
+ * If the solver keeps warm start memory (see warm_start.h), the warm start memory of the current IVP
+ * is passed to the solver via #current_warm_start.
+ *
+ * If the solver supports event detection (see events.h), the event request of the current IVP
+ * (if accelerInt_context::events is set) is passed to the solver via #current_event.
+ *
+ * If #HYBRID is defined for a stiff integrator, the stiff IVPs are issued first, followed by
+ * the non-stiff IVPs, which are integrated by RKC, @see hybrid.h
+ *
+ * If #FAILURE_RETRY is defined, the failed IVPs are queued and re-integrated once all other IVPs
+ * are done, rather than exiting the program, @see retry_failures
  */
-void intDriver (const int NUM, const double t, const double t_end,
-                const double *pr_global, double *y_global)
+static void drive (accelerInt_context* context, const int NUM, const double t, const double t_end,
+                   const double* t_local, const double* t_end_local,
+                   const double *pr_global, double *y_global)
 {
-    int tid;
-    #pragma omp parallel for shared(y_global, pr_global) private(tid)
-    for (tid = 0; tid < NUM; ++tid) {
+#ifdef COST_REORDER
+    const int* order = get_ivp_order(&context->order, NUM);
+#endif
+#ifdef SOLVER_WARM_START
+    resize_warm_start(&context->warm, NUM);
+#endif
+#ifdef FAILURE_RETRY
+    if (context->failures.num != NUM)
+        reset_failures(&context->failures, NUM);
+#endif
+#ifdef HYBRID_DISPATCH
+    int num_stiff = 0;
+#ifdef COST_REORDER
+    const int* batches = hybrid_partition(&context->hybrid, context->num_threads, NUM, t, t_end,
+                                          t_local, t_end_local, pr_global, y_global, order, &num_stiff);
+#else
+    const int* batches = hybrid_partition(&context->hybrid, context->num_threads, NUM, t, t_end,
+                                          t_local, t_end_local, pr_global, y_global, NULL, &num_stiff);
+#endif
+#endif
+    int k;
+    #pragma omp parallel for shared(y_global, pr_global) private(k) SCHEDULE_CLAUSE num_threads(context->num_threads)
+    for (k = 0; k < NUM; ++k) {
+#ifdef HYBRID_DISPATCH
+        int tid = batches[k];
+#elif defined(COST_REORDER)
+        int tid = order[k];
+#else
+        int tid = k;
+#endif
+#ifdef COST_REORDER
+        double cost_start = COST_TIMER();
+#endif
 
         // local array with initial values
         double y_local[NSP];
         double pr_local = pr_global[tid];
+        const double t_ivp = ivp_time(t_local, t, tid);
+        const double t_end_ivp = ivp_time(t_end_local, t_end, tid);
 
         // load local array with initial values from global array
 
         for (int i = 0; i < NSP; i++)
         {
-            y_local[i] = y_global[tid + i * NUM];
+            y_local[i] = y_global[state_index(tid, i, NUM)];
         }
 
         // call integrator for one time step
-        check_error(tid, integrate (t, t_end, pr_local, y_local));
+#ifdef STATISTICS
+        clear_counters();
+#endif
+        load_tolerances(&context->tol, context->tol_scale, tid, &current_tolerances);
+#ifdef SOLVER_WARM_START
+        current_warm_start = get_warm_start(&context->warm, tid);
+#endif
+#ifdef EVENT_DRIVER
+        current_event = context->events == NULL ? NULL : &context->events[tid];
+#endif
+        int code;
+#ifdef HYBRID_DISPATCH
+        if (k >= num_stiff)
+        {
+#ifdef SOLVER_WARM_START
+            // the warm start state of the stiff integrator is stale once RKC has integrated the IVP
+            current_warm_start->valid = false;
+#endif
+            code = rkc_integrate (t_ivp, t_end_ivp, pr_local, y_local);
+        }
+        else
+#endif
+        code = integrate (t_ivp, t_end_ivp, pr_local, y_local);
+#ifdef STATISTICS
+        store_counters(&context->stats, tid);
+#endif
+#ifdef FAILURE_RETRY
+        // a failed IVP is restarted from its initial state, which is still in y_global
+        if (code != EC_success)
+            queue_failure(&context->failures, tid);
+        else
+#else
+        check_error(tid, code);
+#endif
 
         // update global array with integrated values
 
         for (int i = 0; i < NSP; i++)
         {
-            y_global[tid + i * NUM] = y_local[i];
+            y_global[state_index(tid, i, NUM)] = y_local[i];
         }
+#ifdef COST_REORDER
+        record_ivp_cost(&context->order, tid, COST_TIMER() - cost_start);
+#endif
 
     } //end tid loop
+#ifdef FAILURE_RETRY
+    retry_failures(context, NUM, t, t_end, t_local, t_end_local, pr_global, y_global);
+#endif
+#ifdef COST_REORDER
+    update_ivp_order(&context->order, NUM);
+#endif
+
+} // end drive
+
+#endif
+
+/**
+ * \brief Integration driver for the CPU integrators
+ * \param[in,out]   context         The solver instance
+ * \param[in]       NUM             The (non-padded) number of IVPs to integrate
+ * \param[in]       t               The current system time
+ * \param[in]       t_end           The IVP integration end time
+ * \param[in]       pr_global       The system constant variable (pressures / densities)
+ * \param[in,out]   y_global        The system state vectors at time t.
+                                    Returns system state vectors at time t_end
+ *
+ * @see drive
+ */
+void intDriver (accelerInt_context* context, const int NUM, const double t, const double t_end,
+                const double *pr_global, double *y_global)
+{
+    drive(context, NUM, t, t_end, NULL, NULL, pr_global, y_global);
+}
 
-} // end intDriver
+/**
+ * \brief Integration driver for the CPU integrators, with per-IVP integration intervals
+ * \param[in,out]   context         The solver instance
+ * \param[in]       NUM             The (non-padded) number of IVPs to integrate
+ * \param[in]       t_local         The (NUM) current times of the IVPs
+ * \param[in]       t_end_local     The (NUM) integration end times of the IVPs
+ * \param[in]       pr_global       The system constant variable (pressures / densities)
+ * \param[in,out]   y_global        The system state vectors at their times `t_local`.
+                                    Returns system state vectors at their times `t_end_local`
+ *
+ * Each IVP is integrated over its own interval in a single pass, i.e. without synchronizing
+ * the IVPs at common time steps.  @see drive
+ */
+void intDriverLocal (accelerInt_context* context, const int NUM, const double* t_local, const double* t_end_local,
+                     const double *pr_global, double *y_global)
+{
+    drive(context, NUM, 0, 0, t_local, t_end_local, pr_global, y_global);
+}
 
 #ifdef GENERATE_DOCS
  }
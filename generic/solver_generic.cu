@@ -26,7 +26,7 @@
  * \param[in]       s_mem           The solver_memory struct that contains the pre-allocated memory for the solver
  */
  __global__
-void intDriver (const int NUM,
+void DRIVER_LAUNCH_BOUNDS intDriver (const int NUM,
                 const double t,
                 const double t_end,
                 const double * __restrict__ pr_global,
@@ -34,13 +34,157 @@ void intDriver (const int NUM,
                 const mechanism_memory * __restrict__ d_mem,
                 const solver_memory * __restrict__ s_mem)
 {
+#ifdef WARP_LU
+    warp_lu_init();
+#endif
+#ifdef WARP_IVP
+    // each group of WARP_IVP_SIZE threads integrates the IVP of its slot, @see warp_ivp.cuh
+    if (IVP_ID < NUM)
+    {
+        // call integrator for one time step
+        integrate (t, t_end, pr_global[IVP_ID], d_mem->y, d_mem, s_mem);
+    }
+#else
     if (T_ID < NUM)
     {
         // call integrator for one time step
         integrate (t, t_end, pr_global[T_ID], d_mem->y, d_mem, s_mem);
     }
+#endif
 } // end intDriver
 
+/**
+ * \brief Generic driver for the GPU integrators, with per-IVP integration intervals (local time stepping)
+ * \param[in]       NUM             The (non-padded) number of IVPs to integrate
+ * \param[in]       t_local         The (NUM) current times of the IVPs
+ * \param[in]       t_end_local     The (NUM) integration end times of the IVPs
+ * \param[in]       pr_global       The system constant variable (pressures / densities)
+ * \param[in,out]   y_global        The system state vectors at their times `t_local`.  Returns system state vectors at their times `t_end_local`
+ * \param[in]       d_mem           The mechanism_memory struct that contains the pre-allocated memory for the RHS \ Jacobian evaluation
+ * \param[in]       s_mem           The solver_memory struct that contains the pre-allocated memory for the solver
+ */
+ __global__
+void DRIVER_LAUNCH_BOUNDS intDriverLocal (const int NUM,
+                const double * __restrict__ t_local,
+                const double * __restrict__ t_end_local,
+                const double * __restrict__ pr_global,
+                double * __restrict__ y_global,
+                const mechanism_memory * __restrict__ d_mem,
+                const solver_memory * __restrict__ s_mem)
+{
+#ifdef WARP_LU
+    warp_lu_init();
+#endif
+#ifdef WARP_IVP
+    if (IVP_ID < NUM)
+    {
+        integrate (t_local[IVP_ID], t_end_local[IVP_ID], pr_global[IVP_ID], d_mem->y, d_mem, s_mem);
+    }
+#else
+    if (T_ID < NUM)
+    {
+        integrate (t_local[T_ID], t_end_local[T_ID], pr_global[T_ID], d_mem->y, d_mem, s_mem);
+    }
+#endif
+} // end intDriverLocal
+
+#ifdef MANAGED_MEMORY
+/**
+ * \brief Driver for the GPU integrators on (managed) state vectors in the host layout
+ * \param[in]       NUM             The (non-padded) number of IVPs to integrate
+ * \param[in]       ld              The leading dimension of `y_global`, i.e. `y_global[tid + i * ld]`
+ * \param[in]       t               The current system time
+ * \param[in]       t_end           The IVP integration end time
+ * \param[in]       pr_global       The system constant variable (pressures / densities)
+ * \param[in,out]   y_global        The system state vectors at time t.  Returns system state vectors at time t_end
+ * \param[in]       d_mem           The mechanism_memory struct that contains the pre-allocated memory for the RHS \ Jacobian evaluation
+ * \param[in]       s_mem           The solver_memory struct that contains the pre-allocated memory for the solver
+ *
+ * Each thread loads its state vector from (and stores it back to) `y_global` in place,
+ * such that the state vectors need not be repacked to the padded layout of the mechanism_memory.
+ */
+ __global__
+void DRIVER_LAUNCH_BOUNDS intDriverManaged (const int NUM,
+                const int ld,
+                const double t,
+                const double t_end,
+                const double * __restrict__ pr_global,
+                double * __restrict__ y_global,
+                const mechanism_memory * __restrict__ d_mem,
+                const solver_memory * __restrict__ s_mem)
+{
+#ifdef WARP_LU
+    warp_lu_init();
+#endif
+    if (T_ID < NUM)
+    {
+        double * const __restrict__ y = d_mem->y;
+        for (int i = 0; i < NSP; ++i)
+            y[INDEX(i)] = y_global[T_ID + i * ld];
+
+        // call integrator for one time step
+        integrate (t, t_end, pr_global[T_ID], y, d_mem, s_mem);
+
+        for (int i = 0; i < NSP; ++i)
+            y_global[T_ID + i * ld] = y[INDEX(i)];
+    }
+} // end intDriverManaged
+#endif
+
+#ifdef PERSISTENT_KERNEL
+/**
+ * \brief Persistent driver for the GPU integrators
+ * \param[in]       t               The current system time
+ * \param[in]       t_end           The IVP integration end time
+ * \param[in,out]   queue           The work queue of IVPs, the state vectors at time t.  Returns the state vectors at time t_end
+ * \param[in]       d_mem           The mechanism_memory struct that contains the pre-allocated memory for the RHS \ Jacobian evaluation
+ * \param[in]       s_mem           The solver_memory struct that contains the pre-allocated memory for the solver
+ *
+ * Each thread owns one slot (`T_ID`) of the solver and mechanism memory.  After finishing an IVP, the thread
+ * atomically pulls the next unsolved IVP from the queue into its slot, until all IVPs are solved.
+ * Hence the grid need only cover the threads that are resident on the device at once.
+ */
+ __global__
+void DRIVER_LAUNCH_BOUNDS intDriverPersistent (const double t,
+                          const double t_end,
+                          const ivp_queue queue,
+                          const mechanism_memory * __restrict__ d_mem,
+                          const solver_memory * __restrict__ s_mem)
+{
+#ifdef WARP_LU
+    warp_lu_init();
+#endif
+    double * const __restrict__ y = d_mem->y;
+    const int num = queue.num;
+    for (int ivp = atomicAdd(queue.next, 1); ivp < num; ivp = atomicAdd(queue.next, 1))
+    {
+        // load the IVP into the slot of this thread
+        for (int i = 0; i < NSP; ++i)
+            y[INDEX(i)] = queue.y[ivp + i * num];
+#ifdef SOLVER_WARM_START
+        for (int k = 0; k < WARM_SIZE; ++k)
+            s_mem->warm[INDEX(k)] = queue.warm[ivp + k * num];
+#endif
+
+        // call integrator for one time step
+        integrate (t, t_end, queue.var[ivp], y, d_mem, s_mem);
+
+        // and store the results
+        for (int i = 0; i < NSP; ++i)
+            queue.y[ivp + i * num] = y[INDEX(i)];
+        queue.result[ivp] = s_mem->result[T_ID];
+#ifdef STATISTICS
+        for (int k = 0; k < NUM_STATS; ++k)
+            queue.stats[ivp + k * num] = s_mem->stats[INDEX(k)];
+#endif
+#ifdef SOLVER_WARM_START
+        for (int k = 0; k < WARM_SIZE; ++k)
+            queue.warm[ivp + k * num] = s_mem->warm[INDEX(k)];
+#endif
+    }
+} // end intDriverPersistent
+#endif
+
 #ifdef GENERATE_DOCS
  }
 #endif
\ No newline at end of file
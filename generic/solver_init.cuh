@@ -13,6 +13,7 @@
 
  #include "solver_props.cuh"
  #include "header.cuh"
+ #include "gpu_arena.cuh"
 
  #ifdef GENERATE_DOCS
  namespace genericcu{
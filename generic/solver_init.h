@@ -17,8 +17,18 @@
 
  void init_solver_log();
  void solver_log();
- void initialize_solver(int num_threads);
- void cleanup_solver(int num_threads);
+ /**
+  * \brief Allocates the integrator memory of a solver instance
+  * \param[in]       num_threads     The number of OpenMP threads of the instance
+  * \return                          The per-thread integrator memory, or NULL if the solver keeps none
+  */
+ void* initialize_solver(int num_threads);
+ /**
+  * \brief Frees the integrator memory returned by initialize_solver
+  * \param[in]       num_threads     The number of OpenMP threads of the instance
+  * \param[in]       memory          The integrator memory
+  */
+ void cleanup_solver(int num_threads, void* memory);
  const char* solver_name();
 
  #ifdef GENERATE_DOCS
@@ -9,49 +9,535 @@
  */
 
 #include "solver_interface.h"
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #ifdef GENERATE_DOCS
 namespace generic {
 #endif
 
+//! The instance driven by the (non-reentrant) accelerInt_initialize / accelerInt_integrate API
+static accelerInt_context default_context;
+
 /**
  * \brief Initializes the solver
  * \param[in]       num_threads         The number of OpenMP threads to use
  *
+ * This (and the other non-context functions) drive a single, process-wide instance.
+ * @see accelerInt_create for independent instances.
  */
 void accelerInt_initialize(int num_threads) {
-    initialize_solver(num_threads);
+    initialize_context(&default_context, num_threads);
+}
+
+
+/**
+ * \brief Creates an independent solver instance
+ * \param[in]       num_threads         The number of OpenMP threads to use
+ * \return                              The instance, free with accelerInt_destroy
+ *
+ * The instance owns its integrator memory and per-IVP host storage, hence separate instances
+ * may be created, integrated and destroyed concurrently from different host threads
+ * (each of which drives its own OpenMP team).
+ */
+accelerInt_context* accelerInt_create(int num_threads) {
+    accelerInt_context* context = (accelerInt_context*)malloc(sizeof(accelerInt_context));
+    initialize_context(context, num_threads);
+    return context;
+}
+
+
+/**
+ * \brief Integrates NUM IVPs of `context` from `t_start` to `t_end` in global steps of `stepsize`, @see accelerInt_context_integrate
+ */
+static void integrate_steps(accelerInt_context* context, const int NUM, const double t_start, const double t_end,
+                            const double stepsize, double * __restrict__ y_host, const double * __restrict__ var_host)
+{
+    double t = t_start;
+    double step = stepsize < 0 ? t_end - t : stepsize;
+    double t_next = fmin(t_end, t + step);
+    int numSteps = 0;
+    reset_statistics(&context->stats, NUM);
+#ifdef FAILURE_RETRY
+    reset_failures(&context->failures, NUM);
+#endif
+    reset_phase_profile(context->num_threads);
+
+    // time integration loop
+    while (t + EPS < t_end)
+    {
+        numSteps++;
+        intDriver(context, NUM, t, t_next, var_host, y_host);
+        t = t_next;
+        t_next = fmin(t_end, t_start + (numSteps + 1) * step);
+    }
 }
 
 
 /**
  * \brief integrate NUM odes from time `t` to time `t_end`, using stepsizes of `t_step`
  *
+ * \param[in,out]       context         The solver instance
  * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
  * \param[in]           t_start         The system time
  * \param[in]           t_end           The end time
  * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
- * \param[in,out]       y_host          The state vectors to integrate.
+ * \param[in,out]       y_host          The state vectors to integrate, in the layout of the drivers, @see state_layout.h
  * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
  *
+ * If #ISAT is defined, the IVPs are first retrieved from the table of the instance, @see isat.h.
+ * The IVPs are then integrated without the table if per-IVP tolerance scales or event requests are set.
+ */
+void accelerInt_context_integrate(accelerInt_context* context, const int NUM, const double t_start, const double t_end,
+                                  const double stepsize, double * __restrict__ y_host, const double * __restrict__ var_host)
+{
+#ifdef ISAT
+    // the per-IVP tolerance scales and event requests are indexed by IVP, hence not tabulated
+    int tabulate = context->tol_scale == NULL;
+#ifdef EVENT_DRIVER
+    tabulate = tabulate && context->events == NULL;
+#endif
+    if (tabulate)
+    {
+        isat_batch* batch = &context->isat_work;
+        const int num_miss = isat_query(context->isat, batch, NUM, t_end - t_start, y_host, var_host,
+                                        context->num_threads);
+        integrate_steps(context, num_miss, t_start, t_end, stepsize, batch->y, batch->var);
+#ifdef FAILURE_RETRY
+        const int* codes = context->failures.code;
+#else
+        const int* codes = NULL;
+#endif
+        isat_update(context->isat, batch, NUM, t_end - t_start, y_host, codes, context->num_threads);
+        return;
+    }
+#endif
+    integrate_steps(context, NUM, t_start, t_end, stepsize, y_host, var_host);
+}
+
+
+/**
+ * \brief integrate NUM odes from time `t` to time `t_end`, using stepsizes of `t_step`
+ *
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           t_start         The system time
+ * \param[in]           t_end           The end time
+ * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
+ * \param[in,out]       y_host          The state vectors to integrate, in the layout of the drivers, @see state_layout.h
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * @see accelerInt_context_integrate
  */
 void accelerInt_integrate(const int NUM, const double t_start, const double t_end, const double stepsize,
                           double * __restrict__ y_host, const double * __restrict__ var_host)
 {
-    double t = t_start;
-    double step = stepsize < 0 ? t_end - t : stepsize;
-    double t_next = fmin(end_time, t + step);
-    int numSteps = 0;
+    accelerInt_context_integrate(&default_context, NUM, t_start, t_end, stepsize, y_host, var_host);
+}
 
-    // time integration loop
-    while (t + EPS < t_end)
+
+/**
+ * \brief integrate NUM odes, each from its own time `t_start[i]` to its own time `t_end[i]` (local time stepping)
+ *
+ * \param[in,out]       context         The solver instance
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           t_start         The (NUM) start times of the IVPs
+ * \param[in]           t_end           The (NUM) end times of the IVPs, `t_end[i] >= t_start[i]`
+ * \param[in,out]       y_host          The state vectors to integrate, in the layout of the drivers, @see state_layout.h
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * The IVPs are integrated in a single pass of intDriverLocal, hence never synchronize at common
+ * time steps (the caller may batch the IVPs of similar horizons, e.g. the cells of a time level).
+ * The ISAT table (if #ISAT is defined) is not used, as its entries are tabulated for a common interval.
+ */
+void accelerInt_context_integrate_local(accelerInt_context* context, const int NUM, const double * __restrict__ t_start,
+                                        const double * __restrict__ t_end, double * __restrict__ y_host,
+                                        const double * __restrict__ var_host)
+{
+    reset_statistics(&context->stats, NUM);
+#ifdef FAILURE_RETRY
+    reset_failures(&context->failures, NUM);
+#endif
+    reset_phase_profile(context->num_threads);
+    intDriverLocal(context, NUM, t_start, t_end, var_host, y_host);
+}
+
+
+/**
+ * \brief integrate NUM odes, each from its own time `t_start[i]` to its own time `t_end[i]` (local time stepping)
+ *
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           t_start         The (NUM) start times of the IVPs
+ * \param[in]           t_end           The (NUM) end times of the IVPs, `t_end[i] >= t_start[i]`
+ * \param[in,out]       y_host          The state vectors to integrate, in the layout of the drivers, @see state_layout.h
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * @see accelerInt_context_integrate_local
+ */
+void accelerInt_integrate_local(const int NUM, const double * __restrict__ t_start, const double * __restrict__ t_end,
+                                double * __restrict__ y_host, const double * __restrict__ var_host)
+{
+    accelerInt_context_integrate_local(&default_context, NUM, t_start, t_end, y_host, var_host);
+}
+
+
+/**
+ * \brief Returns the number of doubles of the `y_host` arrays of NUM IVPs, including the padding of the blocked layout
+ *
+ * `NUM * NSP`, unless #STATE_BLOCK is defined, @see state_layout.h
+ */
+size_t accelerInt_state_size(const int NUM) {
+    return state_size(NUM);
+}
+
+
+/**
+ * \brief Converts the column-major state vectors `y` (`y[tid + i * NUM]`) to the layout of `y_host`
+ *
+ * \param[in]           NUM             The number of IVPs
+ * \param[in]           y               The (NUM * NSP) column-major state vectors
+ * \param[out]          y_host          The (accelerInt_state_size) state vectors in the layout of the drivers
+ *
+ * A copy unless #STATE_BLOCK is defined, @see block_states
+ */
+void accelerInt_block_states(const int NUM, const double* y, double* y_host) {
+    block_states(NUM, y, y_host, default_context.num_threads > 0 ? default_context.num_threads : 1);
+}
+
+
+/**
+ * \brief Converts the state vectors `y_host` to column-major `y` (`y[tid + i * NUM]`)
+ *
+ * \param[in]           NUM             The number of IVPs
+ * \param[in]           y_host          The (accelerInt_state_size) state vectors in the layout of the drivers
+ * \param[out]          y               The (NUM * NSP) column-major state vectors
+ *
+ * A copy unless #STATE_BLOCK is defined, @see unblock_states
+ */
+void accelerInt_unblock_states(const int NUM, const double* y_host, double* y) {
+    unblock_states(NUM, y_host, y, default_context.num_threads > 0 ? default_context.num_threads : 1);
+}
+
+
+/**
+ * \brief The instance and integration interval of a stream, @see accelerInt_context_integrate_stream
+ */
+typedef struct
+{
+    accelerInt_context* context;
+    double t_start;
+    double t_end;
+    double stepsize;
+} stream_call;
+
+/**
+ * \brief Integrates a chunk of the stream described by the stream_call `arg`
+ */
+static void integrate_stream_chunk(void* arg, const int num, double* y, const double* var)
+{
+    const stream_call* call = (const stream_call*)arg;
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+    // the chunks hold unrelated IVPs, hence each starts cold
+    cleanup_warm_start(&call->context->warm);
+#endif
+#ifdef STATE_BLOCK
+    // the chunks are exchanged with the producer and consumer column-major
+    const int num_threads = call->context->num_threads;
+    double* y_blocked = (double*)malloc(state_size(num) * sizeof(double));
+    block_states(num, y, y_blocked, num_threads);
+    accelerInt_context_integrate(call->context, num, call->t_start, call->t_end, call->stepsize, y_blocked, var);
+    unblock_states(num, y_blocked, y, num_threads);
+    free(y_blocked);
+#else
+    accelerInt_context_integrate(call->context, num, call->t_start, call->t_end, call->stepsize, y, var);
+#endif
+}
+
+
+/**
+ * \brief integrate a stream of IVPs from time `t_start` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * \param[in,out]       context         The solver instance
+ * \param[in]           chunk_size      The (maximum) number of IVPs integrated at once
+ * \param[in]           t_start         The system time
+ * \param[in]           t_end           The end time
+ * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
+ * \param[in]           producer        Fills the next chunk of IVPs, until it returns zero
+ * \param[in]           consumer        Receives each integrated chunk
+ * \param[in]           user            Passed to `producer` and `consumer`
+ * \return                              The number of IVPs integrated
+ *
+ * The IVPs never need to be held in memory at once: the producer is called from a reader thread and the consumer
+ * from a writer thread, while each chunk is integrated by accelerInt_context_integrate (with the OpenMP threads
+ * of the instance), @see ivp_stream.h.  The statistics and failures of the instance refer to the last chunk.
+ * Per-IVP tolerance scales and event requests are indexed by IVP, hence cannot be combined with a stream.
+ */
+long accelerInt_context_integrate_stream(accelerInt_context* context, const int chunk_size, const double t_start,
+                                         const double t_end, const double stepsize, accelerInt_producer producer,
+                                         accelerInt_consumer consumer, void* user)
+{
+    int indexed = context->tol_scale != NULL;
+#ifdef EVENT_DRIVER
+    indexed = indexed || context->events != NULL;
+#endif
+    if (indexed)
     {
-        numSteps++;
-        intDriver(NUM, t, t_end, var_host, y_host);
-        t = t_next;
-        t_next = fmin(t_end, (numSteps + 1) * step);
+        printf("Error: per-IVP tolerance scales and event requests cannot be used with a stream of IVPs.\n");
+        exit(-1);
     }
+    stream_call call = {context, t_start, t_end, stepsize};
+    return run_ivp_stream(chunk_size, producer, consumer, user, integrate_stream_chunk, &call);
+}
+
+
+/**
+ * \brief integrate a stream of IVPs from time `t_start` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * @see accelerInt_context_integrate_stream
+ */
+long accelerInt_integrate_stream(const int chunk_size, const double t_start, const double t_end, const double stepsize,
+                                 accelerInt_producer producer, accelerInt_consumer consumer, void* user)
+{
+    return accelerInt_context_integrate_stream(&default_context, chunk_size, t_start, t_end, stepsize,
+                                               producer, consumer, user);
+}
+
+
+/**
+ * \brief Sets the integration tolerances used by subsequent calls to accelerInt_context_integrate of `context`
+ *
+ * \param[in,out]       context         The solver instance
+ * \param[in]           atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]           rtol            The relative tolerance
+ * \param[in]           atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ *
+ * The program exits if any tolerance is negative, or the relative tolerance is not positive.
+ */
+void accelerInt_context_set_tolerances(accelerInt_context* context, const double atol, const double rtol,
+                                       const double* atol_vector) {
+    set_tolerances(&context->tol, atol, rtol, atol_vector);
+}
+
+
+/**
+ * \brief Sets the integration tolerances used by subsequent calls to accelerInt_integrate
+ *
+ * \param[in]           atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]           rtol            The relative tolerance
+ * \param[in]           atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ */
+void accelerInt_set_tolerances(const double atol, const double rtol, const double* atol_vector) {
+    accelerInt_context_set_tolerances(&default_context, atol, rtol, atol_vector);
+}
+
+
+/**
+ * \brief Sets per-IVP factors that scale both tolerances of each IVP of `context`
+ *
+ * \param[in,out]       context         The solver instance
+ * \param[in]           scale           The (NUM) factors indexed by IVP, or NULL to use the same tolerances for all IVPs.
+ *                                      The array is not copied, and must remain valid while integrating.
+ */
+void accelerInt_context_set_tolerance_scale(accelerInt_context* context, const double* scale) {
+    context->tol_scale = scale;
+}
+
+
+/**
+ * \brief Sets per-IVP factors that scale both tolerances of each IVP in subsequent calls to accelerInt_integrate
+ *
+ * \param[in]           scale           The (NUM) factors indexed by IVP, or NULL to use the same tolerances for all IVPs.
+ */
+void accelerInt_set_tolerance_scale(const double* scale) {
+    accelerInt_context_set_tolerance_scale(&default_context, scale);
+}
+
+
+/**
+ * \brief Pins the OpenMP threads of subsequent calls to accelerInt_context_integrate (from the calling thread) to single CPUs
+ *
+ * \param[in,out]       context         The solver instance
+ * \param[in]           cpus            The CPU of each thread (thread `k` is pinned to `cpus[k % num_cpus]`),
+ *                                      or NULL to pin thread `k` to the `k`-th CPU the process may run on
+ * \param[in]           num_cpus        The number of entries in `cpus`
+ * \return                              Zero on success, otherwise the number of threads that could not be pinned
+ *
+ * If #NUMA_FIRST_TOUCH is defined, the per-thread integrator memory is then recreated by the pinned threads,
+ * such that it is placed on their NUMA nodes.  Pass the state vectors of accelerInt_context_integrate in
+ * arrays first touched by the pinned threads as well, e.g. allocated by allocate_ivp_array.  @see numa_placement.h
+ */
+int accelerInt_context_set_affinity(accelerInt_context* context, const int* cpus, const int num_cpus) {
+    int failed = pin_threads(context->num_threads, cpus, num_cpus);
+#ifdef NUMA_FIRST_TOUCH
+    cleanup_solver(context->num_threads, context->solver);
+    context->solver = initialize_solver(context->num_threads);
+#endif
+    return failed;
+}
+
+
+/**
+ * \brief Pins the OpenMP threads of subsequent calls to accelerInt_integrate (from the calling thread) to single CPUs
+ *
+ * \param[in]           cpus            The CPU of each thread (thread `k` is pinned to `cpus[k % num_cpus]`),
+ *                                      or NULL to pin thread `k` to the `k`-th CPU the process may run on
+ * \param[in]           num_cpus        The number of entries in `cpus`
+ * \return                              Zero on success, otherwise the number of threads that could not be pinned
+ */
+int accelerInt_set_affinity(const int* cpus, const int num_cpus) {
+    return accelerInt_context_set_affinity(&default_context, cpus, num_cpus);
+}
+
+
+/**
+ * \brief Returns the per-IVP integrator statistics of the last call to accelerInt_context_integrate of `context`
+ *
+ * \param[in]           context         The solver instance
+ * \param[in]           NUM             The number of ODEs integrated in the last call to accelerInt_context_integrate
+ * \param[out]          stats           The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`.
+ *                                      @see StatisticIndex.  All entries are zero if #STATISTICS is not defined.
+ */
+void accelerInt_context_get_statistics(const accelerInt_context* context, const int NUM, int* stats) {
+    get_statistics(&context->stats, NUM, stats);
+}
+
+
+/**
+ * \brief Returns the per-IVP integrator statistics of the last call to accelerInt_integrate
+ *
+ * \param[in]           NUM             The number of ODEs integrated in the last call to accelerInt_integrate
+ * \param[out]          stats           The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`.
+ *                                      @see StatisticIndex.  All entries are zero if #STATISTICS is not defined.
+ */
+void accelerInt_get_statistics(const int NUM, int* stats) {
+    accelerInt_context_get_statistics(&default_context, NUM, stats);
+}
+
+
+/**
+ * \brief Returns the per-IVP failures of the last call to accelerInt_context_integrate of `context`
+ *
+ * \param[in]           context         The solver instance
+ * \param[in]           NUM             The number of ODEs integrated in the last call to accelerInt_context_integrate
+ * \param[out]          codes           The (NUM) error code of the last failed re-integration of each IVP, zero if none, or NULL
+ * \param[out]          counts          The number of failed integrations that were re-integrated, and of those that failed again, or NULL
+ * \return                              The number of failed re-integrations, i.e. `counts[1]`.
+ *                                      All zero if #FAILURE_RETRY is not defined (the program exits on a failure instead).
+ *
+ * IVPs whose re-integration failed are left at the start time of the failed global integration step.
+ */
+int accelerInt_context_get_failures(const accelerInt_context* context, const int NUM, int* codes, int* counts) {
+#ifdef FAILURE_RETRY
+    int local_counts[NUM_FAILURE_COUNTS];
+    get_failures(&context->failures, NUM, codes, local_counts);
+    if (counts != NULL)
+        memcpy(counts, local_counts, NUM_FAILURE_COUNTS * sizeof(int));
+    return local_counts[FAILURE_UNRECOVERED];
+#else
+    if (codes != NULL)
+        memset(codes, 0, NUM * sizeof(int));
+    if (counts != NULL)
+        memset(counts, 0, 2 * sizeof(int));
+    return 0;
+#endif
+}
+
+
+/**
+ * \brief Returns the per-IVP failures of the last call to accelerInt_integrate
+ *
+ * \param[in]           NUM             The number of ODEs integrated in the last call to accelerInt_integrate
+ * \param[out]          codes           The (NUM) error code of the last failed re-integration of each IVP, zero if none, or NULL
+ * \param[out]          counts          The number of failed integrations that were re-integrated, and of those that failed again, or NULL
+ * \return                              The number of failed re-integrations, i.e. `counts[1]`
+ */
+int accelerInt_get_failures(const int NUM, int* codes, int* counts) {
+    return accelerInt_context_get_failures(&default_context, NUM, codes, counts);
+}
+
+
+/**
+ * \brief Returns the per-phase profile of the last call to accelerInt_context_integrate of `context`
+ *
+ * \param[in]           context         The solver instance
+ * \param[out]          cycles          The (#NUM_PHASES) cycles spent in each phase, summed over all threads
+ * \param[out]          calls           The (#NUM_PHASES) number of calls of each phase, summed over all threads
+ *                                      @see PhaseIndex.  All entries are zero if #PROFILE_PHASES is not defined.
+ *
+ * The phase counters are thread-private, hence this must be called from the host thread that integrated.
+ */
+void accelerInt_context_get_phase_profile(const accelerInt_context* context, long long* cycles, long long* calls) {
+    get_phase_profile(context->num_threads, cycles, calls);
+}
+
+
+/**
+ * \brief Returns the per-phase profile of the last call to accelerInt_integrate
+ *
+ * \param[out]          cycles          The (#NUM_PHASES) cycles spent in each phase, summed over all threads
+ * \param[out]          calls           The (#NUM_PHASES) number of calls of each phase, summed over all threads
+ *                                      @see PhaseIndex.  All entries are zero if #PROFILE_PHASES is not defined.
+ */
+void accelerInt_get_phase_profile(long long* cycles, long long* calls) {
+    accelerInt_context_get_phase_profile(&default_context, cycles, calls);
+}
+
+
+/**
+ * \brief Returns the cumulative statistics of the ISAT table of `context`
+ *
+ * \param[in]           context         The solver instance
+ * \param[out]          stats           The (#NUM_ISAT_STATS) statistics, @see IsatStatisticIndex.
+ *                                      All entries are zero if #ISAT is not defined.
+ */
+void accelerInt_context_get_isat_statistics(const accelerInt_context* context, long* stats) {
+#ifdef ISAT
+    get_isat_statistics(context->isat, stats);
+#else
+    memset(stats, 0, NUM_ISAT_STATS * sizeof(long));
+#endif
+}
+
+
+/**
+ * \brief Returns the cumulative statistics of the ISAT table of accelerInt_integrate
+ *
+ * \param[out]          stats           The (#NUM_ISAT_STATS) statistics, @see IsatStatisticIndex.
+ *                                      All entries are zero if #ISAT is not defined.
+ */
+void accelerInt_get_isat_statistics(long* stats) {
+    accelerInt_context_get_isat_statistics(&default_context, stats);
+}
+
+
+/**
+ * \brief Shares the ISAT table of `source` with `context`, dropping the table of `context`
+ *
+ * \param[in,out]       context         The solver instance
+ * \param[in]           source          The solver instance whose table is shared
+ *
+ * The table is freed with the last instance sharing it.  Does nothing if #ISAT is not defined.
+ */
+void accelerInt_context_share_isat(accelerInt_context* context, accelerInt_context* source) {
+#ifdef ISAT
+    if (context->isat == source->isat)
+        return;
+    release_isat(context->isat);
+    context->isat = share_isat(source->isat);
+#endif
+}
+
+
+/**
+ * \brief Frees all memory of the solver instance
+ * \param[in]       context             The solver instance created by accelerInt_create
+ *
+ */
+void accelerInt_destroy(accelerInt_context* context) {
+    if (context == NULL)
+        return;
+    cleanup_context(context);
+    free(context);
 }
 
 
@@ -61,12 +547,11 @@ void accelerInt_integrate(const int NUM, const double t_start, const double t_en
  *
  */
 void accelerInt_cleanup(int num_threads) {
-    cleanup_solver(num_threads);
+    cleanup_context(&default_context);
 }
 
 
 
-
 #ifdef GENERATE_DOCS
 }
 #endif
\ No newline at end of file
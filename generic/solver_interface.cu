@@ -9,23 +9,110 @@
  */
 
 #include "solver_interface.cuh"
+#ifdef NVRTC
+#include "nvrtc_kernels.cuh"
+#endif
 
 #ifdef GENERATE_DOCS
 namespace genericcu {
 #endif
 
-//! Padded # of ODEs to solve
-int padded;
-//! The solver memory structs
-solver_memory* host_solver, *device_solver;
-//! The mechanism memory structs
-mechanism_memory* host_mech, *device_mech;
-//! block and grid sizes
-dim3 dimBlock, dimGrid;
-//! result flag
-int* result_flag;
-//! temorary storage
-double* y_temp;
+#ifdef CUDA_GRAPH
+/**
+ * \brief The captured upload / integration / download sequence of a chunk on one stream, @see replay_chunk
+ */
+typedef struct
+{
+    //! The chunk size the sequence was captured for (zero if not captured)
+    int num_cond;
+    cudaGraph_t graph;
+    cudaGraphExec_t exec;
+    //! The intDriver node, whose time arguments are updated before each replay
+    cudaGraphNode_t kernel;
+    //! The launch configuration of the intDriver node
+    cudaKernelNodeParams params;
+#ifdef DEVICE_REDUCE
+    //! The reduce_chunk node, whose time and ignition arguments are updated before each replay
+    cudaGraphNode_t reduce;
+    //! The launch configuration of the reduce_chunk node
+    cudaKernelNodeParams reduce_params;
+#endif
+} step_graph;
+#endif
+
+/**
+ * \brief The state of a GPU solver instance, @see accelerInt_create
+ *
+ * All device memory, pinned staging buffers, streams and host state of an instance
+ * are kept here, such that independent instances never share (mutable) memory.
+ */
+struct accelerInt_context {
+    //! Padded # of ODEs to solve (per stream)
+    int padded;
+    //! The solver memory structs (one set per stream)
+    solver_memory* host_solver[NUM_STREAMS], *device_solver[NUM_STREAMS];
+    //! The mechanism memory structs (one set per stream)
+    mechanism_memory* host_mech[NUM_STREAMS], *device_mech[NUM_STREAMS];
+    //! block and grid sizes
+    dim3 dimBlock, dimGrid;
+    //! result flag (pinned, one per stream)
+    int* result_flag[NUM_STREAMS];
+    //! temorary storage (pinned, one per stream)
+    double* y_temp[NUM_STREAMS];
+    //! pinned staging for the constant parameter (one per stream)
+    double* var_temp[NUM_STREAMS];
+#ifdef STATISTICS
+    //! pinned staging for the per-IVP statistics (one per stream)
+    int* stats_temp[NUM_STREAMS];
+#endif
+#ifdef SOLVER_WARM_START
+    //! pinned staging for the per-IVP warm start state (one per stream)
+    double* warm_temp[NUM_STREAMS];
+#endif
+    //! pinned staging for the per-IVP start and end times of accelerInt_context_integrate_local (one per stream, NULL until used)
+    double* times_temp[NUM_STREAMS];
+    //! the device per-IVP start and end times, stored as `times[ivp]` and `times[padded + ivp]` (one per stream)
+    double* device_times[NUM_STREAMS];
+    //! The CUDA streams used to pipeline the chunks
+    cudaStream_t streams[NUM_STREAMS];
+    //! The IVP offset of the chunk currently in flight on each stream
+    int chunk_offset[NUM_STREAMS];
+    //! The size of the chunk currently in flight on each stream (zero if idle)
+    int chunk_size[NUM_STREAMS];
+#ifdef DEVICE_REDUCE
+    //! The summary of the chunk in flight on each stream, @see device_reduce.cuh
+    chunk_reduction reduction[NUM_STREAMS];
+    //! The ignition state of the IVPs (if #IGN is defined)
+    ignition_state ignition;
+#endif
+#ifdef CUDA_GRAPH
+    //! The captured sequences of each stream, for full (accelerInt_context::padded) and partial chunks
+    step_graph graphs[NUM_STREAMS][2];
+#endif
+    //! The number of IVPs currently resident on the device, @see accelerInt_context_set_state
+    int resident_num;
+    //! The per-device shards, used if initialized via accelerInt_create_multi
+    device_shard shards[MAX_DEVICES];
+    //! The number of device shards (zero if a single device is used)
+    int num_shards;
+    //! True if the memory sets of a single device are allocated, @see accelerInt_create
+    bool initialized;
+    //! The CUDA device of the memory sets of a single device
+    int device;
+#ifdef GPU_ARENA
+    //! The device memory arena of the memory sets of a single device
+    gpu_arena arena;
+#endif
+#ifdef NVRTC
+    //! The runtime compiled kernels of a single device, @see nvrtc_kernels.cuh
+    jit_kernels jit;
+#endif
+    //! The host statistics, warm start state, reordering buffers and phase totals
+    host_state state;
+};
+
+//! The instance driven by the (non-reentrant) accelerInt_initialize / accelerInt_integrate API
+static accelerInt_context default_context;
 
 /**
  * \brief A convienience method to copy memory between host pointers of different pitches, widths and heights.
@@ -81,12 +168,334 @@ inline void memcpy2D_out(double* dst, const int pitch_dst, double const * src, c
 
 
 /**
- * \brief Initializes the solver
- * \param[in]       NUM         The number of ODEs to integrate
- * \param[in]       device      The CUDA device number, if < 0 set to the first available GPU
+ * \brief Waits for the chunk in flight on stream `s` (if any) to complete,
+ *        checks the result codes, accumulates the statistics and stores the warm start state (if enabled)
+ *        and unpacks the state vectors into `y_host`
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           s               The stream index
+ * \param[in]           NUM             The number of ODEs being integrated (leading dimension of `y_host`)
+ * \param[in,out]       y_host          The state vectors to unpack into
  */
-void accelerInt_initialize(int NUM, int device) {
+inline void retire_chunk(accelerInt_context* ctx, const int s, const int NUM, double * __restrict__ y_host)
+{
+    if (ctx->chunk_size[s] <= 0)
+        return;
+    cudaErrorCheck( cudaStreamSynchronize(ctx->streams[s]) );
+#ifdef DEVICE_REDUCE
+    finish_chunk_reduction(&ctx->reduction[s], ctx->chunk_size[s], ctx->host_solver[s]->result, ctx->result_flag[s],
+                           &ctx->ignition);
+#else
+    check_error(ctx->chunk_size[s], ctx->result_flag[s]);
+#endif
+#ifdef STATISTICS
+    accumulate_statistics(&ctx->state.stats, ctx->chunk_offset[s], ctx->chunk_size[s], ctx->padded, ctx->stats_temp[s]);
+#endif
+#ifdef SOLVER_WARM_START
+    store_warm_start(&ctx->state.warm, ctx->chunk_offset[s], ctx->chunk_size[s], ctx->padded, ctx->warm_temp[s]);
+#endif
+    memcpy2D_out(y_host, NUM, ctx->y_temp[s], ctx->padded,
+                    ctx->chunk_offset[s], ctx->chunk_size[s] * sizeof(double), NSP);
+    ctx->chunk_size[s] = 0;
+}
+
+
+/**
+ * \brief Issues the upload of the staged chunk of `num_cond` IVPs on stream `s`, its integration from `t` to
+ *        `t_next` and the download of its results (into the staging buffers)
+ *
+ * \param[in]           ctx             The solver instance
+ * \param[in]           s               The stream index
+ * \param[in]           num_cond        The number of IVPs in the chunk
+ * \param[in]           offset          The index of the first IVP of the chunk
+ * \param[in]           t               The chunk start time
+ * \param[in]           t_next          The chunk end time
+ * \param[in]           local           If true, the IVPs are integrated over their staged per-IVP times
+ *                                      (accelerInt_context::times_temp) instead, by intDriverLocal
+ *
+ * If #DEVICE_REDUCE is defined, the result codes are reduced on the device, and only their summary is
+ * copied back (the ignition is not detected for per-IVP times), @see enqueue_chunk_reduction
+ *
+ * If the batched factorization is used, the integration kernel is relaunched (synchronizing the stream) until
+ * no IVP is suspended at a factorization, @see batched_lu_factor
+ */
+inline void enqueue_chunk(const accelerInt_context* ctx, const int s, const int num_cond, const int offset,
+                          const double t, const double t_next, const bool local)
+{
+    const int padded = ctx->padded;
+    // transfer memory to GPU
+    cudaErrorCheck( cudaMemcpyAsync (ctx->host_mech[s]->var, ctx->var_temp[s],
+                                     num_cond * sizeof(double), cudaMemcpyHostToDevice,
+                                     ctx->streams[s]) );
+    cudaErrorCheck( cudaMemcpy2DAsync (ctx->host_mech[s]->y, padded * sizeof(double),
+                                       ctx->y_temp[s], padded * sizeof(double),
+                                       num_cond * sizeof(double), NSP,
+                                       cudaMemcpyHostToDevice, ctx->streams[s]) );
+#ifdef SOLVER_WARM_START
+    cudaErrorCheck( cudaMemcpy2DAsync (ctx->host_solver[s]->warm, padded * sizeof(double),
+                                       ctx->warm_temp[s], padded * sizeof(double),
+                                       num_cond * sizeof(double), WARM_SIZE,
+                                       cudaMemcpyHostToDevice, ctx->streams[s]) );
+#endif
+    if (local)
+        cudaErrorCheck( cudaMemcpy2DAsync (ctx->device_times[s], padded * sizeof(double),
+                                           ctx->times_temp[s], padded * sizeof(double),
+                                           num_cond * sizeof(double), 2,
+                                           cudaMemcpyHostToDevice, ctx->streams[s]) );
+#ifdef BATCHED_LU
+    // relaunched until no IVP is suspended at a (batched) factorization, @see batched_lu.cuh
+    batched_lu_begin(&ctx->host_solver[s]->batched, ctx->streams[s]);
+    do {
+#endif
+    if (local)
+    {
+#ifdef NVRTC
+        launch_jit_driver_local(&ctx->jit, ctx->dimGrid, ctx->dimBlock, SHARED_SIZE + SOLVER_SHARED_SIZE, ctx->streams[s],
+                                num_cond, ctx->device_times[s], &ctx->device_times[s][padded],
+                                ctx->host_mech[s]->var, ctx->host_mech[s]->y, ctx->device_mech[s], ctx->device_solver[s]);
+#else
+        intDriverLocal <<< ctx->dimGrid, ctx->dimBlock, SHARED_SIZE + SOLVER_SHARED_SIZE, ctx->streams[s] >>> (num_cond,
+                                                                   ctx->device_times[s], &ctx->device_times[s][padded],
+                                                                   ctx->host_mech[s]->var, ctx->host_mech[s]->y,
+                                                                   ctx->device_mech[s], ctx->device_solver[s]);
+#endif
+    }
+    else
+#ifdef NVRTC
+        launch_jit_driver(&ctx->jit, ctx->dimGrid, ctx->dimBlock, SHARED_SIZE + SOLVER_SHARED_SIZE, ctx->streams[s],
+                          num_cond, t, t_next, ctx->host_mech[s]->var, ctx->host_mech[s]->y,
+                          ctx->device_mech[s], ctx->device_solver[s]);
+#else
+        intDriver <<< ctx->dimGrid, ctx->dimBlock, SHARED_SIZE + SOLVER_SHARED_SIZE, ctx->streams[s] >>> (num_cond, t, t_next, ctx->host_mech[s]->var,
+                                                                   ctx->host_mech[s]->y, ctx->device_mech[s], ctx->device_solver[s]);
+#endif
+#ifdef BATCHED_LU
+    } while (batched_lu_factor(&ctx->host_solver[s]->batched, ctx->streams[s]));
+#endif
+#ifdef DEVICE_REDUCE
+    enqueue_chunk_reduction(&ctx->reduction[s], num_cond, ctx->host_solver[s]->result, ctx->host_mech[s]->y, offset,
+                            t_next, local ? NULL : &ctx->ignition, ctx->streams[s]);
+#else
+    // copy the result flag back
+    cudaErrorCheck( cudaMemcpyAsync(ctx->result_flag[s], ctx->host_solver[s]->result, num_cond * sizeof(int),
+                                    cudaMemcpyDeviceToHost, ctx->streams[s]) );
+#endif
+    // transfer memory back to CPU
+    cudaErrorCheck( cudaMemcpy2DAsync (ctx->y_temp[s], padded * sizeof(double),
+                                       ctx->host_mech[s]->y, padded * sizeof(double),
+                                       num_cond * sizeof(double), NSP,
+                                       cudaMemcpyDeviceToHost, ctx->streams[s]) );
+#ifdef STATISTICS
+    // and the statistics
+    cudaErrorCheck( cudaMemcpy2DAsync (ctx->stats_temp[s], padded * sizeof(int),
+                                       ctx->host_solver[s]->stats, padded * sizeof(int),
+                                       num_cond * sizeof(int), NUM_STATS,
+                                       cudaMemcpyDeviceToHost, ctx->streams[s]) );
+#endif
+#ifdef SOLVER_WARM_START
+    // and the warm start state
+    cudaErrorCheck( cudaMemcpy2DAsync (ctx->warm_temp[s], padded * sizeof(double),
+                                       ctx->host_solver[s]->warm, padded * sizeof(double),
+                                       num_cond * sizeof(double), WARM_SIZE,
+                                       cudaMemcpyDeviceToHost, ctx->streams[s]) );
+#endif
+}
+
+#ifdef CUDA_GRAPH
+/**
+ * \brief Frees the captured sequence `g`, if any
+ */
+inline void release_step_graph(step_graph* g)
+{
+    if (g->num_cond <= 0)
+        return;
+    cudaErrorCheck( cudaGraphExecDestroy(g->exec) );
+    cudaErrorCheck( cudaGraphDestroy(g->graph) );
+    g->num_cond = 0;
+}
+
+/**
+ * \brief Captures the enqueue_chunk sequence of `num_cond` IVPs on stream `s` into `g`
+ *
+ * \param[in]           ctx             The solver instance
+ * \param[in]           s               The stream index
+ * \param[in]           num_cond        The number of IVPs in the chunk
+ * \param[in,out]       g               The graph to (re-)capture
+ *
+ * The capture is thread-local, such that instances driven from other host threads are unaffected.
+ */
+static void capture_step_graph(const accelerInt_context* ctx, const int s, const int num_cond, step_graph* g)
+{
+    release_step_graph(g);
+    cudaErrorCheck( cudaStreamBeginCapture(ctx->streams[s], cudaStreamCaptureModeThreadLocal) );
+    // the times are placeholders, set on each replay
+    enqueue_chunk(ctx, s, num_cond, 0, 0, 0, false);
+    cudaErrorCheck( cudaStreamEndCapture(ctx->streams[s], &g->graph) );
+
+    // find the intDriver (and reduce_chunk) node
+    size_t num_nodes = 0;
+    cudaErrorCheck( cudaGraphGetNodes(g->graph, NULL, &num_nodes) );
+    cudaGraphNode_t* nodes = (cudaGraphNode_t*)malloc(num_nodes * sizeof(cudaGraphNode_t));
+    cudaErrorCheck( cudaGraphGetNodes(g->graph, nodes, &num_nodes) );
+    g->kernel = NULL;
+#ifdef DEVICE_REDUCE
+    g->reduce = NULL;
+#endif
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        cudaGraphNodeType type;
+        cudaErrorCheck( cudaGraphNodeGetType(nodes[i], &type) );
+        if (type != cudaGraphNodeTypeKernel)
+            continue;
+        cudaKernelNodeParams params;
+        cudaErrorCheck( cudaGraphKernelNodeGetParams(nodes[i], &params) );
+        if (params.func == (void*)intDriver)
+        {
+            g->kernel = nodes[i];
+            g->params = params;
+        }
+#ifdef DEVICE_REDUCE
+        else if (params.func == (void*)reduce_chunk)
+        {
+            g->reduce = nodes[i];
+            g->reduce_params = params;
+        }
+#endif
+    }
+    free(nodes);
+    if (g->kernel == NULL)
+    {
+        printf("Error: the captured integration step has no kernel node.\n");
+        exit(-1);
+    }
+    cudaErrorCheck( cudaGraphInstantiateWithFlags(&g->exec, g->graph, 0) );
+    g->num_cond = num_cond;
+}
+
+/**
+ * \brief enqueue_chunk as a single graph launch of the sequence captured for `num_cond` IVPs on stream `s`
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           s               The stream index
+ * \param[in]           num_cond        The number of IVPs in the chunk
+ * \param[in]           offset          The index of the first IVP of the chunk
+ * \param[in]           t               The chunk start time
+ * \param[in]           t_next          The chunk end time
+ *
+ * The sequence of full chunks is captured at initialization, and that of a partial chunk when first used
+ * (or when its size changes).  Only the time arguments of the kernel node (and the time and ignition
+ * arguments of the reduction node, if #DEVICE_REDUCE is defined) are updated between replays.
+ */
+inline void replay_chunk(accelerInt_context* ctx, const int s, int num_cond, const int offset, double t, double t_next)
+{
+    step_graph* g = &ctx->graphs[s][num_cond == ctx->padded ? 0 : 1];
+    if (g->num_cond != num_cond)
+        capture_step_graph(ctx, s, num_cond, g);
+
+    // the arguments of intDriver, @see enqueue_chunk
+    const double* var = ctx->host_mech[s]->var;
+    double* y = ctx->host_mech[s]->y;
+    const mechanism_memory* d_mem = ctx->device_mech[s];
+    const solver_memory* s_mem = ctx->device_solver[s];
+    void* args[] = {&num_cond, &t, &t_next, &var, &y, &d_mem, &s_mem};
+    cudaKernelNodeParams params = g->params;
+    params.kernelParams = args;
+    params.extra = NULL;
+    cudaErrorCheck( cudaGraphExecKernelNodeSetParams(g->exec, g->kernel, &params) );
+#ifdef DEVICE_REDUCE
+    // the arguments of reduce_chunk, @see enqueue_chunk_reduction
+    const int* result = ctx->host_solver[s]->result;
+    const bool detect = ctx->ignition.num > 0;
+    const double* T0 = detect ? &ctx->ignition.T0[offset] : NULL;
+    double* time = detect ? &ctx->ignition.time[offset] : NULL;
+    chunk_summary* summary = ctx->reduction[s].device;
+    void* reduce_args[] = {&num_cond, &result, &y, &t_next, &T0, &time, &summary};
+    cudaKernelNodeParams reduce_params = g->reduce_params;
+    reduce_params.kernelParams = reduce_args;
+    reduce_params.extra = NULL;
+    cudaErrorCheck( cudaGraphExecKernelNodeSetParams(g->exec, g->reduce, &reduce_params) );
+#endif
+    cudaErrorCheck( cudaGraphLaunch(g->exec, ctx->streams[s]) );
+}
+#endif
+
+
+/**
+ * \brief Frees the memory sets (or shards) of the previous initialization of `ctx`, if any,
+ *        but keeps the device arenas (if #GPU_ARENA is defined)
+ *
+ * \param[in,out]       ctx             The solver instance
+ */
+inline void release_memory(accelerInt_context* ctx)
+{
+    if (ctx->num_shards > 0)
+    {
+        release_shards(ctx->num_shards, ctx->shards);
+        ctx->num_shards = 0;
+    }
+    if (!ctx->initialized)
+        return;
+    cudaErrorCheck( cudaSetDevice(ctx->device) );
+#ifdef NVRTC
+    release_jit_kernels(&ctx->jit);
+#endif
+    for (int s = 0; s < NUM_STREAMS; ++s)
+    {
+#ifdef CUDA_GRAPH
+        release_step_graph(&ctx->graphs[s][0]);
+        release_step_graph(&ctx->graphs[s][1]);
+#endif
+        free_gpu_memory(&ctx->host_mech[s], &ctx->device_mech[s]);
+        cleanup_solver(&ctx->host_solver[s], &ctx->device_solver[s]);
+        cudaErrorCheck( cudaStreamDestroy(ctx->streams[s]) );
+        cudaErrorCheck( cudaFreeHost(ctx->y_temp[s]) );
+        cudaErrorCheck( cudaFreeHost(ctx->var_temp[s]) );
+        cudaErrorCheck( cudaFreeHost(ctx->result_flag[s]) );
+#ifdef DEVICE_REDUCE
+        free_chunk_reduction(&ctx->reduction[s]);
+#endif
+#ifdef STATISTICS
+        cudaErrorCheck( cudaFreeHost(ctx->stats_temp[s]) );
+#endif
+#ifdef SOLVER_WARM_START
+        cudaErrorCheck( cudaFreeHost(ctx->warm_temp[s]) );
+#endif
+        if (ctx->times_temp[s] != NULL)
+        {
+            cudaErrorCheck( cudaFreeHost(ctx->times_temp[s]) );
+            cudaErrorCheck( cudaFree(ctx->device_times[s]) );
+            ctx->times_temp[s] = NULL;
+            ctx->device_times[s] = NULL;
+        }
+        free(ctx->host_mech[s]);
+        free(ctx->host_solver[s]);
+    }
+#ifdef DEVICE_REDUCE
+    free_ignition(&ctx->ignition);
+#endif
+    ctx->resident_num = 0;
+    ctx->initialized = false;
+}
+
+
+/**
+ * \brief Initializes the memory sets of `ctx` on a single device
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           NUM             The number of ODEs to integrate
+ * \param[in]           device          The CUDA device number, if < 0 set to the first available GPU
+ * \param[in]           reset_device    If true (and #GPU_ARENA is not defined) the device is reset first
+ *
+ * @see accelerInt_initialize
+ */
+static void initialize_context(accelerInt_context* ctx, int NUM, int device, const bool reset_device)
+{
     device = device < 0 ? 0 : device;
+    release_memory(ctx);
+#if defined(PERSISTENT_KERNEL) || defined(MANAGED_MEMORY)
+    ctx->num_shards = initialize_shards(NUM, 1, &device, NULL, ctx->shards, reset_device);
+    return;
+#endif
 
     // set & initialize device using command line argument (if any)
     cudaDeviceProp devProp;
@@ -106,26 +515,36 @@ void accelerInt_initialize(int NUM, int device) {
         exit(1);
     }
     cudaErrorCheck (cudaGetDeviceProperties(&devProp, device));
+    ctx->device = device;
 
+#ifndef GPU_ARENA
     // reset device
-    cudaErrorCheck( cudaDeviceReset() );
+    if (reset_device)
+        cudaErrorCheck( cudaDeviceReset() );
+#endif
     cudaErrorCheck( cudaPeekAtLastError() );
     cudaErrorCheck( cudaDeviceSynchronize() );
 
     //bump up shared mem bank size
     cudaErrorCheck(cudaDeviceSetSharedMemConfig(cudaSharedMemBankSizeEightByte));
-    //and L1 size
-    cudaErrorCheck(cudaDeviceSetCacheConfig(cudaFuncCachePreferL1));
+    //and the L1 / shared memory split, see launch_config.cuh
+    cudaErrorCheck(cudaDeviceSetCacheConfig(CACHE_CONFIG));
 
     //get the memory sizes
     size_t size_per_thread = required_mechanism_size() + required_solver_size();
     size_t free_mem = 0;
     size_t total_mem = 0;
     cudaErrorCheck( cudaMemGetInfo (&free_mem, &total_mem) );
+#ifdef GPU_ARENA
+    // the arena of a previous initialization on this device is reused (or reallocated)
+    if (ctx->arena.base != NULL && ctx->arena.device == device)
+        free_mem += ctx->arena.capacity;
+#endif
 
-    //conservatively estimate the maximum allowable threads
+    //conservatively estimate the maximum allowable threads (per stream)
     int max_threads = int(floor(0.8 * ((double)free_mem) / ((double)size_per_thread)));
-    int padded = min(NUM, max_threads);
+    max_threads /= NUM_STREAMS;
+    int padded = min(int(ceil(NUM / float(NUM_STREAMS))), max_threads);
     //padded is next factor of block size up
     padded = int(ceil(padded / float(TARGET_BLOCK_SIZE)) * TARGET_BLOCK_SIZE);
     if (padded == 0)
@@ -133,23 +552,176 @@ void accelerInt_initialize(int NUM, int device) {
         printf("Mechanism is too large to fit into global CUDA memory... exiting.");
         exit(-1);
     }
+    ctx->padded = padded;
 
-    //initalize memory
-    initialize_gpu_memory(padded, &host_mech, &device_mech);
-    initialize_solver(padded, &host_solver, &device_solver);
+#ifdef GPU_ARENA
+    arena_reserve(&ctx->arena, NUM_STREAMS * arena_required_size(padded, size_per_thread));
+    arena_begin(&ctx->arena);
+#endif
+    for (int s = 0; s < NUM_STREAMS; ++s)
+    {
+        //initalize memory
+        ctx->host_solver[s] = (solver_memory*)malloc(sizeof(solver_memory));
+        ctx->host_mech[s] = (mechanism_memory*)malloc(sizeof(mechanism_memory));
+        initialize_gpu_memory(padded, &ctx->host_mech[s], &ctx->device_mech[s]);
+        initialize_solver(padded, &ctx->host_solver[s], &ctx->device_solver[s]);
+        //pinned local storage, required for asynchronous copies
+        cudaErrorCheck( cudaHostAlloc((void**)&ctx->result_flag[s], padded * sizeof(int), cudaHostAllocDefault) );
+#ifdef DEVICE_REDUCE
+        create_chunk_reduction(&ctx->reduction[s]);
+#endif
+        cudaErrorCheck( cudaHostAlloc((void**)&ctx->y_temp[s], padded * NSP * sizeof(double), cudaHostAllocDefault) );
+        cudaErrorCheck( cudaHostAlloc((void**)&ctx->var_temp[s], padded * sizeof(double), cudaHostAllocDefault) );
+#ifdef STATISTICS
+        cudaErrorCheck( cudaHostAlloc((void**)&ctx->stats_temp[s], padded * NUM_STATS * sizeof(int), cudaHostAllocDefault) );
+#endif
+#ifdef SOLVER_WARM_START
+        cudaErrorCheck( cudaHostAlloc((void**)&ctx->warm_temp[s], padded * WARM_SIZE * sizeof(double), cudaHostAllocDefault) );
+#endif
+        // non-blocking, such that the instance does not synchronize with the legacy stream of other instances
+        cudaErrorCheck( cudaStreamCreateWithFlags(&ctx->streams[s], cudaStreamNonBlocking) );
+        ctx->chunk_offset[s] = 0;
+        ctx->chunk_size[s] = 0;
+    }
+#ifdef GPU_ARENA
+    arena_end();
+#endif
+    ctx->initialized = true;
 
     //grid sizes
-    dimBlock = dim3(TARGET_BLOCK_SIZE, 1);
-    dimGrid = dim3(padded / TARGET_BLOCK_SIZE, 1 );
-    //local storage
-    result_flag = (int*)malloc(padded * sizeof(int));
-    y_temp = (double*)malloc(padded * NSP * sizeof(double));
+    ctx->dimBlock = dim3(TARGET_BLOCK_SIZE, 1);
+    ctx->dimGrid = dim3(padded * DRIVER_THREADS_PER_IVP / TARGET_BLOCK_SIZE, 1 );
+#ifdef NVRTC
+    // for the default tolerances, as restored by initialize_solver
+    set_jit_tolerances(&ctx->jit, ATOL, RTOL, NULL);
+    load_jit_kernels(&ctx->jit);
+#endif
+#ifdef CUDA_GRAPH
+    // capture the sequence of a full chunk on each stream up front, @see replay_chunk
+    for (int s = 0; s < NUM_STREAMS; ++s)
+        capture_step_graph(ctx, s, padded, &ctx->graphs[s][0]);
+#endif
+}
+
+
+/**
+ * \brief Frees all memory of `ctx`
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           reset_devices   If true (and #GPU_ARENA is not defined) the devices are reset afterwards
+ */
+static void cleanup_context(accelerInt_context* ctx, const bool reset_devices)
+{
+    cleanup_host_state(&ctx->state);
+#ifdef GPU_ARENA
+    // the device (and the memory of any other code on it) is left untouched
+    release_memory(ctx);
+    for (int d = 0; d < MAX_DEVICES; ++d)
+        arena_release(&ctx->shards[d].arena);
+    arena_release(&ctx->arena);
+#else
+    if (ctx->num_shards > 0 && reset_devices)
+    {
+        cleanup_shards(ctx->num_shards, ctx->shards);
+        ctx->num_shards = 0;
+        return;
+    }
+    release_memory(ctx);
+    if (reset_devices)
+        cudaErrorCheck( cudaDeviceReset() );
+#endif
+}
+
+
+/**
+ * \brief Initializes the solver
+ * \param[in]       NUM         The number of ODEs to integrate
+ * \param[in]       device      The CUDA device number, if < 0 set to the first available GPU
+ *
+ * If #NUM_STREAMS is greater than one, the available device memory is split between
+ * #NUM_STREAMS independent mechanism_memory / solver_memory sets, such that the
+ * upload, integration and download of consecutive chunks may overlap.
+ *
+ * If #PERSISTENT_KERNEL is defined, the device is instead driven as a single shard,
+ * whose persistent kernel pulls IVPs from a device work queue, @see integrate_shards
+ *
+ * If #MANAGED_MEMORY is defined, the device is likewise driven as a single shard, whose managed memory
+ * covers all NUM IVPs.  State vectors and parameters passed to the integration in managed memory
+ * (cudaMallocManaged) are then integrated in place, @see integrate_shards
+ *
+ * The memory of a previous initialization is freed.  If #GPU_ARENA is defined, the device is not reset,
+ * and all memory sets are carved out of a single device arena, which is kept (or resized) when
+ * re-initializing for a different `NUM`, @see gpu_arena.cuh
+ *
+ * If #NVRTC is defined, the integration kernels are compiled for the device (or loaded from the cubin cache)
+ * here, @see nvrtc_kernels.cuh
+ *
+ * This (and the other non-context functions) drive a single, process-wide instance.
+ * @see accelerInt_create for independent instances.
+ */
+void accelerInt_initialize(int NUM, int device) {
+    initialize_context(&default_context, NUM, device, true);
+}
+
+
+/**
+ * \brief Initializes the solver on multiple devices
+ * \param[in]       NUM         The number of ODEs to integrate
+ * \param[in]       num_devices The number of devices to use, if <= 0 all visible devices are used
+ * \param[in]       devices     The CUDA device numbers, if NULL devices 0 to `num_devices - 1` are used
+ * \param[in]       weights     The relative weights of the devices (e.g. to give faster devices larger shards),
+ *                              if NULL the IVPs are split evenly
+ *
+ * Subsequent calls to accelerInt_integrate split the IVPs into one contiguous shard per device.
+ * Each device is then driven concurrently by its own host thread.  @see initialize_shards
+ */
+void accelerInt_initialize_multi(int NUM, int num_devices, const int* devices, const double* weights) {
+    release_memory(&default_context);
+    default_context.num_shards = initialize_shards(NUM, num_devices, devices, weights,
+                                                   default_context.shards, true);
+}
+
+
+/**
+ * \brief Creates an independent solver instance on a single device
+ * \param[in]       NUM         The number of ODEs to integrate
+ * \param[in]       device      The CUDA device number, if < 0 set to the first available GPU
+ * \return                      The instance, free with accelerInt_destroy
+ *
+ * The instance owns its memory sets, pinned staging buffers, (non-blocking) streams and host state,
+ * hence separate instances may be created, integrated and destroyed concurrently from different host threads.
+ * Unlike accelerInt_initialize, the device is never reset.
+ */
+accelerInt_context* accelerInt_create(int NUM, int device)
+{
+    accelerInt_context* ctx = (accelerInt_context*)calloc(1, sizeof(accelerInt_context));
+    initialize_context(ctx, NUM, device, false);
+    return ctx;
+}
+
+
+/**
+ * \brief Creates an independent solver instance sharded over multiple devices
+ * \param[in]       NUM         The number of ODEs to integrate
+ * \param[in]       num_devices The number of devices to use, if <= 0 all visible devices are used
+ * \param[in]       devices     The CUDA device numbers, if NULL devices 0 to `num_devices - 1` are used
+ * \param[in]       weights     The relative weights of the devices, if NULL the IVPs are split evenly
+ * \return                      The instance, free with accelerInt_destroy
+ *
+ * @see accelerInt_initialize_multi, accelerInt_create
+ */
+accelerInt_context* accelerInt_create_multi(int NUM, int num_devices, const int* devices, const double* weights)
+{
+    accelerInt_context* ctx = (accelerInt_context*)calloc(1, sizeof(accelerInt_context));
+    ctx->num_shards = initialize_shards(NUM, num_devices, devices, weights, ctx->shards, false);
+    return ctx;
 }
 
 
 /**
  * \brief integrate NUM odes from time `t_start` to time `t_end`, using stepsizes of `stepsize`
  *
+ * \param[in,out]       ctx             The solver instance
  * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
  * \param[in]           t_start         The starting time
  * \param[in]           t_end           The end time
@@ -157,71 +729,816 @@ void accelerInt_initialize(int NUM, int device) {
  * \param[in,out]       y_host          The state vectors to integrate.
  * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
  *
+ * Chunks of (at most) accelerInt_context::padded IVPs are issued round-robin over the #NUM_STREAMS streams.
+ * Before a stream is reused, the previous chunk on that stream is retired, hence
+ * the host repacking and PCIe transfers of one chunk overlap with the integration of the others.
+ * If #WARP_REORDER is defined, the IVPs are sorted by a stiffness proxy before each step
+ * (and scattered back afterwards), @see warp_reorder_gather
+ * If the solver defines SOLVER_WARM_START, each IVP continues from the warm start state
+ * (e.g. the step size) of its previous step, @see warm_start.cuh
+ * If #CUDA_GRAPH is defined, the copies and kernel of each chunk are replayed as one captured graph, @see replay_chunk
  */
-void accelerInt_integrate(const int NUM, const double t_start, const double t_end, const double stepsize,
-                          double * __restrict__ y_host, const double * __restrict__ var_host)
+void accelerInt_context_integrate(accelerInt_context* ctx, const int NUM, const double t_start, const double t_end,
+                                  const double stepsize, double * __restrict__ y_host, const double * __restrict__ var_host)
 {
     double step = stepsize < 0 ? t_end - t_start : stepsize;
     double t = t_start;
-    double t_next = fmin(end_time, t + step);
+    double t_next = fmin(t_end, t + step);
     int numSteps = 0;
+    // the chunks overwrite the device memory sets, and with them any resident state
+    ctx->resident_num = 0;
+    reset_statistics(&ctx->state.stats, NUM);
+    reset_phase_profile(&ctx->state.profile);
+#ifdef SOLVER_WARM_START
+    resize_warm_start(&ctx->state.warm, NUM);
+#endif
+
+#if defined(DEVICE_REDUCE) && defined(IGN)
+    // the ignition is detected over each call
+    if (ctx->num_shards > 0)
+        reset_shard_ignition(ctx->num_shards, ctx->shards, y_host);
+    else
+    {
+        cudaErrorCheck( cudaSetDevice(ctx->device) );
+        reset_ignition(&ctx->ignition, NUM, y_host, ctx->streams[0]);
+    }
+#endif
 
+    if (ctx->num_shards > 0)
+    {
+        while (t + EPS < t_end)
+        {
+            numSteps++;
+#ifdef WARP_REORDER
+            double* y_step, *var_step;
+            warp_reorder_gather(&ctx->state, NUM, y_host, var_host, &y_step, &var_step);
+            integrate_shards(&ctx->state, ctx->num_shards, ctx->shards, NUM, t, t_next, y_step, var_step);
+            warp_reorder_scatter(&ctx->state, NUM, y_host);
+#else
+            integrate_shards(&ctx->state, ctx->num_shards, ctx->shards, NUM, t, t_next, y_host, var_host);
+#endif
+            t = t_next;
+            t_next = fmin(t_end, t_start + (numSteps + 1) * step);
+        }
+        return;
+    }
+
+    cudaErrorCheck( cudaSetDevice(ctx->device) );
+    const int padded = ctx->padded;
     // time integration loop
     while (t + EPS < t_end)
     {
         numSteps++;
+        RANGE_PUSH("integration step");
+#ifdef DEVICE_REDUCE
+        begin_ignition_step(&ctx->ignition);
+#endif
+#ifdef WARP_REORDER
+        // sort the IVPs by the stiffness proxy, such that the warps have similar work
+        double* y_step, *var_step;
+        warp_reorder_gather(&ctx->state, NUM, y_host, var_host, &y_step, &var_step);
+#else
+        double* y_step = y_host;
+        const double* var_step = var_host;
+#endif
         int num_solved = 0;
+        int s = 0;
         while (num_solved < NUM)
         {
-            int num_cond = min(NUM - num_solved, padded);
+            // the staging buffers of this stream are free once the previous chunk is retired
+            retire_chunk(ctx, s, NUM, y_step);
 
-            cudaErrorCheck( cudaMemcpy (host_mech->var, &var_host[num_solved],
-                                        num_cond * sizeof(double), cudaMemcpyHostToDevice));
+            int num_cond = min(NUM - num_solved, padded);
 
-             //copy our memory into y_temp
-            memcpy2D_in(y_temp, padded, y_host, NUM,
+            //copy our memory into the staging buffers
+            memcpy(ctx->var_temp[s], &var_step[num_solved], num_cond * sizeof(double));
+            memcpy2D_in(ctx->y_temp[s], padded, y_step, NUM,
                             num_solved, num_cond * sizeof(double), NSP);
-            // transfer memory to GPU
-            cudaErrorCheck( cudaMemcpy2D (host_mech->y, padded * sizeof(double),
-                                            y_temp, padded * sizeof(double),
-                                            num_cond * sizeof(double), NSP,
-                                            cudaMemcpyHostToDevice) );
-            intDriver <<< dimGrid, dimBlock, SHARED_SIZE >>> (num_cond, t, t_next, host_mech->var, host_mech->y, device_mech, device_solver);
+#ifdef SOLVER_WARM_START
+            load_warm_start(&ctx->state.warm, num_solved, num_cond, padded, ctx->warm_temp[s]);
+#endif
+#ifdef CUDA_GRAPH
+            replay_chunk(ctx, s, num_cond, num_solved, t, t_next);
+#else
+            enqueue_chunk(ctx, s, num_cond, num_solved, t, t_next, false);
+#endif
     #ifdef DEBUG
             cudaErrorCheck( cudaPeekAtLastError() );
-            cudaErrorCheck( cudaDeviceSynchronize() );
+            cudaErrorCheck( cudaStreamSynchronize(ctx->streams[s]) );
     #endif
-            // copy the result flag back
-            cudaErrorCheck( cudaMemcpy(result_flag, host_solver->result, num_cond * sizeof(int), cudaMemcpyDeviceToHost) );
-            check_error(num_cond, result_flag);
-            // transfer memory back to CPU
-            cudaErrorCheck( cudaMemcpy2D (y_temp, padded * sizeof(double),
-                                            host_mech->y, padded * sizeof(double),
-                                            num_cond * sizeof(double), NSP,
-                                            cudaMemcpyDeviceToHost) );
-            memcpy2D_out(y_host, NUM, y_temp, padded,
-                            num_solved, num_cond * sizeof(double), NSP);
+            ctx->chunk_offset[s] = num_solved;
+            ctx->chunk_size[s] = num_cond;
 
             num_solved += num_cond;
+            s = (s + 1) % NUM_STREAMS;
+        }
+        // drain the pipeline before the next global step
+        for (s = 0; s < NUM_STREAMS; ++s)
+            retire_chunk(ctx, s, NUM, y_step);
+#ifdef PROFILE_PHASES
+        for (s = 0; s < NUM_STREAMS; ++s)
+            accumulate_phase_profile(&ctx->state.profile, ctx->host_solver[s]->phases, padded, ctx->streams[s]);
+#endif
+        RANGE_POP();
+#ifdef WARP_REORDER
+        warp_reorder_scatter(&ctx->state, NUM, y_host);
+#endif
+        t = t_next;
+        t_next = fmin(t_end, t_start + (numSteps + 1) * step);
+    }
+}
+
+
+/**
+ * \brief integrate NUM odes from time `t_start` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           t_start         The starting time
+ * \param[in]           t_end           The end time
+ * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
+ * \param[in,out]       y_host          The state vectors to integrate.
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * @see accelerInt_context_integrate
+ */
+void accelerInt_integrate(const int NUM, const double t_start, const double t_end, const double stepsize,
+                          double * __restrict__ y_host, const double * __restrict__ var_host)
+{
+    accelerInt_context_integrate(&default_context, NUM, t_start, t_end, stepsize, y_host, var_host);
+}
+
 
+/**
+ * \brief integrate NUM odes, each from its own time `t_start[i]` to its own time `t_end[i]` (local time stepping)
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           t_start         The (NUM) start times of the IVPs
+ * \param[in]           t_end           The (NUM) end times of the IVPs, `t_end[i] >= t_start[i]`
+ * \param[in,out]       y_host          The state vectors to integrate.
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * The chunks are issued as in accelerInt_context_integrate, but each is integrated in a single launch of
+ * intDriverLocal over the per-IVP intervals, i.e. without synchronizing the IVPs at common time steps.
+ * The per-IVP time buffers are allocated on first use.  Only single device instances are supported,
+ * and the IVPs are not reordered (#WARP_REORDER) or replayed as graphs (#CUDA_GRAPH).
+ */
+void accelerInt_context_integrate_local(accelerInt_context* ctx, const int NUM, const double * __restrict__ t_start,
+                                        const double * __restrict__ t_end, double * __restrict__ y_host,
+                                        const double * __restrict__ var_host)
+{
+    if (ctx->num_shards > 0)
+    {
+        printf("Error: per-IVP integration times are not supported by multi-device, persistent or managed instances.\n");
+        exit(-1);
+    }
+    // the chunks overwrite the device memory sets, and with them any resident state
+    ctx->resident_num = 0;
+    reset_statistics(&ctx->state.stats, NUM);
+    reset_phase_profile(&ctx->state.profile);
+#ifdef SOLVER_WARM_START
+    resize_warm_start(&ctx->state.warm, NUM);
+#endif
+
+    cudaErrorCheck( cudaSetDevice(ctx->device) );
+    const int padded = ctx->padded;
+    for (int s = 0; s < NUM_STREAMS; ++s)
+    {
+        if (ctx->times_temp[s] != NULL)
+            continue;
+        cudaErrorCheck( cudaHostAlloc((void**)&ctx->times_temp[s], 2 * padded * sizeof(double), cudaHostAllocDefault) );
+        cudaErrorCheck( cudaMalloc((void**)&ctx->device_times[s], 2 * padded * sizeof(double)) );
+    }
+
+    RANGE_PUSH("local integration");
+    int num_solved = 0;
+    int s = 0;
+    while (num_solved < NUM)
+    {
+        retire_chunk(ctx, s, NUM, y_host);
+
+        int num_cond = min(NUM - num_solved, padded);
+
+        memcpy(ctx->var_temp[s], &var_host[num_solved], num_cond * sizeof(double));
+        memcpy2D_in(ctx->y_temp[s], padded, y_host, NUM,
+                        num_solved, num_cond * sizeof(double), NSP);
+        memcpy(ctx->times_temp[s], &t_start[num_solved], num_cond * sizeof(double));
+        memcpy(&ctx->times_temp[s][padded], &t_end[num_solved], num_cond * sizeof(double));
+#ifdef SOLVER_WARM_START
+        load_warm_start(&ctx->state.warm, num_solved, num_cond, padded, ctx->warm_temp[s]);
+#endif
+        enqueue_chunk(ctx, s, num_cond, num_solved, 0, 0, true);
+#ifdef DEBUG
+        cudaErrorCheck( cudaPeekAtLastError() );
+        cudaErrorCheck( cudaStreamSynchronize(ctx->streams[s]) );
+#endif
+        ctx->chunk_offset[s] = num_solved;
+        ctx->chunk_size[s] = num_cond;
+
+        num_solved += num_cond;
+        s = (s + 1) % NUM_STREAMS;
+    }
+    for (s = 0; s < NUM_STREAMS; ++s)
+        retire_chunk(ctx, s, NUM, y_host);
+#ifdef PROFILE_PHASES
+    for (s = 0; s < NUM_STREAMS; ++s)
+        accumulate_phase_profile(&ctx->state.profile, ctx->host_solver[s]->phases, padded, ctx->streams[s]);
+#endif
+    RANGE_POP();
+}
+
+
+/**
+ * \brief integrate NUM odes, each from its own time `t_start[i]` to its own time `t_end[i]` (local time stepping)
+ *
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           t_start         The (NUM) start times of the IVPs
+ * \param[in]           t_end           The (NUM) end times of the IVPs, `t_end[i] >= t_start[i]`
+ * \param[in,out]       y_host          The state vectors to integrate.
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * @see accelerInt_context_integrate_local
+ */
+void accelerInt_integrate_local(const int NUM, const double * __restrict__ t_start, const double * __restrict__ t_end,
+                                double * __restrict__ y_host, const double * __restrict__ var_host)
+{
+    accelerInt_context_integrate_local(&default_context, NUM, t_start, t_end, y_host, var_host);
+}
+
+
+/**
+ * \brief The instance and integration interval of a stream, @see accelerInt_context_integrate_stream
+ */
+typedef struct
+{
+    accelerInt_context* ctx;
+    double t_start;
+    double t_end;
+    double stepsize;
+} stream_call;
+
+/**
+ * \brief Integrates a chunk of the stream described by the stream_call `arg`
+ */
+static void integrate_stream_chunk(void* arg, const int num, double* y, const double* var)
+{
+    const stream_call* call = (const stream_call*)arg;
+#ifdef SOLVER_WARM_START
+    // the chunks hold unrelated IVPs, hence each starts cold
+    cleanup_warm_start(&call->ctx->state.warm);
+#endif
+    accelerInt_context_integrate(call->ctx, num, call->t_start, call->t_end, call->stepsize, y, var);
+}
+
+
+/**
+ * \brief integrate a stream of IVPs from time `t_start` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           chunk_size      The (maximum) number of IVPs integrated at once
+ * \param[in]           t_start         The starting time
+ * \param[in]           t_end           The end time
+ * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
+ * \param[in]           producer        Fills the next chunk of IVPs, until it returns zero
+ * \param[in]           consumer        Receives each integrated chunk
+ * \param[in]           user            Passed to `producer` and `consumer`
+ * \return                              The number of IVPs integrated
+ *
+ * The producer is called from a reader thread and the consumer from a writer thread, while each chunk is
+ * integrated by accelerInt_context_integrate, @see ivp_stream.h.  A chunk size of #NUM_STREAMS times the
+ * IVPs per stream (i.e. the `NUM` the instance was created for) keeps all streams of the instance busy.
+ * The statistics and phase profile of the instance refer to the last chunk.
+ */
+long accelerInt_context_integrate_stream(accelerInt_context* ctx, const int chunk_size, const double t_start,
+                                         const double t_end, const double stepsize, accelerInt_producer producer,
+                                         accelerInt_consumer consumer, void* user)
+{
+    stream_call call = {ctx, t_start, t_end, stepsize};
+    return run_ivp_stream(chunk_size, producer, consumer, user, integrate_stream_chunk, &call);
+}
+
+
+/**
+ * \brief integrate a stream of IVPs from time `t_start` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * @see accelerInt_context_integrate_stream
+ */
+long accelerInt_integrate_stream(const int chunk_size, const double t_start, const double t_end, const double stepsize,
+                                 accelerInt_producer producer, accelerInt_consumer consumer, void* user)
+{
+    return accelerInt_context_integrate_stream(&default_context, chunk_size, t_start, t_end, stepsize,
+                                               producer, consumer, user);
+}
+
+
+/**
+ * \brief Checks that `NUM` IVPs fit in the device memory sets allocated for `ctx`
+ *        such that they can be kept resident on the device between calls
+ *
+ * \param[in]           ctx             The solver instance
+ * \param[in]           NUM             The number of ODEs to keep resident
+ */
+inline void check_resident_size(const accelerInt_context* ctx, const int NUM)
+{
+    if (ctx->num_shards > 0)
+    {
+        printf("Error: device resident state is not supported when sharding over multiple devices, "
+               "or with the persistent kernel or managed memory.\n");
+        exit(-1);
+    }
+    if (NUM > NUM_STREAMS * ctx->padded)
+    {
+        printf("Error: %d IVPs cannot be kept resident on the device, at most %d fit in the "
+               "allocated memory.\n", NUM, NUM_STREAMS * ctx->padded);
+        exit(-1);
+    }
+}
+
+/**
+ * \brief Uploads NUM state vectors and parameters to the device, where they remain resident
+ *        for subsequent calls to accelerInt_context_integrate_resident and accelerInt_context_get_state
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           y_host          The state vectors to upload
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * The IVPs are split into chunks of (at most) accelerInt_context::padded IVPs, where chunk `s` is stored in the
+ * memory set of stream `s`.  Hence, NUM must not exceed #NUM_STREAMS * accelerInt_context::padded.
+ * If the solver defines SOLVER_WARM_START, the host warm start state of the IVPs is uploaded as well,
+ * and is subsequently kept on the device by accelerInt_context_integrate_resident.
+ * If #DEVICE_REDUCE and #IGN are defined, the ignition detection restarts from the uploaded temperatures.
+ * The resident state shares the memory sets with accelerInt_context_integrate (and the local and stream
+ * variants), hence is discarded by those, after which it must be uploaded again.
+ */
+void accelerInt_context_set_state(accelerInt_context* ctx, const int NUM, const double * __restrict__ y_host,
+                                  const double * __restrict__ var_host)
+{
+    check_resident_size(ctx, NUM);
+    cudaErrorCheck( cudaSetDevice(ctx->device) );
+#ifdef SOLVER_WARM_START
+    resize_warm_start(&ctx->state.warm, NUM);
+#endif
+    const int padded = ctx->padded;
+    int num_solved = 0;
+    for (int s = 0; s < NUM_STREAMS && num_solved < NUM; ++s)
+    {
+        int num_cond = min(NUM - num_solved, padded);
+        memcpy(ctx->var_temp[s], &var_host[num_solved], num_cond * sizeof(double));
+        memcpy2D_in(ctx->y_temp[s], padded, y_host, NUM,
+                        num_solved, num_cond * sizeof(double), NSP);
+        cudaErrorCheck( cudaMemcpyAsync (ctx->host_mech[s]->var, ctx->var_temp[s],
+                                         num_cond * sizeof(double), cudaMemcpyHostToDevice,
+                                         ctx->streams[s]) );
+        cudaErrorCheck( cudaMemcpy2DAsync (ctx->host_mech[s]->y, padded * sizeof(double),
+                                           ctx->y_temp[s], padded * sizeof(double),
+                                           num_cond * sizeof(double), NSP,
+                                           cudaMemcpyHostToDevice, ctx->streams[s]) );
+#ifdef SOLVER_WARM_START
+        load_warm_start(&ctx->state.warm, num_solved, num_cond, padded, ctx->warm_temp[s]);
+        cudaErrorCheck( cudaMemcpy2DAsync (ctx->host_solver[s]->warm, padded * sizeof(double),
+                                           ctx->warm_temp[s], padded * sizeof(double),
+                                           num_cond * sizeof(double), WARM_SIZE,
+                                           cudaMemcpyHostToDevice, ctx->streams[s]) );
+#endif
+        num_solved += num_cond;
+    }
+    for (int s = 0; s < NUM_STREAMS; ++s)
+        cudaErrorCheck( cudaStreamSynchronize(ctx->streams[s]) );
+#if defined(DEVICE_REDUCE) && defined(IGN)
+    // the ignition is detected from the uploaded state
+    reset_ignition(&ctx->ignition, NUM, y_host, ctx->streams[0]);
+#endif
+    ctx->resident_num = NUM;
+}
+
+/**
+ * \brief Uploads NUM state vectors and parameters to the device, where they remain resident
+ *        for subsequent calls to accelerInt_integrate_resident and accelerInt_get_state
+ *
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           y_host          The state vectors to upload
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * @see accelerInt_context_set_state
+ */
+void accelerInt_set_state(const int NUM, const double * __restrict__ y_host, const double * __restrict__ var_host)
+{
+    accelerInt_context_set_state(&default_context, NUM, y_host, var_host);
+}
+
+/**
+ * \brief integrate the device resident IVPs from time `t_start` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           t_start         The starting time
+ * \param[in]           t_end           The end time
+ * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
+ *
+ * The state vectors are neither uploaded nor downloaded, only the result codes are copied back
+ * to the host for error checking.  If #DEVICE_REDUCE is defined, only their summary (and the ignition
+ * totals) are copied back instead, @see accelerInt_context_get_ignition.
+ * @see accelerInt_context_set_state, accelerInt_context_get_state
+ */
+void accelerInt_context_integrate_resident(accelerInt_context* ctx, const double t_start, const double t_end,
+                                           const double stepsize)
+{
+    const int resident_num = ctx->resident_num;
+    if (resident_num <= 0)
+    {
+        printf("Error: no device resident state, call accelerInt_set_state first "
+               "(accelerInt_integrate and accelerInt_integrate_local discard the resident state).\n");
+        exit(-1);
+    }
+    cudaErrorCheck( cudaSetDevice(ctx->device) );
+    const int padded = ctx->padded;
+    double step = stepsize < 0 ? t_end - t_start : stepsize;
+    double t = t_start;
+    double t_next = fmin(t_end, t + step);
+    int numSteps = 0;
+    reset_statistics(&ctx->state.stats, resident_num);
+    reset_phase_profile(&ctx->state.profile);
+
+    // time integration loop
+    while (t + EPS < t_end)
+    {
+        numSteps++;
+#ifdef DEVICE_REDUCE
+        begin_ignition_step(&ctx->ignition);
+#endif
+        int num_solved = 0;
+        for (int s = 0; s < NUM_STREAMS && num_solved < resident_num; ++s)
+        {
+            int num_cond = min(resident_num - num_solved, padded);
+#ifdef BATCHED_LU
+            batched_lu_begin(&ctx->host_solver[s]->batched, ctx->streams[s]);
+            do {
+#endif
+#ifdef NVRTC
+            launch_jit_driver(&ctx->jit, ctx->dimGrid, ctx->dimBlock, SHARED_SIZE + SOLVER_SHARED_SIZE, ctx->streams[s],
+                              num_cond, t, t_next, ctx->host_mech[s]->var, ctx->host_mech[s]->y,
+                              ctx->device_mech[s], ctx->device_solver[s]);
+#else
+            intDriver <<< ctx->dimGrid, ctx->dimBlock, SHARED_SIZE + SOLVER_SHARED_SIZE, ctx->streams[s] >>> (num_cond, t, t_next, ctx->host_mech[s]->var,
+                                                                           ctx->host_mech[s]->y, ctx->device_mech[s], ctx->device_solver[s]);
+#endif
+#ifdef BATCHED_LU
+            } while (batched_lu_factor(&ctx->host_solver[s]->batched, ctx->streams[s]));
+#endif
+    #ifdef DEBUG
+            cudaErrorCheck( cudaPeekAtLastError() );
+            cudaErrorCheck( cudaStreamSynchronize(ctx->streams[s]) );
+    #endif
+#ifdef DEVICE_REDUCE
+            enqueue_chunk_reduction(&ctx->reduction[s], num_cond, ctx->host_solver[s]->result, ctx->host_mech[s]->y,
+                                    num_solved, t_next, &ctx->ignition, ctx->streams[s]);
+#else
+            cudaErrorCheck( cudaMemcpyAsync(ctx->result_flag[s], ctx->host_solver[s]->result, num_cond * sizeof(int),
+                                            cudaMemcpyDeviceToHost, ctx->streams[s]) );
+#endif
+#ifdef STATISTICS
+            cudaErrorCheck( cudaMemcpy2DAsync (ctx->stats_temp[s], padded * sizeof(int),
+                                               ctx->host_solver[s]->stats, padded * sizeof(int),
+                                               num_cond * sizeof(int), NUM_STATS,
+                                               cudaMemcpyDeviceToHost, ctx->streams[s]) );
+#endif
+            num_solved += num_cond;
+        }
+        num_solved = 0;
+        for (int s = 0; s < NUM_STREAMS && num_solved < resident_num; ++s)
+        {
+            int num_cond = min(resident_num - num_solved, padded);
+            cudaErrorCheck( cudaStreamSynchronize(ctx->streams[s]) );
+#ifdef DEVICE_REDUCE
+            finish_chunk_reduction(&ctx->reduction[s], num_cond, ctx->host_solver[s]->result, ctx->result_flag[s],
+                                   &ctx->ignition);
+#else
+            check_error(num_cond, ctx->result_flag[s]);
+#endif
+#ifdef STATISTICS
+            accumulate_statistics(&ctx->state.stats, num_solved, num_cond, padded, ctx->stats_temp[s]);
+#endif
+#ifdef PROFILE_PHASES
+            accumulate_phase_profile(&ctx->state.profile, ctx->host_solver[s]->phases, padded, ctx->streams[s]);
+#endif
+            num_solved += num_cond;
         }
         t = t_next;
-        t_next = fmin(t_end, (numSteps + 1) * step);
+        t_next = fmin(t_end, t_start + (numSteps + 1) * step);
+    }
+}
+
+/**
+ * \brief integrate the device resident IVPs from time `t_start` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * \param[in]           t_start         The starting time
+ * \param[in]           t_end           The end time
+ * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
+ *
+ * @see accelerInt_context_integrate_resident
+ */
+void accelerInt_integrate_resident(const double t_start, const double t_end, const double stepsize)
+{
+    accelerInt_context_integrate_resident(&default_context, t_start, t_end, stepsize);
+}
+
+/**
+ * \brief Downloads (a subset of) the device resident state vectors
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           NUM             The leading dimension of `y_host`, this must match the `NUM` passed to accelerInt_context_set_state
+ * \param[out]          y_host          The state vectors to download into, stored as in accelerInt_context_set_state
+ * \param[in]           num_indices     The number of entries in `indices`.  If `num_indices` <= 0 all IVPs are downloaded
+ * \param[in]           indices         The IVP indices to download, ignored if `num_indices` <= 0
+ *
+ * When only a subset of IVPs is requested, the remaining entries of `y_host` are left untouched.
+ */
+void accelerInt_context_get_state(accelerInt_context* ctx, const int NUM, double * __restrict__ y_host,
+                                  const int num_indices, const int * __restrict__ indices)
+{
+    if (NUM != ctx->resident_num)
+    {
+        printf("Error: requested the state of %d IVPs, but %d are resident on the device.\n",
+               NUM, ctx->resident_num);
+        exit(-1);
     }
+    cudaErrorCheck( cudaSetDevice(ctx->device) );
+    const int padded = ctx->padded;
+    if (num_indices <= 0)
+    {
+        int num_solved = 0;
+        for (int s = 0; s < NUM_STREAMS && num_solved < NUM; ++s)
+        {
+            int num_cond = min(NUM - num_solved, padded);
+            cudaErrorCheck( cudaMemcpy2DAsync (ctx->y_temp[s], padded * sizeof(double),
+                                               ctx->host_mech[s]->y, padded * sizeof(double),
+                                               num_cond * sizeof(double), NSP,
+                                               cudaMemcpyDeviceToHost, ctx->streams[s]) );
+            ctx->chunk_offset[s] = num_solved;
+            ctx->chunk_size[s] = num_cond;
+            num_solved += num_cond;
+        }
+        for (int s = 0; s < NUM_STREAMS; ++s)
+        {
+            if (ctx->chunk_size[s] <= 0)
+                continue;
+            cudaErrorCheck( cudaStreamSynchronize(ctx->streams[s]) );
+            memcpy2D_out(y_host, NUM, ctx->y_temp[s], padded,
+                            ctx->chunk_offset[s], ctx->chunk_size[s] * sizeof(double), NSP);
+            ctx->chunk_size[s] = 0;
+        }
+        return;
+    }
+    for (int i = 0; i < num_indices; ++i)
+    {
+        int index = indices[i];
+        if (index < 0 || index >= NUM)
+        {
+            printf("Error: IVP index %d out of range [0, %d).\n", index, NUM);
+            exit(-1);
+        }
+        // the state of a single IVP is a column of the chunk's state matrix
+        int s = index / padded;
+        cudaErrorCheck( cudaMemcpy2DAsync (&y_host[index], NUM * sizeof(double),
+                                           &ctx->host_mech[s]->y[index % padded], padded * sizeof(double),
+                                           sizeof(double), NSP, cudaMemcpyDeviceToHost, ctx->streams[s]) );
+    }
+    for (int s = 0; s < NUM_STREAMS; ++s)
+        cudaErrorCheck( cudaStreamSynchronize(ctx->streams[s]) );
+}
+
+/**
+ * \brief Downloads (a subset of) the device resident state vectors
+ *
+ * \param[in]           NUM             The leading dimension of `y_host`, this must match the `NUM` passed to accelerInt_set_state
+ * \param[out]          y_host          The state vectors to download into, stored as in accelerInt_set_state
+ * \param[in]           num_indices     The number of entries in `indices`.  If `num_indices` <= 0 all IVPs are downloaded
+ * \param[in]           indices         The IVP indices to download, ignored if `num_indices` <= 0
+ *
+ * @see accelerInt_context_get_state
+ */
+void accelerInt_get_state(const int NUM, double * __restrict__ y_host, const int num_indices,
+                          const int * __restrict__ indices)
+{
+    accelerInt_context_get_state(&default_context, NUM, y_host, num_indices, indices);
 }
 
 
+/**
+ * \brief Sets the integration tolerances of all memory sets (or shards) of `ctx`
+ *
+ * \param[in,out]       ctx             The solver instance
+ * \param[in]           atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]           rtol            The relative tolerance
+ * \param[in]           atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ *
+ * The tolerances apply to subsequent integration calls, re-initializing the instance restores the defaults.
+ * If #NVRTC is defined, the kernels of a single device are recompiled for the new tolerances, @see nvrtc_kernels.cuh
+ */
+void accelerInt_context_set_tolerances(accelerInt_context* ctx, const double atol, const double rtol,
+                                       const double* atol_vector)
+{
+    for (int d = 0; d < ctx->num_shards; ++d)
+    {
+        cudaErrorCheck( cudaSetDevice(ctx->shards[d].device) );
+        set_tolerances(ctx->shards[d].host_solver->tol, atol, rtol, atol_vector);
+    }
+    if (ctx->initialized)
+    {
+        cudaErrorCheck( cudaSetDevice(ctx->device) );
+        for (int s = 0; s < NUM_STREAMS; ++s)
+            set_tolerances(ctx->host_solver[s]->tol, atol, rtol, atol_vector);
+#ifdef NVRTC
+        // the kernels are recompiled (or loaded from the cache) for the new tolerances
+        set_jit_tolerances(&ctx->jit, atol, rtol, atol_vector);
+        load_jit_kernels(&ctx->jit);
+#endif
+    }
+}
+
+/**
+ * \brief Sets the integration tolerances used by subsequent integration calls
+ *
+ * \param[in]           atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]           rtol            The relative tolerance
+ * \param[in]           atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ */
+void accelerInt_set_tolerances(const double atol, const double rtol, const double* atol_vector)
+{
+    accelerInt_context_set_tolerances(&default_context, atol, rtol, atol_vector);
+}
+
+
+/**
+ * \brief Returns the per-IVP integrator statistics of the last call to accelerInt_context_integrate
+ *        (or accelerInt_context_integrate_resident) of `ctx`
+ *
+ * \param[in]           ctx             The solver instance
+ * \param[in]           NUM             The number of ODEs integrated in the last call
+ * \param[out]          stats           The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`.
+ *                                      @see StatisticIndex.  All entries are zero if #STATISTICS is not defined.
+ */
+void accelerInt_context_get_statistics(const accelerInt_context* ctx, const int NUM, int* stats)
+{
+    get_statistics(&ctx->state.stats, NUM, stats);
+}
+
+/**
+ * \brief Returns the per-IVP integrator statistics of the last call to accelerInt_integrate
+ *        (or accelerInt_integrate_resident)
+ *
+ * \param[in]           NUM             The number of ODEs integrated in the last call
+ * \param[out]          stats           The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`.
+ *                                      @see StatisticIndex.  All entries are zero if #STATISTICS is not defined.
+ */
+void accelerInt_get_statistics(const int NUM, int* stats)
+{
+    accelerInt_context_get_statistics(&default_context, NUM, stats);
+}
+
+
+/**
+ * \brief Returns the per-phase profile of the last call to accelerInt_context_integrate
+ *        (or accelerInt_context_integrate_resident) of `ctx`
+ *
+ * \param[in]           ctx             The solver instance
+ * \param[out]          cycles          The (#NUM_PHASES) device clock cycles spent in each phase, summed over all IVPs
+ * \param[out]          calls           The (#NUM_PHASES) number of calls of each phase, summed over all IVPs
+ *                                      @see PhaseIndex.  All entries are zero if #PROFILE_PHASES is not defined.
+ */
+void accelerInt_context_get_phase_profile(const accelerInt_context* ctx, long long* cycles, long long* calls)
+{
+    get_phase_profile(&ctx->state.profile, cycles, calls);
+}
+
+/**
+ * \brief Returns the per-phase profile of the last call to accelerInt_integrate
+ *        (or accelerInt_integrate_resident)
+ *
+ * \param[out]          cycles          The (#NUM_PHASES) device clock cycles spent in each phase, summed over all IVPs
+ * \param[out]          calls           The (#NUM_PHASES) number of calls of each phase, summed over all IVPs
+ *                                      @see PhaseIndex.  All entries are zero if #PROFILE_PHASES is not defined.
+ */
+void accelerInt_get_phase_profile(long long* cycles, long long* calls)
+{
+    accelerInt_context_get_phase_profile(&default_context, cycles, calls);
+}
+
+/**
+ * \brief Returns the device-detected ignition of the IVPs of the last call to accelerInt_context_integrate
+ *        (or since the last accelerInt_context_set_state) of `ctx`
+ *
+ * \param[in]           ctx             The solver instance
+ * \param[out]          num_ignited     The number of IVPs ignited by the end of the last global step
+ * \param[out]          max_T           The maximum temperature at the end of a global step of the call
+ * \param[out]          times           The (NUM) ignition times, negative if not ignited, or NULL
+ *
+ * The totals are returned with each step, while the times are downloaded here, @see device_reduce.cuh.
+ * All results are zero (and the times are left untouched) unless #DEVICE_REDUCE and #IGN are defined.
+ */
+void accelerInt_context_get_ignition(const accelerInt_context* ctx, int* num_ignited, double* max_T, double* times)
+{
+    *num_ignited = 0;
+    *max_T = 0;
+#if defined(DEVICE_REDUCE) && defined(IGN)
+    if (ctx->num_shards > 0)
+    {
+        get_shard_ignition(ctx->num_shards, ctx->shards, num_ignited, max_T, times);
+        return;
+    }
+    *num_ignited = ctx->ignition.num_ignited;
+    *max_T = ctx->ignition.max_T;
+    if (times != NULL && ctx->initialized)
+    {
+        cudaErrorCheck( cudaSetDevice(ctx->device) );
+        get_ignition_times(&ctx->ignition, times);
+    }
+#endif
+}
+
+/**
+ * \brief Returns the device-detected ignition of the IVPs of the last call to accelerInt_integrate
+ *        (or since the last accelerInt_set_state)
+ *
+ * \param[out]          num_ignited     The number of IVPs ignited by the end of the last global step
+ * \param[out]          max_T           The maximum temperature at the end of a global step of the call
+ * \param[out]          times           The (NUM) ignition times, negative if not ignited, or NULL
+ *
+ * @see accelerInt_context_get_ignition
+ */
+void accelerInt_get_ignition(int* num_ignited, double* max_T, double* times)
+{
+    accelerInt_context_get_ignition(&default_context, num_ignited, max_T, times);
+}
+
+
+/**
+ * \brief Frees all memory of the solver instance, the device is not reset
+ *
+ * \param[in]           ctx             The solver instance created by accelerInt_create (or accelerInt_create_multi)
+ */
+void accelerInt_destroy(accelerInt_context* ctx)
+{
+    if (ctx == NULL)
+        return;
+    cleanup_context(ctx, false);
+    free(ctx);
+}
+
 /**
  * \brief Cleans up the solver
+ *
+ * If #GPU_ARENA is not defined, the devices are reset.
  */
 void accelerInt_cleanup() {
-    free_gpu_memory(&host_mech, &device_mech);
-    cleanup_solver(&host_solver, &device_solver);
-    free(y_temp);
-    free(host_mech);
-    free(host_solver);
-    free(result_flag);
-    cudaErrorCheck( cudaDeviceReset() );
+    cleanup_context(&default_context, true);
+}
+
+
+/**
+ * \brief Returns the device memory (in bytes) allocated for the mechanism_memory and solver_memory sets of `ctx`
+ *
+ * \param[in]           ctx             The solver instance
+ *
+ * If #GPU_ARENA is defined, this is the footprint of the device arenas (including any allocation that
+ * did not fit), otherwise the required size of the memory sets,
+ * @see required_mechanism_size, required_solver_size
+ */
+size_t accelerInt_context_device_memory(const accelerInt_context* ctx)
+{
+    size_t bytes = 0;
+#ifdef GPU_ARENA
+    for (int d = 0; d < MAX_DEVICES; ++d)
+        bytes += arena_footprint(&ctx->shards[d].arena);
+    bytes += arena_footprint(&ctx->arena);
+#else
+    size_t size_per_thread = required_mechanism_size() + required_solver_size();
+    for (int d = 0; d < ctx->num_shards; ++d)
+        bytes += ctx->shards[d].padded * size_per_thread;
+    if (ctx->initialized)
+        bytes += NUM_STREAMS * ctx->padded * size_per_thread;
+#endif
+    return bytes;
+}
+
+/**
+ * \brief Returns the device memory (in bytes) allocated for the mechanism_memory and solver_memory sets
+ *
+ * @see accelerInt_context_device_memory
+ */
+size_t accelerInt_device_memory()
+{
+    return accelerInt_context_device_memory(&default_context);
+}
+
+/**
+ * \brief Returns the device memory (in bytes) required per IVP
+ *
+ * @see required_mechanism_size, required_solver_size
+ */
+size_t accelerInt_ivp_memory()
+{
+    return required_mechanism_size() + required_solver_size();
 }
 
 
@@ -18,15 +18,33 @@
 #include "gpu_memory.cuh"
 #include "header.cuh"
 #include "solver_props.cuh"
+#include "multi_gpu.cuh"
+#include "host_state.cuh"
+#include "ivp_stream.h"
 #include <stdio.h>
 #include <float.h>
 
 #define EPS DBL_EPSILON
 
+#ifndef NUM_STREAMS
+//! The number of CUDA streams (and device memory sets) used to pipeline integration, see the CUDA_STREAMS SCons option
+#define NUM_STREAMS (1)
+#endif
+
 #ifdef GENERATE_DOCS
 namespace genericcu {
 #endif
 
+/**
+ * \brief An (opaque) independent solver instance
+ *
+ * The accelerInt_initialize / accelerInt_integrate functions drive a single, process-wide instance.
+ * Instances created by accelerInt_create (or accelerInt_create_multi) own their device memory, streams
+ * and host state instead, such that several (independently sized) instances may be used concurrently
+ * from different host threads.  A single instance must not be used by multiple threads at once.
+ */
+typedef struct accelerInt_context accelerInt_context;
+
 /**
  * \brief Initializes the solver
  * \param[in]       NUM         The number of ODEs to integrate
@@ -35,6 +53,15 @@ namespace genericcu {
 void accelerInt_initialize(int NUM, int device);
 
 
+/**
+ * \brief Initializes the solver on multiple devices
+ * \param[in]       NUM         The number of ODEs to integrate
+ * \param[in]       num_devices The number of devices to use, if <= 0 all visible devices are used
+ * \param[in]       devices     The CUDA device numbers, if NULL devices 0 to `num_devices - 1` are used
+ * \param[in]       weights     The relative weights of the devices, if NULL the IVPs are split evenly
+ */
+void accelerInt_initialize_multi(int NUM, int num_devices, const int* devices, const double* weights);
+
 /**
  * \brief integrate NUM odes from time `t_start` to time `t_end`, using stepsizes of `t_step`
  *
@@ -49,11 +76,218 @@ void accelerInt_initialize(int NUM, int device);
 void accelerInt_integrate(const int NUM, const double t_start, const double t_end, const double stepsize,
                           double * __restrict__ y_host, const double * __restrict__ var_host);
 
+/**
+ * \brief integrate NUM odes, each from its own time `t_start[i]` to its own time `t_end[i]` (local time stepping)
+ *
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           t_start         The (NUM) start times of the IVPs
+ * \param[in]           t_end           The (NUM) end times of the IVPs, `t_end[i] >= t_start[i]`
+ * \param[in,out]       y_host          The state vectors to integrate.
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * Unlike accelerInt_integrate, the IVPs are not synchronized at common time steps.
+ */
+void accelerInt_integrate_local(const int NUM, const double * __restrict__ t_start, const double * __restrict__ t_end,
+                                double * __restrict__ y_host, const double * __restrict__ var_host);
+
+/**
+ * \brief integrate a stream of IVPs (read by `producer`, and written by `consumer`) in chunks of
+ *        (at most) `chunk_size` IVPs, from time `t_start` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * \param[in]           chunk_size      The (maximum) number of IVPs integrated at once
+ * \param[in]           t_start         The system time
+ * \param[in]           t_end           The end time
+ * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
+ * \param[in]           producer        Fills the next chunk of IVPs, until it returns zero
+ * \param[in]           consumer        Receives each integrated chunk
+ * \param[in]           user            Passed to `producer` and `consumer`
+ * \return                              The number of IVPs integrated
+ *
+ * The memory used is bounded by the chunk size, @see ivp_stream.h
+ */
+long accelerInt_integrate_stream(const int chunk_size, const double t_start, const double t_end, const double stepsize,
+                                 accelerInt_producer producer, accelerInt_consumer consumer, void* user);
+
+/**
+ * \brief Uploads NUM state vectors and parameters to the device, where they remain resident
+ *        for subsequent calls to accelerInt_integrate_resident and accelerInt_get_state
+ *
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           y_host          The state vectors to upload
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * A subsequent accelerInt_integrate (or its local and stream variants) discards the resident state.
+ */
+void accelerInt_set_state(const int NUM, const double * __restrict__ y_host, const double * __restrict__ var_host);
+
+/**
+ * \brief integrate the device resident IVPs from time `t_start` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * \param[in]           t_start         The starting time
+ * \param[in]           t_end           The end time
+ * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
+ */
+void accelerInt_integrate_resident(const double t_start, const double t_end, const double stepsize);
+
+/**
+ * \brief Downloads (a subset of) the device resident state vectors
+ *
+ * \param[in]           NUM             The leading dimension of `y_host`, this must match the `NUM` passed to accelerInt_set_state
+ * \param[out]          y_host          The state vectors to download into
+ * \param[in]           num_indices     The number of entries in `indices`.  If `num_indices` <= 0 all IVPs are downloaded
+ * \param[in]           indices         The IVP indices to download, ignored if `num_indices` <= 0
+ */
+void accelerInt_get_state(const int NUM, double * __restrict__ y_host, const int num_indices,
+                          const int * __restrict__ indices);
+
+/**
+ * \brief Sets the integration tolerances used by subsequent integration calls
+ *
+ * \param[in]           atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]           rtol            The relative tolerance
+ * \param[in]           atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ *
+ * The #ATOL and #RTOL options are the defaults, which are restored by re-initialization.  @see tolerances.cuh
+ */
+void accelerInt_set_tolerances(const double atol, const double rtol, const double* atol_vector);
+
+/**
+ * \brief Returns the per-IVP integrator statistics of the last call to accelerInt_integrate
+ *        (or accelerInt_integrate_resident)
+ *
+ * \param[in]           NUM             The number of ODEs integrated in the last call
+ * \param[out]          stats           The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`.
+ *                                      @see StatisticIndex.  All entries are zero if #STATISTICS is not defined.
+ */
+void accelerInt_get_statistics(const int NUM, int* stats);
+
+/**
+ * \brief Returns the per-phase profile of the last call to accelerInt_integrate
+ *        (or accelerInt_integrate_resident)
+ *
+ * \param[out]          cycles          The (#NUM_PHASES) device clock cycles spent in each phase, summed over all IVPs
+ * \param[out]          calls           The (#NUM_PHASES) number of calls of each phase, summed over all IVPs
+ *                                      @see PhaseIndex.  All entries are zero if #PROFILE_PHASES is not defined.
+ */
+void accelerInt_get_phase_profile(long long* cycles, long long* calls);
+
+/**
+ * \brief Returns the device-detected ignition of the IVPs of the last call to accelerInt_integrate
+ *        (or since the last accelerInt_set_state)
+ *
+ * \param[out]          num_ignited     The number of IVPs ignited by the end of the last global step
+ * \param[out]          max_T           The maximum temperature at the end of a global step of the call
+ * \param[out]          times           The (NUM) ignition times, negative if not ignited, or NULL
+ *                                      All results are zero unless #DEVICE_REDUCE and #IGN are defined.
+ */
+void accelerInt_get_ignition(int* num_ignited, double* max_T, double* times);
+
 /**
  * \brief Cleans up the solver
  */
 void accelerInt_cleanup();
 
+/**
+ * \brief Returns the device memory (in bytes) allocated for the mechanism_memory and solver_memory sets
+ *
+ * If #GPU_ARENA is defined, this is the footprint of the device arenas (including any allocation that
+ * did not fit), otherwise the required size of the memory sets
+ */
+size_t accelerInt_device_memory();
+
+/**
+ * \brief Returns the device memory (in bytes) required per IVP, i.e. the sum of the mechanism_memory and the
+ *        (liveness aliased) solver_memory sizes, which determines the number of IVPs that fit on the device
+ */
+size_t accelerInt_ivp_memory();
+
+/**
+ * \brief Creates an independent solver instance on a single device, the device is never reset
+ * \param[in]       NUM         The number of ODEs to integrate
+ * \param[in]       device      The CUDA device number, if < 0 set to the first available GPU
+ * \return                      The instance, free with accelerInt_destroy
+ */
+accelerInt_context* accelerInt_create(int NUM, int device);
+
+/**
+ * \brief Creates an independent solver instance sharded over multiple devices, the devices are never reset
+ * \param[in]       NUM         The number of ODEs to integrate
+ * \param[in]       num_devices The number of devices to use, if <= 0 all visible devices are used
+ * \param[in]       devices     The CUDA device numbers, if NULL devices 0 to `num_devices - 1` are used
+ * \param[in]       weights     The relative weights of the devices, if NULL the IVPs are split evenly
+ * \return                      The instance, free with accelerInt_destroy
+ */
+accelerInt_context* accelerInt_create_multi(int NUM, int num_devices, const int* devices, const double* weights);
+
+/**
+ * \brief accelerInt_integrate on the instance `ctx`
+ */
+void accelerInt_context_integrate(accelerInt_context* ctx, const int NUM, const double t_start, const double t_end,
+                                  const double stepsize, double * __restrict__ y_host, const double * __restrict__ var_host);
+
+/**
+ * \brief accelerInt_integrate_local on the instance `ctx`
+ */
+void accelerInt_context_integrate_local(accelerInt_context* ctx, const int NUM, const double * __restrict__ t_start,
+                                        const double * __restrict__ t_end, double * __restrict__ y_host,
+                                        const double * __restrict__ var_host);
+
+/**
+ * \brief accelerInt_integrate_stream on the instance `ctx`
+ */
+long accelerInt_context_integrate_stream(accelerInt_context* ctx, const int chunk_size, const double t_start,
+                                         const double t_end, const double stepsize, accelerInt_producer producer,
+                                         accelerInt_consumer consumer, void* user);
+
+/**
+ * \brief accelerInt_set_state on the instance `ctx`
+ */
+void accelerInt_context_set_state(accelerInt_context* ctx, const int NUM, const double * __restrict__ y_host,
+                                  const double * __restrict__ var_host);
+
+/**
+ * \brief accelerInt_integrate_resident on the instance `ctx`
+ */
+void accelerInt_context_integrate_resident(accelerInt_context* ctx, const double t_start, const double t_end,
+                                           const double stepsize);
+
+/**
+ * \brief accelerInt_get_state on the instance `ctx`
+ */
+void accelerInt_context_get_state(accelerInt_context* ctx, const int NUM, double * __restrict__ y_host,
+                                  const int num_indices, const int * __restrict__ indices);
+
+/**
+ * \brief accelerInt_set_tolerances on the instance `ctx`
+ */
+void accelerInt_context_set_tolerances(accelerInt_context* ctx, const double atol, const double rtol,
+                                       const double* atol_vector);
+
+/**
+ * \brief accelerInt_get_statistics on the instance `ctx`
+ */
+void accelerInt_context_get_statistics(const accelerInt_context* ctx, const int NUM, int* stats);
+
+/**
+ * \brief accelerInt_get_phase_profile on the instance `ctx`
+ */
+void accelerInt_context_get_phase_profile(const accelerInt_context* ctx, long long* cycles, long long* calls);
+
+/**
+ * \brief accelerInt_get_ignition on the instance `ctx`
+ */
+void accelerInt_context_get_ignition(const accelerInt_context* ctx, int* num_ignited, double* max_T, double* times);
+
+/**
+ * \brief accelerInt_device_memory of the instance `ctx`
+ */
+size_t accelerInt_context_device_memory(const accelerInt_context* ctx);
+
+/**
+ * \brief Frees all memory of the instance `ctx`
+ */
+void accelerInt_destroy(accelerInt_context* ctx);
+
 
 
 
@@ -13,6 +13,12 @@
 
 #include "solver.h"
 #include "solver_init.h"
+#include "solver_context.h"
+#include "phase_profile.h"
+#include "numa_placement.h"
+#include "isat.h"
+#include "ivp_stream.h"
+#include "state_layout.h"
 #include <float.h>
 
 #define EPS DBL_EPSILON
@@ -36,13 +42,116 @@ void accelerInt_initialize(int num_threads);
  * \param[in]           t               The system time
  * \param[in]           t_end           The end time
  * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
- * \param[in,out]       y_host          The state vectors to integrate.
+ * \param[in,out]       y_host          The state vectors to integrate, in the layout of the drivers, @see state_layout.h
  * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
  *
  */
 void accelerInt_integrate(const int NUM, const double t, const double t_end, const double stepsize,
                           double * __restrict__ y_host, const double * __restrict__ var_host);
 
+/**
+ * \brief integrate NUM odes, each from its own time `t_start[i]` to its own time `t_end[i]` (local time stepping)
+ *
+ * \param[in]           NUM             The number of ODEs to integrate.  This should be the size of the leading dimension of `y_host` and `var_host`.  @see accelerint_indx
+ * \param[in]           t_start         The (NUM) start times of the IVPs
+ * \param[in]           t_end           The (NUM) end times of the IVPs, `t_end[i] >= t_start[i]`
+ * \param[in,out]       y_host          The state vectors to integrate, in the layout of the drivers, @see state_layout.h
+ * \param[in]           var_host        The parameters to use in dydt() and eval_jacob()
+ *
+ * Unlike accelerInt_integrate, the IVPs are not synchronized at common time steps.
+ */
+void accelerInt_integrate_local(const int NUM, const double * __restrict__ t_start, const double * __restrict__ t_end,
+                                double * __restrict__ y_host, const double * __restrict__ var_host);
+
+/**
+ * \brief Returns the number of doubles of the `y_host` arrays of NUM IVPs, including the padding of the blocked layout
+ */
+size_t accelerInt_state_size(const int NUM);
+
+/**
+ * \brief Converts the column-major state vectors `y` (`y[tid + i * NUM]`) to the layout of `y_host`, @see state_layout.h
+ */
+void accelerInt_block_states(const int NUM, const double* y, double* y_host);
+
+/**
+ * \brief Converts the state vectors `y_host` to column-major `y` (`y[tid + i * NUM]`), @see state_layout.h
+ */
+void accelerInt_unblock_states(const int NUM, const double* y_host, double* y);
+
+/**
+ * \brief integrate a stream of IVPs (read by `producer`, and written by `consumer`) in chunks of
+ *        (at most) `chunk_size` IVPs, from time `t` to time `t_end`, using stepsizes of `stepsize`
+ *
+ * \param[in]           chunk_size      The (maximum) number of IVPs integrated at once
+ * \param[in]           t               The system time
+ * \param[in]           t_end           The end time
+ * \param[in]           stepsize        The integration step size.  If `stepsize` < 0, the step size will be set to `t_end - t`
+ * \param[in]           producer        Fills the next chunk of IVPs, until it returns zero
+ * \param[in]           consumer        Receives each integrated chunk
+ * \param[in]           user            Passed to `producer` and `consumer`
+ * \return                              The number of IVPs integrated
+ *
+ * The memory used is bounded by the chunk size, @see ivp_stream.h
+ */
+long accelerInt_integrate_stream(const int chunk_size, const double t, const double t_end, const double stepsize,
+                                 accelerInt_producer producer, accelerInt_consumer consumer, void* user);
+
+/**
+ * \brief Sets the integration tolerances used by subsequent calls to accelerInt_integrate
+ *
+ * \param[in]           atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]           rtol            The relative tolerance
+ * \param[in]           atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ *
+ * The #ATOL and #RTOL options are the defaults, @see tolerances.h
+ */
+void accelerInt_set_tolerances(const double atol, const double rtol, const double* atol_vector);
+
+/**
+ * \brief Sets per-IVP factors that scale both tolerances of each IVP in subsequent calls to accelerInt_integrate
+ *
+ * \param[in]           scale           The (NUM) factors indexed by IVP, or NULL to use the same tolerances for all IVPs.
+ *                                      The array is not copied, and must remain valid while integrating.
+ */
+void accelerInt_set_tolerance_scale(const double* scale);
+
+/**
+ * \brief Returns the per-IVP integrator statistics of the last call to accelerInt_integrate
+ *
+ * \param[in]           NUM             The number of ODEs integrated in the last call to accelerInt_integrate
+ * \param[out]          stats           The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`.
+ *                                      @see StatisticIndex.  All entries are zero if #STATISTICS is not defined.
+ */
+void accelerInt_get_statistics(const int NUM, int* stats);
+
+/**
+ * \brief Returns the per-IVP failures of the last call to accelerInt_integrate
+ *
+ * \param[in]           NUM             The number of ODEs integrated in the last call to accelerInt_integrate
+ * \param[out]          codes           The (NUM) error code of the last failed re-integration of each IVP, zero if none, or NULL
+ * \param[out]          counts          The number of failed integrations that were re-integrated, and of those that failed again, or NULL
+ * \return                              The number of failed re-integrations, i.e. `counts[1]`.
+ *                                      All zero if #FAILURE_RETRY is not defined (the program exits on a failure instead).
+ */
+int accelerInt_get_failures(const int NUM, int* codes, int* counts);
+
+/**
+ * \brief Returns the per-phase profile of the last call to accelerInt_integrate
+ *
+ * \param[out]          cycles          The (#NUM_PHASES) cycles spent in each phase, summed over all threads
+ * \param[out]          calls           The (#NUM_PHASES) number of calls of each phase, summed over all threads
+ *                                      @see PhaseIndex.  All entries are zero if #PROFILE_PHASES is not defined.
+ */
+void accelerInt_get_phase_profile(long long* cycles, long long* calls);
+
+/**
+ * \brief Returns the cumulative statistics of the ISAT table of accelerInt_integrate
+ *
+ * \param[out]          stats           The (#NUM_ISAT_STATS) statistics, @see IsatStatisticIndex.
+ *                                      All entries are zero if #ISAT is not defined.
+ */
+void accelerInt_get_isat_statistics(long* stats);
+
 /**
  * \brief Cleans up the solver
  * \param[in]       num_threads         The number of OpenMP threads to use
@@ -50,6 +159,88 @@ void accelerInt_integrate(const int NUM, const double t, const double t_end, con
  */
 void accelerInt_cleanup(int num_threads);
 
+/**
+ * \brief Pins the OpenMP threads of subsequent calls to accelerInt_integrate (from the calling thread) to single CPUs
+ * \param[in]       cpus                The CPU of each thread (thread `k` is pinned to `cpus[k % num_cpus]`),
+ *                                      or NULL to pin thread `k` to the `k`-th CPU the process may run on
+ * \param[in]       num_cpus            The number of entries in `cpus`
+ * \return                              Zero on success, otherwise the number of threads that could not be pinned
+ */
+int accelerInt_set_affinity(const int* cpus, const int num_cpus);
+
+/**
+ * \brief Creates an independent solver instance
+ * \param[in]       num_threads         The number of OpenMP threads to use
+ * \return                              The instance, free with accelerInt_destroy
+ */
+accelerInt_context* accelerInt_create(int num_threads);
+
+/**
+ * \brief accelerInt_integrate on the instance `context`
+ */
+void accelerInt_context_integrate(accelerInt_context* context, const int NUM, const double t_start, const double t_end,
+                                  const double stepsize, double * __restrict__ y_host, const double * __restrict__ var_host);
+
+/**
+ * \brief accelerInt_integrate_local on the instance `context`
+ */
+void accelerInt_context_integrate_local(accelerInt_context* context, const int NUM, const double * __restrict__ t_start,
+                                        const double * __restrict__ t_end, double * __restrict__ y_host,
+                                        const double * __restrict__ var_host);
+
+/**
+ * \brief accelerInt_integrate_stream on the instance `context`
+ */
+long accelerInt_context_integrate_stream(accelerInt_context* context, const int chunk_size, const double t_start,
+                                         const double t_end, const double stepsize, accelerInt_producer producer,
+                                         accelerInt_consumer consumer, void* user);
+
+/**
+ * \brief accelerInt_set_tolerances on the instance `context`
+ */
+void accelerInt_context_set_tolerances(accelerInt_context* context, const double atol, const double rtol,
+                                       const double* atol_vector);
+
+/**
+ * \brief accelerInt_set_tolerance_scale on the instance `context`
+ */
+void accelerInt_context_set_tolerance_scale(accelerInt_context* context, const double* scale);
+
+/**
+ * \brief accelerInt_get_statistics on the instance `context`
+ */
+void accelerInt_context_get_statistics(const accelerInt_context* context, const int NUM, int* stats);
+
+/**
+ * \brief accelerInt_get_failures on the instance `context`
+ */
+int accelerInt_context_get_failures(const accelerInt_context* context, const int NUM, int* codes, int* counts);
+
+/**
+ * \brief accelerInt_get_phase_profile on the instance `context`, called from the thread that integrated
+ */
+void accelerInt_context_get_phase_profile(const accelerInt_context* context, long long* cycles, long long* calls);
+
+/**
+ * \brief accelerInt_get_isat_statistics on the instance `context`
+ */
+void accelerInt_context_get_isat_statistics(const accelerInt_context* context, long* stats);
+
+/**
+ * \brief Shares the ISAT table of `source` with `context` (e.g. instances integrating similar IVPs from different host threads)
+ */
+void accelerInt_context_share_isat(accelerInt_context* context, accelerInt_context* source);
+
+/**
+ * \brief accelerInt_set_affinity on the instance `context`
+ */
+int accelerInt_context_set_affinity(accelerInt_context* context, const int* cpus, const int num_cpus);
+
+/**
+ * \brief Frees all memory of the instance `context`
+ */
+void accelerInt_destroy(accelerInt_context* context);
+
 
 
 
@@ -9,6 +9,9 @@
  */
 
 
+//! for clock_gettime() and the POSIX threads, @see benchmark.h and log_writer.h
+#define _POSIX_C_SOURCE 200112L
+
 /** Include common code. */
 #include <stdlib.h>
 #include <stdio.h>
@@ -25,47 +28,20 @@
 //our code
 #include "header.h"
 #include "solver.h"
-#include "timer.h"
+#include "solver_context.h"
+#include "benchmark.h"
+#include "hw_counters.h"
+#include "log_writer.h"
+#include "checkpoint.h"
+#include "numa_placement.h"
 #include "read_initial_conditions.h"
+#include "state_layout.h"
+#include "phase_profile.h"
 
 #ifdef GENERATE_DOCS
 namespace generic {
 #endif
 
-/**
- * \brief Writes state vectors to file
- * \param[in]           NUM                 the number of state vectors to write
- * \param[in]           t                   the current system time
- * \param[in]           y_host              the current state vectors
- * \param[in]           pFile               the opened binary file object
- *
- * The resulting file is updated as:
- * system time\n
- * temperature, mass fractions (State #1)\n
- * temperature, mass fractions (State #2)...
- */
-void write_log(int NUM, double t, const double* y_host, FILE* pFile)
-{
-    fwrite(&t, sizeof(double), 1, pFile);
-    double buffer[NN];
-    for (int j = 0; j < NUM; j++)
-    {
-        double Y_N = 1.0;
-        buffer[0] = y_host[j];
-        for (int i = 1; i < NSP; ++i)
-        {
-            buffer[i] = y_host[NUM * i + j];
-            Y_N -= buffer[i];
-        }
-        #if NN == NSP + 1 //pyjac
-        buffer[NSP] = Y_N;
-        #endif
-        apply_reverse_mask(&buffer[1]);
-        fwrite(buffer, sizeof(double), NN, pFile);
-    }
-}
-
-
 //////////////////////////////////////////////////////////////////////////////
 
 /** Main function
@@ -74,7 +50,7 @@ void write_log(int NUM, double t, const double* y_host, FILE* pFile)
  * \param[in]       argv    command line argument vector
  *
  * This allows running the integrators from the command line.  The syntax is as follows:\n
- * `./solver-name [num_threads] [num_IVPs]`\n
+ * `./solver-name [num_threads] [num_IVPs] [checkpoint]`\n
  * *  num_threads  [Optional, Default:1]
  *      *  The number OpenMP threads to utilize
  *      *  The number of threads cannot be greater than recognized by OpenMP via `omp_get_max_threads()`
@@ -82,7 +58,17 @@ void write_log(int NUM, double t, const double* y_host, FILE* pFile)
  *      *  The number of initial value problems to solve.
  *      *  This must be less than the number of conditions in the data file if #SAME_IC is not defined.
  *      *  If #SAME_IC is defined, then the initial conditions in the mechanism files will be used.
+ * *  checkpoint   [Optional]
+ *      *  A checkpoint file (@see checkpoint.h) of num_IVPs IVPs to restart from, instead of the initial conditions.
+ *      *  The integration resumes at the time and global step of the checkpoint, with the per-IVP controller
+ *         state of the checkpoint (if written by the same solver and build).
  *
+ * If #CHECKPOINT_INTERVAL is defined, a checkpoint is written (asynchronously) to `<solver>-checkpoint.bin`
+ * whenever this many seconds passed since the last checkpoint, after a global integration step of the last trial.
+ *
+ * The integration is repeated for #BENCHMARK_WARMUP untimed and #BENCHMARK_TRIALS timed trials
+ * from the same initial conditions, the reported time is the median of the timed trials.
+ * Logging (if enabled) is performed for the last trial only.  @see benchmark.h
  */
 int main (int argc, char *argv[])
 {
@@ -135,11 +121,20 @@ int main (int argc, char *argv[])
 
     #endif
 
+    const char* restart_file = argc > 3 ? argv[3] : NULL;
+
     // print number of independent ODEs
     printf ("# ODEs: %d\n", NUM);
     printf ("# threads: %d\n", num_threads);
 
-    initialize_solver(num_threads);
+#ifdef NUMA_FIRST_TOUCH
+    // pin the threads before they first touch the integrator memory and the initial conditions
+    pin_threads(num_threads, NULL, 0);
+#endif
+
+    // the integrator memory and per-IVP host storage
+    accelerInt_context context;
+    initialize_context(&context, num_threads);
 
     /////////////////////////////////////////////////
     // arrays
@@ -154,26 +149,90 @@ int main (int argc, char *argv[])
     double* y_host;
     double* var_host;
 
+    // the size of the per-IVP controller state in the checkpoints
+#ifdef SOLVER_WARM_START
+    const size_t warm_bytes = (size_t)NUM * sizeof(warm_start_memory);
+#else
+    const size_t warm_bytes = 0;
+#endif
+    // the time, number of completed global steps and controller state the integration starts from
+    double t_start = 0;
+    int step_start = 0;
+    void* warm_init = NULL;
+    if (restart_file != NULL)
+    {
+#ifdef EVENT_DRIVER
+        printf("Error: restarting from a checkpoint is not supported with IGN_EVENT.\n");
+        exit(1);
+#endif
+        y_host = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+        var_host = (double*)malloc(NUM * sizeof(double));
+        warm_init = warm_bytes ? malloc(warm_bytes) : NULL;
+        if (!read_checkpoint(restart_file, NUM, warm_bytes, &t_start, &step_start, y_host, var_host, warm_init))
+        {
+            free(warm_init);
+            warm_init = NULL;
+        }
+        printf ("# restart: %s (t = %e, step %d)\n", restart_file, t_start, step_start);
+    }
+    else
+    {
 #ifdef SAME_IC
-    set_same_initial_conditions(NUM, &y_host, &var_host);
+        set_same_initial_conditions(NUM, &y_host, &var_host);
 #else
-    read_initial_conditions(filename, NUM, &y_host, &var_host);
+        read_initial_conditions(filename, NUM, &y_host, &var_host);
+#endif
+    }
+#ifdef STATE_BLOCK
+    // the drivers integrate the state vectors in the blocked layout, @see state_layout.h
+    double* y_loaded = y_host;
+    y_host = (double*)malloc(state_size(NUM) * sizeof(double));
+    block_states(NUM, y_loaded, y_host, num_threads);
 #endif
 
 // flag for ignition
 #ifdef IGN
-    bool ign_flag = false;
     // ignition delay time, units [s]
     double t_ign = 0.0;
+#ifndef EVENT_DRIVER
+    bool ign_flag = false;
     double T0 = y_host[0];
 #endif
+#endif
+
+    // the initial conditions of each trial
+    double* y_init = (double*)malloc(state_size(NUM) * sizeof(double));
+    memcpy(y_init, y_host, state_size(NUM) * sizeof(double));
+
+#ifdef EVENT_DRIVER
+    // the ignition event of each IVP, and the states at the (logged) outer steps
+    event_request* events = (event_request*)malloc(NUM * sizeof(event_request));
+    int num_out = 0;
+    double* t_out = NULL;
+    double* y_out = NULL;
+#ifdef LOG_OUTPUT
+    while (fmin(end_time, num_out * t_step) + EPS < end_time)
+        num_out++;
+    t_out = (double*)malloc(num_out * sizeof(double));
+    for (int k = 0; k < num_out; ++k)
+        t_out[k] = fmin(end_time, (k + 1) * t_step);
+    y_out = (double*)malloc(NUM * NSP * num_out * sizeof(double));
+#endif
+    for (int tid = 0; tid < NUM; ++tid)
+    {
+        events[tid].threshold = y_init[state_index(tid, EVENT_INDEX, NUM)] + 400.0;
+        events[tid].num_out = num_out;
+        events[tid].t_out = t_out;
+        events[tid].y_out = &y_out[tid * NSP * num_out];
+    }
+#endif
 
 #ifdef LOG_OUTPUT
     // file for data
-    FILE *pFile;
+    log_writer state_log;
     const char* f_name = solver_name();
     int len = strlen(f_name);
-    char out_name[len + 13];
+    char out_name[len + 32];
     struct stat info;
     if (stat("./log/", &info) != 0)
     {
@@ -181,86 +240,267 @@ int main (int argc, char *argv[])
                " mkdir log (or the equivalent) and run again.\n");
         exit(-1);
     }
-    sprintf(out_name, "log/%s-log.bin", f_name);
-    pFile = fopen(out_name, "wb");
-
-    write_log(NUM, 0, y_host, pFile);
+    // a restarted run is logged to a separate file, starting at the checkpoint
+    if (restart_file != NULL)
+        sprintf(out_name, "log/%s-log-%d.bin", f_name, step_start);
+    else
+        sprintf(out_name, "log/%s-log.bin", f_name);
+    open_log(&state_log, out_name, NUM);
+
+    write_log(&state_log, t_start, y_host);
     init_solver_log();
 #endif
 
-    //////////////////////////////
-    // start timer
-    StartTimer();
-    //////////////////////////////
+#ifdef CHECKPOINT_INTERVAL
+    checkpoint_writer checkpoint;
+    char checkpoint_name[strlen(solver_name()) + 16];
+    sprintf(checkpoint_name, "%s-checkpoint.bin", solver_name());
+    open_checkpoint(&checkpoint, checkpoint_name, NUM, warm_bytes);
+#endif
 
-    // set initial time
-    double t = 0;
-    double t_next = fmin(end_time, t_step);
+    double samples[BENCHMARK_TRIALS];
     int numSteps = 0;
-
-    // time integration loop
-    while (t + EPS < end_time)
+#ifdef HW_COUNTERS
+    hw_counters counters;
+    hw_counters_open(&counters, num_threads);
+#endif
+    for (int trial = -BENCHMARK_WARMUP; trial < BENCHMARK_TRIALS; ++trial)
     {
-        numSteps++;
-
-        intDriver(NUM, t, t_next, var_host, y_host);
-        t = t_next;
-        t_next = fmin(end_time, (numSteps + 1) * t_step);
-
-#if defined(PRINT)
-        printf("%.15le\t%.15le\n", t, y_host[0]);
+#ifdef LOG_OUTPUT
+        // only the last trial is logged
+        bool last_trial = trial == BENCHMARK_TRIALS - 1;
 #endif
-#ifdef DEBUG
-        // check if within bounds
-        if ((y_host[0] < 0.0) || (y_host[0] > 10000.0))
+        memcpy(y_host, y_init, state_size(NUM) * sizeof(double));
+#ifdef SOLVER_WARM_START
+        // each trial starts cold, or from the controller state of the checkpoint
+        cleanup_warm_start(&context.warm);
+        if (warm_init != NULL)
         {
-            printf("Error, out of bounds.\n");
-            printf("Time: %e, ind %d val %e\n", t, 0, y_host[0]);
-            return 1;
+            resize_warm_start(&context.warm, NUM);
+            memcpy(context.warm.warm, warm_init, warm_bytes);
         }
 #endif
+#ifdef IGN
+        t_ign = 0.0;
+#ifndef EVENT_DRIVER
+        ign_flag = false;
+#endif
+#endif
+#ifdef EVENT_DRIVER
+        for (int tid = 0; tid < NUM; ++tid)
+            events[tid].t_event = -1;
+#endif
+
+        //////////////////////////////
+        // start timer
+        double trial_start = benchmark_time();
+        //////////////////////////////
+#ifdef HW_COUNTERS
+        if (trial >= 0)
+            hw_counters_start(&counters);
+#endif
+
+        reset_statistics(&context.stats, NUM);
+#ifdef FAILURE_RETRY
+        reset_failures(&context.failures, NUM);
+#endif
+        reset_phase_profile(num_threads);
+
+        // set initial time
+        double t = t_start;
+        numSteps = step_start;
+#ifdef CHECKPOINT_INTERVAL
+        double last_checkpoint = benchmark_time();
+#endif
+
+#ifdef EVENT_DRIVER
+        // a single integration call, the solver locates the ignition event on its internal steps
+        context.events = events;
+        intDriver(&context, NUM, t, end_time, var_host, y_host);
+        context.events = NULL;
+        t = end_time;
+        numSteps = 1;
+        if (events[0].t_event >= 0)
+            t_ign = events[0].t_event;
 #ifdef LOG_OUTPUT
         #if !defined(LOG_END_ONLY)
-            write_log(NUM, t, y_host, pFile);
+        if (last_trial)
+        {
+            // reassemble the dense output of each logged step (the final state is in y_host)
+            double* y_log = (double*)malloc(state_size(NUM) * sizeof(double));
+            for (int k = 0; k < num_out - 1; ++k)
+            {
+                if ((k + 1) % LOG_STEP_STRIDE != 0)
+                    continue;
+                for (int tid = 0; tid < NUM; ++tid)
+                    for (int i = 0; i < NSP; ++i)
+                        y_log[state_index(tid, i, NUM)] = events[tid].y_out[i + NSP * k];
+                write_log(&state_log, t_out[k], y_log);
+                solver_log();
+            }
+            free(y_log);
+            write_log(&state_log, t, y_host);
             solver_log();
+        }
         #endif
 #endif
+#else
+        double t_next = fmin(end_time, (numSteps + 1) * t_step);
+
+        // time integration loop
+        while (t + EPS < end_time)
+        {
+            numSteps++;
+
+            intDriver(&context, NUM, t, t_next, var_host, y_host);
+            t = t_next;
+            t_next = fmin(end_time, (numSteps + 1) * t_step);
+
+#if defined(PRINT)
+            printf("%.15le\t%.15le\n", t, y_host[0]);
+#endif
+#ifdef DEBUG
+            // check if within bounds
+            if ((y_host[0] < 0.0) || (y_host[0] > 10000.0))
+            {
+                printf("Error, out of bounds.\n");
+                printf("Time: %e, ind %d val %e\n", t, 0, y_host[0]);
+                return 1;
+            }
+#endif
+#ifdef CHECKPOINT_INTERVAL
+            if (trial == BENCHMARK_TRIALS - 1 && t + EPS < end_time &&
+                benchmark_time() - last_checkpoint >= CHECKPOINT_INTERVAL)
+            {
+#ifdef SOLVER_WARM_START
+                write_checkpoint(&checkpoint, t, numSteps, y_host, var_host, context.warm.warm);
+#else
+                write_checkpoint(&checkpoint, t, numSteps, y_host, var_host, NULL);
+#endif
+                last_checkpoint = benchmark_time();
+            }
+#endif
+#ifdef LOG_OUTPUT
+            #if !defined(LOG_END_ONLY)
+            if (last_trial && (numSteps % LOG_STEP_STRIDE == 0 || !(t + EPS < end_time)))
+            {
+                write_log(&state_log, t, y_host);
+                solver_log();
+            }
+            #endif
+#endif
 #ifdef IGN
-        // determine if ignition has occurred
-        if ((y_host[0] >= (T0 + 400.0)) && !(ign_flag)) {
-            ign_flag = true;
-            t_ign = t;
+            // determine if ignition has occurred
+            if ((y_host[0] >= (T0 + 400.0)) && !(ign_flag)) {
+                ign_flag = true;
+                t_ign = t;
+            }
+#endif
         }
 #endif
-    }
 
 #ifdef LOG_END_ONLY
-    write_log(NUM, t, y_host, pFile);
-    solver_log();
+        if (last_trial)
+        {
+            write_log(&state_log, t, y_host);
+            solver_log();
+        }
 #endif
 
-    /////////////////////////////////
-    // end timer
-    double runtime = GetTimer();
-    /////////////////////////////////
-
+        /////////////////////////////////
+        // end timer
+        if (trial >= 0)
+            samples[trial] = benchmark_time() - trial_start;
+        /////////////////////////////////
+#ifdef HW_COUNTERS
+        if (trial >= 0)
+            hw_counters_stop(&counters);
+#endif
+    } // end trials
 
-    runtime /= 1000.0;
+    benchmark_summary summary;
+    benchmark_summarize(BENCHMARK_TRIALS, samples, &summary);
+    double runtime = summary.median;
     printf ("Time: %.15e sec\n", runtime);
-    runtime = runtime / ((double)(numSteps));
+#if BENCHMARK_TRIALS > 1
+    printf ("Trials: %d\tmin: %.6e\tp10: %.6e\tp90: %.6e\tmax: %.6e\tstd. dev.: %.6e (s)\n",
+            BENCHMARK_TRIALS, summary.min, summary.p10, summary.p90, summary.max, sqrt(summary.variance));
+#endif
+#ifdef HW_COUNTERS
+    benchmark_counters metrics;
+    hw_counters_summarize(&counters, &metrics);
+    hw_counters_print(&counters, (double)NUM * (numSteps - step_start) * BENCHMARK_TRIALS);
+    hw_counters_close(&counters);
+#endif
+#ifdef BENCHMARK_OUTPUT
+    benchmark_info bench = {solver_name(), "cpu", NUM, num_threads, 0, numSteps - step_start, t_step};
+#ifdef HW_COUNTERS
+    bench.counters = &metrics;
+#endif
+    benchmark_write(BENCHMARK_OUTPUT, &bench, BENCHMARK_TRIALS, samples, &summary);
+#endif
+    runtime = runtime / ((double)(numSteps - step_start));
     printf ("Time per step: %e (s)\t%.15e (s/thread)\n", runtime, runtime / NUM);
 #ifdef IGN
     printf ("Ig. Delay (s): %e\n", t_ign);
 #endif
     printf("TFinal: %e\n", y_host[0]);
+#ifdef STATISTICS
+    int* stats = (int*)malloc(NUM * NUM_STATS * sizeof(int));
+    get_statistics(&context.stats, NUM, stats);
+    long int total_steps = 0;
+    int max_steps = 0;
+    for (int i = 0; i < NUM; ++i)
+    {
+        total_steps += stats[i + STAT_STEPS * NUM];
+        max_steps = stats[i + STAT_STEPS * NUM] > max_steps ? stats[i + STAT_STEPS * NUM] : max_steps;
+    }
+    printf("Integrator steps: %ld (total)\t%d (max)\n", total_steps, max_steps);
+#ifdef LAZY_JACOBIAN
+    long int jac_evals = 0, jac_age = 0, jac_stale = 0;
+    for (int i = 0; i < NUM; ++i)
+    {
+        jac_evals += stats[i + STAT_JAC_EVALS * NUM];
+        jac_age += stats[i + STAT_JAC_AGE * NUM];
+        jac_stale += stats[i + STAT_JAC_STALE_REJECTS * NUM];
+    }
+    printf("Jacobian evaluations: %ld (total)\t%ld (after a rejected reuse)\t%.2f (mean age in steps)\n",
+           jac_evals, jac_stale, total_steps > 0 ? jac_age / (double)total_steps : 0.0);
+#endif
+    free(stats);
+#endif
+#ifdef FAILURE_RETRY
+    // of the last trial
+    int failure_counts[NUM_FAILURE_COUNTS];
+    get_failures(&context.failures, NUM, NULL, failure_counts);
+    printf("Failed integrations: %d (re-integrated)\t%d (unrecovered)\n",
+           failure_counts[FAILURE_RETRIED], failure_counts[FAILURE_UNRECOVERED]);
+#endif
+#ifdef PROFILE_PHASES
+    // of the last trial
+    print_phase_profile(num_threads, stdout);
+#endif
 
 #ifdef LOG_OUTPUT
-    fclose (pFile);
+    close_log(&state_log);
+#endif
+#ifdef CHECKPOINT_INTERVAL
+    close_checkpoint(&checkpoint);
 #endif
 
+#ifdef STATE_BLOCK
     free (y_host);
-    free(var_host);
-    cleanup_solver(num_threads);
+    y_host = y_loaded;
+#endif
+    free_initial_conditions(y_host, var_host);
+    free (y_init);
+    free (warm_init);
+#ifdef EVENT_DRIVER
+    free (events);
+    free (t_out);
+    free (y_out);
+#endif
+    cleanup_context(&context);
 
     return 0;
 }
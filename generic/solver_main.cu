@@ -30,12 +30,17 @@
 
 //our code
 #include "header.cuh"
-#include "timer.h"
+#include "benchmark.h"
+#include "log_writer.h"
 //get our solver stuff
 #include "solver.cuh"
 #include "gpu_memory.cuh"
 #include "read_initial_conditions.cuh"
 #include "launch_bounds.cuh"
+#include "multi_gpu.cuh"
+#include "solver_stats.cuh"
+#include "warp_reorder.cuh"
+#include "checkpoint.h"
 
 #ifdef DIVERGENCE_TEST
     #include <assert.h>
@@ -44,90 +49,34 @@
     __device__ int integrator_steps[DIVERGENCE_TEST] = {0};
 #endif
 
+#ifdef HW_COUNTERS
 /**
- * \brief Writes state vectors to file
- * \param[in]           NUM                 the number of state vectors to write
- * \param[in]           t                   the current system time
- * \param[in]           y_host              the current state vectors
- * \param[in]           pFile               the opened binary file object
+ * \brief Fills the static resource usage of intDriver on `device` (registers, local memory, theoretical occupancy)
  *
- * The resulting file is updated as:
- * system time\n
- * temperature, mass fractions (State #1)\n
- * temperature, mass fractions (State #2)...
+ * The dynamic counters (FLOPs, DRAM bytes, cache hit rates) are not collected in process,
+ * but by profiling the executable with Nsight Compute (`benchmark.py --profile`), hence are unavailable here.
  */
-void write_log(int NUM, double t, const double* y_host, FILE* pFile)
+static void kernel_counters(const int device, benchmark_counters* metrics)
 {
-    fwrite(&t, sizeof(double), 1, pFile);
-    double buffer[NN];
-    for (int j = 0; j < NUM; j++)
-    {
-        double Y_N = 1.0;
-        buffer[0] = y_host[j];
-        for (int i = 1; i < NSP; ++i)
-        {
-            buffer[i] = y_host[NUM * i + j];
-            Y_N -= buffer[i];
-        }
-        #if NN == NSP + 1 //pyjac
-        buffer[NSP] = Y_N;
-        #endif
-        apply_reverse_mask(&buffer[1]);
-        fwrite(buffer, sizeof(double), NN, pFile);
-    }
-}
-
-/**
- * \brief A convienience method to copy memory between host pointers of different pitches, widths and heights.
- *        Enables easier use of CUDA's cudaMemcpy2D functions.
- *
- * \param[out]              dst             The destination array
- * \param[in]               pitch_dst       The width (in bytes) of the destination array.
-                                            This corresponds to the padded number of IVPs to be solved.
- * \param[in]               src             The source pointer
- * \param[in]               pitch_src       The width (in bytes)  of the source array.
-                                            This corresponds to the (non-padded) number of IVPs read by read_initial_conditions
- * \param[in]               offset          The offset within the source array (IVP index) to copy from.
-                                            This is useful in the case (for large models) where the solver and state vector memory will not fit in device memory
-                                            and the integration must be split into multiple kernel calls.
- * \param[in]               width           The size (in bytes) of memory to copy for each entry in the state vector
- * \param[in]               height          The number of entries in the state vector
- */
-inline void memcpy2D_in(double* dst, const int pitch_dst, double const * src, const int pitch_src,
-                                     const int offset, const size_t width, const int height) {
-    for (int i = 0; i < height; ++i)
-    {
-        memcpy(dst, &src[offset], width);
-        dst += pitch_dst;
-        src += pitch_src;
-    }
-}
-
-/**
- * \brief A convienience method to copy memory between host pointers of different pitches, widths and heights.
- *        Enables easier use of CUDA's cudaMemcpy2D functions.
- *
- * \param[out]              dst             The destination array
- * \param[in]               pitch_dst       The width (in bytes)  of the source array.
-                                            This corresponds to the (non-padded) number of IVPs read by read_initial_conditions
- * \param[in]               src             The source pointer
- * \param[in]               pitch_src       The width (in bytes) of the destination array.
-                                            This corresponds to the padded number of IVPs to be solved.
- * \param[in]               offset          The offset within the destination array (IVP index) to copy to.
-                                            This is useful in the case (for large models) where the solver and state vector memory will not fit in device memory
-                                            and the integration must be split into multiple kernel calls.
- * \param[in]               width           The size (in bytes) of memory to copy for each entry in the state vector
- * \param[in]               height          The number of entries in the state vector
- */
-inline void memcpy2D_out(double* dst, const int pitch_dst, double const * src, const int pitch_src,
-                                      const int offset, const size_t width, const int height) {
-    for (int i = 0; i < height; ++i)
-    {
-        memcpy(&dst[offset], src, width);
-        dst += pitch_dst;
-        src += pitch_src;
-    }
+    metrics->flops = -1;
+    metrics->dram_bytes = -1;
+    metrics->l1_hit_rate = -1;
+    metrics->l2_hit_rate = -1;
+    cudaDeviceProp devProp;
+    cudaErrorCheck( cudaGetDeviceProperties(&devProp, device) );
+    cudaFuncAttributes attr;
+    cudaErrorCheck( cudaFuncGetAttributes(&attr, intDriver) );
+    metrics->registers = attr.numRegs;
+    metrics->local_bytes = (int)attr.localSizeBytes;
+    int blocks = 0;
+    cudaErrorCheck( cudaOccupancyMaxActiveBlocksPerMultiprocessor(&blocks, intDriver, TARGET_BLOCK_SIZE,
+                                                                  SHARED_SIZE + SOLVER_SHARED_SIZE) );
+    metrics->occupancy = (double)(blocks * TARGET_BLOCK_SIZE) / (double)devProp.maxThreadsPerMultiProcessor;
+    printf ("registers: %d	local memory: %d (bytes/thread)	theoretical occupancy: %.3f
+",
+            metrics->registers, metrics->local_bytes, metrics->occupancy);
 }
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -137,15 +86,26 @@ inline void memcpy2D_out(double* dst, const int pitch_dst, double const * src, c
  * \param[in]       argv    command line argument vector
  *
  * This allows running the integrators from the command line.  The syntax is as follows:\n
- * `./solver-name [num_threads] [num_IVPs]`\n
- * *  num_threads  [Optional, Default:1]
- *      *  The number OpenMP threads to utilize
- *      *  The number of threads cannot be greater than recognized by OpenMP via `omp_get_max_threads()`
+ * `./solver-name [num_IVPs] [device] [weights] [checkpoint]`\n
  * *  num_IVPs     [Optional, Default:1]
  *      *  The number of initial value problems to solve.
  *      *  This must be less than the number of conditions in the data file if #SAME_IC is not defined.
  *      *  If #SAME_IC is defined, then the initial conditions in the mechanism files will be used.
+ * *  device       [Optional, Default:0]
+ *      *  The CUDA device number to use, or -1 to shard the IVPs over all visible devices
+ * *  weights      [Optional, Default: even split]
+ *      *  A comma separated list of relative device weights (e.g. `1,1,2`), used when device is -1, or `-` for an even split
+ * *  checkpoint   [Optional]
+ *      *  A checkpoint file (@see checkpoint.h) of num_IVPs IVPs to restart from, instead of the initial conditions.
+ *      *  The integration resumes at the time and global step of the checkpoint, with the per-IVP controller
+ *         state of the checkpoint (if written by the same solver and build).
  *
+ * If #CHECKPOINT_INTERVAL is defined, a checkpoint is written (asynchronously) to `<solver>-checkpoint.bin`
+ * whenever this many seconds passed since the last checkpoint, after a global integration step of the last trial.
+ *
+ * The integration is repeated for #BENCHMARK_WARMUP untimed and #BENCHMARK_TRIALS timed trials
+ * from the same initial conditions, the reported time is the median of the timed trials.
+ * Logging (if enabled) is performed for the last trial only.  @see benchmark.h
  */
 int main (int argc, char *argv[])
 {
@@ -170,74 +130,75 @@ int main (int argc, char *argv[])
         NUM = problemsize;
     }
 
-    // set & initialize device using command line argument (if any)
-    cudaDeviceProp devProp;
-    if (argc <= 2)
+    // set & initialize device(s) using command line argument (if any)
+    int num_devices = 1;
+    int device_id = 0;
+    if (argc > 2)
     {
-        // default device id is 0
-        cudaErrorCheck (cudaSetDevice (0) );
-        cudaErrorCheck (cudaGetDeviceProperties(&devProp, 0));
-    }
-    else
-    {
-        // use second argument for number
-
         // get number of devices
-        int num_devices;
-        cudaGetDeviceCount(&num_devices);
+        int visible_devices;
+        cudaGetDeviceCount(&visible_devices);
 
-        int id = 0;
-        if (sscanf(argv[2], "%i", &id) == 1 && (id >= 0) && (id < num_devices))
-        {
-            cudaErrorCheck( cudaSetDevice (id) );
-        }
-        else
+        if (sscanf(argv[2], "%i", &device_id) != 1 || (device_id < -1) || (device_id >= visible_devices))
         {
             // not in range, error
             printf("Error: GPU device number not in correct range\n");
-            printf("Provide number between 0 and %i\n", num_devices - 1);
+            printf("Provide number between 0 and %i, or -1 to use all devices\n", visible_devices - 1);
             exit(1);
         }
-        cudaErrorCheck (cudaGetDeviceProperties(&devProp, id));
+        if (device_id == -1)
+            num_devices = min(visible_devices, MAX_DEVICES);
     }
-    cudaErrorCheck( cudaDeviceReset() );
-    cudaErrorCheck( cudaPeekAtLastError() );
-    cudaErrorCheck( cudaDeviceSynchronize() );
+
+    // optional relative weights of the devices
+    double weights[MAX_DEVICES];
+    bool use_weights = false;
+    if (argc > 3 && strcmp(argv[3], "-") != 0)
+    {
+        int num_weights = 0;
+        for (char* tok = strtok(argv[3], ","); tok != NULL && num_weights < MAX_DEVICES; tok = strtok(NULL, ","))
+        {
+            if (sscanf(tok, "%lf", &weights[num_weights]) != 1 || weights[num_weights] < 0)
+            {
+                printf("Error: could not parse device weight %s\n", tok);
+                exit(1);
+            }
+            num_weights++;
+        }
+        if (num_weights != num_devices)
+        {
+            printf("Error: %d device weights specified for %d devices\n", num_weights, num_devices);
+            exit(1);
+        }
+        use_weights = true;
+    }
+
+    const char* restart_file = argc > 4 ? argv[4] : NULL;
+
     #ifdef DIVERGENCE_TEST
         NUM = DIVERGENCE_TEST;
         assert(NUM % 32 == 0);
+        if (num_devices != 1)
+        {
+            printf("Error: the divergence test can only be run on a single device\n");
+            exit(1);
+        }
     #endif
-    //bump up shared mem bank size
-    cudaErrorCheck(cudaDeviceSetSharedMemConfig(cudaSharedMemBankSizeEightByte));
-    //and L1 size
-    cudaErrorCheck(cudaDeviceSetCacheConfig(cudaFuncCachePreferL1));
-
-    size_t size_per_thread = required_mechanism_size() + required_solver_size();
-    size_t free_mem = 0;
-    size_t total_mem = 0;
-    cudaErrorCheck( cudaMemGetInfo (&free_mem, &total_mem) );
-
-    //conservatively estimate the maximum allowable threads
-    int max_threads = int(floor(0.8 * ((double)free_mem) / ((double)size_per_thread)));
-    int padded = min(NUM, max_threads);
-    //padded is next factor of block size up
-    padded = int(ceil(padded / float(TARGET_BLOCK_SIZE)) * TARGET_BLOCK_SIZE);
-    if (padded == 0)
-    {
-        printf("Mechanism is too large to fit into global CUDA memory... exiting.");
-        exit(-1);
-    }
 
-    solver_memory* host_solver, *device_solver;
-    mechanism_memory* host_mech, *device_mech;
-    host_solver = (solver_memory*)malloc(sizeof(solver_memory));
-    host_mech = (mechanism_memory*)malloc(sizeof(mechanism_memory));
-
-    initialize_gpu_memory(padded, &host_mech, &device_mech);
-    initialize_solver(padded, &host_solver, &device_solver);
+    // zero-initialized, such that the (GPU_ARENA) device arenas start empty
+    device_shard shards[MAX_DEVICES] = {};
+    int num_shards = initialize_shards(NUM, num_devices, device_id < 0 ? NULL : &device_id,
+                                       use_weights ? weights : NULL, shards, true);
+    // the host statistics, warm start state, reordering buffers and phase totals
+    host_state state = {};
 
     // print number of threads and block size
     printf ("# threads: %d \t block size: %d\n", NUM, TARGET_BLOCK_SIZE);
+    if (num_shards > 1)
+    {
+        for (int d = 0; d < num_shards; ++d)
+            printf ("# device %d: %d IVPs\n", shards[d].device, shards[d].num);
+    }
 
 #ifdef SHUFFLE
     const char* filename = "shuffled_data.bin";
@@ -247,16 +208,37 @@ int main (int argc, char *argv[])
 
     double* y_host;
     double* var_host;
+
+    // the size of the per-IVP controller state in the checkpoints
+#ifdef SOLVER_WARM_START
+    const size_t warm_bytes = (size_t)NUM * WARM_SIZE * sizeof(double);
+#else
+    const size_t warm_bytes = 0;
+#endif
+    // the time, number of completed global steps and controller state the integration starts from
+    double t_start = 0;
+    int step_start = 0;
+    void* warm_init = NULL;
+    if (restart_file != NULL)
+    {
+        y_host = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+        var_host = (double*)malloc(NUM * sizeof(double));
+        warm_init = warm_bytes ? malloc(warm_bytes) : NULL;
+        if (!read_checkpoint(restart_file, NUM, warm_bytes, &t_start, &step_start, y_host, var_host, warm_init))
+        {
+            free(warm_init);
+            warm_init = NULL;
+        }
+        printf ("# restart: %s (t = %e, step %d)\n", restart_file, t_start, step_start);
+    }
+    else
+    {
 #ifdef SAME_IC
-    set_same_initial_conditions(NUM, &y_host, &var_host);
+        set_same_initial_conditions(NUM, &y_host, &var_host);
 #else
-    read_initial_conditions(filename, NUM, &y_host, &var_host);
+        read_initial_conditions(filename, NUM, &y_host, &var_host);
 #endif
-
-    //grid sizes
-    dim3 dimBlock(TARGET_BLOCK_SIZE, 1);
-    dim3 dimGrid (padded / TARGET_BLOCK_SIZE, 1 );
-    int* result_flag = (int*)malloc(padded * sizeof(int));
+    }
 
 // flag for ignition
 #ifdef IGN
@@ -266,12 +248,29 @@ int main (int argc, char *argv[])
     double T0 = y_host[0];
 #endif
 
+#ifdef MANAGED_MEMORY
+    // the shards integrate managed state vectors in place, @see integrate_shards
+    double* y_managed, *var_managed;
+    cudaErrorCheck( cudaMallocManaged(&y_managed, (size_t)NUM * NSP * sizeof(double)) );
+    cudaErrorCheck( cudaMallocManaged(&var_managed, NUM * sizeof(double)) );
+    memcpy(y_managed, y_host, (size_t)NUM * NSP * sizeof(double));
+    memcpy(var_managed, var_host, NUM * sizeof(double));
+    cudaErrorCheck( cudaMemAdvise(var_managed, NUM * sizeof(double), cudaMemAdviseSetReadMostly, 0) );
+    free_initial_conditions(y_host, var_host);
+    y_host = y_managed;
+    var_host = var_managed;
+#endif
+
+    // the initial conditions of each trial
+    double* y_init = (double*)malloc(NUM * NSP * sizeof(double));
+    memcpy(y_init, y_host, NUM * NSP * sizeof(double));
+
 #ifdef LOG_OUTPUT
     // file for data
-    FILE *pFile;
+    log_writer state_log;
     const char* f_name = solver_name();
     int len = strlen(f_name);
-    char out_name[len + 13];
+    char out_name[len + 32];
     struct stat info;
     if (stat("./log/", &info) != 0)
     {
@@ -279,108 +278,142 @@ int main (int argc, char *argv[])
                " mkdir log (or the equivalent) and run again.\n");
         exit(-1);
     }
-    sprintf(out_name, "log/%s-log.bin", f_name);
-    pFile = fopen(out_name, "wb");
+    // a restarted run is logged to a separate file, starting at the checkpoint
+    if (restart_file != NULL)
+        sprintf(out_name, "log/%s-log-%d.bin", f_name, step_start);
+    else
+        sprintf(out_name, "log/%s-log.bin", f_name);
+    open_log(&state_log, out_name, NUM);
 
-    write_log(NUM, 0, y_host, pFile);
+    write_log(&state_log, t_start, y_host);
 
     //initialize integrator specific log
     init_solver_log();
 #endif
 
-    double* y_temp = 0;
-    y_temp = (double*)malloc(padded * NSP * sizeof(double));
-
-    //////////////////////////////
-    // start timer
-    StartTimer();
-    //////////////////////////////
+#ifdef CHECKPOINT_INTERVAL
+    checkpoint_writer checkpoint;
+    char checkpoint_name[strlen(solver_name()) + 16];
+    sprintf(checkpoint_name, "%s-checkpoint.bin", solver_name());
+    open_checkpoint(&checkpoint, checkpoint_name, NUM, warm_bytes);
+#endif
 
-    // set initial time
-    double t = 0;
-    double t_next = fmin(end_time, t_step);
+    double samples[BENCHMARK_TRIALS];
     int numSteps = 0;
-
-    // time integration loop
-    while (t + EPS < end_time)
+    for (int trial = -BENCHMARK_WARMUP; trial < BENCHMARK_TRIALS; ++trial)
     {
-        numSteps++;
-
-        int num_solved = 0;
-        while (num_solved < NUM)
+#ifdef LOG_OUTPUT
+        // only the last trial is logged
+        bool last_trial = trial == BENCHMARK_TRIALS - 1;
+#endif
+        memcpy(y_host, y_init, NUM * NSP * sizeof(double));
+#ifdef SOLVER_WARM_START
+        // each trial starts cold, or from the controller state of the checkpoint
+        cleanup_warm_start(&state.warm);
+        if (warm_init != NULL)
         {
-            int num_cond = min(NUM - num_solved, padded);
-
-            cudaErrorCheck( cudaMemcpy (host_mech->var, &var_host[num_solved],
-                                        num_cond * sizeof(double), cudaMemcpyHostToDevice));
-
-             //copy our memory into y_temp
-            memcpy2D_in(y_temp, padded, y_host, NUM,
-                            num_solved, num_cond * sizeof(double), NSP);
-            // transfer memory to GPU
-            cudaErrorCheck( cudaMemcpy2D (host_mech->y, padded * sizeof(double),
-                                            y_temp, padded * sizeof(double),
-                                            num_cond * sizeof(double), NSP,
-                                            cudaMemcpyHostToDevice) );
-            intDriver <<< dimGrid, dimBlock, SHARED_SIZE >>> (num_cond, t, t_next, host_mech->var, host_mech->y, device_mech, device_solver);
-    #ifdef DEBUG
-            cudaErrorCheck( cudaPeekAtLastError() );
-            cudaErrorCheck( cudaDeviceSynchronize() );
-    #endif
-            // copy the result flag back
-            cudaErrorCheck( cudaMemcpy(result_flag, host_solver->result, num_cond * sizeof(int), cudaMemcpyDeviceToHost) );
-            check_error(num_cond, result_flag);
-            // transfer memory back to CPU
-            cudaErrorCheck( cudaMemcpy2D (y_temp, padded * sizeof(double),
-                                            host_mech->y, padded * sizeof(double),
-                                            num_cond * sizeof(double), NSP,
-                                            cudaMemcpyDeviceToHost) );
-            memcpy2D_out(y_host, NUM, y_temp, padded,
-                            num_solved, num_cond * sizeof(double), NSP);
-
-            num_solved += num_cond;
-
+            resize_warm_start(&state.warm, NUM);
+            memcpy(state.warm.warm, warm_init, warm_bytes);
         }
+#endif
+#ifdef IGN
+        ign_flag = false;
+        t_ign = 0.0;
+#ifdef DEVICE_REDUCE
+        // the ignition of every IVP is detected on the devices
+        reset_shard_ignition(num_shards, shards, y_host);
+#endif
+#endif
 
-        t = t_next;
-        t_next = fmin(end_time, (numSteps + 1) * t_step);
+        //////////////////////////////
+        // start timer
+        double trial_start = benchmark_time();
+        //////////////////////////////
+
+        // set initial time
+        double t = t_start;
+        numSteps = step_start;
+        double t_next = fmin(end_time, (numSteps + 1) * t_step);
+#ifdef CHECKPOINT_INTERVAL
+        double last_checkpoint = benchmark_time();
+#endif
+        reset_statistics(&state.stats, NUM);
+        reset_phase_profile(&state.profile);
 
-    #if defined(PRINT)
-            printf("%.15le\t%.15le\n", t, y_host[0]);
-    #endif
-    #ifdef DEBUG
-            // check if within bounds
-            if ((y_host[0] < 0.0) || (y_host[0] > 10000.0))
-            {
-                printf("Error, out of bounds.\n");
-                printf("Time: %e, ind %d val %e\n", t, 0, y_host[0]);
-                return 1;
-            }
-    #endif
-    #ifdef LOG_OUTPUT
-            #if !defined(LOG_END_ONLY)
-                write_log(NUM, t, y_host, pFile);
-                solver_log();
-            #endif
-    #endif
-    #ifdef IGN
-            // determine if ignition has occurred
-            if ((y_host[0] >= (T0 + 400.0)) && !(ign_flag)) {
-                ign_flag = true;
-                t_ign = t;
-            }
-    #endif
-    }
+        // time integration loop
+        while (t + EPS < end_time)
+        {
+            numSteps++;
+
+#ifdef WARP_REORDER
+            // sort the IVPs by the stiffness proxy, such that the warps have similar work
+            double* y_step, *var_step;
+            warp_reorder_gather(&state, NUM, y_host, var_host, &y_step, &var_step);
+            integrate_shards(&state, num_shards, shards, NUM, t, t_next, y_step, var_step);
+            warp_reorder_scatter(&state, NUM, y_host);
+#else
+            integrate_shards(&state, num_shards, shards, NUM, t, t_next, y_host, var_host);
+#endif
+
+            t = t_next;
+            t_next = fmin(end_time, (numSteps + 1) * t_step);
+
+        #if defined(PRINT)
+                printf("%.15le\t%.15le\n", t, y_host[0]);
+        #endif
+        #ifdef DEBUG
+                // check if within bounds
+                if ((y_host[0] < 0.0) || (y_host[0] > 10000.0))
+                {
+                    printf("Error, out of bounds.\n");
+                    printf("Time: %e, ind %d val %e\n", t, 0, y_host[0]);
+                    return 1;
+                }
+        #endif
+        #ifdef CHECKPOINT_INTERVAL
+                if (trial == BENCHMARK_TRIALS - 1 && t + EPS < end_time &&
+                    benchmark_time() - last_checkpoint >= CHECKPOINT_INTERVAL)
+                {
+                #ifdef SOLVER_WARM_START
+                    write_checkpoint(&checkpoint, t, numSteps, y_host, var_host, state.warm.warm);
+                #else
+                    write_checkpoint(&checkpoint, t, numSteps, y_host, var_host, NULL);
+                #endif
+                    last_checkpoint = benchmark_time();
+                }
+        #endif
+        #ifdef LOG_OUTPUT
+                #if !defined(LOG_END_ONLY)
+                if (last_trial && (numSteps % LOG_STEP_STRIDE == 0 || !(t + EPS < end_time)))
+                {
+                    write_log(&state_log, t, y_host);
+                    solver_log();
+                }
+                #endif
+        #endif
+        #if defined(IGN) && !defined(DEVICE_REDUCE)
+                // determine if ignition has occurred
+                if ((y_host[0] >= (T0 + 400.0)) && !(ign_flag)) {
+                    ign_flag = true;
+                    t_ign = t;
+                }
+        #endif
+        }
 
 #ifdef LOG_END_ONLY
-    write_log(NUM, t, y_host, pFile);
-    solver_log();
+        if (last_trial)
+        {
+            write_log(&state_log, t, y_host);
+            solver_log();
+        }
 #endif
 
-    /////////////////////////////////
-    // end timer
-    double runtime = GetTimer();
-    /////////////////////////////////
+        /////////////////////////////////
+        // end timer
+        if (trial >= 0)
+            samples[trial] = benchmark_time() - trial_start;
+        /////////////////////////////////
+    } // end trials
 
     #ifdef DIVERGENCE_TEST
     int host_integrator_steps[DIVERGENCE_TEST];
@@ -411,27 +444,86 @@ int main (int argc, char *argv[])
     fclose(dFile);
     #endif
 
-    runtime /= 1000.0;
+    benchmark_summary summary;
+    benchmark_summarize(BENCHMARK_TRIALS, samples, &summary);
+    double runtime = summary.median;
     printf ("Time: %.15e sec\n", runtime);
-    runtime = runtime / ((double)(numSteps));
+#if BENCHMARK_TRIALS > 1
+    printf ("Trials: %d\tmin: %.6e\tp10: %.6e\tp90: %.6e\tmax: %.6e\tstd. dev.: %.6e (s)\n",
+            BENCHMARK_TRIALS, summary.min, summary.p10, summary.p90, summary.max, sqrt(summary.variance));
+#endif
+#ifdef HW_COUNTERS
+    benchmark_counters metrics;
+    kernel_counters(shards[0].device, &metrics);
+#endif
+#ifdef BENCHMARK_OUTPUT
+    benchmark_info bench = {solver_name(), "gpu", NUM, num_shards, TARGET_BLOCK_SIZE, numSteps - step_start, t_step};
+#ifdef HW_COUNTERS
+    bench.counters = &metrics;
+#endif
+    benchmark_write(BENCHMARK_OUTPUT, &bench, BENCHMARK_TRIALS, samples, &summary);
+#endif
+    runtime = runtime / ((double)(numSteps - step_start));
     printf ("Time per step: %e (s)\t%.15e (s/thread)\n", runtime, runtime / NUM);
-#ifdef IGN
+#if defined(IGN) && defined(DEVICE_REDUCE)
+    int num_ignited = 0;
+    double max_T = 0;
+    double* ign_times = (double*)malloc(NUM * sizeof(double));
+    get_shard_ignition(num_shards, shards, &num_ignited, &max_T, ign_times);
+    t_ign = fmax(ign_times[0], 0.0);
+    free(ign_times);
+    printf ("Ig. Delay (s): %e\n", t_ign);
+    printf ("Ignited: %d / %d\tmax T: %e\n", num_ignited, NUM, max_T);
+#elif defined(IGN)
     printf ("Ig. Delay (s): %e\n", t_ign);
 #endif
     printf("TFinal: %e\n", y_host[0]);
+#ifdef STATISTICS
+    int* stats = (int*)malloc(NUM * NUM_STATS * sizeof(int));
+    get_statistics(&state.stats, NUM, stats);
+    long int total_steps = 0;
+    int max_steps = 0;
+    for (int i = 0; i < NUM; ++i)
+    {
+        total_steps += stats[i + STAT_STEPS * NUM];
+        max_steps = stats[i + STAT_STEPS * NUM] > max_steps ? stats[i + STAT_STEPS * NUM] : max_steps;
+    }
+    printf("Integrator steps: %ld (total)\t%d (max)\n", total_steps, max_steps);
+#ifdef LAZY_JACOBIAN
+    long int jac_evals = 0, jac_age = 0, jac_stale = 0;
+    for (int i = 0; i < NUM; ++i)
+    {
+        jac_evals += stats[i + STAT_JAC_EVALS * NUM];
+        jac_age += stats[i + STAT_JAC_AGE * NUM];
+        jac_stale += stats[i + STAT_JAC_STALE_REJECTS * NUM];
+    }
+    printf("Jacobian evaluations: %ld (total)\t%ld (after a rejected reuse)\t%.2f (mean age in steps)\n",
+           jac_evals, jac_stale, total_steps > 0 ? jac_age / (double)total_steps : 0.0);
+#endif
+    free(stats);
+#endif
+#ifdef PROFILE_PHASES
+    // of the last trial, in device clock cycles
+    print_phase_profile(&state.profile, stdout);
+#endif
 
 #ifdef LOG_OUTPUT
-    fclose (pFile);
+    close_log(&state_log);
+#endif
+#ifdef CHECKPOINT_INTERVAL
+    close_checkpoint(&checkpoint);
 #endif
 
-
-    free_gpu_memory(&host_mech, &device_mech);
-    cleanup_solver(&host_solver, &device_solver);
-    free(y_temp);
-    free(host_mech);
-    free(host_solver);
-    free(result_flag);
-    cudaErrorCheck( cudaDeviceReset() );
+#ifdef MANAGED_MEMORY
+    cudaErrorCheck( cudaFree(y_host) );
+    cudaErrorCheck( cudaFree(var_host) );
+#else
+    free_initial_conditions(y_host, var_host);
+#endif
+    cleanup_shards(num_shards, shards);
+    cleanup_host_state(&state);
+    free(y_init);
+    free(warm_init);
 
     return 0;
 }
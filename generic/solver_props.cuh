@@ -18,6 +18,16 @@
  	struct solver_memory {};
 #endif
 
+#ifndef DRIVER_THREADS_PER_IVP
+ 	//! The number of threads intDriver is launched with per IVP slot, @see warp_ivp.cuh
+ 	#define DRIVER_THREADS_PER_IVP (1)
+#endif
+
+#ifndef SOLVER_SHARED_SIZE
+ 	//! The dynamic shared memory (in bytes) per block required by the solver, in addition to #SHARED_SIZE
+ 	#define SOLVER_SHARED_SIZE (0)
+#endif
+
 #ifdef GENERATE_DOCS
 namespace genericcu {
 #endif
@@ -0,0 +1,133 @@
+/**
+ * \file
+ * \brief Storage for the per-IVP integrator statistics of the CPU solvers
+ *
+ * Only compiled into the integrators if #STATISTICS is defined
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "header.h"
+#include "solver_stats.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef STATISTICS
+
+int stat_counters[NUM_STATS] = {0};
+#ifdef SIMD_LANES
+int lane_counters[SIMD_LANES][NUM_STATS] = {{0}};
+#endif
+
+/**
+ * \brief Zeros the accumulated statistics for NUM IVPs (allocating storage as needed)
+ * \param[in,out]   storage     The statistics storage
+ * \param[in]       NUM         The number of IVPs
+ */
+void reset_statistics(ivp_statistics* storage, const int NUM)
+{
+    if (NUM != storage->num)
+    {
+        free(storage->stats);
+        storage->stats = (int*)malloc(NUM * NUM_STATS * sizeof(int));
+        storage->num = NUM;
+    }
+    memset(storage->stats, 0, NUM * NUM_STATS * sizeof(int));
+}
+
+/**
+ * \brief Zeros the counters of the current thread, called by the driver before each IVP
+ */
+void clear_counters()
+{
+    memset(stat_counters, 0, NUM_STATS * sizeof(int));
+}
+
+/**
+ * \brief Adds the counters of the current thread to the statistics of IVP `tid`
+ * \param[in,out]   storage     The statistics storage
+ * \param[in]       tid         The IVP index
+ */
+void store_counters(ivp_statistics* storage, const int tid)
+{
+    if (tid >= storage->num)
+        return;
+    for (int i = 0; i < NUM_STATS; ++i)
+        storage->stats[tid + i * storage->num] += stat_counters[i];
+}
+
+#ifdef SIMD_LANES
+/**
+ * \brief Zeros the lane counters of the current thread, called by the driver before each group of IVPs
+ */
+void clear_lane_counters()
+{
+    memset(lane_counters, 0, SIMD_LANES * NUM_STATS * sizeof(int));
+}
+
+/**
+ * \brief Adds the counters of `lane` of the current thread to the statistics of IVP `tid`
+ * \param[in,out]   storage     The statistics storage
+ * \param[in]       lane        The lane index
+ * \param[in]       tid         The IVP index
+ */
+void store_lane_counters(ivp_statistics* storage, const int lane, const int tid)
+{
+    if (tid >= storage->num)
+        return;
+    for (int i = 0; i < NUM_STATS; ++i)
+        storage->stats[tid + i * storage->num] += lane_counters[lane][i];
+}
+#endif
+
+/**
+ * \brief Copies the accumulated statistics into `stats`
+ * \param[in]       storage     The statistics storage
+ * \param[in]       NUM         The number of IVPs, must match the last call to reset_statistics
+ * \param[out]      stats       The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`
+ */
+void get_statistics(const ivp_statistics* storage, const int NUM, int* stats)
+{
+    if (NUM != storage->num)
+    {
+        printf("Error: requested statistics for %d IVPs, but %d were integrated.\n", NUM, storage->num);
+        exit(-1);
+    }
+    memcpy(stats, storage->stats, NUM * NUM_STATS * sizeof(int));
+}
+
+/**
+ * \brief Frees the statistics storage
+ * \param[in,out]   storage     The statistics storage
+ */
+void cleanup_statistics(ivp_statistics* storage)
+{
+    free(storage->stats);
+    storage->stats = 0;
+    storage->num = 0;
+}
+
+#else
+
+void reset_statistics(ivp_statistics* storage, const int NUM) {}
+void clear_counters() {}
+void store_counters(ivp_statistics* storage, const int tid) {}
+#ifdef SIMD_LANES
+void clear_lane_counters() {}
+void store_lane_counters(ivp_statistics* storage, const int lane, const int tid) {}
+#endif
+void get_statistics(const ivp_statistics* storage, const int NUM, int* stats)
+{
+    //no statistics are gathered
+    memset(stats, 0, NUM * NUM_STATS * sizeof(int));
+}
+void cleanup_statistics(ivp_statistics* storage) {}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
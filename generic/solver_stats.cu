@@ -0,0 +1,101 @@
+/**
+ * \file
+ * \brief Host storage for the per-IVP integrator statistics of the GPU solvers, @see ivp_statistics
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "solver_stats.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+/**
+ * \brief Zeros the accumulated host statistics for NUM IVPs (allocating storage as needed)
+ * \param[in,out]   storage     The host statistics
+ * \param[in]       NUM         The number of IVPs
+ */
+void reset_statistics(ivp_statistics* storage, const int NUM)
+{
+#ifdef STATISTICS
+    if (NUM != storage->num)
+    {
+        free(storage->stats);
+        storage->stats = (int*)malloc(NUM * NUM_STATS * sizeof(int));
+        storage->num = NUM;
+    }
+    memset(storage->stats, 0, NUM * NUM_STATS * sizeof(int));
+#endif
+}
+
+/**
+ * \brief Adds the statistics of a chunk of IVPs (copied back from the device) to the host statistics
+ * \param[in,out]   storage     The host statistics
+ * \param[in]       offset      The index of the first IVP in the chunk
+ * \param[in]       num_cond    The number of IVPs in the chunk
+ * \param[in]       pitch       The leading dimension of `chunk_stats`, i.e. the padded number of IVPs
+ * \param[in]       chunk_stats The chunk statistics, stored as `chunk_stats[tid + stat * pitch]`
+ */
+void accumulate_statistics(ivp_statistics* storage, const int offset, const int num_cond, const int pitch,
+                           const int* chunk_stats)
+{
+    if (offset + num_cond > storage->num)
+        return;
+    for (int i = 0; i < NUM_STATS; ++i)
+    {
+        for (int tid = 0; tid < num_cond; ++tid)
+        {
+            int index = storage->order == 0 ? offset + tid : storage->order[offset + tid];
+            storage->stats[index + i * storage->num] += chunk_stats[tid + i * pitch];
+        }
+    }
+}
+
+/**
+ * \brief Sets the mapping from the IVP indices seen by accumulate_statistics to the original IVP indices
+ * \param[in,out]   storage     The host statistics
+ * \param[in]       order       The mapping, `order[k]` is the original index of IVP `k`.  If NULL, the identity is used.
+ * @see warp_reorder_gather
+ */
+void set_statistics_order(ivp_statistics* storage, const int* order)
+{
+    storage->order = order;
+}
+
+/**
+ * \brief Copies the accumulated statistics into `stats`
+ * \param[in]       storage     The host statistics
+ * \param[in]       NUM         The number of IVPs, must match the last call to reset_statistics
+ * \param[out]      stats       The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`
+ */
+void get_statistics(const ivp_statistics* storage, const int NUM, int* stats)
+{
+#ifdef STATISTICS
+    if (NUM != storage->num)
+    {
+        printf("Error: requested statistics for %d IVPs, but %d were integrated.\n", NUM, storage->num);
+        exit(-1);
+    }
+    memcpy(stats, storage->stats, NUM * NUM_STATS * sizeof(int));
+#else
+    //no statistics are gathered
+    memset(stats, 0, NUM * NUM_STATS * sizeof(int));
+#endif
+}
+
+/**
+ * \brief Frees the host statistics storage
+ * \param[in,out]   storage     The host statistics
+ */
+void cleanup_statistics(ivp_statistics* storage)
+{
+    free(storage->stats);
+    storage->stats = 0;
+    storage->num = 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,122 @@
+/**
+ * \file
+ * \brief Definitions for the per-IVP integrator statistics of the GPU solvers
+ *
+ * If #STATISTICS is defined, each solver_memory struct contains a `stats` array of
+ * (#NUM_STATS * padded) counters, stored as `stats[INDEX(stat)]`.  The counters are zeroed at
+ * the start of each call to integrate(), and accumulated on the host after every kernel call.
+ * @see accelerInt_get_statistics
+ */
+
+#ifndef SOLVER_STATS_CUH
+#define SOLVER_STATS_CUH
+
+#include "solver_options.cuh"
+#include "gpu_macros.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+/**
+ * \brief The per-IVP statistics gathered
+ */
+enum StatisticIndex
+{
+    //! Accepted internal integration steps
+    STAT_STEPS = 0,
+    //! Rejected internal integration steps
+    STAT_REJECTED = 1,
+    //! Jacobian evaluations (spectral radius estimates for RKC)
+    STAT_JAC_EVALS = 2,
+    //! LU factorizations of the iteration matrix
+    STAT_LU_DECOMPS = 3,
+    //! Newton iterations
+    STAT_NEWTON_ITERS = 4,
+    //! Krylov subspace (Arnoldi) constructions
+    STAT_KRYLOV_CALLS = 5,
+    //! Sum of the resulting Krylov subspace sizes
+    STAT_KRYLOV_SIZE = 6,
+    //! Arnoldi vectors reused from a previous Krylov subspace, rather than recomputed @see KRYLOV_RECYCLE
+    STAT_KRYLOV_RECYCLED = 7,
+    //! Sum over the accepted steps of the age (in accepted steps) of the Jacobian used @see LAZY_JACOBIAN
+    STAT_JAC_AGE = 8,
+    //! Rejected steps taken with a reused Jacobian, each of which forces its re-evaluation @see LAZY_JACOBIAN
+    STAT_JAC_STALE_REJECTS = 9
+};
+
+//! The number of per-IVP statistics
+#define NUM_STATS (10)
+
+#ifdef STATISTICS
+    //! Increment the given statistic of this thread's IVP
+    #define STAT_INC(solver, stat) ((solver)->stats[INDEX(stat)] += 1)
+    //! Add `val` to the given statistic of this thread's IVP
+    #define STAT_ADD(solver, stat, val) ((solver)->stats[INDEX(stat)] += (val))
+    //! Zero the statistics of this thread's IVP
+    #define STAT_RESET(solver) for (int stat_i = 0; stat_i < NUM_STATS; ++stat_i) (solver)->stats[INDEX(stat_i)] = 0
+#else
+    #define STAT_INC(solver, stat)
+    #define STAT_ADD(solver, stat, val)
+    #define STAT_RESET(solver)
+#endif
+
+/**
+ * \brief The accumulated host statistics of a solver instance
+ * \param           num         The number of IVPs in #stats
+ * \param           stats       The accumulated per-IVP statistics, stored as `stats[tid + stat * num]`
+ * \param           order       The optional mapping of the accumulated IVP indices to the original IVP indices
+ *
+ * Zero-initialize before the first call to reset_statistics.
+ */
+struct ivp_statistics {
+    int num;
+    int* stats;
+    const int* order;
+};
+
+/**
+ * \brief Zeros the accumulated host statistics for NUM IVPs (allocating storage as needed)
+ * \param[in,out]   storage     The host statistics
+ * \param[in]       NUM         The number of IVPs
+ */
+void reset_statistics(ivp_statistics* storage, const int NUM);
+
+/**
+ * \brief Adds the statistics of a chunk of IVPs (copied back from the device) to the host statistics
+ * \param[in,out]   storage     The host statistics
+ * \param[in]       offset      The index of the first IVP in the chunk
+ * \param[in]       num_cond    The number of IVPs in the chunk
+ * \param[in]       pitch       The leading dimension of `chunk_stats`, i.e. the padded number of IVPs
+ * \param[in]       chunk_stats The chunk statistics, stored as `chunk_stats[tid + stat * pitch]`
+ */
+void accumulate_statistics(ivp_statistics* storage, const int offset, const int num_cond, const int pitch,
+                           const int* chunk_stats);
+
+/**
+ * \brief Sets the mapping from the IVP indices seen by accumulate_statistics to the original IVP indices
+ * \param[in,out]   storage     The host statistics
+ * \param[in]       order       The mapping, `order[k]` is the original index of IVP `k`.  If NULL, the identity is used.
+ * @see warp_reorder_gather
+ */
+void set_statistics_order(ivp_statistics* storage, const int* order);
+
+/**
+ * \brief Copies the accumulated statistics into `stats`
+ * \param[in]       storage     The host statistics
+ * \param[in]       NUM         The number of IVPs, must match the last call to reset_statistics
+ * \param[out]      stats       The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`
+ */
+void get_statistics(const ivp_statistics* storage, const int NUM, int* stats);
+
+/**
+ * \brief Frees the host statistics storage
+ * \param[in,out]   storage     The host statistics
+ */
+void cleanup_statistics(ivp_statistics* storage);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * \file
+ * \brief Definitions for the per-IVP integrator statistics of the CPU solvers
+ *
+ * If #STATISTICS is defined, each integrator counts its internal work in the
+ * (OpenMP thread-private) stat_counters array, which the integration driver accumulates
+ * into the column-major (`stats[tid + stat * NUM]`) ivp_statistics of the solver instance after every IVP.
+ * @see accelerInt_get_statistics
+ */
+
+#ifndef SOLVER_STATS_H
+#define SOLVER_STATS_H
+
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief The per-IVP statistics gathered
+ */
+enum StatisticIndex
+{
+    //! Accepted internal integration steps
+    STAT_STEPS = 0,
+    //! Rejected internal integration steps
+    STAT_REJECTED = 1,
+    //! Jacobian evaluations (spectral radius estimates for RKC)
+    STAT_JAC_EVALS = 2,
+    //! LU factorizations of the iteration matrix
+    STAT_LU_DECOMPS = 3,
+    //! Newton iterations
+    STAT_NEWTON_ITERS = 4,
+    //! Krylov subspace (Arnoldi) constructions
+    STAT_KRYLOV_CALLS = 5,
+    //! Sum of the resulting Krylov subspace sizes
+    STAT_KRYLOV_SIZE = 6,
+    //! Arnoldi vectors reused from a previous Krylov subspace, rather than recomputed @see KRYLOV_RECYCLE
+    STAT_KRYLOV_RECYCLED = 7,
+    //! Sum over the accepted steps of the age (in accepted steps) of the Jacobian used @see LAZY_JACOBIAN
+    STAT_JAC_AGE = 8,
+    //! Rejected steps taken with a reused Jacobian, each of which forces its re-evaluation @see LAZY_JACOBIAN
+    STAT_JAC_STALE_REJECTS = 9
+};
+
+//! The number of per-IVP statistics
+#define NUM_STATS (10)
+
+#ifdef STATISTICS
+    //! The statistics of the IVP currently integrated by this thread
+    extern int stat_counters[NUM_STATS];
+    #pragma omp threadprivate(stat_counters)
+
+    //! Increment the given statistic of the current IVP
+    #define STAT_INC(stat) (stat_counters[(stat)] += 1)
+    //! Add `val` to the given statistic of the current IVP
+    #define STAT_ADD(stat, val) (stat_counters[(stat)] += (val))
+    #ifdef SIMD_LANES
+        //! The statistics of the IVPs currently integrated in lockstep by this thread
+        extern int lane_counters[SIMD_LANES][NUM_STATS];
+        #pragma omp threadprivate(lane_counters)
+
+        //! Increment the given statistic of the IVP in `lane`
+        #define STAT_LANE_INC(lane, stat) (lane_counters[(lane)][(stat)] += 1)
+    #endif
+#else
+    #define STAT_INC(stat)
+    #define STAT_ADD(stat, val)
+    #define STAT_LANE_INC(lane, stat)
+#endif
+
+/**
+ * \brief The accumulated per-IVP statistics of a solver instance
+ * \param           num         The number of IVPs in #stats
+ * \param           stats       The accumulated statistics, stored as `stats[tid + stat * num]`
+ *
+ * Zero-initialize before the first call to reset_statistics.
+ */
+typedef struct
+{
+    int num;
+    int* stats;
+} ivp_statistics;
+
+/**
+ * \brief Zeros the accumulated statistics for NUM IVPs (allocating storage as needed)
+ * \param[in,out]   storage     The statistics storage
+ * \param[in]       NUM         The number of IVPs
+ */
+void reset_statistics(ivp_statistics* storage, const int NUM);
+
+/**
+ * \brief Zeros the counters of the current thread, called by the driver before each IVP
+ */
+void clear_counters();
+
+/**
+ * \brief Adds the counters of the current thread to the statistics of IVP `tid`
+ * \param[in,out]   storage     The statistics storage
+ * \param[in]       tid         The IVP index
+ */
+void store_counters(ivp_statistics* storage, const int tid);
+
+#ifdef SIMD_LANES
+/**
+ * \brief Zeros the lane counters of the current thread, called by the driver before each group of IVPs
+ */
+void clear_lane_counters();
+
+/**
+ * \brief Adds the counters of `lane` of the current thread to the statistics of IVP `tid`
+ * \param[in,out]   storage     The statistics storage
+ * \param[in]       lane        The lane index
+ * \param[in]       tid         The IVP index
+ */
+void store_lane_counters(ivp_statistics* storage, const int lane, const int tid);
+#endif
+
+/**
+ * \brief Copies the accumulated statistics into `stats`
+ * \param[in]       storage     The statistics storage
+ * \param[in]       NUM         The number of IVPs, must match the last call to reset_statistics
+ * \param[out]      stats       The (NUM * #NUM_STATS) statistics array, stored as `stats[tid + stat * NUM]`
+ */
+void get_statistics(const ivp_statistics* storage, const int NUM, int* stats);
+
+/**
+ * \brief Frees the statistics storage
+ * \param[in,out]   storage     The statistics storage
+ */
+void cleanup_statistics(ivp_statistics* storage);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * \file
+ * \brief The (optionally compressed) storage of the Jacobian of the GPU solvers
+ *
+ * As for the CPU solvers (@see sparse_jacobian.h), if #SPARSE_JACOBIAN is defined the mechanism's eval_jacob
+ * stores only the structural nonzeros of its `jac_pattern.h` in compressed sparse column order, such that
+ * mechanism_memory::jac holds #JAC_SIZE (rather than NSP x NSP) doubles per thread, stored as `jac[INDEX(n)]`.
+ * The pattern is shared by all threads, and lives in constant memory.
+ */
+
+#ifndef SPARSE_JACOBIAN_CUH
+#define SPARSE_JACOBIAN_CUH
+
+#include "header.cuh"
+#include "solver_options.cuh"
+#include "gpu_macros.cuh"
+#include <cuComplex.h>
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef SPARSE_JACOBIAN
+#include "jac_pattern.h"
+
+//! The number of doubles of a Jacobian (per thread)
+#define JAC_SIZE (JAC_NNZ)
+
+//! The start of each column in the compressed Jacobian, @see JAC_COL_START
+static __constant__ int d_jac_col_start[NSP + 1] = JAC_COL_START;
+//! The row of each entry of the compressed Jacobian, @see JAC_ROW_INDEX
+static __constant__ int d_jac_row_index[JAC_NNZ] = JAC_ROW_INDEX;
+#else
+//! The number of doubles of a Jacobian (per thread)
+#define JAC_SIZE (NSP * NSP)
+#endif
+
+/**
+ * \brief Fills the (host) structural nonzero pattern `mask[i + j * NSP]` of the Jacobian, i.e. all entries if not compressed
+ */
+static inline void jacobian_pattern(bool* mask)
+{
+#ifdef SPARSE_JACOBIAN
+    const int col_start[NSP + 1] = JAC_COL_START;
+    const int row_index[JAC_NNZ] = JAC_ROW_INDEX;
+    for (int i = 0; i < NSP * NSP; ++i)
+        mask[i] = false;
+    for (int j = 0; j < NSP; ++j)
+    {
+        for (int n = col_start[j]; n < col_start[j + 1]; ++n)
+            mask[row_index[n] + j * NSP] = true;
+    }
+#else
+    for (int i = 0; i < NSP * NSP; ++i)
+        mask[i] = true;
+#endif
+}
+
+/**
+ * \brief Computes \f$w := w + J v\f$ for the Jacobian `jac`
+ */
+__device__ __forceinline__
+void jacobian_multiply_add(const double* __restrict__ jac, const double* __restrict__ v, double* __restrict__ w)
+{
+    #pragma unroll 8
+    for (int j = 0; j < NSP; ++j)
+    {
+#ifdef SPARSE_JACOBIAN
+        for (int n = d_jac_col_start[j]; n < d_jac_col_start[j + 1]; ++n)
+            w[INDEX(d_jac_row_index[n])] += jac[INDEX(n)] * v[INDEX(j)];
+#else
+        #pragma unroll 8
+        for (int i = 0; i < NSP; ++i)
+            w[INDEX(i)] += jac[INDEX(i + j * NSP)] * v[INDEX(j)];
+#endif
+    }
+}
+
+/**
+ * \brief Computes \f$w_0 := w_0 + J v_0\f$ and \f$w_1 := w_1 + J v_1\f$ in a single pass over the Jacobian `jac`
+ */
+__device__ __forceinline__
+void jacobian_multiply_add2(const double* __restrict__ jac, const double* __restrict__ v0,
+                            const double* __restrict__ v1, double* __restrict__ w0, double* __restrict__ w1)
+{
+    #pragma unroll 8
+    for (int j = 0; j < NSP; ++j)
+    {
+#ifdef SPARSE_JACOBIAN
+        for (int n = d_jac_col_start[j]; n < d_jac_col_start[j + 1]; ++n)
+        {
+            const int i = d_jac_row_index[n];
+            w0[INDEX(i)] += jac[INDEX(n)] * v0[INDEX(j)];
+            w1[INDEX(i)] += jac[INDEX(n)] * v1[INDEX(j)];
+        }
+#else
+        #pragma unroll 8
+        for (int i = 0; i < NSP; ++i)
+        {
+            w0[INDEX(i)] += jac[INDEX(i + j * NSP)] * v0[INDEX(j)];
+            w1[INDEX(i)] += jac[INDEX(i + j * NSP)] * v1[INDEX(j)];
+        }
+#endif
+    }
+}
+
+/**
+ * \brief Computes \f$w := w + J v\f$ for the Jacobian `jac` and complex vectors
+ */
+__device__ __forceinline__
+void jacobian_multiply_add_complex(const double* __restrict__ jac, const cuDoubleComplex* __restrict__ v,
+                                   cuDoubleComplex* __restrict__ w)
+{
+    #pragma unroll 8
+    for (int j = 0; j < NSP; ++j)
+    {
+#ifdef SPARSE_JACOBIAN
+        for (int n = d_jac_col_start[j]; n < d_jac_col_start[j + 1]; ++n)
+        {
+            const int i = d_jac_row_index[n];
+            w[INDEX(i)] = make_cuDoubleComplex(cuCreal(w[INDEX(i)]) + jac[INDEX(n)] * cuCreal(v[INDEX(j)]),
+                                               cuCimag(w[INDEX(i)]) + jac[INDEX(n)] * cuCimag(v[INDEX(j)]));
+        }
+#else
+        #pragma unroll 8
+        for (int i = 0; i < NSP; ++i)
+            w[INDEX(i)] = make_cuDoubleComplex(cuCreal(w[INDEX(i)]) + jac[INDEX(i + j * NSP)] * cuCreal(v[INDEX(j)]),
+                                               cuCimag(w[INDEX(i)]) + jac[INDEX(i + j * NSP)] * cuCimag(v[INDEX(j)]));
+#endif
+    }
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
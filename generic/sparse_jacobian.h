@@ -0,0 +1,164 @@
+/**
+ * \file
+ * \brief The (optionally compressed) storage of the Jacobian of the CPU solvers
+ *
+ * By default, eval_jacob fills the dense, column-major (NSP x NSP) Jacobian `jac[i + j * NSP]`.
+ * If #SPARSE_JACOBIAN is defined, the mechanism instead stores only the structural nonzeros of the
+ * Jacobian, in the compressed sparse column order of a mechanism-wide pattern supplied by its `jac_pattern.h`:
+ *  - `JAC_NNZ`, the number of structural nonzeros
+ *  - `JAC_COL_START`, the (NSP + 1) column starts, i.e. the entries of column `j` are
+ *    `jac[JAC_COL_START[j]]`...`jac[JAC_COL_START[j + 1] - 1]`
+ *  - `JAC_ROW_INDEX`, the (JAC_NNZ) rows of the entries, ascending within each column
+ *
+ * That is, the entries are those of the dense Jacobian with the structural zeros removed, and each Jacobian
+ * takes #JAC_SIZE doubles.  The functions below let the solvers treat both storages alike.
+ */
+
+#ifndef SPARSE_JACOBIAN_H
+#define SPARSE_JACOBIAN_H
+
+#include "header.h"
+#include "solver_options.h"
+#include <stdbool.h>
+#include <complex.h>
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef SPARSE_JACOBIAN
+#include "jac_pattern.h"
+
+//! The number of doubles of a Jacobian
+#define JAC_SIZE (JAC_NNZ)
+
+//! The start of each column in the compressed Jacobian, @see JAC_COL_START
+static const int jac_col_start[NSP + 1] = JAC_COL_START;
+//! The row of each entry of the compressed Jacobian, @see JAC_ROW_INDEX
+static const int jac_row_index[JAC_NNZ] = JAC_ROW_INDEX;
+#else
+//! The number of doubles of a Jacobian
+#define JAC_SIZE (NSP * NSP)
+#endif
+
+/**
+ * \brief Fills the structural nonzero pattern `mask[i + j * NSP]` of the Jacobian, i.e. all entries if not compressed
+ */
+static inline void jacobian_pattern(bool* mask)
+{
+#ifdef SPARSE_JACOBIAN
+    for (int i = 0; i < NSP * NSP; ++i)
+        mask[i] = false;
+    for (int j = 0; j < NSP; ++j)
+    {
+        for (int n = jac_col_start[j]; n < jac_col_start[j + 1]; ++n)
+            mask[jac_row_index[n] + j * NSP] = true;
+    }
+#else
+    for (int i = 0; i < NSP * NSP; ++i)
+        mask[i] = true;
+#endif
+}
+
+/**
+ * \brief Returns the entry (i, j) of the Jacobian `jac`
+ *
+ * Searches column `j` if compressed, hence is meant for gathering (sub-)blocks rather than the inner loops.
+ */
+static inline double jacobian_entry(const double* jac, const int i, const int j)
+{
+#ifdef SPARSE_JACOBIAN
+    for (int n = jac_col_start[j]; n < jac_col_start[j + 1] && jac_row_index[n] <= i; ++n)
+    {
+        if (jac_row_index[n] == i)
+            return jac[n];
+    }
+    return 0;
+#else
+    return jac[i + j * NSP];
+#endif
+}
+
+/**
+ * \brief Adds `alpha` times the Jacobian `jac` to the dense, column-major matrix `dense[i + j * ld]`
+ */
+static inline void jacobian_scatter_add(const double* jac, const double alpha, double* dense, const int ld)
+{
+    for (int j = 0; j < NSP; ++j)
+    {
+#ifdef SPARSE_JACOBIAN
+        for (int n = jac_col_start[j]; n < jac_col_start[j + 1]; ++n)
+            dense[jac_row_index[n] + j * ld] += alpha * jac[n];
+#else
+        for (int i = 0; i < NSP; ++i)
+            dense[i + j * ld] += alpha * jac[i + j * NSP];
+#endif
+    }
+}
+
+/**
+ * \brief Computes \f$w := w + J v\f$ for the Jacobian `jac`
+ */
+static inline void jacobian_multiply_add(const double* __restrict__ jac, const double* __restrict__ v,
+                                         double* __restrict__ w)
+{
+    for (int j = 0; j < NSP; ++j)
+    {
+#ifdef SPARSE_JACOBIAN
+        for (int n = jac_col_start[j]; n < jac_col_start[j + 1]; ++n)
+            w[jac_row_index[n]] += jac[n] * v[j];
+#else
+        for (int i = 0; i < NSP; ++i)
+            w[i] += jac[i + j * NSP] * v[j];
+#endif
+    }
+}
+
+/**
+ * \brief Computes \f$w_0 := w_0 + J v_0\f$ and \f$w_1 := w_1 + J v_1\f$ in a single pass over the Jacobian `jac`
+ */
+static inline void jacobian_multiply_add2(const double* __restrict__ jac, const double* __restrict__ v0,
+                                          const double* __restrict__ v1, double* __restrict__ w0,
+                                          double* __restrict__ w1)
+{
+    for (int j = 0; j < NSP; ++j)
+    {
+#ifdef SPARSE_JACOBIAN
+        for (int n = jac_col_start[j]; n < jac_col_start[j + 1]; ++n)
+        {
+            w0[jac_row_index[n]] += jac[n] * v0[j];
+            w1[jac_row_index[n]] += jac[n] * v1[j];
+        }
+#else
+        for (int i = 0; i < NSP; ++i)
+        {
+            w0[i] += jac[i + j * NSP] * v0[j];
+            w1[i] += jac[i + j * NSP] * v1[j];
+        }
+#endif
+    }
+}
+
+/**
+ * \brief Computes \f$w := w + J v\f$ for the Jacobian `jac` and complex vectors
+ */
+static inline void jacobian_multiply_add_complex(const double* __restrict__ jac, const double complex* __restrict__ v,
+                                                 double complex* __restrict__ w)
+{
+    for (int j = 0; j < NSP; ++j)
+    {
+#ifdef SPARSE_JACOBIAN
+        for (int n = jac_col_start[j]; n < jac_col_start[j + 1]; ++n)
+            w[jac_row_index[n]] += jac[n] * v[j];
+#else
+        for (int i = 0; i < NSP; ++i)
+            w[i] += jac[i + j * NSP] * v[j];
+#endif
+    }
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,272 @@
+/**
+ * \file
+ * \brief Implementation of the sparse (statically pivoted) LU factorization of the CPU solvers
+ *
+ * \see sparse_lu.h
+ */
+
+#include "sparse_lu.h"
+#include "jacob.h"
+#include "sparse_jacobian.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef SPARSE_LU
+
+//! The nonzero pattern of the factors (the Jacobian, the diagonal and the fill-in), stored as `lu_pattern[i + j * NSP]`
+static bool lu_pattern[NSP * NSP];
+//! The rows of the subdiagonal entries of column `k` of L are `lower_index[lower_ptr[k]]`...`lower_index[lower_ptr[k + 1] - 1]`
+static int lower_ptr[NSP + 1];
+//! The row indicies of the subdiagonal entries of L, @see lower_ptr
+static int* lower_index = NULL;
+//! The columns of the superdiagonal entries of row `k` of U are `upper_index[upper_ptr[k]]`...`upper_index[upper_ptr[k + 1] - 1]`
+static int upper_ptr[NSP + 1];
+//! The column indicies of the superdiagonal entries of U, @see upper_ptr
+static int* upper_index = NULL;
+//! Nonzero once the symbolic factorization is computed
+static int analyzed = 0;
+
+/**
+ * \brief Computes the symbolic factorization (without pivoting) of a matrix with the nonzero pattern `mask`
+ * \param[in]       mask        The nonzero pattern, stored as `mask[i + j * NSP]`
+ */
+static void sparse_lu_analyze(const bool* mask)
+{
+    memcpy(lu_pattern, mask, NSP * NSP * sizeof(bool));
+    for (int k = 0; k < NSP; ++k)
+        lu_pattern[k + k * NSP] = true;
+
+    // eliminating column k fills in (i, j) for every nonzero (i, k) and (k, j)
+    for (int k = 0; k < NSP; ++k)
+    {
+        for (int i = k + 1; i < NSP; ++i)
+        {
+            if (!lu_pattern[i + k * NSP])
+                continue;
+            for (int j = k + 1; j < NSP; ++j)
+            {
+                if (lu_pattern[k + j * NSP])
+                    lu_pattern[i + j * NSP] = true;
+            }
+        }
+    }
+
+    int num_lower = 0;
+    int num_upper = 0;
+    for (int j = 0; j < NSP; ++j)
+    {
+        for (int i = 0; i < NSP; ++i)
+        {
+            if (!lu_pattern[i + j * NSP])
+                continue;
+            if (i > j)
+                num_lower++;
+            else if (i < j)
+                num_upper++;
+        }
+    }
+    free(lower_index);
+    free(upper_index);
+    lower_index = (int*)malloc((num_lower > 0 ? num_lower : 1) * sizeof(int));
+    upper_index = (int*)malloc((num_upper > 0 ? num_upper : 1) * sizeof(int));
+    if (lower_index == NULL || upper_index == NULL)
+    {
+        printf("Error: could not allocate the sparse LU factorization.\n");
+        exit(-1);
+    }
+    num_lower = 0;
+    num_upper = 0;
+    for (int k = 0; k < NSP; ++k)
+    {
+        lower_ptr[k] = num_lower;
+        upper_ptr[k] = num_upper;
+        for (int i = k + 1; i < NSP; ++i)
+        {
+            if (lu_pattern[i + k * NSP])
+                lower_index[num_lower++] = i;
+        }
+        for (int j = k + 1; j < NSP; ++j)
+        {
+            if (lu_pattern[k + j * NSP])
+                upper_index[num_upper++] = j;
+        }
+    }
+    lower_ptr[NSP] = num_lower;
+    upper_ptr[NSP] = num_upper;
+}
+
+void sparse_lu_init(const double t, const double pr, const double* y)
+{
+    int done;
+    #pragma omp atomic read
+    done = analyzed;
+    if (done)
+        return;
+
+    #pragma omp critical(sparse_lu_init)
+    {
+        if (!analyzed)
+        {
+            bool* mask = (bool*)calloc(NSP * NSP, sizeof(bool));
+#ifdef SPARSE_JACOBIAN
+            // the structural pattern of the mechanism
+            jacobian_pattern(mask);
+#else
+            double* jac = (double*)malloc(NSP * NSP * sizeof(double));
+            double y_pert[NSP];
+            for (int k = 0; k < 3; ++k)
+            {
+                for (int i = 0; i < NSP; ++i)
+                    y_pert[i] = y[i] + 0.1 * k * (fabs(y[i]) + 1e-3);
+                eval_jacob(t, pr, y_pert, jac);
+                for (int i = 0; i < NSP * NSP; ++i)
+                    mask[i] = mask[i] || jac[i] != 0;
+            }
+            free(jac);
+#endif
+            sparse_lu_analyze(mask);
+            free(mask);
+            #pragma omp flush
+            #pragma omp atomic write
+            analyzed = 1;
+        }
+    }
+}
+
+bool sparse_lu_in_pattern(const double* A)
+{
+#ifdef SPARSE_JACOBIAN
+    // the compressed Jacobian has no entries outside of the pattern
+    (void)A;
+#else
+    for (int i = 0; i < NSP * NSP; ++i)
+    {
+        if (!lu_pattern[i] && A[i] != 0)
+            return false;
+    }
+#endif
+    return true;
+}
+
+int sparse_lu_factor(double* A)
+{
+    for (int k = 0; k < NSP; ++k)
+    {
+        const double pivot = A[k + k * NSP];
+        double col_max = 0;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            col_max = fmax(col_max, fabs(A[lower_index[l] + k * NSP]));
+        if (pivot == 0 || fabs(pivot) < SPARSE_LU_PIVOT_TOL * col_max)
+            return k + 1;
+
+        const double inv = 1.0 / pivot;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            A[lower_index[l] + k * NSP] *= inv;
+        for (int u = upper_ptr[k]; u < upper_ptr[k + 1]; ++u)
+        {
+            const int j = upper_index[u];
+            const double a_kj = A[k + j * NSP];
+            if (a_kj == 0)
+                continue;
+            for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            {
+                const int i = lower_index[l];
+                A[i + j * NSP] -= A[i + k * NSP] * a_kj;
+            }
+        }
+    }
+    return 0;
+}
+
+int sparse_lu_factor_complex(double complex* A)
+{
+    for (int k = 0; k < NSP; ++k)
+    {
+        const double complex pivot = A[k + k * NSP];
+        double col_max = 0;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            col_max = fmax(col_max, cabs(A[lower_index[l] + k * NSP]));
+        if (pivot == 0 || cabs(pivot) < SPARSE_LU_PIVOT_TOL * col_max)
+            return k + 1;
+
+        const double complex inv = 1.0 / pivot;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            A[lower_index[l] + k * NSP] *= inv;
+        for (int u = upper_ptr[k]; u < upper_ptr[k + 1]; ++u)
+        {
+            const int j = upper_index[u];
+            const double complex a_kj = A[k + j * NSP];
+            if (a_kj == 0)
+                continue;
+            for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            {
+                const int i = lower_index[l];
+                A[i + j * NSP] -= A[i + k * NSP] * a_kj;
+            }
+        }
+    }
+    return 0;
+}
+
+void sparse_lu_solve(const double* LU, double* b)
+{
+    // forward substitution, L has a unit diagonal
+    for (int k = 0; k < NSP; ++k)
+    {
+        const double b_k = b[k];
+        if (b_k == 0)
+            continue;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            b[lower_index[l]] -= LU[lower_index[l] + k * NSP] * b_k;
+    }
+    // back substitution
+    for (int k = NSP - 1; k >= 0; --k)
+    {
+        double sum = b[k];
+        for (int u = upper_ptr[k]; u < upper_ptr[k + 1]; ++u)
+            sum -= LU[k + upper_index[u] * NSP] * b[upper_index[u]];
+        b[k] = sum / LU[k + k * NSP];
+    }
+}
+
+void sparse_lu_solve_complex(const double complex* LU, double complex* b)
+{
+    // forward substitution, L has a unit diagonal
+    for (int k = 0; k < NSP; ++k)
+    {
+        const double complex b_k = b[k];
+        if (b_k == 0)
+            continue;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            b[lower_index[l]] -= LU[lower_index[l] + k * NSP] * b_k;
+    }
+    // back substitution
+    for (int k = NSP - 1; k >= 0; --k)
+    {
+        double complex sum = b[k];
+        for (int u = upper_ptr[k]; u < upper_ptr[k + 1]; ++u)
+            sum -= LU[k + upper_index[u] * NSP] * b[upper_index[u]];
+        b[k] = sum / LU[k + k * NSP];
+    }
+}
+
+void cleanup_sparse_lu()
+{
+    free(lower_index);
+    free(upper_index);
+    lower_index = NULL;
+    upper_index = NULL;
+    analyzed = 0;
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,300 @@
+/**
+ * \file
+ * \brief Implementation of the sparse (statically pivoted) LU factorization of the GPU solvers
+ *
+ * \see sparse_lu.cuh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sparse_lu.cuh"
+#include "gpu_memory.cuh"
+#include "gpu_macros.cuh"
+#include "sparse_jacobian.cuh"
+#ifndef FINITE_DIFFERENCE
+#include "jacob.cuh"
+#else
+#include "fd_jacob.cuh"
+#endif
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef SPARSE_LU
+
+#ifndef SPARSE_JACOBIAN
+/**
+ * \brief Accumulates the nonzero pattern of the Jacobian at three synthetic states
+ * \param[in]       d_mem       The mechanism memory (allocated for a single thread)
+ * \param[in]       work        A (2 * NSP) work array for the finite difference Jacobian
+ * \param[in,out]   mask        The (zeroed) nonzero pattern, stored as `mask[i + j * NSP]`
+ *
+ * Launched with a single thread, such that `INDEX(i) == i`
+ */
+__global__
+void sparse_lu_detect(const mechanism_memory* __restrict__ d_mem, double* __restrict__ work, bool* __restrict__ mask)
+{
+    double* const __restrict__ y = d_mem->y;
+    double* const __restrict__ jac = d_mem->jac;
+    for (int k = 0; k < 3; ++k)
+    {
+        y[INDEX(0)] = 1000.0 + 250.0 * k;
+        for (int i = 1; i < NSP; ++i)
+            y[INDEX(i)] = (1.0 + 0.5 * k + 0.01 * i) / NSP;
+#ifndef FINITE_DIFFERENCE
+        eval_jacob(0, 101325.0 * (1 + k), y, jac, d_mem);
+#else
+        eval_jacob(0, 101325.0 * (1 + k), y, jac, d_mem, work, &work[NSP]);
+#endif
+        for (int i = 0; i < NSP * NSP; ++i)
+            mask[i] = mask[i] || jac[INDEX(i)] != 0;
+    }
+}
+#endif
+
+// host code, not compiled by NVRTC (@see nvrtc_kernels.cuh)
+#ifndef __CUDACC_RTC__
+/**
+ * \brief Copies `count` entries of the host array `src` to (newly allocated) device memory
+ */
+template <typename T>
+static T* copy_to_device(const T* src, const int count)
+{
+    T* dst = 0;
+    cudaErrorCheck( cudaMalloc((void**)&dst, (count > 0 ? count : 1) * sizeof(T)) );
+    if (count > 0)
+        cudaErrorCheck( cudaMemcpy(dst, src, count * sizeof(T), cudaMemcpyHostToDevice) );
+    return dst;
+}
+
+void initialize_sparse_lu(sparse_lu_pattern* lu)
+{
+    bool* pattern = (bool*)malloc(NSP * NSP * sizeof(bool));
+#ifdef SPARSE_JACOBIAN
+    // the structural pattern of the mechanism
+    jacobian_pattern(pattern);
+#else
+    // evaluate the Jacobian on the device
+    mechanism_memory* h_mech = (mechanism_memory*)malloc(sizeof(mechanism_memory));
+    mechanism_memory* d_mech = 0;
+    initialize_gpu_memory(1, &h_mech, &d_mech);
+    double* d_work = 0;
+    cudaErrorCheck( cudaMalloc((void**)&d_work, 2 * NSP * sizeof(double)) );
+    bool* d_mask = 0;
+    cudaErrorCheck( cudaMalloc((void**)&d_mask, NSP * NSP * sizeof(bool)) );
+    cudaErrorCheck( cudaMemset(d_mask, 0, NSP * NSP * sizeof(bool)) );
+    sparse_lu_detect <<< 1, 1 >>> (d_mech, d_work, d_mask);
+    cudaErrorCheck( cudaPeekAtLastError() );
+    cudaErrorCheck( cudaMemcpy(pattern, d_mask, NSP * NSP * sizeof(bool), cudaMemcpyDeviceToHost) );
+    cudaErrorCheck( cudaFree(d_mask) );
+    cudaErrorCheck( cudaFree(d_work) );
+    free_gpu_memory(&h_mech, &d_mech);
+    free(h_mech);
+#endif
+
+    // symbolic factorization, eliminating column k fills in (i, j) for every nonzero (i, k) and (k, j)
+    for (int k = 0; k < NSP; ++k)
+        pattern[k + k * NSP] = true;
+    for (int k = 0; k < NSP; ++k)
+    {
+        for (int i = k + 1; i < NSP; ++i)
+        {
+            if (!pattern[i + k * NSP])
+                continue;
+            for (int j = k + 1; j < NSP; ++j)
+            {
+                if (pattern[k + j * NSP])
+                    pattern[i + j * NSP] = true;
+            }
+        }
+    }
+
+    int lower_ptr[NSP + 1];
+    int upper_ptr[NSP + 1];
+    int* lower_index = (int*)malloc(NSP * NSP * sizeof(int));
+    int* upper_index = (int*)malloc(NSP * NSP * sizeof(int));
+    int num_lower = 0;
+    int num_upper = 0;
+    for (int k = 0; k < NSP; ++k)
+    {
+        lower_ptr[k] = num_lower;
+        upper_ptr[k] = num_upper;
+        for (int i = k + 1; i < NSP; ++i)
+        {
+            if (pattern[i + k * NSP])
+                lower_index[num_lower++] = i;
+        }
+        for (int j = k + 1; j < NSP; ++j)
+        {
+            if (pattern[k + j * NSP])
+                upper_index[num_upper++] = j;
+        }
+    }
+    lower_ptr[NSP] = num_lower;
+    upper_ptr[NSP] = num_upper;
+
+    lu->pattern = copy_to_device(pattern, NSP * NSP);
+    lu->lower_ptr = copy_to_device(lower_ptr, NSP + 1);
+    lu->lower_index = copy_to_device(lower_index, num_lower);
+    lu->upper_ptr = copy_to_device(upper_ptr, NSP + 1);
+    lu->upper_index = copy_to_device(upper_index, num_upper);
+    free(pattern);
+    free(lower_index);
+    free(upper_index);
+}
+
+void cleanup_sparse_lu(sparse_lu_pattern* lu)
+{
+    cudaErrorCheck( cudaFree(lu->pattern) );
+    cudaErrorCheck( cudaFree(lu->lower_ptr) );
+    cudaErrorCheck( cudaFree(lu->lower_index) );
+    cudaErrorCheck( cudaFree(lu->upper_ptr) );
+    cudaErrorCheck( cudaFree(lu->upper_index) );
+}
+#endif
+
+__device__
+bool sparse_lu_in_pattern(const sparse_lu_pattern* __restrict__ lu, const double* __restrict__ A)
+{
+    // a compressed Jacobian has no entries outside of the pattern
+#ifndef SPARSE_JACOBIAN
+    for (int i = 0; i < NSP * NSP; ++i)
+    {
+        if (!lu->pattern[i] && A[INDEX(i)] != 0)
+            return false;
+    }
+#endif
+    return true;
+}
+
+__device__
+int sparse_lu_factor(const sparse_lu_pattern* __restrict__ lu, double* __restrict__ A)
+{
+    const int* __restrict__ lower_ptr = lu->lower_ptr;
+    const int* __restrict__ lower_index = lu->lower_index;
+    const int* __restrict__ upper_ptr = lu->upper_ptr;
+    const int* __restrict__ upper_index = lu->upper_index;
+    for (int k = 0; k < NSP; ++k)
+    {
+        const double pivot = A[INDEX(k + k * NSP)];
+        double col_max = 0;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            col_max = fmax(col_max, fabs(A[INDEX(lower_index[l] + k * NSP)]));
+        if (pivot == 0 || fabs(pivot) < SPARSE_LU_PIVOT_TOL * col_max)
+            return k + 1;
+
+        const double inv = 1.0 / pivot;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            A[INDEX(lower_index[l] + k * NSP)] *= inv;
+        for (int u = upper_ptr[k]; u < upper_ptr[k + 1]; ++u)
+        {
+            const int j = upper_index[u];
+            const double a_kj = A[INDEX(k + j * NSP)];
+            if (a_kj == 0)
+                continue;
+            for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            {
+                const int i = lower_index[l];
+                A[INDEX(i + j * NSP)] -= A[INDEX(i + k * NSP)] * a_kj;
+            }
+        }
+    }
+    return 0;
+}
+
+__device__
+int sparse_lu_factor_complex(const sparse_lu_pattern* __restrict__ lu, cuDoubleComplex* __restrict__ A)
+{
+    const int* __restrict__ lower_ptr = lu->lower_ptr;
+    const int* __restrict__ lower_index = lu->lower_index;
+    const int* __restrict__ upper_ptr = lu->upper_ptr;
+    const int* __restrict__ upper_index = lu->upper_index;
+    for (int k = 0; k < NSP; ++k)
+    {
+        const cuDoubleComplex pivot = A[INDEX(k + k * NSP)];
+        double col_max = 0;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            col_max = fmax(col_max, cuCabs(A[INDEX(lower_index[l] + k * NSP)]));
+        if (cuCabs(pivot) == 0 || cuCabs(pivot) < SPARSE_LU_PIVOT_TOL * col_max)
+            return k + 1;
+
+        const cuDoubleComplex inv = cuCdiv(make_cuDoubleComplex(1.0, 0.0), pivot);
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            A[INDEX(lower_index[l] + k * NSP)] = cuCmul(A[INDEX(lower_index[l] + k * NSP)], inv);
+        for (int u = upper_ptr[k]; u < upper_ptr[k + 1]; ++u)
+        {
+            const int j = upper_index[u];
+            const cuDoubleComplex a_kj = A[INDEX(k + j * NSP)];
+            if (cuCreal(a_kj) == 0 && cuCimag(a_kj) == 0)
+                continue;
+            for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            {
+                const int i = lower_index[l];
+                A[INDEX(i + j * NSP)] = cuCsub(A[INDEX(i + j * NSP)], cuCmul(A[INDEX(i + k * NSP)], a_kj));
+            }
+        }
+    }
+    return 0;
+}
+
+__device__
+void sparse_lu_solve(const sparse_lu_pattern* __restrict__ lu, const double* __restrict__ LU, double* __restrict__ b)
+{
+    const int* __restrict__ lower_ptr = lu->lower_ptr;
+    const int* __restrict__ lower_index = lu->lower_index;
+    const int* __restrict__ upper_ptr = lu->upper_ptr;
+    const int* __restrict__ upper_index = lu->upper_index;
+    // forward substitution, L has a unit diagonal
+    for (int k = 0; k < NSP; ++k)
+    {
+        const double b_k = b[INDEX(k)];
+        if (b_k == 0)
+            continue;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            b[INDEX(lower_index[l])] -= LU[INDEX(lower_index[l] + k * NSP)] * b_k;
+    }
+    // back substitution
+    for (int k = NSP - 1; k >= 0; --k)
+    {
+        double sum = b[INDEX(k)];
+        for (int u = upper_ptr[k]; u < upper_ptr[k + 1]; ++u)
+            sum -= LU[INDEX(k + upper_index[u] * NSP)] * b[INDEX(upper_index[u])];
+        b[INDEX(k)] = sum / LU[INDEX(k + k * NSP)];
+    }
+}
+
+__device__
+void sparse_lu_solve_complex(const sparse_lu_pattern* __restrict__ lu, const cuDoubleComplex* __restrict__ LU,
+                             cuDoubleComplex* __restrict__ b)
+{
+    const int* __restrict__ lower_ptr = lu->lower_ptr;
+    const int* __restrict__ lower_index = lu->lower_index;
+    const int* __restrict__ upper_ptr = lu->upper_ptr;
+    const int* __restrict__ upper_index = lu->upper_index;
+    // forward substitution, L has a unit diagonal
+    for (int k = 0; k < NSP; ++k)
+    {
+        const cuDoubleComplex b_k = b[INDEX(k)];
+        if (cuCreal(b_k) == 0 && cuCimag(b_k) == 0)
+            continue;
+        for (int l = lower_ptr[k]; l < lower_ptr[k + 1]; ++l)
+            b[INDEX(lower_index[l])] = cuCsub(b[INDEX(lower_index[l])],
+                                              cuCmul(LU[INDEX(lower_index[l] + k * NSP)], b_k));
+    }
+    // back substitution
+    for (int k = NSP - 1; k >= 0; --k)
+    {
+        cuDoubleComplex sum = b[INDEX(k)];
+        for (int u = upper_ptr[k]; u < upper_ptr[k + 1]; ++u)
+            sum = cuCsub(sum, cuCmul(LU[INDEX(k + upper_index[u] * NSP)], b[INDEX(upper_index[u])]));
+        b[INDEX(k)] = cuCdiv(sum, LU[INDEX(k + k * NSP)]);
+    }
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,119 @@
+/**
+ * \file
+ * \brief Header definitions for the sparse (statically pivoted) LU factorization of the GPU solvers
+ *
+ * If #SPARSE_LU is defined, the Radau-IIa solver factors its system matrices
+ * \f$\frac{\gamma}{h} I - J\f$ with a sparse LU factorization: the nonzero pattern of the
+ * Jacobian (and the fill-in of the factors) is computed once on initialization, and each
+ * factorization only operates on the entries in the pattern.  The pattern is shared by all
+ * threads, while the matrices keep the dense, column-major `A[INDEX(i + j * NSP)]` storage.
+ *
+ * As the pattern is detected from the Jacobian (and no pivoting is performed), sparse_lu_in_pattern
+ * and the pivot threshold #SPARSE_LU_PIVOT_TOL detect matrices the sparse factorization must not be
+ * used for, in which case the solver falls back to the dense (partially pivoted) factorization.
+ * If #SPARSE_JACOBIAN is defined, the structural pattern of the mechanism is used instead of the detected one.
+ */
+
+#ifndef SPARSE_LU_CUH
+#define SPARSE_LU_CUH
+
+#include "header.cuh"
+#include "solver_options.cuh"
+#include <cuComplex.h>
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef SPARSE_LU
+
+/**
+ * \brief The pivot index array entry that marks a sparse factorization
+ *
+ * Stored in the first entry of the pivot indicies of a matrix factored by sparse_lu_factor,
+ * which is never a valid pivot index.
+ */
+#define SPARSE_LU_PIVOT (-1)
+
+#ifndef SPARSE_LU_PIVOT_TOL
+    /**
+     * \brief The minimum ratio of the magnitude of a pivot to the largest (subdiagonal) entry of its column
+     *
+     * If a pivot is smaller, the sparse factorization fails and the dense factorization should be used.
+     */
+    #define SPARSE_LU_PIVOT_TOL (1e-2)
+#endif
+
+/**
+ * \brief The (device) symbolic factorization, shared by all threads
+ */
+struct sparse_lu_pattern
+{
+    //! The nonzero pattern of the factors (the Jacobian, the diagonal and the fill-in), stored as `pattern[i + j * NSP]`
+    bool* pattern;
+    //! The rows of the subdiagonal entries of column `k` of L are `lower_index[lower_ptr[k]]`...`lower_index[lower_ptr[k + 1] - 1]`
+    int* lower_ptr;
+    //! The row indicies of the subdiagonal entries of L
+    int* lower_index;
+    //! The columns of the superdiagonal entries of row `k` of U are `upper_index[upper_ptr[k]]`...`upper_index[upper_ptr[k + 1] - 1]`
+    int* upper_ptr;
+    //! The column indicies of the superdiagonal entries of U
+    int* upper_index;
+};
+
+/**
+ * \brief Detects the nonzero pattern of the Jacobian on the current device and computes the symbolic factorization
+ * \param[out]      lu          The symbolic factorization, with pointers to device memory
+ *
+ * The pattern is the union of the nonzero entries of the Jacobian at three synthetic states
+ * (in which all entries are nonzero), evaluated by a single device thread.
+ */
+void initialize_sparse_lu(sparse_lu_pattern* lu);
+
+/**
+ * \brief Frees the device memory of the symbolic factorization
+ */
+void cleanup_sparse_lu(sparse_lu_pattern* lu);
+
+/**
+ * \brief Returns true if all nonzero entries of the Jacobian `A` are in the pattern of the factors
+ *
+ * Always true for a compressed (#SPARSE_JACOBIAN) Jacobian.
+ */
+__device__
+bool sparse_lu_in_pattern(const sparse_lu_pattern* __restrict__ lu, const double* __restrict__ A);
+
+/**
+ * \brief Factors the (NSP x NSP) matrix `A` in place, without pivoting
+ * \returns 0 on success, or `k + 1` if the k-th pivot is too small, @see SPARSE_LU_PIVOT_TOL
+ */
+__device__
+int sparse_lu_factor(const sparse_lu_pattern* __restrict__ lu, double* __restrict__ A);
+
+/**
+ * \brief Factors the (NSP x NSP) complex matrix `A` in place, without pivoting
+ * \returns 0 on success, or `k + 1` if the k-th pivot is too small, @see SPARSE_LU_PIVOT_TOL
+ */
+__device__
+int sparse_lu_factor_complex(const sparse_lu_pattern* __restrict__ lu, cuDoubleComplex* __restrict__ A);
+
+/**
+ * \brief Solves \f$LU x = b\f$ for the factors computed by sparse_lu_factor, overwriting `b` with the solution
+ */
+__device__
+void sparse_lu_solve(const sparse_lu_pattern* __restrict__ lu, const double* __restrict__ LU, double* __restrict__ b);
+
+/**
+ * \brief Solves \f$LU x = b\f$ for the factors computed by sparse_lu_factor_complex, overwriting `b` with the solution
+ */
+__device__
+void sparse_lu_solve_complex(const sparse_lu_pattern* __restrict__ lu, const cuDoubleComplex* __restrict__ LU,
+                             cuDoubleComplex* __restrict__ b);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
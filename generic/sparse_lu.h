@@ -0,0 +1,106 @@
+/**
+ * \file
+ * \brief Header definitions for the sparse (statically pivoted) LU factorization of the CPU solvers
+ *
+ * If #SPARSE_LU is defined, the Radau-IIa solver factors its system matrices
+ * \f$\frac{\gamma}{h} I - J\f$ with a sparse LU factorization: the nonzero pattern of the
+ * Jacobian (and the fill-in of the factors) is computed once by sparse_lu_init, and each
+ * factorization only operates on the entries in the pattern.  The matrices keep the dense,
+ * column-major storage of the Jacobian.
+ *
+ * As the pattern is detected from the Jacobian (and no pivoting is performed), sparse_lu_in_pattern
+ * and the pivot threshold #SPARSE_LU_PIVOT_TOL detect matrices the sparse factorization must not be
+ * used for, in which case the solver falls back to the dense (partially pivoted) LAPACK factorization.
+ * If #SPARSE_JACOBIAN is defined, the structural pattern of the mechanism is used instead of the detected one.
+ */
+
+#ifndef SPARSE_LU_H
+#define SPARSE_LU_H
+
+#include "header.h"
+#include "solver_options.h"
+#include <stdbool.h>
+#include <complex.h>
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef SPARSE_LU
+
+/**
+ * \brief The pivot index array entry that marks a sparse factorization
+ *
+ * Stored in the first entry of the pivot indicies of a matrix factored by sparse_lu_factor,
+ * which is never a valid (zero or one-based) pivot index.
+ */
+#define SPARSE_LU_PIVOT (-1)
+
+#ifndef SPARSE_LU_PIVOT_TOL
+    /**
+     * \brief The minimum ratio of the magnitude of a pivot to the largest (subdiagonal) entry of its column
+     *
+     * If a pivot is smaller, the sparse factorization fails and the dense factorization should be used.
+     */
+    #define SPARSE_LU_PIVOT_TOL (1e-2)
+#endif
+
+/**
+ * \brief Detects the nonzero pattern of the Jacobian and computes the symbolic factorization, if not already done
+ * \param[in]       t           The current system time
+ * \param[in]       pr          The system constant variable (pressure/density)
+ * \param[in]       y           A state vector to evaluate the Jacobian at
+ *
+ * The pattern is the union of the nonzero entries of the Jacobian at `y` and at two perturbed
+ * states (in which all entries are nonzero), such that entries of the Jacobian that vanish for zero
+ * mass fractions are part of the pattern.  Thread-safe, only the first call computes the pattern.
+ */
+void sparse_lu_init(const double t, const double pr, const double* y);
+
+/**
+ * \brief Returns true if all nonzero entries of the Jacobian `A` are in the pattern of the factors
+ *
+ * Always true for a compressed (#SPARSE_JACOBIAN) Jacobian.
+ */
+bool sparse_lu_in_pattern(const double* A);
+
+/**
+ * \brief Factors the (NSP x NSP) matrix `A` in place, without pivoting
+ * \param[in,out]   A           The matrix to factor, overwritten with its L (unit diagonal) and U factors
+ * \returns 0 on success, or `k + 1` if the k-th pivot is too small, @see SPARSE_LU_PIVOT_TOL
+ */
+int sparse_lu_factor(double* A);
+
+/**
+ * \brief Factors the (NSP x NSP) complex matrix `A` in place, without pivoting
+ * \param[in,out]   A           The matrix to factor, overwritten with its L (unit diagonal) and U factors
+ * \returns 0 on success, or `k + 1` if the k-th pivot is too small, @see SPARSE_LU_PIVOT_TOL
+ */
+int sparse_lu_factor_complex(double complex* A);
+
+/**
+ * \brief Solves \f$LU x = b\f$ for the factors computed by sparse_lu_factor
+ * \param[in]       LU          The factored matrix
+ * \param[in,out]   b           The (NSP x 1) right hand side, overwritten with the solution
+ */
+void sparse_lu_solve(const double* LU, double* b);
+
+/**
+ * \brief Solves \f$LU x = b\f$ for the factors computed by sparse_lu_factor_complex
+ * \param[in]       LU          The factored matrix
+ * \param[in,out]   b           The (NSP x 1) right hand side, overwritten with the solution
+ */
+void sparse_lu_solve_complex(const double complex* LU, double complex* b);
+
+/**
+ * \brief Frees the symbolic factorization
+ */
+void cleanup_sparse_lu();
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * \file
+ * \brief Dynamic per-IVP masking of the state vector entries, @see species_mask.h
+ */
+
+#include <math.h>
+#include "species_mask.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef SPECIES_MASK
+
+/**
+ * \brief Resets `mask` to the always active entries
+ */
+void reset_species_mask(species_mask* mask)
+{
+    mask->num_active = 0;
+    for (int i = 0; i < NSP; ++i)
+    {
+        mask->is_active[i] = i < SPECIES_MASK_FIXED;
+        if (mask->is_active[i])
+            mask->active[mask->num_active++] = i;
+    }
+}
+
+/**
+ * \brief Activates the inactive entries of `mask` that exceed the threshold at the state `y`
+ * \param[in,out]   mask            The mask
+ * \param[in]       dt              The remaining integration time
+ * \param[in]       y               The state vector
+ * \param[in]       f               The (unmasked) derivatives at `y`
+ * \return                          True if any entry was activated
+ */
+bool update_species_mask(species_mask* mask, const double dt, const double* y, const double* f)
+{
+    bool changed = false;
+    for (int i = SPECIES_MASK_FIXED; i < NSP; ++i)
+    {
+        if (!mask->is_active[i] &&
+            (fabs(y[i]) > SPECIES_MASK_THRESHOLD || fabs(f[i]) * dt > SPECIES_MASK_THRESHOLD))
+        {
+            mask->is_active[i] = true;
+            changed = true;
+        }
+    }
+    if (changed)
+    {
+        // keep the active indices ascending, i.e. the compacted block in the order of the full matrix
+        mask->num_active = 0;
+        for (int i = 0; i < NSP; ++i)
+        {
+            if (mask->is_active[i])
+                mask->active[mask->num_active++] = i;
+        }
+    }
+    return changed;
+}
+
+/**
+ * \brief Zeros the inactive entries of the vector `f`
+ */
+void apply_species_mask(const species_mask* mask, double* f)
+{
+    if (mask->num_active == NSP)
+        return;
+    for (int i = 0; i < NSP; ++i)
+    {
+        if (!mask->is_active[i])
+            f[i] = 0;
+    }
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,78 @@
+/**
+ * \file
+ * \brief Header definitions for the dynamic per-IVP masking of the state vector entries (adaptive chemistry)
+ *
+ * If #SPECIES_MASK is defined, each call of the Radau-IIa integrate() solves a reduced system of the active
+ * state vector entries.  The first #SPECIES_MASK_FIXED entries (the temperature of the pyJac state vector)
+ * are always active, and any other entry is active if its magnitude, or its projected change
+ * \f$|f_i(y)| (t_{end} - t)\f$ over the rest of the call, exceeds #SPECIES_MASK_THRESHOLD.  The inactive
+ * entries are frozen (their derivatives are zeroed), such that the LU factorizations and back substitutions
+ * of the Newton iterations operate on the compacted active block of the system matrices.
+ *
+ * The criterion is re-evaluated on the state of every accepted step, and an entry that becomes active
+ * (e.g. a radical produced as the IVP ignites) stays active for the rest of the call.  The mechanism
+ * `dydt` and `eval_jacob` still evaluate the full state vector.
+ */
+
+#ifndef SPECIES_MASK_H
+#define SPECIES_MASK_H
+
+#include <stdbool.h>
+#include "header.h"
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifdef SPECIES_MASK
+
+#ifndef SPECIES_MASK_THRESHOLD
+    //! The magnitude (and projected change) below which a state vector entry is inactive
+    #define SPECIES_MASK_THRESHOLD (1e-14)
+#endif
+#ifndef SPECIES_MASK_FIXED
+    //! The number of leading state vector entries that are always active
+    #define SPECIES_MASK_FIXED (1)
+#endif
+
+/**
+ * \brief The active state vector entries of an IVP
+ * \param           num_active      The number of active entries
+ * \param           active          The (ascending) indices of the active entries
+ * \param           is_active       True for the active entries, indexed by state vector entry
+ */
+typedef struct
+{
+    int num_active;
+    int active[NSP];
+    bool is_active[NSP];
+} species_mask;
+
+/**
+ * \brief Resets `mask` to the always active entries
+ */
+void reset_species_mask(species_mask* mask);
+
+/**
+ * \brief Activates the inactive entries of `mask` that exceed the threshold at the state `y`
+ * \param[in,out]   mask            The mask
+ * \param[in]       dt              The remaining integration time
+ * \param[in]       y               The state vector
+ * \param[in]       f               The (unmasked) derivatives at `y`
+ * \return                          True if any entry was activated
+ */
+bool update_species_mask(species_mask* mask, const double dt, const double* y, const double* f);
+
+/**
+ * \brief Zeros the inactive entries of the vector `f`
+ */
+void apply_species_mask(const species_mask* mask, double* f);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
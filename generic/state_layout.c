@@ -0,0 +1,81 @@
+/**
+ * \file
+ * \brief Conversion of the state vectors to and from the layout of the CPU drivers, @see state_layout.h
+ */
+
+#include <string.h>
+#include "state_layout.h"
+#include "load_balance.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief Converts the column-major state vectors `y` of NUM IVPs to the layout of the drivers `y_blocked`
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       y               The (NUM * NSP) state vectors, stored as `y[tid + i * NUM]`
+ * \param[out]      y_blocked       The (#state_size) state vectors, stored as `y_blocked[state_index(tid, i, NUM)]`
+ * \param[in]       num_threads     The number of OpenMP threads
+ */
+void block_states(const int NUM, const double* y, double* y_blocked, const int num_threads)
+{
+#ifdef STATE_BLOCK
+    const int num_blocks = (NUM + STATE_BLOCK - 1) / STATE_BLOCK;
+    int b;
+    #pragma omp parallel for private(b) SCHEDULE_CLAUSE num_threads(num_threads)
+    for (b = 0; b < num_blocks; ++b)
+    {
+        // each entry of the block is a contiguous run in both layouts
+        const int first = b * STATE_BLOCK;
+        const int num_lanes = NUM - first < STATE_BLOCK ? NUM - first : STATE_BLOCK;
+        double* block = &y_blocked[(size_t)b * STATE_BLOCK * NSP];
+        for (int i = 0; i < NSP; ++i)
+        {
+            const double* row = &y[first + (size_t)i * NUM];
+            for (int l = 0; l < num_lanes; ++l)
+                block[i * STATE_BLOCK + l] = row[l];
+            for (int l = num_lanes; l < STATE_BLOCK; ++l)
+                block[i * STATE_BLOCK + l] = row[num_lanes - 1];
+        }
+    }
+#else
+    (void)num_threads;
+    memcpy(y_blocked, y, (size_t)NUM * NSP * sizeof(double));
+#endif
+}
+
+/**
+ * \brief Converts the state vectors `y_blocked` of NUM IVPs in the layout of the drivers to column-major `y`
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       y_blocked       The (#state_size) state vectors, stored as `y_blocked[state_index(tid, i, NUM)]`
+ * \param[out]      y               The (NUM * NSP) state vectors, stored as `y[tid + i * NUM]`
+ * \param[in]       num_threads     The number of OpenMP threads
+ */
+void unblock_states(const int NUM, const double* y_blocked, double* y, const int num_threads)
+{
+#ifdef STATE_BLOCK
+    const int num_blocks = (NUM + STATE_BLOCK - 1) / STATE_BLOCK;
+    int b;
+    #pragma omp parallel for private(b) SCHEDULE_CLAUSE num_threads(num_threads)
+    for (b = 0; b < num_blocks; ++b)
+    {
+        const int first = b * STATE_BLOCK;
+        const int num_lanes = NUM - first < STATE_BLOCK ? NUM - first : STATE_BLOCK;
+        const double* block = &y_blocked[(size_t)b * STATE_BLOCK * NSP];
+        for (int i = 0; i < NSP; ++i)
+        {
+            double* row = &y[first + (size_t)i * NUM];
+            for (int l = 0; l < num_lanes; ++l)
+                row[l] = block[i * STATE_BLOCK + l];
+        }
+    }
+#else
+    (void)num_threads;
+    memcpy(y, y_blocked, (size_t)NUM * NSP * sizeof(double));
+#endif
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,85 @@
+/**
+ * \file
+ * \brief The layout of the state vectors of the CPU drivers and library API
+ *
+ * By default the state vectors of NUM IVPs are stored column-major, i.e. entry `i` of IVP `tid` is
+ * `y[tid + i * NUM]`.  Gathering one IVP then touches NSP entries that are `NUM` doubles apart, hence for
+ * large NUM a different page (and TLB entry) per entry.  If #STATE_BLOCK is defined, the state vectors are
+ * instead stored as an array of structs of arrays: the IVPs are grouped into blocks of #STATE_BLOCK
+ * consecutive IVPs, each block stores its NSP x #STATE_BLOCK entries contiguously, and entry `i` of the IVPs
+ * of a block is a contiguous run of #STATE_BLOCK doubles, i.e.
+ *
+ *     y[(tid / STATE_BLOCK) * STATE_BLOCK * NSP + i * STATE_BLOCK + tid % STATE_BLOCK]
+ *
+ * such that an IVP is gathered from `NSP * STATE_BLOCK` contiguous doubles.  The last block is padded to
+ * #STATE_BLOCK IVPs, @see state_size.  A block of #SIMD_LANES IVPs is exactly the lane-wise layout of
+ * integrate_lanes, which then integrates the blocks in place.  #STATE_BLOCK is a power of two of at most 32,
+ * such that a block of eight or more IVPs spans whole cache lines, and a block is a (sub-)warp of a GPU.
+ *
+ * The layout applies to `y_host` of the CPU library API (@see accelerInt_integrate) and to the drivers.
+ * The initial conditions, the log and the checkpoints keep the column-major layout, and are converted by
+ * block_states / unblock_states.
+ */
+
+#ifndef STATE_LAYOUT_H
+#define STATE_LAYOUT_H
+
+#include <stddef.h>
+#include "header.h"
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief Returns the index of entry `i` of IVP `tid` in the state vectors of NUM IVPs
+ */
+static inline size_t state_index(const int tid, const int i, const int NUM)
+{
+#ifdef STATE_BLOCK
+    (void)NUM;
+    return (size_t)(tid / STATE_BLOCK) * (STATE_BLOCK * NSP) + (size_t)i * STATE_BLOCK + tid % STATE_BLOCK;
+#else
+    return tid + (size_t)i * NUM;
+#endif
+}
+
+/**
+ * \brief Returns the number of doubles of the state vectors of NUM IVPs, including the padding of the last block
+ */
+static inline size_t state_size(const int NUM)
+{
+#ifdef STATE_BLOCK
+    return (size_t)((NUM + STATE_BLOCK - 1) / STATE_BLOCK) * STATE_BLOCK * NSP;
+#else
+    return (size_t)NUM * NSP;
+#endif
+}
+
+/**
+ * \brief Converts the column-major state vectors `y` of NUM IVPs to the layout of the drivers `y_blocked`
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       y               The (NUM * NSP) state vectors, stored as `y[tid + i * NUM]`
+ * \param[out]      y_blocked       The (#state_size) state vectors, stored as `y_blocked[state_index(tid, i, NUM)]`
+ * \param[in]       num_threads     The number of OpenMP threads
+ *
+ * The padding of the last block repeats its last IVP.  The blocks are written in parallel, with the schedule
+ * of the drivers (i.e. placed near the threads integrating them), @see numa_placement.h
+ */
+void block_states(const int NUM, const double* y, double* y_blocked, const int num_threads);
+
+/**
+ * \brief Converts the state vectors `y_blocked` of NUM IVPs in the layout of the drivers to column-major `y`
+ * \param[in]       NUM             The number of IVPs
+ * \param[in]       y_blocked       The (#state_size) state vectors, stored as `y_blocked[state_index(tid, i, NUM)]`
+ * \param[out]      y               The (NUM * NSP) state vectors, stored as `y[tid + i * NUM]`
+ * \param[in]       num_threads     The number of OpenMP threads
+ */
+void unblock_states(const int NUM, const double* y_blocked, double* y, const int num_threads);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
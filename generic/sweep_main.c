@@ -0,0 +1,176 @@
+/**
+ * \file
+ * \brief the parameter sweep main file for all CPU solvers
+ *
+ * Contains the main function of the sweep executables (built with the PARAMETER_SWEEP option), @see parameter_sweep.h
+ */
+
+//! for clock_gettime(), @see benchmark.h
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+//our code
+#include "header.h"
+#include "parameter_sweep.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+//! The maximum number of values of each swept parameter
+#define SWEEP_MAX_VALUES (64)
+
+/**
+ * \brief Parses the comma separated list `arg` into `values`
+ * \return The number of values, the program exits if any value is not a positive number
+ */
+static int parse_list(char* arg, double* values)
+{
+    int num = 0;
+    for (char* tok = strtok(arg, ","); tok != NULL; tok = strtok(NULL, ","))
+    {
+        if (num == SWEEP_MAX_VALUES)
+        {
+            printf("Error: at most %d values may be swept per parameter\n", SWEEP_MAX_VALUES);
+            exit(1);
+        }
+        if (sscanf(tok, "%lf", &values[num]) != 1 || !(values[num] > 0))
+        {
+            printf("Error: could not parse sweep value %s, provide a number greater than 0\n", tok);
+            exit(1);
+        }
+        num++;
+    }
+    return num;
+}
+
+/** Main function
+ *
+ * \param[in]       argc    command line argument count
+ * \param[in]       argv    command line argument vector
+ *
+ * This times the integrators over a sweep of configurations in a single process.  The syntax is as follows:\n
+ * `./solver-name-sweep [num_threads] [num_IVPs] [step_sizes] [end_time] [trials]`\n
+ * *  num_threads  [Optional, Default:1]
+ *      *  A comma separated list of the numbers of OpenMP threads to utilize
+ * *  num_IVPs     [Optional, Default:1]
+ *      *  A comma separated list of the numbers of initial value problems to solve.
+ *      *  The largest must be less than the number of conditions in the data file if #SAME_IC is not defined.
+ * *  step_sizes   [Optional, Default:#t_step]
+ *      *  A comma separated list of the global integration step sizes
+ * *  end_time     [Optional, Default:#end_time]
+ *      *  The end time of each configuration, or 0 to integrate a single step of each step size
+ * *  trials       [Optional, Default:#BENCHMARK_TRIALS]
+ *      *  The number of timed trials of each configuration, each preceded by #BENCHMARK_WARMUP untimed trials
+ *
+ * The data file is read once, and every combination of the swept values is timed, with one solver instance
+ * per thread count.  A block in the format of the serial executables is printed for each configuration,
+ * and if #BENCHMARK_OUTPUT is defined a record of each configuration is appended to the named file.
+ */
+int main (int argc, char *argv[])
+{
+    double threads[SWEEP_MAX_VALUES] = {1};
+    double sizes[SWEEP_MAX_VALUES] = {1};
+    double steps[SWEEP_MAX_VALUES] = {t_step};
+    int num_threads_swept = 1;
+    int num_sizes = 1;
+    int num_steps_swept = 1;
+    double t_end = end_time;
+    int trials = BENCHMARK_TRIALS;
+
+    if (argc > 1)
+        num_threads_swept = parse_list(argv[1], threads);
+    if (argc > 2)
+        num_sizes = parse_list(argv[2], sizes);
+    if (argc > 3)
+        num_steps_swept = parse_list(argv[3], steps);
+    if (argc > 4 && (sscanf(argv[4], "%lf", &t_end) != 1 || t_end < 0))
+    {
+        printf("Error: End time not in correct range\n");
+        printf("Provide a number greater than 0, or 0 to integrate a single step\n");
+        exit(1);
+    }
+    if (argc > 5 && (sscanf(argv[5], "%i", &trials) != 1 || trials <= 0))
+    {
+        printf("Error: Number of trials not in correct range\n");
+        printf("Provide number greater than 0\n");
+        exit(1);
+    }
+
+    #ifdef _OPENMP
+    int max_threads = omp_get_max_threads ();
+    #else
+    int max_threads = 1;
+    #endif
+    int NUM = 1;
+    for (int i = 0; i < num_threads_swept; ++i)
+    {
+        if (threads[i] != floor(threads[i]) || threads[i] > max_threads)
+        {
+            printf("Error: Number of threads not in correct range\n");
+            printf("Provide numbers between 1 and %i\n", max_threads);
+            exit(1);
+        }
+    }
+    for (int i = 0; i < num_sizes; ++i)
+    {
+        if (sizes[i] != floor(sizes[i]) || sizes[i] > 2147483647.0)
+        {
+            printf("Error: Problem size not in correct range\n");
+            printf("Provide integers greater than 0\n");
+            exit(1);
+        }
+        NUM = sizes[i] > NUM ? (int)sizes[i] : NUM;
+    }
+
+    parameter_sweep sweep;
+#ifdef SAME_IC
+    parameter_sweep_create(&sweep, NULL, NUM);
+#elif defined(SHUFFLE)
+    parameter_sweep_create(&sweep, "shuffled_data.bin", NUM);
+#else
+    parameter_sweep_create(&sweep, "ign_data.bin", NUM);
+#endif
+
+    double* samples = (double*)malloc(trials * sizeof(double));
+    for (int i = 0; i < num_threads_swept; ++i)
+    {
+        for (int j = 0; j < num_sizes; ++j)
+        {
+            for (int k = 0; k < num_steps_swept; ++k)
+            {
+                sweep_point point = {(int)sizes[j], (int)threads[i], steps[k],
+                                     t_end > 0 ? t_end : steps[k], BENCHMARK_WARMUP, trials};
+                benchmark_summary summary;
+                int numSteps = parameter_sweep_run(&sweep, &point, samples, &summary);
+
+                printf ("# ODEs: %d\n", point.NUM);
+                printf ("# threads: %d\n", point.num_threads);
+                printf ("Step size: %e (s)\tEnd time: %e (s)\n", point.stepsize, point.t_end);
+                printf ("Time: %.15e sec\n", summary.median);
+                if (trials > 1)
+                    printf ("Trials: %d\tmin: %.6e\tp10: %.6e\tp90: %.6e\tmax: %.6e\tstd. dev.: %.6e (s)\n",
+                            trials, summary.min, summary.p10, summary.p90, summary.max, sqrt(summary.variance));
+#ifdef BENCHMARK_OUTPUT
+                benchmark_info bench = {solver_name(), "cpu", point.NUM, point.num_threads, 0, numSteps, point.stepsize};
+                benchmark_write(BENCHMARK_OUTPUT, &bench, trials, samples, &summary);
+#endif
+                double runtime = summary.median / ((double)(numSteps));
+                printf ("Time per step: %e (s)\t%.15e (s/thread)\n", runtime, runtime / point.NUM);
+                printf ("TFinal: %e\n\n", sweep.y[0]);
+            }
+        }
+    }
+
+    free(samples);
+    parameter_sweep_destroy(&sweep);
+    return 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,166 @@
+/**
+ * \file
+ * \brief the parameter sweep main file for all GPU solvers
+ *
+ * Contains the main function of the sweep executables (built with the PARAMETER_SWEEP option), @see parameter_sweep.cuh
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+/* Include CUDA libraries. */
+#include <cuda_runtime.h>
+
+//our code
+#include "header.cuh"
+#include "parameter_sweep.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The maximum number of values of each swept parameter
+#define SWEEP_MAX_VALUES (64)
+
+/**
+ * \brief Parses the comma separated list `arg` into `values`
+ * \return The number of values, the program exits if any value is not a positive number
+ */
+static int parse_list(char* arg, double* values)
+{
+    int num = 0;
+    for (char* tok = strtok(arg, ","); tok != NULL; tok = strtok(NULL, ","))
+    {
+        if (num == SWEEP_MAX_VALUES)
+        {
+            printf("Error: at most %d values may be swept per parameter\n", SWEEP_MAX_VALUES);
+            exit(1);
+        }
+        if (sscanf(tok, "%lf", &values[num]) != 1 || !(values[num] > 0))
+        {
+            printf("Error: could not parse sweep value %s, provide a number greater than 0\n", tok);
+            exit(1);
+        }
+        num++;
+    }
+    return num;
+}
+
+/** Main function
+ *
+ * \param[in]       argc    command line argument count
+ * \param[in]       argv    command line argument vector
+ *
+ * This times the integrators over a sweep of configurations in a single process.  The syntax is as follows:\n
+ * `./solver-name-gpu-sweep [num_IVPs] [step_sizes] [end_time] [trials] [device]`\n
+ * *  num_IVPs     [Optional, Default:1]
+ *      *  A comma separated list of the numbers of initial value problems to solve.
+ *      *  The largest must be less than the number of conditions in the data file if #SAME_IC is not defined.
+ * *  step_sizes   [Optional, Default:#t_step]
+ *      *  A comma separated list of the global integration step sizes
+ * *  end_time     [Optional, Default:#end_time]
+ *      *  The end time of each configuration, or 0 to integrate a single step of each step size
+ * *  trials       [Optional, Default:#BENCHMARK_TRIALS]
+ *      *  The number of timed trials of each configuration, each preceded by #BENCHMARK_WARMUP untimed trials
+ * *  device       [Optional, Default:0]
+ *      *  The CUDA device number to use
+ *
+ * The data file is read once, and every combination of the swept values is timed, reusing the solver instance
+ * over the step sizes of each number of IVPs.  A block in the format of the serial executables is printed for
+ * each configuration, and if #BENCHMARK_OUTPUT is defined a record of each configuration is appended to the named file.
+ */
+int main (int argc, char *argv[])
+{
+    double sizes[SWEEP_MAX_VALUES] = {1};
+    double steps[SWEEP_MAX_VALUES] = {t_step};
+    int num_sizes = 1;
+    int num_steps_swept = 1;
+    double t_end = end_time;
+    int trials = BENCHMARK_TRIALS;
+    int device = 0;
+
+    if (argc > 1)
+        num_sizes = parse_list(argv[1], sizes);
+    if (argc > 2)
+        num_steps_swept = parse_list(argv[2], steps);
+    if (argc > 3 && (sscanf(argv[3], "%lf", &t_end) != 1 || t_end < 0))
+    {
+        printf("Error: End time not in correct range\n");
+        printf("Provide a number greater than 0, or 0 to integrate a single step\n");
+        exit(1);
+    }
+    if (argc > 4 && (sscanf(argv[4], "%i", &trials) != 1 || trials <= 0))
+    {
+        printf("Error: Number of trials not in correct range\n");
+        printf("Provide number greater than 0\n");
+        exit(1);
+    }
+    if (argc > 5)
+    {
+        int visible_devices;
+        cudaGetDeviceCount(&visible_devices);
+        if (sscanf(argv[5], "%i", &device) != 1 || (device < 0) || (device >= visible_devices))
+        {
+            printf("Error: GPU device number not in correct range\n");
+            printf("Provide number between 0 and %i\n", visible_devices - 1);
+            exit(1);
+        }
+    }
+
+    int NUM = 1;
+    for (int i = 0; i < num_sizes; ++i)
+    {
+        if (sizes[i] != floor(sizes[i]) || sizes[i] > 2147483647.0)
+        {
+            printf("Error: Problem size not in correct range\n");
+            printf("Provide integers greater than 0\n");
+            exit(1);
+        }
+        NUM = sizes[i] > NUM ? (int)sizes[i] : NUM;
+    }
+
+    parameter_sweep sweep;
+#ifdef SAME_IC
+    parameter_sweep_create(&sweep, NULL, NUM, device);
+#elif defined(SHUFFLE)
+    parameter_sweep_create(&sweep, "shuffled_data.bin", NUM, device);
+#else
+    parameter_sweep_create(&sweep, "ign_data.bin", NUM, device);
+#endif
+
+    double* samples = (double*)malloc(trials * sizeof(double));
+    for (int j = 0; j < num_sizes; ++j)
+    {
+        for (int k = 0; k < num_steps_swept; ++k)
+        {
+            sweep_point point = {(int)sizes[j], steps[k], t_end > 0 ? t_end : steps[k], BENCHMARK_WARMUP, trials};
+            benchmark_summary summary;
+            int numSteps = parameter_sweep_run(&sweep, &point, samples, &summary);
+
+            printf ("# ODEs: %d\n", point.NUM);
+            printf ("# threads: %d \t block size: %d\n", point.NUM, TARGET_BLOCK_SIZE);
+            printf ("Step size: %e (s)\tEnd time: %e (s)\n", point.stepsize, point.t_end);
+            printf ("Time: %.15e sec\n", summary.median);
+            if (trials > 1)
+                printf ("Trials: %d\tmin: %.6e\tp10: %.6e\tp90: %.6e\tmax: %.6e\tstd. dev.: %.6e (s)\n",
+                        trials, summary.min, summary.p10, summary.p90, summary.max, sqrt(summary.variance));
+#ifdef BENCHMARK_OUTPUT
+            benchmark_info bench = {solver_name(), "gpu", point.NUM, 1, TARGET_BLOCK_SIZE, numSteps, point.stepsize};
+            benchmark_write(BENCHMARK_OUTPUT, &bench, trials, samples, &summary);
+#endif
+            double runtime = summary.median / ((double)(numSteps));
+            printf ("Time per step: %e (s)\t%.15e (s/thread)\n", runtime, runtime / point.NUM);
+            printf ("TFinal: %e\n\n", sweep.y[0]);
+        }
+    }
+
+    free(samples);
+    parameter_sweep_destroy(&sweep);
+    return 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,49 @@
+/**
+ * \file
+ * \brief The runtime integration tolerances of the CPU solvers, @see tolerances.h
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "tolerances.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+ivp_tolerances current_tolerances;
+
+#ifdef SIMD_LANES
+ivp_tolerances current_lane_tolerances[SIMD_LANES];
+#endif
+
+void initialize_tolerances(ivp_tolerances* tol)
+{
+    for (int i = 0; i < NSP; ++i)
+        tol->atol[i] = ATOL;
+    tol->rtol = RTOL;
+}
+
+void set_tolerances(ivp_tolerances* tol, const double atol, const double rtol, const double* atol_vector)
+{
+    if (!(rtol > 0))
+    {
+        printf("Error: the relative tolerance must be positive, %e was given.\n", rtol);
+        exit(-1);
+    }
+    for (int i = 0; i < NSP; ++i)
+    {
+        tol->atol[i] = atol_vector == NULL ? atol : atol_vector[i];
+        if (!(tol->atol[i] >= 0))
+        {
+            printf("Error: the absolute tolerance of state vector entry %d must not be negative, %e was given.\n",
+                   i, tol->atol[i]);
+            exit(-1);
+        }
+    }
+    tol->rtol = rtol;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
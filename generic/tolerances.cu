@@ -0,0 +1,56 @@
+/**
+ * \file
+ * \brief The runtime integration tolerances of the GPU solvers, @see tolerances.cuh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "tolerances.cuh"
+#include "gpu_arena.cuh"
+#include "gpu_macros.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+void initialize_tolerances(double** tol)
+{
+    cudaErrorCheck( arena_malloc(tol, TOL_SIZE * sizeof(double)) );
+    set_tolerances(*tol, ATOL, RTOL, NULL);
+}
+
+void fill_tolerances(double* host_tol, const double atol, const double rtol, const double* atol_vector)
+{
+    if (!(rtol > 0))
+    {
+        printf("Error: the relative tolerance must be positive, %e was given.\n", rtol);
+        exit(-1);
+    }
+    for (int i = 0; i < NSP; ++i)
+    {
+        host_tol[i] = atol_vector == NULL ? atol : atol_vector[i];
+        if (!(host_tol[i] >= 0))
+        {
+            printf("Error: the absolute tolerance of state vector entry %d must not be negative, %e was given.\n",
+                   i, host_tol[i]);
+            exit(-1);
+        }
+    }
+    TOL_RTOL(host_tol) = rtol;
+}
+
+void set_tolerances(double* tol, const double atol, const double rtol, const double* atol_vector)
+{
+    double host_tol[TOL_SIZE];
+    fill_tolerances(host_tol, atol, rtol, atol_vector);
+    cudaErrorCheck( cudaMemcpy(tol, host_tol, TOL_SIZE * sizeof(double), cudaMemcpyHostToDevice) );
+}
+
+void cleanup_tolerances(double* tol)
+{
+    cudaErrorCheck( arena_free(tol) );
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
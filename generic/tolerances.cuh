@@ -0,0 +1,69 @@
+/**
+ * \file
+ * \brief Header definitions for the runtime integration tolerances of the GPU solvers
+ *
+ * The #ATOL and #RTOL options are only the defaults of each memory set: the `tol` array of the
+ * solver_memory struct holds the absolute tolerance of each state vector entry followed by the
+ * relative tolerance, shared by all IVPs, and may be changed between integration calls
+ * (@see accelerInt_context_set_tolerances).  Unlike the CPU solvers, per-IVP tolerance scaling is not supported.
+ */
+
+#ifndef TOLERANCES_CUH
+#define TOLERANCES_CUH
+
+#include "header.cuh"
+#include "solver_options.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The size of the tolerance array: the (NSP) absolute tolerances, followed by the relative tolerance
+#define TOL_SIZE (NSP + 1)
+#ifdef JIT_TOLERANCES
+// the runtime compiled kernels of nvrtc_kernels.cuh, whose tolerances are compile-time constants
+#define TOL_ATOL(tol, i) (JIT_ATOL(i))
+#define TOL_RTOL(tol) (JIT_RTOL)
+#else
+//! The absolute tolerance of state vector entry `i` in the tolerance array `tol`
+#define TOL_ATOL(tol, i) ((tol)[i])
+//! The relative tolerance in the tolerance array `tol`
+#define TOL_RTOL(tol) ((tol)[NSP])
+#endif
+
+/**
+ * \brief Allocates the device tolerance array and sets the default (#ATOL, #RTOL) tolerances
+ * \param[out]      tol             The (#TOL_SIZE) device tolerance array
+ */
+void initialize_tolerances(double** tol);
+
+/**
+ * \brief Sets the tolerances of the device tolerance array `tol` (on the current device)
+ * \param[in,out]   tol             The (#TOL_SIZE) device tolerance array
+ * \param[in]       atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]       rtol            The relative tolerance
+ * \param[in]       atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ *
+ * The program exits if any tolerance is negative, or the relative tolerance is not positive.
+ */
+void set_tolerances(double* tol, const double atol, const double rtol, const double* atol_vector);
+
+/**
+ * \brief Fills the host tolerance array `host_tol` as set_tolerances, which exits if any tolerance is invalid
+ * \param[out]      host_tol        The (#TOL_SIZE) host tolerance array
+ * \param[in]       atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]       rtol            The relative tolerance
+ * \param[in]       atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ */
+void fill_tolerances(double* host_tol, const double atol, const double rtol, const double* atol_vector);
+
+/**
+ * \brief Frees the device tolerance array
+ */
+void cleanup_tolerances(double* tol);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
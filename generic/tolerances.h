@@ -0,0 +1,86 @@
+/**
+ * \file
+ * \brief Header definitions for the runtime integration tolerances of the CPU solvers
+ *
+ * The #ATOL and #RTOL options are only the defaults of each solver instance: the tolerances may be
+ * changed between integration calls (@see accelerInt_set_tolerances), with an optional absolute tolerance
+ * per state vector entry (e.g. loose tolerances on inert or trace species), and an optional factor per IVP
+ * that scales both tolerances of that IVP (@see accelerInt_set_tolerance_scale).  Before each call to
+ * integrate(), the driver loads the tolerances of the current IVP into the (OpenMP thread-private)
+ * #current_tolerances, from which the error norms of the solvers are computed.
+ */
+
+#ifndef TOLERANCES_H
+#define TOLERANCES_H
+
+#include "header.h"
+#include "solver_options.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+/**
+ * \brief The integration tolerances of an IVP
+ */
+typedef struct
+{
+    //! The absolute tolerance of each state vector entry
+    double atol[NSP];
+    //! The relative tolerance
+    double rtol;
+} ivp_tolerances;
+
+//! The tolerances of the IVP currently integrated by this thread
+extern ivp_tolerances current_tolerances;
+#pragma omp threadprivate(current_tolerances)
+
+#ifdef SIMD_LANES
+//! The tolerances of the IVPs of each lane currently integrated by this thread, @see integrate_lanes
+extern ivp_tolerances current_lane_tolerances[SIMD_LANES];
+#pragma omp threadprivate(current_lane_tolerances)
+#endif
+
+/**
+ * \brief Sets the default (#ATOL, #RTOL) tolerances
+ * \param[out]      tol             The tolerances
+ */
+void initialize_tolerances(ivp_tolerances* tol);
+
+/**
+ * \brief Sets the tolerances
+ * \param[out]      tol             The tolerances
+ * \param[in]       atol            The absolute tolerance of all state vector entries, ignored if `atol_vector` is set
+ * \param[in]       rtol            The relative tolerance
+ * \param[in]       atol_vector     The (NSP) absolute tolerance of each state vector entry, or NULL
+ *
+ * The program exits if any tolerance is negative, or the relative tolerance is not positive.
+ */
+void set_tolerances(ivp_tolerances* tol, const double atol, const double rtol, const double* atol_vector);
+
+/**
+ * \brief Loads the tolerances of IVP `tid` into `out`
+ * \param[in]       tol             The tolerances of the solver instance
+ * \param[in]       scale           The per-IVP scaling factors, or NULL
+ * \param[in]       tid             The IVP index
+ * \param[out]      out             The tolerances of the IVP, e.g. #current_tolerances
+ */
+static inline void load_tolerances(const ivp_tolerances* tol, const double* scale, const int tid,
+                                   ivp_tolerances* out)
+{
+    if (scale == NULL)
+    {
+        *out = *tol;
+        return;
+    }
+    const double s = scale[tid];
+    for (int i = 0; i < NSP; ++i)
+        out->atol[i] = s * tol->atol[i];
+    out->rtol = s * tol->rtol;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
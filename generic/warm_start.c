@@ -0,0 +1,70 @@
+/**
+ * \file
+ * \brief Per-IVP warm start storage of the CPU solvers
+ *
+ * Only used by solvers that define SOLVER_WARM_START, if #WARM_START is defined
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "header.h"
+#include "warm_start.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+
+warm_start_memory* current_warm_start = 0;
+#ifdef SIMD_LANES
+warm_start_memory* current_lane_warm_start[SIMD_LANES];
+#endif
+
+/**
+ * \brief Allocates (zeroed) warm start memory for NUM IVPs, if NUM differs from the previous call
+ * \param[in,out]   storage     The warm start storage
+ * \param[in]       NUM         The number of IVPs
+ *
+ * Zeroed warm start memory is invalid, i.e. the first call after a resize is a cold start.
+ */
+void resize_warm_start(warm_start_storage* storage, const int NUM)
+{
+    if (NUM == storage->num)
+        return;
+    free(storage->warm);
+    storage->warm = (warm_start_memory*)calloc(NUM, sizeof(warm_start_memory));
+    if (storage->warm == NULL)
+    {
+        printf("Error: could not allocate the warm start memory for %d IVPs.\n", NUM);
+        exit(-1);
+    }
+    storage->num = NUM;
+}
+
+/**
+ * \brief Returns the warm start memory of IVP `tid`
+ * \param[in]       storage     The warm start storage
+ * \param[in]       tid         The IVP index
+ */
+warm_start_memory* get_warm_start(const warm_start_storage* storage, const int tid)
+{
+    return &storage->warm[tid];
+}
+
+/**
+ * \brief Frees the warm start memory
+ * \param[in,out]   storage     The warm start storage
+ */
+void cleanup_warm_start(warm_start_storage* storage)
+{
+    free(storage->warm);
+    storage->warm = 0;
+    storage->num = 0;
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,107 @@
+/**
+ * \file
+ * \brief Host storage for the per-IVP warm start state of the GPU solvers
+ *
+ * Only used by solvers that define SOLVER_WARM_START, if #WARM_START is defined
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "warm_start.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef SOLVER_WARM_START
+
+/**
+ * \brief Allocates (zeroed) host warm start storage for NUM IVPs, if NUM differs from the previous call
+ * \param[in,out]   storage     The host warm start state
+ * \param[in]       NUM         The number of IVPs
+ *
+ * Zeroed warm start storage is invalid, i.e. the first call after a resize is a cold start.
+ */
+void resize_warm_start(warm_start_storage* storage, const int NUM)
+{
+    if (NUM == storage->num)
+        return;
+    free(storage->warm);
+    storage->warm = (double*)calloc(NUM * WARM_SIZE, sizeof(double));
+    if (storage->warm == NULL)
+    {
+        printf("Error: could not allocate the warm start memory for %d IVPs.\n", NUM);
+        exit(-1);
+    }
+    storage->num = NUM;
+}
+
+/**
+ * \brief Copies the warm start state of a chunk of IVPs into `chunk_warm` (to be copied to the device)
+ * \param[in]       storage     The host warm start state
+ * \param[in]       offset      The index of the first IVP in the chunk
+ * \param[in]       num_cond    The number of IVPs in the chunk
+ * \param[in]       pitch       The leading dimension of `chunk_warm`, i.e. the padded number of IVPs
+ * \param[out]      chunk_warm  The chunk warm start state, stored as `chunk_warm[tid + k * pitch]`
+ */
+void load_warm_start(const warm_start_storage* storage, const int offset, const int num_cond, const int pitch,
+                     double* chunk_warm)
+{
+    for (int k = 0; k < WARM_SIZE; ++k)
+    {
+        for (int tid = 0; tid < num_cond; ++tid)
+        {
+            int index = storage->order == 0 ? offset + tid : storage->order[offset + tid];
+            chunk_warm[tid + k * pitch] = storage->warm[index + k * storage->num];
+        }
+    }
+}
+
+/**
+ * \brief Stores the warm start state of a chunk of IVPs (copied back from the device)
+ * \param[in,out]   storage     The host warm start state
+ * \param[in]       offset      The index of the first IVP in the chunk
+ * \param[in]       num_cond    The number of IVPs in the chunk
+ * \param[in]       pitch       The leading dimension of `chunk_warm`, i.e. the padded number of IVPs
+ * \param[in]       chunk_warm  The chunk warm start state, stored as `chunk_warm[tid + k * pitch]`
+ */
+void store_warm_start(warm_start_storage* storage, const int offset, const int num_cond, const int pitch,
+                      const double* chunk_warm)
+{
+    for (int k = 0; k < WARM_SIZE; ++k)
+    {
+        for (int tid = 0; tid < num_cond; ++tid)
+        {
+            int index = storage->order == 0 ? offset + tid : storage->order[offset + tid];
+            storage->warm[index + k * storage->num] = chunk_warm[tid + k * pitch];
+        }
+    }
+}
+
+/**
+ * \brief Sets the mapping from the IVP indices seen by load_warm_start / store_warm_start to the original IVP indices
+ * \param[in,out]   storage     The host warm start state
+ * \param[in]       order       The mapping, `order[k]` is the original index of IVP `k`.  If NULL, the identity is used.
+ * @see warp_reorder_gather
+ */
+void set_warm_start_order(warm_start_storage* storage, const int* order)
+{
+    storage->order = order;
+}
+
+/**
+ * \brief Frees the host warm start storage
+ * \param[in,out]   storage     The host warm start state
+ */
+void cleanup_warm_start(warm_start_storage* storage)
+{
+    free(storage->warm);
+    storage->warm = 0;
+    storage->num = 0;
+}
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,90 @@
+/**
+ * \file
+ * \brief Header definitions for the per-IVP warm start storage of the GPU solvers
+ *
+ * If #WARM_START is defined, solvers that define SOLVER_WARM_START keep #WARM_SIZE entries
+ * per IVP in the `warm` array of their solver_memory struct, stored as `warm[INDEX(k)]`
+ * (e.g. the step size proposed by the last accepted step).  A zeroed entry denotes a cold start.
+ * As the device memory is reused by the chunks of each call, the warm start state is
+ * kept per IVP on the host, loaded into the chunk before every kernel call and
+ * stored back afterwards.
+ */
+
+#ifndef WARM_START_CUH
+#define WARM_START_CUH
+
+#include "solver_options.cuh"
+#include "solver_props.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef SOLVER_WARM_START
+
+/**
+ * \brief The host warm start state of a solver instance
+ * \param           num         The number of IVPs in #warm
+ * \param           warm        The per-IVP warm start state, stored as `warm[tid + k * num]`
+ * \param           order       The optional mapping of the chunk IVP indices to the original IVP indices
+ *
+ * Zero-initialize before the first call to resize_warm_start.
+ */
+struct warm_start_storage {
+    int num;
+    double* warm;
+    const int* order;
+};
+
+/**
+ * \brief Allocates (zeroed) host warm start storage for NUM IVPs, if NUM differs from the previous call
+ * \param[in,out]   storage     The host warm start state
+ * \param[in]       NUM         The number of IVPs
+ *
+ * Zeroed warm start storage is invalid, i.e. the first call after a resize is a cold start.
+ */
+void resize_warm_start(warm_start_storage* storage, const int NUM);
+
+/**
+ * \brief Copies the warm start state of a chunk of IVPs into `chunk_warm` (to be copied to the device)
+ * \param[in]       storage     The host warm start state
+ * \param[in]       offset      The index of the first IVP in the chunk
+ * \param[in]       num_cond    The number of IVPs in the chunk
+ * \param[in]       pitch       The leading dimension of `chunk_warm`, i.e. the padded number of IVPs
+ * \param[out]      chunk_warm  The chunk warm start state, stored as `chunk_warm[tid + k * pitch]`
+ */
+void load_warm_start(const warm_start_storage* storage, const int offset, const int num_cond, const int pitch,
+                     double* chunk_warm);
+
+/**
+ * \brief Stores the warm start state of a chunk of IVPs (copied back from the device)
+ * \param[in,out]   storage     The host warm start state
+ * \param[in]       offset      The index of the first IVP in the chunk
+ * \param[in]       num_cond    The number of IVPs in the chunk
+ * \param[in]       pitch       The leading dimension of `chunk_warm`, i.e. the padded number of IVPs
+ * \param[in]       chunk_warm  The chunk warm start state, stored as `chunk_warm[tid + k * pitch]`
+ */
+void store_warm_start(warm_start_storage* storage, const int offset, const int num_cond, const int pitch,
+                      const double* chunk_warm);
+
+/**
+ * \brief Sets the mapping from the IVP indices seen by load_warm_start / store_warm_start to the original IVP indices
+ * \param[in,out]   storage     The host warm start state
+ * \param[in]       order       The mapping, `order[k]` is the original index of IVP `k`.  If NULL, the identity is used.
+ * @see warp_reorder_gather
+ */
+void set_warm_start_order(warm_start_storage* storage, const int* order);
+
+/**
+ * \brief Frees the host warm start storage
+ * \param[in,out]   storage     The host warm start state
+ */
+void cleanup_warm_start(warm_start_storage* storage);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * \file
+ * \brief Header definitions for the per-IVP warm start storage of the CPU solvers
+ *
+ * If #WARM_START is defined, solvers that define SOLVER_WARM_START keep a `warm_start_memory`
+ * struct per IVP across calls to intDriver, e.g. to reuse the Jacobian and its factorizations
+ * of the previous call.  The memory is owned by the solver instance (@see warm_start_storage), and
+ * the driver sets the (OpenMP thread-private) #current_warm_start to the memory of the current IVP
+ * before each call to integrate().
+ */
+
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include "solver_options.h"
+#include "solver_props.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+
+//! The warm start memory of the IVP currently integrated by this thread
+extern warm_start_memory* current_warm_start;
+#pragma omp threadprivate(current_warm_start)
+
+#ifdef SIMD_LANES
+//! The warm start memory of the IVPs of each lane currently integrated by this thread (NULL for unused lanes), @see integrate_lanes
+extern warm_start_memory* current_lane_warm_start[SIMD_LANES];
+#pragma omp threadprivate(current_lane_warm_start)
+#endif
+
+/**
+ * \brief The per-IVP warm start memory of a solver instance
+ * \param           num         The number of IVPs in #warm
+ * \param           warm        The warm start memory of each IVP
+ *
+ * Zero-initialize before the first call to resize_warm_start.
+ */
+typedef struct
+{
+    int num;
+    warm_start_memory* warm;
+} warm_start_storage;
+
+/**
+ * \brief Allocates (zeroed) warm start memory for NUM IVPs, if NUM differs from the previous call
+ * \param[in,out]   storage     The warm start storage
+ * \param[in]       NUM         The number of IVPs
+ *
+ * Zeroed warm start memory is invalid, i.e. the first call after a resize is a cold start.
+ */
+void resize_warm_start(warm_start_storage* storage, const int NUM);
+
+/**
+ * \brief Returns the warm start memory of IVP `tid`
+ * \param[in]       storage     The warm start storage
+ * \param[in]       tid         The IVP index
+ */
+warm_start_memory* get_warm_start(const warm_start_storage* storage, const int tid);
+
+/**
+ * \brief Frees the warm start memory
+ * \param[in,out]   storage     The warm start storage
+ */
+void cleanup_warm_start(warm_start_storage* storage);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * \file
+ * \brief Header definitions for the warp-per-IVP execution mode of the GPU solvers
+ *
+ * With one thread per IVP (#INDEX), each thread of a large mechanism streams its own NSP-long vectors through
+ * the L1, and the occupancy is limited by the per-thread working set.  If #WARP_IVP is selected (the WARP_IVP
+ * option is enabled, the solver is RKC without #RKC_SINGLE and NSP is at least #WARP_IVP_MIN_NSP), intDriver
+ * instead launches #WARP_IVP_SIZE threads (a warp, or a sub-warp group) per IVP: the threads of a group
+ * integrate one IVP together, with the vector operations distributed over the lanes of the group (entry `i` is
+ * updated by lane `i % WARP_IVP_SIZE`) and the norms computed by shuffle reductions.  The step size control is
+ * evaluated redundantly by every lane, hence needs no broadcast.
+ *
+ * The solver vectors of an IVP are stored contiguously (#IVP_VEC), such that the lanes of a group access
+ * consecutive entries.  The state vectors, parameters and results keep the column-major layout of the
+ * driver, indexed by the IVP slot (#IVP_INDEX) rather than the thread.  The right hand side is evaluated by
+ * the `dydt_warp` function of the mechanism (see the van der Pol example), which is called by all lanes
+ * of the group on the contiguous vectors of the IVP.
+ */
+
+#ifndef WARP_IVP_CUH
+#define WARP_IVP_CUH
+
+#include "header.cuh"
+#include "solver_options.cuh"
+#include "gpu_macros.cuh"
+#include "gpu_memory.cuh"
+#include "launch_bounds.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifndef WARP_IVP_MIN_NSP
+    //! The minimum number of species for which the warp-per-IVP mode is selected
+    #define WARP_IVP_MIN_NSP (64)
+#endif
+#ifndef WARP_IVP_SIZE
+    //! The number of threads (a power of two, at most 32) that integrate one IVP
+    #define WARP_IVP_SIZE (32)
+#endif
+
+#if defined(RKC) && defined(WARP_IVP_AUTO) && !defined(PERSISTENT_KERNEL) && !defined(MANAGED_MEMORY) \
+    && !defined(RKC_SINGLE) && (NSP >= WARP_IVP_MIN_NSP)
+    //! The solver integrates each IVP with a group of #WARP_IVP_SIZE threads
+    #define WARP_IVP
+    //! The number of threads intDriver is launched with per IVP slot
+    #define DRIVER_THREADS_PER_IVP (WARP_IVP_SIZE)
+#endif
+
+#ifdef WARP_IVP
+
+#if (WARP_IVP_SIZE > 32) || (WARP_IVP_SIZE & (WARP_IVP_SIZE - 1)) || (TARGET_BLOCK_SIZE % WARP_IVP_SIZE)
+    #error "WARP_IVP_SIZE must be a power of two, at most 32, that divides the block size"
+#endif
+
+//! The lane of this thread in the group of its IVP
+#define IVP_LANE (threadIdx.x % WARP_IVP_SIZE)
+//! The IVP slot of this thread
+#define IVP_ID (T_ID / WARP_IVP_SIZE)
+//! The number of IVP slots of the grid, i.e. the offset between the entries of the column-major arrays
+#define IVP_DIM (GRID_DIM / WARP_IVP_SIZE)
+//! The entry `i` of a column-major (driver / mechanism) array of this IVP, the counterpart of #INDEX
+#define IVP_INDEX(i) (IVP_ID + (i) * IVP_DIM)
+//! The entry `i` of a contiguous (solver) vector of `n` entries per IVP
+#define IVP_VEC(n, i) (IVP_ID * (n) + (i))
+//! Loops `i` over the entries of an NSP-long vector that are owned by this lane
+#define IVP_FOR(i) for (int i = IVP_LANE; i < NSP; i += WARP_IVP_SIZE)
+
+/**
+ * \brief The mask of the lanes of the group of this thread
+ */
+__device__ __forceinline__
+unsigned ivp_mask()
+{
+    const unsigned group = (WARP_IVP_SIZE == 32) ? 0xffffffffu : ((1u << WARP_IVP_SIZE) - 1u);
+    return group << ((threadIdx.x % 32) & ~(WARP_IVP_SIZE - 1));
+}
+
+/**
+ * \brief Synchronizes the lanes of the group, e.g. between writing and reading another lane's entries
+ */
+__device__ __forceinline__
+void ivp_sync()
+{
+    __syncwarp(ivp_mask());
+}
+
+/**
+ * \brief Returns the sum of `val` over the lanes of the group, in all lanes
+ */
+__device__ __forceinline__
+double ivp_sum(double val)
+{
+    const unsigned mask = ivp_mask();
+    for (int offset = WARP_IVP_SIZE / 2; offset > 0; offset /= 2)
+        val += __shfl_xor_sync(mask, val, offset, WARP_IVP_SIZE);
+    return val;
+}
+
+/**
+ * \brief The right hand side of the mechanism, evaluated by the group of an IVP
+ * \param[in]       t           The current system time
+ * \param[in]       pr          The system constant variable (pressure / density)
+ * \param[in]       y           The (contiguous) state vector of the IVP
+ * \param[out]      dy          The (contiguous) derivative vector of the IVP
+ * \param[in]       lane        The lane of the calling thread in the group, i.e. #IVP_LANE
+ * \param[in]       d_mem       The mechanism_memory struct, whose per-IVP storage is indexed by #IVP_INDEX
+ *
+ * Called by all #WARP_IVP_SIZE lanes of the group, and followed by ivp_sync.
+ */
+__device__
+void dydt_warp (const double t, const double pr, const double * __restrict__ y, double * __restrict__ dy,
+                const int lane, const mechanism_memory * __restrict__ d_mem);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
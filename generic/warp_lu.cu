@@ -0,0 +1,229 @@
+/**
+ * \file
+ * \brief Implementation of the warp-cooperative LU factorization of the GPU solvers
+ *
+ * The threads that call a factorization together are given by `__activemask()`.  As other threads of
+ * the same warp may (on devices with independent thread scheduling) enter a factorization concurrently,
+ * the shared memory of the warp is protected by a lock, acquired by the lowest active lane.
+ */
+
+#include "warp_lu.cuh"
+#include "gpu_macros.cuh"
+
+#ifdef WARP_LU
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+//! The dynamic shared memory of the block, of which the first #SHARED_SIZE bytes belong to the mechanism
+extern __shared__ double warp_lu_shared[];
+
+//! The warp width
+#define WARP_LU_LANES (32)
+
+/**
+ * \brief The shared memory of this warp: the lock, the pivot, the per-lane results, and the matrix
+ */
+__device__ __forceinline__
+char* warp_lu_memory() {
+    return ((char*)warp_lu_shared) + SHARED_SIZE + (threadIdx.x / WARP_LU_LANES) * WARP_LU_WARP_SIZE;
+}
+
+__device__
+void warp_lu_init() {
+    if (threadIdx.x % WARP_LU_LANES == 0)
+        *((int*)warp_lu_memory()) = 0;
+    __syncthreads();
+}
+
+/**
+ * \brief Acquires the shared memory of this warp for the threads in `mask`
+ */
+__device__ __forceinline__
+void warp_lu_lock(int* lock, const unsigned mask, const int lane) {
+    if (lane == __ffs(mask) - 1) {
+        while (atomicCAS(lock, 0, 1) != 0);
+    }
+    __syncwarp(mask);
+}
+
+/**
+ * \brief Releases the shared memory of this warp
+ */
+__device__ __forceinline__
+void warp_lu_unlock(int* lock, const unsigned mask, const int lane) {
+    __syncwarp(mask);
+    if (lane == __ffs(mask) - 1) {
+        __threadfence_block();
+        atomicExch(lock, 0);
+    }
+}
+
+__device__
+void warp_getLU (double* __restrict__ A, int* __restrict__ ipiv, int* __restrict__ info) {
+    const unsigned mask = __activemask();
+    const int lane = threadIdx.x % WARP_LU_LANES;
+    const int rank = __popc(mask & ((1u << lane) - 1));
+    const int count = __popc(mask);
+    const int warp_base = T_ID - lane;
+
+    char* const memory = warp_lu_memory();
+    int* const lock = (int*)memory;
+    int* const pivot = &lock[1];
+    int* const result = &lock[2];
+    double* const buf = (double*)(memory + WARP_LU_HEADER_SIZE);
+
+    warp_lu_lock(lock, mask, lane);
+    result[lane] = *info;
+    for (unsigned todo = mask; todo; todo &= todo - 1) {
+        const int src = __ffs(todo) - 1;
+        const int tid = warp_base + src;
+
+        // stage the matrix of lane src
+        for (int k = rank; k < NSP * NSP; k += count)
+            buf[k] = A[tid + k * GRID_DIM];
+        __syncwarp(mask);
+
+        for (int j = 0; j < NSP; ++j) {
+            // find pivot and test for singularity
+            if (rank == 0) {
+                int jp = j;
+                double maxVal = fabs(buf[j + j * NSP]);
+                for (int i = j + 1; i < NSP; ++i) {
+                    if (fabs(buf[i + j * NSP]) > maxVal) {
+                        jp = i;
+                        maxVal = fabs(buf[i + j * NSP]);
+                    }
+                }
+                ipiv[tid + j * GRID_DIM] = jp;
+                *pivot = maxVal > 0.0 ? jp : -1;
+                if (*pivot < 0)
+                    result[src] = j + 1;
+            }
+            __syncwarp(mask);
+            const int jp = *pivot;
+            if (jp < 0)
+                break;
+
+            // apply interchange to all columns
+            if (jp != j) {
+                for (int k = rank; k < NSP; k += count) {
+                    double temp = buf[j + k * NSP];
+                    buf[j + k * NSP] = buf[jp + k * NSP];
+                    buf[jp + k * NSP] = temp;
+                }
+            }
+            __syncwarp(mask);
+
+            // compute elements j+1:n-1 of the jth column
+            const double scale = 1.0 / buf[j + j * NSP];
+            for (int i = j + 1 + rank; i < NSP; i += count)
+                buf[i + j * NSP] *= scale;
+            __syncwarp(mask);
+
+            // update trailing submatrix, each lane updates a strided set of rows
+            for (int k = j + 1; k < NSP; ++k) {
+                const double temp = buf[j + k * NSP];
+                if (fabs(temp) > 0.0) {
+                    for (int i = j + 1 + rank; i < NSP; i += count)
+                        buf[i + k * NSP] -= buf[i + j * NSP] * temp;
+                }
+            }
+            __syncwarp(mask);
+        }
+
+        for (int k = rank; k < NSP * NSP; k += count)
+            A[tid + k * GRID_DIM] = buf[k];
+        __syncwarp(mask);
+    }
+    *info = result[lane];
+    warp_lu_unlock(lock, mask, lane);
+}
+
+__device__
+void warp_getComplexLU (cuDoubleComplex* __restrict__ A, int* __restrict__ ipiv, int* __restrict__ info) {
+    const unsigned mask = __activemask();
+    const int lane = threadIdx.x % WARP_LU_LANES;
+    const int rank = __popc(mask & ((1u << lane) - 1));
+    const int count = __popc(mask);
+    const int warp_base = T_ID - lane;
+
+    char* const memory = warp_lu_memory();
+    int* const lock = (int*)memory;
+    int* const pivot = &lock[1];
+    int* const result = &lock[2];
+    cuDoubleComplex* const buf = (cuDoubleComplex*)(memory + WARP_LU_HEADER_SIZE);
+
+    warp_lu_lock(lock, mask, lane);
+    result[lane] = *info;
+    for (unsigned todo = mask; todo; todo &= todo - 1) {
+        const int src = __ffs(todo) - 1;
+        const int tid = warp_base + src;
+
+        // stage the matrix of lane src
+        for (int k = rank; k < NSP * NSP; k += count)
+            buf[k] = A[tid + k * GRID_DIM];
+        __syncwarp(mask);
+
+        for (int j = 0; j < NSP; ++j) {
+            // find pivot and test for singularity
+            if (rank == 0) {
+                int jp = j;
+                double maxVal = cuCabs(buf[j + j * NSP]);
+                for (int i = j + 1; i < NSP; ++i) {
+                    if (cuCabs(buf[i + j * NSP]) > maxVal) {
+                        jp = i;
+                        maxVal = cuCabs(buf[i + j * NSP]);
+                    }
+                }
+                ipiv[tid + j * GRID_DIM] = jp;
+                *pivot = maxVal > 0.0 ? jp : -1;
+                if (*pivot < 0)
+                    result[src] = j + 1;
+            }
+            __syncwarp(mask);
+            const int jp = *pivot;
+            if (jp < 0)
+                break;
+
+            // apply interchange to all columns
+            if (jp != j) {
+                for (int k = rank; k < NSP; k += count) {
+                    cuDoubleComplex temp = buf[j + k * NSP];
+                    buf[j + k * NSP] = buf[jp + k * NSP];
+                    buf[jp + k * NSP] = temp;
+                }
+            }
+            __syncwarp(mask);
+
+            // compute elements j+1:n-1 of the jth column
+            const cuDoubleComplex scale = cuCdiv(make_cuDoubleComplex(1.0, 0.0), buf[j + j * NSP]);
+            for (int i = j + 1 + rank; i < NSP; i += count)
+                buf[i + j * NSP] = cuCmul(buf[i + j * NSP], scale);
+            __syncwarp(mask);
+
+            // update trailing submatrix, each lane updates a strided set of rows
+            for (int k = j + 1; k < NSP; ++k) {
+                const cuDoubleComplex temp = buf[j + k * NSP];
+                if (cuCabs(temp) > 0.0) {
+                    for (int i = j + 1 + rank; i < NSP; i += count)
+                        buf[i + k * NSP] = cuCsub(buf[i + k * NSP], cuCmul(buf[i + j * NSP], temp));
+                }
+            }
+            __syncwarp(mask);
+        }
+
+        for (int k = rank; k < NSP * NSP; k += count)
+            A[tid + k * GRID_DIM] = buf[k];
+        __syncwarp(mask);
+    }
+    *info = result[lane];
+    warp_lu_unlock(lock, mask, lane);
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
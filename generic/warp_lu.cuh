@@ -0,0 +1,86 @@
+/**
+ * \file
+ * \brief Header definitions for the warp-cooperative LU factorization of the GPU solvers
+ *
+ * The dense factorizations getLU / getComplexLU are performed by a single thread per IVP, strided
+ * through global memory by #INDEX.  For larger mechanisms #WARP_LU is selected automatically
+ * (if the WARP_LU option is enabled, NSP is at least #WARP_LU_MIN_NSP and the matrices fit in shared
+ * memory): the threads of a warp that factor a matrix at the same time then cooperatively factor each
+ * of their matrices in turn, staged in the shared memory of the warp.
+ *
+ * The intDriver kernel is launched with #SOLVER_SHARED_SIZE additional bytes of dynamic shared
+ * memory, of which each warp owns one (NSP x NSP) complex matrix, @see WARP_LU_WARP_SIZE.
+ */
+
+#ifndef WARP_LU_CUH
+#define WARP_LU_CUH
+
+#include "header.cuh"
+#include "solver_options.cuh"
+#include "launch_bounds.cuh"
+#include <cuComplex.h>
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifndef WARP_LU_MIN_NSP
+    //! The minimum number of species for which the warp-cooperative factorization is selected
+    #define WARP_LU_MIN_NSP (16)
+#endif
+
+//! The maximum dynamic shared memory per block (in bytes) that may be launched without opting in
+#define WARP_LU_MAX_SHARED (49152)
+//! The number of warps per block
+#define WARP_LU_WARPS ((TARGET_BLOCK_SIZE + 31) / 32)
+//! The size (in bytes) of the lock, pivot and per-lane result entries of a warp, padded to the matrix alignment
+#define WARP_LU_HEADER_SIZE (144)
+//! The shared memory (in bytes) of a warp: the header and one (NSP x NSP) cuDoubleComplex matrix
+#define WARP_LU_WARP_SIZE (WARP_LU_HEADER_SIZE + 16 * NSP * NSP)
+//! The shared memory (in bytes) of a block
+#define WARP_LU_SHARED_SIZE (WARP_LU_WARPS * WARP_LU_WARP_SIZE)
+
+#if defined(RADAU2A) && defined(WARP_LU_AUTO) && !defined(MIXED_PRECISION) && !defined(HESSENBERG_RADAU) \
+    && (NSP >= WARP_LU_MIN_NSP) && (SHARED_SIZE + WARP_LU_SHARED_SIZE <= WARP_LU_MAX_SHARED)
+    //! The Radau-IIa solver factors its matrices with the warp-cooperative factorization
+    #define WARP_LU
+    //! The dynamic shared memory (in bytes) per block required by the solver, in addition to #SHARED_SIZE
+    #define SOLVER_SHARED_SIZE (WARP_LU_SHARED_SIZE)
+#endif
+
+#ifdef WARP_LU
+
+/**
+ * \brief Initializes the shared memory of the warp-cooperative factorization
+ *
+ * Must be called by all threads of a block on entry to the kernel
+ */
+__device__
+void warp_lu_init();
+
+/**
+ * \brief Computes the LU factorization of the (NSP x NSP) matrix `A` with partial pivoting, @see getLU
+ *
+ * All threads of the warp that call this function together (i.e. the active threads) factor the
+ * matrix of each of these threads in turn in shared memory.
+ *
+ * \param[in,out]   A           The (global, #INDEX strided) matrix to factorize
+ * \param[out]      ipiv        The (0-based) pivot indicies
+ * \param[out]      info        Set to `j + 1` if the `j`th pivot is zero, otherwise unchanged
+ */
+__device__
+void warp_getLU (double* __restrict__ A, int* __restrict__ ipiv, int* __restrict__ info);
+
+/**
+ * \brief Computes the LU factorization of the complex (NSP x NSP) matrix `A` with partial pivoting, @see warp_getLU
+ */
+__device__
+void warp_getComplexLU (cuDoubleComplex* __restrict__ A, int* __restrict__ ipiv, int* __restrict__ info);
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+/**
+ * \file
+ * \brief Warp-coherent reordering of IVPs by a stiffness proxy on the GPU
+ *
+ * The IVPs are sorted by descending proxy value, hence the stiffest IVPs are
+ * grouped in the first warps.  The permutation is also passed to the statistics,
+ * such that these are always reported in the original IVP order.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "header.cuh"
+#include "warp_reorder.cuh"
+#include "host_state.cuh"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+/**
+ * \brief Comparison function for qsort, ordering the sort keys by descending proxy value
+ */
+static int compare_key(const void* a, const void* b)
+{
+    const reorder_key* ka = (const reorder_key*)a;
+    const reorder_key* kb = (const reorder_key*)b;
+    if (ka->key > kb->key)
+        return -1;
+    if (ka->key < kb->key)
+        return 1;
+    //keep the original ordering for equal keys, to retain memory locality
+    return ka->index - kb->index;
+}
+
+/**
+ * \brief (Re)allocates the reordering buffers for NUM IVPs
+ */
+static void allocate_reorder(warp_reorder_state* reorder, const int NUM)
+{
+    if (NUM == reorder->num)
+        return;
+    cleanup_warp_reorder(reorder);
+    reorder->order = (int*)malloc(NUM * sizeof(int));
+    reorder->keys = (double*)malloc(NUM * sizeof(double));
+    reorder->sorted = (reorder_key*)malloc(NUM * sizeof(reorder_key));
+    reorder->y_sorted = (double*)malloc(NUM * NSP * sizeof(double));
+    reorder->var_sorted = (double*)malloc(NUM * sizeof(double));
+    for (int i = 0; i < NUM; ++i)
+    {
+        reorder->order[i] = i;
+        reorder->keys[i] = 0;
+    }
+#ifdef WARP_REORDER_STEPS
+    reorder->steps_start = (int*)malloc(NUM * sizeof(int));
+    reorder->steps_end = (int*)malloc(NUM * sizeof(int));
+    reorder->stats_temp = (int*)malloc(NUM * NUM_STATS * sizeof(int));
+#endif
+    reorder->num = NUM;
+}
+
+#ifdef WARP_REORDER_STEPS
+/**
+ * \brief Stores the current (accepted + rejected) internal step counts of each IVP in `steps`
+ */
+static void get_step_counts(host_state* state, const int NUM, int* steps)
+{
+    int* stats_temp = state->reorder.stats_temp;
+    get_statistics(&state->stats, NUM, stats_temp);
+    for (int i = 0; i < NUM; ++i)
+        steps[i] = stats_temp[i + STAT_STEPS * NUM] + stats_temp[i + STAT_REJECTED * NUM];
+}
+#endif
+
+/**
+ * \brief Sorts the IVPs by the stiffness proxy into the reordering buffers of `state`
+ *
+ * \param[in,out]   state       The host state of the solver instance, whose statistics (and warm start state)
+ *                              are mapped to the original IVP order
+ * \param[in]       NUM         The number of IVPs (leading dimension of all arrays)
+ * \param[in]       y_host      The state vectors
+ * \param[in]       var_host    The parameters
+ * \param[out]      y_sorted    Set to the sorted state vectors
+ * \param[out]      var_sorted  Set to the sorted parameters
+ *
+ * If #WARP_REORDER_STEPS is defined, the step counts measured by the last
+ * warp_reorder_scatter are used, hence the first step uses the original order.
+ */
+void warp_reorder_gather(host_state* state, const int NUM, const double* y_host, const double* var_host,
+                         double** y_sorted, double** var_sorted)
+{
+    warp_reorder_state* reorder = &state->reorder;
+    allocate_reorder(reorder, NUM);
+#ifdef WARP_REORDER_STEPS
+    get_step_counts(state, NUM, reorder->steps_start);
+#else
+    for (int i = 0; i < NUM; ++i)
+        reorder->keys[i] = y_host[i + WARP_REORDER_INDEX * NUM];
+#endif
+    for (int i = 0; i < NUM; ++i)
+    {
+        reorder->sorted[i].key = reorder->keys[i];
+        reorder->sorted[i].index = i;
+    }
+    qsort(reorder->sorted, NUM, sizeof(reorder_key), compare_key);
+
+    for (int k = 0; k < NUM; ++k)
+    {
+        int tid = reorder->sorted[k].index;
+        reorder->order[k] = tid;
+        reorder->var_sorted[k] = var_host[tid];
+        for (int i = 0; i < NSP; ++i)
+            reorder->y_sorted[k + i * NUM] = y_host[tid + i * NUM];
+    }
+    set_statistics_order(&state->stats, reorder->order);
+#ifdef SOLVER_WARM_START
+    set_warm_start_order(&state->warm, reorder->order);
+#endif
+    *y_sorted = reorder->y_sorted;
+    *var_sorted = reorder->var_sorted;
+}
+
+/**
+ * \brief Scatters the sorted state vectors (as returned by warp_reorder_gather) back into `y_host`
+ *
+ * \param[in,out]   state       The host state of the solver instance
+ * \param[in]       NUM         The number of IVPs (leading dimension of `y_host`)
+ * \param[out]      y_host      The state vectors in the original order
+ */
+void warp_reorder_scatter(host_state* state, const int NUM, double* y_host)
+{
+    warp_reorder_state* reorder = &state->reorder;
+    for (int k = 0; k < NUM; ++k)
+    {
+        int tid = reorder->order[k];
+        for (int i = 0; i < NSP; ++i)
+            y_host[tid + i * NUM] = reorder->y_sorted[k + i * NUM];
+    }
+    set_statistics_order(&state->stats, 0);
+#ifdef SOLVER_WARM_START
+    set_warm_start_order(&state->warm, 0);
+#endif
+#ifdef WARP_REORDER_STEPS
+    //the proxy for the next step is the work done in this step
+    get_step_counts(state, NUM, reorder->steps_end);
+    for (int i = 0; i < NUM; ++i)
+        reorder->keys[i] = reorder->steps_end[i] - reorder->steps_start[i];
+#endif
+}
+
+/**
+ * \brief Frees the reordering buffers
+ * \param[in,out]   reorder     The reordering buffers
+ */
+void cleanup_warp_reorder(warp_reorder_state* reorder)
+{
+    free(reorder->order);
+    free(reorder->keys);
+    free(reorder->sorted);
+    free(reorder->y_sorted);
+    free(reorder->var_sorted);
+    reorder->order = 0;
+    reorder->keys = 0;
+    reorder->sorted = 0;
+    reorder->y_sorted = 0;
+    reorder->var_sorted = 0;
+#ifdef WARP_REORDER_STEPS
+    free(reorder->steps_start);
+    free(reorder->steps_end);
+    free(reorder->stats_temp);
+    reorder->steps_start = 0;
+    reorder->steps_end = 0;
+    reorder->stats_temp = 0;
+#endif
+    reorder->num = 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
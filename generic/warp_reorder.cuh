@@ -0,0 +1,97 @@
+/**
+ * \file
+ * \brief Definitions for the warp-coherent reordering of IVPs on the GPU
+ *
+ * If #WARP_REORDER is defined, the IVPs are sorted by a cheap stiffness proxy before each
+ * global integration step, such that the IVPs in a warp (and block) have similar amounts of work,
+ * and are scattered back to their original location afterwards.  The proxy is either:
+ *   - the state vector entry #WARP_REORDER_INDEX (e.g. the temperature), or
+ *   - the number of internal (accepted + rejected) integrator steps of the previous global step,
+ *     if #WARP_REORDER_STEPS is defined (requires #STATISTICS)
+ */
+
+#ifndef WARP_REORDER_CUH
+#define WARP_REORDER_CUH
+
+#include "solver_options.cuh"
+
+#if defined(WARP_REORDER_STEPS) && !defined(STATISTICS)
+    #error "Reordering IVPs by the previous step count requires the STATISTICS option"
+#endif
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+/**
+ * \brief A sort key of the reordering, i.e. the stiffness proxy of an (original) IVP index
+ */
+struct reorder_key {
+    double key;
+    int index;
+};
+
+/**
+ * \brief The reordering buffers of a solver instance
+ * \param           num             The number of IVPs in the buffers
+ * \param           order           The permutation, `order[k]` is the original index of the IVP in sorted slot `k`
+ * \param           keys            The stiffness proxy of each (original) IVP
+ * \param           sorted          The sort keys (gathered from #keys), sorted by descending proxy value
+ * \param           y_sorted        The sorted state vectors
+ * \param           var_sorted      The sorted parameters
+ * \param           steps_start     The internal step counts of each IVP at the start of the current global step (if #WARP_REORDER_STEPS is defined)
+ * \param           steps_end       The internal step counts of each IVP at the end of the current global step (if #WARP_REORDER_STEPS is defined)
+ * \param           stats_temp      Storage for the statistics (if #WARP_REORDER_STEPS is defined)
+ *
+ * Zero-initialize before the first call to warp_reorder_gather.
+ */
+struct warp_reorder_state {
+    int num;
+    int* order;
+    double* keys;
+    reorder_key* sorted;
+    double* y_sorted;
+    double* var_sorted;
+#ifdef WARP_REORDER_STEPS
+    int* steps_start;
+    int* steps_end;
+    int* stats_temp;
+#endif
+};
+
+struct host_state;
+
+/**
+ * \brief Sorts the IVPs by the stiffness proxy into the reordering buffers of `state`
+ *
+ * \param[in,out]   state       The host state of the solver instance, whose statistics (and warm start state)
+ *                              are mapped to the original IVP order
+ * \param[in]       NUM         The number of IVPs (leading dimension of all arrays)
+ * \param[in]       y_host      The state vectors
+ * \param[in]       var_host    The parameters
+ * \param[out]      y_sorted    Set to the sorted state vectors
+ * \param[out]      var_sorted  Set to the sorted parameters
+ */
+void warp_reorder_gather(host_state* state, const int NUM, const double* y_host, const double* var_host,
+                         double** y_sorted, double** var_sorted);
+
+/**
+ * \brief Scatters the sorted state vectors (as returned by warp_reorder_gather) back into `y_host`
+ *
+ * \param[in,out]   state       The host state of the solver instance
+ * \param[in]       NUM         The number of IVPs (leading dimension of `y_host`)
+ * \param[out]      y_host      The state vectors in the original order
+ */
+void warp_reorder_scatter(host_state* state, const int NUM, double* y_host);
+
+/**
+ * \brief Frees the reordering buffers
+ * \param[in,out]   reorder     The reordering buffers
+ */
+void cleanup_warp_reorder(warp_reorder_state* reorder);
+
+#ifdef GENERATE_DOCS
+}
+#endif
+
+#endif
@@ -0,0 +1,120 @@
+#! /usr/bin/env python2.7
+"""
+Tunes the launch configuration of the GPU integrators for the current
+mechanism and GPU 0: each candidate block size, cache configuration and
+occupancy target is built and benchmarked on a sample of the initial
+conditions (see benchmark.py), and the fastest is stored per device in
+a cache file.  Subsequent builds with LAUNCH_TUNING=<cache file> use the
+stored configuration.
+"""
+from __future__ import print_function
+import os
+import sys
+import json
+import itertools
+from argparse import ArgumentParser
+
+import benchmark
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), 'site_scons'))
+from buildutils import gpu_device_name, launch_options
+
+
+def tune(cache, num_cond, block_sizes, cache_configs, min_blocks, trials, warmup,
+         blacklist=[], scons_args=[]):
+    """
+    Benchmarks all candidate launch configurations, and stores the one with the
+    smallest total median runtime of the GPU solvers in `cache`
+    """
+    device = gpu_device_name()
+    if device is None:
+        print('Error: could not query the name of GPU 0 via nvidia-smi')
+        sys.exit(-1)
+
+    records = 'launch_tuner.records'
+    results = []
+    for block_size, cache_config, blocks in itertools.product(block_sizes, cache_configs, min_blocks):
+        config = dict(zip(launch_options, [block_size, cache_config, blocks]))
+        print('Launch configuration:', config)
+        args = ['LAUNCH_TUNING='] + ['{}={}'.format(k, v) for k, v in sorted(config.items())]
+        benchmark.run(records, [], [num_cond], ['cuda'], trials, warmup,
+                      blacklist=blacklist, scons_args=scons_args + args)
+        data = benchmark.collect(records, 'launch_tuner')
+        if not data:
+            print('Error: no GPU benchmark records were written for', config)
+            sys.exit(-1)
+        results.append((sum(record['median'] for record in data), config))
+        print('total median: {:.6e} s'.format(results[-1][0]))
+
+    best_time, best = min(results, key=lambda x: x[0])
+    entries = {}
+    if os.path.isfile(cache):
+        with open(cache, 'r') as file:
+            entries = json.load(file)
+    entries[device] = dict(best, time=best_time, num_cond=num_cond)
+    with open(cache, 'w') as file:
+        json.dump(entries, file, indent=2, sort_keys=True)
+    print('Best launch configuration for {}: {} ({:.6e} s)'.format(device, best, best_time))
+
+    # and rebuild with the stored configuration
+    benchmark.run(records, [], [num_cond], ['cuda'], trials, warmup,
+                  blacklist=blacklist,
+                  scons_args=scons_args + ['LAUNCH_TUNING={}'.format(os.path.abspath(cache))])
+    return best
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='Tunes the block size, cache configuration and '
+                                        'occupancy target of the GPU integrators')
+    parser.add_argument('-nc', '--num_cond',
+                        type=int,
+                        required=True,
+                        help='The # of IVPs (of the initial conditions) to benchmark with')
+    parser.add_argument('-b', '--block_sizes',
+                        type=str,
+                        required=False,
+                        default='32,64,128,256',
+                        help='Comma separated list of block sizes to test')
+    parser.add_argument('-c', '--cache_configs',
+                        type=str,
+                        required=False,
+                        default='L1,shared,equal',
+                        help='Comma separated list of cache configurations to test '
+                             '(see the CACHE_CONFIG SCons option)')
+    parser.add_argument('-m', '--min_blocks',
+                        type=str,
+                        required=False,
+                        default='0,2,4',
+                        help='Comma separated list of the minimum resident blocks per '
+                             'multiprocessor to test (zero for no __launch_bounds__ limit)')
+    parser.add_argument('-s', '--solver_blacklist',
+                        required=False,
+                        default='',
+                        help='The solvers to not run')
+    parser.add_argument('-r', '--trials',
+                        type=int,
+                        required=False,
+                        default=3,
+                        help='The number of timed trials per run')
+    parser.add_argument('-w', '--warmup',
+                        type=int,
+                        required=False,
+                        default=1,
+                        help='The number of untimed warm-up trials per run')
+    parser.add_argument('-o', '--output',
+                        required=False,
+                        default='launch_tuning.json',
+                        help='The launch configuration cache file')
+    parser.add_argument('scons_args',
+                        nargs='*',
+                        help='Additional options passed to scons, e.g. mechanism_dir=...')
+    args = parser.parse_args()
+
+    tune(args.output,
+         num_cond=args.num_cond,
+         block_sizes=[int(x) for x in args.block_sizes.split(',') if x.strip()],
+         cache_configs=[x.strip() for x in args.cache_configs.split(',') if x.strip()],
+         min_blocks=[int(x) for x in args.min_blocks.split(',') if x.strip()],
+         trials=args.trials,
+         warmup=args.warmup,
+         blacklist=[x.strip() for x in args.solver_blacklist.split(',') if x.strip()],
+         scons_args=args.scons_args)
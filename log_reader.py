@@ -0,0 +1,189 @@
+#! /usr/bin/env python2.7
+"""
+Reads the binary logs written by the integrator executables (see generic/log_writer.h),
+in either the default row-major layout, the (memory mapped) column-major layout or the
+compressed layout
+"""
+import zlib
+import numpy as np
+
+#: the magic bytes of the column-major log format
+LOG_MAGIC = b'ACCINTLG'
+#: the header of the column-major log format
+header_dtype = np.dtype([('magic', 'S8'), ('num', '<i8'), ('nvar', '<i8'),
+                         ('num_steps', '<i8'), ('ivp_stride', '<i8'),
+                         ('step_stride', '<i8')])
+
+#: the magic bytes of the compressed log format
+LOG_COMPRESSED_MAGIC = b'ACCINTLZ'
+#: the header of the compressed log format
+compressed_header_dtype = np.dtype([('magic', 'S8'), ('num', '<i8'), ('nvar', '<i8'),
+                                    ('num_steps', '<i8'), ('ivp_stride', '<i8'),
+                                    ('step_stride', '<i8'), ('chunk_ivps', '<i8'),
+                                    ('lossy_bits', '<i8'), ('index_offset', '<i8')])
+#: the snapshot index of the compressed log format
+index_dtype = np.dtype([('t', '<f8'), ('offset', '<i8')])
+
+
+def is_column_major(filename):
+    with open(filename, 'rb') as file:
+        return file.read(len(LOG_MAGIC)) == LOG_MAGIC
+
+
+def is_compressed(filename):
+    with open(filename, 'rb') as file:
+        return file.read(len(LOG_COMPRESSED_MAGIC)) == LOG_COMPRESSED_MAGIC
+
+
+def read_index(filename):
+    """
+    Reads the header and the snapshot index of the compressed log `filename`.  If the log
+    was not closed, the index is rebuilt from the (complete) snapshots
+
+    Returns
+    -------
+    header : :class:`numpy.void`
+        The log header, @see compressed_header_dtype
+    index : :class:`numpy.ndarray`
+        The system time and file offset of each snapshot, @see index_dtype
+    """
+    header = np.fromfile(filename, dtype=compressed_header_dtype, count=1)[0]
+    num_steps = int(header['num_steps'])
+    if header['index_offset'] > 0:
+        with open(filename, 'rb') as file:
+            file.seek(int(header['index_offset']))
+            index = np.frombuffer(file.read(num_steps * index_dtype.itemsize), dtype=index_dtype)
+        return header, index
+    num_chunks = -(-int(header['num']) // int(header['chunk_ivps']))
+    entries = []
+    with open(filename, 'rb') as file:
+        file.seek(0, 2)
+        end = file.tell()
+        offset = compressed_header_dtype.itemsize
+        while offset + 8 * (1 + num_chunks) <= end:
+            file.seek(offset)
+            t = np.frombuffer(file.read(8), dtype='<f8')[0]
+            sizes = np.frombuffer(file.read(8 * num_chunks), dtype='<i8')
+            next_offset = offset + 8 * (1 + num_chunks) + int(np.sum(sizes))
+            if next_offset > end:
+                break
+            entries.append((t, offset))
+            offset = next_offset
+    return header, np.array(entries, dtype=index_dtype)
+
+
+def read_compressed_log(filename, time_range=None, ivp_range=None):
+    """
+    Reads the snapshots in `time_range` of the logged IVPs in `ivp_range` from the compressed
+    log `filename`, decompressing only the chunks holding them
+
+    Parameters
+    ----------
+    filename : str
+        The log file
+    time_range : tuple of float
+        The (inclusive) range of system times to read, or None for all snapshots
+    ivp_range : tuple of int
+        The [start, stop) range of logged IVPs to read, or None for all.  Note that the
+        logged IVP `i` is the IVP `i * ivp_stride` of the integration
+
+    Returns
+    -------
+    times : :class:`numpy.ndarray`
+        The system time of each read snapshot, shape (num_steps,)
+    states : :class:`numpy.ndarray`
+        The logged state vectors, shape (num_steps, stop - start, nvar)
+    """
+    header, index = read_index(filename)
+    num = int(header['num'])
+    nvar = int(header['nvar'])
+    chunk = int(header['chunk_ivps'])
+    num_chunks = -(-num // chunk)
+    start, stop = (0, num) if ivp_range is None else (max(ivp_range[0], 0), min(ivp_range[1], num))
+    if time_range is not None:
+        index = index[(index['t'] >= time_range[0]) & (index['t'] <= time_range[1])]
+    states = np.empty((index.shape[0], max(stop - start, 0), nvar))
+    if stop <= start:
+        return index['t'].copy(), states
+    with open(filename, 'rb') as file:
+        for step, (_, offset) in enumerate(index):
+            file.seek(int(offset) + 8)
+            sizes = np.frombuffer(file.read(8 * num_chunks), dtype='<i8')
+            chunk_offsets = int(offset) + 8 * (1 + num_chunks) + np.concatenate(([0], np.cumsum(sizes)))
+            for c in range(start // chunk, (stop - 1) // chunk + 1):
+                file.seek(int(chunk_offsets[c]))
+                count = min(num - c * chunk, chunk)
+                # undo the byte shuffle
+                data = np.frombuffer(zlib.decompress(file.read(int(sizes[c]))), dtype=np.uint8)
+                data = data.reshape((8, nvar * count)).T.copy().view('<f8').reshape((nvar, count))
+                lo = max(start, c * chunk)
+                hi = min(stop, c * chunk + count)
+                states[step, lo - start:hi - start, :] = data[:, lo - c * chunk:hi - c * chunk].T
+    return index['t'].copy(), states
+
+
+def read_log(filename, num_conditions=None, nvar=None, time_range=None, ivp_range=None):
+    """
+    Reads the log `filename`
+
+    Parameters
+    ----------
+    filename : str
+        The log file
+    num_conditions : int
+        The number of logged IVPs, ignored for the column-major layout
+    nvar : int
+        The number of logged entries per IVP (i.e. NN), ignored for the column-major layout
+    time_range : tuple of float
+        The (inclusive) range of system times to read, or None for all snapshots
+    ivp_range : tuple of int
+        The [start, stop) range of logged IVPs to read, or None for all, @see read_compressed_log
+
+    Returns
+    -------
+    times : :class:`numpy.ndarray`
+        The system time of each snapshot, shape (num_steps,)
+    states : :class:`numpy.ndarray`
+        The logged state vectors, shape (num_steps, num_conditions, nvar).  For the
+        column-major layout this is a (transposed) view of the memory mapped file.
+    """
+    if is_compressed(filename):
+        return read_compressed_log(filename, time_range, ivp_range)
+    times, states = __read_uncompressed(filename, num_conditions, nvar)
+    if time_range is not None:
+        mask = (times >= time_range[0]) & (times <= time_range[1])
+        times, states = times[mask], states[mask]
+    if ivp_range is not None:
+        states = states[:, ivp_range[0]:ivp_range[1]]
+    return times, states
+
+
+def __read_uncompressed(filename, num_conditions, nvar):
+    if is_column_major(filename):
+        header = np.fromfile(filename, dtype=header_dtype, count=1)[0]
+        num_conditions = int(header['num'])
+        nvar = int(header['nvar'])
+        num_steps = int(header['num_steps'])
+        width = 1 + num_conditions * nvar
+        if num_steps == 0:
+            # not closed, use what has been written
+            num_steps = (np.memmap(filename, dtype='float64', mode='r',
+                                   offset=header_dtype.itemsize).shape[0]) // width
+        data = np.memmap(filename, dtype='float64', mode='r',
+                         offset=header_dtype.itemsize, shape=(num_steps, width))
+        states = data[:, 1:].reshape((num_steps, nvar, num_conditions))
+        return data[:, 0], states.transpose((0, 2, 1))
+    assert num_conditions is not None and nvar is not None, \
+        'The number of conditions and variables must be specified for the row-major layout'
+    data = np.fromfile(filename, dtype='float64')
+    data = data.reshape((-1, 1 + num_conditions * nvar))
+    return data[:, 0], data[:, 1:].reshape((-1, num_conditions, nvar))
+
+
+def read_log_rows(filename, num_conditions=None, nvar=None, time_range=None, ivp_range=None):
+    """
+    Reads the log `filename` as a (num_steps, 1 + num_conditions * nvar) array in the
+    row-major layout, i.e. (time, state #1, state #2...) per snapshot, @see read_log
+    """
+    times, states = read_log(filename, num_conditions, nvar, time_range, ivp_range)
+    return np.hstack((times[:, np.newaxis], states.reshape((states.shape[0], -1))))
@@ -17,6 +17,7 @@ import multiprocessing
 from argparse import ArgumentParser
 from pyjac import create_jacobian
 from optionloop import OptionLoop
+from log_reader import read_log_rows
 np.set_printoptions(precision=15)
 
 scons = subprocess.check_output('which scons', shell=True).strip()
@@ -42,8 +43,7 @@ def __check_error(builder, num_conditions, nvar, validator, atol, rtol, minor_sp
         for f in glob(pjoin('log', globtxt)):
             if keyfile in f:
                 continue
-            array = np.fromfile(f, dtype='float64')
-            array = array.reshape((-1, 1 + num_conditions * nvar))
+            array = read_log_rows(f, num_conditions, nvar)
 
             file.write(f + '\n')
             data_arr = array[-1, 1:]
@@ -99,9 +99,11 @@ def __execute(builder, num_threads, num_conditions, t_step=None):
 def __check_valid(nvar, num_conditions, t_end, t_step):
     if not isfile(pjoin('log', 'valid.bin')):
         return None
-    validator = np.fromfile(pjoin('log', 'valid.bin'), dtype='float64')
-    if validator.shape[0] % (1 + num_conditions * nvar) == 0:
-        validator = validator.reshape((-1, 1 + num_conditions * nvar))
+    try:
+        validator = read_log_rows(pjoin('log', 'valid.bin'), num_conditions, nvar)
+    except ValueError:
+        return None
+    if validator.shape[1] == 1 + num_conditions * nvar:
         if np.any(np.isclose(validator[:, 0], t_end, atol=t_step/10.)):
             return validator
     return None
@@ -178,8 +180,7 @@ def __run_and_check(mech, thermo, initial_conditions, build_path,
                         pjoin(cwd(), 'log', 'valid.bin'))
 
         force_opt = True
-        validator = np.fromfile(pjoin('log', 'valid.bin'), dtype='float64')
-        validator = validator.reshape((-1, 1 + num_conditions * nvar))
+        validator = read_log_rows(pjoin('log', 'valid.bin'), num_conditions, nvar)
 
         #force constant time steps
         arg_list += ['CONST_TIME_STEP=TRUE']
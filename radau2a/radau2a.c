@@ -24,6 +24,14 @@ Problems, 2nd Edition, Springer-Verlag, Berlin, 1996. doi:10.1007/978-3-642-
 #include "lapack_dfns.h"
 #include "dydt.h"
 #include "jacob.h"
+#include "solver_stats.h"
+#include "phase_profile.h"
+#include "warm_start.h"
+#include "events.h"
+#include "tolerances.h"
+#include "sparse_lu.h"
+#include "sparse_jacobian.h"
+#include "species_mask.h"
 #include <complex.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -76,7 +84,7 @@ static inline void scale (const double * __restrict__ y0,
 						  double * __restrict__ sc) {
 
 	for (int i = 0; i < NSP; ++i) {
-		sc[i] = 1.0 / (ATOL + fmax(fabs(y0[i]), fabs(y[i])) * RTOL);
+		sc[i] = 1.0 / (current_tolerances.atol[i] + fmax(fabs(y0[i]), fabs(y[i])) * current_tolerances.rtol);
 	}
 }
 
@@ -89,7 +97,7 @@ static inline void scale_init (const double * __restrict__ y0,
 							   double * __restrict__ sc) {
 
 	for (int i = 0; i < NSP; ++i) {
-		sc[i] = 1.0 / (ATOL + fabs(y0[i]) * RTOL);
+		sc[i] = 1.0 / (current_tolerances.atol[i] + fabs(y0[i]) * current_tolerances.rtol);
 	}
 }
 
@@ -241,10 +249,64 @@ static int NRHS = 1;
 //! Lapack - Array size
 static int ARRSIZE = NSP;
 
+#ifdef SPECIES_MASK
+//! The active state vector entries of the IVP integrated by this thread, @see species_mask.h
+static species_mask rk_mask;
+#pragma omp threadprivate(rk_mask)
+#endif
+
+/**
+* \brief Evaluates the derivatives of the (active) state vector entries
+*/
+static inline void RK_dydt(const double t, const double pr, const double* __restrict__ y, double* __restrict__ dy) {
+	dydt(t, pr, y, dy);
+#ifdef SPECIES_MASK
+	apply_species_mask(&rk_mask, dy);
+#endif
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+* \brief Assembles the real system matrix \f$E_1 = \frac{\gamma}{h} I - J\f$ from the (possibly compressed) Jacobian
+*/
+static inline void RK_Assemble(const double temp1, const double* __restrict__ Jac, lu_real* __restrict__ E1) {
+#ifdef SPARSE_JACOBIAN
+	memset(E1, 0, NSP * NSP * sizeof(lu_real));
+	for (int j = 0; j < NSP; j++)
+		for (int n = jac_col_start[j]; n < jac_col_start[j + 1]; n++)
+			E1[jac_row_index[n] + j * NSP] = -Jac[n];
+#else
+	for (int i = 0; i < NSP * NSP; i++)
+		E1[i] = -Jac[i];
+#endif
+	for (int i = 0; i < NSP; i++)
+		E1[i + i * NSP] += temp1;
+}
+
+/**
+* \brief Assembles the complex system matrix \f$E_2 = \frac{\alpha + i \beta}{h} I - J\f$, @see RK_Assemble
+*/
+static inline void RK_Assemble_Complex(const double complex temp2, const double* __restrict__ Jac,
+									   lu_complex* __restrict__ E2) {
+#ifdef SPARSE_JACOBIAN
+	memset(E2, 0, NSP * NSP * sizeof(lu_complex));
+	for (int j = 0; j < NSP; j++)
+		for (int n = jac_col_start[j]; n < jac_col_start[j + 1]; n++)
+			E2[jac_row_index[n] + j * NSP] = -Jac[n] + 0 * I;
+#else
+	for (int i = 0; i < NSP * NSP; i++)
+		E2[i] = -Jac[i] + 0 * I;
+#endif
+	for (int i = 0; i < NSP; i++)
+		E2[i + i * NSP] += temp2;
+}
+
 /**
 * \brief Compute E1 & E2 matricies and their LU Decomposition
+*
+* If #MIXED_PRECISION is defined, E1 and E2 are factored in single precision
+*
 * \param[in]			H				The timestep size
 * \param[in,out]		E1				The non-complex matrix system
 * \param[in,out]		E2				The complex matrix system
@@ -253,28 +315,246 @@ static int ARRSIZE = NSP;
 * \param[out]			ipiv2			The pivot indicies for E2
 * \param[out]			info			An indicator variable determining if an error occured.
 */
-static void RK_Decomp(const double H, double* __restrict__ E1,
-					  double complex* __restrict__ E2, const double* __restrict__ Jac,
+static void RK_Decomp(const double H, lu_real* __restrict__ E1,
+					  lu_complex* __restrict__ E2, const double* __restrict__ Jac,
 					  int* __restrict__ ipiv1, int* __restrict__ ipiv2, int* __restrict__ info) {
 	double complex temp2 = rkAlpha/H + I * rkBeta/H;
 	double temp1 = rkGamma / H;
 
-	for (int i = 0; i < NSP; i++)
+#ifdef SPECIES_MASK
+	//factor the compacted active block, the rows of the frozen entries are the diagonal
+	int n = rk_mask.num_active;
+	for (int jj = 0; jj < n; jj++)
 	{
-
-		for(int j = 0; j < NSP; j++)
+		const int j = rk_mask.active[jj];
+		for (int ii = 0; ii < n; ii++)
 		{
-			E1[i + j * NSP] = -Jac[i + j * NSP];
-			E2[i + j * NSP] = -Jac[i + j * NSP] + 0 * I;
+			const int i = rk_mask.active[ii];
+			E1[ii + jj * n] = -jacobian_entry(Jac, i, j);
+			E2[ii + jj * n] = -jacobian_entry(Jac, i, j) + 0 * I;
+		}
+		E1[jj + jj * n] += temp1;
+		E2[jj + jj * n] += temp2;
+	}
+	dgetrf_(&n, &n, E1, &n, ipiv1, info);
+	if (*info != 0) {
+		return;
+	}
+	zgetrf_(&n, &n, E2, &n, ipiv2, info);
+	return;
+#endif
+	RK_Assemble(temp1, Jac, E1);
+	RK_Assemble_Complex(temp2, Jac, E2);
+#ifdef SPARSE_LU
+	//use the sparse factorizations if possible, otherwise reassemble and fall back to LAPACK
+	bool sparse = sparse_lu_in_pattern(Jac);
+	if (sparse && sparse_lu_factor(E1) == 0)
+	{
+		ipiv1[0] = SPARSE_LU_PIVOT;
+	}
+	else
+	{
+		RK_Assemble(temp1, Jac, E1);
+		dgetrf_(&ARRSIZE, &ARRSIZE, E1, &ARRSIZE, ipiv1, info);
+		if (*info != 0) {
+			return;
 		}
-		E1[i + i * NSP] += temp1;
-		E2[i + i * NSP] += temp2;
 	}
+	if (sparse && sparse_lu_factor_complex(E2) == 0)
+	{
+		ipiv2[0] = SPARSE_LU_PIVOT;
+		*info = 0;
+		return;
+	}
+	RK_Assemble_Complex(temp2, Jac, E2);
+#elif defined(MIXED_PRECISION)
+	sgetrf_(&ARRSIZE, &ARRSIZE, E1, &ARRSIZE, ipiv1, info);
+	if (*info != 0) {
+		return;
+	}
+#else
 	dgetrf_(&ARRSIZE, &ARRSIZE, E1, &ARRSIZE, ipiv1, info);
 	if (*info != 0) {
 		return;
 	}
+#endif
+#ifdef MIXED_PRECISION
+	cgetrf_(&ARRSIZE, &ARRSIZE, E2, &ARRSIZE, ipiv2, info);
+#else
 	zgetrf_(&ARRSIZE, &ARRSIZE, E2, &ARRSIZE, ipiv2, info);
+#endif
+}
+
+#ifdef SPECIES_MASK
+/**
+* \brief Solves the real system \f$E_1 x = b\f$ factored (as the active block) in RK_Decomp
+*
+* The right hand sides of the frozen entries vanish (their derivatives are zero), hence so does their coupling
+* to the active block
+*/
+static inline void RK_Backsolve_Masked(const double H, lu_real* __restrict__ E1, int* __restrict__ ipiv1,
+									   double* __restrict__ b) {
+	int n = rk_mask.num_active;
+	int info = 0;
+	double x[NSP];
+	for (int ii = 0; ii < n; ++ii)
+		x[ii] = b[rk_mask.active[ii]];
+	dgetrs_ (&TRANS, &n, &NRHS, E1, &n, ipiv1, x, &n, &info);
+	for (int i = 0; i < NSP; ++i)
+		b[i] *= H / rkGamma;
+	for (int ii = 0; ii < n; ++ii)
+		b[rk_mask.active[ii]] = x[ii];
+}
+
+/**
+* \brief Solves the complex system \f$E_2 x = b\f$ factored (as the active block) in RK_Decomp, @see RK_Backsolve_Masked
+*/
+static inline void RK_Backsolve_Complex_Masked(const double H, lu_complex* __restrict__ E2, int* __restrict__ ipiv2,
+											   double complex* __restrict__ b) {
+	int n = rk_mask.num_active;
+	int info = 0;
+	double complex x[NSP];
+	for (int ii = 0; ii < n; ++ii)
+		x[ii] = b[rk_mask.active[ii]];
+	zgetrs_ (&TRANS, &n, &NRHS, E2, &n, ipiv2, x, &n, &info);
+	for (int i = 0; i < NSP; ++i)
+		b[i] /= rkAlpha/H + I * rkBeta/H;
+	for (int ii = 0; ii < n; ++ii)
+		b[rk_mask.active[ii]] = x[ii];
+}
+#endif
+
+#ifdef MIXED_PRECISION
+/**
+* \brief Solves the real system \f$E_1 x = b\f$ in single precision, using the factorization computed in RK_Decomp
+*
+* `x` may alias `b`
+*/
+static inline void RK_Backsolve_Single(lu_real* __restrict__ E1, int* __restrict__ ipiv1,
+									   const double* b, double* x) {
+	float temp[NSP];
+	for (int i = 0; i < NSP; ++i)
+		temp[i] = (float)b[i];
+	int info = 0;
+	sgetrs_ (&TRANS, &ARRSIZE, &NRHS, E1, &ARRSIZE, ipiv1, temp, &ARRSIZE, &info);
+#ifdef DEBUG
+	//this is only true on an incorrect call of sgetrs
+	if (info != 0) {
+		printf("Error in back-substitution\n");
+		exit(-1);
+	}
+#endif
+	for (int i = 0; i < NSP; ++i)
+		x[i] = temp[i];
+}
+
+/**
+* \brief Solves the complex system \f$E_2 x = b\f$ in single precision, using the factorization computed in RK_Decomp
+*
+* `x` may alias `b`
+*/
+static inline void RK_Backsolve_Complex_Single(lu_complex* __restrict__ E2, int* __restrict__ ipiv2,
+											   const double complex* b, double complex* x) {
+	float complex temp[NSP];
+	for (int i = 0; i < NSP; ++i)
+		temp[i] = (float complex)b[i];
+	int info = 0;
+	cgetrs_ (&TRANS, &ARRSIZE, &NRHS, E2, &ARRSIZE, ipiv2, temp, &ARRSIZE, &info);
+#ifdef DEBUG
+	//this is only true on an incorrect call of cgetrs
+	if (info != 0) {
+		printf("Error in back-substitution\n");
+		exit(-1);
+	}
+#endif
+	for (int i = 0; i < NSP; ++i)
+		x[i] = temp[i];
+}
+#endif
+
+/**
+* \brief Solves the real system \f$E_1 x = b\f$, using the factorization computed in RK_Decomp
+*
+* If #MIXED_PRECISION is defined, the single precision solution is improved by one step of
+* iterative refinement, with the residual \f$b - E_1 x\f$ computed in double precision
+* from the step size `H` and the Jacobian `Jac` that E1 was formed from
+*/
+static inline void RK_Backsolve(const double H, const double* __restrict__ Jac,
+								lu_real* __restrict__ E1, int* __restrict__ ipiv1, double* __restrict__ b) {
+#ifdef SPECIES_MASK
+	RK_Backsolve_Masked(H, E1, ipiv1, b);
+	return;
+#endif
+#ifdef SPARSE_LU
+	if (ipiv1[0] == SPARSE_LU_PIVOT) {
+		sparse_lu_solve(E1, b);
+		return;
+	}
+#endif
+#ifdef MIXED_PRECISION
+	double x[NSP];
+	RK_Backsolve_Single(E1, ipiv1, b, x);
+	// b := b - E1 * x = b - (gamma / H) * x + Jac * x
+	double temp1 = rkGamma / H;
+	for (int i = 0; i < NSP; ++i)
+		b[i] -= temp1 * x[i];
+	jacobian_multiply_add(Jac, x, b);
+	RK_Backsolve_Single(E1, ipiv1, b, b);
+	for (int i = 0; i < NSP; ++i)
+		b[i] += x[i];
+#else
+	int info = 0;
+	dgetrs_ (&TRANS, &ARRSIZE, &NRHS, E1, &ARRSIZE, ipiv1, b, &ARRSIZE, &info);
+#ifdef DEBUG
+	//this is only true on an incorrect call of dgetrs
+	if (info != 0) {
+		printf("Error in back-substitution\n");
+		exit(-1);
+	}
+#endif
+#endif
+}
+
+/**
+* \brief Solves the complex system \f$E_2 x = b\f$, using the factorization computed in RK_Decomp
+*
+* If #MIXED_PRECISION is defined, the solution is refined as in RK_Backsolve
+*/
+static inline void RK_Backsolve_Complex(const double H, const double* __restrict__ Jac,
+										lu_complex* __restrict__ E2, int* __restrict__ ipiv2,
+										double complex* __restrict__ b) {
+#ifdef SPECIES_MASK
+	RK_Backsolve_Complex_Masked(H, E2, ipiv2, b);
+	return;
+#endif
+#ifdef SPARSE_LU
+	if (ipiv2[0] == SPARSE_LU_PIVOT) {
+		sparse_lu_solve_complex(E2, b);
+		return;
+	}
+#endif
+#ifdef MIXED_PRECISION
+	double complex x[NSP];
+	RK_Backsolve_Complex_Single(E2, ipiv2, b, x);
+	// b := b - E2 * x = b - ((alpha + i beta) / H) * x + Jac * x
+	double complex temp2 = rkAlpha/H + I * rkBeta/H;
+	for (int i = 0; i < NSP; ++i)
+		b[i] -= temp2 * x[i];
+	jacobian_multiply_add_complex(Jac, x, b);
+	RK_Backsolve_Complex_Single(E2, ipiv2, b, b);
+	for (int i = 0; i < NSP; ++i)
+		b[i] += x[i];
+#else
+	int info = 0;
+	zgetrs_(&TRANS, &ARRSIZE, &NRHS, E2, &ARRSIZE, ipiv2, b, &ARRSIZE, &info);
+#ifdef DEBUG
+	//this is only true on an incorrect call of zgetrs
+	if (info != 0) {
+		printf("Error in back-substitution\n");
+		exit(-1);
+	}
+#endif
+#endif
 }
 
 /**
@@ -314,6 +594,81 @@ static void RK_Interpolate(const double H, const double Hold, double* __restrict
 }
 
 
+#ifdef EVENT_DRIVER
+/**
+* \brief Evaluates the collocation polynomial of the last accepted step
+* \param[in]		s		the normalized time in the step, in [0, 1]
+* \param[in]		y0		the state vector at the start of the step
+* \param[in]		Z1		the stage increments of the step
+* \param[in]		Z2		the stage increments of the step
+* \param[in]		Z3		the stage increments of the step
+* \param[out]		u		the state vector at time `t + s * H`
+*
+* The (cubic) collocation polynomial interpolates `y0` at s = 0, and `y0 + Zi` at s = rkC[i - 1]
+*/
+static void RK_Dense(const double s, const double* __restrict__ y0, const double* __restrict__ Z1,
+					 const double* __restrict__ Z2, const double* __restrict__ Z3, double* __restrict__ u) {
+	double L1 = s * (s - rkC[1]) * (s - rkC[2]) / (rkC[0] * (rkC[0] - rkC[1]) * (rkC[0] - rkC[2]));
+	double L2 = s * (s - rkC[0]) * (s - rkC[2]) / (rkC[1] * (rkC[1] - rkC[0]) * (rkC[1] - rkC[2]));
+	double L3 = s * (s - rkC[0]) * (s - rkC[1]) / (rkC[2] * (rkC[2] - rkC[0]) * (rkC[2] - rkC[1]));
+	for (int i = 0; i < NSP; i++) {
+		u[i] = y0[i] + L1 * Z1[i] + L2 * Z2[i] + L3 * Z3[i];
+	}
+}
+
+/**
+* \brief Locates the event and evaluates the requested dense output on the last accepted step
+* \param[in,out]	event	the event request of this IVP
+* \param[in,out]	next_out	the index of the next dense output time
+* \param[in]		t		the time at the start of the step
+* \param[in]		H		the step size
+* \param[in]		y0		the state vector at the start of the step
+* \param[in]		Z1		the stage increments of the step
+* \param[in]		Z2		the stage increments of the step
+* \param[in]		Z3		the stage increments of the step
+*
+* The event time is found by the Illinois variant of regula falsi on the collocation polynomial.
+*/
+static void RK_Events(event_request* __restrict__ event, int* __restrict__ next_out, const double t,
+					  const double H, const double* __restrict__ y0, const double* __restrict__ Z1,
+					  const double* __restrict__ Z2, const double* __restrict__ Z3) {
+	double u[NSP];
+	for (; *next_out < event->num_out && event->t_out[*next_out] <= t + H + Roundoff * fabs(t + H); ++(*next_out)) {
+		double s = fmin(1.0, (event->t_out[*next_out] - t) / H);
+		RK_Dense(s, y0, Z1, Z2, Z3, &event->y_out[NSP * (*next_out)]);
+	}
+
+	double g0 = y0[EVENT_INDEX] - event->threshold;
+	double g1 = y0[EVENT_INDEX] + Z3[EVENT_INDEX] - event->threshold;
+	if (event->t_event >= 0 || g0 >= 0 || g1 < 0) {
+		return;
+	}
+	double s0 = 0, s1 = 1;
+	int side = 0;
+	for (int iter = 0; iter < 100 && (s1 - s0) > 4 * EPS; ++iter) {
+		double s = (s0 * g1 - s1 * g0) / (g1 - g0);
+		RK_Dense(s, y0, Z1, Z2, Z3, u);
+		double g = u[EVENT_INDEX] - event->threshold;
+		if (g < 0) {
+			s0 = s;
+			g0 = g;
+			if (side == -1)
+				g1 *= 0.5;
+			side = -1;
+		} else {
+			s1 = s;
+			g1 = g;
+			if (side == 1)
+				g0 *= 0.5;
+			side = 1;
+		}
+		if (g == 0)
+			break;
+	}
+	event->t_event = t + s1 * H;
+}
+#endif
+
 /**
 * \brief Performs \f$Z:= X + Y\f$ with unrolled (or at least bounds known at compile time) loops
 */
@@ -365,28 +720,36 @@ static void RK_PrepareRHS(const double t, const  double pr, const  double H,
 
 	// TMP = Y + Z1
 	WADD(Y, Z1, TMP);
-	dydt(t + rkC[0] * H, pr, TMP, F);
+	PHASE_BEGIN(PHASE_RHS);
+	RK_dydt(t + rkC[0] * H, pr, TMP, F);
+	PHASE_END(PHASE_RHS);
 	//R[:] -= -h * rkA[:][0] * F[:]
 	DAXPY3(-H * rkA[0][0], -H * rkA[1][0], -H * rkA[2][0], F, R1, R2, R3);
 
 	// TMP = Y + Z2
 	WADD(Y, Z2, TMP);
-	dydt(t + rkC[1] * H, pr, TMP, F);
+	PHASE_BEGIN(PHASE_RHS);
+	RK_dydt(t + rkC[1] * H, pr, TMP, F);
+	PHASE_END(PHASE_RHS);
 	//R[:] -= -h * rkA[:][1] * F[:]
 	DAXPY3(-H * rkA[0][1], -H * rkA[1][1], -H * rkA[2][1], F, R1, R2, R3);
 
 	// TMP = Y + Z3
 	WADD(Y, Z3, TMP);
-	dydt(t + rkC[2] * H, pr, TMP, F);
+	PHASE_BEGIN(PHASE_RHS);
+	RK_dydt(t + rkC[2] * H, pr, TMP, F);
+	PHASE_END(PHASE_RHS);
 	//R[:] -= -h * rkA[:][2] * F[:]
 	DAXPY3(-H * rkA[0][2], -H * rkA[1][2], -H * rkA[2][2], F, R1, R2, R3);
 }
 
 /**
  * \brief Solves for the RHS values in the Newton iteration
+ *
+ * `H_LU` and `Jac` are the step size and Jacobian E1 and E2 were formed from, @see RK_Backsolve
  */
-static void RK_Solve(const double H, double* __restrict__ E1,
-					 double complex* __restrict__ E2, double* __restrict__ R1,
+static void RK_Solve(const double H, const double H_LU, const double* __restrict__ Jac,
+					 lu_real* __restrict__ E1, lu_complex* __restrict__ E2, double* __restrict__ R1,
 					 double* __restrict__ R2, double* __restrict__ R3, int* __restrict__ ipiv1,
 					 int* __restrict__ ipiv2) {
 	// Z = (1/h) T^(-1) A^(-1) * Z
@@ -400,27 +763,14 @@ static void RK_Solve(const double H, double* __restrict__ E1,
 		R2[i] = rkTinvAinv[1][0] * x1 + rkTinvAinv[1][1] * x2 + rkTinvAinv[1][2] * x3;
 		R3[i] = rkTinvAinv[2][0] * x1 + rkTinvAinv[2][1] * x2 + rkTinvAinv[2][2] * x3;
 	}
-	int info = 0;
-	dgetrs_ (&TRANS, &ARRSIZE, &NRHS, E1, &ARRSIZE, ipiv1, R1, &ARRSIZE, &info);
-#ifdef DEBUG
-	if (info != 0) {
-		printf("Error in back-substitution\n");
-		exit(-1);
-	}
-#endif
+	RK_Backsolve(H_LU, Jac, E1, ipiv1, R1);
 	double complex temp[NSP];
 
 	for (int i = 0; i < NSP; ++i)
 	{
 		temp[i] = R2[i] + I * R3[i];
 	}
-	zgetrs_(&TRANS, &ARRSIZE, &NRHS, E2, &ARRSIZE, ipiv2, temp, &ARRSIZE, &info);
-#ifdef DEBUG
-	if (info != 0) {
-		printf("Error in back-substitution\n");
-		exit(-1);
-	}
-#endif
+	RK_Backsolve_Complex(H_LU, Jac, E2, ipiv2, temp);
 
 	for (int i = 0; i < NSP; ++i)
 	{
@@ -454,11 +804,14 @@ static inline double RK_ErrorNorm(const double* __restrict__ scale, double* __re
 
 /**
  * \brief Computes and returns the error estimate for this step
+ *
+ * `H_LU` and `Jac` are the step size and Jacobian E1 was formed from, @see RK_Backsolve
  */
 static double RK_ErrorEstimate(const double H, const double t, const double pr,
 							   const double* __restrict__ Y, const double* __restrict__ F0,
 							   const double* __restrict__ Z1, const double* __restrict__ Z2, const double* __restrict__ Z3,
-							   const double* __restrict__ scale, double* __restrict__ E1, int* __restrict__ ipiv1,
+							   const double* __restrict__ scale, const double H_LU, const double* __restrict__ Jac,
+							   lu_real* __restrict__ E1, int* __restrict__ ipiv1,
 							   const bool FirstStep, const bool Reject) {
 	double HrkE1  = rkE[1]/H;
     double HrkE2  = rkE[2]/H;
@@ -475,33 +828,21 @@ static double RK_ErrorEstimate(const double H, const double t, const double pr,
     for (int i = 0; i < NSP; ++i) {
     	TMP[i] = rkE[0] * F0[i] + F2[i];
     }
-    int info = 0;
-    dgetrs_ (&TRANS, &ARRSIZE, &NRHS, E1, &ARRSIZE, ipiv1, TMP, &ARRSIZE, &info);
-#ifdef DEBUG
-    //this is only true on an incorrect call of dgetrs, hence ignore
-    if (info != 0) {
-    	printf("Error on back-substitution.");
-    	exit(-1);
-    }
-#endif
+    RK_Backsolve(H_LU, Jac, E1, ipiv1, TMP);
     double Err = RK_ErrorNorm(scale, TMP);
     if (Err >= 1.0 && (FirstStep || Reject)) {
 
     	for (int i = 0; i < NSP; i++) {
         	TMP[i] += Y[i];
         }
-    	dydt(t, pr, TMP, F1);
+    	PHASE_BEGIN(PHASE_RHS);
+    	RK_dydt(t, pr, TMP, F1);
+    	PHASE_END(PHASE_RHS);
 
     	for (int i = 0; i < NSP; i++) {
         	TMP[i] = F1[i] + F2[i];
         }
-       	dgetrs_ (&TRANS, &ARRSIZE, &NRHS, E1, &ARRSIZE, ipiv1, TMP, &ARRSIZE, &info);
-#ifdef DEBUG
-       	if (info != 0) {
-	    	printf("Error on back-substitution.");
-	    	exit(-1);
-    	}
-#endif
+       	RK_Backsolve(H_LU, Jac, E1, ipiv1, TMP);
         Err = RK_ErrorNorm(scale, TMP);
     }
     return Err;
@@ -535,12 +876,25 @@ int integrate (const double t_start, const double t_end, const double pr, double
 	bool FirstStep = true;
 	bool SkipJac = false;
 	bool SkipLU = false;
+	//the step size used in the factorizations E1 and E2
+	double H_LU = H;
 	double sc[NSP];
-	double A[NSP * NSP] = {0.0};
-	double E1[NSP * NSP] = {0};
-	double complex E2[NSP * NSP] = {0};
+#ifdef SOLVER_WARM_START
+	//operate directly on the warm start memory of this IVP
+	warm_start_memory* const ws = current_warm_start;
+	double* const A = ws->A;
+	lu_real* const E1 = ws->E1;
+	lu_complex* const E2 = ws->E2;
+	int* const ipiv1 = ws->ipiv1;
+	int* const ipiv2 = ws->ipiv2;
+	double* const CONT = ws->CONT;
+#else
+	double A[JAC_SIZE] = {0.0};
+	lu_real E1[NSP * NSP] = {0};
+	lu_complex E2[NSP * NSP] = {0};
 	int ipiv1[NSP] = {0};
 	int ipiv2[NSP] = {0};
+#endif
 	double Z1[NSP] = {0};
 	double Z2[NSP] = {0};
 	double Z3[NSP] = {0};
@@ -553,27 +907,97 @@ int integrate (const double t_start, const double t_end, const double pr, double
 	double DZ1[NSP] = {0};
 	double DZ2[NSP] = {0};
 	double DZ3[NSP] = {0};
+#ifndef SOLVER_WARM_START
 	double CONT[NSP * 3] = {0};
+#endif
 	scale_init(y, sc);
 	double y0[NSP];
 	memcpy(y0, y, NSP * sizeof(double));
 	double F0[NSP];
 	int info = 0;
+#ifdef SPARSE_LU
+	sparse_lu_init(t_start, pr, y);
+#endif
+#ifdef SPECIES_MASK
+	reset_species_mask(&rk_mask);
+#endif
 	int Nconsecutive = 0;
 	int Nsteps = 0;
 	double NewtonRate = pow(2.0, 1.25);
+#ifdef EVENT_DRIVER
+	//skip the dense output times before this call
+	int next_out = 0;
+	if (current_event != NULL) {
+		while (next_out < current_event->num_out && current_event->t_out[next_out] < t_start) {
+			next_out++;
+		}
+	}
+#endif
+#ifdef SOLVER_WARM_START
+	//true while the Jacobian of the previous call is in use
+	bool CachedJac = false;
+	if (ws->valid && ws->H > 0) {
+		//continue the step size control and Newton convergence history of the previous call
+		Hold = ws->Hold;
+#ifdef Gustafsson
+		Hacc = ws->Hacc;
+		ErrOld = ws->ErrOld;
+#endif
+		NewtonRate = ws->NewtonRate;
+		SkipJac = ws->SkipJac;
+		CachedJac = SkipJac;
+		H = fmin(ws->H, t_end - t_start);
+		//reuse the factorizations under the same step size ratio test as within a call
+		double Hratio = ws->H / ws->H_LU;
+		if (SkipJac && ws->SkipLU && (Hratio >= Qmin) && (Hratio <= Qmax) && ws->H_LU <= t_end - t_start) {
+			SkipLU = true;
+			H = ws->H_LU;
+			H_LU = H;
+		}
+		//the interpolant and error history are only valid if the state was not modified since
+		FirstStep = memcmp(y, ws->y, NSP * sizeof(double)) != 0;
+#ifdef SPECIES_MASK
+		//the factorizations are of the active block of the previous call
+		SkipLU = false;
+#endif
+	}
+	ws->valid = false;
+#endif
 
 	while (t + Roundoff < t_end) {
 		if (!Reject) {
+			PHASE_BEGIN(PHASE_RHS);
 			dydt (t, pr, y, F0);
+			PHASE_END(PHASE_RHS);
+#ifdef SPECIES_MASK
+			//activate the entries that became significant, which changes the factored block
+			if (update_species_mask(&rk_mask, t_end - t, y, F0)) {
+				SkipLU = false;
+			}
+			apply_species_mask(&rk_mask, F0);
+#endif
 		}
 		if (!SkipLU) {
 			//need to update Jac/LU
 			if (!SkipJac) {
+				PHASE_BEGIN(PHASE_JACOBIAN);
 				eval_jacob (t, pr, y, A);
+				PHASE_END(PHASE_JACOBIAN);
+				STAT_INC(STAT_JAC_EVALS);
+#ifdef SOLVER_WARM_START
+				CachedJac = false;
+#endif
 			}
+			PHASE_BEGIN(PHASE_LU);
 			RK_Decomp(H, E1, E2, A, ipiv1, ipiv2, &info);
+			PHASE_END(PHASE_LU);
+			STAT_INC(STAT_LU_DECOMPS);
+			H_LU = H;
+#ifdef SOLVER_WARM_START
+			ws->H_LU = H;
+#endif
 			if (info != 0) {
+				STAT_INC(STAT_REJECTED);
 				Nconsecutive += 1;
 				if (Nconsecutive >= Max_consecutive_errs)
 				{
@@ -613,9 +1037,11 @@ int integrate (const double t_start, const double t_end, const double pr, double
 		//reuse previous NewtonRate
 		NewtonRate = pow(fmax(NewtonRate, EPS), 0.8);
 
+		PHASE_BEGIN(PHASE_NEWTON);
 		for (; NewtonIter < NewtonMaxit; NewtonIter++) {
+			STAT_INC(STAT_NEWTON_ITERS);
 			RK_PrepareRHS(t, pr, H, y, Z1, Z2, Z3, DZ1, DZ2, DZ3);
-			RK_Solve(H, E1, E2, DZ1, DZ2, DZ3, ipiv1, ipiv2);
+			RK_Solve(H, H_LU, A, E1, E2, DZ1, DZ2, DZ3, ipiv1, ipiv2);
 			double d1 = RK_ErrorNorm(sc, DZ1);
 			double d2 = RK_ErrorNorm(sc, DZ2);
 			double d3 = RK_ErrorNorm(sc, DZ3);
@@ -655,19 +1081,26 @@ int integrate (const double t_start, const double t_end, const double pr, double
             NewtonDone = (NewtonRate * NewtonIncrement <= NewtonTol);
             if (NewtonDone) break;
             if (NewtonIter == NewtonMaxit - 1) {
+            	PHASE_END(PHASE_NEWTON);
             	return EC_newton_max_iterations_exceeded;
             }
 		}
+		PHASE_END(PHASE_NEWTON);
 #ifndef CONST_TIME_STEP
 		if (!NewtonDone) {
+			STAT_INC(STAT_REJECTED);
 			H = Fac * H;
 			Reject = true;
 			SkipJac = true;
 			SkipLU = false;
+#ifdef SOLVER_WARM_START
+			//the Jacobian of the previous call may be stale
+			SkipJac = !CachedJac;
+#endif
 			continue;
 		}
 
-		double Err = RK_ErrorEstimate(H, t, pr, y, F0, Z1, Z2, Z3, sc, E1, ipiv1, FirstStep, Reject);
+		double Err = RK_ErrorEstimate(H, t, pr, y, F0, Z1, Z2, Z3, sc, H_LU, A, E1, ipiv1, FirstStep, Reject);
 		//~~~> Computation of new step size Hnew
 		Fac = pow(Err, (-1.0 / rkELO)) * (1.0 + 2 * NewtonMaxit) / (NewtonIter + 1.0 + 2 * NewtonMaxit);
 		Fac = fmin(FacMax, fmax(FacMin, Fac));
@@ -683,10 +1116,16 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			Hacc = H;
 			ErrOld = fmax(1e-2, Err);
 #endif
+			STAT_INC(STAT_STEPS);
 			FirstStep = false;
 			Hold = H;
 			t += H;
 
+#ifdef EVENT_DRIVER
+			if (current_event != NULL) {
+				RK_Events(current_event, &next_out, t - H, H, y0, Z1, Z2, Z3);
+			}
+#endif
 			for (int i = 0; i < NSP; i++) {
 				y[i] += Z3[i];
 			}
@@ -696,6 +1135,12 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			}
 			scale(y, y0, sc);
 			memcpy(y0, y, NSP * sizeof(double));
+#ifdef SOLVER_WARM_START
+			CachedJac = false;
+			//the proposed step size, before it is limited by the end time
+			ws->H = Reject ? fmin(fmax(Hnew, Hmin), H) : fmax(Hnew, Hmin);
+			ws->SkipLU = (Theta <= ThetaMin);
+#endif
 			Hnew = fmin(fmax(Hnew, Hmin), t_end - t);
 			if (Reject) {
 				Hnew = fmin(Hnew, H);
@@ -713,6 +1158,7 @@ int integrate (const double t_start, const double t_end, const double pr, double
          	SkipJac = NewtonIter == 1 || NewtonRate <= ThetaMin;
 		}
 		else {
+			STAT_INC(STAT_REJECTED);
 			if (FirstStep || Reject) {
 				H = FacRej * H;
 			} else {
@@ -721,10 +1167,15 @@ int integrate (const double t_start, const double t_end, const double pr, double
 			Reject = true;
 			SkipJac = true;
 			SkipLU = false;
+#ifdef SOLVER_WARM_START
+			//the Jacobian of the previous call may be stale
+			SkipJac = !CachedJac;
+#endif
 		}
 #else
 		//constant time stepping
 		//update y & t
+		STAT_INC(STAT_STEPS);
 		t += H;
 
 		for (int i = 0; i < NSP; i++) {
@@ -732,6 +1183,18 @@ int integrate (const double t_start, const double t_end, const double pr, double
 		}
 #endif
 	}
+#ifdef SOLVER_WARM_START
+	//store the state for the next call
+	memcpy(ws->y, y, NSP * sizeof(double));
+	ws->Hold = Hold;
+#ifdef Gustafsson
+	ws->Hacc = Hacc;
+	ws->ErrOld = ErrOld;
+#endif
+	ws->NewtonRate = NewtonRate;
+	ws->SkipJac = SkipJac;
+	ws->valid = true;
+#endif
 	return EC_success;
 }
 
@@ -28,6 +28,7 @@ Problems, 2nd Edition, Springer-Verlag, Berlin, 1996. doi:10.1007/978-3-642-
 //math operations
 #include "inverse.cuh"
 #include "complexInverse.cuh"
+#include "warp_lu.cuh"
 
 //rate/jacobian subroutines
 #ifndef FINITE_DIFFERENCE
@@ -37,6 +38,7 @@ Problems, 2nd Edition, Springer-Verlag, Berlin, 1996. doi:10.1007/978-3-642-
 #endif
 #include "dydt.cuh"
 #include "gpu_macros.cuh"
+#include "sparse_jacobian.cuh"
 
 #ifdef GENERATE_DOCS
 namespace radau2acu {
@@ -51,6 +53,18 @@ namespace radau2acu {
 	#define ALL(X) ((X))
 #endif
 
+#ifdef WARP_LU
+	//! The dense factorization of E1, cooperatively by the threads of a warp
+	#define DENSE_LU(A, ipiv, info) (warp_getLU((A), (ipiv), (info)))
+	//! The dense factorization of E2, cooperatively by the threads of a warp
+	#define DENSE_COMPLEX_LU(A, ipiv, info) (warp_getComplexLU((A), (ipiv), (info)))
+#else
+	//! The dense factorization of E1
+	#define DENSE_LU(A, ipiv, info) (getLU(NSP, (A), (ipiv), (info)))
+	//! The dense factorization of E2
+	#define DENSE_COMPLEX_LU(A, ipiv, info) (getComplexLU(NSP, (A), (ipiv), (info)))
+#endif
+
 //! Maximum number of allowed internal timesteps before error
 #define Max_no_steps (200000)
 //! Maximum number of allowed Newton iteration steps before error
@@ -91,14 +105,16 @@ namespace radau2acu {
  * \param[in]		y0			the initial state vector to use
  * \param[in]		y			the current state vector
  * \param[out]		sc			the populated error weight scalings
+ * \param[in]		tol			the integration tolerances @see tolerances.cuh
  */
 __device__
 void scale (double const * const __restrict__ y0,
 			double const * const __restrict__ y,
-			double * const __restrict__ sc) {
+			double * const __restrict__ sc,
+			double const * const __restrict__ tol) {
 	#pragma unroll 8
 	for (int i = 0; i < NSP; ++i) {
-		sc[INDEX(i)] = 1.0 / (ATOL + fmax(fabs(y0[INDEX(i)]), fabs(y[INDEX(i)])) * RTOL);
+		sc[INDEX(i)] = 1.0 / (TOL_ATOL(tol, i) + fmax(fabs(y0[INDEX(i)]), fabs(y[INDEX(i)])) * TOL_RTOL(tol));
 	}
 }
 
@@ -106,13 +122,15 @@ void scale (double const * const __restrict__ y0,
  * \brief Computes error weight scaling from initial state
  * \param[in]		y0			the initial state vector to use
  * \param[out]		sc			the populated error weight scalings
+ * \param[in]		tol			the integration tolerances @see tolerances.cuh
  */
 __device__
 void scale_init (double const * const __restrict__ y0,
-				 double * const __restrict__ sc) {
+				 double * const __restrict__ sc,
+				 double const * const __restrict__ tol) {
 	#pragma unroll 8
 	for (int i = 0; i < NSP; ++i) {
-		sc[INDEX(i)] = 1.0 / (ATOL + fabs(y0[INDEX(i)]) * RTOL);
+		sc[INDEX(i)] = 1.0 / (TOL_ATOL(tol, i) + fabs(y0[INDEX(i)]) * TOL_RTOL(tol));
 	}
 }
 
@@ -303,35 +321,212 @@ __constant__ double rkELO = 4;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#ifdef MIXED_PRECISION
+/*
+* single precision LU factorization of E1 with partial pivoting, @see getLU
+*/
+__device__ void getLU_single(float* __restrict__ A, int* __restrict__ ipiv, int* __restrict__ info) {
+	for (int j = 0; j < NSP; ++j) {
+		// find pivot and test for singularity
+		int jp = j;
+		float maxVal = fabsf(A[INDEX(j + j * NSP)]);
+		for (int i = j + 1; i < NSP; ++i) {
+			if (fabsf(A[INDEX(i + j * NSP)]) > maxVal) {
+				jp = i;
+				maxVal = fabsf(A[INDEX(i + j * NSP)]);
+			}
+		}
+		ipiv[INDEX(j)] = jp;
+		if (!(maxVal > 0.0f)) {
+			*info = j + 1;
+			return;
+		}
+		// apply interchange to all columns
+		if (jp != j) {
+			for (int k = 0; k < NSP; ++k) {
+				float temp = A[INDEX(j + k * NSP)];
+				A[INDEX(j + k * NSP)] = A[INDEX(jp + k * NSP)];
+				A[INDEX(jp + k * NSP)] = temp;
+			}
+		}
+		// compute the multipliers and update the trailing submatrix
+		float pivot = 1.0f / A[INDEX(j + j * NSP)];
+		for (int i = j + 1; i < NSP; ++i)
+			A[INDEX(i + j * NSP)] *= pivot;
+		for (int k = j + 1; k < NSP; ++k) {
+			float temp = A[INDEX(j + k * NSP)];
+			for (int i = j + 1; i < NSP; ++i)
+				A[INDEX(i + k * NSP)] -= A[INDEX(i + j * NSP)] * temp;
+		}
+	}
+}
+
+/*
+* single precision LU factorization of E2 with partial pivoting, @see getComplexLU
+*/
+__device__ void getComplexLU_single(cuComplex* __restrict__ A, int* __restrict__ ipiv, int* __restrict__ info) {
+	for (int j = 0; j < NSP; ++j) {
+		// find pivot and test for singularity
+		int jp = j;
+		float maxVal = cuCabsf(A[INDEX(j + j * NSP)]);
+		for (int i = j + 1; i < NSP; ++i) {
+			if (cuCabsf(A[INDEX(i + j * NSP)]) > maxVal) {
+				jp = i;
+				maxVal = cuCabsf(A[INDEX(i + j * NSP)]);
+			}
+		}
+		ipiv[INDEX(j)] = jp;
+		if (!(maxVal > 0.0f)) {
+			*info = j + 1;
+			return;
+		}
+		// apply interchange to all columns
+		if (jp != j) {
+			for (int k = 0; k < NSP; ++k) {
+				cuComplex temp = A[INDEX(j + k * NSP)];
+				A[INDEX(j + k * NSP)] = A[INDEX(jp + k * NSP)];
+				A[INDEX(jp + k * NSP)] = temp;
+			}
+		}
+		// compute the multipliers and update the trailing submatrix
+		cuComplex pivot = cuCdivf(make_cuComplex(1.0f, 0.0f), A[INDEX(j + j * NSP)]);
+		for (int i = j + 1; i < NSP; ++i)
+			A[INDEX(i + j * NSP)] = cuCmulf(A[INDEX(i + j * NSP)], pivot);
+		for (int k = j + 1; k < NSP; ++k) {
+			cuComplex temp = A[INDEX(j + k * NSP)];
+			for (int i = j + 1; i < NSP; ++i)
+				A[INDEX(i + k * NSP)] = cuCsubf(A[INDEX(i + k * NSP)], cuCmulf(A[INDEX(i + j * NSP)], temp));
+		}
+	}
+}
+#endif
+
+#ifdef HESSENBERG_RADAU
+/*
+* checks that the E1 & E2 matricies are nonsingular
+*
+* The Jacobian is reduced to Hessenberg form (in place) on evaluation, and the shifted systems are
+* eliminated within each solve, @see hessenberg.cuh, hence E1 and E2 are never formed or factored
+*/
+__device__ void RK_Decomp(double H, const double* const __restrict__ Jac,
+							const solver_memory* const __restrict__ solver,
+							int* __restrict__ info) {
+	double * const __restrict__ R1 = solver->DZ1;
+	cuDoubleComplex * const __restrict__ temp = solver->work4;
+	#pragma unroll 8
+	for (int i = 0; i < NSP; i++)
+	{
+		R1[INDEX(i)] = 0;
+		temp[INDEX(i)] = make_cuDoubleComplex(0, 0);
+	}
+	*info = hessenberg_solve(Jac, rkGamma / H, R1, (double*)solver->hess_work,
+							 (double*)solver->hess_mult, solver->ipiv);
+	if (*info != 0) {
+		return;
+	}
+	*info = hessenberg_solve_complex(Jac, make_cuDoubleComplex(rkAlpha/H, rkBeta/H), temp,
+									 solver->hess_work, solver->hess_mult, solver->ipiv);
+}
+#else
+/*
+* assembles the real system matrix E1 = (gamma / H) * I - Jac from the (possibly compressed) Jacobian
+*/
+__device__ void RK_Assemble(const double H, const double* const __restrict__ Jac,
+							lu_real* const __restrict__ E1) {
+#ifdef SPARSE_JACOBIAN
+	#pragma unroll 8
+	for (int i = 0; i < NSP * NSP; i++)
+		E1[INDEX(i)] = 0;
+	for (int j = 0; j < NSP; j++)
+		for (int n = d_jac_col_start[j]; n < d_jac_col_start[j + 1]; n++)
+			E1[INDEX(d_jac_row_index[n] + j * NSP)] = -Jac[INDEX(n)];
+#else
+	#pragma unroll 8
+	for (int i = 0; i < NSP * NSP; i++)
+		E1[INDEX(i)] = -Jac[INDEX(i)];
+#endif
+	#pragma unroll 8
+	for (int i = 0; i < NSP; i++)
+		E1[INDEX(i + i * NSP)] += rkGamma / H;
+}
+
+/*
+* assembles the complex system matrix E2 = ((alpha + i beta) / H) * I - Jac, see RK_Assemble
+*/
+__device__ void RK_Assemble_Complex(const double H, const double* const __restrict__ Jac,
+									lu_complex* const __restrict__ E2) {
+#ifdef SPARSE_JACOBIAN
+	#pragma unroll 8
+	for (int i = 0; i < NSP * NSP; i++)
+		E2[INDEX(i)] = MAKE_LU_COMPLEX(0, 0);
+	for (int j = 0; j < NSP; j++)
+		for (int n = d_jac_col_start[j]; n < d_jac_col_start[j + 1]; n++)
+			E2[INDEX(d_jac_row_index[n] + j * NSP)] = MAKE_LU_COMPLEX(-Jac[INDEX(n)], 0);
+#else
+	#pragma unroll 8
+	for (int i = 0; i < NSP * NSP; i++)
+		E2[INDEX(i)] = MAKE_LU_COMPLEX(-Jac[INDEX(i)], 0);
+#endif
+	#pragma unroll 8
+	for (int i = 0; i < NSP; i++)
+		E2[INDEX(i + i * NSP)] = MAKE_LU_COMPLEX(cuCreal(LU_COMPLEX_TO_DOUBLE(E2[INDEX(i + i * NSP)])) + rkAlpha/H, rkBeta/H);
+}
+
 /*
 * calculate E1 & E2 matricies and their LU Decomposition
+*
+* If MIXED_PRECISION is defined, E1 and E2 are factored in single precision
 */
 __device__ void RK_Decomp(double H, const double* const __restrict__ Jac,
 							const solver_memory* const __restrict__ solver,
 							int* __restrict__ info) {
-	double* const __restrict__ E1 = solver->E1;
-	cuDoubleComplex* const __restrict__ E2 = solver->E2;
+	lu_real* const __restrict__ E1 = solver->E1;
+	lu_complex* const __restrict__ E2 = solver->E2;
 	int* const __restrict__ ipiv1 = solver->ipiv1;
 	int* const __restrict__ ipiv2 = solver->ipiv2;
-	cuDoubleComplex temp = make_cuDoubleComplex(rkAlpha/H, rkBeta/H);
-	#pragma unroll 8
-	for (int i = 0; i < NSP; i++)
+	RK_Assemble(H, Jac, E1);
+	RK_Assemble_Complex(H, Jac, E2);
+#ifdef SPARSE_LU
+	//use the sparse factorizations if possible, otherwise reassemble and fall back to the dense factorizations
+	const sparse_lu_pattern* const __restrict__ lu = &solver->lu;
+	bool sparse = sparse_lu_in_pattern(lu, Jac);
+	if (sparse && sparse_lu_factor(lu, E1) == 0)
 	{
-		#pragma unroll 8
-		for(int j = 0; j < NSP; j++)
-		{
-			E1[INDEX(i + j * NSP)] = -Jac[INDEX(i + j * NSP)];
-			E2[INDEX(i + j * NSP)] = make_cuDoubleComplex(-Jac[INDEX(i + j * NSP)], 0);
+		ipiv1[INDEX(0)] = SPARSE_LU_PIVOT;
+	}
+	else
+	{
+		RK_Assemble(H, Jac, E1);
+		DENSE_LU(E1, ipiv1, info);
+		if (*info != 0) {
+			return;
 		}
-		E1[INDEX(i + i * NSP)] += rkGamma / H;
-		E2[INDEX(i + i * NSP)] = cuCadd(E2[INDEX(i + i * NSP)], temp);
 	}
-	getLU(NSP, E1, ipiv1, info);
+	if (sparse && sparse_lu_factor_complex(lu, E2) == 0)
+	{
+		ipiv2[INDEX(0)] = SPARSE_LU_PIVOT;
+		*info = 0;
+		return;
+	}
+	RK_Assemble_Complex(H, Jac, E2);
+#elif defined(MIXED_PRECISION)
+	getLU_single(E1, ipiv1, info);
+	if (*info != 0) {
+		return;
+	}
+#else
+	DENSE_LU(E1, ipiv1, info);
 	if (*info != 0) {
 		return;
 	}
-	getComplexLU(NSP, E2, ipiv2, info);
+#endif
+#ifdef MIXED_PRECISION
+	getComplexLU_single(E2, ipiv2, info);
+#else
+	DENSE_COMPLEX_LU(E2, ipiv2, info);
+#endif
 }
+#endif
 
 __device__ void RK_Make_Interpolate(const double* __restrict__ Z1, const double* __restrict__ Z2,
 										const double* __restrict__ Z3, double* __restrict__ CONT) {
@@ -409,19 +604,25 @@ __device__ void RK_PrepareRHS(double t, double pr, double H,
 
 	// TMP = Y + Z1
 	WADD(Y, Z1, TMP);
+	PHASE_BEGIN(solver, PHASE_RHS);
 	dydt(t + rkC[0] * H, pr, TMP, F, mech);
+	PHASE_END(solver, PHASE_RHS);
 	//R[:] -= -h * rkA[:][0] * F[:]
 	DAXPY3(-H * rkA[0][0], -H * rkA[1][0], -H * rkA[2][0], F, R1, R2, R3);
 
 	// TMP = Y + Z2
 	WADD(Y, Z2, TMP);
+	PHASE_BEGIN(solver, PHASE_RHS);
 	dydt(t + rkC[1] * H, pr, TMP, F, mech);
+	PHASE_END(solver, PHASE_RHS);
 	//R[:] -= -h * rkA[:][1] * F[:]
 	DAXPY3(-H * rkA[0][1], -H * rkA[1][1], -H * rkA[2][1], F, R1, R2, R3);
 
 	// TMP = Y + Z3
 	WADD(Y, Z3, TMP);
+	PHASE_BEGIN(solver, PHASE_RHS);
 	dydt(t + rkC[2] * H, pr, TMP, F, mech);
+	PHASE_END(solver, PHASE_RHS);
 	//R[:] -= -h * rkA[:][2] * F[:]
 	DAXPY3(-H * rkA[0][2], -H * rkA[1][2], -H * rkA[2][2], F, R1, R2, R3);
 }
@@ -442,7 +643,7 @@ __device__ void dlaswp(double * const __restrict__ A,
 //diag == 'n' -> nounit = true
 //upper == 'u' -> upper = true
 __device__ void dtrsm(bool upper, bool nounit,
-					  double const * const __restrict__ A,
+					  lu_real const * const __restrict__ A,
 					  double * const __restrict__ b) {
 	if (upper) {
 		#pragma unroll 8
@@ -475,7 +676,7 @@ __device__ void dtrsm(bool upper, bool nounit,
 	}
 }
 
-__device__ void dgetrs(double * const __restrict__ A,
+__device__ void dgetrs(lu_real * const __restrict__ A,
 					   double * const __restrict__ B,
 					   int const * const __restrict__ ipiv) {
 	dlaswp(B, ipiv);
@@ -498,19 +699,19 @@ __device__ void zlaswp(cuDoubleComplex * const __restrict__ A, int const * const
 //diag == 'n' -> nounit = true
 //upper == 'u' -> upper = true
 __device__ void ztrsm(bool upper, bool nounit,
-					  cuDoubleComplex const * const __restrict__ A,
+					  lu_complex const * const __restrict__ A,
 					  cuDoubleComplex * const __restrict__ b) {
 	if (upper) {
 		#pragma unroll 8
 		for (int k = NSP - 1; k >= 0; --k)
 		{
 			if (nounit) {
-				b[INDEX(k)] = cuCdiv(b[INDEX(k)], A[INDEX(k + k * NSP)]);
+				b[INDEX(k)] = cuCdiv(b[INDEX(k)], LU_COMPLEX_TO_DOUBLE(A[INDEX(k + k * NSP)]));
 			}
 			#pragma unroll 8
 			for (int i = 0; i < k; i++)
 			{
-				b[INDEX(i)] = cuCsub(b[INDEX(i)], cuCmul(b[INDEX(k)], A[INDEX(i + k * NSP)]));
+				b[INDEX(i)] = cuCsub(b[INDEX(i)], cuCmul(b[INDEX(k)], LU_COMPLEX_TO_DOUBLE(A[INDEX(i + k * NSP)])));
 			}
 		}
 	}
@@ -519,19 +720,19 @@ __device__ void ztrsm(bool upper, bool nounit,
 		for (int k = 0; k < NSP; k++) {
 			if (cuCabs(b[INDEX(k)]) > 0) {
 				if (nounit) {
-					b[INDEX(k)] = cuCdiv(b[INDEX(k)], A[INDEX(k + k * NSP)]);
+					b[INDEX(k)] = cuCdiv(b[INDEX(k)], LU_COMPLEX_TO_DOUBLE(A[INDEX(k + k * NSP)]));
 				}
 				#pragma unroll 8
 				for (int i = k + 1; i < NSP; i++)
 				{
-					b[INDEX(i)] = cuCsub(b[INDEX(i)], cuCmul(b[INDEX(k)], A[INDEX(i + k * NSP)]));
+					b[INDEX(i)] = cuCsub(b[INDEX(i)], cuCmul(b[INDEX(k)], LU_COMPLEX_TO_DOUBLE(A[INDEX(i + k * NSP)])));
 				}
 			}
 		}
 	}
 }
 
-__device__ void zgetrs(cuDoubleComplex * const __restrict__ A,
+__device__ void zgetrs(lu_complex * const __restrict__ A,
 					   cuDoubleComplex * const __restrict__ B,
 					   int const * const __restrict__ ipiv) {
 	zlaswp(B, ipiv);
@@ -539,17 +740,104 @@ __device__ void zgetrs(cuDoubleComplex * const __restrict__ A,
 	ztrsm(true, true, A, B);
 }
 
-__device__ void RK_Solve(const double H,
+/*
+* solves E1 * x = B, using the factorization computed in RK_Decomp
+*
+* If MIXED_PRECISION is defined, the solution with the single precision factorization is
+* improved by one step of iterative refinement, with the residual B - E1 * x computed in double
+* precision from the step size H and the Jacobian Jac that E1 was formed from
+*
+* If HESSENBERG_RADAU is defined, Jac is the Hessenberg reduced Jacobian, @see RK_Decomp
+*/
+__device__ void RK_Backsolve(const double H, double const * const __restrict__ Jac,
+							 solver_memory const * const __restrict__ solver,
+							 double * const __restrict__ B) {
+#ifdef HESSENBERG_RADAU
+	hessenberg_apply_Q(Jac, solver->tau, true, B);
+	hessenberg_solve(Jac, rkGamma / H, B, (double*)solver->hess_work, (double*)solver->hess_mult, solver->ipiv);
+	hessenberg_apply_Q(Jac, solver->tau, false, B);
+#else
+	lu_real * const __restrict__ E1 = solver->E1;
+	int const * const __restrict__ ipiv1 = solver->ipiv1;
+#ifdef SPARSE_LU
+	if (ipiv1[INDEX(0)] == SPARSE_LU_PIVOT) {
+		sparse_lu_solve(&solver->lu, E1, B);
+		return;
+	}
+#endif
+#ifdef MIXED_PRECISION
+	double * const __restrict__ r = solver->refine1;
+	#pragma unroll 8
+	for (int i = 0; i < NSP; ++i)
+		r[INDEX(i)] = B[INDEX(i)];
+#endif
+	dgetrs(E1, B, ipiv1);
+#ifdef MIXED_PRECISION
+	// r := B - E1 * x = B - (gamma / H) * x + Jac * x
+	#pragma unroll 8
+	for (int i = 0; i < NSP; ++i)
+		r[INDEX(i)] -= (rkGamma / H) * B[INDEX(i)];
+	jacobian_multiply_add(Jac, B, r);
+	dgetrs(E1, r, ipiv1);
+	#pragma unroll 8
+	for (int i = 0; i < NSP; ++i)
+		B[INDEX(i)] += r[INDEX(i)];
+#endif
+#endif
+}
+
+#ifndef HESSENBERG_RADAU
+/*
+* solves E2 * x = B, using the factorization computed in RK_Decomp
+*
+* If MIXED_PRECISION is defined, the solution is refined as in RK_Backsolve
+*/
+__device__ void RK_Backsolve_Complex(const double H, double const * const __restrict__ Jac,
+									 solver_memory const * const __restrict__ solver,
+									 cuDoubleComplex * const __restrict__ B) {
+	lu_complex * const __restrict__ E2 = solver->E2;
+	int const * const __restrict__ ipiv2 = solver->ipiv2;
+#ifdef SPARSE_LU
+	if (ipiv2[INDEX(0)] == SPARSE_LU_PIVOT) {
+		sparse_lu_solve_complex(&solver->lu, E2, B);
+		return;
+	}
+#endif
+#ifdef MIXED_PRECISION
+	cuDoubleComplex * const __restrict__ r = solver->refine2;
+	#pragma unroll 8
+	for (int i = 0; i < NSP; ++i)
+		r[INDEX(i)] = B[INDEX(i)];
+#endif
+	zgetrs(E2, B, ipiv2);
+#ifdef MIXED_PRECISION
+	// r := B - E2 * x = B - ((alpha + i beta) / H) * x + Jac * x
+	cuDoubleComplex temp = make_cuDoubleComplex(rkAlpha/H, rkBeta/H);
+	#pragma unroll 8
+	for (int i = 0; i < NSP; ++i)
+		r[INDEX(i)] = cuCsub(r[INDEX(i)], cuCmul(temp, B[INDEX(i)]));
+	jacobian_multiply_add_complex(Jac, B, r);
+	zgetrs(E2, r, ipiv2);
+	#pragma unroll 8
+	for (int i = 0; i < NSP; ++i)
+		B[INDEX(i)] = cuCadd(B[INDEX(i)], r[INDEX(i)]);
+#endif
+}
+#endif
+
+/*
+* solves for the RHS values in the Newton iteration
+*
+* H_LU and Jac are the step size and Jacobian E1 and E2 were formed from, @see RK_Backsolve
+*/
+__device__ void RK_Solve(const double H, const double H_LU,
+								double const * const __restrict__ Jac,
 								solver_memory const * const __restrict__ solver,
 								cuDoubleComplex * const __restrict__ temp) {
 
-	double* const __restrict__ E1 = solver->E1;
-	cuDoubleComplex * const __restrict__ E2 = solver->E2;
 	double * const __restrict__ R1 = solver->DZ1;
 	double * const __restrict__ R2 = solver->DZ2;
 	double * const __restrict__ R3 = solver->DZ3;
-	int* const __restrict__ ipiv1 = solver->ipiv1;
-	int* const __restrict__ ipiv2 = solver->ipiv2;
 
 	// Z = (1/h) T^(-1) A^(-1) * Z
 	#pragma unroll 8
@@ -562,19 +850,33 @@ __device__ void RK_Solve(const double H,
 		R2[INDEX(i)] = rkTinvAinv[1][0] * x1 + rkTinvAinv[1][1] * x2 + rkTinvAinv[1][2] * x3;
 		R3[INDEX(i)] = rkTinvAinv[2][0] * x1 + rkTinvAinv[2][1] * x2 + rkTinvAinv[2][2] * x3;
 	}
-	dgetrs(E1, R1, ipiv1);
+#ifdef HESSENBERG_RADAU
+	// solve all systems in the basis of the Hessenberg reduction at once
+	hessenberg_apply_Q3(Jac, solver->tau, true, R1, R2, R3);
+	hessenberg_solve(Jac, rkGamma / H_LU, R1, (double*)solver->hess_work, (double*)solver->hess_mult, solver->ipiv);
+#else
+	RK_Backsolve(H_LU, Jac, solver, R1);
+#endif
 	#pragma unroll 8
 	for (int i = 0; i < NSP; ++i)
 	{
 		temp[INDEX(i)] = make_cuDoubleComplex(R2[INDEX(i)], R3[INDEX(i)]);
 	}
-	zgetrs(E2, temp, ipiv2);
+#ifdef HESSENBERG_RADAU
+	hessenberg_solve_complex(Jac, make_cuDoubleComplex(rkAlpha/H_LU, rkBeta/H_LU), temp,
+							 solver->hess_work, solver->hess_mult, solver->ipiv);
+#else
+	RK_Backsolve_Complex(H_LU, Jac, solver, temp);
+#endif
 	#pragma unroll 8
 	for (int i = 0; i < NSP; ++i)
 	{
 		R2[INDEX(i)] = cuCreal(temp[INDEX(i)]);
 		R3[INDEX(i)] = cuCimag(temp[INDEX(i)]);
 	}
+#ifdef HESSENBERG_RADAU
+	hessenberg_apply_Q3(Jac, solver->tau, false, R1, R2, R3);
+#endif
 
 	// Z = T * Z
 	#pragma unroll 8
@@ -598,7 +900,7 @@ __device__ double RK_ErrorNorm(double const * const __restrict__ scale,
 	return fmax(sqrt(sum / ((double)NSP)), 1e-10);
 }
 
-__device__ double RK_ErrorEstimate(const double H, const double t,
+__device__ double RK_ErrorEstimate(const double H, const double H_LU, const double t,
 											 const double pr,
 											 double const * const __restrict__ Y,
 											 solver_memory const * const __restrict__ solver,
@@ -609,7 +911,7 @@ __device__ double RK_ErrorEstimate(const double H, const double t,
     double HrkE2  = rkE[2]/H;
     double HrkE3  = rkE[3]/H;
 
-	double * const __restrict__ E1 = mech->jac;
+	double const * const __restrict__ Jac = mech->jac;
 	const double * const __restrict__ F0 = mech->dy;
     double * const __restrict__ F1 = solver->work1;
     double * const __restrict__ F2 = solver->work2;
@@ -617,7 +919,6 @@ __device__ double RK_ErrorEstimate(const double H, const double t,
     double const * const __restrict__ Z1 = solver->Z1;
     double const * const __restrict__ Z2 = solver->Z2;
     double const * const __restrict__ Z3 = solver->Z3;
-    int const * __restrict__ ipiv1 = solver->ipiv1;
     double const * __restrict__ scale = solver->scale;
 
     #pragma unroll 8
@@ -628,19 +929,21 @@ __device__ double RK_ErrorEstimate(const double H, const double t,
     for (int i = 0; i < NSP; ++i) {
     	TMP[INDEX(i)] = rkE[0] * F0[INDEX(i)] + F2[INDEX(i)];
     }
-    dgetrs(E1, TMP, ipiv1);
+    RK_Backsolve(H_LU, Jac, solver, TMP);
     double Err = RK_ErrorNorm(scale, TMP);
     if (Err >= 1.0 && (FirstStep || Reject)) {
         #pragma unroll 8
     	for (int i = 0; i < NSP; i++) {
         	TMP[INDEX(i)] += Y[INDEX(i)];
         }
+    	PHASE_BEGIN(solver, PHASE_RHS);
     	dydt(t, pr, TMP, F1, mech);
+    	PHASE_END(solver, PHASE_RHS);
     	#pragma unroll 8
     	for (int i = 0; i < NSP; i++) {
         	TMP[INDEX(i)] = F1[INDEX(i)] + F2[INDEX(i)];
         }
-        dgetrs(E1, TMP, ipiv1);
+        RK_Backsolve(H_LU, Jac, solver, TMP);
         Err = RK_ErrorNorm(scale, TMP);
     }
     return Err;
@@ -673,10 +976,12 @@ __device__ void integrate (const double t_start,
 	bool FirstStep = true;
 	bool SkipJac = false;
 	bool SkipLU = false;
+	//the step size used in the factorizations E1 and E2
+	double H_LU = H;
 
 	double * const __restrict__ A = mech->jac;
 	double * const __restrict__ sc = solver->scale;
-	double * const __restrict__ y0 = solver->y0;
+	double const * const __restrict__ tol = solver->tol;
 	double * const __restrict__ F0 = mech->dy;
 	double * const __restrict__ work1 = solver->work1;
 	double * const __restrict__ work2 = solver->work2;
@@ -690,33 +995,116 @@ __device__ void integrate (const double t_start,
 	double * const __restrict__ CONT = solver->CONT;
 	int * const __restrict__ result = solver->result;
 
-	scale_init(y, sc);
-	safe_memcpy(y0, y);
-#ifndef FORCE_ZERO
-	safe_memset(F0, 0.0);
+#ifdef SOLVER_WARM_START
+	double * const __restrict__ warm = solver->warm;
 #endif
 	int info = 0;
 	int Nconsecutive = 0;
 	int Nsteps = 0;
 	double NewtonRate = pow(2.0, 1.25);
+#ifdef BATCHED_LU
+	double * const __restrict__ suspend = solver->suspend;
+	if (batched_lu_resuming(&solver->batched)) {
+		// a relaunch, in which only the IVPs suspended at their factorization continue @see batched_lu.cuh
+		if (result[T_ID] != EC_lu_pending)
+			return;
+		t = suspend[INDEX(0)];
+		H = suspend[INDEX(1)];
+		Hold = suspend[INDEX(2)];
+#ifdef Gustafsson
+		Hacc = suspend[INDEX(3)];
+		ErrOld = suspend[INDEX(4)];
+#endif
+		NewtonRate = suspend[INDEX(5)];
+		Reject = suspend[INDEX(6)] != 0;
+		FirstStep = suspend[INDEX(7)] != 0;
+		Nconsecutive = (int)suspend[INDEX(8)];
+		Nsteps = (int)suspend[INDEX(9)];
+		info = batched_lu_resume(&solver->batched, solver->E1, solver->ipiv1, solver->E2, solver->ipiv2);
+		goto factored;
+	}
+#endif
+	STAT_RESET(solver);
+#ifdef SOLVER_WARM_START
+	if (warm[INDEX(0)] > 0) {
+		// continue from the step size and error history of the previous kernel call
+		H = fmin(warm[INDEX(0)], t_end - t_start);
+#ifdef Gustafsson
+		Hacc = warm[INDEX(1)];
+		ErrOld = warm[INDEX(2)];
+#endif
+	}
+#endif
+	scale_init(y, sc, tol);
+#ifndef FORCE_ZERO
+	safe_memset(F0, 0.0);
+#endif
 	while (t + Roundoff < t_end) {
 		#ifdef DIVERGENCE_TEST
 			integrator_steps[T_ID]++;
 		#endif
 		if(!Reject) {
+			PHASE_BEGIN(solver, PHASE_RHS);
 			dydt (t, var, y, F0, mech);
+			PHASE_END(solver, PHASE_RHS);
 		}
 		if(!SkipLU) {
 			//need to update Jac/LU
 			if(!SkipJac) {
+#ifdef HESSENBERG_RADAU
+				// the reduction below fills the structural zeros the Jacobian evaluation may not write
+				safe_memset_jac(A, 0.0);
+#endif
 #ifndef FINITE_DIFFERENCE
+				PHASE_BEGIN(solver, PHASE_JACOBIAN);
 				eval_jacob (t, var, y, A, mech);
+				PHASE_END(solver, PHASE_JACOBIAN);
 #else
+				PHASE_BEGIN(solver, PHASE_JACOBIAN);
 				eval_jacob (t, var, y, A, mech, work1, work2);
+				PHASE_END(solver, PHASE_JACOBIAN);
+#endif
+				STAT_INC(solver, STAT_JAC_EVALS);
+#ifdef HESSENBERG_RADAU
+				// reduced once per Jacobian, such that a change of the step size requires no refactorization
+				PHASE_BEGIN(solver, PHASE_LU);
+				hessenberg_reduce(A, solver->tau);
+				PHASE_END(solver, PHASE_LU);
+#endif
+			}
+			PHASE_BEGIN(solver, PHASE_LU);
+#ifdef BATCHED_LU
+			if (solver->batched.enabled) {
+				// register E1 and E2 in the batch, and suspend until the host has factored it
+				RK_Assemble(H, A, solver->E1);
+				RK_Assemble_Complex(H, A, solver->E2);
+				batched_lu_suspend(&solver->batched, solver->E1, solver->E2);
+				PHASE_END(solver, PHASE_LU);
+				suspend[INDEX(0)] = t;
+				suspend[INDEX(1)] = H;
+				suspend[INDEX(2)] = Hold;
+#ifdef Gustafsson
+				suspend[INDEX(3)] = Hacc;
+				suspend[INDEX(4)] = ErrOld;
 #endif
+				suspend[INDEX(5)] = NewtonRate;
+				suspend[INDEX(6)] = Reject;
+				suspend[INDEX(7)] = FirstStep;
+				suspend[INDEX(8)] = Nconsecutive;
+				suspend[INDEX(9)] = Nsteps;
+				result[T_ID] = EC_lu_pending;
+				return;
 			}
+#endif
 			RK_Decomp(H, A, solver, &info);
+			PHASE_END(solver, PHASE_LU);
+#ifdef BATCHED_LU
+factored:
+#endif
+			STAT_INC(solver, STAT_LU_DECOMPS);
+			H_LU = H;
 			if(info != 0) {
+				STAT_INC(solver, STAT_REJECTED);
 				Nconsecutive += 1;
 				if (Nconsecutive >= 5)
 				{
@@ -759,9 +1147,11 @@ __device__ void integrate (const double t_start,
 		//reuse previous NewtonRate
 		NewtonRate = pow(fmax(NewtonRate, EPS), 0.8);
 
+		PHASE_BEGIN(solver, PHASE_NEWTON);
 		for (; NewtonIter < NewtonMaxit; NewtonIter++) {
 			RK_PrepareRHS(t, var, H, y, solver, mech, work1, work2);
-			RK_Solve(H, solver, work4);
+			RK_Solve(H, H_LU, A, solver, work4);
+			STAT_INC(solver, STAT_NEWTON_ITERS);
 			double d1 = RK_ErrorNorm(sc, DZ1);
 			double d2 = RK_ErrorNorm(sc, DZ2);
 			double d3 = RK_ErrorNorm(sc, DZ3);
@@ -799,12 +1189,15 @@ __device__ void integrate (const double t_start,
             if (NewtonDone) break;
             if (NewtonIter >= NewtonMaxit)
             {
+				PHASE_END(solver, PHASE_NEWTON);
 				result[T_ID] = EC_newton_max_iterations_exceeded;
 				return;
 			}
 		}
+		PHASE_END(solver, PHASE_NEWTON);
 #ifndef CONST_TIME_STEP
 		if(!NewtonDone) {
+			STAT_INC(solver, STAT_REJECTED);
 			H = Fac * H;
 			Reject = true;
 			SkipJac = true;
@@ -812,7 +1205,7 @@ __device__ void integrate (const double t_start,
 			continue;
 		}
 
-		double Err = RK_ErrorEstimate(H, t, var, y,
+		double Err = RK_ErrorEstimate(H, H_LU, t, var, y,
 						solver, mech, FirstStep, Reject);
 
 		//!~~~> Computation of new step size Hnew
@@ -822,7 +1215,8 @@ __device__ void integrate (const double t_start,
 
 		if (Err < 1.0) {
 #ifdef Gustafsson
-			if (!FirstStep) {
+			// i.e. not the first accepted step (or warm started)
+			if (Hacc > 0) {
 				double FacGus = FacSafe * (H / Hacc) * pow(Err * Err / ErrOld, -0.25);
 				FacGus = fmin(FacMax, fmax(FacMin, FacGus));
 				Fac = fmin(Fac, FacGus);
@@ -831,9 +1225,13 @@ __device__ void integrate (const double t_start,
 			Hacc = H;
 			ErrOld = fmax(1e-2, Err);
 #endif
+			STAT_INC(solver, STAT_STEPS);
 			FirstStep = false;
 			Hold = H;
 			t += H;
+			// y0 shares the storage of DZ1 (dead once Newton converged), hence is only set on acceptance
+			// and not held in a restrict qualified local
+			safe_memcpy(solver->y0, y);
 			#pragma unroll 8
 			for (int i = 0; i < NSP; i++) {
 				y[INDEX(i)] += Z3[INDEX(i)];
@@ -842,8 +1240,10 @@ __device__ void integrate (const double t_start,
 			if (StartNewton) {
 				RK_Make_Interpolate(Z1, Z2, Z3, CONT);
 			}
-			scale(y, y0, sc);
-			safe_memcpy(y0, y);
+			scale(y, solver->y0, sc, tol);
+#ifdef SOLVER_WARM_START
+			warm[INDEX(0)] = fmax(Hnew, Hmin);
+#endif
 			Hnew = fmin(fmax(Hnew, Hmin), t_end - t);
 			if (Reject) {
 				Hnew = fmin(Hnew, H);
@@ -866,6 +1266,7 @@ __device__ void integrate (const double t_start,
 			} else {
 				H = Hnew;
 			}
+			STAT_INC(solver, STAT_REJECTED);
 			Reject = true;
 			SkipJac = true;
 			SkipLU = false;
@@ -873,6 +1274,7 @@ __device__ void integrate (const double t_start,
 #else
 		//constant time stepping
 		//update y & t
+		STAT_INC(solver, STAT_STEPS);
 		t += H;
 		#pragma unroll 8
 		for (int i = 0; i < NSP; i++) {
@@ -880,5 +1282,9 @@ __device__ void integrate (const double t_start,
 		}
 #endif
 	}
+#if defined(SOLVER_WARM_START) && defined(Gustafsson)
+	warm[INDEX(1)] = Hacc;
+	warm[INDEX(2)] = ErrOld;
+#endif
 	result[T_ID] = EC_success;
 }
\ No newline at end of file
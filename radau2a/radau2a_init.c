@@ -7,11 +7,28 @@
  *
  */
 
+#include <stddef.h>
+#include "sparse_lu.h"
+
 #ifdef GENERATE_DOCS
 namespace radau2a {
 #endif
 
- void initialize_solver() {
+#ifdef SPARSE_LU
+//! The number of live solver instances, the (shared) sparse LU pattern is freed with the last one
+static int num_instances = 0;
+#endif
+
+/*!
+   \brief Initializes the solver, the Radau-IIa solver keeps no per-thread memory
+   \param num_threads Unused
+*/
+ void* initialize_solver(int num_threads) {
+#ifdef SPARSE_LU
+ 	#pragma omp critical(radau2a_instances)
+ 	++num_instances;
+#endif
+ 	return NULL;
  }
 
 /*!
@@ -23,8 +40,22 @@ namespace radau2a {
  	return name;
  }
 
- void cleanup_solver() {
- 	//nothing to do
+/*!
+   \brief Cleans up the solver
+   \param num_threads Unused
+   \param memory Unused
+*/
+ void cleanup_solver(int num_threads, void* memory) {
+#ifdef SPARSE_LU
+ 	#pragma omp critical(radau2a_instances)
+ 	{
+ 		if (--num_instances <= 0)
+ 		{
+ 			cleanup_sparse_lu();
+ 			num_instances = 0;
+ 		}
+ 	}
+#endif
  }
 
  void init_solver_log() {
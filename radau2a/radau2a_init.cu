@@ -8,6 +8,9 @@
  */
 
  #include "solver_init.cuh"
+#ifdef FINITE_DIFFERENCE
+ #include "fd_jacob.cuh"
+#endif
 
 #ifdef GENERATE_DOCS
 namespace radau2acu {
@@ -39,26 +42,52 @@ namespace radau2acu {
  size_t required_solver_size() {
  	//return the size (in bytes), needed per cuda thread
  	size_t num_bytes = 0;
+#ifdef HESSENBERG_RADAU
+  //the Householder factors of the reduced Jacobian, and a pivot index array
+  num_bytes += NSP * sizeof(double) + NSP * sizeof(int);
+  //2 complex work arrays for the shifted Hessenberg solves
+  num_bytes += 2 * NSP * sizeof(cuDoubleComplex);
+#else
   //regular jacobian factorization
-  num_bytes += NSP * NSP * sizeof(double);
+  num_bytes += NSP * NSP * sizeof(lu_real);
   //complex jacobian factorization
-  num_bytes += NSP * NSP * sizeof(cuDoubleComplex);
- 	//an error scale array
- 	num_bytes += NSP * sizeof(double);
+  num_bytes += NSP * NSP * sizeof(lu_complex);
   //two pivot index arrays
   num_bytes += 2 * NSP * sizeof(int);
+#endif
+ 	//an error scale array
+ 	num_bytes += NSP * sizeof(double);
  	//6 RHS and interpolant arrays
  	num_bytes += 6 * NSP * sizeof(double);
  	//continuation array of size 3 * NSP
  	num_bytes += 3 * NSP * sizeof(double);
- 	//y0
- 	num_bytes += NSP * sizeof(double);
- 	//3 work arrays
- 	num_bytes += 3 * NSP * sizeof(double);
+ 	//2 work arrays, y0 and the third work array share the storage of DZ1
+ 	num_bytes += 2 * NSP * sizeof(double);
   //1 complex work array
-  num_bytes += NSP * sizeof(double);
+  num_bytes += NSP * sizeof(cuDoubleComplex);
   //result flag
   num_bytes += 1 * sizeof(int);
+#ifdef MIXED_PRECISION
+  //real and complex iterative refinement residuals
+  num_bytes += NSP * sizeof(double) + NSP * sizeof(cuDoubleComplex);
+#endif
+#ifdef STATISTICS
+  //statistics counters
+  num_bytes += NUM_STATS * sizeof(int);
+#endif
+#ifdef PROFILE_PHASES
+  //phase counters
+  num_bytes += 2 * NUM_PHASES * sizeof(long long);
+#endif
+#ifdef SOLVER_WARM_START
+  //warm start state
+  num_bytes += WARM_SIZE * sizeof(double);
+#endif
+#ifdef BATCHED_LU
+  //the batched factorization, and the suspended step state
+  if (batched_lu_selected())
+    num_bytes += batched_lu_size() + SUSPEND_SIZE * sizeof(double);
+#endif
 
   return num_bytes;
  }
@@ -70,7 +99,7 @@ namespace radau2acu {
  */
 void createAndZero(void** ptr, size_t size)
 {
-  cudaErrorCheck(cudaMalloc(ptr, size));
+  cudaErrorCheck(arena_malloc(ptr, size));
   cudaErrorCheck(cudaMemset(*ptr, 0, size));
 }
 
@@ -82,13 +111,20 @@ void createAndZero(void** ptr, size_t size)
 */
 void initialize_solver(const int padded, solver_memory** h_mem, solver_memory** d_mem) {
   // Allocate storage for the device struct
-  cudaErrorCheck( cudaMalloc(d_mem, sizeof(solver_memory)) );
+  cudaErrorCheck( arena_malloc(d_mem, sizeof(solver_memory)) );
   //allocate the device arrays on the host pointer
-  createAndZero((void**)&((*h_mem)->E1), NSP * NSP * padded * sizeof(double));
-  createAndZero((void**)&((*h_mem)->E2), NSP * NSP * padded * sizeof(cuDoubleComplex));
-  createAndZero((void**)&((*h_mem)->scale), NSP * padded * sizeof(cuDoubleComplex));
+#ifdef HESSENBERG_RADAU
+  createAndZero((void**)&((*h_mem)->tau), NSP * padded * sizeof(double));
+  createAndZero((void**)&((*h_mem)->ipiv), NSP * padded * sizeof(int));
+  createAndZero((void**)&((*h_mem)->hess_work), NSP * padded * sizeof(cuDoubleComplex));
+  createAndZero((void**)&((*h_mem)->hess_mult), NSP * padded * sizeof(cuDoubleComplex));
+#else
+  createAndZero((void**)&((*h_mem)->E1), NSP * NSP * padded * sizeof(lu_real));
+  createAndZero((void**)&((*h_mem)->E2), NSP * NSP * padded * sizeof(lu_complex));
   createAndZero((void**)&((*h_mem)->ipiv1), NSP * padded * sizeof(int));
   createAndZero((void**)&((*h_mem)->ipiv2), NSP * padded * sizeof(int));
+#endif
+  createAndZero((void**)&((*h_mem)->scale), NSP * padded * sizeof(double));
   createAndZero((void**)&((*h_mem)->Z1), NSP * padded * sizeof(double));
   createAndZero((void**)&((*h_mem)->Z2), NSP * padded * sizeof(double));
   createAndZero((void**)&((*h_mem)->Z3), NSP * padded * sizeof(double));
@@ -96,12 +132,41 @@ void initialize_solver(const int padded, solver_memory** h_mem, solver_memory**
   createAndZero((void**)&((*h_mem)->DZ2), NSP * padded * sizeof(double));
   createAndZero((void**)&((*h_mem)->DZ3), NSP * padded * sizeof(double));
   createAndZero((void**)&((*h_mem)->CONT), 3 * NSP * padded * sizeof(double));
-  createAndZero((void**)&((*h_mem)->y0), NSP * padded * sizeof(double));
   createAndZero((void**)&((*h_mem)->work1), NSP * padded * sizeof(double));
   createAndZero((void**)&((*h_mem)->work2), NSP * padded * sizeof(double));
-  createAndZero((void**)&((*h_mem)->work3), NSP * padded * sizeof(double));
   createAndZero((void**)&((*h_mem)->work4), NSP * padded * sizeof(cuDoubleComplex));
+  // the Newton increment DZ1 is dead in the error estimate (work3) and on acceptance of the step (y0),
+  // hence the three share one buffer
+  (*h_mem)->y0 = (*h_mem)->DZ1;
+  (*h_mem)->work3 = (*h_mem)->DZ1;
   createAndZero((void**)&((*h_mem)->result), padded * sizeof(int));
+#ifdef MIXED_PRECISION
+  createAndZero((void**)&((*h_mem)->refine1), NSP * padded * sizeof(double));
+  createAndZero((void**)&((*h_mem)->refine2), NSP * padded * sizeof(cuDoubleComplex));
+#endif
+#ifdef STATISTICS
+  createAndZero((void**)&((*h_mem)->stats), NUM_STATS * padded * sizeof(int));
+#endif
+#ifdef PROFILE_PHASES
+  createAndZero((void**)&((*h_mem)->phases), 2 * NUM_PHASES * padded * sizeof(long long));
+#endif
+#ifdef SOLVER_WARM_START
+  createAndZero((void**)&((*h_mem)->warm), WARM_SIZE * padded * sizeof(double));
+#endif
+#if defined(FINITE_DIFFERENCE) && defined(FD_COLORING)
+  // must precede the sparse LU initialization, which evaluates the Jacobian
+  initialize_fd_coloring();
+#endif
+#ifdef SPARSE_LU
+  initialize_sparse_lu(&(*h_mem)->lu);
+#endif
+#ifdef BATCHED_LU
+  initialize_batched_lu(padded, &(*h_mem)->batched);
+  (*h_mem)->suspend = NULL;
+  if ((*h_mem)->batched.enabled)
+    createAndZero((void**)&((*h_mem)->suspend), SUSPEND_SIZE * padded * sizeof(double));
+#endif
+  initialize_tolerances(&(*h_mem)->tol);
 
   //copy host struct to device
   cudaErrorCheck( cudaMemcpy(*d_mem, *h_mem, sizeof(solver_memory), cudaMemcpyHostToDevice) );
@@ -114,23 +179,50 @@ void initialize_solver(const int padded, solver_memory** h_mem, solver_memory**
    @see solver_options.cuh
 */
  void cleanup_solver(solver_memory** h_mem, solver_memory** d_mem) {
-  cudaErrorCheck(cudaFree((*h_mem)->E1));
-  cudaErrorCheck(cudaFree((*h_mem)->E2));
-  cudaErrorCheck(cudaFree((*h_mem)->scale));
-  cudaErrorCheck(cudaFree((*h_mem)->ipiv1));
-  cudaErrorCheck(cudaFree((*h_mem)->ipiv2));
-  cudaErrorCheck(cudaFree((*h_mem)->Z1));
-  cudaErrorCheck(cudaFree((*h_mem)->Z2));
-  cudaErrorCheck(cudaFree((*h_mem)->Z3));
-  cudaErrorCheck(cudaFree((*h_mem)->DZ1));
-  cudaErrorCheck(cudaFree((*h_mem)->DZ2));
-  cudaErrorCheck(cudaFree((*h_mem)->DZ3));
-  cudaErrorCheck(cudaFree((*h_mem)->CONT));
-  cudaErrorCheck(cudaFree((*h_mem)->y0));
-  cudaErrorCheck(cudaFree((*h_mem)->work1));
-  cudaErrorCheck(cudaFree((*h_mem)->work2));
-  cudaErrorCheck(cudaFree((*h_mem)->work3));
-  cudaErrorCheck(cudaFree((*h_mem)->work4));
-  cudaErrorCheck(cudaFree((*h_mem)->result));
-  cudaErrorCheck(cudaFree(*d_mem));
+#ifdef HESSENBERG_RADAU
+  cudaErrorCheck(arena_free((*h_mem)->tau));
+  cudaErrorCheck(arena_free((*h_mem)->ipiv));
+  cudaErrorCheck(arena_free((*h_mem)->hess_work));
+  cudaErrorCheck(arena_free((*h_mem)->hess_mult));
+#else
+  cudaErrorCheck(arena_free((*h_mem)->E1));
+  cudaErrorCheck(arena_free((*h_mem)->E2));
+  cudaErrorCheck(arena_free((*h_mem)->ipiv1));
+  cudaErrorCheck(arena_free((*h_mem)->ipiv2));
+#endif
+  cudaErrorCheck(arena_free((*h_mem)->scale));
+  cudaErrorCheck(arena_free((*h_mem)->Z1));
+  cudaErrorCheck(arena_free((*h_mem)->Z2));
+  cudaErrorCheck(arena_free((*h_mem)->Z3));
+  cudaErrorCheck(arena_free((*h_mem)->DZ1));
+  cudaErrorCheck(arena_free((*h_mem)->DZ2));
+  cudaErrorCheck(arena_free((*h_mem)->DZ3));
+  cudaErrorCheck(arena_free((*h_mem)->CONT));
+  cudaErrorCheck(arena_free((*h_mem)->work1));
+  cudaErrorCheck(arena_free((*h_mem)->work2));
+  cudaErrorCheck(arena_free((*h_mem)->work4));
+  cudaErrorCheck(arena_free((*h_mem)->result));
+#ifdef MIXED_PRECISION
+  cudaErrorCheck(arena_free((*h_mem)->refine1));
+  cudaErrorCheck(arena_free((*h_mem)->refine2));
+#endif
+#ifdef STATISTICS
+  cudaErrorCheck(arena_free((*h_mem)->stats));
+#endif
+#ifdef PROFILE_PHASES
+  cudaErrorCheck(arena_free((*h_mem)->phases));
+#endif
+#ifdef SOLVER_WARM_START
+  cudaErrorCheck(arena_free((*h_mem)->warm));
+#endif
+#ifdef SPARSE_LU
+  cleanup_sparse_lu(&(*h_mem)->lu);
+#endif
+#ifdef BATCHED_LU
+  if ((*h_mem)->suspend != NULL)
+    cudaErrorCheck(arena_free((*h_mem)->suspend));
+  cleanup_batched_lu(&(*h_mem)->batched);
+#endif
+  cleanup_tolerances((*h_mem)->tol);
+  cudaErrorCheck(arena_free(*d_mem));
 }
\ No newline at end of file
@@ -9,6 +9,13 @@
 #define RADAU2A_PROPS_CUH
 
 #include "header.cuh"
+#include "solver_stats.cuh"
+#include "phase_profile.cuh"
+#include "sparse_lu.cuh"
+#include "warp_lu.cuh"
+#include "hessenberg.cuh"
+#include "batched_lu.cuh"
+#include "tolerances.cuh"
 #include <cuComplex.h>
 #include <stdio.h>
 
@@ -19,19 +26,78 @@ namespace radau2acu {
 //! the matrix dimensions
 #define STRIDE (NSP)
 
+#ifdef MIXED_PRECISION
+#ifdef SPARSE_LU
+    #error "The mixed precision Radau-IIa linear solves are incompatible with the SPARSE_LU option"
+#endif
+#ifdef HESSENBERG_RADAU
+    #error "The mixed precision Radau-IIa linear solves are incompatible with the HESSENBERG_RADAU option"
+#endif
+//! The precision of the factorized real system matrix E1
+typedef float lu_real;
+//! The precision of the factorized complex system matrix E2
+typedef cuComplex lu_complex;
+//! Constructs an entry of E2
+#define MAKE_LU_COMPLEX(re, im) (make_cuComplex((re), (im)))
+//! Promotes an entry of E2 to double precision
+#define LU_COMPLEX_TO_DOUBLE(z) (cuComplexFloatToDouble((z)))
+#else
+//! The precision of the factorized real system matrix E1
+typedef double lu_real;
+//! The precision of the factorized complex system matrix E2
+typedef cuDoubleComplex lu_complex;
+//! Constructs an entry of E2
+#define MAKE_LU_COMPLEX(re, im) (make_cuDoubleComplex((re), (im)))
+//! Promotes an entry of E2 to double precision
+#define LU_COMPLEX_TO_DOUBLE(z) (z)
+#endif
+
+#if defined(HESSENBERG_RADAU) && defined(SPARSE_LU)
+    #error "The Hessenberg reduced Radau-IIa linear solves are incompatible with the SPARSE_LU option"
+#endif
+
+#if defined(HESSENBERG_RADAU) && defined(SPARSE_JACOBIAN)
+    #error "The Hessenberg reduced Radau-IIa linear solves require the dense (in place) storage of the Jacobian"
+#endif
+
+#ifdef BATCHED_LU
+//! The number of step state entries saved by an IVP suspended at a batched factorization, @see batched_lu.cuh
+#define SUSPEND_SIZE (10)
+#endif
+
+#if defined(WARM_START) && !defined(CONST_TIME_STEP)
+//! The Radau-IIa solver continues from the step size and error history of the previous kernel call
+#define SOLVER_WARM_START
+//! The number of warm start entries per IVP: the proposed step size, the last accepted step size and its error estimate
+#define WARM_SIZE (3)
+#endif
+
 //! Memory required for Radau-IIa GPU solver
 struct solver_memory
 {
+#ifdef HESSENBERG_RADAU
+	//! The scalar factors of the Householder reflections of the Hessenberg reduced Jacobian @see hessenberg_reduce
+	double* tau;
+	//! The column interchanges of the shifted Hessenberg solves, shared by the real and complex systems
+	int* ipiv;
+	//! The eliminated column of the shifted Hessenberg solves (used as a real array for the real system)
+	cuDoubleComplex* hess_work;
+	//! The multipliers of the shifted Hessenberg solves (used as a real array for the real system)
+	cuDoubleComplex* hess_mult;
+#else
 	//! The matrix for the non-complex system solve
-	double* E1;
+	lu_real* E1;
 	//! The matrix for the complex system solve
-	cuDoubleComplex* E2;
-	//! The error weight scaling vector
-	double* scale;
+	lu_complex* E2;
 	//! Pivot indicies for E1
 	int* ipiv1;
 	//! Pivot indicies for E2
 	int* ipiv2;
+#endif
+	//! The error weight scaling vector
+	double* scale;
+	//! The (#TOL_SIZE) integration tolerances, shared by all threads @see tolerances.cuh
+	double* tol;
 	//! Stage 1 values
 	double* Z1;
 	//! Stage 2 values
@@ -46,18 +112,46 @@ struct solver_memory
 	double* DZ3;
 	//! Quadratic interpolate
 	double* CONT;
-	//! Initial state vectors
+	//! Initial state vectors of the accepted step, aliases DZ1
 	double* y0;
 	//! work vector
 	double* work1;
 	//! work vector
 	double* work2;
-	//! work vector
+	//! work vector of the error estimate, aliases DZ1
 	double* work3;
 	//! complex work vector
 	cuDoubleComplex* work4;
 	//! array of return codes @see RKCU_ErrCodes
 	int* result;
+#ifdef MIXED_PRECISION
+	//! the residual of the iterative refinement of the real system solve
+	double* refine1;
+	//! the residual of the iterative refinement of the complex system solve
+	cuDoubleComplex* refine2;
+#endif
+#ifdef STATISTICS
+	//! per-IVP integrator statistics, stored as `stats[INDEX(stat)]` @see StatisticIndex
+	int* stats;
+#endif
+#ifdef PROFILE_PHASES
+	//! per-thread phase counters, stored as `phases[INDEX(phase)]` (cycles) and `phases[INDEX(NUM_PHASES + phase)]` (calls) @see PhaseIndex
+	long long* phases;
+#endif
+#ifdef SOLVER_WARM_START
+	//! per-IVP warm start state kept between kernel calls, stored as `warm[INDEX(k)]` @see warm_start.cuh
+	double* warm;
+#endif
+#ifdef SPARSE_LU
+	//! the symbolic factorization of E1 and E2, shared by all threads @see sparse_lu.cuh
+	sparse_lu_pattern lu;
+#endif
+#ifdef BATCHED_LU
+	//! the batch of E1 and E2 factored by the library routines (if selected) @see batched_lu.cuh
+	batched_lu batched;
+	//! the step state of the IVPs suspended at a batched factorization, stored as `suspend[INDEX(k)]` (NULL if not selected)
+	double* suspend;
+#endif
 };
 
 /**
@@ -79,6 +173,10 @@ struct solver_memory
 #define EC_h_plus_t_equals_h (3)
 //! Maximum allowed Newton Iteration steps exceeded @see #NewtonMaxit
 #define EC_newton_max_iterations_exceeded (4)
+#ifdef BATCHED_LU
+//! Internal marker of an IVP suspended at a batched factorization, never returned @see batched_lu.cuh
+#define EC_lu_pending (-1)
+#endif
 
 /**
  * @}
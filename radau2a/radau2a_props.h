@@ -9,7 +9,11 @@
 #define RADAU2A_PROPS_H
 
 #include "header.h"
+#include "solver_options.h"
+#include "sparse_jacobian.h"
 #include <stdio.h>
+#include <stdbool.h>
+#include <complex.h>
 
 #ifdef GENERATE_DOCS
 namespace radau2a {
@@ -18,6 +22,74 @@ namespace radau2a {
 //! the matrix dimensions
 #define STRIDE (NSP)
 
+#if defined(SPECIES_MASK) && (defined(SPARSE_LU) || defined(MIXED_PRECISION))
+    #error "The masked Radau-IIa linear solves are incompatible with the SPARSE_LU and MIXED_PRECISION options"
+#endif
+
+#ifdef MIXED_PRECISION
+#ifdef SPARSE_LU
+    #error "The mixed precision Radau-IIa linear solves are incompatible with the SPARSE_LU option"
+#endif
+//! The precision of the factorized real system matrix E1
+typedef float lu_real;
+//! The precision of the factorized complex system matrix E2
+typedef float complex lu_complex;
+#else
+//! The precision of the factorized real system matrix E1
+typedef double lu_real;
+//! The precision of the factorized complex system matrix E2
+typedef double complex lu_complex;
+#endif
+
+#if defined(IGN_EVENT) && !defined(CONST_TIME_STEP)
+//! The Radau-IIa solver locates events and evaluates dense output on its internal steps, @see events.h
+#define SOLVER_EVENTS
+#endif
+
+#if defined(WARM_START) && !defined(CONST_TIME_STEP)
+//! The Radau-IIa solver reuses its Jacobian, LU factorizations and interpolant between calls, @see warm_start_memory
+#define SOLVER_WARM_START
+
+/**
+ * \brief The per-IVP state of the Radau-IIa solver kept between calls to integrate()
+ */
+typedef struct
+{
+    //! true if this struct holds the state at the end of a successful integrate() call
+    bool valid;
+    //! the state vector at the end of the previous call, used to detect external modification
+    double y[NSP];
+    //! the Jacobian, compressed if #SPARSE_JACOBIAN is defined
+    double A[JAC_SIZE];
+    //! the LU factorization of the real system matrix
+    lu_real E1[NSP * NSP];
+    //! the LU factorization of the complex system matrix
+    lu_complex E2[NSP * NSP];
+    //! the pivot indicies of E1
+    int ipiv1[NSP];
+    //! the pivot indicies of E2
+    int ipiv2[NSP];
+    //! the quadratic interpolant of the last accepted step
+    double CONT[NSP * 3];
+    //! the (unclamped) step size proposed after the last accepted step
+    double H;
+    //! the step size of the last accepted step
+    double Hold;
+    //! the step size used in the factorizations E1 and E2
+    double H_LU;
+    //! the Gustafsson controller step size
+    double Hacc;
+    //! the Gustafsson controller error
+    double ErrOld;
+    //! the Newton convergence rate
+    double NewtonRate;
+    //! true if the Jacobian may be reused, according to the Newton convergence of the last step
+    bool SkipJac;
+    //! true if the LU factorizations may be reused, according to the Newton convergence of the last step
+    bool SkipLU;
+} warm_start_memory;
+#endif
+
 /**
  * \addtogroup ErrorCodes Return codes of Integrators
  * @{
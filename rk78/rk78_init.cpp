@@ -14,55 +14,65 @@
 namespace rk78 {
 #endif
 
-//! State vector containers for boost
-std::vector<state_type*> state_vectors;
-//! RHS wrappers for boost
-std::vector<rhs_eval*> evaluators;
-//! Addaptive timesteppers
-std::vector<stepper*> steppers;
-//! ODE controllers
-std::vector<controller> controllers;
 #ifdef STIFFNESS_MEASURE
 std::vector<double> max_stepsize;
 #include <stdio.h>
 FILE* stepsizes;
 #endif
 
-extern "C" void initialize_solver(int);
-extern "C" void cleanup_solver(int);
+extern "C" void* initialize_solver(int);
+extern "C" void cleanup_solver(int, void*);
 extern "C" const char* solver_name();
 extern "C" void init_solver_log();
 extern "C" void solver_log();
 
-/*! \fn void initialize_solver(int num_threads)
+/*! \fn void* initialize_solver(int num_threads)
    \brief Initializes the solver
    \param num_threads The number of OpenMP threads to use
+   \return The (rk78_memory) state vectors, evaluators and controllers of each thread
+
+   If #NUMA_FIRST_TOUCH is defined, the objects of each thread are created by that thread, such that
+   they are placed on the NUMA node of the thread. @see numa_placement.h
 */
-void initialize_solver(int num_threads) {
+void* initialize_solver(int num_threads) {
+	rk78_memory* memory = new rk78_memory();
+	memory->state_vectors.resize(num_threads);
+	memory->evaluators.resize(num_threads);
+	memory->steppers.resize(num_threads);
+	memory->controllers.resize(num_threads);
 	//create the necessary state vectors and evaluators
+#ifdef NUMA_FIRST_TOUCH
+	// iteration i runs on thread i
+	#pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+#endif
 	for (int i = 0; i < num_threads; ++i)
 	{
-		state_vectors.push_back(new state_type(NSP, 0.0));
-		evaluators.push_back(new rhs_eval());
-		steppers.push_back(new stepper());
-		controllers.push_back(make_controlled<stepper>(ATOL, RTOL, *steppers[i]));
+		memory->state_vectors[i] = new state_type();
+		memory->state_vectors[i]->fill(0.0);
+		memory->evaluators[i] = new rhs_eval();
+		memory->steppers[i] = new stepper();
+		memory->controllers[i] = new controller(make_controlled<stepper>(ATOL, RTOL, *memory->steppers[i]));
 	}
+	return memory;
 }
 
 /*!
    \brief Cleans up the created solvers
    \param num_threads The number of OpenMP threads used
+   \param memory The rk78_memory returned by initialize_solver
 
    Frees and cleans up allocated RK78 memory.
 */
-void cleanup_solver(int num_threads) {
-	for (int i = 0; i < state_vectors.size(); ++i)
+void cleanup_solver(int num_threads, void* memory) {
+	rk78_memory* rk_mem = static_cast<rk78_memory*>(memory);
+	for (int i = 0; i < rk_mem->state_vectors.size(); ++i)
 	{
-		delete state_vectors[i];
-		delete evaluators[i];
-		delete steppers[i];
-		controllers.pop_back();
+		delete rk_mem->state_vectors[i];
+		delete rk_mem->evaluators[i];
+		delete rk_mem->steppers[i];
+		delete rk_mem->controllers[i];
 	}
+	delete rk_mem;
 #ifdef STIFFNESS_MEASURE
 	fclose(stepsizes);
 #endif
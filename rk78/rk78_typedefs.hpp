@@ -11,7 +11,10 @@
 #ifndef RK78_TYPEDEFS_HPP
 #define RK78_TYPEDEFS_HPP
 
+#include <array>
+#include <vector>
 #include <boost/numeric/odeint.hpp>
+#include <boost/numeric/odeint/algebra/array_algebra.hpp>
 using namespace boost::numeric::odeint;
 
 //our code
@@ -25,11 +28,11 @@ extern "C" {
 namespace rk78 {
 #endif
 
-//! state vector
-typedef std::vector< double > state_type;
+//! state vector, of fixed size such that the stepper stages are never resized or heap allocated
+typedef std::array< double , NSP > state_type;
 
-//! solver type
-typedef runge_kutta_fehlberg78< state_type , double > stepper;
+//! solver type, the array_algebra operations are unrolled over the (compile-time) NSP
+typedef runge_kutta_fehlberg78< state_type , double , state_type , double , array_algebra > stepper;
 
 //! controller type
 typedef controlled_runge_kutta< stepper > controller;
@@ -62,10 +65,24 @@ public:
 	//wrapper for the pyJac RHS fn
 	void operator() (const state_type &y , state_type &fy , const double t) const
 	{
-		dydt(t, this->m_statevar, &y[0], &fy[0]);
+		dydt(t, this->m_statevar, y.data(), fy.data());
 	}
 };
 
+/**
+   \brief The per-thread RK78 memory of a solver instance, returned by initialize_solver
+*/
+struct rk78_memory {
+	//! State vector containers for boost
+	std::vector<state_type*> state_vectors;
+	//! RHS wrappers for boost
+	std::vector<rhs_eval*> evaluators;
+	//! Addaptive timesteppers
+	std::vector<stepper*> steppers;
+	//! ODE controllers
+	std::vector<controller*> controllers;
+};
+
 #ifdef GENERATE_DOCS
 }
 #endif
@@ -13,29 +13,29 @@
 
 //boost includes
 #include <boost/numeric/odeint/integrate/integrate_adaptive.hpp>
+#include <algorithm>
 extern "C" {
 #include "solver.h"
+#include "solver_context.h"
+#include "state_layout.h"
 }
 
 #ifdef GENERATE_DOCS
 namespace rk78 {
 #endif
 
-extern std::vector<state_type*> state_vectors;
-extern std::vector<rhs_eval*> evaluators;
-extern std::vector<controller> controllers;
-
-extern "C" void intDriver(const int, const double, const double, const double*, double*);
+extern "C" void intDriver(accelerInt_context*, const int, const double, const double, const double*, double*);
+extern "C" void intDriverLocal(accelerInt_context*, const int, const double*, const double*, const double*, double*);
 
 #ifdef STIFFNESS_MEASURE
     extern std::vector<double> max_stepsize;
-    controlled_step_result test_step(int index, const state_type& y, const double t, state_type& y_out, const double dt)
+    controlled_step_result test_step(rk78_memory* memory, int index, const state_type& y, const double t, state_type& y_out, const double dt)
     {
         try
         {
             double t_copy = t;
             double dt_copy = dt;
-            return controllers[index]->try_step(*evaluators[index], y, t_copy, y_out, dt_copy);
+            return memory->controllers[index]->try_step(*memory->evaluators[index], y, t_copy, y_out, dt_copy);
         }
         catch(...)
         {
@@ -45,31 +45,54 @@ extern "C" void intDriver(const int, const double, const double, const double*,
 #endif
 
 /**
- * \brief Integration driver for the CPU integrators
+ * \brief Integration driver for the CPU integrators, @see intDriver and intDriverLocal
+ * \param[in,out]   context     the solver instance, whose accelerInt_context::solver holds the rk78_memory
  * \param[in]       NUM         the number of IVPs to solve
  * \param[in]       t           the current IVP time
  * \param[in]       t_end       the time to integrate the IVP to
+ * \param[in]       t_local     the per-IVP current times, or NULL if all IVPs are at `t`
+ * \param[in]       t_end_local the per-IVP end times, or NULL if all IVPs end at `t_end`
  * \param[in]       pr_global   the pressure value for the IVPs
  * \param[in, out]  y_global    the state vectors
  *
  * The integration driver for the RK78 solver
+ *
+ * The OpenMP schedule is controlled by #SCHEDULE_CLAUSE.  If #COST_REORDER is defined
+ * the IVPs are issued in order of descending cost measured on the previous call.
+ * The controller of each IVP is rebuilt with its tolerances (see tolerances.h).
  */
-void intDriver (const int NUM, const double t, const double t_end,
-                const double *pr_global, double *y_global)
+static void drive (accelerInt_context* context, const int NUM, const double t, const double t_end,
+                   const double* t_local, const double* t_end_local,
+                   const double *pr_global, double *y_global)
 {
+    rk78_memory* memory = static_cast<rk78_memory*>(context->solver);
+    std::vector<state_type*>& state_vectors = memory->state_vectors;
+    std::vector<rhs_eval*>& evaluators = memory->evaluators;
+    std::vector<controller*>& controllers = memory->controllers;
     #ifdef STIFFNESS_MEASURE
     max_stepsize.clear();
     max_stepsize.resize(NUM, 0.0);
     #endif
 
-	int tid = 0;
+#ifdef COST_REORDER
+    const int* order = get_ivp_order(&context->order, NUM);
+#endif
+	int k = 0;
 #ifdef STIFFNESS_MEASURE
-    #pragma omp parallel for shared(state_vectors, evaluators, controllers, max_stepsize) private(tid)
+    #pragma omp parallel for shared(state_vectors, evaluators, controllers, max_stepsize) private(k) SCHEDULE_CLAUSE num_threads(context->num_threads)
 #else
-	#pragma omp parallel for shared(state_vectors, evaluators, controllers) private(tid)
+	#pragma omp parallel for shared(state_vectors, evaluators, controllers) private(k) SCHEDULE_CLAUSE num_threads(context->num_threads)
+#endif
+    for (k = 0; k < NUM; ++k) {
+#ifdef COST_REORDER
+        int tid = order[k];
+        double cost_start = COST_TIMER();
+#else
+        int tid = k;
 #endif
-    for (tid = 0; tid < NUM; ++tid) {
     	int index = omp_get_thread_num();
+        const double t_ivp = ivp_time(t_local, t, tid);
+        const double t_end_ivp = ivp_time(t_end_local, t_end, tid);
 
         // local array with initial values
         state_type& vec = *state_vectors[index];
@@ -78,23 +101,39 @@ void intDriver (const int NUM, const double t, const double t_end,
         // load local array with initial values from global array
         for (int i = 0; i < NSP; i++)
         {
-            vec[i] = y_global[tid + i * NUM];
+            vec[i] = y_global[state_index(tid, i, NUM)];
+        }
+
+        // odeint's error checker supports scalar tolerances only, so the tightest absolute tolerance is used
+        load_tolerances(&context->tol, context->tol_scale, tid, &current_tolerances);
+        double atol = current_tolerances.atol[0];
+        for (int i = 1; i < NSP; i++)
+        {
+            atol = std::min(atol, current_tolerances.atol[i]);
         }
+        *controllers[index] = make_controlled<stepper>(atol, current_tolerances.rtol, *memory->steppers[index]);
 
 #ifndef STIFFNESS_MEASURE
-        integrate_adaptive(controllers[index],
-            *evaluators[index], vec, t, t_end, t_end - t);
+#ifdef STATISTICS
+        clear_counters();
+        STAT_ADD(STAT_STEPS, (int)integrate_adaptive(*controllers[index],
+            *evaluators[index], vec, t_ivp, t_end_ivp, t_end_ivp - t_ivp));
+        store_counters(&context->stats, tid);
+#else
+        integrate_adaptive(*controllers[index],
+            *evaluators[index], vec, t_ivp, t_end_ivp, t_end_ivp - t_ivp);
+#endif
 #else
         double tol = 1e-15;
         state_type y_copy(vec);
         //do a binary search to find the maximum stepsize
         double left_size = 1.0;
-        while (test_step(index, vec, t, y_copy, left_size) == success)
+        while (test_step(memory, index, vec, t_ivp, y_copy, left_size) == success)
         {
             left_size *= 10.0;
         }
         double right_size = 1e-20;
-        while (test_step(index, vec, t, y_copy, right_size) == fail)
+        while (test_step(memory, index, vec, t_ivp, y_copy, right_size) == fail)
         {
             right_size /= 10.0;
         }
@@ -102,7 +141,7 @@ void intDriver (const int NUM, const double t, const double t_end,
         double mid = 0;
         while (delta > tol) {
             mid = (left_size + right_size) / 2.0;
-            controlled_step_result result = test_step(index, vec, t, y_copy, mid);
+            controlled_step_result result = test_step(memory, index, vec, t_ivp, y_copy, mid);
             if (result == fail) {
                 //mid becomes the new left
                 delta = fabs(left_size - mid) / left_size;
@@ -119,10 +158,50 @@ void intDriver (const int NUM, const double t, const double t_end,
         // update global array with integrated values
         for (int i = 0; i < NSP; i++)
         {
-            y_global[tid + i * NUM] = vec[i];
+            y_global[state_index(tid, i, NUM)] = vec[i];
         }
+#ifdef COST_REORDER
+        record_ivp_cost(&context->order, tid, COST_TIMER() - cost_start);
+#endif
 
     }
+#ifdef COST_REORDER
+    update_ivp_order(&context->order, NUM);
+#endif
+}
+
+/**
+ * \brief Integration driver for the CPU integrators
+ * \param[in,out]   context     the solver instance, whose accelerInt_context::solver holds the rk78_memory
+ * \param[in]       NUM         the number of IVPs to solve
+ * \param[in]       t           the current IVP time
+ * \param[in]       t_end       the time to integrate the IVP to
+ * \param[in]       pr_global   the pressure value for the IVPs
+ * \param[in, out]  y_global    the state vectors
+ *
+ * @see drive
+ */
+void intDriver (accelerInt_context* context, const int NUM, const double t, const double t_end,
+                const double *pr_global, double *y_global)
+{
+    drive(context, NUM, t, t_end, NULL, NULL, pr_global, y_global);
+}
+
+/**
+ * \brief Integration driver for the CPU integrators, with per-IVP integration intervals
+ * \param[in,out]   context     the solver instance, whose accelerInt_context::solver holds the rk78_memory
+ * \param[in]       NUM         the number of IVPs to solve
+ * \param[in]       t_local     the (NUM) current times of the IVPs
+ * \param[in]       t_end_local the (NUM) times to integrate the IVPs to
+ * \param[in]       pr_global   the pressure value for the IVPs
+ * \param[in, out]  y_global    the state vectors
+ *
+ * @see drive
+ */
+void intDriverLocal (accelerInt_context* context, const int NUM, const double* t_local, const double* t_end_local,
+                     const double *pr_global, double *y_global)
+{
+    drive(context, NUM, 0, 0, t_local, t_end_local, pr_global, y_global);
 }
 
 #ifdef GENERATE_DOCS
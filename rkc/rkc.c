@@ -19,14 +19,42 @@
  *
  */
 
+#include <string.h>
 #include "rkc.h"
 #include "dydt.h"
 #include "solver_options.h"
+#include "solver_stats.h"
+#include "phase_profile.h"
+#include "warm_start.h"
+#include "tolerances.h"
 
 #ifdef GENERATE_DOCS
 namespace rkc {
 #endif
 
+/**
+ * \brief Evaluates the derivative function at the (#Real precision) state `y`, @see dydt
+ *
+ * With #RKC_SINGLE, the state is converted to, and the derivative from, the double precision of the mechanism.
+ */
+static inline void rkc_dydt (const double t, const double pr, const Real* y, Real* dy) {
+    PHASE_BEGIN(PHASE_RHS);
+#ifdef RKC_SINGLE
+    double y_d[NSP];
+    double dy_d[NSP];
+    for (int i = 0; i < NSP; ++i) {
+        y_d[i] = y[i];
+    }
+    dydt (t, pr, y_d, dy_d);
+    for (int i = 0; i < NSP; ++i) {
+        dy[i] = (Real)dy_d[i];
+    }
+#else
+    dydt (t, pr, y, dy);
+#endif
+    PHASE_END(PHASE_RHS);
+}
+
 /**
  * \brief Function to estimate spectral radius.
  *
@@ -38,7 +66,7 @@ namespace rkc {
  * \param[in,out] v Array for eigenvectors
  * \param[out] Fv   Array for derivative evaluations
  */
-Real rkc_spec_rad (const Real t, const Real pr, const Real hmax, const Real* y,
+Real rkc_spec_rad (const double t, const double pr, const Real hmax, const Real* y,
                    const Real* F, Real* v, Real* Fv) {
 
     const int itmax = 50;
@@ -80,7 +108,7 @@ Real rkc_spec_rad (const Real t, const Real pr, const Real hmax, const Real* y,
     Real sigma = ZERO;
     for (int iter = 1; iter <= itmax; ++iter) {
 
-        dydt (t, pr, v, Fv);
+        rkc_dydt (t, pr, v, Fv);
 
         nrm1 = ZERO;
         for (int i = 0; i < NSP; ++i) {
@@ -122,7 +150,7 @@ Real rkc_spec_rad (const Real t, const Real pr, const Real hmax, const Real* y,
  * \param[in] s    number of steps.
  * \param[out] y_j  Integrated variables.
  */
-void rkc_step (const Real t, const Real pr, const Real h, const Real* y_0, const Real* F_0,
+void rkc_step (const double t, const double pr, const Real h, const Real* y_0, const Real* F_0,
                const int s, Real* y_j) {
 
     const Real w0 = ONE + TWO / (13.0 * (Real)(s * s));
@@ -166,7 +194,7 @@ void rkc_step (const Real t, const Real pr, const Real h, const Real* y_0, const
         mu_t = mu * w1 / w0;
 
           // calculate derivative, use y array for temporary storage
-        dydt (t + (h * c_jm1), pr, y_jm1, y_j);
+        rkc_dydt (t + (h * c_jm1), pr, y_jm1, y_j);
 
         for (int i = 0; i < NSP; ++i) {
             y_j[i] = (ONE - mu - nu) * y_0[i] + (mu * y_jm1[i]) + (nu * y_jm2[i])
@@ -205,13 +233,28 @@ void rkc_step (const Real t, const Real pr, const Real h, const Real* y_0, const
  * \param[in] pr        A parameter used for pressure or density to pass to the derivative function.
 // * \param[in] task      0 to take a single integration step, 1 to integrate to tEnd.
  * \param[in,out] y     Dependent variable array, integrated values replace initial conditions.
+ *
+ * The times and `y` are double precision also with #RKC_SINGLE, the state is integrated in #Real precision.
  */
-int integrate (Real t, const Real tEnd, const Real pr, Real* y) {
-
+int integrate (double t, const double tEnd, const double pr, double* y) {
+
+#ifdef SOLVER_WARM_START
+    // continue from the step size, error history, spectral radius and eigenvector of the previous call
+    // (zeroed, i.e. a cold start, if there is none).  The spectral radius is only re-estimated
+    // once RKC_SPEC_RAD_INTERVAL accepted steps have passed since its estimate, counted over calls
+    warm_start_memory* ws = current_warm_start;
+    Real* work = ws->work;
+    if (!ws->valid) {
+        memset(work, 0, (4 + NSP) * sizeof(Real));
+        ws->rad_age = 0;
+    }
+    int nstep = ws->rad_age;
+#else
     int nstep = 0;
     Real work[4 + NSP] = {0};
+#endif
 
-    int m_max = (int)(round(sqrt(RTOL / (10.0 * UROUND))));
+    int m_max = (int)(round(sqrt(current_tolerances.rtol / (10.0 * UROUND))));
 
     if (m_max < 2) {
         m_max = 2;
@@ -224,7 +267,7 @@ int integrate (Real t, const Real tEnd, const Real pr, Real* y) {
 
     // calculate F_n for initial y
     Real F_n[NSP];
-    dydt (t, pr, y_n, F_n);
+    rkc_dydt (t, pr, y_n, F_n);
 
     // load initial estimate for eigenvector
     if (work[2] < UROUND) {
@@ -236,6 +279,9 @@ int integrate (Real t, const Real tEnd, const Real pr, Real* y) {
     const Real hmax = fabs(tEnd - t);
     Real hmin = TEN * UROUND * fmax(fabs(t), hmax);
 
+    // the tentative state
+    Real y_np1[NSP];
+
     while (t < tEnd) {
         // use time step stored in work[2]
 
@@ -244,9 +290,10 @@ int integrate (Real t, const Real tEnd, const Real pr, Real* y) {
         Real err;
 
         // estimate Jacobian spectral radius
-        // only if 25 steps passed
-        if ((nstep % 25) == 0) {
+        // only if RKC_SPEC_RAD_INTERVAL steps passed
+        if ((nstep % RKC_SPEC_RAD_INTERVAL) == 0) {
             work[3] = rkc_spec_rad (t, pr, hmax, y_n, F_n, &work[4], temp_arr2);
+            STAT_INC(STAT_JAC_EVALS);
         }
 
         // first step, estimate step size
@@ -260,11 +307,11 @@ int integrate (Real t, const Real tEnd, const Real pr, Real* y) {
             for (int i = 0; i < NSP; ++i) {
                 temp_arr[i] = y_n[i] + (work[2] * F_n[i]);
             }
-            dydt (t + work[2], pr, temp_arr, temp_arr2);
+            rkc_dydt (t + work[2], pr, temp_arr, temp_arr2);
 
             err = ZERO;
             for (int i = 0; i < NSP; ++i) {
-                Real est = (temp_arr2[i] - F_n[i]) / (ATOL + RTOL * fabs(y_n[i]));
+                Real est = (temp_arr2[i] - F_n[i]) / (current_tolerances.atol[i] + current_tolerances.rtol * fabs(y_n[i]));
                 err += est * est;
             }
             err = work[2] * sqrt(err / NSP);
@@ -292,16 +339,16 @@ int integrate (Real t, const Real tEnd, const Real pr, Real* y) {
         hmin = TEN * UROUND * fmax(fabs(t), fabs(t + work[2]));
 
         // perform tentative time step
-        rkc_step (t, pr, work[2], y_n, F_n, m, y);
+        rkc_step (t, pr, work[2], y_n, F_n, m, y_np1);
 
         // calculate F_np1 with tenative y_np1
-        dydt (t + work[2], pr, y, temp_arr);
+        rkc_dydt (t + work[2], pr, y_np1, temp_arr);
 
         // estimate error
         err = ZERO;
         for (int i = 0; i < NSP; ++i) {
-            Real est = P8 * (y_n[i] - y[i]) + P4 * work[2] * (F_n[i] + temp_arr[i]);
-            est /= (ATOL + RTOL * fmax(fabs(y[i]), fabs(y_n[i])));
+            Real est = P8 * (y_n[i] - y_np1[i]) + P4 * work[2] * (F_n[i] + temp_arr[i]);
+            est /= (current_tolerances.atol[i] + current_tolerances.rtol * fmax(fabs(y_np1[i]), fabs(y_n[i])));
             err += est * est;
         }
         err = sqrt(err / ((Real)NSP));
@@ -314,10 +361,13 @@ int integrate (Real t, const Real tEnd, const Real pr, Real* y) {
 
             // reevaluate spectral radius
             work[3] = rkc_spec_rad (t, pr, hmax, y_n, F_n, &work[4], temp_arr2);
+            STAT_INC(STAT_REJECTED);
+            STAT_INC(STAT_JAC_EVALS);
         } else {
             // step accepted
             t += work[2];
             nstep++;
+            STAT_INC(STAT_STEPS);
 
             Real fac = TEN;
             Real temp1, temp2;
@@ -340,7 +390,7 @@ int integrate (Real t, const Real tEnd, const Real pr, Real* y) {
             work[1] = work[2];
 
             for (int i = 0; i < NSP; ++i) {
-                y_n[i] = y[i];
+                y_n[i] = y_np1[i];
                 F_n[i] = temp_arr[i];
             }
 
@@ -357,6 +407,15 @@ int integrate (Real t, const Real tEnd, const Real pr, Real* y) {
 
     }
 
+    for (int i = 0; i < NSP; ++i) {
+        y[i] = y_n[i];
+    }
+
+#ifdef SOLVER_WARM_START
+    ws->rad_age = nstep % RKC_SPEC_RAD_INTERVAL;
+    ws->valid = true;
+#endif
+
     return EC_success;
 
 } // rkc_driver
@@ -5,14 +5,52 @@
 namespace rkc_cu {
 #endif
 
+// the warp-per-IVP implementation is in rkc_warp.cu
+#ifndef WARP_IVP
+
 //#define SHARED
 
 /////////////////////////////////////////////////////////
 
+__device__ __forceinline__
+void rkc_dydt (const double t, const double pr, const Real* y, Real* dy,
+               mechanism_memory const * const __restrict__ mech,
+               solver_memory const * const __restrict__ solver) {
+   /**
+    * Evaluates the derivative function at the (Real precision) state y, with RKC_SINGLE
+    * the state is converted to, and the derivative from, the double precision of the mechanism.
+    *
+    * @param t    the time.
+    * @param pr   A parameter used for pressure or density to pass to the derivative function.
+    * @param y    Array of dependent variable.
+    * @param dy   Array for the derivative evaluation
+    * @param mech The mechanism memory struct
+    * @param solver The solver memory struct (for the conversion and phase counters)
+    */
+    PHASE_BEGIN(solver, PHASE_RHS);
+#ifdef RKC_SINGLE
+    double * const __restrict__ y_rhs = solver->y_rhs;
+    double * const __restrict__ dy_rhs = solver->dy_rhs;
+    for (int i = 0; i < NSP; ++i) {
+        y_rhs[INDEX(i)] = y[INDEX(i)];
+    }
+    dydt (t, pr, y_rhs, dy_rhs, mech);
+    for (int i = 0; i < NSP; ++i) {
+        dy[INDEX(i)] = (Real)dy_rhs[INDEX(i)];
+    }
+#else
+    dydt (t, pr, y, dy, mech);
+#endif
+    PHASE_END(solver, PHASE_RHS);
+}
+
+/////////////////////////////////////////////////////////
+
 __device__
-Real rkc_spec_rad (const Real t, const Real pr, const Real hmax, const Real* y,
+Real rkc_spec_rad (const double t, const double pr, const Real hmax, const Real* y,
                    const Real* F, Real* v, Real* Fv,
-                   mechanism_memory const * const __restrict__ mech) {
+                   mechanism_memory const * const __restrict__ mech,
+                   solver_memory const * const __restrict__ solver) {
    /**
     * Function to estimate spectral radius.
     *
@@ -23,6 +61,8 @@ Real rkc_spec_rad (const Real t, const Real pr, const Real hmax, const Real* y,
     * @param F    Derivative evaluated at current state
     * @param v
     * @param Fv
+    * @param mech The mechanism memory struct
+    * @param solver The solver memory struct (for the phase counters)
     */
 
     const int itmax = 50;
@@ -68,7 +108,7 @@ Real rkc_spec_rad (const Real t, const Real pr, const Real hmax, const Real* y,
     Real sigma = ZERO;
     for (int iter = 1; iter <= itmax; ++iter) {
 
-        dydt (t, pr, v, Fv, mech);
+        rkc_dydt (t, pr, v, Fv, mech, solver);
 
         nrm1 = ZERO;
         for (int i = 0; i < NSP; ++i) {
@@ -101,10 +141,11 @@ Real rkc_spec_rad (const Real t, const Real pr, const Real hmax, const Real* y,
 ///////////////////////////////////////////////////////
 
 __device__
-void rkc_step (const Real t, const Real pr, const Real h, const Real* y_0,
+void rkc_step (const double t, const double pr, const Real h, const Real* y_0,
                const Real* F_0, const int s, Real* y_j,
                Real* y_jm1, Real* y_jm2,
-               mechanism_memory const * const __restrict__ mech) {
+               mechanism_memory const * const __restrict__ mech,
+               solver_memory const * const __restrict__ solver) {
    /**
     * Function to take a single RKC integration step
     *
@@ -115,6 +156,8 @@ void rkc_step (const Real t, const Real pr, const Real h, const Real* y_0,
     * @param F_0  Derivative function at initial conditions.
     * @param s    number of steps.
     * @param y_j  Integrated variables.
+    * @param mech The mechanism memory struct
+    * @param solver The solver memory struct (for the phase counters)
     */
 
     const Real w0 = ONE + TWO / (13.0 * (Real)(s * s));
@@ -158,7 +201,7 @@ void rkc_step (const Real t, const Real pr, const Real h, const Real* y_0,
         mu_t = mu * w1 / w0;
 
           // calculate derivative, use y array for temporary storage
-        dydt (t + (h * c_jm1), pr, y_jm1, y_j, mech);
+        rkc_dydt (t + (h * c_jm1), pr, y_jm1, y_j, mech, solver);
 
         for (int i = 0; i < NSP; ++i) {
             y_j[INDEX(i)] = (ONE - mu - nu) * y_0[INDEX(i)] + (mu * y_jm1[INDEX(i)]) + (nu * y_jm2[INDEX(i)])
@@ -189,10 +232,10 @@ void rkc_step (const Real t, const Real pr, const Real h, const Real* y_0,
 
 /////////////////////////////////////////////////////////////
 
-__device__ void integrate (const Real tstart,
-                            const Real tEnd,
-                            const Real pr,
-                            Real *y,
+__device__ void integrate (const double tstart,
+                            const double tEnd,
+                            const double pr,
+                            double * const __restrict__ y,
                             mechanism_memory const * const __restrict__ mech,
                             solver_memory const * const __restrict__ solver) {
    /**
@@ -204,11 +247,13 @@ __device__ void integrate (const Real tstart,
     * @param y      Dependent variable array, integrated values replace initial conditions.
     * @param mech   The mechanism_memory struct that contains the pre-allocated memory for the RHS \ Jacobian evaluation
     * @param solver The solver_memory struct that contains the pre-allocated memory for the solver
+    *
+    * The times and y are double precision also with RKC_SINGLE, the state is integrated in Real precision.
     */
 
-    Real t = tstart;
-    int nstep = 0;
-    int mMax = (int)(round(sqrt(RTOL / (10.0 * UROUND))));
+    double t = tstart;
+    double const * const __restrict__ tol = solver->tol;
+    int mMax = (int)(round(sqrt(TOL_RTOL(tol) / (10.0 * UROUND))));
 
     if (mMax < 2) {
         mMax = 2;
@@ -223,11 +268,28 @@ __device__ void integrate (const Real tstart,
     // calculate F_n for initial y
     Real * const __restrict__ F_n = solver->F_n;
     //Real F_n[INDEX(NSP)];
-    dydt (t, pr, y_n, F_n, mech);
+    rkc_dydt (t, pr, y_n, F_n, mech, solver);
+    STAT_RESET(solver);
 
     // load initial estimate for eigenvector
     // Real work [INDEX(NSP + 4)];
     Real * const __restrict__ work = solver->work;
+#ifdef SOLVER_WARM_START
+    // continue from the step size, error history, spectral radius and eigenvector of the previous kernel call
+    // (zeroed, i.e. a cold start, if there is none).  The spectral radius is only re-estimated
+    // once RKC_SPEC_RAD_INTERVAL accepted steps have passed since its estimate, counted over calls
+    double * const __restrict__ warm = solver->warm;
+    for (int i = 0; i < 4 + NSP; ++i) {
+        work[INDEX(i)] = warm[INDEX(i)];
+    }
+    int nstep = (int)warm[INDEX(4 + NSP)];
+#else
+    int nstep = 0;
+    // the work array is reused by the next IVP assigned to this thread
+    for (int i = 0; i < 4 + NSP; ++i) {
+        work[INDEX(i)] = ZERO;
+    }
+#endif
     if (work[INDEX(2)] < UROUND) {
         for (int i = 0; i < NSP; ++i) {
             work[INDEX(4 + i)] = F_n[INDEX(i)];
@@ -245,15 +307,22 @@ __device__ void integrate (const Real tstart,
 
     Real * const __restrict__ y_jm1 = solver->y_jm1;
     Real * const __restrict__ y_jm2 = solver->y_jm2;
+#ifdef RKC_SINGLE
+    Real * const __restrict__ y_np1 = solver->y_np1;
+#else
+    // the tentative state is stored in y
+    Real * const __restrict__ y_np1 = y;
+#endif
 
     while (t < tEnd) {
         Real err;
 
         // estimate Jacobian spectral radius
-        // only if 25 steps passed
-        if ((nstep % 25) == 0) {
+        // only if RKC_SPEC_RAD_INTERVAL steps passed
+        if ((nstep % RKC_SPEC_RAD_INTERVAL) == 0) {
             //spec_rad = rkc_spec_rad (t, pr, y_n, F_n, temp_arr, temp_arr2);
-            work[INDEX(3)] = rkc_spec_rad (t, pr, stepSizeMax, y_n, F_n, &work[4 * GRID_DIM], temp_arr2, mech);
+            work[INDEX(3)] = rkc_spec_rad (t, pr, stepSizeMax, y_n, F_n, &work[4 * GRID_DIM], temp_arr2, mech, solver);
+            STAT_INC(solver, STAT_JAC_EVALS);
         }
         //Real spec_rad = rkc_spec_rad (t, pr, y_n, F_n, temp_arr, temp_arr2);
 
@@ -268,11 +337,11 @@ __device__ void integrate (const Real tstart,
             for (int i = 0; i < NSP; ++i) {
                 temp_arr[INDEX(i)] = y_n[INDEX(i)] + (work[INDEX(2)] * F_n[INDEX(i)]);
             }
-            dydt (t + work[INDEX(2)], pr, temp_arr, temp_arr2, mech);
+            rkc_dydt (t + work[INDEX(2)], pr, temp_arr, temp_arr2, mech, solver);
 
             err = ZERO;
             for (int i = 0; i < NSP; ++i) {
-                Real est = (temp_arr2[INDEX(i)] - F_n[INDEX(i)]) / (ATOL + RTOL * fabs(y_n[INDEX(i)]));
+                Real est = (temp_arr2[INDEX(i)] - F_n[INDEX(i)]) / (TOL_ATOL(tol, i) + TOL_RTOL(tol) * fabs(y_n[INDEX(i)]));
                 err += est * est;
             }
             err = work[INDEX(2)] * sqrt(err / NSP);
@@ -300,16 +369,16 @@ __device__ void integrate (const Real tstart,
         }
 
         // perform tentative time step
-        rkc_step (t, pr, work[INDEX(2)], y_n, F_n, m, y, y_jm1, y_jm2, mech);
+        rkc_step (t, pr, work[INDEX(2)], y_n, F_n, m, y_np1, y_jm1, y_jm2, mech, solver);
 
         // calculate F_np1 with tenative y_np1
-        dydt (t + work[INDEX(2)], pr, y, temp_arr, mech);
+        rkc_dydt (t + work[INDEX(2)], pr, y_np1, temp_arr, mech, solver);
 
         // estimate error
         err = ZERO;
         for (int i = 0; i < NSP; ++i) {
-            Real est = P8 * (y_n[INDEX(i)] - y[INDEX(i)]) + P4 * work[INDEX(2)] * (F_n[INDEX(i)] + temp_arr[INDEX(i)]);
-            est /= (ATOL + RTOL * fmax(fabs(y[INDEX(i)]), fabs(y_n[INDEX(i)])));
+            Real est = P8 * (y_n[INDEX(i)] - y_np1[INDEX(i)]) + P4 * work[INDEX(2)] * (F_n[INDEX(i)] + temp_arr[INDEX(i)]);
+            est /= (TOL_ATOL(tol, i) + TOL_RTOL(tol) * fmax(fabs(y_np1[INDEX(i)]), fabs(y_n[INDEX(i)])));
             err += est * est;
         }
         err = sqrt(err / ((Real)NSP));
@@ -322,11 +391,14 @@ __device__ void integrate (const Real tstart,
 
             // reevaluate spectral radius
             //spec_rad = rkc_spec_rad (t, pr, y_n, F_n, temp_arr, temp_arr2);
-            work[INDEX(3)] = rkc_spec_rad (t, pr, stepSizeMax, y_n, F_n, &work[GRID_DIM * 4], temp_arr2, mech);
+            work[INDEX(3)] = rkc_spec_rad (t, pr, stepSizeMax, y_n, F_n, &work[GRID_DIM * 4], temp_arr2, mech, solver);
+            STAT_INC(solver, STAT_REJECTED);
+            STAT_INC(solver, STAT_JAC_EVALS);
         } else {
             // step accepted
             t += work[INDEX(2)];
             nstep++;
+            STAT_INC(solver, STAT_STEPS);
 
             Real fac = TEN;
             Real temp1, temp2;
@@ -349,7 +421,7 @@ __device__ void integrate (const Real tstart,
             work[INDEX(1)] = work[INDEX(2)];
 
             for (int i = 0; i < NSP; ++i) {
-                y_n[INDEX(i)] = y[INDEX(i)];
+                y_n[INDEX(i)] = y_np1[INDEX(i)];
                 F_n[INDEX(i)] = temp_arr[INDEX(i)];
             }
 
@@ -365,11 +437,25 @@ __device__ void integrate (const Real tstart,
 
     }
 
+#ifdef RKC_SINGLE
+    for (int i = 0; i < NSP; ++i) {
+        y[INDEX(i)] = y_n[INDEX(i)];
+    }
+#endif
+
+#ifdef SOLVER_WARM_START
+    for (int i = 0; i < 4 + NSP; ++i) {
+        warm[INDEX(i)] = work[INDEX(i)];
+    }
+    warm[INDEX(4 + NSP)] = (double)(nstep % RKC_SPEC_RAD_INTERVAL);
+#endif
     int * const __restrict__ result = solver->result;
     result[T_ID] = EC_success;
 
 } // rkc_driver
 
+#endif
+
 
 #ifdef GENERATE_DOCS
 }
@@ -6,8 +6,8 @@
 #include "solver_options.cuh"
 
 //__device__ Real rkc_spec_rad (const Real, const Real, const Real*, const Real*, Real*, Real*);
-__device__ Real rkc_spec_rad (const Real, const Real, const Real, const Real*, const Real*, Real*, Real*);
-__device__ void rkc_step (const Real, const Real, const Real, const Real*, const Real*, const int, Real*);
+__device__ Real rkc_spec_rad (const double, const double, const Real, const Real*, const Real*, Real*, Real*);
+__device__ void rkc_step (const double, const double, const Real, const Real*, const Real*, const int, Real*);
 __device__ void rkc_driver (Real, const Real, const Real, int, Real*, Real*);
 
 #endif
\ No newline at end of file
@@ -5,8 +5,8 @@
 #include "rkc_props.h"
 
 //Real rkc_spec_rad (const Real, const Real, const Real*, const Real*, Real*, Real*);
-Real rkc_spec_rad (const Real, const Real, const Real, const Real*, const Real*, Real*, Real*);
-void rkc_step (const Real, const Real, const Real, const Real*, const Real*, const int, Real*);
+Real rkc_spec_rad (const double, const double, const Real, const Real*, const Real*, Real*, Real*);
+void rkc_step (const double, const double, const Real, const Real*, const Real*, const int, Real*);
 void rkc_driver (Real, const Real, const Real, int, Real*, Real*);
 
 #endif
\ No newline at end of file
@@ -7,11 +7,15 @@
  *
  */
 
+#include <stddef.h>
+
 #ifdef GENERATE_DOCS
 namespace rkc {
 #endif
 
- void initialize_solver() {
+ void* initialize_solver(int num_threads) {
+    //the RKC solver keeps no per-thread memory
+    return NULL;
  }
 
 /*!
@@ -23,7 +27,7 @@ namespace rkc {
     return name;
  }
 
- void cleanup_solver() {
+ void cleanup_solver(int num_threads, void* memory) {
     //nothing to do
  }
 
@@ -40,15 +40,33 @@ namespace rkc_cu {
     //return the size (in bytes), needed per cuda thread
     size_t num_bytes = 0;
     // state vector
-    num_bytes += NSP * sizeof(double);
+    num_bytes += NSP * sizeof(Real);
     // derivatives
-    num_bytes += NSP * sizeof(double);
+    num_bytes += NSP * sizeof(Real);
     // work array with 4 extra spots
-    num_bytes += (4 + NSP) * sizeof(double);
+    num_bytes += (4 + NSP) * sizeof(Real);
     // four regular work arrays of size NSP
-    num_bytes += 4 * NSP * sizeof(double);
+    num_bytes += 4 * NSP * sizeof(Real);
+#ifdef RKC_SINGLE
+    // the tentative state vector
+    num_bytes += NSP * sizeof(Real);
+    // the double precision state and derivative vectors of the RHS evaluation
+    num_bytes += 2 * NSP * sizeof(double);
+#endif
     // result array
     num_bytes += 1 * sizeof(int);
+#ifdef STATISTICS
+    // statistics counters
+    num_bytes += NUM_STATS * sizeof(int);
+#endif
+#ifdef PROFILE_PHASES
+    // phase counters
+    num_bytes += 2 * NUM_PHASES * sizeof(long long);
+#endif
+#ifdef SOLVER_WARM_START
+    // warm start state
+    num_bytes += WARM_SIZE * sizeof(double);
+#endif
 
     return num_bytes;
  }
@@ -60,7 +78,7 @@ namespace rkc_cu {
  */
 void createAndZero(void** ptr, size_t size)
 {
-  cudaErrorCheck(cudaMalloc(ptr, size));
+  cudaErrorCheck(arena_malloc(ptr, size));
   cudaErrorCheck(cudaMemset(*ptr, 0, size));
 }
 
@@ -72,16 +90,31 @@ void createAndZero(void** ptr, size_t size)
 */
 void initialize_solver(const int padded, solver_memory** h_mem, solver_memory** d_mem) {
   // Allocate storage for the device struct
-  cudaErrorCheck( cudaMalloc(d_mem, sizeof(solver_memory)) );
+  cudaErrorCheck( arena_malloc(d_mem, sizeof(solver_memory)) );
   //allocate the device arrays on the host pointer
-  createAndZero((void**)&((*h_mem)->y_n), NSP * padded * sizeof(double));
-  createAndZero((void**)&((*h_mem)->F_n), NSP * padded * sizeof(double));
-  createAndZero((void**)&((*h_mem)->work), (NSP + 4) * padded * sizeof(double));
-  createAndZero((void**)&((*h_mem)->temp_arr), NSP * padded * sizeof(double));
-  createAndZero((void**)&((*h_mem)->temp_arr2), NSP * padded * sizeof(double));
-  createAndZero((void**)&((*h_mem)->y_jm1), NSP * padded * sizeof(double));
-  createAndZero((void**)&((*h_mem)->y_jm2), NSP * padded * sizeof(double));
+  createAndZero((void**)&((*h_mem)->y_n), NSP * padded * sizeof(Real));
+  createAndZero((void**)&((*h_mem)->F_n), NSP * padded * sizeof(Real));
+  createAndZero((void**)&((*h_mem)->work), (NSP + 4) * padded * sizeof(Real));
+  createAndZero((void**)&((*h_mem)->temp_arr), NSP * padded * sizeof(Real));
+  createAndZero((void**)&((*h_mem)->temp_arr2), NSP * padded * sizeof(Real));
+  createAndZero((void**)&((*h_mem)->y_jm1), NSP * padded * sizeof(Real));
+  createAndZero((void**)&((*h_mem)->y_jm2), NSP * padded * sizeof(Real));
+#ifdef RKC_SINGLE
+  createAndZero((void**)&((*h_mem)->y_np1), NSP * padded * sizeof(Real));
+  createAndZero((void**)&((*h_mem)->y_rhs), NSP * padded * sizeof(double));
+  createAndZero((void**)&((*h_mem)->dy_rhs), NSP * padded * sizeof(double));
+#endif
   createAndZero((void**)&((*h_mem)->result), padded * sizeof(int));
+#ifdef STATISTICS
+  createAndZero((void**)&((*h_mem)->stats), NUM_STATS * padded * sizeof(int));
+#endif
+#ifdef PROFILE_PHASES
+  createAndZero((void**)&((*h_mem)->phases), 2 * NUM_PHASES * padded * sizeof(long long));
+#endif
+#ifdef SOLVER_WARM_START
+  createAndZero((void**)&((*h_mem)->warm), WARM_SIZE * padded * sizeof(double));
+#endif
+  initialize_tolerances(&(*h_mem)->tol);
 
   //copy host struct to device
   cudaErrorCheck( cudaMemcpy(*d_mem, *h_mem, sizeof(solver_memory), cudaMemcpyHostToDevice) );
@@ -94,13 +127,28 @@ void initialize_solver(const int padded, solver_memory** h_mem, solver_memory**
    @see solver_options.cuh
 */
  void cleanup_solver(solver_memory** h_mem, solver_memory** d_mem) {
-  cudaErrorCheck(cudaFree((*h_mem)->y_n));
-  cudaErrorCheck(cudaFree((*h_mem)->F_n));
-  cudaErrorCheck(cudaFree((*h_mem)->work));
-  cudaErrorCheck(cudaFree((*h_mem)->temp_arr));
-  cudaErrorCheck(cudaFree((*h_mem)->temp_arr2));
-  cudaErrorCheck(cudaFree((*h_mem)->y_jm1));
-  cudaErrorCheck(cudaFree((*h_mem)->y_jm2));
-  cudaErrorCheck(cudaFree((*h_mem)->result));
-  cudaErrorCheck(cudaFree(*d_mem));
+  cudaErrorCheck(arena_free((*h_mem)->y_n));
+  cudaErrorCheck(arena_free((*h_mem)->F_n));
+  cudaErrorCheck(arena_free((*h_mem)->work));
+  cudaErrorCheck(arena_free((*h_mem)->temp_arr));
+  cudaErrorCheck(arena_free((*h_mem)->temp_arr2));
+  cudaErrorCheck(arena_free((*h_mem)->y_jm1));
+  cudaErrorCheck(arena_free((*h_mem)->y_jm2));
+#ifdef RKC_SINGLE
+  cudaErrorCheck(arena_free((*h_mem)->y_np1));
+  cudaErrorCheck(arena_free((*h_mem)->y_rhs));
+  cudaErrorCheck(arena_free((*h_mem)->dy_rhs));
+#endif
+  cudaErrorCheck(arena_free((*h_mem)->result));
+#ifdef STATISTICS
+  cudaErrorCheck(arena_free((*h_mem)->stats));
+#endif
+#ifdef PROFILE_PHASES
+  cudaErrorCheck(arena_free((*h_mem)->phases));
+#endif
+#ifdef SOLVER_WARM_START
+  cudaErrorCheck(arena_free((*h_mem)->warm));
+#endif
+  cleanup_tolerances((*h_mem)->tol);
+  cudaErrorCheck(arena_free(*d_mem));
 }
\ No newline at end of file
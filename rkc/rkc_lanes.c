@@ -0,0 +1,510 @@
+/**
+ * \file
+ * \brief Lockstep integration of multiple IVPs with the Runge-Kutta-Chebyshev (RKC) solver
+ *
+ * The IVPs of a group are stored lane-wise, i.e. `y[lane + i * SIMD_LANES]`, such that
+ * the stage updates, error estimates and step size control of the RKC method vectorize
+ * over the lanes (the same layout the GPU solver uses over the threads of a warp).
+ * All lanes take the same number of stages per step, the maximum required by any active lane.
+ * This is always stable, as the stability region of the RKC method grows with the number of stages.
+ * The times, step sizes and step acceptance are tracked per lane, and lanes that reach the
+ * end time are masked out of the remaining steps.
+ * If #DYDT_BATCH is defined, the derivatives of all lanes are evaluated by a single dydt_batch call,
+ * the unused lanes of a group at the state of its first lane.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "rkc.h"
+#include "dydt.h"
+#include "solver_options.h"
+#include "solver_stats.h"
+#include "phase_profile.h"
+#include "warm_start.h"
+#include "tolerances.h"
+
+#ifdef GENERATE_DOCS
+namespace rkc {
+#endif
+
+#if defined(SIMD_LANES) && defined(LANE_INTEGRATOR)
+
+//! The lane-wise index of entry `i` of `lane`
+#define LANE(i, lane) ((lane) + (i) * SIMD_LANES)
+
+/**
+ * \brief Copies the entries of `lane` from the lane-wise array `src` into the contiguous array `dst`
+ */
+static inline void gather_lane(const int lane, const Real* src, Real* dst) {
+    for (int i = 0; i < NSP; ++i) {
+        dst[i] = src[LANE(i, lane)];
+    }
+}
+
+/**
+ * \brief Copies the contiguous array `src` into the entries of `lane` of the lane-wise array `dst`
+ */
+static inline void scatter_lane(const int lane, const Real* src, Real* dst) {
+    for (int i = 0; i < NSP; ++i) {
+        dst[LANE(i, lane)] = src[i];
+    }
+}
+
+/**
+ * \brief Estimates the spectral radius of the Jacobian of a single lane, @see rkc_spec_rad
+ *
+ * \param[in] lane  The lane index
+ * \param[in] t     The time of the lane
+ * \param[in] pr    The parameter of the lane
+ * \param[in] hmax  Max time step size.
+ * \param[in] y     The lane-wise dependent variables
+ * \param[in] F     The lane-wise derivatives evaluated at `y`
+ * \param[in,out] v The lane-wise eigenvector estimates
+ */
+static Real spec_rad_lane (const int lane, const Real t, const Real pr, const Real hmax,
+                           const Real* y, const Real* F, Real* v) {
+    Real y_l[NSP];
+    Real F_l[NSP];
+    Real v_l[NSP];
+    Real Fv_l[NSP];
+    gather_lane(lane, y, y_l);
+    gather_lane(lane, F, F_l);
+    gather_lane(lane, v, v_l);
+    Real rad = rkc_spec_rad (t, pr, hmax, y_l, F_l, v_l, Fv_l);
+    scatter_lane(lane, v_l, v);
+    return rad;
+}
+
+/**
+ * \brief Evaluates the derivatives of all active lanes, the derivatives of inactive lanes are set to zero
+ *
+ * The dydt (or dydt_batch) calls are counted in #PHASE_RHS here.
+ *
+ * \param[in]  t        The times of the lanes
+ * \param[in]  h        A time offset
+ * \param[in]  c        The multiplier of `h`, i.e. the derivative of lane `l` is evaluated at `t[l] + c * h[l]`
+ * \param[in]  pr       The parameters of the lanes
+ * \param[in]  active   The lane mask
+ * \param[in]  y        The lane-wise dependent variables
+ * \param[out] dy       The lane-wise derivatives
+ */
+static void dydt_lanes (const Real* t, const Real* h, const Real c, const Real* pr, const int* active,
+                        const Real* y, Real* dy) {
+#ifdef DYDT_BATCH
+    // the lane-wise arrays are already in the layout of dydt_batch, inactive lanes are evaluated and discarded
+    Real t_l[SIMD_LANES];
+    for (int l = 0; l < SIMD_LANES; ++l) {
+        t_l[l] = t[l] + c * h[l];
+    }
+    PHASE_BEGIN(PHASE_RHS);
+    dydt_batch (SIMD_LANES, t_l, pr, y, dy);
+    PHASE_END(PHASE_RHS);
+    for (int l = 0; l < SIMD_LANES; ++l) {
+        if (!active[l]) {
+            for (int i = 0; i < NSP; ++i) {
+                dy[LANE(i, l)] = ZERO;
+            }
+        }
+    }
+#else
+    Real y_l[NSP];
+    Real dy_l[NSP];
+    for (int l = 0; l < SIMD_LANES; ++l) {
+        if (active[l]) {
+            gather_lane(l, y, y_l);
+            PHASE_BEGIN(PHASE_RHS);
+            dydt (t[l] + c * h[l], pr[l], y_l, dy_l);
+            PHASE_END(PHASE_RHS);
+            scatter_lane(l, dy_l, dy);
+        } else {
+            for (int i = 0; i < NSP; ++i) {
+                dy[LANE(i, l)] = ZERO;
+            }
+        }
+    }
+#endif
+}
+
+/**
+ * \brief Function to take a single RKC integration step with `s` stages in all lanes
+ *
+ * \param[in] t         The starting times of the lanes.
+ * \param[in] pr        The parameters of the lanes.
+ * \param[in] h         The time-step sizes of the lanes, zero for inactive lanes.
+ * \param[in] active    The lane mask
+ * \param[in] y_0       Initial conditions.
+ * \param[in] F_0       Derivative function at initial conditions.
+ * \param[in] s         number of steps.
+ * \param[out] y_j      Integrated variables.
+ *
+ * As opposed to the time step size, the RKC coefficients only depend on the number of stages,
+ * and are hence shared between all lanes.
+ */
+static void rkc_step_lanes (const Real* t, const Real* pr, const Real* h, const int* active,
+                            const Real* y_0, const Real* F_0, const int s, Real* y_j) {
+
+    const Real w0 = ONE + TWO / (13.0 * (Real)(s * s));
+    Real temp1 = (w0 * w0) - ONE;
+    Real temp2 = sqrt(temp1);
+    Real arg = (Real)(s) * log(w0 + temp2);
+    const Real w1 = sinh(arg) * temp1 / (cosh(arg) * (Real)(s) * temp2 - w0 * sinh(arg));
+
+    Real b_jm1 = ONE / (FOUR * (w0 * w0));
+    Real b_jm2 = b_jm1;
+
+    Real y_jm1[NSP * SIMD_LANES];
+    Real y_jm2[NSP * SIMD_LANES];
+
+    // calculate y_1
+    Real mu_t = w1 * b_jm1;
+    for (int i = 0; i < NSP; ++i) {
+        for (int l = 0; l < SIMD_LANES; ++l) {
+            y_jm2[LANE(i, l)] = y_0[LANE(i, l)];
+            y_jm1[LANE(i, l)] = y_0[LANE(i, l)] + (mu_t * h[l] * F_0[LANE(i, l)]);
+        }
+    }
+
+    Real c_jm2 = ZERO;
+    Real c_jm1 = mu_t;
+    Real zjm1 = w0;
+    Real zjm2 = ONE;
+    Real dzjm1 = ONE;
+    Real dzjm2 = ZERO;
+    Real d2zjm1 = ZERO;
+    Real d2zjm2 = ZERO;
+
+    for (int j = 2; j <= s; ++j) {
+
+        Real zj = TWO * w0 * zjm1 - zjm2;
+        Real dzj = TWO * w0 * dzjm1 - dzjm2 + TWO * zjm1;
+        Real d2zj = TWO * w0 * d2zjm1 - d2zjm2 + FOUR * dzjm1;
+        Real b_j = d2zj / (dzj * dzj);
+        Real gamma_t = ONE - (zjm1 * b_jm1);
+
+        Real nu = -b_j / b_jm2;
+        Real mu = TWO * b_j * w0 / b_jm1;
+        mu_t = mu * w1 / w0;
+
+        // calculate derivative, use y array for temporary storage
+        dydt_lanes (t, h, c_jm1, pr, active, y_jm1, y_j);
+
+        for (int i = 0; i < NSP; ++i) {
+            for (int l = 0; l < SIMD_LANES; ++l) {
+                y_j[LANE(i, l)] = (ONE - mu - nu) * y_0[LANE(i, l)] + (mu * y_jm1[LANE(i, l)])
+                                + (nu * y_jm2[LANE(i, l)])
+                                + h[l] * mu_t * (y_j[LANE(i, l)] - (gamma_t * F_0[LANE(i, l)]));
+            }
+        }
+        Real c_j = (mu * c_jm1) + (nu * c_jm2) + mu_t * (ONE - gamma_t);
+
+        if (j < s) {
+            for (int i = 0; i < NSP * SIMD_LANES; ++i) {
+                y_jm2[i] = y_jm1[i];
+                y_jm1[i] = y_j[i];
+            }
+        }
+
+        c_jm2 = c_jm1;
+        c_jm1 = c_j;
+        b_jm2 = b_jm1;
+        b_jm1 = b_j;
+        zjm2 = zjm1;
+        zjm1 = zj;
+        dzjm2 = dzjm1;
+        dzjm1 = dzj;
+        d2zjm2 = d2zjm1;
+        d2zjm1 = d2zj;
+    }
+
+} // rkc_step_lanes
+
+/////////////////////////////////////////////////////////////
+
+/**
+ * \brief Lockstep driver function for the RKC integrator.
+ *
+ * \param[in] t_start       The starting time.
+ * \param[in] tEnd          The desired end time.
+ * \param[in] num_lanes     The number of IVPs in this group (<= #SIMD_LANES), the remaining lanes are ignored
+ * \param[in] pr            The parameters of the lanes
+ * \param[in,out] y         Lane-wise dependent variable array, integrated values replace initial conditions.
+ * \param[out] result       The return codes of the lanes
+ *
+ * Mirrors integrate(), with all per-IVP scalars replaced by per-lane arrays.
+ * The tolerances of each lane are read from #current_lane_tolerances.  If the solver keeps warm start
+ * memory, each lane continues from (and updates) that of #current_lane_warm_start as integrate() does.
+ * The return code of each lane is that integrate() would return for its IVP.
+ */
+void integrate_lanes (const Real t_start, const Real tEnd, const int num_lanes, const Real* pr,
+                      Real* y, int* result) {
+
+    const ivp_tolerances* tol = current_lane_tolerances;
+    int m_max[SIMD_LANES];
+    for (int l = 0; l < SIMD_LANES; ++l) {
+        m_max[l] = (int)(round(sqrt(tol[l].rtol / (10.0 * UROUND))));
+        if (m_max[l] < 2) {
+            m_max[l] = 2;
+        }
+    }
+
+    const Real hmax = fabs(tEnd - t_start);
+
+    int active[SIMD_LANES];
+    int nstep[SIMD_LANES];
+    Real t[SIMD_LANES];
+    // previous error, previous step size, step size and spectral radius
+    Real err_old[SIMD_LANES];
+    Real h_old[SIMD_LANES];
+    Real h[SIMD_LANES];
+    Real rad[SIMD_LANES];
+    Real hmin[SIMD_LANES];
+    // the step size of each lane in the current step, zero if inactive
+    Real h_step[SIMD_LANES];
+    Real err[SIMD_LANES];
+    // the return code of each lane (as integrate(), the RKC method itself does not fail)
+    int code[SIMD_LANES];
+    for (int l = 0; l < SIMD_LANES; ++l) {
+        active[l] = l < num_lanes;
+        code[l] = EC_success;
+        nstep[l] = 0;
+        t[l] = t_start;
+        err_old[l] = ZERO;
+        h_old[l] = ZERO;
+        h[l] = ZERO;
+        rad[l] = ZERO;
+        hmin[l] = TEN * UROUND * fmax(fabs(t_start), hmax);
+    }
+
+#ifdef SOLVER_WARM_START
+    // continue from the step size, error history, spectral radius and eigenvector of the previous call
+    warm_start_memory* ws[SIMD_LANES];
+    for (int l = 0; l < SIMD_LANES; ++l) {
+        ws[l] = l < num_lanes ? current_lane_warm_start[l] : NULL;
+        if (ws[l] == NULL) {
+            continue;
+        }
+        if (!ws[l]->valid) {
+            memset(ws[l]->work, 0, (4 + NSP) * sizeof(Real));
+            ws[l]->rad_age = 0;
+        }
+        err_old[l] = ws[l]->work[0];
+        h_old[l] = ws[l]->work[1];
+        h[l] = ws[l]->work[2];
+        rad[l] = ws[l]->work[3];
+        nstep[l] = ws[l]->rad_age;
+    }
+#endif
+
+    // the unused lanes repeat the first lane, such that a batched dydt evaluates a valid state
+    Real y_n[NSP * SIMD_LANES];
+    for (int i = 0; i < NSP; ++i) {
+        for (int l = 0; l < SIMD_LANES; ++l) {
+            y_n[LANE(i, l)] = y[LANE(i, active[l] ? l : 0)];
+        }
+    }
+
+    // calculate F_n for initial y
+    Real F_n[NSP * SIMD_LANES];
+    for (int l = 0; l < SIMD_LANES; ++l) {
+        h_step[l] = ZERO;
+    }
+    dydt_lanes (t, h_step, ZERO, pr, active, y_n, F_n);
+
+    // load initial estimate for eigenvector
+    Real v[NSP * SIMD_LANES];
+    for (int i = 0; i < NSP; ++i) {
+        for (int l = 0; l < SIMD_LANES; ++l) {
+#ifdef SOLVER_WARM_START
+            if (ws[l] != NULL && h[l] >= UROUND) {
+                v[LANE(i, l)] = ws[l]->work[4 + i];
+                continue;
+            }
+#endif
+            v[LANE(i, l)] = F_n[LANE(i, l)];
+        }
+    }
+
+    Real temp_arr[NSP * SIMD_LANES];
+    Real y_l[NSP];
+    Real F_l[NSP];
+
+    int num_active = num_lanes;
+    while (num_active > 0) {
+
+        // estimate Jacobian spectral radius
+        // only if RKC_SPEC_RAD_INTERVAL steps passed
+        for (int l = 0; l < SIMD_LANES; ++l) {
+            if (active[l] && (nstep[l] % RKC_SPEC_RAD_INTERVAL) == 0) {
+                rad[l] = spec_rad_lane (l, t[l], pr[l], hmax, y_n, F_n, v);
+                STAT_LANE_INC(l, STAT_JAC_EVALS);
+            }
+        }
+
+        // first step, estimate step size
+        for (int l = 0; l < SIMD_LANES; ++l) {
+            if (!active[l] || h[l] >= UROUND) {
+                continue;
+            }
+            h[l] = hmax;
+            if ((rad[l] * h[l]) > ONE) {
+                h[l] = ONE / rad[l];
+            }
+            h[l] = fmax(h[l], hmin[l]);
+
+            for (int i = 0; i < NSP; ++i) {
+                y_l[i] = y_n[LANE(i, l)] + (h[l] * F_n[LANE(i, l)]);
+            }
+            PHASE_BEGIN(PHASE_RHS);
+            dydt (t[l] + h[l], pr[l], y_l, F_l);
+            PHASE_END(PHASE_RHS);
+
+            Real err_l = ZERO;
+            for (int i = 0; i < NSP; ++i) {
+                Real est = (F_l[i] - F_n[LANE(i, l)]) / (tol[l].atol[i] + tol[l].rtol * fabs(y_n[LANE(i, l)]));
+                err_l += est * est;
+            }
+            err_l = h[l] * sqrt(err_l / NSP);
+
+            if ((P1 * h[l]) < (hmax * sqrt(err_l))) {
+                h[l] = fmax(P1 * h[l] / sqrt(err_l), hmin[l]);
+            } else {
+                h[l] = hmax;
+            }
+        }
+
+        // calculate number of steps, shared by all lanes
+        int s = 2;
+        for (int l = 0; l < SIMD_LANES; ++l) {
+            if (!active[l]) {
+                h_step[l] = ZERO;
+                continue;
+            }
+            // check if last step
+            if ((ONEP1 * h[l]) >= fabs(tEnd - t[l])) {
+                h[l] = fabs(tEnd - t[l]);
+            }
+
+            int m = 1 + (int)(sqrt(ONEP54 * h[l] * rad[l] + ONE));
+
+            if (m > m_max[l]) {
+                m = m_max[l];
+                h[l] = (Real)(m * m - 1) / (ONEP54 * rad[l]);
+            }
+            s = m > s ? m : s;
+
+            hmin[l] = TEN * UROUND * fmax(fabs(t[l]), fabs(t[l] + h[l]));
+            h_step[l] = h[l];
+        }
+
+        // perform tentative time step
+        rkc_step_lanes (t, pr, h_step, active, y_n, F_n, s, y);
+
+        // calculate F_np1 with tenative y_np1
+        dydt_lanes (t, h_step, ONE, pr, active, y, temp_arr);
+
+        // estimate error
+        for (int l = 0; l < SIMD_LANES; ++l) {
+            err[l] = ZERO;
+        }
+        for (int i = 0; i < NSP; ++i) {
+            for (int l = 0; l < SIMD_LANES; ++l) {
+                Real est = P8 * (y_n[LANE(i, l)] - y[LANE(i, l)])
+                         + P4 * h_step[l] * (F_n[LANE(i, l)] + temp_arr[LANE(i, l)]);
+                est /= (tol[l].atol[i] + tol[l].rtol * fmax(fabs(y[LANE(i, l)]), fabs(y_n[LANE(i, l)])));
+                err[l] += est * est;
+            }
+        }
+        for (int l = 0; l < SIMD_LANES; ++l) {
+            err[l] = sqrt(err[l] / ((Real)NSP));
+        }
+
+        // masked step acceptance
+        for (int l = 0; l < SIMD_LANES; ++l) {
+            if (!active[l]) {
+                continue;
+            }
+            if (err[l] > ONE) {
+                // error too large, step is rejected
+
+                // select smaller step size
+                h[l] = P8 * h[l] / (pow(err[l], ONE3RD));
+
+                // reevaluate spectral radius
+                rad[l] = spec_rad_lane (l, t[l], pr[l], hmax, y_n, F_n, v);
+                STAT_LANE_INC(l, STAT_REJECTED);
+                STAT_LANE_INC(l, STAT_JAC_EVALS);
+            } else {
+                // step accepted
+                t[l] += h[l];
+                nstep[l]++;
+                STAT_LANE_INC(l, STAT_STEPS);
+
+                Real fac = TEN;
+                Real temp1, temp2;
+
+                if (h_old[l] < UROUND) {
+                    temp2 = pow(err[l], ONE3RD);
+                    if (P8 < (fac * temp2)) {
+                        fac = P8 / temp2;
+                    }
+                } else {
+                    temp1 = P8 * h[l] * pow(err_old[l], ONE3RD);
+                    temp2 = h_old[l] * pow(err[l], TWO3RD);
+                    if (temp1 < (fac * temp2)) {
+                        fac = temp1 / temp2;
+                    }
+                }
+
+                // set "old" values to those for current time step
+                err_old[l] = err[l];
+                h_old[l] = h[l];
+
+                for (int i = 0; i < NSP; ++i) {
+                    y_n[LANE(i, l)] = y[LANE(i, l)];
+                    F_n[LANE(i, l)] = temp_arr[LANE(i, l)];
+                }
+
+                // store next time step
+                h[l] *= fmax(P1, fac);
+                h[l] = fmax(hmin[l], fmin(hmax, h[l]));
+
+                if (!(t[l] < tEnd)) {
+                    active[l] = 0;
+                    num_active--;
+                }
+            }
+        }
+
+    }
+
+    // the last accepted state of each lane
+    for (int i = 0; i < NSP; ++i) {
+        for (int l = 0; l < num_lanes; ++l) {
+            y[LANE(i, l)] = y_n[LANE(i, l)];
+        }
+    }
+    for (int l = 0; l < num_lanes; ++l) {
+        result[l] = code[l];
+#ifdef SOLVER_WARM_START
+        if (ws[l] == NULL) {
+            continue;
+        }
+        ws[l]->work[0] = err_old[l];
+        ws[l]->work[1] = h_old[l];
+        ws[l]->work[2] = h[l];
+        ws[l]->work[3] = rad[l];
+        for (int i = 0; i < NSP; ++i) {
+            ws[l]->work[4 + i] = v[LANE(i, l)];
+        }
+        ws[l]->rad_age = nstep[l] % RKC_SPEC_RAD_INTERVAL;
+        ws[l]->valid = code[l] == EC_success;
+#endif
+    }
+
+} // integrate_lanes
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -9,14 +9,20 @@
 #define RKC_PROPS_CUH
 
 #include "header.cuh"
+#include "solver_stats.cuh"
+#include "phase_profile.cuh"
+#include "tolerances.cuh"
+#include "warp_ivp.cuh"
 #include <stdio.h>
 
 #ifdef GENERATE_DOCS
 namespace rkc_cu {
 #endif
 
-/** Set double precision */
+#ifndef RKC_SINGLE
+/** Set double precision (single precision if #RKC_SINGLE, the RHS is still evaluated in double precision) */
 #define DOUBLE
+#endif
 
 #ifdef DOUBLE
     #define Real double
@@ -57,7 +63,18 @@ namespace rkc_cu {
     #define P01 0.01f
     #define ONE3RD (1.0f / 3.0f)
     #define TWO3RD (2.0f / 3.0f)
-    #define UROUND (2.22e-16)
+    #define UROUND (1.19e-7)
+#endif
+
+//! The number of accepted steps after which the spectral radius is re-estimated (it is also re-estimated after each rejected step)
+#define RKC_SPEC_RAD_INTERVAL (25)
+
+#if defined(WARM_START)
+//! The RKC solver continues from the step size and spectral radius estimate and error history of the previous kernel call
+#define SOLVER_WARM_START
+//! The number of warm start entries per IVP: the RKC work array, i.e. the last error, last and next step size, spectral radius and its eigenvector,
+//! followed by the number of accepted steps (modulo #RKC_SPEC_RAD_INTERVAL) since the spectral radius was estimated
+#define WARM_SIZE (5 + NSP)
 #endif
 
 //! Memory required for Radau-IIa GPU solver
@@ -65,6 +82,8 @@ struct solver_memory
 {
     //! Initial state vectors
     Real* y_n;
+    //! The (#TOL_SIZE) integration tolerances, shared by all threads @see tolerances.cuh
+    double* tol;
     //! The derivative vectors
     Real* F_n;
     //! The a work vector
@@ -77,8 +96,28 @@ struct solver_memory
     Real* y_jm1;
     //! The a work vector
     Real* y_jm2;
+#ifdef RKC_SINGLE
+    //! The tentative state vectors
+    Real* y_np1;
+    //! The (double precision) state vectors the derivative function is evaluated at
+    double* y_rhs;
+    //! The (double precision) derivative vectors
+    double* dy_rhs;
+#endif
     //! array of return codes @see RKCCU_ErrCodes
     int* result;
+#ifdef STATISTICS
+    //! per-IVP integrator statistics, stored as `stats[INDEX(stat)]` @see StatisticIndex
+    int* stats;
+#endif
+#ifdef PROFILE_PHASES
+    //! per-thread phase counters, stored as `phases[INDEX(phase)]` (cycles) and `phases[INDEX(NUM_PHASES + phase)]` (calls) @see PhaseIndex
+    long long* phases;
+#endif
+#ifdef SOLVER_WARM_START
+    //! per-IVP warm start state kept between kernel calls, stored as `warm[INDEX(k)]` @see warm_start.cuh
+    double* warm;
+#endif
 };
 
 /**
@@ -1,10 +1,20 @@
 #ifndef RKC_PROPS_H
 #define RKC_PROPS_H
 
+#include "header.h"
+#include "solver_options.h"
 #include <stdio.h>
+#include <stdbool.h>
 
-/** Set double precision */
+#ifndef RKC_SINGLE
+/** Set double precision (single precision if #RKC_SINGLE, the RHS is still evaluated in double precision) */
 #define DOUBLE
+#endif
+
+#ifndef RKC_SINGLE
+/** RKC implements integrate_lanes, used by the CPU driver if SIMD_LANES is defined */
+#define LANE_INTEGRATOR
+#endif
 
 #ifdef GENERATE_DOCS
 namespace radau2a {
@@ -49,7 +59,29 @@ namespace radau2a {
 	#define P01 0.01f
 	#define ONE3RD (1.0f / 3.0f)
 	#define TWO3RD (2.0f / 3.0f)
-	#define UROUND (2.22e-16)
+	#define UROUND (1.19e-7)
+#endif
+
+//! The number of accepted steps after which the spectral radius is re-estimated (it is also re-estimated after each rejected step)
+#define RKC_SPEC_RAD_INTERVAL (25)
+
+#if defined(WARM_START) && !defined(HYBRID_MILD)
+//! The RKC solver continues from the step size, error history and spectral radius estimate of the previous call, @see warm_start_memory
+//! (not if linked into a stiff integrator for the hybrid dispatch, @see hybrid.h)
+#define SOLVER_WARM_START
+
+/**
+ * \brief The per-IVP state of the RKC solver kept between calls to integrate() (or integrate_lanes())
+ */
+typedef struct
+{
+    //! true if this struct holds the state at the end of a successful integrate() call
+    bool valid;
+    //! the RKC work array, i.e. the last error, last and next step size, spectral radius and its eigenvector
+    Real work[4 + NSP];
+    //! the number of accepted steps (modulo #RKC_SPEC_RAD_INTERVAL) since the spectral radius was estimated
+    int rad_age;
+} warm_start_memory;
 #endif
 
 /**
@@ -0,0 +1,433 @@
+/**
+ * \file
+ * \brief The warp-per-IVP implementation of the RKC GPU solver, @see warp_ivp.cuh
+ *
+ * The same algorithm as rkc.cu, with each IVP integrated by a group of #WARP_IVP_SIZE threads.  The vector
+ * operations are distributed over the lanes of the group, and the scalars (the step size, the error history and
+ * the spectral radius) are kept in registers, computed identically by every lane.
+ */
+
+#include "rkc.cuh"
+#include "dydt.cuh"
+
+#ifdef GENERATE_DOCS
+namespace rkc_cu {
+#endif
+
+#ifdef WARP_IVP
+
+#ifdef STATISTICS
+    //! Increments the statistic `stat` of this IVP (once per group)
+    #define WARP_STAT_INC(solver, stat) if (IVP_LANE == 0) (solver)->stats[IVP_INDEX(stat)] += 1
+    //! Zeros the statistics of this IVP
+    #define WARP_STAT_RESET(solver) if (IVP_LANE == 0) for (int stat_i = 0; stat_i < NUM_STATS; ++stat_i) (solver)->stats[IVP_INDEX(stat_i)] = 0
+#else
+    #define WARP_STAT_INC(solver, stat)
+    #define WARP_STAT_RESET(solver)
+#endif
+
+#ifdef PROFILE_PHASES
+    //! Starts the phase `phase` of this IVP (once per group)
+    #define WARP_PHASE_BEGIN(solver, phase) if (IVP_LANE == 0) (solver)->phases[IVP_INDEX(phase)] -= clock64()
+    //! Ends the phase `phase` of this IVP, and counts the call
+    #define WARP_PHASE_END(solver, phase) if (IVP_LANE == 0) { (solver)->phases[IVP_INDEX(phase)] += clock64(); \
+                                                               (solver)->phases[IVP_INDEX(NUM_PHASES + (phase))] += 1; }
+#else
+    #define WARP_PHASE_BEGIN(solver, phase)
+    #define WARP_PHASE_END(solver, phase)
+#endif
+
+/**
+ * \brief Evaluates the right hand side of the (contiguous) state vector `y` of this IVP with the lanes of its group
+ *
+ * The entries of `y` written by the other lanes are visible to the mechanism, and the entries of `dy` to all lanes
+ * after the call.
+ */
+__device__ __forceinline__
+void warp_rhs (const Real t, const Real pr, const Real* __restrict__ y, Real* __restrict__ dy,
+               mechanism_memory const * const __restrict__ mech,
+               solver_memory const * const __restrict__ solver) {
+    ivp_sync();
+    WARP_PHASE_BEGIN(solver, PHASE_RHS);
+    dydt_warp (t, pr, y, dy, IVP_LANE, mech);
+    ivp_sync();
+    WARP_PHASE_END(solver, PHASE_RHS);
+}
+
+/////////////////////////////////////////////////////////
+
+/**
+ * \brief Estimates the spectral radius by the nonlinear power method, @see rkc_spec_rad of rkc.cu
+ *
+ * The norms are shuffle reductions over the group, which (by the symmetric butterfly) are identical in every lane.
+ */
+__device__
+Real warp_spec_rad (const Real t, const Real pr, const Real hmax, const Real* __restrict__ y,
+                    const Real* __restrict__ F, Real* __restrict__ v, Real* __restrict__ Fv,
+                    mechanism_memory const * const __restrict__ mech,
+                    solver_memory const * const __restrict__ solver) {
+
+    const int itmax = 50;
+    Real small = ONE / hmax;
+
+    Real nrm1 = ZERO;
+    Real nrm2 = ZERO;
+    IVP_FOR(i) {
+        nrm1 += (y[i] * y[i]);
+        nrm2 += (v[i] * v[i]);
+    }
+    nrm1 = sqrt(ivp_sum(nrm1));
+    nrm2 = sqrt(ivp_sum(nrm2));
+
+    Real dynrm;
+    if ((nrm1 != ZERO) && (nrm2 != ZERO)) {
+        dynrm = nrm1 * sqrt(UROUND);
+        IVP_FOR(i) {
+            v[i] = y[i] + v[i] * (dynrm / nrm2);
+        }
+    } else if (nrm1 != ZERO) {
+        dynrm = nrm1 * sqrt(UROUND);
+        IVP_FOR(i) {
+            v[i] = y[i] * (ONE + sqrt(UROUND));
+        }
+    } else if (nrm2 != ZERO) {
+        dynrm = UROUND;
+        IVP_FOR(i) {
+            v[i] *= (dynrm / nrm2);
+        }
+    } else {
+        dynrm = UROUND;
+        IVP_FOR(i) {
+            v[i] = UROUND;
+        }
+    }
+
+    // now iterate using nonlinear power method
+    Real sigma = ZERO;
+    for (int iter = 1; iter <= itmax; ++iter) {
+
+        warp_rhs (t, pr, v, Fv, mech, solver);
+
+        nrm1 = ZERO;
+        IVP_FOR(i) {
+            nrm1 += ((Fv[i] - F[i]) * (Fv[i] - F[i]));
+        }
+        nrm1 = sqrt(ivp_sum(nrm1));
+        nrm2 = sigma;
+        sigma = nrm1 / dynrm;
+
+        nrm2 = fabs(sigma - nrm2) / sigma;
+        if ((iter >= 2) && (fabs(sigma - nrm2) <= (fmax(sigma, small) * P01))) {
+            IVP_FOR(i) {
+                v[i] -= y[i];
+            }
+            return (ONEP2 * sigma);
+        }
+
+        if (nrm1 != ZERO) {
+            IVP_FOR(i) {
+                v[i] = y[i] + ((Fv[i] - F[i]) * (dynrm / nrm1));
+            }
+        } else {
+            int ind = (iter % NSP);
+            if ((ind % WARP_IVP_SIZE) == IVP_LANE) {
+                v[ind] = y[ind] - (v[ind] - y[ind]);
+            }
+        }
+    }
+    return (ONEP2 * sigma);
+}
+
+///////////////////////////////////////////////////////
+
+/**
+ * \brief Takes a single RKC step of `s` stages, @see rkc_step of rkc.cu
+ */
+__device__
+void warp_step (const Real t, const Real pr, const Real h, const Real* __restrict__ y_0,
+                const Real* __restrict__ F_0, const int s, Real* __restrict__ y_j,
+                Real* __restrict__ y_jm1, Real* __restrict__ y_jm2,
+                mechanism_memory const * const __restrict__ mech,
+                solver_memory const * const __restrict__ solver) {
+
+    const Real w0 = ONE + TWO / (13.0 * (Real)(s * s));
+    Real temp1 = (w0 * w0) - ONE;
+    Real temp2 = sqrt(temp1);
+    const Real arg = (Real)(s) * log(w0 + temp2);
+    const Real w1 = sinh(arg) * temp1 / (cosh(arg) * (Real)(s) * temp2 - w0 * sinh(arg));
+
+    Real b_jm1 = ONE / (FOUR * (w0 * w0));
+    Real b_jm2 = b_jm1;
+
+    // calculate y_1
+    Real mu_t = w1 * b_jm1;
+    IVP_FOR(i) {
+        y_jm2[i] = y_0[i];
+        y_jm1[i] = y_0[i] + (mu_t * h * F_0[i]);
+    }
+
+    Real c_jm2 = ZERO;
+    Real c_jm1 = mu_t;
+    Real zjm1 = w0;
+    Real zjm2 = ONE;
+    Real dzjm1 = ONE;
+    Real dzjm2 = ZERO;
+    Real d2zjm1 = ZERO;
+    Real d2zjm2 = ZERO;
+
+    for (int j = 2; j <= s; ++j) {
+
+        Real zj = TWO * w0 * zjm1 - zjm2;
+        Real dzj = TWO * w0 * dzjm1 - dzjm2 + TWO * zjm1;
+        Real d2zj = TWO * w0 * d2zjm1 - d2zjm2 + FOUR * dzjm1;
+        Real b_j = d2zj / (dzj * dzj);
+        Real gamma_t = ONE - (zjm1 * b_jm1);
+
+        Real nu = -b_j / b_jm2;
+        Real mu = TWO * b_j * w0 / b_jm1;
+        mu_t = mu * w1 / w0;
+
+        // calculate derivative, use y array for temporary storage
+        warp_rhs (t + (h * c_jm1), pr, y_jm1, y_j, mech, solver);
+
+        IVP_FOR(i) {
+            y_j[i] = (ONE - mu - nu) * y_0[i] + (mu * y_jm1[i]) + (nu * y_jm2[i])
+                 + h * mu_t * (y_j[i] - (gamma_t * F_0[i]));
+        }
+        Real c_j = (mu * c_jm1) + (nu * c_jm2) + mu_t * (ONE - gamma_t);
+
+        if (j < s) {
+            IVP_FOR(i) {
+                y_jm2[i] = y_jm1[i];
+                y_jm1[i] = y_j[i];
+            }
+        }
+
+        c_jm2 = c_jm1;
+        c_jm1 = c_j;
+        b_jm2 = b_jm1;
+        b_jm1 = b_j;
+        zjm2 = zjm1;
+        zjm1 = zj;
+        dzjm2 = dzjm1;
+        dzjm1 = dzj;
+        d2zjm2 = d2zjm1;
+        d2zjm1 = d2zj;
+    }
+
+} // warp_step
+
+/////////////////////////////////////////////////////////////
+
+/**
+ * \brief Driver function for the RKC integrator, called by all lanes of the group of an IVP
+ *
+ * \param[in]       tstart      the starting time.
+ * \param[in]       tEnd        the desired end time.
+ * \param[in]       pr          A parameter used for pressure or density to pass to the derivative function.
+ * \param[in,out]   y           The (column-major, #IVP_INDEX) state vectors, integrated values replace initial conditions.
+ * \param[in]       mech        The mechanism_memory struct that contains the pre-allocated memory for the RHS evaluation
+ * \param[in]       solver      The solver_memory struct, whose vectors hold the contiguous (#IVP_VEC) vectors of each IVP
+ */
+__device__ void integrate (const Real tstart,
+                           const Real tEnd,
+                           const Real pr,
+                           Real *y,
+                           mechanism_memory const * const __restrict__ mech,
+                           solver_memory const * const __restrict__ solver) {
+
+    Real t = tstart;
+    double const * const __restrict__ tol = solver->tol;
+    int mMax = (int)(round(sqrt(TOL_RTOL(tol) / (10.0 * UROUND))));
+
+    if (mMax < 2) {
+        mMax = 2;
+    }
+
+    // the contiguous vectors of this IVP
+    Real * const __restrict__ y_n = &solver->y_n[IVP_VEC(NSP, 0)];
+    Real * const __restrict__ F_n = &solver->F_n[IVP_VEC(NSP, 0)];
+    Real * const __restrict__ temp_arr = &solver->temp_arr[IVP_VEC(NSP, 0)];
+    Real * const __restrict__ y_j = &solver->temp_arr2[IVP_VEC(NSP, 0)];
+    Real * const __restrict__ y_jm1 = &solver->y_jm1[IVP_VEC(NSP, 0)];
+    Real * const __restrict__ y_jm2 = &solver->y_jm2[IVP_VEC(NSP, 0)];
+    // the work array holds the spectral radius eigenvector after its four scalars
+    Real * const __restrict__ eigvec = &solver->work[IVP_VEC(NSP + 4, 4)];
+
+    IVP_FOR(i) {
+        y_n[i] = y[IVP_INDEX(i)];
+    }
+
+    // calculate F_n for initial y
+    warp_rhs (t, pr, y_n, F_n, mech, solver);
+    WARP_STAT_RESET(solver);
+
+    // the last error, the last and next step size, and the spectral radius
+    Real err_old, h_old, h, spec_rad;
+#ifdef SOLVER_WARM_START
+    // continue from the step size, error history, spectral radius and eigenvector of the previous kernel call,
+    // @see rkc.cu
+    double * const __restrict__ warm = solver->warm;
+    err_old = warm[IVP_INDEX(0)];
+    h_old = warm[IVP_INDEX(1)];
+    h = warm[IVP_INDEX(2)];
+    spec_rad = warm[IVP_INDEX(3)];
+    IVP_FOR(i) {
+        eigvec[i] = warm[IVP_INDEX(4 + i)];
+    }
+    int nstep = (int)warm[IVP_INDEX(4 + NSP)];
+#else
+    err_old = ZERO;
+    h_old = ZERO;
+    h = ZERO;
+    spec_rad = ZERO;
+    int nstep = 0;
+#endif
+    if (h < UROUND) {
+        IVP_FOR(i) {
+            eigvec[i] = F_n[i];
+        }
+    }
+
+    const Real stepSizeMax = fabs(tEnd - t);
+    Real stepSizeMin = TEN * UROUND * fmax(fabs(t), stepSizeMax);
+
+    while (t < tEnd) {
+        Real err;
+
+        // estimate Jacobian spectral radius
+        // only if RKC_SPEC_RAD_INTERVAL steps passed
+        if ((nstep % RKC_SPEC_RAD_INTERVAL) == 0) {
+            spec_rad = warp_spec_rad (t, pr, stepSizeMax, y_n, F_n, eigvec, temp_arr, mech, solver);
+            WARP_STAT_INC(solver, STAT_JAC_EVALS);
+        }
+
+        if (h < UROUND) {
+            // estimate first time step
+            h = stepSizeMax;
+            if ((spec_rad * h) > ONE) {
+                h = ONE / spec_rad;
+            }
+            h = fmax(h, stepSizeMin);
+
+            IVP_FOR(i) {
+                y_j[i] = y_n[i] + (h * F_n[i]);
+            }
+            warp_rhs (t + h, pr, y_j, temp_arr, mech, solver);
+
+            err = ZERO;
+            IVP_FOR(i) {
+                Real est = (temp_arr[i] - F_n[i]) / (TOL_ATOL(tol, i) + TOL_RTOL(tol) * fabs(y_n[i]));
+                err += est * est;
+            }
+            err = h * sqrt(ivp_sum(err) / NSP);
+
+            if ((P1 * h) < (stepSizeMax * sqrt(err))) {
+                h = fmax(P1 * h / sqrt(err), stepSizeMin);
+            } else {
+                h = stepSizeMax;
+            }
+        }
+
+        // check if last step
+        if ((ONEP1 * h) >= fabs(tEnd - t)) {
+            h = fabs(tEnd - t);
+        }
+
+        // calculate number of steps
+        int m = 1 + (int)(sqrt(ONEP54 * h * spec_rad + ONE));
+
+        if (m > mMax) {
+            m = mMax;
+            h = ((Real)(m * m - 1)) / (ONEP54 * spec_rad);
+        }
+
+        // perform tentative time step
+        warp_step (t, pr, h, y_n, F_n, m, y_j, y_jm1, y_jm2, mech, solver);
+
+        // calculate F_np1 with tenative y_np1
+        warp_rhs (t + h, pr, y_j, temp_arr, mech, solver);
+
+        // estimate error
+        err = ZERO;
+        IVP_FOR(i) {
+            Real est = P8 * (y_n[i] - y_j[i]) + P4 * h * (F_n[i] + temp_arr[i]);
+            est /= (TOL_ATOL(tol, i) + TOL_RTOL(tol) * fmax(fabs(y_j[i]), fabs(y_n[i])));
+            err += est * est;
+        }
+        err = sqrt(ivp_sum(err) / ((Real)NSP));
+
+        if (err > ONE) {
+            // error too large, step is rejected
+
+            // select smaller step size
+            h = P8 * h / (pow(err, ONE3RD));
+
+            // reevaluate spectral radius
+            spec_rad = warp_spec_rad (t, pr, stepSizeMax, y_n, F_n, eigvec, temp_arr, mech, solver);
+            WARP_STAT_INC(solver, STAT_REJECTED);
+            WARP_STAT_INC(solver, STAT_JAC_EVALS);
+        } else {
+            // step accepted
+            t += h;
+            nstep++;
+            WARP_STAT_INC(solver, STAT_STEPS);
+
+            Real fac = TEN;
+            Real temp1, temp2;
+
+            if (h_old < UROUND) {
+                temp2 = pow(err, ONE3RD);
+                if (P8 < (fac * temp2)) {
+                    fac = P8 / temp2;
+                }
+            } else {
+                temp1 = P8 * h * pow(err_old, ONE3RD);
+                temp2 = h_old * pow(err, TWO3RD);
+                if (temp1 < (fac * temp2)) {
+                    fac = temp1 / temp2;
+                }
+            }
+
+            // set "old" values to those for current time step
+            err_old = err;
+            h_old = h;
+
+            IVP_FOR(i) {
+                y_n[i] = y_j[i];
+                F_n[i] = temp_arr[i];
+            }
+
+            h *= fmax(P1, fac);
+            h = fmax(stepSizeMin, fmin(stepSizeMax, h));
+        }
+
+    }
+
+    IVP_FOR(i) {
+        y[IVP_INDEX(i)] = y_n[i];
+    }
+#ifdef SOLVER_WARM_START
+    IVP_FOR(i) {
+        warm[IVP_INDEX(4 + i)] = eigvec[i];
+    }
+    if (IVP_LANE == 0) {
+        warm[IVP_INDEX(0)] = err_old;
+        warm[IVP_INDEX(1)] = h_old;
+        warm[IVP_INDEX(2)] = h;
+        warm[IVP_INDEX(3)] = spec_rad;
+        warm[IVP_INDEX(4 + NSP)] = (double)(nstep % RKC_SPEC_RAD_INTERVAL);
+    }
+#endif
+    if (IVP_LANE == 0) {
+        int * const __restrict__ result = solver->result;
+        result[IVP_ID] = EC_success;
+    }
+
+} // rkc_driver
+
+#endif
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -76,3 +76,87 @@ def formatOption(env, opt):
     lines.append('')
 
     return lines
+
+
+def gpu_device_name(device=0):
+    """
+    Returns the name of the given CUDA device as reported by nvidia-smi,
+    or None if it cannot be queried.
+    """
+    import subprocess
+    try:
+        out = subprocess.check_output(['nvidia-smi', '--query-gpu=name',
+                                       '--format=csv,noheader',
+                                       '-i', str(device)])
+    except (OSError, subprocess.CalledProcessError):
+        return None
+    name = out.decode('utf-8').strip()
+    return name if name else None
+
+
+#: the SCons options selected by launch_tuner.py
+launch_options = ['BLOCK_SIZE', 'CACHE_CONFIG', 'LAUNCH_MIN_BLOCKS']
+
+
+def load_launch_tuning(filename, device=0):
+    """
+    Returns the launch configuration (a dict of the `launch_options`) stored
+    by launch_tuner.py in `filename` for the given CUDA device, or None if
+    the file holds no entry for the device.
+    """
+    import json
+    import os
+    name = gpu_device_name(device)
+    if name is None or not os.path.isfile(filename):
+        return None
+    with open(filename, 'r') as file:
+        cache = json.load(file)
+    if name not in cache:
+        return None
+    return dict((key, cache[name][key]) for key in launch_options)
+
+
+#: the compiler flags of the ISA levels of the ISA_LEVELS option, see isa_dispatch.h
+isa_flags = {'avx2': ['-march=x86-64-v3'],
+             'avx512': ['-march=x86-64-v4', '-mprefer-vector-width=512']}
+
+
+def rename_isa_symbols(target, source, env):
+    """
+    A SCons action linking the objects `source` (compiled for the ISA level
+    `env['ISA_LEVEL']`) into the single relocatable object `target`.  The
+    global functions of the object are suffixed by '_isa_<level>', such
+    that they do not collide with the baseline build, and its global
+    variables are weakened, such that they bind to those of the baseline
+    build.
+    """
+    import os
+    import subprocess
+    level = env['ISA_LEVEL']
+    output = str(target[0])
+    merged = output + '.merged.o'
+    subprocess.check_call([env.subst('$CC'), '-r', '-nostdlib', '-o', merged] +
+                          [str(x) for x in source])
+    symbols = subprocess.check_output(['nm', '-g', '--defined-only', merged])
+    rename = []
+    weaken = []
+    for line in symbols.decode('utf-8').splitlines():
+        fields = line.split()
+        if len(fields) != 3:
+            continue
+        kind, name = fields[1], fields[2]
+        if kind in 'TWi':
+            rename.append('{0} {0}_isa_{1}'.format(name, level))
+        elif kind in 'DBRGSV':
+            weaken.append(name)
+    rename_file = output + '.rename'
+    weaken_file = output + '.weaken'
+    with open(rename_file, 'w') as file:
+        file.write('\n'.join(rename) + '\n')
+    with open(weaken_file, 'w') as file:
+        file.write('\n'.join(weaken) + '\n')
+    subprocess.check_call(['objcopy', '--redefine-syms=' + rename_file,
+                           '--weaken-symbols=' + weaken_file, merged, output])
+    for name in [merged, rename_file, weaken_file]:
+        os.remove(name)
+    return 0
@@ -0,0 +1,443 @@
+/**
+ * \file
+ * \brief Behaviour tests of the CPU drivers and library interface
+ *
+ * Built as the [solver]-driver-tests executables with the DRIVER_TESTS option, and run as
+ * `./rkc-int-driver-tests [num_IVPs] [ic_file]`.  Unlike the kernel checks of unit_tests.c, these drive a solver
+ * instance through the library interface and compare it to the scalar integrator:
+ *  - the state layout: block_states / unblock_states round-trip the column-major state vectors, place
+ *    each entry at its state_index, and pad the last block of #STATE_BLOCK IVPs with its last IVP
+ *  - the drivers: accelerInt_context_integrate of perturbed initial conditions matches integrate() called
+ *    on each IVP in turn, bit for bit for the scalar driver, and within #DRIVER_TESTS_FACTOR of the
+ *    tolerances for the lockstep lanes (#SIMD_LANES) and the hybrid dispatch (#HYBRID)
+ *  - the solver instances: instances of different tolerances integrating concurrently on their own threads
+ *    match integrate() at their tolerances, as above
+ *  - the ISAT table (#ISAT): repeating the call retrieves the IVPs within the ISAT tolerances of integrate(),
+ *    as do queries perturbed inside the EOA of the entries (within #DRIVER_TESTS_ISAT_FACTOR), and once the
+ *    table of #ISAT_MEMORY MB is full the clock hand evicts entries
+ *
+ * Each check prints a line, and the program returns the number of failed checks.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "header.h"
+#include "solver_options.h"
+#include "solver_interface.h"
+#include "tolerances.h"
+#include "warm_start.h"
+#include "hybrid.h"
+#include "isa_dispatch.h"
+#include "read_initial_conditions.h"
+
+#ifdef ISA_DISPATCHED
+    // the integrator of the ISA level chosen by select_isa, as called by the drivers
+    #define integrate (*isa_integrate)
+#endif
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+#ifndef DRIVER_TESTS_FACTOR
+    //! The bound of the error norm (in units of the tolerances) between drivers that legitimately differ from integrate()
+    #define DRIVER_TESTS_FACTOR (10.0)
+#endif
+//! The seed of the perturbations of the initial conditions
+#define DRIVER_TESTS_SEED (0x5eed1234u)
+
+#if (defined(SIMD_LANES) && defined(LANE_INTEGRATOR)) || defined(HYBRID_DISPATCH) || defined(ISAT)
+//! The drivers do not call integrate() on each IVP, and are compared within #DRIVER_TESTS_FACTOR
+#define DRIVER_TESTS_INEXACT
+#endif
+
+/**
+ * \brief Returns the next value in [-1, 1) of the (xorshift) random sequence `state`
+ */
+static inline double driver_tests_rand(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return 2.0 * ((double)x / 4294967296.0) - 1.0;
+}
+
+/**
+ * \brief Prints and counts the result of a check
+ * \return                  1 if the check failed, 0 otherwise
+ */
+static int report(const char* check, const bool passed, const double value)
+{
+    printf("%-40s %s (%.3e)\n", check, passed ? "passed" : "FAILED", value);
+    return passed ? 0 : 1;
+}
+
+/**
+ * \brief Returns the largest difference of the (column-major) state vectors `y` and `y_ref` of NUM IVPs,
+ *        in units of the tolerances `atol` + `rtol` * |y_ref|
+ */
+static double error_norm(const int NUM, const double* y, const double* y_ref, const double atol, const double rtol)
+{
+    double norm = 0;
+    for (int k = 0; k < NUM * NSP; ++k)
+    {
+        const double err = fabs(y[k] - y_ref[k]) / (atol + rtol * fabs(y_ref[k]));
+        // a NaN state fails the check
+        norm = isnan(err) ? INFINITY : fmax(norm, err);
+    }
+    return norm;
+}
+
+/**
+ * \brief Checks the round-trip and the padding of block_states / unblock_states for NUM IVPs
+ * \return                  The number of failed checks
+ */
+static int test_layout(const int NUM, uint32_t* seed)
+{
+    const size_t size = accelerInt_state_size(NUM);
+    double* y = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    double* y_blocked = (double*)malloc(size * sizeof(double));
+    double* y_back = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    for (int k = 0; k < NUM * NSP; ++k)
+        y[k] = driver_tests_rand(seed);
+
+    accelerInt_block_states(NUM, y, y_blocked);
+    int misplaced = 0;
+    for (int tid = 0; tid < NUM; ++tid)
+        for (int i = 0; i < NSP; ++i)
+            misplaced += y_blocked[state_index(tid, i, NUM)] != y[tid + i * NUM];
+#ifdef STATE_BLOCK
+    // the padding of the last block repeats its last IVP
+    const int num_padded = (int)(size / NSP);
+    for (int tid = NUM; tid < num_padded; ++tid)
+        for (int i = 0; i < NSP; ++i)
+            misplaced += y_blocked[state_index(tid, i, NUM)] != y[NUM - 1 + i * NUM];
+#endif
+    accelerInt_unblock_states(NUM, y_blocked, y_back);
+
+    char check[64];
+    sprintf(check, "layout, %d IVPs", NUM);
+    const int failed = report(check, size >= (size_t)NUM * NSP && misplaced == 0 &&
+                                     memcmp(y, y_back, (size_t)NUM * NSP * sizeof(double)) == 0, misplaced);
+    free(y);
+    free(y_blocked);
+    free(y_back);
+    return failed;
+}
+
+/**
+ * \brief Integrates the (column-major) state vectors `y` of NUM IVPs from 0 to #t_step with integrate(),
+ *        one IVP after the other at the tolerances `atol` / `rtol`, as the scalar driver does
+ */
+static void integrate_reference(const int NUM, double* y, const double* var, const double atol, const double rtol)
+{
+    set_tolerances(&current_tolerances, atol, rtol, NULL);
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+    warm_start_storage warm;
+    memset(&warm, 0, sizeof(warm_start_storage));
+    resize_warm_start(&warm, NUM);
+#endif
+    double y_local[NSP];
+    for (int tid = 0; tid < NUM; ++tid)
+    {
+        for (int i = 0; i < NSP; ++i)
+            y_local[i] = y[tid + i * NUM];
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+        current_warm_start = get_warm_start(&warm, tid);
+#endif
+        check_error(tid, integrate(0, t_step, var[tid], y_local));
+        for (int i = 0; i < NSP; ++i)
+            y[tid + i * NUM] = y_local[i];
+    }
+#if defined(WARM_START) && defined(SOLVER_WARM_START)
+    cleanup_warm_start(&warm);
+#endif
+}
+
+/**
+ * \brief Integrates the (column-major) state vectors `y` of NUM IVPs from 0 to #t_step with the drivers of `context`
+ */
+static void integrate_driver(accelerInt_context* context, const int NUM, double* y, const double* var)
+{
+    double* y_host = (double*)malloc(accelerInt_state_size(NUM) * sizeof(double));
+    accelerInt_block_states(NUM, y, y_host);
+    accelerInt_context_integrate(context, NUM, 0, t_step, -1, y_host, var);
+    accelerInt_unblock_states(NUM, y_host, y);
+    free(y_host);
+}
+
+//! The number of solver instances integrating concurrently
+#define DRIVER_TESTS_CONTEXTS (2)
+
+/**
+ * \brief A call of integrate_driver, run on its own thread
+ */
+typedef struct
+{
+    accelerInt_context* context;
+    int NUM;
+    double* y;
+    const double* var;
+} driver_tests_job;
+
+/**
+ * \brief The thread of a driver_tests_job
+ */
+static void* run_job(void* arg)
+{
+    driver_tests_job* job = (driver_tests_job*)arg;
+    integrate_driver(job->context, job->NUM, job->y, job->var);
+    return NULL;
+}
+
+/**
+ * \brief Checks #DRIVER_TESTS_CONTEXTS solver instances of different tolerances integrating the NUM IVPs
+ *        `y_init` concurrently (each on its own thread) against integrate() at the same tolerances
+ * \return                  The number of failed checks
+ */
+static int test_concurrent(const int NUM, const double* y_init, const double* var)
+{
+    accelerInt_context* contexts[DRIVER_TESTS_CONTEXTS];
+    driver_tests_job jobs[DRIVER_TESTS_CONTEXTS];
+    pthread_t threads[DRIVER_TESTS_CONTEXTS];
+    double* y_ref[DRIVER_TESTS_CONTEXTS];
+    double atol[DRIVER_TESTS_CONTEXTS];
+    double rtol[DRIVER_TESTS_CONTEXTS];
+    for (int c = 0; c < DRIVER_TESTS_CONTEXTS; ++c)
+    {
+        // each instance tightens the tolerances of the previous by a factor of 10
+        atol[c] = ATOL * pow(1e-1, c);
+        rtol[c] = RTOL * pow(1e-1, c);
+        y_ref[c] = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+        memcpy(y_ref[c], y_init, (size_t)NUM * NSP * sizeof(double));
+        integrate_reference(NUM, y_ref[c], var, atol[c], rtol[c]);
+
+        contexts[c] = accelerInt_create(1);
+        accelerInt_context_set_tolerances(contexts[c], atol[c], rtol[c], NULL);
+        jobs[c].context = contexts[c];
+        jobs[c].NUM = NUM;
+        jobs[c].y = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+        jobs[c].var = var;
+        memcpy(jobs[c].y, y_init, (size_t)NUM * NSP * sizeof(double));
+    }
+    for (int c = 0; c < DRIVER_TESTS_CONTEXTS; ++c)
+    {
+        if (pthread_create(&threads[c], NULL, run_job, &jobs[c]) != 0)
+        {
+            printf("Error: could not start the thread of solver instance %d\n", c);
+            exit(1);
+        }
+    }
+
+    int failed = 0;
+    for (int c = 0; c < DRIVER_TESTS_CONTEXTS; ++c)
+    {
+        pthread_join(threads[c], NULL);
+        const double norm = error_norm(NUM, jobs[c].y, y_ref[c], atol[c], rtol[c]);
+        char check[64];
+        sprintf(check, "concurrent instance %d vs. integrate()", c);
+#ifdef DRIVER_TESTS_INEXACT
+        failed += report(check, norm <= DRIVER_TESTS_FACTOR, norm);
+#else
+        failed += report(check, memcmp(jobs[c].y, y_ref[c], (size_t)NUM * NSP * sizeof(double)) == 0, norm);
+#endif
+        accelerInt_destroy(contexts[c]);
+        free(jobs[c].y);
+        free(y_ref[c]);
+    }
+    return failed;
+}
+
+#ifdef ISAT
+
+#ifndef DRIVER_TESTS_ISAT_FACTOR
+    //! The bound of the error norm (in units of the ISAT tolerances) of the queries retrieved by the linear approximation
+    #define DRIVER_TESTS_ISAT_FACTOR (2.0)
+#endif
+#ifndef DRIVER_TESTS_ISAT_ROUNDS
+    //! The maximum number of calls of fresh IVPs that fill the table
+    #define DRIVER_TESTS_ISAT_ROUNDS (100)
+#endif
+
+/**
+ * \brief Integrates `y` with the drivers of `context` as integrate_driver, and returns the number of IVPs
+ *        retrieved from its ISAT table
+ * \param[out]      stats       The (#NUM_ISAT_STATS) table statistics after the call
+ */
+static long integrate_isat(accelerInt_context* context, const int NUM, double* y, const double* var, long* stats)
+{
+    long before[NUM_ISAT_STATS];
+    accelerInt_context_get_isat_statistics(context, before);
+    integrate_driver(context, NUM, y, var);
+    accelerInt_context_get_isat_statistics(context, stats);
+    return stats[ISAT_RETRIEVES] - before[ISAT_RETRIEVES];
+}
+
+/**
+ * \brief Checks the retrieval and eviction of the ISAT table of `context`
+ * \param[in]       NUM         The number of IVPs
+ * \param[in]       y_init      The state vectors tabulated by the last call of `context`
+ * \param[in]       var         The parameters
+ * \param[in]       y_ref       The state vectors `y_init` integrated by integrate_reference
+ * \return                      The number of failed checks
+ */
+static int test_isat(accelerInt_context* context, const int NUM, const double* y_init, const double* var,
+                     const double* y_ref, uint32_t* seed)
+{
+    // the retrieval error adds to the integration error of the tabulated entries
+    const double atol = ISAT_ATOL + DRIVER_TESTS_FACTOR * ATOL;
+    const double rtol = ISAT_RTOL + DRIVER_TESTS_FACTOR * RTOL;
+    const double atol_eoa = DRIVER_TESTS_ISAT_FACTOR * ISAT_ATOL + DRIVER_TESTS_FACTOR * ATOL;
+    const double rtol_eoa = DRIVER_TESTS_ISAT_FACTOR * ISAT_RTOL + DRIVER_TESTS_FACTOR * RTOL;
+    double* y = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    double* y_query = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    double* y_query_ref = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    long stats[NUM_ISAT_STATS];
+    int failed = 0;
+
+    // the same queries again, which are retrieved at the tabulated points
+    memcpy(y, y_init, (size_t)NUM * NSP * sizeof(double));
+    long retrieved = integrate_isat(context, NUM, y, var, stats);
+    failed += report("ISAT retrieves", retrieved > 0, retrieved);
+    double norm = error_norm(NUM, y, y_ref, atol, rtol);
+    failed += report("ISAT vs. integrate()", norm <= 1.0, norm);
+
+    // queries near the tabulated points, i.e. inside their EOA, which are retrieved by the linear approximation
+    for (int tid = 0; tid < NUM; ++tid)
+    {
+        const double scale = pow(10.0, -4.5 + 1.5 * driver_tests_rand(seed));
+        for (int i = 0; i < NSP; ++i)
+            y_query[tid + i * NUM] = y_init[tid + i * NUM] * (1.0 + scale * driver_tests_rand(seed));
+    }
+    memcpy(y_query_ref, y_query, (size_t)NUM * NSP * sizeof(double));
+    integrate_reference(NUM, y_query_ref, var, ATOL, RTOL);
+    memcpy(y, y_query, (size_t)NUM * NSP * sizeof(double));
+    retrieved = integrate_isat(context, NUM, y, var, stats);
+    failed += report("ISAT retrieves, perturbed", retrieved > 0, retrieved);
+    norm = error_norm(NUM, y, y_query_ref, atol_eoa, rtol_eoa);
+    failed += report("ISAT vs. integrate(), perturbed", norm <= 1.0, norm);
+
+    // fresh queries, until the table is full and the clock hand evicts entries
+    for (int round = 0; round < DRIVER_TESTS_ISAT_ROUNDS && stats[ISAT_EVICTIONS] == 0; ++round)
+    {
+        for (int k = 0; k < NUM * NSP; ++k)
+            y_query[k] = y_init[k] * (1.0 + 1e-1 * driver_tests_rand(seed));
+        memcpy(y, y_query, (size_t)NUM * NSP * sizeof(double));
+        integrate_isat(context, NUM, y, var, stats);
+    }
+    if (stats[ISAT_EVICTIONS] == 0)
+        printf("%-40s skipped (the table of %d MB is not full)\n", "ISAT evictions", ISAT_MEMORY);
+    else
+    {
+        failed += report("ISAT evictions", stats[ISAT_ENTRIES] == stats[ISAT_ADDS] - stats[ISAT_EVICTIONS],
+                         stats[ISAT_EVICTIONS]);
+        // the last queries were tabulated after the evictions
+        memcpy(y_query_ref, y_query, (size_t)NUM * NSP * sizeof(double));
+        integrate_reference(NUM, y_query_ref, var, ATOL, RTOL);
+        memcpy(y, y_query, (size_t)NUM * NSP * sizeof(double));
+        retrieved = integrate_isat(context, NUM, y, var, stats);
+        failed += report("ISAT retrieves, after evictions", retrieved > 0, retrieved);
+        norm = error_norm(NUM, y, y_query_ref, atol_eoa, rtol_eoa);
+        failed += report("ISAT vs. integrate(), after evictions", norm <= 1.0, norm);
+    }
+
+    free(y);
+    free(y_query);
+    free(y_query_ref);
+    return failed;
+}
+
+#endif
+
+/** Main function
+ *
+ * \param[in]       argc    command line argument count
+ * \param[in]       argv    command line argument vector
+ *
+ * The syntax is as follows:\n
+ * `./solver-name-driver-tests [num_IVPs] [ic_file]`\n
+ * *  num_IVPs     [Optional, Default:37]
+ *      *  The number of IVPs integrated by the driver checks
+ * *  ic_file      [Optional]
+ *      *  The initial condition file the IVPs are perturbed from (its first IVP), if not supplied the
+ *         mechanism's set_same_initial_conditions is used
+ */
+int main (int argc, char *argv[])
+{
+    // not a multiple of the lanes or blocks, such that the padding is exercised
+    int NUM = 37;
+    if (argc > 1)
+    {
+        NUM = atoi(argv[1]);
+        if (NUM < 1)
+        {
+            printf("Error: the number of IVPs must be positive\n");
+            exit(1);
+        }
+    }
+    uint32_t seed = DRIVER_TESTS_SEED;
+    int failed = 0;
+    printf("# %s driver tests, NSP: %d, IVPs: %d\n", solver_name(), NSP, NUM);
+
+    for (int n = 1; n < NUM; n = 2 * n + 1)
+        failed += test_layout(n, &seed);
+    failed += test_layout(NUM, &seed);
+
+    // the IVPs, perturbed from the initial condition
+    double* y_ic;
+    double* var_ic;
+    if (argc > 2)
+        read_initial_conditions(argv[2], 1, &y_ic, &var_ic);
+    else
+        set_same_initial_conditions(1, &y_ic, &var_ic);
+    double* y_init = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    double* var = (double*)malloc(NUM * sizeof(double));
+    for (int tid = 0; tid < NUM; ++tid)
+    {
+        for (int i = 0; i < NSP; ++i)
+            y_init[tid + i * NUM] = y_ic[i] * (1.0 + 1e-2 * driver_tests_rand(&seed));
+        var[tid] = var_ic[0] * (1.0 + 1e-1 * driver_tests_rand(&seed));
+    }
+    free(y_ic);
+    free(var_ic);
+
+    accelerInt_context* context = accelerInt_create(1);
+    double* y_ref = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    double* y = (double*)malloc((size_t)NUM * NSP * sizeof(double));
+    memcpy(y_ref, y_init, (size_t)NUM * NSP * sizeof(double));
+    integrate_reference(NUM, y_ref, var, ATOL, RTOL);
+
+    memcpy(y, y_init, (size_t)NUM * NSP * sizeof(double));
+    integrate_driver(context, NUM, y, var);
+    const double norm = error_norm(NUM, y, y_ref, ATOL, RTOL);
+#ifdef DRIVER_TESTS_INEXACT
+    failed += report("driver vs. integrate()", norm <= DRIVER_TESTS_FACTOR, norm);
+#else
+    failed += report("driver vs. integrate()", memcmp(y, y_ref, (size_t)NUM * NSP * sizeof(double)) == 0, norm);
+#endif
+    failed += test_concurrent(NUM, y_init, var);
+
+#ifdef ISAT
+    failed += test_isat(context, NUM, y_init, var, y_ref, &seed);
+#endif
+
+    accelerInt_destroy(context);
+    free(y_init);
+    free(var);
+    free(y_ref);
+    free(y);
+    printf("# %d failed\n", failed);
+    return failed;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,434 @@
+/**
+ * \file
+ * \brief Microbenchmarks of the numerical kernels of the CPU solvers
+ *
+ * Built as the [solver]-microbench executables with the MICROBENCH option, @see microbench.h
+ *
+ * Times, in isolation and on a single thread, the kernels that dominate the solver profiles:
+ *  - the Hessenberg LU factorization and inversion (getComplexLUHessenberg, getComplexInverseHessenberg)
+ *  - the RHS and Jacobian evaluations (dydt, eval_jacob) and the Jacobian-vector product (sparse_multiplier)
+ *  - the phi-function evaluation and the Arnoldi iteration (phiAc_variable, arnoldi) of the exponential integrators
+ *  - the linear system factorization and solve (RK_Decomp, RK_Solve) of the Radau-IIa integrator
+ *
+ * The Hessenberg and phi-function kernels are run over a range of sizes up to #STRIDE, the other kernels
+ * operate on (NSP x NSP) matricies and are run at the #NSP of the mechanism (the size range of those
+ * kernels is covered by building against different mechanisms).
+ *
+ * The operations are timed in batches of at least #MICROBENCH_MIN_TIME seconds, and the median of
+ * #MICROBENCH_TRIALS batches is reported.  In-place kernels restore their input from one of #MICROBENCH_INPUTS
+ * fixed random inputs before each operation, the time of this copy is measured separately and subtracted.
+ * Cycles are read from the time stamp counter (x86 only).
+ */
+
+//! for clock_gettime(), @see benchmark.h
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <complex.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifdef RADAU2A
+//the Radau-IIa kernels are static, hence the integrator is compiled into this file (in place of radau2a.o)
+#define integrate microbench_radau2a_integrate
+#include "radau2a.c"
+#undef integrate
+#endif
+
+#include "header.h"
+#include "solver_options.h"
+#include "solver_props.h"
+#include "solver_init.h"
+#include "tolerances.h"
+#include "complexInverse.h"
+#include "dydt.h"
+#include "jacob.h"
+#include "sparse_multiplier.h"
+#include "sparse_jacobian.h"
+#include "read_initial_conditions.h"
+#if defined(RB43) || defined(EXP4)
+#include "phiAHessenberg.h"
+#include "jac_operator.h"
+#include "arnoldi.h"
+#endif
+#include "microbench.h"
+
+#ifdef GENERATE_DOCS
+namespace generic {
+#endif
+
+//! An operation of a kernel on input `i` of the kernel data
+typedef void (*microbench_op)(void* data, const int i);
+
+/**
+ * \brief Returns the time stamp counter, or zero if it is unavailable
+ */
+static inline long long microbench_cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (long long)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * \brief Times `reps` operations of `op`, cycling through the inputs
+ * \param[out]      cycles      The elapsed cycles
+ * \return          The elapsed time in seconds
+ */
+static double microbench_batch(microbench_op op, void* data, const long reps, double* cycles)
+{
+    long long c0 = microbench_cycles();
+    double t0 = benchmark_time();
+    for (long r = 0; r < reps; ++r)
+        op(data, (int)(r % MICROBENCH_INPUTS));
+    double t1 = benchmark_time();
+    *cycles = (double)(microbench_cycles() - c0);
+    return t1 - t0;
+}
+
+/**
+ * \brief Measures the median time and cycles per operation of `op`
+ *
+ * The number of operations per batch is doubled until a batch lasts #MICROBENCH_MIN_TIME, which also warms up the caches
+ */
+static void microbench_measure(microbench_op op, void* data, double* ns_per_op, double* cycles_per_op)
+{
+    long reps = 1;
+    double cycles = 0;
+    while (microbench_batch(op, data, reps, &cycles) < MICROBENCH_MIN_TIME)
+        reps *= 2;
+
+    double times[MICROBENCH_TRIALS];
+    double trial_cycles[MICROBENCH_TRIALS];
+    for (int trial = 0; trial < MICROBENCH_TRIALS; ++trial)
+    {
+        times[trial] = 1e9 * microbench_batch(op, data, reps, &cycles) / reps;
+        trial_cycles[trial] = cycles / reps;
+    }
+    benchmark_summary summary;
+    benchmark_summarize(MICROBENCH_TRIALS, times, &summary);
+    *ns_per_op = summary.median;
+    benchmark_summarize(MICROBENCH_TRIALS, trial_cycles, &summary);
+    *cycles_per_op = summary.median;
+}
+
+/**
+ * \brief Times the kernel `op` and prints its record
+ * \param[in]       kernel      The kernel name
+ * \param[in]       size        The size the kernel is run at
+ * \param[in]       flops       The nominal flops per operation, zero if not defined
+ * \param[in]       op          The operation
+ * \param[in]       baseline    The input copy included in `op`, subtracted from its time, or NULL
+ * \param[in]       data        The kernel data
+ */
+static void microbench_run(const char* kernel, const int size, const double flops,
+                           microbench_op op, microbench_op baseline, void* data)
+{
+    microbench_record rec = {kernel, "cpu", size, 0, 0, flops};
+    microbench_measure(op, data, &rec.ns_per_op, &rec.cycles_per_op);
+    if (baseline != NULL)
+    {
+        double ns_copy, cycles_copy;
+        microbench_measure(baseline, data, &ns_copy, &cycles_copy);
+        rec.ns_per_op = fmax(rec.ns_per_op - ns_copy, 0);
+        rec.cycles_per_op = fmax(rec.cycles_per_op - cycles_copy, 0);
+    }
+    microbench_print(&rec);
+}
+
+/**
+ * \brief The data of the Hessenberg kernels
+ */
+typedef struct
+{
+    //! the matrix size
+    int n;
+    //! the #MICROBENCH_INPUTS random (#STRIDE x #STRIDE) inputs
+    double complex* inputs;
+    //! the real parts of the inputs, for the phi-functions
+    double* real_inputs;
+    //! the working matrix
+    double complex A[STRIDE * STRIDE];
+    //! the resulting real matrix
+    double phiA[STRIDE * STRIDE];
+    //! the pivot indicies
+    int ipiv[STRIDE];
+} hessenberg_data;
+
+//! Restores the working matrix from input `i`
+static void hessenberg_copy(void* data, const int i)
+{
+    hessenberg_data* d = (hessenberg_data*)data;
+    memcpy(d->A, &d->inputs[i * STRIDE * STRIDE], d->n * STRIDE * sizeof(double complex));
+}
+
+static void hessenberg_lu(void* data, const int i)
+{
+    hessenberg_data* d = (hessenberg_data*)data;
+    hessenberg_copy(data, i);
+    getComplexLUHessenberg(d->n, d->A, d->ipiv);
+}
+
+static void hessenberg_inverse(void* data, const int i)
+{
+    hessenberg_data* d = (hessenberg_data*)data;
+    int info = 0;
+    hessenberg_copy(data, i);
+    getComplexInverseHessenberg(d->n, d->A, d->ipiv, &info);
+}
+
+#if defined(RB43) || defined(EXP4)
+static void phi_variable(void* data, const int i)
+{
+    hessenberg_data* d = (hessenberg_data*)data;
+    phiAc_variable(d->n, &d->real_inputs[i * STRIDE * STRIDE], 1.0, d->phiA);
+}
+#endif
+
+/**
+ * \brief The data of the (NSP x NSP) mechanism and solver kernels
+ */
+typedef struct
+{
+    //! the system constant variable (pressure/density)
+    double pr;
+    //! the #MICROBENCH_INPUTS random state vectors
+    double y[MICROBENCH_INPUTS][NSP];
+    //! the Jacobian at each state vector
+    double jac[MICROBENCH_INPUTS][JAC_SIZE];
+    //! #MICROBENCH_INPUTS random vectors
+    double v[MICROBENCH_INPUTS][NSP];
+    //! the output vector
+    double dy[NSP];
+    //! the output matrix
+    double A[NSP * NSP];
+#if defined(RB43) || defined(EXP4)
+    //! the RHS at each state vector
+    double fy[MICROBENCH_INPUTS][NSP];
+    //! the Jacobian operator at each state vector
+    jac_operator J[MICROBENCH_INPUTS];
+    //! the error weights at each state vector
+    double sc[MICROBENCH_INPUTS][NSP];
+    //! the Arnoldi basis
+    double Vm[NSP * STRIDE];
+    //! the Hessenberg matrix
+    double Hm[STRIDE * STRIDE];
+    //! the phi-function of the Hessenberg matrix
+    double phiHm[STRIDE * STRIDE];
+    //! the sum of the Krylov subspace sizes of the Arnoldi iterations
+    long long m_sum;
+    //! the number of Arnoldi iterations
+    long long m_count;
+#endif
+#ifdef RADAU2A
+    //! the step size
+    double H;
+    //! the real system matrix
+    lu_real E1[NSP * NSP];
+    //! the complex system matrix
+    lu_complex E2[NSP * NSP];
+    //! the real pivot indicies
+    int ipiv1[NSP];
+    //! the complex pivot indicies
+    int ipiv2[NSP];
+    //! the stage right hand sides
+    double R[3][NSP];
+#endif
+} mechanism_data;
+
+static void rhs(void* data, const int i)
+{
+    mechanism_data* d = (mechanism_data*)data;
+    dydt(0, d->pr, d->y[i], d->dy);
+}
+
+static void jacobian(void* data, const int i)
+{
+    mechanism_data* d = (mechanism_data*)data;
+    eval_jacob(0, d->pr, d->y[i], d->A);
+}
+
+static void jac_vec(void* data, const int i)
+{
+    mechanism_data* d = (mechanism_data*)data;
+    sparse_multiplier(d->jac[i], d->v[i], d->dy);
+}
+
+#if defined(RB43) || defined(EXP4)
+static void krylov(void* data, const int i)
+{
+    mechanism_data* d = (mechanism_data*)data;
+    double beta = 0;
+    int m = arnoldi(1.0, 1, MICROBENCH_STEP, &d->J[i], d->v[i], d->sc[i], &beta, d->Vm, d->Hm, d->phiHm, 0, 0);
+    d->m_sum += m;
+    d->m_count += 1;
+}
+#endif
+
+#ifdef RADAU2A
+static void rk_decomp(void* data, const int i)
+{
+    mechanism_data* d = (mechanism_data*)data;
+    int info = 0;
+    RK_Decomp(d->H, d->E1, d->E2, d->jac[i], d->ipiv1, d->ipiv2, &info);
+}
+
+//! Restores the stage right hand sides from input `i`
+static void rk_copy(void* data, const int i)
+{
+    mechanism_data* d = (mechanism_data*)data;
+    memcpy(d->R[0], d->v[i], NSP * sizeof(double));
+    memcpy(d->R[1], d->v[(i + 1) % MICROBENCH_INPUTS], NSP * sizeof(double));
+    memcpy(d->R[2], d->v[(i + 2) % MICROBENCH_INPUTS], NSP * sizeof(double));
+}
+
+static void rk_solve(void* data, const int i)
+{
+    mechanism_data* d = (mechanism_data*)data;
+    rk_copy(data, i);
+    RK_Solve(d->H, d->H, d->jac[0], d->E1, d->E2, d->R[0], d->R[1], d->R[2], d->ipiv1, d->ipiv2);
+}
+#endif
+
+/** Main function
+ *
+ * \param[in]       argc    command line argument count
+ * \param[in]       argv    command line argument vector
+ *
+ * The syntax is as follows:\n
+ * `./solver-name-microbench [max_size] [ic_file]`\n
+ * *  max_size     [Optional, Default:#STRIDE]
+ *      *  The largest size of the Hessenberg and phi-function kernels, at most #STRIDE
+ * *  ic_file      [Optional]
+ *      *  The initial condition file the state vectors are perturbed from, if not supplied the mechanism's
+ *         set_same_initial_conditions is used
+ */
+int main (int argc, char *argv[])
+{
+    int max_size = STRIDE;
+    if (argc > 1)
+    {
+        max_size = atoi(argv[1]);
+        if (max_size < 2 || max_size > STRIDE)
+        {
+            printf("Error: the maximum size must be between 2 and %d\n", STRIDE);
+            exit(1);
+        }
+    }
+
+    initialize_tolerances(&current_tolerances);
+    void* memory = initialize_solver(1);
+    uint32_t state = MICROBENCH_SEED;
+
+    printf("# %s microbenchmarks, NSP: %d, STRIDE: %d\n", solver_name(), NSP, STRIDE);
+    microbench_print_header();
+
+    // the Hessenberg kernels
+    hessenberg_data* hess = (hessenberg_data*)malloc(sizeof(hessenberg_data));
+    hess->inputs = (double complex*)malloc(MICROBENCH_INPUTS * STRIDE * STRIDE * sizeof(double complex));
+    hess->real_inputs = (double*)malloc(MICROBENCH_INPUTS * STRIDE * STRIDE * sizeof(double));
+    double* imag = (double*)malloc(STRIDE * STRIDE * sizeof(double));
+    int sizes[32];
+    int num_sizes = microbench_sizes(max_size, sizes);
+    for (int s = 0; s < num_sizes; ++s)
+    {
+        const int n = sizes[s];
+        hess->n = n;
+        for (int k = 0; k < MICROBENCH_INPUTS; ++k)
+        {
+            double* real = &hess->real_inputs[k * STRIDE * STRIDE];
+            double complex* A = &hess->inputs[k * STRIDE * STRIDE];
+            memset(real, 0, STRIDE * STRIDE * sizeof(double));
+            memset(imag, 0, STRIDE * STRIDE * sizeof(double));
+            microbench_hessenberg(n, STRIDE, 0.0, &state, real);
+            microbench_hessenberg(n, STRIDE, 0.0, &state, imag);
+            // shifted by a complex pole, as in the rational approximant
+            for (int j = 0; j < STRIDE * STRIDE; ++j)
+                A[j] = real[j] + imag[j] * I;
+            for (int j = 0; j < n; ++j)
+                A[j + j * STRIDE] += 2.0 + 1.0 * I;
+        }
+        microbench_run("getHessenbergLU", n, microbench_flops_hessenberg_lu(n),
+                       hessenberg_lu, hessenberg_copy, hess);
+        microbench_run("getComplexInverseHessenberg", n, microbench_flops_hessenberg_inverse(n),
+                       hessenberg_inverse, hessenberg_copy, hess);
+#if defined(RB43) || defined(EXP4)
+#ifdef PHI_TAYLOR
+        // the Taylor series cost depends on the norm of the matrix, and is not modeled
+        microbench_run("phiAc_variable", n, 0, phi_variable, NULL, hess);
+#else
+        microbench_run("phiAc_variable", n, microbench_flops_phi(n, N_RA), phi_variable, NULL, hess);
+#endif
+#endif
+    }
+    free(imag);
+    free(hess->inputs);
+    free(hess->real_inputs);
+    free(hess);
+
+    // the mechanism and solver kernels, at random perturbations of the initial state
+    double* y_host;
+    double* var_host;
+    if (argc > 2)
+        read_initial_conditions(argv[2], 1, &y_host, &var_host);
+    else
+        set_same_initial_conditions(1, &y_host, &var_host);
+    mechanism_data* mech = (mechanism_data*)malloc(sizeof(mechanism_data));
+    mech->pr = var_host[0];
+    int nnz = 0;
+    for (int k = 0; k < MICROBENCH_INPUTS; ++k)
+    {
+        for (int i = 0; i < NSP; ++i)
+        {
+            mech->y[k][i] = y_host[i] * (1.0 + 1e-3 * microbench_rand(&state));
+            mech->v[k][i] = microbench_rand(&state);
+        }
+        eval_jacob(0, mech->pr, mech->y[k], mech->jac[k]);
+    }
+    for (int i = 0; i < JAC_SIZE; ++i)
+        nnz += mech->jac[0][i] != 0;
+    free(y_host);
+    free(var_host);
+
+    microbench_run("dydt", NSP, 0, rhs, NULL, mech);
+    microbench_run("eval_jacob", NSP, 0, jacobian, NULL, mech);
+    microbench_run("sparse_multiplier", NSP, 2.0 * nnz, jac_vec, NULL, mech);
+#if defined(RB43) || defined(EXP4)
+    for (int k = 0; k < MICROBENCH_INPUTS; ++k)
+    {
+        dydt(0, mech->pr, mech->y[k], mech->fy[k]);
+        jac_operator_update(&mech->J[k], 0, mech->pr, mech->y[k], mech->fy[k]);
+        scale_init(mech->y[k], mech->sc[k]);
+    }
+    mech->m_sum = 0;
+    mech->m_count = 0;
+    // the Krylov subspace size, and hence the cost, depends on the step size
+    microbench_run("arnoldi", NSP, 0, krylov, NULL, mech);
+    printf("# arnoldi: step size %.3e, mean Krylov subspace size %.2f\n", MICROBENCH_STEP,
+           (double)mech->m_sum / (double)mech->m_count);
+#endif
+#ifdef RADAU2A
+#ifdef SPARSE_LU
+    sparse_lu_init(0, mech->pr, mech->y[0]);
+#endif
+    mech->H = MICROBENCH_STEP;
+    microbench_run("RK_Decomp", NSP, microbench_flops_rk_decomp(NSP), rk_decomp, NULL, mech);
+    // factor the systems of the first input, solved in RK_Solve
+    rk_decomp(mech, 0);
+    microbench_run("RK_Solve", NSP, microbench_flops_rk_solve(NSP), rk_solve, rk_copy, mech);
+#endif
+    free(mech);
+
+    cleanup_solver(1, memory);
+    return 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,513 @@
+/**
+ * \file
+ * \brief Microbenchmarks of the numerical kernels of the GPU solvers
+ *
+ * Built as the [solver]-gpu-microbench executables with the MICROBENCH option, @see microbench.h
+ *
+ * Times the device kernels of microbench.c (getHessenbergLU, getComplexInverseHessenberg, phiAc_variable,
+ * dydt, eval_jacob, sparse_multiplier, RK_Decomp and RK_Solve) with one operation per GPU thread, on a grid
+ * of (padded) threads laid out as in the integration drivers, i.e. every thread operates on its own
+ * fixed random input.  The launches are timed with CUDA events, in batches of at least #MICROBENCH_MIN_TIME
+ * seconds, and the median of #MICROBENCH_TRIALS batches is reported per operation (i.e. the batch time
+ * divided by the number of launches and threads), hence the GFLOP/s are those of the whole device.
+ * In-place kernels restore their input before each operation, the time of this copy is measured separately
+ * and subtracted.  No cycles are reported.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include <cuComplex.h>
+
+#include "header.cuh"
+#include "solver.cuh"
+#include "gpu_macros.cuh"
+#include "gpu_memory.cuh"
+#include "launch_bounds.cuh"
+#include "multi_gpu.cuh"
+#include "complexInverse.cuh"
+#include "dydt.cuh"
+#ifndef FINITE_DIFFERENCE
+#include "jacob.cuh"
+#else
+#include "fd_jacob.cuh"
+#endif
+#include "sparse_multiplier.cuh"
+#include "sparse_jacobian.cuh"
+#include "read_initial_conditions.cuh"
+#if defined(RB43) || defined(EXP4)
+#include "phiAHessenberg.cuh"
+#endif
+#include "microbench.h"
+
+#ifdef GENERATE_DOCS
+namespace genericcu {
+#endif
+
+#ifdef RADAU2A
+// defined in radau2a.cu
+__device__ void RK_Decomp(double H, const double* const __restrict__ Jac,
+                          const solver_memory* const __restrict__ solver,
+                          int* __restrict__ info);
+__device__ void RK_Solve(const double H, const double H_LU,
+                         double const * const __restrict__ Jac,
+                         solver_memory const * const __restrict__ solver,
+                         cuDoubleComplex * const __restrict__ temp);
+#endif
+
+/**
+ * \brief The device buffers and launch configuration of the GPU microbenchmarks
+ *
+ * All buffers are stored per thread, with a leading dimension of the padded number of threads, @see INDEX
+ */
+struct gpu_bench
+{
+    //! the device the solver and mechanism memory live on
+    device_shard shard;
+    //! the matrix size of the Hessenberg kernels
+    int n;
+    //! the (#STRIDE x #STRIDE) complex random inputs
+    cuDoubleComplex* inputs;
+    //! the (#STRIDE x #STRIDE) complex working matricies
+    cuDoubleComplex* A;
+    //! a (#STRIDE) complex work array
+    cuDoubleComplex* work;
+    //! the (#STRIDE x #STRIDE) real random inputs
+    double* real_inputs;
+    //! the (#STRIDE x #STRIDE) real results
+    double* phiA;
+    //! (#NSP) random vectors
+    double* v;
+    //! (#NSP) output vectors
+    double* w;
+    //! (#NSP) work arrays of the finite difference Jacobian
+    double* work1;
+    double* work2;
+    //! the (#STRIDE) pivot indicies
+    int* ipiv;
+};
+
+//! A launch of a kernel on all threads
+typedef void (*gpu_launch)(const gpu_bench* b);
+
+__global__
+void hessenberg_copy_kernel(const int n, const cuDoubleComplex* __restrict__ inputs, cuDoubleComplex* __restrict__ A)
+{
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            A[INDEX(i + j * STRIDE)] = inputs[INDEX(i + j * STRIDE)];
+        }
+    }
+}
+
+__global__
+void hessenberg_lu_kernel(const int n, const cuDoubleComplex* __restrict__ inputs, cuDoubleComplex* __restrict__ A,
+                          int* __restrict__ ipiv)
+{
+    int info = 0;
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            A[INDEX(i + j * STRIDE)] = inputs[INDEX(i + j * STRIDE)];
+        }
+    }
+    getHessenbergLU(n, A, ipiv, &info);
+}
+
+__global__
+void hessenberg_inverse_kernel(const int n, const cuDoubleComplex* __restrict__ inputs, cuDoubleComplex* __restrict__ A,
+                               int* __restrict__ ipiv, cuDoubleComplex* __restrict__ work)
+{
+    int info = 0;
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            A[INDEX(i + j * STRIDE)] = inputs[INDEX(i + j * STRIDE)];
+        }
+    }
+    getComplexInverseHessenberg(n, A, ipiv, &info, work);
+}
+
+#if defined(RB43) || defined(EXP4)
+__global__
+void phi_kernel(const int n, const double* __restrict__ inputs, double* __restrict__ phiA,
+                const solver_memory* __restrict__ solver, cuDoubleComplex* __restrict__ work)
+{
+    phiAc_variable(n, inputs, 1.0, phiA, solver, work);
+}
+#endif
+
+__global__
+void dydt_kernel(const mechanism_memory* __restrict__ d_mem)
+{
+    dydt(0, d_mem->var[T_ID], d_mem->y, d_mem->dy, d_mem);
+}
+
+__global__
+void jacob_kernel(const mechanism_memory* __restrict__ d_mem, double* __restrict__ work1, double* __restrict__ work2)
+{
+#ifndef FINITE_DIFFERENCE
+    eval_jacob(0, d_mem->var[T_ID], d_mem->y, d_mem->jac, d_mem);
+#else
+    eval_jacob(0, d_mem->var[T_ID], d_mem->y, d_mem->jac, d_mem, work1, work2);
+#endif
+}
+
+__global__
+void sparse_kernel(const mechanism_memory* __restrict__ d_mem, const double* __restrict__ v, double* __restrict__ w)
+{
+    sparse_multiplier(d_mem->jac, v, w);
+}
+
+#ifdef RADAU2A
+__global__
+void DRIVER_LAUNCH_BOUNDS rk_decomp_kernel(const mechanism_memory* __restrict__ d_mem, const solver_memory* __restrict__ solver)
+{
+#ifdef WARP_LU
+    warp_lu_init();
+#endif
+    int info = 0;
+    RK_Decomp(MICROBENCH_STEP, d_mem->jac, solver, &info);
+}
+
+__global__
+void rk_copy_kernel(const double* __restrict__ v, const solver_memory* __restrict__ solver)
+{
+    for (int i = 0; i < NSP; ++i)
+    {
+        solver->DZ1[INDEX(i)] = v[INDEX(i)];
+        solver->DZ2[INDEX(i)] = -v[INDEX(i)];
+        solver->DZ3[INDEX(i)] = 0.5 * v[INDEX(i)];
+    }
+}
+
+__global__
+void rk_solve_kernel(const mechanism_memory* __restrict__ d_mem, const double* __restrict__ v,
+                     const solver_memory* __restrict__ solver, cuDoubleComplex* __restrict__ work)
+{
+    for (int i = 0; i < NSP; ++i)
+    {
+        solver->DZ1[INDEX(i)] = v[INDEX(i)];
+        solver->DZ2[INDEX(i)] = -v[INDEX(i)];
+        solver->DZ3[INDEX(i)] = 0.5 * v[INDEX(i)];
+    }
+    RK_Solve(MICROBENCH_STEP, MICROBENCH_STEP, d_mem->jac, solver, work);
+}
+
+#ifdef HESSENBERG_RADAU
+__global__
+void hessenberg_reduce_kernel(const mechanism_memory* __restrict__ d_mem, const solver_memory* __restrict__ solver)
+{
+    hessenberg_reduce(d_mem->jac, solver->tau);
+}
+#endif
+#endif
+
+static void launch_hessenberg_copy(const gpu_bench* b)
+{
+    hessenberg_copy_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, 0, b->shard.stream >>> (b->n, b->inputs, b->A);
+}
+
+static void launch_hessenberg_lu(const gpu_bench* b)
+{
+    hessenberg_lu_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, 0, b->shard.stream >>> (b->n, b->inputs, b->A, b->ipiv);
+}
+
+static void launch_hessenberg_inverse(const gpu_bench* b)
+{
+    hessenberg_inverse_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, 0, b->shard.stream >>> (b->n, b->inputs, b->A,
+                                                                                              b->ipiv, b->work);
+}
+
+#if defined(RB43) || defined(EXP4)
+static void launch_phi(const gpu_bench* b)
+{
+    phi_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, 0, b->shard.stream >>> (b->n, b->real_inputs, b->phiA,
+                                                                               b->shard.device_solver, b->work);
+}
+#endif
+
+static void launch_dydt(const gpu_bench* b)
+{
+    dydt_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, SHARED_SIZE, b->shard.stream >>> (b->shard.device_mech);
+}
+
+static void launch_jacob(const gpu_bench* b)
+{
+    jacob_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, SHARED_SIZE, b->shard.stream >>> (b->shard.device_mech,
+                                                                                           b->work1, b->work2);
+}
+
+static void launch_sparse(const gpu_bench* b)
+{
+    sparse_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, 0, b->shard.stream >>> (b->shard.device_mech, b->v, b->w);
+}
+
+#ifdef RADAU2A
+static void launch_rk_decomp(const gpu_bench* b)
+{
+    rk_decomp_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, SHARED_SIZE + SOLVER_SHARED_SIZE, b->shard.stream >>> (
+                                                                b->shard.device_mech, b->shard.device_solver);
+}
+
+static void launch_rk_copy(const gpu_bench* b)
+{
+    rk_copy_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, 0, b->shard.stream >>> (b->v, b->shard.device_solver);
+}
+
+static void launch_rk_solve(const gpu_bench* b)
+{
+    rk_solve_kernel <<< b->shard.dimGrid, TARGET_BLOCK_SIZE, SHARED_SIZE + SOLVER_SHARED_SIZE, b->shard.stream >>> (
+                                                                b->shard.device_mech, b->v, b->shard.device_solver, b->work);
+}
+#endif
+
+/**
+ * \brief Times `reps` launches of `launch` with CUDA events
+ * \return          The elapsed time in ms
+ */
+static float gpu_batch(gpu_launch launch, const gpu_bench* b, const long reps, cudaEvent_t start, cudaEvent_t stop)
+{
+    cudaErrorCheck( cudaEventRecord(start, b->shard.stream) );
+    for (long r = 0; r < reps; ++r)
+        launch(b);
+    cudaErrorCheck( cudaEventRecord(stop, b->shard.stream) );
+    cudaErrorCheck( cudaEventSynchronize(stop) );
+    cudaErrorCheck( cudaPeekAtLastError() );
+    float ms = 0;
+    cudaErrorCheck( cudaEventElapsedTime(&ms, start, stop) );
+    return ms;
+}
+
+/**
+ * \brief Returns the median time per operation (in ns) of `launch`
+ *
+ * The number of launches per batch is doubled until a batch lasts #MICROBENCH_MIN_TIME
+ */
+static double gpu_measure(gpu_launch launch, const gpu_bench* b)
+{
+    cudaEvent_t start, stop;
+    cudaErrorCheck( cudaEventCreate(&start) );
+    cudaErrorCheck( cudaEventCreate(&stop) );
+    long reps = 1;
+    while (gpu_batch(launch, b, reps, start, stop) < 1e3 * MICROBENCH_MIN_TIME)
+        reps *= 2;
+
+    double times[MICROBENCH_TRIALS];
+    for (int trial = 0; trial < MICROBENCH_TRIALS; ++trial)
+        times[trial] = 1e6 * gpu_batch(launch, b, reps, start, stop) / ((double)reps * b->shard.padded);
+    benchmark_summary summary;
+    benchmark_summarize(MICROBENCH_TRIALS, times, &summary);
+    cudaErrorCheck( cudaEventDestroy(start) );
+    cudaErrorCheck( cudaEventDestroy(stop) );
+    return summary.median;
+}
+
+/**
+ * \brief Times the kernel of `launch` and prints its record
+ * \param[in]       kernel      The kernel name
+ * \param[in]       size        The size the kernel is run at
+ * \param[in]       flops       The nominal flops per operation, zero if not defined
+ * \param[in]       launch      The kernel launch
+ * \param[in]       baseline    The launch of the input copy included in `launch`, subtracted from its time, or NULL
+ * \param[in]       b           The benchmark buffers
+ */
+static void gpu_run(const char* kernel, const int size, const double flops, gpu_launch launch,
+                    gpu_launch baseline, const gpu_bench* b)
+{
+    microbench_record rec = {kernel, "gpu", size, 0, 0, flops};
+    rec.ns_per_op = gpu_measure(launch, b);
+    if (baseline != NULL)
+        rec.ns_per_op = fmax(rec.ns_per_op - gpu_measure(baseline, b), 0);
+    microbench_print(&rec);
+}
+
+/**
+ * \brief Copies the column-major (`lda` x `lda`) matrix `src` of thread `tid` into the per-thread layout of `dest`
+ */
+static void scatter(const int lda, const int padded, const int tid, const double* src, double* dest)
+{
+    for (int k = 0; k < lda * lda; ++k)
+        dest[tid + k * padded] = src[k];
+}
+
+/** Main function
+ *
+ * \param[in]       argc    command line argument count
+ * \param[in]       argv    command line argument vector
+ *
+ * The syntax is as follows:\n
+ * `./solver-name-gpu-microbench [num_threads] [device] [max_size] [ic_file]`\n
+ * *  num_threads  [Optional, Default:8192]
+ *      *  The number of GPU threads (operations per launch), rounded up to a multiple of the block size
+ * *  device       [Optional, Default:0]
+ *      *  The CUDA device to use
+ * *  max_size     [Optional, Default:#STRIDE]
+ *      *  The largest size of the Hessenberg and phi-function kernels, at most #STRIDE
+ * *  ic_file      [Optional]
+ *      *  The initial condition file the state vectors are perturbed from, if not supplied the mechanism's
+ *         set_same_initial_conditions is used
+ */
+int main (int argc, char *argv[])
+{
+    int NUM = 8192;
+    int device = 0;
+    int max_size = STRIDE;
+    if (argc > 1)
+        NUM = atoi(argv[1]);
+    if (argc > 2)
+        device = atoi(argv[2]);
+    if (argc > 3)
+        max_size = atoi(argv[3]);
+    if (NUM < 1 || max_size < 2 || max_size > STRIDE)
+    {
+        printf("Error: the number of threads must be positive, and the maximum size between 2 and %d\n", STRIDE);
+        exit(1);
+    }
+
+    // zero-initialized, such that the (GPU_ARENA) device arena starts empty
+    gpu_bench b = {};
+    if (initialize_shards(NUM, 1, &device, NULL, &b.shard, true) != 1)
+    {
+        printf("Error: could not initialize device %d\n", device);
+        exit(1);
+    }
+    const int padded = b.shard.padded;
+    // the kernels below run one thread per IVP, even if intDriver runs a group per IVP (WARP_IVP)
+    b.shard.dimGrid = dim3(padded / TARGET_BLOCK_SIZE, 1);
+    const size_t mat_size = (size_t)padded * STRIDE * STRIDE;
+    cudaErrorCheck( cudaMalloc(&b.inputs, mat_size * sizeof(cuDoubleComplex)) );
+    cudaErrorCheck( cudaMalloc(&b.A, mat_size * sizeof(cuDoubleComplex)) );
+    cudaErrorCheck( cudaMalloc(&b.work, (size_t)padded * STRIDE * sizeof(cuDoubleComplex)) );
+    cudaErrorCheck( cudaMalloc(&b.real_inputs, mat_size * sizeof(double)) );
+    cudaErrorCheck( cudaMalloc(&b.phiA, mat_size * sizeof(double)) );
+    cudaErrorCheck( cudaMalloc(&b.v, (size_t)padded * NSP * sizeof(double)) );
+    cudaErrorCheck( cudaMalloc(&b.w, (size_t)padded * NSP * sizeof(double)) );
+    cudaErrorCheck( cudaMalloc(&b.work1, (size_t)padded * NSP * sizeof(double)) );
+    cudaErrorCheck( cudaMalloc(&b.work2, (size_t)padded * NSP * sizeof(double)) );
+    cudaErrorCheck( cudaMalloc(&b.ipiv, (size_t)padded * STRIDE * sizeof(int)) );
+
+    uint32_t state = MICROBENCH_SEED;
+    printf("# %s microbenchmarks, NSP: %d, STRIDE: %d, threads: %d, block size: %d\n", solver_name(), NSP, STRIDE,
+           padded, TARGET_BLOCK_SIZE);
+    microbench_print_header();
+
+    // the Hessenberg kernels
+    double* real = (double*)malloc(STRIDE * STRIDE * sizeof(double));
+    double* imag = (double*)malloc(STRIDE * STRIDE * sizeof(double));
+    double* real_host = (double*)malloc(mat_size * sizeof(double));
+    cuDoubleComplex* complex_host = (cuDoubleComplex*)malloc(mat_size * sizeof(cuDoubleComplex));
+    int sizes[32];
+    int num_sizes = microbench_sizes(max_size, sizes);
+    for (int s = 0; s < num_sizes; ++s)
+    {
+        const int n = sizes[s];
+        b.n = n;
+        for (int tid = 0; tid < padded; ++tid)
+        {
+            memset(real, 0, STRIDE * STRIDE * sizeof(double));
+            memset(imag, 0, STRIDE * STRIDE * sizeof(double));
+            microbench_hessenberg(n, STRIDE, 0.0, &state, real);
+            microbench_hessenberg(n, STRIDE, 0.0, &state, imag);
+            scatter(STRIDE, padded, tid, real, real_host);
+            // shifted by a complex pole, as in the rational approximant
+            for (int k = 0; k < STRIDE * STRIDE; ++k)
+            {
+                const bool diagonal = (k % STRIDE) == (k / STRIDE) && (k % STRIDE) < n;
+                complex_host[tid + k * padded] = make_cuDoubleComplex(real[k] + (diagonal ? 2.0 : 0.0),
+                                                                      imag[k] + (diagonal ? 1.0 : 0.0));
+            }
+        }
+        cudaErrorCheck( cudaMemcpy(b.real_inputs, real_host, mat_size * sizeof(double), cudaMemcpyHostToDevice) );
+        cudaErrorCheck( cudaMemcpy(b.inputs, complex_host, mat_size * sizeof(cuDoubleComplex), cudaMemcpyHostToDevice) );
+
+        gpu_run("getHessenbergLU", n, microbench_flops_hessenberg_lu(n), launch_hessenberg_lu,
+                launch_hessenberg_copy, &b);
+        gpu_run("getComplexInverseHessenberg", n, microbench_flops_hessenberg_inverse(n), launch_hessenberg_inverse,
+                launch_hessenberg_copy, &b);
+#if defined(RB43) || defined(EXP4)
+#ifdef PHI_TAYLOR
+        // the Taylor series cost depends on the norm of the matrix, and is not modeled
+        gpu_run("phiAc_variable", n, 0, launch_phi, NULL, &b);
+#else
+        gpu_run("phiAc_variable", n, microbench_flops_phi(n, N_RA), launch_phi, NULL, &b);
+#endif
+#endif
+    }
+    free(real);
+    free(imag);
+    free(real_host);
+    free(complex_host);
+
+    // the mechanism and solver kernels, at random perturbations of the initial state
+    double* y_host;
+    double* var_host;
+    if (argc > 4)
+        read_initial_conditions(argv[4], 1, &y_host, &var_host);
+    else
+        set_same_initial_conditions(1, &y_host, &var_host);
+    double* y = (double*)malloc((size_t)padded * NSP * sizeof(double));
+    double* v = (double*)malloc((size_t)padded * NSP * sizeof(double));
+    double* var = (double*)malloc((size_t)padded * sizeof(double));
+    for (int tid = 0; tid < padded; ++tid)
+    {
+        var[tid] = var_host[0];
+        for (int i = 0; i < NSP; ++i)
+        {
+            y[tid + i * padded] = y_host[i] * (1.0 + 1e-3 * microbench_rand(&state));
+            v[tid + i * padded] = microbench_rand(&state);
+        }
+    }
+    cudaErrorCheck( cudaMemcpy(b.shard.host_mech->y, y, (size_t)padded * NSP * sizeof(double), cudaMemcpyHostToDevice) );
+    cudaErrorCheck( cudaMemcpy(b.shard.host_mech->var, var, (size_t)padded * sizeof(double), cudaMemcpyHostToDevice) );
+    cudaErrorCheck( cudaMemcpy(b.v, v, (size_t)padded * NSP * sizeof(double), cudaMemcpyHostToDevice) );
+    free(y);
+    free(v);
+    free(var);
+    free(y_host);
+    free(var_host);
+
+    gpu_run("dydt", NSP, 0, launch_dydt, NULL, &b);
+    gpu_run("eval_jacob", NSP, 0, launch_jacob, NULL, &b);
+    // the Jacobian of the first thread gives the nonzeros of the Jacobian-vector product
+    double* jac = (double*)malloc((size_t)padded * JAC_SIZE * sizeof(double));
+    cudaErrorCheck( cudaMemcpy(jac, b.shard.host_mech->jac, (size_t)padded * JAC_SIZE * sizeof(double),
+                               cudaMemcpyDeviceToHost) );
+    int nnz = 0;
+    for (int k = 0; k < JAC_SIZE; ++k)
+        nnz += jac[k * padded] != 0;
+    free(jac);
+    gpu_run("sparse_multiplier", NSP, 2.0 * nnz, launch_sparse, NULL, &b);
+#ifdef RADAU2A
+#ifdef HESSENBERG_RADAU
+    hessenberg_reduce_kernel <<< b.shard.dimGrid, TARGET_BLOCK_SIZE, 0, b.shard.stream >>> (b.shard.device_mech,
+                                                                                           b.shard.device_solver);
+#endif
+    gpu_run("RK_Decomp", NSP, microbench_flops_rk_decomp(NSP), launch_rk_decomp, NULL, &b);
+    gpu_run("RK_Solve", NSP, microbench_flops_rk_solve(NSP), launch_rk_solve, launch_rk_copy, &b);
+#endif
+
+    cudaErrorCheck( cudaFree(b.inputs) );
+    cudaErrorCheck( cudaFree(b.A) );
+    cudaErrorCheck( cudaFree(b.work) );
+    cudaErrorCheck( cudaFree(b.real_inputs) );
+    cudaErrorCheck( cudaFree(b.phiA) );
+    cudaErrorCheck( cudaFree(b.v) );
+    cudaErrorCheck( cudaFree(b.w) );
+    cudaErrorCheck( cudaFree(b.work1) );
+    cudaErrorCheck( cudaFree(b.work2) );
+    cudaErrorCheck( cudaFree(b.ipiv) );
+    cleanup_shards(1, &b.shard);
+    return 0;
+}
+
+#ifdef GENERATE_DOCS
+}
+#endif
@@ -0,0 +1,205 @@
+/**
+ * \file
+ * \brief Shared inputs, flop models and output of the numerical kernel microbenchmarks
+ *
+ * The microbenchmarks (microbench.c for the CPU, microbench.cu for the GPU) time the kernels that
+ * dominate the solver profiles in isolation, on fixed (seeded) random inputs over a range of
+ * matrix sizes.  Each kernel is reported in ns / operation and GFLOP/s, where the flops are the
+ * nominal counts of the dense algorithms below (not the operations actually executed, e.g. the
+ * zero skipping of the Hessenberg routines is ignored), such that the GFLOP/s of one kernel are
+ * comparable between builds.  Kernels without a meaningful flop count (e.g. the Jacobian evaluation,
+ * whose cost is that of the mechanism) report zero GFLOP/s.
+ *
+ * If #BENCHMARK_OUTPUT is defined, a record of each kernel is appended to the named file, as CSV if the
+ * file name ends with `.csv` and as JSON lines otherwise.
+ * The solver options must be included before this file.
+ */
+
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "benchmark.h"
+
+#ifndef MICROBENCH_TRIALS
+    //! The number of timed trials of each kernel, the median trial is reported
+    #define MICROBENCH_TRIALS (5)
+#endif
+#ifndef MICROBENCH_MIN_TIME
+    //! The minimum duration (in seconds) of each timed trial, the number of operations per trial is grown to reach it
+    #define MICROBENCH_MIN_TIME (0.05)
+#endif
+//! The number of distinct random inputs each kernel cycles through
+#define MICROBENCH_INPUTS (16)
+//! The step size of the Arnoldi iterations and the Radau-IIa system matricies
+#define MICROBENCH_STEP (1e-6)
+//! The seed of the random inputs
+#define MICROBENCH_SEED (0x5eed1234u)
+
+/**
+ * \brief The timing of a kernel at one size
+ */
+typedef struct
+{
+    //! the kernel name
+    const char* kernel;
+    //! the platform, i.e. "cpu" or "gpu"
+    const char* platform;
+    //! the matrix size (n or m) the kernel was run at
+    int size;
+    //! the median time per operation, in ns
+    double ns_per_op;
+    //! the median CPU cycles per operation, zero if not measured
+    double cycles_per_op;
+    //! the nominal flops per operation, zero if not defined
+    double flops_per_op;
+} microbench_record;
+
+/**
+ * \brief Returns the next value in [-1, 1) of the (xorshift) random sequence `state`
+ *
+ * Unlike rand(), the sequence is the same on every platform, such that the inputs of two builds match.
+ */
+static inline double microbench_rand(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return 2.0 * ((double)x / 4294967296.0) - 1.0;
+}
+
+/**
+ * \brief Fills the (`n` x `n`, leading dimension `lda`, column-major) upper Hessenberg matrix `A` with random entries
+ * \param[in]       n           The matrix size
+ * \param[in]       lda         The leading dimension of `A`
+ * \param[in]       shift       Added to the diagonal, e.g. to keep the matrix well-conditioned
+ * \param[in,out]   state       The random sequence
+ * \param[out]      A           The matrix, the entries below the subdiagonal are zero
+ */
+static inline void microbench_hessenberg(const int n, const int lda, const double shift, uint32_t* state, double* A)
+{
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            A[i + j * lda] = i <= j + 1 ? microbench_rand(state) / n : 0.0;
+        }
+        A[j + j * lda] += shift;
+    }
+}
+
+/**
+ * \brief Nominal flops of the LU factorization of an (n x n) complex Hessenberg matrix
+ *
+ * One complex multiply-add (8 flops) per entry of the n - k updated entries of each row k
+ */
+static inline double microbench_flops_hessenberg_lu(const int n)
+{
+    return 4.0 * n * (n - 1);
+}
+
+/**
+ * \brief Nominal flops of the inversion of an (n x n) complex Hessenberg matrix (getComplexInverseHessenberg)
+ *
+ * The LU factorization, the inversion of U (\f$n^3/6\f$ complex multiply-adds) and the solve with the bidiagonal L
+ */
+static inline double microbench_flops_hessenberg_inverse(const int n)
+{
+    return microbench_flops_hessenberg_lu(n) + 8.0 * n * n * n / 6.0 + 8.0 * n * n;
+}
+
+/**
+ * \brief Nominal flops of the rational approximation of \f$\phi_1\f$ of an (m x m) Hessenberg matrix
+ * \param[in]       m           The matrix size
+ * \param[in]       num_poles   The number of poles of the approximant, of which every other is evaluated
+ */
+static inline double microbench_flops_phi(const int m, const int num_poles)
+{
+    // the shifted inverse and the accumulation of the (complex * real) residue product
+    return (num_poles / 2) * (microbench_flops_hessenberg_inverse(m) + 8.0 * m * m);
+}
+
+/**
+ * \brief Nominal flops of the formation and the dense LU factorization of the Radau-IIa real and complex systems of size n
+ */
+static inline double microbench_flops_rk_decomp(const int n)
+{
+    // dgetrf + zgetrf
+    return 2.0 * n * n * n / 3.0 + 8.0 * n * n * n / 3.0 + 3.0 * n * n;
+}
+
+/**
+ * \brief Nominal flops of the Radau-IIa back-substitution of the real and complex systems of size n (RK_Solve)
+ */
+static inline double microbench_flops_rk_solve(const int n)
+{
+    // dgetrs + zgetrs, and the two 3 x 3 transformations of the stages
+    return 2.0 * n * n + 8.0 * n * n + 2.0 * 18.0 * n;
+}
+
+/**
+ * \brief Prints the header of the kernel table
+ */
+static inline void microbench_print_header()
+{
+    printf("%-28s %8s %8s %14s %14s %10s\n", "kernel", "platform", "size", "ns/op", "cycles/op", "GFLOP/s");
+}
+
+/**
+ * \brief Prints the kernel record `rec`, and appends it to #BENCHMARK_OUTPUT (if defined)
+ */
+static inline void microbench_print(const microbench_record* rec)
+{
+    double gflops = rec->flops_per_op > 0 ? rec->flops_per_op / rec->ns_per_op : 0;
+    printf("%-28s %8s %8d %14.3f %14.1f %10.3f\n", rec->kernel, rec->platform, rec->size,
+           rec->ns_per_op, rec->cycles_per_op, gflops);
+#ifdef BENCHMARK_OUTPUT
+    const char* filename = BENCHMARK_OUTPUT;
+    size_t len = strlen(filename);
+    int csv = len >= 4 && strcmp(&filename[len - 4], ".csv") == 0;
+    FILE* file = fopen(filename, "a");
+    if (file == NULL)
+    {
+        printf("Error: could not open benchmark output file %s\n", filename);
+        exit(-1);
+    }
+    if (csv)
+    {
+        fseek(file, 0, SEEK_END);
+        if (ftell(file) == 0)
+            fprintf(file, "kernel,platform,size,ns_per_op,cycles_per_op,flops_per_op,gflops\n");
+        fprintf(file, "%s,%s,%d,%.9e,%.9e,%.9e,%.9e\n", rec->kernel, rec->platform, rec->size,
+                rec->ns_per_op, rec->cycles_per_op, rec->flops_per_op, gflops);
+    }
+    else
+    {
+        fprintf(file, "{\"kernel\": \"%s\", \"platform\": \"%s\", \"size\": %d, \"ns_per_op\": %.9e, "
+                      "\"cycles_per_op\": %.9e, \"flops_per_op\": %.9e, \"gflops\": %.9e}\n",
+                rec->kernel, rec->platform, rec->size, rec->ns_per_op, rec->cycles_per_op,
+                rec->flops_per_op, gflops);
+    }
+    fclose(file);
+#endif
+}
+
+/**
+ * \brief Returns the sizes (in increasing order) the variable-sized kernels are run at: powers of two up to, and including, `max_size`
+ * \param[in]       max_size    The largest size
+ * \param[out]      sizes       The sizes, at least 32 entries
+ * \return          The number of sizes
+ */
+static inline int microbench_sizes(const int max_size, int* sizes)
+{
+    int num = 0;
+    for (int n = 2; n < max_size && num < 31; n *= 2)
+        sizes[num++] = n;
+    sizes[num++] = max_size;
+    return num;
+}
+
+#endif